@@ -0,0 +1,14 @@
+-- Add detection decode strategy columns to streams table
+--
+-- detection_decode_mode: how the unified detection thread decodes video for
+-- detection: 'keyframes' (decode only keyframes, default), 'gop' (decode the
+-- keyframe of every Nth GOP) or 'full' (decode every frame).
+--
+-- detection_decode_gop_interval: N for 'gop' mode.
+
+-- migrate:up
+ALTER TABLE streams ADD COLUMN detection_decode_mode TEXT DEFAULT 'keyframes';
+ALTER TABLE streams ADD COLUMN detection_decode_gop_interval INTEGER DEFAULT 2;
+
+-- migrate:down
+-- SQLite does not support DROP COLUMN in older versions; migration is left intentionally empty.
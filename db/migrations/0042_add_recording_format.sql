@@ -0,0 +1,12 @@
+-- Add recording container format column to streams table
+--
+-- recording_format: 'mp4' (default) writes a regular MP4 and relocates the
+-- moov atom to the front when the segment is closed (faststart); 'fmp4'
+-- writes an append-only fragmented MP4 (one fragment per keyframe) that is
+-- never rewritten.
+
+-- migrate:up
+ALTER TABLE streams ADD COLUMN recording_format TEXT DEFAULT 'mp4';
+
+-- migrate:down
+-- SQLite does not support DROP COLUMN in older versions; migration is left intentionally empty.
@@ -0,0 +1,168 @@
+-- Indexes and triggers that keep the recordings list fast on large archives
+--
+-- recording_day_counts holds the number of listable recordings (complete,
+-- with an end time) per stream and UTC day of start_time, so the list total
+-- is a sum over a few hundred rows instead of a COUNT(*) over the archive.
+--
+-- recording_labels holds, for each recording, the labels of the detections
+-- linked to it by recording_id or, for detections without one, by stream and
+-- time range.  It may keep a label after the detection that added it is gone,
+-- so label queries use it to find candidates and still check detections.
+-- recording_label_names lists every label once, for resolving LIKE patterns.
+--
+-- All three tables are maintained by the triggers below.
+
+-- migrate:up
+
+CREATE INDEX IF NOT EXISTS idx_recordings_complete_start ON recordings(is_complete, start_time);
+CREATE INDEX IF NOT EXISTS idx_recordings_stream_end ON recordings(stream_name, end_time);
+
+CREATE TABLE IF NOT EXISTS recording_day_counts (
+    stream_name TEXT NOT NULL,
+    day INTEGER NOT NULL,
+    count INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY (stream_name, day)
+) WITHOUT ROWID;
+
+CREATE TABLE IF NOT EXISTS recording_labels (
+    recording_id INTEGER NOT NULL,
+    label TEXT NOT NULL,
+    PRIMARY KEY (recording_id, label)
+) WITHOUT ROWID;
+
+CREATE INDEX IF NOT EXISTS idx_recording_labels_label ON recording_labels(label, recording_id);
+
+CREATE TABLE IF NOT EXISTS recording_label_names (
+    label TEXT PRIMARY KEY
+) WITHOUT ROWID;
+
+-- Backfill from existing data
+INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)
+    SELECT stream_name, start_time / 86400, COUNT(*) FROM recordings
+    WHERE is_complete = 1 AND end_time IS NOT NULL
+    GROUP BY stream_name, start_time / 86400;
+
+INSERT OR IGNORE INTO recording_labels (recording_id, label)
+    SELECT d.recording_id, d.label FROM detections d
+    WHERE d.recording_id IS NOT NULL
+      AND EXISTS (SELECT 1 FROM recordings r WHERE r.id = d.recording_id);
+
+INSERT OR IGNORE INTO recording_labels (recording_id, label)
+    SELECT r.id, d.label FROM recordings r
+    JOIN detections d ON d.stream_name = r.stream_name
+        AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time
+    WHERE d.recording_id IS NULL AND r.end_time IS NOT NULL;
+
+INSERT OR IGNORE INTO recording_label_names (label)
+    SELECT DISTINCT label FROM recording_labels;
+
+-- Per-day counters
+CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_insert
+AFTER INSERT ON recordings
+WHEN NEW.is_complete = 1 AND NEW.end_time IS NOT NULL
+BEGIN
+    INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)
+        VALUES (NEW.stream_name, NEW.start_time / 86400, 0);
+    UPDATE recording_day_counts SET count = count + 1
+        WHERE stream_name = NEW.stream_name AND day = NEW.start_time / 86400;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_delete
+AFTER DELETE ON recordings
+WHEN OLD.is_complete = 1 AND OLD.end_time IS NOT NULL
+BEGIN
+    UPDATE recording_day_counts SET count = count - 1
+        WHERE stream_name = OLD.stream_name AND day = OLD.start_time / 86400;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_update_old
+AFTER UPDATE OF stream_name, start_time, end_time, is_complete ON recordings
+WHEN OLD.is_complete = 1 AND OLD.end_time IS NOT NULL
+BEGIN
+    UPDATE recording_day_counts SET count = count - 1
+        WHERE stream_name = OLD.stream_name AND day = OLD.start_time / 86400;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_update_new
+AFTER UPDATE OF stream_name, start_time, end_time, is_complete ON recordings
+WHEN NEW.is_complete = 1 AND NEW.end_time IS NOT NULL
+BEGIN
+    INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)
+        VALUES (NEW.stream_name, NEW.start_time / 86400, 0);
+    UPDATE recording_day_counts SET count = count + 1
+        WHERE stream_name = NEW.stream_name AND day = NEW.start_time / 86400;
+END;
+
+-- Label index
+CREATE TRIGGER IF NOT EXISTS trg_recording_labels_name
+AFTER INSERT ON recording_labels
+BEGIN
+    INSERT OR IGNORE INTO recording_label_names (label) VALUES (NEW.label);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_detections_labels_insert
+AFTER INSERT ON detections
+BEGIN
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT r.id, NEW.label FROM recordings r WHERE r.id = NEW.recording_id;
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT r.id, NEW.label FROM recordings r
+        WHERE NEW.recording_id IS NULL AND r.stream_name = NEW.stream_name
+          AND r.end_time >= NEW.timestamp AND r.start_time <= NEW.timestamp;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_detections_labels_update
+AFTER UPDATE OF recording_id, label ON detections
+BEGIN
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT r.id, NEW.label FROM recordings r WHERE r.id = NEW.recording_id;
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT r.id, NEW.label FROM recordings r
+        WHERE NEW.recording_id IS NULL AND r.stream_name = NEW.stream_name
+          AND r.end_time >= NEW.timestamp AND r.start_time <= NEW.timestamp;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_insert
+AFTER INSERT ON recordings
+WHEN NEW.end_time IS NOT NULL
+BEGIN
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT NEW.id, d.label FROM detections d
+        WHERE d.recording_id IS NULL AND d.stream_name = NEW.stream_name
+          AND d.timestamp >= NEW.start_time AND d.timestamp <= NEW.end_time;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_update
+AFTER UPDATE OF stream_name, start_time, end_time ON recordings
+WHEN NEW.end_time IS NOT NULL
+BEGIN
+    INSERT OR IGNORE INTO recording_labels (recording_id, label)
+        SELECT NEW.id, d.label FROM detections d
+        WHERE d.recording_id IS NULL AND d.stream_name = NEW.stream_name
+          AND d.timestamp >= NEW.start_time AND d.timestamp <= NEW.end_time;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_delete
+AFTER DELETE ON recordings
+BEGIN
+    DELETE FROM recording_labels WHERE recording_id = OLD.id;
+END;
+
+-- migrate:down
+
+DROP TRIGGER IF EXISTS trg_recordings_labels_delete;
+DROP TRIGGER IF EXISTS trg_recordings_labels_update;
+DROP TRIGGER IF EXISTS trg_recordings_labels_insert;
+DROP TRIGGER IF EXISTS trg_detections_labels_update;
+DROP TRIGGER IF EXISTS trg_detections_labels_insert;
+DROP TRIGGER IF EXISTS trg_recording_labels_name;
+DROP TRIGGER IF EXISTS trg_recordings_day_count_update_new;
+DROP TRIGGER IF EXISTS trg_recordings_day_count_update_old;
+DROP TRIGGER IF EXISTS trg_recordings_day_count_delete;
+DROP TRIGGER IF EXISTS trg_recordings_day_count_insert;
+DROP TABLE IF EXISTS recording_label_names;
+DROP INDEX IF EXISTS idx_recording_labels_label;
+DROP TABLE IF EXISTS recording_labels;
+DROP TABLE IF EXISTS recording_day_counts;
+DROP INDEX IF EXISTS idx_recordings_stream_end;
+DROP INDEX IF EXISTS idx_recordings_complete_start;
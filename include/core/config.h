@@ -36,6 +36,8 @@ typedef struct {
     bool detection_based_recording; // Only record when detection occurs
     char detection_model[MAX_PATH_LENGTH]; // Path to detection model file
     int detection_interval; // Seconds between detection checks
+    char detection_decode_mode[16]; // Detection decode strategy: "keyframes", "gop", or "full"
+    int detection_decode_gop_interval; // Decode every Nth GOP when detection_decode_mode is "gop"
     float detection_threshold; // Confidence threshold for detection
     int pre_detection_buffer; // Seconds to keep before detection
     int post_detection_buffer; // Seconds to keep after detection
@@ -46,6 +48,7 @@ typedef struct {
     bool streaming_enabled; // Whether HLS streaming is enabled for this stream
     stream_protocol_t protocol; // Stream protocol (TCP, UDP, or ONVIF)
     bool record_audio; // Whether to record audio with video
+    char recording_format[16]; // Recording container layout: "mp4" (faststart) or "fmp4" (fragmented, append-only)
 
     // ONVIF specific fields
     char onvif_username[64];
@@ -128,6 +131,11 @@ typedef struct {
     // Storage settings
     char storage_path[MAX_PATH_LENGTH];
     char storage_path_hls[MAX_PATH_LENGTH]; // Path for HLS segments, overrides storage_path/hls when specified
+    bool hls_memory_store;           // Keep live HLS playlists and segments in RAM instead of on disk
+    int hls_memory_segments;         // Segments per stream listed in the playlist and held in RAM
+    int hls_spill_segments;          // Older segments spilled to disk to extend the playlist (0 = none)
+    bool hls_low_latency;            // LL-HLS parts and blocking playlist reload (requires hls_memory_store)
+    int hls_part_duration_ms;        // LL-HLS part target duration in milliseconds
     uint64_t max_storage_size; // in bytes
     int retention_days;
     bool auto_delete_oldest;
@@ -143,6 +151,7 @@ typedef struct {
     
     // Models settings
     char models_path[MAX_PATH_LENGTH]; // Path to detection models directory
+    int sod_threads;                   // Threads per SOD forward pass (0 = one per CPU); also runs CPUs / sod_threads passes at once
     
     // API detection settings
     char api_detection_url[MAX_URL_LENGTH]; // URL for the detection API
@@ -198,6 +207,7 @@ typedef struct {
     
     // Stream settings
     int max_streams;            // Runtime operational limit (default 32, max MAX_STREAMS, requires restart)
+    bool shared_ingest;         // Open each camera once and fan packets out to HLS, MP4 and detection (default: true)
     stream_config_t *streams;   // Dynamically allocated array of max_streams entries
     
     // Memory optimization
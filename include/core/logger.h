@@ -153,6 +153,85 @@ int is_syslog_enabled(void);
  */
 int is_logger_available(void);
 
+/* -----------------------------------------------------------------------
+ * Asynchronous writer
+ *
+ * Once init_logger() has run, log_* calls only format the message and hand
+ * it to a lock-free queue; a background thread writes queued messages to
+ * the log file, the console, syslog and the JSON log in batches, with one
+ * flush per batch.  When the queue is full the caller waits for the writer
+ * rather than dropping the message.  Before init_logger() and after
+ * shutdown_logger() messages are written synchronously.
+ * ----------------------------------------------------------------------- */
+
+// Messages the queue holds before callers have to wait for the writer
+#define LOG_QUEUE_SIZE 256
+
+// Messages a single call site may log per second by default
+#define LOG_RATE_LIMIT_DEFAULT 20
+
+/**
+ * Wait until every message logged so far has been written out
+ *
+ * Call before reading the log file back.
+ */
+void log_flush(void);
+
+/**
+ * Limit how many messages one call site may log per second
+ *
+ * Further messages from that call site in the same second are dropped and
+ * counted; the count is logged just before the call site's next message.
+ * ERROR messages are never dropped.
+ *
+ * @param per_second Messages allowed per second, or 0 for no limit
+ */
+void set_log_rate_limit(int per_second);
+
+/* -----------------------------------------------------------------------
+ * In-memory tail
+ *
+ * The writer keeps the most recent LOG_TAIL_ENTRIES messages in memory so
+ * the logs API can serve them without reading the log file back.
+ * ----------------------------------------------------------------------- */
+
+#define LOG_TAIL_ENTRIES  1024
+#define LOG_TAIL_TEXT_MAX 512   // Longer lines are truncated in the tail
+
+/**
+ * One message in the in-memory tail
+ */
+typedef struct {
+    log_level_t level;
+    char timestamp[24];                 // "YYYY-MM-DD HH:MM:SS.mmm", as in the log file
+    char text[LOG_TAIL_TEXT_MAX];       // "[component] [stream] message", as in the log file
+} log_tail_entry_t;
+
+/**
+ * Callback for log_tail_foreach(); called with the tail locked, so it must
+ * not log
+ */
+typedef void (*log_tail_callback_t)(const log_tail_entry_t *entry, void *user_data);
+
+/**
+ * Visit recent messages, oldest first
+ *
+ * With after_timestamp, visits the oldest max_entries messages at or below
+ * max_level that are newer than it, so a poller pages forward without gaps;
+ * without, visits the newest max_entries.  Nothing is visited unless the
+ * tail holds the complete answer: with after_timestamp, the tail must reach
+ * back to it; without, it must hold max_entries matching messages.
+ *
+ * @param max_level Most verbose level to include
+ * @param after_timestamp Only messages newer than this, or NULL/"" for any
+ * @param max_entries Maximum messages to visit
+ * @param callback Called for each message
+ * @param user_data Passed to callback
+ * @return Number of messages visited, or -1 if the log file must be read instead
+ */
+int log_tail_foreach(log_level_t max_level, const char *after_timestamp, int max_entries,
+                     log_tail_callback_t callback, void *user_data);
+
 /* -----------------------------------------------------------------------
  * Compile-time per-translation-unit context macros
  *
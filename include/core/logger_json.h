@@ -32,6 +32,26 @@ void shutdown_json_logger(void);
  */
 int write_json_log(log_level_t level, const char *timestamp, const char *message);
 
+/**
+ * @brief Write a log entry to the JSON log file without flushing it
+ *
+ * Used by the logger's background writer, which flushes once per batch.
+ *
+ * @param level Log level
+ * @param timestamp Timestamp string
+ * @param component Component label, or NULL/"" for none
+ * @param stream_name Stream name, or NULL/"" for none
+ * @param message Log message
+ * @return int 0 on success, non-zero on error
+ */
+int write_json_log_entry(log_level_t level, const char *timestamp, const char *component,
+                         const char *stream_name, const char *message);
+
+/**
+ * @brief Flush entries written with write_json_log_entry() to disk
+ */
+void flush_json_log(void);
+
 /**
  * @brief Get logs from the JSON log file with timestamp-based pagination
  * 
@@ -226,6 +226,34 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
  */
 int db_auth_validate_session(const char *token, int64_t *user_id);
 
+/**
+ * @brief Look up the user behind a valid session token
+ *
+ * Served from the in-memory session cache when possible. Does not record
+ * activity; call db_auth_validate_session_with_context() for that.
+ *
+ * @param token Session token
+ * @param user Pointer to store the user
+ * @return 0 on success, non-zero if the session is unknown, expired or its user inactive
+ */
+int db_auth_get_session_user(const char *token, user_t *user);
+
+/**
+ * @brief Write session activity held in the cache to the database
+ *
+ * Runs automatically about once a minute from session validation.
+ *
+ * @return Number of sessions written, or negative on failure
+ */
+int db_auth_flush_session_activity(void);
+
+/**
+ * @brief Flush pending session activity and empty the session cache
+ *
+ * Call before the database is closed or replaced.
+ */
+void db_auth_shutdown(void);
+
 /**
  * @brief Delete a session
  * 
@@ -0,0 +1,134 @@
+/**
+ * @file db_auth_cache.h
+ * @brief In-memory cache of validated sessions and API keys
+ *
+ * Entries are keyed by the SHA-256 digest of the credential, never the
+ * credential itself, and spread over independently locked shards so that
+ * concurrent requests only contend when their tokens hash to the same shard.
+ *
+ * Session activity (last_activity_at / idle_expires_at) is advanced in the
+ * cache on every request and collected with auth_cache_take_activity() so
+ * the database is written in periodic batches instead of per request.
+ *
+ * The cache only holds what the database said; callers are responsible for
+ * invalidating entries whenever they change a session or a user.
+ */
+
+#ifndef LIGHTNVR_DB_AUTH_CACHE_H
+#define LIGHTNVR_DB_AUTH_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "database/db_auth.h"
+
+#define AUTH_CACHE_KEY_SIZE 32
+#define AUTH_CACHE_SHARDS 16
+#define AUTH_CACHE_SHARD_SLOTS 16
+
+// Entries are re-read from the database after this long even without an
+// explicit invalidation, which bounds the effect of out-of-band DB edits.
+#define AUTH_CACHE_TTL_SECONDS 300
+
+typedef enum {
+    AUTH_CACHE_SESSION = 0,
+    AUTH_CACHE_API_KEY = 1
+} auth_cache_kind_t;
+
+typedef struct {
+    uint8_t key[AUTH_CACHE_KEY_SIZE];  /**< SHA-256 of the token or API key */
+    auth_cache_kind_t kind;
+    int64_t session_id;                /**< 0 for API keys */
+    time_t expires_at;                 /**< Absolute expiry (0 = never) */
+    time_t idle_expires_at;            /**< Idle expiry (0 = never) */
+    time_t last_activity_at;           /**< Latest activity seen by the cache */
+    time_t stored_activity_at;         /**< last_activity_at as last written to the DB */
+    time_t loaded_at;                  /**< When the entry was read from the DB */
+    char ip_address[46];
+    char user_agent[256];
+    user_t user;
+} auth_cache_entry_t;
+
+/**
+ * Pending activity for one session, as returned by auth_cache_take_activity()
+ */
+typedef struct {
+    int64_t session_id;
+    time_t last_activity_at;
+    time_t idle_expires_at;
+} auth_cache_activity_t;
+
+/**
+ * Look up a cached entry
+ *
+ * Expired sessions are dropped. An entry older than AUTH_CACHE_TTL_SECONDS
+ * is reported as a miss but kept, so its pending activity survives the
+ * reload through auth_cache_put().
+ *
+ * @return true and a copy of the entry in @p out on a hit
+ */
+bool auth_cache_get(const uint8_t key[AUTH_CACHE_KEY_SIZE], auth_cache_kind_t kind,
+                    time_t now, auth_cache_entry_t *out);
+
+/**
+ * Insert or replace an entry freshly loaded from the database
+ *
+ * When the session is already cached, activity newer than what the
+ * database holds is carried over so a reload never loses it.
+ *
+ * @return 0 on success, -1 if the shard is full of entries with unwritten
+ *         activity (the caller simply continues uncached)
+ */
+int auth_cache_put(const auth_cache_entry_t *entry, time_t now);
+
+/**
+ * Current invalidation generation
+ *
+ * Read it before loading an entry from the database and pass it to
+ * auth_cache_put_if_current().
+ */
+uint64_t auth_cache_generation(void);
+
+/**
+ * Insert an entry loaded from the database unless an invalidation ran since
+ * @p generation was read
+ *
+ * A logout or password change between the database read and the insert
+ * would otherwise be lost and the revoked credential cached again.
+ *
+ * @return As auth_cache_put(), or 1 if the entry was skipped as outdated
+ */
+int auth_cache_put_if_current(const auth_cache_entry_t *entry, time_t now, uint64_t generation);
+
+/**
+ * Record a request on a cached session
+ *
+ * Advances last_activity_at and the idle expiry (capped at the absolute
+ * expiry) and stores the client IP / user agent when given.
+ *
+ * @param idle_seconds Idle timeout to apply from @p now
+ * @param out          Receives a copy of the updated entry (may be NULL)
+ * @return -1 if the session is not cached or has expired, 1 if the client
+ *         IP or user agent changed, 0 otherwise
+ */
+int auth_cache_record_activity(const uint8_t key[AUTH_CACHE_KEY_SIZE], time_t now,
+                               int idle_seconds, const char *ip_address,
+                               const char *user_agent, auth_cache_entry_t *out);
+
+/**
+ * Collect sessions whose activity has not been written to the database
+ *
+ * The entries are marked as written; a caller that fails to store them
+ * only loses the activity since the previous flush.
+ *
+ * @return Number of entries stored in @p out (at most @p max)
+ */
+int auth_cache_take_activity(auth_cache_activity_t *out, int max);
+
+void auth_cache_invalidate_key(const uint8_t key[AUTH_CACHE_KEY_SIZE], auth_cache_kind_t kind);
+void auth_cache_invalidate_session(int64_t session_id);
+void auth_cache_invalidate_user(int64_t user_id);
+void auth_cache_clear(void);
+
+#endif // LIGHTNVR_DB_AUTH_CACHE_H
@@ -630,6 +630,172 @@ static const char migration_0040_up[] =
 static const char migration_0040_down[] =
     "SELECT 1;";
 
+static const char migration_0041_up[] =
+    "ALTER TABLE streams ADD COLUMN detection_decode_mode TEXT DEFAULT 'keyframes';\n"
+    "ALTER TABLE streams ADD COLUMN detection_decode_gop_interval INTEGER DEFAULT 2;";
+
+static const char migration_0041_down[] =
+    "SELECT 1;";
+
+static const char migration_0042_up[] =
+    "ALTER TABLE streams ADD COLUMN recording_format TEXT DEFAULT 'mp4';";
+
+static const char migration_0042_down[] =
+    "SELECT 1;";
+
+static const char migration_0043_up[] =
+    "CREATE INDEX IF NOT EXISTS idx_recordings_complete_start ON recordings(is_complete, start_time);\n"
+    "CREATE INDEX IF NOT EXISTS idx_recordings_stream_end ON recordings(stream_name, end_time);\n"
+    "\n"
+    "CREATE TABLE IF NOT EXISTS recording_day_counts (\n"
+    "    stream_name TEXT NOT NULL,\n"
+    "    day INTEGER NOT NULL,\n"
+    "    count INTEGER NOT NULL DEFAULT 0,\n"
+    "    PRIMARY KEY (stream_name, day)\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "CREATE TABLE IF NOT EXISTS recording_labels (\n"
+    "    recording_id INTEGER NOT NULL,\n"
+    "    label TEXT NOT NULL,\n"
+    "    PRIMARY KEY (recording_id, label)\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "CREATE INDEX IF NOT EXISTS idx_recording_labels_label ON recording_labels(label, recording_id);\n"
+    "\n"
+    "CREATE TABLE IF NOT EXISTS recording_label_names (\n"
+    "    label TEXT PRIMARY KEY\n"
+    ") WITHOUT ROWID;\n"
+    "\n"
+    "-- Backfill from existing data\n"
+    "INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)\n"
+    "    SELECT stream_name, start_time / 86400, COUNT(*) FROM recordings\n"
+    "    WHERE is_complete = 1 AND end_time IS NOT NULL\n"
+    "    GROUP BY stream_name, start_time / 86400;\n"
+    "\n"
+    "INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "    SELECT d.recording_id, d.label FROM detections d\n"
+    "    WHERE d.recording_id IS NOT NULL\n"
+    "      AND EXISTS (SELECT 1 FROM recordings r WHERE r.id = d.recording_id);\n"
+    "\n"
+    "INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "    SELECT r.id, d.label FROM recordings r\n"
+    "    JOIN detections d ON d.stream_name = r.stream_name\n"
+    "        AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time\n"
+    "    WHERE d.recording_id IS NULL AND r.end_time IS NOT NULL;\n"
+    "\n"
+    "INSERT OR IGNORE INTO recording_label_names (label)\n"
+    "    SELECT DISTINCT label FROM recording_labels;\n"
+    "\n"
+    "-- Per-day counters\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_insert\n"
+    "AFTER INSERT ON recordings\n"
+    "WHEN NEW.is_complete = 1 AND NEW.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)\n"
+    "        VALUES (NEW.stream_name, NEW.start_time / 86400, 0);\n"
+    "    UPDATE recording_day_counts SET count = count + 1\n"
+    "        WHERE stream_name = NEW.stream_name AND day = NEW.start_time / 86400;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_delete\n"
+    "AFTER DELETE ON recordings\n"
+    "WHEN OLD.is_complete = 1 AND OLD.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    UPDATE recording_day_counts SET count = count - 1\n"
+    "        WHERE stream_name = OLD.stream_name AND day = OLD.start_time / 86400;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_update_old\n"
+    "AFTER UPDATE OF stream_name, start_time, end_time, is_complete ON recordings\n"
+    "WHEN OLD.is_complete = 1 AND OLD.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    UPDATE recording_day_counts SET count = count - 1\n"
+    "        WHERE stream_name = OLD.stream_name AND day = OLD.start_time / 86400;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_day_count_update_new\n"
+    "AFTER UPDATE OF stream_name, start_time, end_time, is_complete ON recordings\n"
+    "WHEN NEW.is_complete = 1 AND NEW.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_day_counts (stream_name, day, count)\n"
+    "        VALUES (NEW.stream_name, NEW.start_time / 86400, 0);\n"
+    "    UPDATE recording_day_counts SET count = count + 1\n"
+    "        WHERE stream_name = NEW.stream_name AND day = NEW.start_time / 86400;\n"
+    "END;\n"
+    "\n"
+    "-- Label index\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recording_labels_name\n"
+    "AFTER INSERT ON recording_labels\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_label_names (label) VALUES (NEW.label);\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_detections_labels_insert\n"
+    "AFTER INSERT ON detections\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT r.id, NEW.label FROM recordings r WHERE r.id = NEW.recording_id;\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT r.id, NEW.label FROM recordings r\n"
+    "        WHERE NEW.recording_id IS NULL AND r.stream_name = NEW.stream_name\n"
+    "          AND r.end_time >= NEW.timestamp AND r.start_time <= NEW.timestamp;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_detections_labels_update\n"
+    "AFTER UPDATE OF recording_id, label ON detections\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT r.id, NEW.label FROM recordings r WHERE r.id = NEW.recording_id;\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT r.id, NEW.label FROM recordings r\n"
+    "        WHERE NEW.recording_id IS NULL AND r.stream_name = NEW.stream_name\n"
+    "          AND r.end_time >= NEW.timestamp AND r.start_time <= NEW.timestamp;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_insert\n"
+    "AFTER INSERT ON recordings\n"
+    "WHEN NEW.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT NEW.id, d.label FROM detections d\n"
+    "        WHERE d.recording_id IS NULL AND d.stream_name = NEW.stream_name\n"
+    "          AND d.timestamp >= NEW.start_time AND d.timestamp <= NEW.end_time;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_update\n"
+    "AFTER UPDATE OF stream_name, start_time, end_time ON recordings\n"
+    "WHEN NEW.end_time IS NOT NULL\n"
+    "BEGIN\n"
+    "    INSERT OR IGNORE INTO recording_labels (recording_id, label)\n"
+    "        SELECT NEW.id, d.label FROM detections d\n"
+    "        WHERE d.recording_id IS NULL AND d.stream_name = NEW.stream_name\n"
+    "          AND d.timestamp >= NEW.start_time AND d.timestamp <= NEW.end_time;\n"
+    "END;\n"
+    "\n"
+    "CREATE TRIGGER IF NOT EXISTS trg_recordings_labels_delete\n"
+    "AFTER DELETE ON recordings\n"
+    "BEGIN\n"
+    "    DELETE FROM recording_labels WHERE recording_id = OLD.id;\n"
+    "END;";
+
+static const char migration_0043_down[] =
+    "DROP TRIGGER IF EXISTS trg_recordings_labels_delete;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_labels_update;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_labels_insert;\n"
+    "DROP TRIGGER IF EXISTS trg_detections_labels_update;\n"
+    "DROP TRIGGER IF EXISTS trg_detections_labels_insert;\n"
+    "DROP TRIGGER IF EXISTS trg_recording_labels_name;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_day_count_update_new;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_day_count_update_old;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_day_count_delete;\n"
+    "DROP TRIGGER IF EXISTS trg_recordings_day_count_insert;\n"
+    "DROP TABLE IF EXISTS recording_label_names;\n"
+    "DROP INDEX IF EXISTS idx_recording_labels_label;\n"
+    "DROP TABLE IF EXISTS recording_labels;\n"
+    "DROP TABLE IF EXISTS recording_day_counts;\n"
+    "DROP INDEX IF EXISTS idx_recordings_stream_end;\n"
+    "DROP INDEX IF EXISTS idx_recordings_complete_start;";
+
 static const migration_t embedded_migrations_data[] = {
     {
         .version = "0001",
@@ -911,8 +1077,29 @@ static const migration_t embedded_migrations_data[] = {
         .sql_down = migration_0040_down,
         .is_embedded = true
     },
+    {
+        .version = "0041",
+        .description = "add_detection_decode_mode",
+        .sql_up = migration_0041_up,
+        .sql_down = migration_0041_down,
+        .is_embedded = true
+    },
+    {
+        .version = "0042",
+        .description = "add_recording_format",
+        .sql_up = migration_0042_up,
+        .sql_down = migration_0042_down,
+        .is_embedded = true
+    },
+    {
+        .version = "0043",
+        .description = "add_recording_list_indexes",
+        .sql_up = migration_0043_up,
+        .sql_down = migration_0043_down,
+        .is_embedded = true
+    },
 };
 
-#define EMBEDDED_MIGRATIONS_COUNT 40
+#define EMBEDDED_MIGRATIONS_COUNT 43
 
 #endif /* DB_EMBEDDED_MIGRATIONS_H */
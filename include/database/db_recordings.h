@@ -131,6 +131,47 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
                                    const char * const *allowed_streams, int allowed_streams_count,
                                    const char *tag_filter, const char *capture_method_filter);
 
+/**
+ * Position in the recordings list ordered by (start_time, id)
+ */
+typedef struct {
+    time_t start_time;
+    uint64_t id;
+} recording_cursor_t;
+
+/**
+ * Get the page of recordings that follows a cursor, ordered by start time
+ *
+ * Keyset pagination: the page starts just past the recording the cursor
+ * names, so its cost does not grow with the number of pages already read.
+ * Pass the start_time and id of the last recording of a page to get the next.
+ *
+ * @param start_time Start time filter (0 for no filter)
+ * @param end_time End time filter (0 for no filter)
+ * @param stream_name Stream name filter as a single name or comma-separated list (NULL for all streams)
+ * @param has_detection Filter for recordings with detection events (0 for all)
+ * @param detection_label Filter by specific detection label as a single value or comma-separated list (NULL for all)
+ * @param protected_filter Filter by protection status (-1 for all, 0 for unprotected, 1 for protected)
+ * @param sort_order Sort order ("asc" or "desc", default "desc")
+ * @param after Cursor to continue from, or NULL for the first page
+ * @param metadata Array to fill with recording metadata
+ * @param limit Maximum number of recordings to return
+ * @param allowed_streams Optional whitelist of stream names for tag-based RBAC (NULL or count=0 for no restriction)
+ * @param allowed_streams_count Number of entries in allowed_streams (0 for no restriction)
+ * @param tag_filter Filter by recording tag as a single value or comma-separated list (NULL for all)
+ * @param capture_method_filter Filter by capture method as a single value or comma-separated list (NULL for all)
+ * @return Number of recordings found, or -1 on error
+ */
+int get_recording_metadata_after(time_t start_time, time_t end_time,
+                                 const char *stream_name, int has_detection,
+                                 const char *detection_label,
+                                 int protected_filter,
+                                 const char *sort_order,
+                                 const recording_cursor_t *after,
+                                 recording_metadata_t *metadata, int limit,
+                                 const char * const *allowed_streams, int allowed_streams_count,
+                                 const char *tag_filter, const char *capture_method_filter);
+
 /**
  * Get recording metadata by ID
  *
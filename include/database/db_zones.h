@@ -2,6 +2,7 @@
 #define DB_ZONES_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "core/config.h"
 
 #define MAX_ZONE_NAME 64
@@ -72,5 +73,20 @@ int delete_detection_zone(const char *zone_id);
  */
 int update_zone_enabled(const char *zone_id, bool enabled);
 
+/**
+ * Get the version of the zones table
+ *
+ * Changes after every write made through this module, so callers can keep
+ * zones in memory and reload them only when the version moves.
+ * @return Current version
+ */
+uint64_t get_detection_zones_version(void);
+
+/**
+ * Mark cached zones stale after a change made outside this module
+ * (e.g. deleting a stream, which cascades to its zones)
+ */
+void bump_detection_zones_version(void);
+
 #endif /* DB_ZONES_H */
 
@@ -156,7 +156,8 @@ typedef enum {
 	SOD_RNN_CALLBACK,
 	SOD_RNN_TEXT_LENGTH,
 	SOD_RNN_DATA_LENGTH,
-	SOD_RNN_SEED
+	SOD_RNN_SEED,
+	SOD_CNN_THREADS /* int: threads shared by all networks in the process (<= 0: one per CPU, 1: no worker pool) */
 }SOD_CNN_CONFIG;
 /* 
  * RNN Consumer callback to be used in conjunction with the `SOD_RNN_CALLBACK` configuration verb.
@@ -0,0 +1,134 @@
+/**
+ * Per-stream decoded frame bus
+ *
+ * The unified detection thread is the only component that decodes a live
+ * camera.  Instead of opening another RTSP session and decoder, any other
+ * consumer of decoded frames subscribes to the stream's frame bus:
+ *
+ * - the publisher hands each decoded frame to frame_bus_publish(), which only
+ *   takes a reference (no pixel copy);
+ * - each subscriber asks for frames at its own rate and, optionally, its own
+ *   size / pixel format;
+ * - a subscriber that keeps the source size and format receives a new
+ *   reference to the published frame (zero-copy); otherwise the frame is
+ *   scaled into a buffer owned by the returned frame.
+ *
+ * The publisher decodes extra frames only while frame_bus_wants_frame()
+ * reports a subscriber waiting, and publishing is a single atomic load while
+ * no stream has subscribers, so an unused bus costs nothing.
+ *
+ * The MQTT Home Assistant snapshot thread subscribes to every stream and
+ * falls back to go2rtc for streams without a running detection thread.
+ */
+
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+
+typedef struct frame_bus_subscriber frame_bus_subscriber_t;
+
+/**
+ * Subscription options
+ */
+typedef struct {
+    int interval_ms;                // Minimum spacing between delivered frames (0 = every published frame)
+    int width;                      // Output width (0 = source width)
+    int height;                     // Output height (0 = source height)
+    enum AVPixelFormat pix_fmt;     // Output format (AV_PIX_FMT_NONE = source format)
+} frame_bus_sub_config_t;
+
+/**
+ * Frame bus statistics for one stream
+ */
+typedef struct {
+    int subscribers;
+    uint64_t frames_published;
+    uint64_t frames_delivered;
+} frame_bus_stats_t;
+
+/**
+ * Publish a decoded frame to a stream's subscribers
+ *
+ * Takes a new reference to frame; the caller keeps ownership of its own
+ * reference.  Frames arriving faster than the fastest subscriber wants them
+ * are dropped, and nothing is retained while the stream has no subscribers.
+ *
+ * @param stream_name Stream the frame was decoded from
+ * @param frame Decoded frame
+ * @return 1 if the frame was published, 0 if it was dropped, -1 on error
+ */
+int frame_bus_publish(const char *stream_name, const AVFrame *frame);
+
+/**
+ * Check whether a stream's subscribers are waiting for a new frame
+ *
+ * Publishers that only decode some frames for their own use (e.g. keyframes
+ * on a detection interval) call this to decide whether to decode one more.
+ *
+ * @param stream_name Stream name
+ * @return true if a published frame would be accepted now
+ */
+bool frame_bus_wants_frame(const char *stream_name);
+
+/**
+ * Drop the frame retained for a stream
+ *
+ * Called by the publisher when it disconnects so decoder buffers are not
+ * held after the decoder is closed.  Subscriptions are kept and resume when
+ * a publisher comes back.
+ *
+ * @param stream_name Stream name
+ */
+void frame_bus_clear(const char *stream_name);
+
+/**
+ * Subscribe to a stream's decoded frames
+ *
+ * The stream does not need a publisher yet.
+ *
+ * @param stream_name Stream name
+ * @param config Subscription options (NULL = every frame, source size and format)
+ * @return Subscription handle, or NULL on error
+ */
+frame_bus_subscriber_t *frame_bus_subscribe(const char *stream_name, const frame_bus_sub_config_t *config);
+
+/**
+ * Cancel a subscription and release its resources
+ *
+ * @param sub Subscription handle (may be NULL)
+ */
+void frame_bus_unsubscribe(frame_bus_subscriber_t *sub);
+
+/**
+ * Get the next frame due for a subscriber without blocking
+ *
+ * A handle must only be used from one thread at a time.
+ *
+ * @param sub Subscription handle
+ * @return New frame the caller must av_frame_free(), or NULL if no new frame is due
+ */
+AVFrame *frame_bus_acquire(frame_bus_subscriber_t *sub);
+
+/**
+ * Wait for the next frame due for a subscriber
+ *
+ * @param sub Subscription handle
+ * @param timeout_ms Maximum time to wait
+ * @return New frame the caller must av_frame_free(), or NULL on timeout
+ */
+AVFrame *frame_bus_acquire_wait(frame_bus_subscriber_t *sub, int timeout_ms);
+
+/**
+ * Get frame bus statistics for a stream
+ *
+ * @param stream_name Stream name
+ * @param stats Output statistics
+ * @return 0 on success, -1 if the stream has no bus
+ */
+int frame_bus_get_stats(const char *stream_name, frame_bus_stats_t *stats);
+
+#endif /* FRAME_BUS_H */
@@ -0,0 +1,103 @@
+#ifndef HLS_LL_PLAYLIST_H
+#define HLS_LL_PLAYLIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Low-latency HLS playlist
+ *
+ * Tracks the segments and partial segments of a live LL-HLS stream and
+ * renders its media playlist with EXT-X-PART, EXT-X-PRELOAD-HINT and
+ * EXT-X-SERVER-CONTROL.  Segments are named "segment_<msn>.ts" and parts
+ * "part_<msn>_<index>.ts", which is also how the HLS memory store tells
+ * the two apart.
+ */
+
+// Parts a single segment can be split into; a segment that reaches this is
+// closed even without a keyframe
+#define HLS_LL_MAX_PARTS 64
+
+typedef struct {
+    double duration;
+    bool independent;       // Part contains a keyframe
+} hls_ll_part_t;
+
+typedef struct {
+    int64_t msn;            // Media sequence number
+    double duration;
+    int part_count;
+    hls_ll_part_t parts[HLS_LL_MAX_PARTS];
+} hls_ll_segment_t;
+
+typedef struct {
+    int target_duration;    // Seconds, only ever grows
+    double part_target;     // Seconds
+    int max_parts;          // Parts the playlist may reference at once
+
+    // Completed segments, oldest first: segments[(head + i) % window]
+    hls_ll_segment_t *segments;
+    int window;
+    int head;
+    int count;
+
+    hls_ll_segment_t current;   // Segment being built
+} hls_ll_playlist_t;
+
+typedef enum {
+    HLS_LL_REQUEST_READY,   // The playlist already satisfies the request
+    HLS_LL_REQUEST_WAIT,    // Hold the request until more parts are published
+    HLS_LL_REQUEST_INVALID  // Asks too far into the future (400)
+} hls_ll_request_state_t;
+
+/**
+ * Initialize a playlist
+ *
+ * @param target_duration Target segment duration in seconds
+ * @param part_target Part target duration in seconds
+ * @param window Completed segments listed in the playlist
+ * @param max_parts Parts the playlist may reference (what the store keeps)
+ * @return 0 on success, -1 on invalid parameters or allocation failure
+ */
+int hls_ll_playlist_init(hls_ll_playlist_t *pl, int target_duration, double part_target,
+                         int window, int max_parts);
+
+/**
+ * Release a playlist
+ */
+void hls_ll_playlist_free(hls_ll_playlist_t *pl);
+
+/**
+ * Append a part to the segment being built
+ *
+ * @return Index of the part within its segment, or -1 if the segment is full
+ */
+int hls_ll_playlist_add_part(hls_ll_playlist_t *pl, double duration, bool independent);
+
+/**
+ * Close the segment being built and start the next one
+ *
+ * @return Media sequence number of the closed segment, or -1 if it had no parts
+ */
+int64_t hls_ll_playlist_end_segment(hls_ll_playlist_t *pl);
+
+/**
+ * Render the media playlist
+ *
+ * @return Length of the playlist, or -1 if the buffer is too small
+ */
+int hls_ll_playlist_render(const hls_ll_playlist_t *pl, char *buf, size_t size);
+
+/**
+ * Decide how to answer a blocking request for part @p part of segment @p msn
+ *
+ * @param cur_msn Sequence number of the segment being built
+ * @param cur_parts Parts published so far in that segment
+ * @param msn Requested sequence number (_HLS_msn)
+ * @param part Requested part (_HLS_part), or -1 to wait for the whole segment
+ */
+hls_ll_request_state_t hls_ll_playlist_request_state(int64_t cur_msn, int cur_parts,
+                                                     int64_t msn, int part);
+
+#endif /* HLS_LL_PLAYLIST_H */
@@ -0,0 +1,118 @@
+#ifndef HLS_MEMORY_STORE_H
+#define HLS_MEMORY_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * In-memory HLS segment store
+ *
+ * When enabled, the HLS writer muxes the playlist and segments into memory
+ * instead of files and hands each finished file to this store.  Every stream
+ * keeps its current playlist plus a ring of its newest segments, which the web
+ * server copies straight into responses without touching the disk.
+ *
+ * Segments evicted from the ring can optionally be spilled to disk so the
+ * playlist can cover a longer DVR window; the oldest spilled files are deleted
+ * as new ones arrive.
+ *
+ * Low-latency streams additionally keep a ring of partial segments ("part_*"
+ * files) and publish their position so blocked playlist requests can be
+ * answered as soon as the part they wait for exists.
+ */
+
+// Segments kept beyond the playlist length so a client holding a slightly
+// older playlist can still fetch every segment it references
+#define HLS_MEMORY_STORE_SLACK_SEGMENTS 2
+
+/**
+ * Create (or reset) the store for a stream
+ *
+ * @param stream_name Stream name
+ * @param max_segments Segments kept in memory
+ * @param spill_dir Directory evicted segments are written to, or NULL
+ * @param spill_segments Spilled segments kept on disk (0 disables spilling)
+ * @return 0 on success, -1 on failure
+ */
+int hls_memory_store_open(const char *stream_name, int max_segments,
+                          const char *spill_dir, int spill_segments);
+
+/**
+ * Drop the store for a stream and delete its spilled segments
+ */
+void hls_memory_store_close(const char *stream_name);
+
+/**
+ * Drop every store (used during shutdown)
+ */
+void hls_memory_store_close_all(void);
+
+/**
+ * Check whether a stream is being served from memory
+ */
+bool hls_memory_store_is_open(const char *stream_name);
+
+/**
+ * Store a finished playlist or segment (the data is copied)
+ *
+ * Files ending in ".m3u8" replace the stream's playlist; anything else is
+ * appended to the segment ring, evicting (and possibly spilling) the oldest.
+ *
+ * @return 0 on success, -1 if the stream has no store or on allocation failure
+ */
+int hls_memory_store_put(const char *stream_name, const char *file_name,
+                         const unsigned char *data, size_t size);
+
+/**
+ * Copy a playlist or segment out of the store
+ *
+ * The copy is made after the store lock is released, so readers of large
+ * segments do not hold up writers or readers of other streams.
+ *
+ * @param data Receives a malloc'd copy the caller must free
+ * @param size Receives the size of the copy
+ * @return 0 on success, -1 if the file is not held in memory
+ */
+int hls_memory_store_get(const char *stream_name, const char *file_name,
+                         unsigned char **data, size_t *size);
+
+/**
+ * Keep low-latency parts for a stream
+ *
+ * @param max_parts Parts kept in memory
+ * @param target_duration Target segment duration in seconds (bounds how long
+ *                        blocking requests are held)
+ * @return 0 on success, -1 if the stream has no store or already keeps parts
+ */
+int hls_memory_store_enable_parts(const char *stream_name, int max_parts, int target_duration);
+
+/**
+ * Publish the position of the newest playlist and notify the listener
+ *
+ * @param msn Sequence number of the segment being built
+ * @param parts Parts of that segment already published
+ */
+int hls_memory_store_set_position(const char *stream_name, int64_t msn, int parts);
+
+/**
+ * Read the published position of a low-latency stream (outputs may be NULL)
+ *
+ * @return 0 on success, -1 if the stream has no store, keeps no parts or has
+ *         not published anything yet
+ */
+int hls_memory_store_get_position(const char *stream_name, int64_t *msn, int *parts,
+                                  int *target_duration);
+
+/**
+ * Set the function called (from the writer's thread) whenever a position is
+ * published or a low-latency store is closed
+ */
+void hls_memory_store_set_listener(void (*listener)(void));
+
+/**
+ * Report the number of open stores and the bytes they hold (either may be NULL)
+ */
+void hls_memory_store_get_usage(int *streams, size_t *bytes);
+
+#endif /* HLS_MEMORY_STORE_H */
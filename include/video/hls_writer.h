@@ -7,10 +7,21 @@
 #include <libavcodec/bsf.h>
 
 #include "core/config.h"
+#include "video/hls/hls_ll_playlist.h"
 
 // Use a different name to avoid conflict with MAX_PATH_LENGTH in config.h
 #define HLS_MAX_PATH_LENGTH 1024
 
+// Files the HLS muxer can have open at once in memory mode (segment + playlist)
+#define HLS_MEMORY_OPEN_FILES 4
+
+// Growable byte buffer for low-latency parts and the segments they form
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} hls_byte_buffer_t;
+
 // Forward declaration for the DTS tracking structure
 typedef struct {
     int64_t first_dts;
@@ -42,6 +53,35 @@ typedef struct hls_writer_t {
     // Thread context for standalone operation
     void *thread_ctx;
 
+    // In-memory output: files the muxer opens are collected in dynamic
+    // buffers and handed to the HLS memory store when closed
+    int memory_mode;
+    struct {
+        AVIOContext *pb;
+        char name[64];
+    } memory_files[HLS_MEMORY_OPEN_FILES];
+    int (*default_io_open)(struct AVFormatContext *s, AVIOContext **pb, const char *url,
+                           int flags, AVDictionary **options);
+    int (*default_io_close2)(struct AVFormatContext *s, AVIOContext *pb);
+
+    // Low-latency mode: a plain MPEG-TS muxer writes into the current part,
+    // which is cut every part target and published with the LL-HLS playlist.
+    // Timestamps are in the output stream time base.
+    int low_latency;
+    AVIOContext *ll_pb;
+    hls_ll_playlist_t ll_playlist;
+    double ll_part_target;
+    char *ll_playlist_buf;
+    size_t ll_playlist_size;
+    hls_byte_buffer_t ll_part;
+    hls_byte_buffer_t ll_segment;
+    int ll_started;
+    int ll_part_independent;
+    int64_t ll_segment_start;
+    int64_t ll_part_start;
+    int64_t ll_last_dts;
+    int64_t ll_frame_interval;
+
     // Mutex for thread safety
     pthread_mutex_t mutex;
 } hls_writer_t;
@@ -0,0 +1,154 @@
+/**
+ * Cross-stream inference scheduler for embedded detection models
+ *
+ * Detection threads no longer run their own copy of a model.  Each one hands
+ * its decoded frame to inference_scheduler_detect() and blocks until a
+ * scheduler worker has run it:
+ *
+ * - model instances are shared by every stream and each is only ever used by
+ *   one worker at a time; a (model path, threshold) gets a further instance,
+ *   up to one per worker, when the loaded ones are all busy;
+ * - queued frames that use the same model are handed to the backend as one
+ *   batch, so a backend that can batch runs a single forward pass for them;
+ * - the highest-priority frame runs first, ties going to the earliest
+ *   deadline;
+ * - a frame still queued when its deadline passes, or when the same stream
+ *   submits a newer frame, is dropped rather than run late.
+ *
+ * Queue depth, drops, batch sizes, queue wait and inference latency are kept
+ * for the metrics endpoint.
+ */
+
+#ifndef INFERENCE_SCHEDULER_H
+#define INFERENCE_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "video/detection_result.h"
+#include "video/detection_model.h"
+
+// Largest number of frames handed to the backend in one call
+#define INFERENCE_MAX_BATCH 8
+
+// Model instances kept loaded at once; the least recently used idle one is
+// unloaded when another is needed
+#define INFERENCE_MAX_MODELS 8
+
+// Deadline used when a request does not set one
+#define INFERENCE_DEFAULT_DEADLINE_MS 1000
+
+// Histogram buckets, upper bounds in seconds (a +Inf bucket is implied)
+#define INFERENCE_HISTOGRAM_BUCKETS 10
+#define INFERENCE_HISTOGRAM_BOUNDS { 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0 }
+
+/**
+ * Result codes of inference_scheduler_detect()
+ */
+#define INFERENCE_OK        0
+#define INFERENCE_ERROR    -1
+#define INFERENCE_DROPPED   1   // Frame was stale and never ran
+
+/**
+ * One frame handed to a backend
+ */
+typedef struct {
+    const unsigned char *data;
+    int width;
+    int height;
+    int channels;
+} inference_frame_t;
+
+/**
+ * Model backend used by the workers
+ *
+ * detect_batch runs count frames through the model and sets status[i] to 0
+ * for each frame whose results[i] is valid.
+ */
+typedef struct {
+    detection_model_t (*load)(const char *model_path, float threshold);
+    void (*unload)(detection_model_t model);
+    void (*detect_batch)(detection_model_t model, const inference_frame_t *frames, int count,
+                         detection_result_t *results, int *status);
+} inference_backend_t;
+
+/**
+ * A frame submitted by a detection thread
+ */
+typedef struct {
+    const char *stream_name;
+    const char *model_path;
+    float threshold;
+    inference_frame_t frame;    // Must stay valid until inference_scheduler_detect() returns
+    int priority;               // 1-10, higher runs first (0 = default 5)
+    int deadline_ms;            // Longest the frame may wait to start (0 = default)
+} inference_request_t;
+
+/**
+ * Cumulative histogram in Prometheus form
+ */
+typedef struct {
+    uint64_t buckets[INFERENCE_HISTOGRAM_BUCKETS];  // Observations <= the matching bound
+    uint64_t count;
+    double sum;                                     // Seconds
+} inference_histogram_t;
+
+/**
+ * Scheduler statistics since start
+ */
+typedef struct {
+    int workers;
+    int queue_depth;                // Frames waiting now
+    int models_loaded;
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t failed;
+    uint64_t dropped_deadline;      // Deadline passed while queued
+    uint64_t dropped_superseded;    // Replaced by a newer frame from the same stream
+    uint64_t batches;
+    uint64_t batch_sizes[INFERENCE_MAX_BATCH];  // Backend calls made with i + 1 frames
+    inference_histogram_t queue_wait;      // Submission to start of inference
+    inference_histogram_t latency;          // Duration of each backend call
+} inference_scheduler_stats_t;
+
+/**
+ * Start the scheduler
+ *
+ * @param workers Worker threads (<= 0 means 1, capped at 8).  Each worker
+ *                runs one forward pass at a time, which itself uses
+ *                [models] sod_threads cores, so cores / sod_threads workers
+ *                keep the CPUs busy.
+ * @param backend Model backend, or NULL for the detection model system
+ * @return 0 on success, -1 on error
+ */
+int inference_scheduler_init(int workers, const inference_backend_t *backend);
+
+/**
+ * Stop the workers, fail any queued frames and unload all models
+ */
+void inference_scheduler_shutdown(void);
+
+/**
+ * Check whether the scheduler is accepting frames
+ */
+bool inference_scheduler_is_running(void);
+
+/**
+ * Run detection on a frame through the scheduler
+ *
+ * Blocks until the frame has run or has been dropped.
+ *
+ * @param req Frame and scheduling parameters
+ * @param result Filled in on INFERENCE_OK
+ * @return INFERENCE_OK, INFERENCE_DROPPED, or INFERENCE_ERROR
+ */
+int inference_scheduler_detect(const inference_request_t *req, detection_result_t *result);
+
+/**
+ * Get scheduler statistics
+ *
+ * @param stats Output statistics (zeroed when the scheduler never ran)
+ */
+void inference_scheduler_get_stats(inference_scheduler_stats_t *stats);
+
+#endif /* INFERENCE_SCHEDULER_H */
@@ -0,0 +1,143 @@
+/**
+ * Keyframe index sidecar for recordings
+ *
+ * While a recording is written, the wall-clock time of every video keyframe
+ * is collected.  Once the MP4 is finalized the keyframe timestamps and byte
+ * offsets are resolved from the container (after faststart has relocated the
+ * moov atom, or from the fragment headers of a fragmented MP4) and saved next
+ * to the recording as "<file>.kfi".
+ *
+ * Readers can then map a wall-clock time (or a position in the recording) to
+ * the byte range of the GOP that contains it without parsing the container.
+ *
+ * Sidecar layout (little endian):
+ *   header:  "LKFI" | u16 version | u16 reserved | u32 tb_num | u32 tb_den |
+ *            u32 entry count | i64 data_end
+ *   entries: i64 pts | i64 byte offset | i64 wall-clock ms
+ */
+
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define KEYFRAME_INDEX_EXTENSION ".kfi"
+#define KEYFRAME_INDEX_VERSION 1
+
+typedef struct {
+    int64_t pts;            // Keyframe timestamp in the file's video time base
+    int64_t offset;         // Byte offset of the keyframe sample in the file
+    int64_t wall_ms;        // Wall-clock time the keyframe was recorded (ms since epoch)
+} keyframe_index_entry_t;
+
+typedef struct {
+    int tb_num;             // Video stream time base
+    int tb_den;
+    int64_t data_end;       // Offset just past the last sample in the file
+    int count;
+    keyframe_index_entry_t *entries;    // Sorted by pts
+} keyframe_index_t;
+
+/**
+ * Byte range of one GOP
+ */
+typedef struct {
+    int64_t offset;         // First byte of the keyframe sample
+    int64_t length;         // Bytes up to the next keyframe (or end of media data)
+    int64_t pts;            // Keyframe timestamp in the file's video time base
+    double media_seconds;   // Keyframe position relative to the first keyframe
+    int64_t wall_ms;        // Wall-clock time of the keyframe
+} keyframe_gop_range_t;
+
+/**
+ * Keyframe collector used while a recording is being written
+ */
+typedef struct keyframe_index_recorder keyframe_index_recorder_t;
+
+/**
+ * Create a collector
+ *
+ * @return Collector, or NULL on allocation failure
+ */
+keyframe_index_recorder_t *keyframe_index_recorder_create(void);
+
+/**
+ * Record the wall-clock time of a video keyframe handed to the muxer
+ *
+ * @param rec Collector (NULL is ignored)
+ * @param wall_ms Wall-clock time in ms since epoch
+ */
+void keyframe_index_recorder_add(keyframe_index_recorder_t *rec, int64_t wall_ms);
+
+/**
+ * Resolve the collected keyframes against a finalized recording and write
+ * its sidecar
+ *
+ * The recording must be closed (trailer written).  Keyframes are matched in
+ * order; if the counts disagree, wall-clock times are extrapolated from the
+ * first recorded keyframe.
+ *
+ * @param rec Collector
+ * @param recording_path Finalized MP4 file
+ * @return 0 on success, -1 on failure
+ */
+int keyframe_index_recorder_finish(keyframe_index_recorder_t *rec, const char *recording_path);
+
+/**
+ * Free a collector
+ */
+void keyframe_index_recorder_free(keyframe_index_recorder_t *rec);
+
+/**
+ * Build the sidecar path for a recording
+ *
+ * @return 0 on success, -1 if the buffer is too small
+ */
+int keyframe_index_sidecar_path(const char *recording_path, char *path, size_t path_size);
+
+/**
+ * Write an index to a sidecar file (atomically, via a temporary file)
+ *
+ * @return 0 on success, -1 on failure
+ */
+int keyframe_index_save(const keyframe_index_t *index, const char *sidecar_path);
+
+/**
+ * Load the sidecar of a recording
+ *
+ * @param recording_path Recording file (the sidecar path is derived from it)
+ * @return Index the caller must release with keyframe_index_free(), or NULL
+ *         if there is no valid sidecar
+ */
+keyframe_index_t *keyframe_index_load(const char *recording_path);
+
+/**
+ * Free an index returned by keyframe_index_load()
+ */
+void keyframe_index_free(keyframe_index_t *index);
+
+/**
+ * Find the GOP containing a wall-clock time
+ *
+ * Times before the first keyframe map to the first GOP.
+ *
+ * @return 0 on success, -1 if the index is empty
+ */
+int keyframe_index_find_gop(const keyframe_index_t *index, int64_t wall_ms,
+                            keyframe_gop_range_t *range);
+
+/**
+ * Find the GOP containing a position relative to the start of the recording
+ *
+ * @return 0 on success, -1 if the index is empty
+ */
+int keyframe_index_find_gop_at(const keyframe_index_t *index, double media_seconds,
+                               keyframe_gop_range_t *range);
+
+/**
+ * Delete the sidecar of a recording (missing sidecars are ignored)
+ */
+void keyframe_index_delete(const char *recording_path);
+
+#endif /* KEYFRAME_INDEX_H */
@@ -46,11 +46,32 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
                  int width, int height, int channels, time_t frame_time,
                  detection_result_t *result);
 
+/**
+ * Process a decoded frame's luma plane for motion detection
+ *
+ * Equivalent to detect_motion() but reads the Y plane of a planar/semi-planar
+ * YUV frame directly through its stride, downscaling while reading, so no
+ * full-resolution RGB or grayscale copy is made.
+ *
+ * @param stream_name The name of the stream
+ * @param luma Pointer to the first row of the Y plane (e.g. AVFrame->data[0])
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ * @param stride Bytes between the starts of consecutive rows (e.g. AVFrame->linesize[0])
+ * @param full_range true for full-range (0-255, JPEG) luma, false for limited (16-235)
+ * @param frame_time Timestamp of the frame
+ * @param result Pointer to detection result structure to fill
+ * @return 0 on success, non-zero on failure
+ */
+int detect_motion_luma(const char *stream_name, const unsigned char *luma,
+                       int width, int height, int stride, bool full_range,
+                       time_t frame_time, detection_result_t *result);
+
 /**
  * Configure advanced motion detection parameters
  * 
  * @param stream_name The name of the stream
- * @param blur_radius Blur radius for noise reduction (0-5)
+ * @param blur_radius Blur radius for noise reduction (0-15)
  * @param noise_threshold Threshold for noise filtering (0-50)
  * @param use_grid_detection Whether to use grid-based detection
  * @param grid_size Size of detection grid (2-32)
@@ -0,0 +1,94 @@
+#ifndef LIGHTNVR_MOTION_KERNELS_H
+#define LIGHTNVR_MOTION_KERNELS_H
+
+#include <stdint.h>
+
+/**
+ * Pixel kernels used by motion detection
+ *
+ * Each kernel set implements the same operations; the scalar set is the
+ * reference implementation and every vectorized set must produce
+ * bit-identical output.  motion_kernels_get() picks the best set for the
+ * running CPU once, at first use.
+ *
+ * All planes are 8-bit single channel.  Unless a stride is given, buffers are
+ * tightly packed (stride == width).
+ */
+typedef struct {
+    const char *name;
+
+    /**
+     * Convert packed RGB24 to grayscale: (76*R + 150*G + 29*B) >> 8
+     */
+    void (*rgb_to_gray)(const uint8_t *rgb, uint8_t *gray, int npixels);
+
+    /**
+     * Block-average downscale by an integer factor
+     *
+     * Output pixel (x, y) is the mean of the source pixels in block
+     * [x*factor, x*factor+factor) x [y*factor, y*factor+factor) clipped to the
+     * source; blocks that fall entirely outside the source are set to 0.
+     */
+    void (*downscale)(const uint8_t *src, int src_stride, int width, int height, int factor,
+                      uint8_t *dst, int dst_width, int dst_height);
+
+    /**
+     * Separable box blur (horizontal pass then vertical pass)
+     *
+     * Each pass averages the window [i-radius, i+radius] clipped to the image,
+     * truncating.  Both passes use running sums, so the cost per pixel does not
+     * grow with radius.  tmp must hold width*height bytes.  radius <= 0 copies
+     * src.
+     */
+    void (*box_blur)(const uint8_t *src, uint8_t *dst, uint8_t *tmp,
+                     int width, int height, int radius);
+
+    /**
+     * Running-average background update: bg = ((256-alpha)*bg + alpha*cur) >> 8
+     *
+     * alpha is the learning rate in 8-bit fixed point (0-256).
+     */
+    void (*update_background)(uint8_t *bg, const uint8_t *cur, int npixels, int alpha);
+
+    /**
+     * Sum of thresholded frame/background differences over every other pixel
+     *
+     * For i = 0, 2, 4, ... < n: diff = max(|curr-prev|, |curr-bg|); pixels with
+     * diff > threshold add diff to the returned sum and 1 to *changed.
+     */
+    uint32_t (*diff_sum)(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                         int n, int threshold, int *changed);
+
+    /**
+     * Thresholded frame/background differences of every other pixel
+     *
+     * Same per-pixel rule as diff_sum, but writes out[i/2] = diff (or 0 when
+     * diff <= threshold) for i = 0, 2, 4, ... < n.  out must hold (n+1)/2
+     * bytes.  Used to feed the integral image behind grid motion scoring.
+     */
+    void (*diff_row)(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                     int n, int threshold, uint8_t *out);
+} motion_kernels_t;
+
+/**
+ * Get the fastest kernel set supported by this CPU
+ *
+ * @return Kernel set (never NULL; falls back to the scalar set)
+ */
+const motion_kernels_t *motion_kernels_get(void);
+
+/**
+ * Get the scalar reference kernel set
+ */
+const motion_kernels_t *motion_kernels_scalar(void);
+
+/**
+ * List every kernel set this CPU can run, scalar first
+ *
+ * @param out Output array of kernel set pointers
+ * @param max Capacity of out
+ * @return Number of entries written
+ */
+int motion_kernels_available(const motion_kernels_t **out, int max);
+
+#endif /* LIGHTNVR_MOTION_KERNELS_H */
@@ -10,6 +10,7 @@
 #include <pthread.h>
 #include "core/config.h"  // For MAX_PATH_LENGTH and MAX_STREAM_NAME
 #include "video/mp4_writer_thread.h"
+#include "video/keyframe_index.h"
 
 /**
  * MP4 writer structure
@@ -50,6 +51,7 @@ struct mp4_writer {
     int waiting_for_keyframe; // Flag indicating if we're waiting for a keyframe to rotate
     int is_rotating;          // Flag indicating if rotation is in progress
     char output_dir[MAX_PATH_LENGTH]; // Directory where MP4 files are stored
+    int fragmented;           // Write fragmented MP4 (append-only) instead of faststart
 
     // Recording trigger type
     char trigger_type[16];    // 'scheduled', 'detection', 'motion', 'manual'
@@ -75,6 +77,10 @@ struct mp4_writer {
     // Used by mp4_writer_initialize() instead of reconstructing from sample_rate,
     // which may be 0 for some pass-through codecs.
     AVRational pending_audio_time_base;
+
+    // Keyframe wall-clock times collected for the .kfi sidecar; resolved
+    // against the finalized file in mp4_writer_close()
+    keyframe_index_recorder_t *keyframe_index;
 };
 
 /**
@@ -141,6 +147,18 @@ void mp4_writer_set_audio(mp4_writer_t *writer, int enable);
  */
 void mp4_writer_set_segment_duration(mp4_writer_t *writer, int segment_duration);
 
+/**
+ * Select the container layout for new segments
+ *
+ * Fragmented MP4 is written append-only (one fragment per keyframe) and is
+ * never rewritten when the segment is closed; regular MP4 relocates the moov
+ * atom to the front of the file (faststart).
+ *
+ * @param writer The MP4 writer instance
+ * @param format "fmp4" for fragmented MP4, anything else for regular MP4
+ */
+void mp4_writer_set_recording_format(mp4_writer_t *writer, const char *format);
+
 // Rotation is now handled entirely by the writer thread in mp4_writer_rtsp.c
 
 /**
@@ -34,6 +34,7 @@ typedef struct {
     int segment_index;
     bool has_audio;
     bool last_frame_was_key;  // Flag to indicate if the last frame of previous segment was a key frame
+    bool fragmented;          // Write the next segment as fragmented MP4 instead of faststart
 
     // If set, the next segment should start by writing this packet first.
     // This intentionally duplicates the boundary keyframe to bias toward overlap (no gaps).
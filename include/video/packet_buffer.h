@@ -23,6 +23,12 @@
  * - Memory-efficient packet storage
  * - Thread-safe operations
  * - Optional disk-based fallback for resource-constrained systems
+ * - Pooled mode: packet data copied into one per-stream byte ring with
+ *   metadata in flat arrays, so steady-state buffering does no malloc/free
+ * - Global admission control: the pool splits its memory limit into
+ *   per-stream budgets by priority, shrinking low-priority pre-rolls first
+ *   and spilling a buffer to a disk-backed (mmap) strategy when RAM cannot
+ *   hold even its minimum pre-roll
  */
 
 // Maximum buffer size in seconds
@@ -30,11 +36,20 @@
 #define MIN_BUFFER_SECONDS 5
 #define DEFAULT_BUFFER_SECONDS 5
 
+// Admission control: pre-roll every buffer keeps in RAM before the pool
+// starts spilling buffers to disk, and how often budgets are recomputed
+#define PACKET_BUFFER_MIN_PREROLL_SECONDS 2
+#define PACKET_BUFFER_REBALANCE_INTERVAL 1
+#define PACKET_BUFFER_DEFAULT_PRIORITY 5
+
+struct pre_buffer_strategy;
+
 // Buffer storage modes
 typedef enum {
     BUFFER_MODE_MEMORY = 0,     // Store packets in memory (default)
     BUFFER_MODE_DISK = 1,       // Store packets on disk (for low-memory systems)
-    BUFFER_MODE_HYBRID = 2      // Use memory with disk fallback
+    BUFFER_MODE_HYBRID = 2,     // Use memory with disk fallback
+    BUFFER_MODE_MEMORY_POOLED = 3 // Store packet data in a per-stream byte ring (no per-packet allocation)
 } buffer_mode_t;
 
 // Buffered packet structure
@@ -48,6 +63,40 @@ typedef struct {
     size_t data_size;           // Size of packet data
 } buffered_packet_t;
 
+/**
+ * Packet ring used by BUFFER_MODE_MEMORY_POOLED
+ *
+ * Packet payloads are copied back to back into one byte ring (records never
+ * straddle the end; skipped tail bytes are charged to the next record).
+ * Per-packet metadata lives in flat arrays indexed like the packet ring, so
+ * adding and evicting a packet is a memcpy plus index arithmetic.  The byte
+ * ring grows (up to PACKET_RING_MAX_BYTES) only while the buffer warms up.
+ * The whole ring is charged to the pool, so it never grows past the
+ * buffer's budget.  It shrinks when the budget drops and is released while
+ * the buffer spills to disk.
+ */
+#define PACKET_RING_INITIAL_BYTES ((size_t)1024 * 1024)
+#define PACKET_RING_MAX_BYTES ((size_t)64 * 1024 * 1024)
+
+typedef struct {
+    uint8_t *data;              // Byte ring holding packet payloads
+    size_t capacity;            // Size of data in bytes
+    size_t head;                // Next write offset
+    size_t used;                // Bytes in use, including wrap padding
+
+    // Struct-of-arrays index, max_packets entries each
+    size_t *offset;             // Payload offset in data
+    uint32_t *size;             // Payload size
+    uint32_t *span;             // Payload size plus any wrap padding before it
+    int64_t *pts;
+    int64_t *dts;
+    int64_t *duration;
+    time_t *timestamp;          // Wall clock capture time
+    int *stream_index;
+    int *flags;                 // AVPacket flags
+    AVPacket **side_data_pkt;   // Clone for the rare packet carrying side data, else NULL
+} packet_ring_t;
+
 // Circular buffer structure
 typedef struct {
     char stream_name[256];      // Stream name for this buffer
@@ -58,10 +107,12 @@ typedef struct {
     buffer_mode_t mode;         // Storage mode
 
     // Circular buffer
-    buffered_packet_t *packets; // Array of buffered packets
+    buffered_packet_t *packets; // Array of buffered packets (NULL in pooled mode)
+    packet_ring_t ring;         // Packet storage in pooled mode
     int head;                   // Write position
     int tail;                   // Read position
     int count;                  // Number of packets in buffer
+    int keyframe_count;         // Keyframes currently buffered
 
     // Statistics
     uint64_t total_packets_buffered;    // Total packets buffered
@@ -69,6 +120,19 @@ typedef struct {
     uint64_t total_bytes_buffered;      // Total bytes buffered
     size_t current_memory_usage;        // Current memory usage in bytes
     size_t peak_memory_usage;           // Peak memory usage in bytes
+    uint64_t total_packets_shed;        // Packets evicted to stay within the memory budget
+
+    // Admission control.  Budget, demand and spill flag are shared with the
+    // pool policy without taking this buffer's mutex (atomic access only).
+    int priority;               // 1-10, higher keeps its pre-roll longer under pressure
+    size_t memory_limit;        // Per-buffer cap in bytes (0 = none)
+    size_t memory_budget;       // Budget assigned by the pool (0 = unlimited)
+    size_t memory_demand;       // Estimated bytes for the full buffer_seconds window
+    size_t byte_rate;           // Smoothed ingest rate in bytes per second
+    time_t rate_window_start;   // Start of the current rate measurement window
+    size_t rate_window_bytes;   // Bytes received in the current window
+    bool spill_requested;       // Pool cannot fit this buffer's minimum pre-roll in RAM
+    struct pre_buffer_strategy *spill;  // Disk-backed buffer used while spilled (NULL otherwise)
 
     // Timing information
     time_t oldest_packet_time;  // Timestamp of oldest packet in buffer
@@ -90,9 +154,21 @@ typedef struct {
     pthread_mutex_t pool_mutex;
     int active_buffers;
     size_t total_memory_limit;      // Total memory limit for all buffers
-    size_t current_memory_usage;    // Current total memory usage
+    size_t current_memory_usage;    // Current total memory usage (atomic)
+    time_t last_rebalance;          // Last time per-buffer budgets were recomputed (atomic)
 } packet_buffer_pool_t;
 
+// Per-stream admission control snapshot, reported by the metrics API
+typedef struct {
+    char stream_name[256];
+    int priority;
+    size_t memory_usage;        // Bytes held in RAM (the whole ring in pooled mode)
+    size_t memory_budget;       // Budget assigned by the pool (0 = unlimited)
+    size_t memory_demand;       // Estimated bytes for the full pre-roll
+    bool spilled;               // Packets are currently going to the disk-backed buffer
+    uint64_t packets_shed;      // Packets evicted early to stay within budget
+} packet_buffer_budget_t;
+
 /**
  * Initialize the packet buffer pool
  *
@@ -244,12 +320,49 @@ int packet_buffer_estimate_packet_count(int fps, int duration_seconds);
 /**
  * Set memory limit for a specific buffer
  *
+ * The limit caps the budget the pool assigns to this buffer.
+ *
  * @param buffer Buffer to configure
- * @param limit_mb Memory limit in MB
+ * @param limit_mb Memory limit in MB (0 = no per-buffer limit)
  * @return 0 on success, non-zero on failure
  */
 int packet_buffer_set_memory_limit(packet_buffer_t *buffer, size_t limit_mb);
 
+/**
+ * Set the priority used by the pool when memory is short
+ *
+ * Lower-priority buffers have their pre-roll shrunk, and are spilled to
+ * disk, before higher-priority ones.
+ *
+ * @param buffer Buffer to configure
+ * @param priority Stream priority 1-10 (values outside the range are clamped)
+ * @return 0 on success, non-zero on failure
+ */
+int packet_buffer_set_priority(packet_buffer_t *buffer, int priority);
+
+/**
+ * Recompute per-buffer memory budgets from the pool limit
+ *
+ * Every buffer is first granted its minimum pre-roll
+ * (PACKET_BUFFER_MIN_PREROLL_SECONDS), highest priority first; buffers whose
+ * minimum no longer fits are marked for spilling to disk.  The remaining
+ * memory is then handed out highest priority first up to each buffer's
+ * demand.  Called automatically at most every
+ * PACKET_BUFFER_REBALANCE_INTERVAL seconds while packets arrive, and when
+ * buffers, priorities or limits change.
+ */
+void packet_buffer_rebalance_pool(void);
+
+/**
+ * Snapshot admission control state for all active buffers
+ *
+ * @param budgets Output array
+ * @param max_budgets Capacity of budgets
+ * @param memory_limit Output: pool memory limit in bytes (0 = unlimited; may be NULL)
+ * @return Number of entries written
+ */
+int packet_buffer_get_budgets(packet_buffer_budget_t *budgets, int max_budgets, size_t *memory_limit);
+
 /**
  * Get total memory usage across all buffers
  *
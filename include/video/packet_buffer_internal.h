@@ -0,0 +1,65 @@
+/**
+ * Internal header for the packet buffer's disk spill
+ *
+ * When the pool cannot fit a buffer's minimum pre-roll in RAM, the buffer
+ * keeps buffering into an mmap-backed pre-detection strategy.  These
+ * wrappers keep the strategy interface (whose headers clash with streams.h)
+ * out of packet_buffer.c.
+ */
+
+#ifndef LIGHTNVR_PACKET_BUFFER_INTERNAL_H
+#define LIGHTNVR_PACKET_BUFFER_INTERNAL_H
+
+#include <time.h>
+#include <libavcodec/avcodec.h>
+#include "video/packet_buffer.h"
+
+/**
+ * Create the disk-backed spill buffer for a stream
+ *
+ * @param stream_name Stream name
+ * @param buffer_seconds Pre-roll duration in seconds
+ * @param estimated_fps Expected packet rate, used to size the index
+ * @return Spill buffer, or NULL on failure
+ */
+struct pre_buffer_strategy *packet_buffer_spill_create(const char *stream_name, int buffer_seconds,
+                                                       int estimated_fps);
+
+/**
+ * Destroy a spill buffer and remove its backing file
+ */
+void packet_buffer_spill_destroy(struct pre_buffer_strategy *spill);
+
+/**
+ * Append a packet to a spill buffer
+ *
+ * @return 0 on success, -1 on failure
+ */
+int packet_buffer_spill_add(struct pre_buffer_strategy *spill, const AVPacket *packet, time_t timestamp);
+
+/**
+ * Pass every spilled packet to callback, oldest first, then empty the spill
+ *
+ * @return Number of packets passed to callback
+ */
+int packet_buffer_spill_flush(struct pre_buffer_strategy *spill,
+                              int (*callback)(const AVPacket *packet, void *user_data),
+                              void *user_data);
+
+/**
+ * Drop every spilled packet
+ */
+void packet_buffer_spill_clear(struct pre_buffer_strategy *spill);
+
+/**
+ * Get spill buffer contents
+ *
+ * @param spill Spill buffer
+ * @param keyframes Output: keyframes buffered
+ * @param oldest Output: timestamp of the oldest packet
+ * @param newest Output: timestamp of the newest packet
+ * @return Number of packets buffered (0 on error)
+ */
+int packet_buffer_spill_stats(struct pre_buffer_strategy *spill, int *keyframes, time_t *oldest, time_t *newest);
+
+#endif /* LIGHTNVR_PACKET_BUFFER_INTERNAL_H */
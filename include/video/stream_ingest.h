@@ -0,0 +1,112 @@
+/**
+ * Per-stream shared ingest
+ *
+ * HLS streaming, MP4 recording and detection each need the demuxed packets
+ * of the same camera.  Instead of each of them opening its own RTSP session
+ * and demuxer, the first consumer of a URL starts an ingest thread that opens
+ * the source once and publishes a reference to every packet to all
+ * consumers of that URL:
+ *
+ * - each consumer has its own bounded single-producer/single-consumer ring,
+ *   so a slow consumer never stalls the source or the other consumers;
+ * - when a ring is full the packet is dropped according to the consumer's
+ *   drop policy instead of blocking the ingest thread;
+ * - packets are shared with av_packet_ref(), never copied, so every consumer
+ *   sees the same payload and the same timestamps.
+ *
+ * A consumer gets an AVFormatContext that mirrors the source's streams
+ * (codec parameters, time bases, frame rates) but has no demuxer attached.
+ * Read it with stream_ingest_read_frame() instead of av_read_frame() and
+ * close it with avformat_close_input() as usual; closing releases the
+ * subscription and the last consumer to leave stops the ingest thread.
+ *
+ * When the source disconnects, every consumer drains its ring and then gets
+ * AVERROR_EOF, so its existing reconnect path reopens the shared context once
+ * the ingest thread has reconnected.
+ */
+
+#ifndef STREAM_INGEST_H
+#define STREAM_INGEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <libavformat/avformat.h>
+
+/**
+ * What to do with a packet that arrives while a consumer's ring is full
+ */
+typedef enum {
+    STREAM_INGEST_DROP_NEWEST = 0,      // Drop the incoming packet only
+    STREAM_INGEST_DROP_TO_KEYFRAME      // Drop everything until the next video keyframe
+} stream_ingest_drop_policy_t;
+
+/**
+ * Consumer options
+ */
+typedef struct {
+    int queue_packets;                          // Ring capacity in packets (0 = default, rounded up to a power of two)
+    stream_ingest_drop_policy_t drop_policy;
+} stream_ingest_consumer_config_t;
+
+/**
+ * Statistics for one consumer
+ */
+typedef struct {
+    int source_consumers;           // Consumers currently sharing the source
+    int queued;                     // Packets waiting in this consumer's ring
+    uint64_t packets_delivered;
+    uint64_t packets_dropped;
+} stream_ingest_stats_t;
+
+#define STREAM_INGEST_DEFAULT_QUEUE_PACKETS 256
+
+/**
+ * Open a shared input for a stream
+ *
+ * Drop-in replacement for avformat_open_input() + avformat_find_stream_info():
+ * on success *ctx has the source's streams and is ready to read.  If *ctx is
+ * non-NULL it must come from avformat_alloc_context() and its interrupt
+ * callback is honoured while waiting for the source and while reading.  On
+ * failure *ctx is freed and set to NULL.
+ *
+ * @param ctx Input/output format context
+ * @param stream_name Stream name (used for logging)
+ * @param url Source URL; consumers of the same URL share one connection
+ * @param protocol STREAM_PROTOCOL_TCP or STREAM_PROTOCOL_UDP, used if this call starts the ingest
+ * @param config Consumer options (NULL = defaults, drop to keyframe)
+ * @return 0 on success, negative AVERROR on failure
+ */
+int stream_ingest_open_input(AVFormatContext **ctx, const char *stream_name, const char *url,
+                             int protocol, const stream_ingest_consumer_config_t *config);
+
+/**
+ * Check whether a format context was opened by stream_ingest_open_input()
+ *
+ * @param ctx Format context (may be NULL)
+ * @return true for a shared input
+ */
+bool stream_ingest_is_shared(const AVFormatContext *ctx);
+
+/**
+ * Read the next packet from an input context
+ *
+ * For a shared input this takes the next packet from the consumer's ring,
+ * waiting until one arrives; any other context is read with av_read_frame().
+ *
+ * @param ctx Format context
+ * @param pkt Packet to fill; the caller must av_packet_unref() it
+ * @return 0 on success, AVERROR_EOF once the source disconnected,
+ *         AVERROR_EXIT if the interrupt callback fired, other AVERROR on failure
+ */
+int stream_ingest_read_frame(AVFormatContext *ctx, AVPacket *pkt);
+
+/**
+ * Get statistics for a shared input
+ *
+ * @param ctx Format context opened by stream_ingest_open_input()
+ * @param stats Output statistics
+ * @return 0 on success, -1 if ctx is not a shared input
+ */
+int stream_ingest_get_stats(const AVFormatContext *ctx, stream_ingest_stats_t *stats);
+
+#endif /* STREAM_INGEST_H */
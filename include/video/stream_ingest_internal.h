@@ -0,0 +1,71 @@
+/**
+ * Internal header for the shared ingest consumer rings
+ *
+ * Exposed so the ring and drop policies can be tested without a live
+ * source.  Each ring has exactly one producer (the ingest thread) and one
+ * consumer (the thread reading the shared input).
+ */
+
+#ifndef LIGHTNVR_STREAM_INGEST_INTERNAL_H
+#define LIGHTNVR_STREAM_INGEST_INTERNAL_H
+
+#include <stdbool.h>
+#include <libavcodec/avcodec.h>
+#include <libavformat/avio.h>
+#include "video/stream_ingest.h"
+
+typedef struct stream_ingest_queue stream_ingest_queue_t;
+
+/**
+ * Create a consumer ring
+ *
+ * A new ring drops everything until the first video keyframe, so a consumer
+ * joining a running source never starts mid-GOP.
+ *
+ * @param config Consumer options (NULL = defaults)
+ * @return Ring, or NULL on failure
+ */
+stream_ingest_queue_t *stream_ingest_queue_create(const stream_ingest_consumer_config_t *config);
+
+/**
+ * Destroy a ring and free any packets still queued
+ */
+void stream_ingest_queue_destroy(stream_ingest_queue_t *queue);
+
+/**
+ * Queue a new reference to a packet (producer side)
+ *
+ * @param queue Ring
+ * @param pkt Packet to reference
+ * @param is_video Whether the packet belongs to a video stream
+ * @return 1 if queued, 0 if dropped by the drop policy, -1 on error
+ */
+int stream_ingest_queue_push(stream_ingest_queue_t *queue, const AVPacket *pkt, bool is_video);
+
+/**
+ * Take the next packet (consumer side)
+ *
+ * @param queue Ring
+ * @param pkt Packet to fill
+ * @param interrupt Interrupt callback to poll while waiting (may be NULL)
+ * @param timeout_ms Maximum time to wait (0 = do not wait)
+ * @return 0 on success, AVERROR(EAGAIN) on timeout, AVERROR_EOF once the ring
+ *         is empty and the source was lost, AVERROR_EXIT if interrupted
+ */
+int stream_ingest_queue_pop(stream_ingest_queue_t *queue, AVPacket *pkt,
+                            const AVIOInterruptCB *interrupt, int timeout_ms);
+
+/**
+ * Mark the source as lost (producer side)
+ *
+ * Packets already queued are still delivered; after that every pop returns
+ * AVERROR_EOF and further pushes are dropped.
+ */
+void stream_ingest_queue_mark_lost(stream_ingest_queue_t *queue);
+
+/**
+ * Get ring statistics (source_consumers is left untouched)
+ */
+void stream_ingest_queue_stats(stream_ingest_queue_t *queue, stream_ingest_stats_t *stats);
+
+#endif /* LIGHTNVR_STREAM_INGEST_INTERNAL_H */
@@ -16,6 +16,16 @@ bool is_onvif_stream(const char *url);
 // Open input stream with appropriate options based on protocol
 int open_input_stream(AVFormatContext **input_ctx, const char *url, int protocol);
 
+// Same, but the open and stream probe also stop when interrupt->callback
+// returns nonzero (the shutdown check is then up to that callback), and
+// overrides (may be NULL) replace the protocol defaults
+int open_input_stream_interruptible(AVFormatContext **input_ctx, const char *url, int protocol,
+                                    const AVIOInterruptCB *interrupt, const AVDictionary *overrides);
+
+// Add the options the MP4 recorder opens its camera connection with:
+// unbuffered low-delay reads, regenerated PTS and a 5 s / 5 MB probe
+void set_recording_input_options(AVDictionary **options);
+
 // Find video stream index in the input context
 int find_video_stream_index(const AVFormatContext *input_ctx);
 
@@ -0,0 +1,86 @@
+/**
+ * In-process recording thumbnail engine
+ *
+ * Renders a JPEG thumbnail from a recording without spawning ffmpeg: the
+ * file is opened with libavformat, seeked to the keyframe at or before the
+ * requested time, one frame is decoded, downscaled with a per-thread cached
+ * scaler and encoded with a per-thread JPEG encoder.
+ *
+ * Encoded thumbnails are kept in a small LRU memory cache that sits in front
+ * of the on-disk thumbnail directory.
+ */
+
+#ifndef THUMBNAIL_ENGINE_H
+#define THUMBNAIL_ENGINE_H
+
+#include <stddef.h>
+
+#define THUMBNAIL_DEFAULT_WIDTH 320
+#define THUMBNAIL_DEFAULT_QUALITY 75
+#define THUMBNAIL_CACHE_DEFAULT_BYTES (8 * 1024 * 1024)
+
+/**
+ * Render a thumbnail to memory
+ *
+ * @param input_path Recording file
+ * @param seek_seconds Position in the recording (clamped to 0)
+ * @param width Output width; height keeps the aspect ratio.  Frames narrower
+ *              than width are not upscaled
+ * @param quality JPEG quality (1-100)
+ * @param jpeg Output: JPEG data the caller must free()
+ * @param jpeg_size Output: JPEG size in bytes
+ * @return 0 on success, -1 on failure
+ */
+int thumbnail_engine_render(const char *input_path, double seek_seconds, int width, int quality,
+                            unsigned char **jpeg, size_t *jpeg_size);
+
+/**
+ * Release the calling thread's cached scaler, pixel buffer and JPEG encoder
+ *
+ * Worker threads call this before exiting.
+ */
+void thumbnail_engine_thread_cleanup(void);
+
+/**
+ * Set the memory cache budget, evicting least recently used entries to fit
+ *
+ * @param max_bytes Total bytes of JPEG data to keep (0 disables the cache)
+ */
+void thumbnail_cache_set_limit(size_t max_bytes);
+
+/**
+ * Look up a cached thumbnail and mark it most recently used
+ *
+ * @param key Cache key (the thumbnail's on-disk path)
+ * @param data Output: copy of the JPEG data the caller must free()
+ * @param size Output: JPEG size in bytes
+ * @return 0 on hit, -1 on miss
+ */
+int thumbnail_cache_get(const char *key, unsigned char **data, size_t *size);
+
+/**
+ * Insert or replace a cached thumbnail (the data is copied)
+ *
+ * @return 0 on success, -1 if the entry does not fit or on allocation failure
+ */
+int thumbnail_cache_put(const char *key, const unsigned char *data, size_t size);
+
+/**
+ * Drop a cached thumbnail
+ */
+void thumbnail_cache_remove(const char *key);
+
+/**
+ * Drop every cached thumbnail
+ */
+void thumbnail_cache_clear(void);
+
+/**
+ * Get memory cache usage
+ *
+ * @param entries Output: number of cached thumbnails (may be NULL)
+ * @param bytes Output: bytes of JPEG data cached (may be NULL)
+ */
+void thumbnail_cache_get_usage(int *entries, size_t *bytes);
+
+#endif /* THUMBNAIL_ENGINE_H */
@@ -30,6 +30,11 @@
 // Maximum number of unified detection threads
 #define MAX_UNIFIED_DETECTION_THREADS MAX_STREAMS
 
+// Number of reusable RGB output buffers kept per stream for detection frames
+#define UDT_FRAME_POOL_SIZE 2
+
+struct SwsContext;
+
 /**
  * Thread state machine states
  */
@@ -44,6 +49,18 @@ typedef enum {
     UDT_STATE_STOPPED            // Thread has stopped
 } unified_detection_state_t;
 
+/**
+ * Decode strategy for detection frames
+ *
+ * Decoding a P-frame needs every reference since the last keyframe, so the
+ * only cheap way to get a clean frame is to decode keyframes alone.
+ */
+typedef enum {
+    UDT_DECODE_KEYFRAMES = 0,    // Decode keyframes only; detection runs on keyframes once the interval elapses
+    UDT_DECODE_GOP,              // Decode the keyframe of every Nth GOP; detection runs on each of them
+    UDT_DECODE_FULL              // Decode every frame; detection runs on the latest frame once the interval elapses
+} udt_decode_mode_t;
+
 /**
  * Unified Detection Thread Context
  * 
@@ -67,6 +84,9 @@ typedef struct {
     detection_model_t model;
     float detection_threshold;
     int detection_interval;  // Seconds between detection checks
+    int priority;            // Stream priority 1-10, used for buffer budgets and inference scheduling
+    udt_decode_mode_t decode_mode;  // How video is decoded for detection
+    int decode_gop_interval;        // N for UDT_DECODE_GOP (>= 1)
     
     // Buffer configuration
     int pre_buffer_seconds;   // Seconds to keep before detection
@@ -95,6 +115,7 @@ typedef struct {
     
     // Audio recording configuration
     bool record_audio;  // Whether to include audio in recordings
+    char recording_format[16];  // "mp4" or "fmp4" (fragmented) for detection recordings
 
     // External motion trigger: set to 1 by unified_detection_notify_motion() when
     // an ONVIF-managed master stream propagates its motion event to this UDT-managed
@@ -152,7 +173,29 @@ typedef struct {
     AVCodecContext *decoder_ctx;
     int video_stream_idx;
     int audio_stream_idx;
+    uint64_t keyframes_seen;     // Video keyframes since connect (drives UDT_DECODE_GOP)
+    AVFrame *latest_frame;       // Most recent decoded frame (UDT_DECODE_FULL only)
+    uint64_t frames_decoded;     // Frames decoded for detection / the frame bus
     
+    // Detection frame conversion cache (owned exclusively by the UDT thread).
+    // The scaler and the RGB24 output buffers are keyed by the decoded frame's
+    // width, height and pixel format, and are rebuilt only when one of those
+    // changes, so the per-detection path never calls sws_getContext()/malloc().
+    // Released when the thread exits.
+    struct SwsContext *sws_ctx;
+    int sws_src_width;
+    int sws_src_height;
+    int sws_src_format;                          // enum AVPixelFormat of the source
+    uint8_t *frame_pool[UDT_FRAME_POOL_SIZE];    // av_malloc'd (aligned) RGB24 buffers
+    size_t frame_pool_buf_size;                  // size in bytes of each frame_pool entry
+    int frame_pool_next;                         // next frame_pool slot to hand out
+
+    // Conversion cache counters, readable from any thread
+    atomic_ullong scaler_rebuilds;       // sws_getContext() calls made
+    atomic_ullong scaler_reuses;         // sws_getContext() calls avoided
+    atomic_ullong frame_buffer_allocs;   // frame_pool allocations made
+    atomic_ullong frame_buffer_reuses;   // frame_pool allocations avoided
+
     // Statistics
     uint64_t total_packets_processed;
     uint64_t total_detections;
@@ -287,6 +330,39 @@ int get_unified_detection_stats(const char *stream_name,
                                 uint64_t *detections,
                                 uint64_t *recordings);
 
+/**
+ * Detection frame conversion cache statistics for a unified detection thread
+ */
+typedef struct {
+    uint64_t scaler_rebuilds;      // Scaler (re)creations, e.g. first frame or resolution change
+    uint64_t scaler_reuses;        // Frames converted with the cached scaler
+    uint64_t buffer_allocs;        // RGB buffer allocations
+    uint64_t buffer_reuses;        // Frames converted into an already-allocated buffer
+} udt_frame_cache_stats_t;
+
+/**
+ * Get detection frame conversion cache statistics for a unified detection thread
+ *
+ * @param stream_name Name of the stream
+ * @param stats Output: cache statistics
+ * @return 0 on success, -1 if not found
+ */
+int get_unified_detection_frame_cache_stats(const char *stream_name,
+                                            udt_frame_cache_stats_t *stats);
+
+/**
+ * Parse a stream's detection_decode_mode setting
+ *
+ * @param mode "keyframes", "gop" or "full" (case-insensitive)
+ * @return Matching decode mode; UDT_DECODE_KEYFRAMES for NULL, empty or unknown values
+ */
+udt_decode_mode_t udt_decode_mode_from_string(const char *mode);
+
+/**
+ * Get the configuration string for a decode mode
+ */
+const char *udt_decode_mode_to_string(udt_decode_mode_t mode);
+
 /**
  * Notify a UDT-managed stream of an externally-detected motion event.
  *
@@ -7,7 +7,8 @@
  * Filter detections based on configured zones for a stream
  *
  * This function:
- * 1. Loads zones for the stream from the database
+ * 1. Gets the stream's compiled zones, loading them from the database only
+ *    when the zones table has changed since they were last compiled
  * 2. Filters detections to only include those within enabled zones
  * 3. Applies per-zone class filters and confidence thresholds
  * 4. Sets the zone_id field for each accepted detection
@@ -40,6 +41,8 @@ int filter_detections_by_stream_objects(const char *stream_name, detection_resul
  *
  * For each grid cell, checks whether the cell center (in normalized 0-1
  * coordinates) falls inside any enabled zone polygon for the given stream.
+ * Uses the same compiled zones as filter_detections_by_zones(), so calling
+ * this per frame does not touch the database.
  *
  * If no zones are configured or no zones are enabled, all mask entries are
  * set to true (i.e. the entire frame is considered active).
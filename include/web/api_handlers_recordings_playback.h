@@ -23,4 +23,16 @@ void handle_recordings_playback(const http_request_t *req, http_response_t *res)
  */
 void handle_recordings_download(const http_request_t *req, http_response_t *res);
 
+/**
+ * @brief Backend-agnostic handler for GET /api/recordings/keyframe/:id
+ *
+ * Returns the byte range of the GOP containing a wall-clock time (?t=) or a
+ * position in the recording (?offset=), read from the recording's keyframe
+ * index sidecar.
+ *
+ * @param req HTTP request
+ * @param res HTTP response
+ */
+void handle_recordings_keyframe(const http_request_t *req, http_response_t *res);
+
 #endif // API_HANDLERS_RECORDINGS_PLAYBACK_H
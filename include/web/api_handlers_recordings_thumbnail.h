@@ -12,7 +12,7 @@
  * @brief Backend-agnostic handler for GET /api/recordings/thumbnail/:id/:index
  * 
  * Serves a thumbnail image for a recording. If the thumbnail doesn't exist yet,
- * generates it on-the-fly using ffmpeg and caches it to disk.
+ * renders it in-process and caches it in memory and on disk.
  * 
  * Index 0 = start frame, 1 = middle frame, 2 = end frame.
  * Thumbnails are stored in {storage_path}/thumbnails/{id}_{index}.jpg
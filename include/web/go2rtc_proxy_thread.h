@@ -1,13 +1,13 @@
 /**
  * @file go2rtc_proxy_thread.h
- * @brief One-and-done proxy threads for go2rtc reverse proxy
+ * @brief Event-loop reverse proxy for go2rtc
  *
- * Instead of using the shared libuv worker thread pool (which can be
- * exhausted by long-running curl requests), each proxy request spawns
- * a short-lived detached pthread.  The thread performs the blocking
- * curl call, enqueues the result on a lock-free done list, and wakes
- * the event loop via uv_async_send so the response is sent from the
- * loop thread (as libuv requires).
+ * Proxy requests run as transfers on a curl multi handle driven by the
+ * server's event loop, so they neither spawn threads nor occupy the shared
+ * libuv worker pool (which long-running requests could exhaust).  The
+ * connections to go2rtc are pooled and kept alive, and response bodies are
+ * streamed to the client as they arrive, with the upstream transfer paused
+ * while the client falls behind.
  */
 
 #ifndef GO2RTC_PROXY_THREAD_H
@@ -20,7 +20,7 @@
 #include "web/libuv_server.h"
 
 /**
- * Initialise the proxy async mechanism.
+ * Initialise the curl multi handle and its timer.
  * Must be called once from the event-loop thread after the loop is running.
  *
  * @param loop  The libuv event loop
@@ -29,9 +29,8 @@
 int go2rtc_proxy_thread_init(uv_loop_t *loop);
 
 /**
- * Submit a proxy request.  A detached thread is spawned to perform the
- * blocking curl call.  When complete the event loop is woken and the
- * response is sent from the loop thread.
+ * Submit a proxy request.  The response is streamed to the connection from
+ * the event loop, which also handles keep-alive or close once it is sent.
  *
  * The caller must have already stopped reading on the connection and
  * paused the HTTP parser.
@@ -44,9 +43,14 @@ int go2rtc_proxy_thread_submit(libuv_connection_t *conn,
                                write_complete_action_t action);
 
 /**
- * Shut down: close the uv_async handle.
- * Any in-flight threads will still complete but their results are discarded
- * (the connection will already be torn down by libuv shutdown).
+ * Detach a connection that is being destroyed from its proxy request, which
+ * is aborted.  Must be called from the event-loop thread.
+ */
+void go2rtc_proxy_detach(libuv_connection_t *conn);
+
+/**
+ * Shut down: abort remaining transfers, close the pooled connections and
+ * the timer.  Connections are already torn down by the libuv shutdown.
  */
 void go2rtc_proxy_thread_shutdown(void);
 
@@ -0,0 +1,68 @@
+/**
+ * @file hls_blocking_reload.h
+ * @brief LL-HLS blocking playlist reloads parked on the event loop
+ *
+ * A low-latency player asks for the playlist (or the part named in the
+ * preload hint) before it exists, and the server holds the request until
+ * the HLS writer publishes it.  The handler only decides that a request has
+ * to wait; once back on the loop thread the connection is parked in a list
+ * that is re-checked whenever a writer publishes a part (via uv_async), so
+ * no thread-pool worker stays busy for a waiting client.
+ */
+
+#ifndef HLS_BLOCKING_RELOAD_H
+#define HLS_BLOCKING_RELOAD_H
+
+#ifdef HTTP_BACKEND_LIBUV
+
+#include <stdint.h>
+#include <uv.h>
+#include "web/libuv_server.h"
+
+/**
+ * @brief Builds the response for a parked request (runs on the loop thread)
+ *
+ * @param res Response to fill in
+ * @param stream_name Stream the request is for
+ * @param file_name Requested file (playlist or part)
+ * @param result 0 when the request can be answered, -1 if it timed out
+ */
+typedef void (*hls_reload_respond_t)(http_response_t *res, const char *stream_name,
+                                     const char *file_name, int result);
+
+/**
+ * Initialise the wake-up handle and the timeout timer
+ *
+ * @param loop The libuv event loop
+ * @return 0 on success, -1 on error
+ */
+int hls_blocking_reload_init(uv_loop_t *loop);
+
+/**
+ * Close the handles and drop parked requests (their connections are torn
+ * down by the server shutdown)
+ */
+void hls_blocking_reload_shutdown(void);
+
+/**
+ * Mark a request as blocking until part @p part of segment @p msn exists
+ *
+ * Called by the handler on the worker thread; the request is parked by
+ * hls_blocking_reload_start() once the handler has returned.
+ *
+ * @param part Requested part, or -1 to wait for the whole segment
+ * @return 0 on success, -1 on error (the handler should answer right away)
+ */
+int hls_blocking_reload_defer(libuv_connection_t *conn, const char *stream_name,
+                              const char *file_name, int64_t msn, int part,
+                              hls_reload_respond_t respond);
+
+/**
+ * Park (or immediately answer) the request deferred on @p conn
+ *
+ * Must be called from the event-loop thread.
+ */
+void hls_blocking_reload_start(libuv_connection_t *conn);
+
+#endif /* HTTP_BACKEND_LIBUV */
+#endif /* HLS_BLOCKING_RELOAD_H */
@@ -91,8 +91,12 @@ void http_server_destroy(http_server_handle_t server);
 /**
  * @brief Register request handler
  * 
+ * '#' in the path matches one segment and is captured as a path parameter
+ * (see http_request_get_path_param); a trailing '*' matches the rest of the
+ * path. If several routes match, the one registered first is used.
+ *
  * @param server Server handle
- * @param path Request path
+ * @param path Request path pattern
  * @param method HTTP method or NULL for any method
  * @param handler Request handler function
  * @return int 0 on success, non-zero on error
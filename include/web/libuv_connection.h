@@ -159,6 +159,14 @@ bool libuv_parse_range_header(const char *range_header, size_t file_size,
  */
 const char *libuv_get_mime_type(const char *path);
 
+/**
+ * @brief Get the reason phrase for an HTTP status code
+ *
+ * @param status_code HTTP status code
+ * @return const char* Reason phrase (static string, "Unknown" if not listed)
+ */
+const char *libuv_get_status_phrase(int status_code);
+
 #endif /* HTTP_BACKEND_LIBUV */
 
 #endif /* LIBUV_CONNECTION_H */
@@ -15,6 +15,7 @@
 #include <uv.h>
 #include "web/http_server.h"
 #include "web/request_response.h"
+#include "web/route_trie.h"
 
 /**
  * @brief libuv server internal structure
@@ -28,14 +29,8 @@ typedef struct libuv_server {
     bool owns_loop;                     // Whether we own the event loop
     volatile bool shutting_down;        // Server is shutting down (volatile for cross-thread visibility)
 
-    // Handler registry (same structure as http_server_t)
-    struct {
-        char path[256];                 // Request path pattern
-        char method[16];                // HTTP method or empty for any
-        request_handler_t handler;      // Request handler function
-    } *handlers;
-    int handler_count;                  // Number of registered handlers
-    int handler_capacity;               // Capacity of handlers array
+    // Handler registry, compiled into a segment trie at registration
+    route_trie_t routes;
 
     // TLS context (optional, NULL if TLS disabled)
     void *tls_ctx;
@@ -94,6 +89,9 @@ typedef struct libuv_connection {
     char deferred_file_path[MAX_PATH_LENGTH]; // Deferred file path to serve
     char deferred_content_type[128];    // Deferred content type (empty = auto-detect)
     char deferred_extra_headers[512];   // Deferred extra headers (empty = none)
+    struct hls_reload_waiter *deferred_hls_reload; // LL-HLS request to park once back on loop thread
+    struct zip_stream_ctx *zip_stream;  // Batch ZIP download deferred to / streaming on the loop thread
+    struct proxy_transfer *proxy_transfer; // go2rtc proxy request streaming to this connection
     write_complete_action_t deferred_action; // Action to take after async response completes
 } libuv_connection_t;
 
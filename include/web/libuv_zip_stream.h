@@ -0,0 +1,49 @@
+/**
+ * @file libuv_zip_stream.h
+ * @brief Stream a ZIP archive of files straight to a libuv connection
+ *
+ * The archive is never assembled anywhere: each file is read in chunks on
+ * the libuv thread pool, its CRC-32 is updated on the same pass, and the
+ * chunk is written to the socket.  The next chunk is only read once the
+ * previous write has completed, so a slow client holds at most one chunk
+ * in memory and no temporary file is needed.
+ */
+
+#ifndef LIBUV_ZIP_STREAM_H
+#define LIBUV_ZIP_STREAM_H
+
+#ifdef HTTP_BACKEND_LIBUV
+
+#include "web/libuv_server.h"
+#include "web/zip_stream.h"
+
+/**
+ * Hand an archive to the connection to be streamed once the handler returns
+ *
+ * Called by the handler on the worker thread; streaming starts from
+ * libuv_zip_stream_start().  Ownership of @p zs passes to the stream on
+ * success.
+ *
+ * @param extra_headers Additional response headers (e.g. Content-Disposition), or NULL
+ * @return 0 on success, -1 on error (@p zs is left to the caller)
+ */
+int libuv_zip_stream_defer(libuv_connection_t *conn, zip_stream_t *zs,
+                           const char *extra_headers);
+
+/**
+ * Send the response headers and start streaming the deferred archive
+ *
+ * Must be called from the event-loop thread.
+ */
+void libuv_zip_stream_start(libuv_connection_t *conn);
+
+/**
+ * Detach a connection that is being destroyed from its stream
+ *
+ * An archive that never started is freed; a running one notices on its
+ * next callback and cleans up.
+ */
+void libuv_zip_stream_detach(libuv_connection_t *conn);
+
+#endif /* HTTP_BACKEND_LIBUV */
+#endif /* LIBUV_ZIP_STREAM_H */
@@ -13,6 +13,9 @@
 // Maximum query string parameters
 #define MAX_QUERY_PARAMS 32
 
+// Maximum '#' segments captured from a route pattern
+#define MAX_PATH_PARAMS 4
+
 // HTTP methods (prefixed with HTTP_METHOD_ to avoid conflicts with llhttp)
 typedef enum {
     HTTP_METHOD_GET,
@@ -46,6 +49,11 @@ typedef struct {
     http_header_t headers[MAX_HEADERS];    // Array of headers (inline, no alloc needed)
     int num_headers;                       // Number of headers
     char client_ip[64];                    // Client IP address
+    int num_path_params;                   // Number of '#' segments captured by the router
+    struct {
+        uint16_t offset;                   // Offset of the segment in path
+        uint16_t length;                   // Raw (still URL-encoded) length
+    } path_params[MAX_PATH_PARAMS];
     void *user_data;                       // User data pointer (e.g., http_server_t*)
 } http_request_t;
 
@@ -102,6 +110,21 @@ int http_request_get_body_str(const http_request_t *req, char *buf, size_t buf_l
 int http_request_extract_path_param(const http_request_t *req, const char *prefix,
                                      char *param_buf, size_t buf_size);
 
+/**
+ * @brief Get a URL-decoded path parameter captured by the router
+ *
+ * Parameters are the '#' segments of the matched route pattern, in order,
+ * e.g. index 0 of "/api/streams/#/zones" is the stream name.
+ *
+ * @param req HTTP request
+ * @param index Zero-based parameter index
+ * @param param_buf Buffer to store the decoded parameter
+ * @param buf_size Size of the buffer
+ * @return 0 on success, -1 if missing, empty or too long
+ */
+int http_request_get_path_param(const http_request_t *req, int index,
+                                char *param_buf, size_t buf_size);
+
 /**
  * @brief Add a header to the response
  * @param res HTTP response
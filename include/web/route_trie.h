@@ -0,0 +1,70 @@
+/**
+ * @file route_trie.h
+ * @brief Segment-keyed radix tree for HTTP route dispatch
+ *
+ * Route patterns are split on '/' when registered and stored one segment
+ * per node, with a handler table per node indexed by HTTP method.  Two
+ * wildcards are supported, each of which must be a whole segment:
+ *   - '#' matches exactly one segment (anything except '/', may be empty)
+ *     and is captured as a path parameter
+ *   - '*' must be the last segment and matches the rest of the path
+ *
+ * When several routes match a request the one registered first wins, which
+ * is the same precedence as scanning the routes in registration order.
+ */
+
+#ifndef ROUTE_TRIE_H
+#define ROUTE_TRIE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "web/request_response.h"
+
+// Deepest pattern that can be registered, in segments
+#define ROUTE_MAX_SEGMENTS 32
+
+typedef struct route_node route_node_t;
+
+typedef struct {
+    route_node_t *root;
+    int route_count;
+} route_trie_t;
+
+/**
+ * Result of a successful match
+ */
+typedef struct {
+    request_handler_t handler;
+    int num_params;
+    struct {
+        uint16_t offset;    // Byte offset of the segment in the matched path
+        uint16_t length;    // Segment length (not URL-decoded)
+    } params[MAX_PATH_PARAMS];
+} route_match_t;
+
+int route_trie_init(route_trie_t *trie);
+void route_trie_free(route_trie_t *trie);
+
+/**
+ * Add a route
+ *
+ * @param pattern Path pattern starting with '/'
+ * @param method  HTTP method name, or NULL / "" to match any method
+ * @return 0 on success (a duplicate of an existing route is ignored, as the
+ *         earlier registration would always win), -1 on an invalid pattern,
+ *         unknown method or allocation failure
+ */
+int route_trie_insert(route_trie_t *trie, const char *pattern, const char *method,
+                      request_handler_t handler);
+
+/**
+ * Find the handler for a request
+ *
+ * @param path  Request path without the query string
+ * @return true with the handler and captured '#' segments in @p match
+ */
+bool route_trie_match(const route_trie_t *trie, http_method_t method, const char *path,
+                      route_match_t *match);
+
+#endif /* ROUTE_TRIE_H */
@@ -1,10 +1,12 @@
 /**
  * @file thumbnail_thread.h
- * @brief Detached pthread-based thumbnail generation with async completion
+ * @brief Worker-pool thumbnail generation with async completion
  *
- * This module offloads thumbnail generation to detached pthreads to avoid
- * blocking the libuv thread pool. When generation completes, a uv_async
- * callback is triggered to send the response back to the client.
+ * This module offloads thumbnail generation to a small pool of persistent
+ * worker threads to avoid blocking the libuv thread pool.  Workers render
+ * in-process through the thumbnail engine, store the result in the memory
+ * and disk caches, and then trigger a uv_async callback to send the
+ * response back to the client.
  */
 
 #ifndef THUMBNAIL_THREAD_H
@@ -17,7 +19,7 @@
  * @brief Opaque handle for a deferred response action
  *
  * This handle is stored in the connection and used to send the response
- * after the thumbnail generation completes on a detached pthread.
+ * after the thumbnail generation completes on a worker thread.
  * In practice, this is a pointer to the libuv_connection_t.
  */
 typedef void* deferred_action_handle_t;
@@ -39,8 +41,9 @@ typedef void (*deferred_response_callback_t)(deferred_action_handle_t handle,
 /**
  * @brief Initialize the thumbnail thread subsystem
  *
- * Must be called once during server initialization, before any thumbnail
- * requests are processed.
+ * Must be called during server initialization, before any thumbnail
+ * requests are processed, and again when the server restarts after a stop.
+ * Does nothing if the subsystem is already running.
  *
  * @param loop The libuv event loop (for uv_async callbacks)
  * @return 0 on success, -1 on error
@@ -50,16 +53,20 @@ int thumbnail_thread_init(uv_loop_t *loop);
 /**
  * @brief Shutdown the thumbnail thread subsystem
  *
- * Waits for all in-flight thumbnail generations to complete, then cleans up
- * resources. Must be called during server shutdown.
+ * Lets in-flight thumbnail generations finish and joins the workers. Then
+ * it invokes the callback of every request that hasn't been answered yet:
+ * finished ones with their result, and queued ones with -1. Finally it
+ * cleans up resources. It must run on the event loop thread while the
+ * connections still exist, i.e. after the loop has stopped and before its
+ * handles are closed. Does nothing if the subsystem isn't running.
  */
 void thumbnail_thread_shutdown(void);
 
 /**
  * @brief Submit a thumbnail generation request
  *
- * Spawns a detached pthread to generate the thumbnail. When complete, the
- * uv_async callback will invoke the callback to send the response.
+ * Queues the request for the worker pool. When complete, the uv_async
+ * callback will invoke the callback to send the response.
  *
  * @param recording_id Recording ID
  * @param index Thumbnail index (0, 1, or 2)
@@ -68,7 +75,7 @@ void thumbnail_thread_shutdown(void);
  * @param seek_seconds Seek time in the video
  * @param deferred_action Handle to the deferred response action
  * @param callback Function to call when generation completes
- * @return 0 on success (request submitted), -1 on error
+ * @return 0 on success (request queued), -1 on error or if the queue is full
  */
 int thumbnail_thread_submit(uint64_t recording_id, int index,
                             const char *input_path, const char *output_path,
@@ -76,11 +83,11 @@ int thumbnail_thread_submit(uint64_t recording_id, int index,
                             deferred_response_callback_t callback);
 
 /**
- * @brief Get the number of active thumbnail generation threads
+ * @brief Get the number of thumbnail generations currently running
  *
  * Useful for monitoring and debugging.
  *
- * @return Number of active threads
+ * @return Number of busy workers
  */
 int thumbnail_thread_get_active_count(void);
 
@@ -0,0 +1,109 @@
+#ifndef ZIP_STREAM_H
+#define ZIP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "core/config.h"
+
+/**
+ * Streaming ZIP archive layout
+ *
+ * Describes a STORED (uncompressed) ZIP archive that is produced in a single
+ * pass: each entry is written as local header, file data, data descriptor,
+ * followed by the central directory.  The CRC-32 is only known once an
+ * entry's data has gone out, so it travels in the data descriptor (flag
+ * bit 3) rather than the local header.  Sizes come from stat() up front,
+ * which fixes every offset and the total archive length before the first
+ * byte is sent.
+ *
+ * Entries of 4 GiB or more, or that start past 4 GiB, use the ZIP64 extra
+ * field, and the archive gets ZIP64 end records when its central directory
+ * does; smaller archives stay plain ZIP for older readers.
+ *
+ * Nothing here does I/O, so the layout can be tested on its own.
+ */
+
+// Largest local header or data descriptor zip_stream_local_header() and
+// zip_stream_data_descriptor() produce
+#define ZIP_STREAM_HEADER_MAX (30 + 128 + 20)
+
+typedef struct {
+    char name[128];             // Name inside the archive
+    char path[MAX_PATH_LENGTH]; // File the data is read from
+    uint64_t size;              // Bytes to store
+    uint64_t offset;            // Offset of the local header in the archive
+    uint16_t dos_time;
+    uint16_t dos_date;
+    uint32_t crc;               // Filled in while the data is streamed
+} zip_stream_entry_t;
+
+typedef struct {
+    zip_stream_entry_t *entries;
+    int count;
+    int capacity;
+    uint64_t data_end;          // Offset of the central directory
+} zip_stream_t;
+
+/**
+ * Initialize an archive with room for @p capacity entries
+ *
+ * @return 0 on success, -1 on invalid parameters or allocation failure
+ */
+int zip_stream_init(zip_stream_t *zs, int capacity);
+
+/**
+ * Release an archive
+ */
+void zip_stream_free(zip_stream_t *zs);
+
+/**
+ * Append an entry
+ *
+ * @param name Name inside the archive (truncated to 127 bytes)
+ * @param path File to read the data from
+ * @param size Bytes of the file to store
+ * @param mtime Modification time recorded for the entry (local time)
+ * @return Index of the entry, or -1 if the archive is full
+ */
+int zip_stream_add(zip_stream_t *zs, const char *name, const char *path,
+                   uint64_t size, time_t mtime);
+
+/**
+ * Total length of the archive, for Content-Length
+ */
+uint64_t zip_stream_total_size(const zip_stream_t *zs);
+
+/**
+ * Update a CRC-32 (as used by ZIP and zlib's crc32()) with more data
+ *
+ * @param crc CRC of the data so far, 0 to start
+ */
+uint32_t zip_stream_crc32(uint32_t crc, const void *data, size_t len);
+
+/**
+ * Write the local file header of an entry
+ *
+ * @param out Buffer of at least ZIP_STREAM_HEADER_MAX bytes
+ * @return Bytes written
+ */
+size_t zip_stream_local_header(const zip_stream_entry_t *e, uint8_t *out);
+
+/**
+ * Write the data descriptor that follows an entry's data (uses e->crc)
+ *
+ * @param out Buffer of at least ZIP_STREAM_HEADER_MAX bytes
+ * @return Bytes written
+ */
+size_t zip_stream_data_descriptor(const zip_stream_entry_t *e, uint8_t *out);
+
+/**
+ * Build the central directory and end records
+ *
+ * @param len Receives the length of the returned buffer
+ * @return Buffer the caller frees, or NULL on allocation failure
+ */
+uint8_t *zip_stream_build_trailer(const zip_stream_t *zs, size_t *len);
+
+#endif /* ZIP_STREAM_H */
@@ -279,6 +279,7 @@ void load_default_config(config_t *config) {
 
     // --- Runtime stream limit ---
     config->max_streams = 32; // default; overridden by [streams] max_streams in INI
+    config->shared_ingest = true;
     config->streams = calloc(config->max_streams, sizeof(stream_config_t));
     if (!config->streams) {
         // Fatal: we can't run without a streams array. Caller will detect NULL.
@@ -320,6 +321,11 @@ void load_default_config(config_t *config) {
     // Storage settings
     safe_strcpy(config->storage_path, "/var/lib/lightnvr/recordings", MAX_PATH_LENGTH, 0);
     config->storage_path_hls[0] = '\0'; // Empty by default, will use storage_path if not specified
+    config->hls_memory_store = false;
+    config->hls_memory_segments = 6;
+    config->hls_spill_segments = 0;
+    config->hls_low_latency = false;
+    config->hls_part_duration_ms = 500;
     config->max_storage_size = 0; // 0 means unlimited
     config->retention_days = 30;
     config->auto_delete_oldest = true;
@@ -335,6 +341,7 @@ void load_default_config(config_t *config) {
 
     // Models settings
     safe_strcpy(config->models_path, "/var/lib/lightnvr/models", MAX_PATH_LENGTH, 0);
+    config->sod_threads = 0;
     
     // API detection settings
     safe_strcpy(config->api_detection_url, "http://localhost:8000/detect", MAX_URL_LENGTH, 0);
@@ -438,6 +445,8 @@ void load_default_config(config_t *config) {
         config->streams[i].detection_based_recording = false;
         config->streams[i].detection_model[0] = '\0';
         config->streams[i].detection_interval = 10; // Check every 10 seconds
+        safe_strcpy(config->streams[i].detection_decode_mode, "keyframes", sizeof(config->streams[i].detection_decode_mode), 0);
+        config->streams[i].detection_decode_gop_interval = 2; // Every other GOP in "gop" mode
         config->streams[i].detection_threshold = 0.5f; // 50% confidence threshold
         config->streams[i].pre_detection_buffer = 5; // 5 seconds before detection
         config->streams[i].post_detection_buffer = 10; // 10 seconds after detection
@@ -445,6 +454,7 @@ void load_default_config(config_t *config) {
         safe_strcpy(config->streams[i].detection_object_filter, "none", sizeof(config->streams[i].detection_object_filter), 0);
         config->streams[i].streaming_enabled = true; // Enable streaming by default
         config->streams[i].record_audio = false; // Disable audio recording by default
+        safe_strcpy(config->streams[i].recording_format, "mp4", sizeof(config->streams[i].recording_format), 0);
 
         // Tiered retention defaults
         config->streams[i].tier_critical_multiplier = 3.0;
@@ -567,6 +577,26 @@ int validate_config(config_t *config) {
                  config->db_backup_retention_count);
         config->db_backup_retention_count = 0;
     }
+
+    if (config->hls_memory_segments < 2) {
+        log_warn("hls_memory_segments (%d) is below 2; clamping to 2", config->hls_memory_segments);
+        config->hls_memory_segments = 2;
+    }
+
+    if (config->hls_spill_segments < 0) {
+        log_warn("hls_spill_segments (%d) is negative; clamping to 0", config->hls_spill_segments);
+        config->hls_spill_segments = 0;
+    }
+
+    if (config->hls_part_duration_ms < 200 || config->hls_part_duration_ms > 2000) {
+        log_warn("hls_part_duration_ms (%d) is outside 200-2000; using 500", config->hls_part_duration_ms);
+        config->hls_part_duration_ms = 500;
+    }
+
+    if (config->hls_low_latency && !config->hls_memory_store) {
+        log_warn("hls_low_latency requires hls_memory; low-latency HLS disabled");
+        config->hls_low_latency = false;
+    }
     
     if (strlen(config->web_root) == 0) {
         log_error("Web root path is required");
@@ -635,6 +665,16 @@ static int config_ini_handler(void* user, const char* section, const char* name,
             safe_strcpy(config->storage_path, value, MAX_PATH_LENGTH, 0);
         } else if (strcmp(name, "path_hls") == 0) {
             safe_strcpy(config->storage_path_hls, value, MAX_PATH_LENGTH, 0);
+        } else if (strcmp(name, "hls_memory") == 0) {
+            config->hls_memory_store = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "hls_memory_segments") == 0) {
+            config->hls_memory_segments = safe_atoi(value, 6);
+        } else if (strcmp(name, "hls_spill_segments") == 0) {
+            config->hls_spill_segments = safe_atoi(value, 0);
+        } else if (strcmp(name, "hls_low_latency") == 0) {
+            config->hls_low_latency = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(name, "hls_part_duration_ms") == 0) {
+            config->hls_part_duration_ms = safe_atoi(value, 500);
         } else if (strcmp(name, "max_size") == 0) {
             config->max_storage_size = strtoull(value, NULL, 10);
         } else if (strcmp(name, "retention_days") == 0) {
@@ -657,6 +697,11 @@ static int config_ini_handler(void* user, const char* section, const char* name,
     else if (strcmp(section, "models") == 0) {
         if (strcmp(name, "path") == 0) {
             safe_strcpy(config->models_path, value, MAX_PATH_LENGTH, 0);
+        } else if (strcmp(name, "sod_threads") == 0) {
+            config->sod_threads = atoi(value);
+            if (config->sod_threads < 0) {
+                config->sod_threads = 0;
+            }
         }
     }
     // API detection settings
@@ -780,6 +825,8 @@ static int config_ini_handler(void* user, const char* section, const char* name,
                               new_max, config->max_streams);
                 }
             }
+        } else if (strcmp(name, "shared_ingest") == 0) {
+            config->shared_ingest = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
         }
     }
     // Stream-specific [stream.X] sections are no longer read from the INI file.
@@ -1562,6 +1609,14 @@ int save_config(const config_t *config, const char *path) {
     if (config->storage_path_hls[0] != '\0') {
         fprintf(file, "path_hls = %s  ; Dedicated path for HLS segments\n", config->storage_path_hls);
     }
+    fprintf(file, "hls_memory = %s  ; Serve live HLS from RAM instead of segment files\n",
+            config->hls_memory_store ? "true" : "false");
+    fprintf(file, "hls_memory_segments = %d\n", config->hls_memory_segments);
+    fprintf(file, "hls_spill_segments = %d  ; Older segments kept on disk for a longer DVR window\n",
+            config->hls_spill_segments);
+    fprintf(file, "hls_low_latency = %s  ; LL-HLS partial segments and blocking playlist reload\n",
+            config->hls_low_latency ? "true" : "false");
+    fprintf(file, "hls_part_duration_ms = %d\n", config->hls_part_duration_ms);
     
     fprintf(file, "max_size = %llu  ; 0 means unlimited, otherwise bytes\n", (unsigned long long)config->max_storage_size);
     fprintf(file, "retention_days = %d\n", config->retention_days);
@@ -1582,7 +1637,9 @@ int save_config(const config_t *config, const char *path) {
 
     // Write models settings
     fprintf(file, "[models]\n");
-    fprintf(file, "path = %s\n\n", config->models_path);
+    fprintf(file, "path = %s\n", config->models_path);
+    fprintf(file, "sod_threads = %d  ; Threads for embedded SOD detection per pass (0 = one per CPU); CPUs / sod_threads passes run at once\n\n",
+            config->sod_threads);
     
     // Write API detection settings
     fprintf(file, "[api_detection]\n");
@@ -1626,8 +1683,10 @@ int save_config(const config_t *config, const char *path) {
 
     // Write stream settings
     fprintf(file, "[streams]\n");
-    fprintf(file, "max_streams = %d  ; Runtime stream slot limit (default: 32, ceiling: %d; requires restart)\n\n",
+    fprintf(file, "max_streams = %d  ; Runtime stream slot limit (default: 32, ceiling: %d; requires restart)\n",
             config->max_streams, MAX_STREAMS);
+    fprintf(file, "shared_ingest = %s  ; Open each camera once for HLS, MP4 and detection\n\n",
+            config->shared_ingest ? "true" : "false");
     
     // Write memory optimization settings
     fprintf(file, "[memory]\n");
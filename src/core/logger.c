@@ -5,8 +5,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -21,6 +25,20 @@
 #include "core/path_utils.h"
 #include "utils/strings.h"
 
+// Longest message written; longer ones are truncated
+#define LOG_MESSAGE_MAX 4096
+
+// Messages up to this length are formatted straight into the queue slot;
+// longer ones are copied to the heap
+#define LOG_QUEUE_INLINE_MESSAGE 512
+
+// Messages the writer thread writes between flushes
+#define LOG_WRITE_BATCH 64
+
+// Call sites tracked by the rate limiter, and slots probed per lookup
+#define LOG_RATE_SLOTS  512
+#define LOG_RATE_PROBES 8
+
 // Logger state
 static struct {
     FILE *log_file;
@@ -46,7 +64,10 @@ static struct {
 
 // Weak symbols for optional JSON logger (implemented in logger_json.c when linked)
 extern __attribute__((weak)) int init_json_logger(const char *filename);
-extern __attribute__((weak)) int write_json_log(log_level_t level, const char *timestamp, const char *message);
+extern __attribute__((weak)) int write_json_log_entry(log_level_t level, const char *timestamp,
+                                                      const char *component, const char *stream_name,
+                                                      const char *message);
+extern __attribute__((weak)) void flush_json_log(void);
 
 // -----------------------------------------------------------------------
 // Per-thread logging context (thread-local storage)
@@ -77,6 +98,9 @@ static const char *log_level_strings[] = {
     "DEBUG"
 };
 
+static void start_log_writer(void);
+static void stop_log_writer(void);
+
 // Initialize the logging system
 int init_logger(void) {
     // Check if already initialized
@@ -108,6 +132,9 @@ int init_logger(void) {
     // Mark as initialized
     logger.initialized = 1;
 
+    // From here on messages are written by the background writer
+    start_log_writer();
+
     return 0;
 }
 
@@ -133,6 +160,9 @@ void shutdown_logger(void) {
     // Small delay to allow in-flight log operations to complete
     usleep(10000);  // 10ms
 
+    // Write out everything still queued before the files are closed
+    stop_log_writer();
+
     pthread_mutex_lock(&logger.mutex);
 
     if (logger.log_file != NULL && logger.log_file != stdout && logger.log_file != stderr) {
@@ -326,58 +356,36 @@ static void build_ctx_prefix(char *buf, size_t bufsz,
     }
 }
 
-// Core logging implementation shared by log_message_v and _log_message_ctx.
-// component and stream are already resolved by the caller; NULL or "" means
-// no prefix for that field.
-static void do_log_internal(log_level_t level,
-                             const char *component, const char *stream,
-                             const char *format, va_list args) {
-    // Only log messages at or below the configured log level.
-    if (level > logger.log_level) {
-        return;
-    }
-
-    // Create timestamp
-    struct timespec now;
-    clock_gettime(CLOCK_REALTIME, &now);
-
+// Format the log file timestamp ("%Y-%m-%d %H:%M:%S.mmm") and, when
+// iso_timestamp is set, the ISO 8601 timestamp used by the JSON log.
+static void format_timestamps(const struct timespec *time,
+                              char *timestamp, size_t timestamp_size,
+                              char *iso_timestamp, size_t iso_size) {
     struct tm tm_buf;
-    localtime_r(&now.tv_sec, &tm_buf);
-
-    char timestamp[32];
-    size_t offset = strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm_buf);
-
-    unsigned int msec = (unsigned int)(now.tv_nsec / 1000000UL);
-    snprintf(timestamp + offset, sizeof(timestamp) - offset, ".%03u", msec);
+    localtime_r(&time->tv_sec, &tm_buf);
 
-    char message[4096];
-    vsnprintf(message, sizeof(message), format, args);
+    size_t offset = strftime(timestamp, timestamp_size, "%Y-%m-%d %H:%M:%S", &tm_buf);
 
-    char ctx_prefix[224] = {0};
-    build_ctx_prefix(ctx_prefix, sizeof(ctx_prefix), component, stream);
+    unsigned int msec = (unsigned int)(time->tv_nsec / 1000000UL);
+    snprintf(timestamp + offset, timestamp_size - offset, ".%03u", msec);
 
-    // CRITICAL: Check if logger is shutting down or destroyed.
-    // Write directly to console without the mutex to avoid use-after-destroy.
-    if (logger.shutdown) {
-        FILE *console = (level == LOG_LEVEL_ERROR) ? stderr : stdout;
-        fprintf(console, "[%s] [%s] %s%s\n",
-                timestamp, log_level_strings[level], ctx_prefix, message);
-        fflush(console);
-        return;
+    if (iso_timestamp) {
+        strftime(iso_timestamp, iso_size, "%Y-%m-%dT%H:%M:%S", &tm_buf);
     }
+}
 
-    pthread_mutex_lock(&logger.mutex);
-
+// Write one line to the log file, the console and syslog.
+// Caller holds logger.mutex.
+static void write_entry_locked(log_level_t level, const char *timestamp,
+                               const char *ctx_prefix, const char *message) {
     if (logger.log_file && logger.log_file != stdout && logger.log_file != stderr) {
         fprintf(logger.log_file, "[%s] [%s] %s%s\n",
                 timestamp, log_level_strings[level], ctx_prefix, message);
-        fflush(logger.log_file);
     }
 
     FILE *console = (level == LOG_LEVEL_ERROR) ? stderr : stdout;
     fprintf(console, "[%s] [%s] %s%s\n",
             timestamp, log_level_strings[level], ctx_prefix, message);
-    fflush(console);
 
     if (logger.syslog_enabled) {
         int syslog_priority;
@@ -390,15 +398,595 @@ static void do_log_internal(log_level_t level,
         }
         syslog(syslog_priority, "%s", message);
     }
+}
+
+// Flush the log file and the console. Caller holds logger.mutex.
+static void flush_outputs_locked(void) {
+    if (logger.log_file && logger.log_file != stdout && logger.log_file != stderr) {
+        fflush(logger.log_file);
+    }
+    fflush(stdout);
+    fflush(stderr);
+}
+
+// -----------------------------------------------------------------------
+// In-memory tail of the most recent messages, written only by whichever
+// thread writes the log file (the writer thread once it is running).
+// -----------------------------------------------------------------------
+static struct {
+    log_tail_entry_t entries[LOG_TAIL_ENTRIES];
+    int head;       // Slot the next message goes into
+    int count;
+    pthread_mutex_t mutex;
+} log_tail = {
+    .head = 0,
+    .count = 0,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// Caller holds log_tail.mutex
+static void tail_append_locked(log_level_t level, const char *timestamp,
+                               const char *ctx_prefix, const char *message) {
+    log_tail_entry_t *entry = &log_tail.entries[log_tail.head];
+    entry->level = level;
+    safe_strcpy(entry->timestamp, timestamp, sizeof(entry->timestamp), 0);
+    snprintf(entry->text, sizeof(entry->text), "%s%s", ctx_prefix, message);
+
+    log_tail.head = (log_tail.head + 1) % LOG_TAIL_ENTRIES;
+    if (log_tail.count < LOG_TAIL_ENTRIES) {
+        log_tail.count++;
+    }
+}
+
+int log_tail_foreach(log_level_t max_level, const char *after_timestamp, int max_entries,
+                     log_tail_callback_t callback, void *user_data) {
+    if (!callback || max_entries <= 0) {
+        return -1;
+    }
+
+    bool after = after_timestamp && after_timestamp[0];
+
+    pthread_mutex_lock(&log_tail.mutex);
+
+    int count = log_tail.count;
+    int oldest = (log_tail.head - count + LOG_TAIL_ENTRIES) % LOG_TAIL_ENTRIES;
+
+    // Messages newer than after_timestamp may already have been evicted
+    if (count == 0 ||
+        (after && strcmp(log_tail.entries[oldest].timestamp, after_timestamp) > 0)) {
+        pthread_mutex_unlock(&log_tail.mutex);
+        return -1;
+    }
+
+    // A poll after a timestamp continues from there: visit the oldest
+    // max_entries newer messages, like the log file fallback does
+    if (after) {
+        int matched = 0;
+        for (int i = 0; i < count && matched < max_entries; i++) {
+            const log_tail_entry_t *entry = &log_tail.entries[(oldest + i) % LOG_TAIL_ENTRIES];
+            if (strcmp(entry->timestamp, after_timestamp) <= 0 || entry->level > max_level) {
+                continue;
+            }
+            callback(entry, user_data);
+            matched++;
+        }
+        pthread_mutex_unlock(&log_tail.mutex);
+        return matched;
+    }
+
+    // Otherwise walk back from the newest message to find the first one to visit
+    int matched = 0;
+    int start = count;
+    for (int i = count - 1; i >= 0 && matched < max_entries; i--) {
+        if (log_tail.entries[(oldest + i) % LOG_TAIL_ENTRIES].level <= max_level) {
+            matched++;
+            start = i;
+        }
+    }
+
+    // The tail only answers when it holds enough lines; older ones are in the
+    // log file
+    if (matched < max_entries) {
+        pthread_mutex_unlock(&log_tail.mutex);
+        return -1;
+    }
+
+    for (int i = start; i < count; i++) {
+        const log_tail_entry_t *entry = &log_tail.entries[(oldest + i) % LOG_TAIL_ENTRIES];
+        if (entry->level <= max_level) {
+            callback(entry, user_data);
+        }
+    }
+
+    pthread_mutex_unlock(&log_tail.mutex);
+    return matched;
+}
+
+// Write a message synchronously, for use before the writer thread starts
+// or when it could not be started
+static void log_sync(log_level_t level, const struct timespec *time,
+                     const char *component, const char *stream,
+                     const char *format, va_list args) {
+    char timestamp[32];
+    char iso_timestamp[32];
+    format_timestamps(time, timestamp, sizeof(timestamp), iso_timestamp, sizeof(iso_timestamp));
+
+    char message[LOG_MESSAGE_MAX];
+    vsnprintf(message, sizeof(message), format, args);
+
+    char ctx_prefix[224] = {0};
+    build_ctx_prefix(ctx_prefix, sizeof(ctx_prefix), component, stream);
+
+    pthread_mutex_lock(&logger.mutex);
+    write_entry_locked(level, timestamp, ctx_prefix, message);
+    flush_outputs_locked();
+    pthread_mutex_unlock(&logger.mutex);
+
+    pthread_mutex_lock(&log_tail.mutex);
+    tail_append_locked(level, timestamp, ctx_prefix, message);
+    pthread_mutex_unlock(&log_tail.mutex);
+
+    if (write_json_log_entry) {
+        write_json_log_entry(level, iso_timestamp, component, stream, message);
+        if (flush_json_log) {
+            flush_json_log();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// Message queue and writer thread
+//
+// A bounded multi-producer queue: each slot carries a sequence number that
+// tells producers when it is free and the writer when it is filled, so
+// producers only contend on one atomic counter.  The writer is the only
+// consumer.
+// -----------------------------------------------------------------------
+_Static_assert((LOG_QUEUE_SIZE & (LOG_QUEUE_SIZE - 1)) == 0,
+               "LOG_QUEUE_SIZE must be a power of two");
+
+typedef struct {
+    atomic_size_t seq;
+    log_level_t level;
+    struct timespec time;
+    char component[64];
+    char stream[128];
+    char *message;                                  // inline_message or a heap copy
+    char inline_message[LOG_QUEUE_INLINE_MESSAGE];
+} log_slot_t;
+
+static struct {
+    log_slot_t slots[LOG_QUEUE_SIZE];
+    atomic_size_t enqueue_pos;
+    size_t dequeue_pos;             // Only touched by the consumer
+    atomic_int running;             // Producers may queue messages
+    atomic_int stop;                // Writer should exit once the queue is empty
+    atomic_int wake_pending;        // A wake-up has been posted and not yet seen
+    sem_t wake;
+    pthread_t thread;
+    pthread_once_t once;
+    pthread_mutex_t flush_mutex;
+    pthread_cond_t flush_cond;
+    size_t written_pos;             // Messages before this are written (flush_mutex)
+} log_queue = {
+    .once = PTHREAD_ONCE_INIT,
+    .flush_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .flush_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void wake_writer(void) {
+    if (!atomic_exchange(&log_queue.wake_pending, 1)) {
+        sem_post(&log_queue.wake);
+    }
+}
+
+// Claim the next free slot, waiting for the writer while the queue is full.
+// Returns NULL if the writer stops while we wait.
+static log_slot_t *queue_claim(size_t *pos_out) {
+    size_t pos = atomic_load_explicit(&log_queue.enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        log_slot_t *slot = &log_queue.slots[pos & (LOG_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&log_queue.enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *pos_out = pos;
+                return slot;
+            }
+        } else if (dif < 0) {
+            // Queue full: wait for the writer rather than lose the message
+            if (!atomic_load(&log_queue.running)) {
+                return NULL;
+            }
+            wake_writer();
+            usleep(100);
+            pos = atomic_load_explicit(&log_queue.enqueue_pos, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&log_queue.enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Format a message into a queue slot. Returns false if the writer is not
+// running, in which case args is untouched.
+static bool queue_message(log_level_t level, const struct timespec *time,
+                          const char *component, const char *stream,
+                          const char *format, va_list args) {
+    if (!atomic_load_explicit(&log_queue.running, memory_order_acquire)) {
+        return false;
+    }
+
+    size_t pos;
+    log_slot_t *slot = queue_claim(&pos);
+    if (!slot) {
+        return false;
+    }
+
+    slot->level = level;
+    slot->time = *time;
+    safe_strcpy(slot->component, component ? component : "", sizeof(slot->component), 0);
+    safe_strcpy(slot->stream, stream ? stream : "", sizeof(slot->stream), 0);
+
+    va_list copy;
+    va_copy(copy, args);
+
+    slot->message = slot->inline_message;
+    int len = vsnprintf(slot->inline_message, sizeof(slot->inline_message), format, args);
+    if (len >= (int)sizeof(slot->inline_message)) {
+        size_t size = (len < LOG_MESSAGE_MAX) ? (size_t)len + 1 : LOG_MESSAGE_MAX;
+        char *heap_message = malloc(size);
+        if (heap_message) {
+            vsnprintf(heap_message, size, format, copy);
+            slot->message = heap_message;
+        }
+    }
+
+    va_end(copy);
+
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    wake_writer();
+
+    return true;
+}
+
+// Write out up to LOG_WRITE_BATCH queued messages. Returns how many.
+static int writer_drain(void) {
+    size_t pos = log_queue.dequeue_pos;
+    log_slot_t *batch[LOG_WRITE_BATCH];
+    int n = 0;
+
+    while (n < LOG_WRITE_BATCH) {
+        log_slot_t *slot = &log_queue.slots[(pos + n) & (LOG_QUEUE_SIZE - 1)];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + n + 1) {
+            break;
+        }
+        batch[n++] = slot;
+    }
+
+    if (n == 0) {
+        return 0;
+    }
+
+    char timestamps[LOG_WRITE_BATCH][32];
+    char iso_timestamps[LOG_WRITE_BATCH][32];
+    char ctx_prefixes[LOG_WRITE_BATCH][224];
+
+    for (int i = 0; i < n; i++) {
+        format_timestamps(&batch[i]->time, timestamps[i], sizeof(timestamps[i]),
+                          iso_timestamps[i], sizeof(iso_timestamps[i]));
+        build_ctx_prefix(ctx_prefixes[i], sizeof(ctx_prefixes[i]),
+                         batch[i]->component, batch[i]->stream);
+    }
 
+    pthread_mutex_lock(&logger.mutex);
+    for (int i = 0; i < n; i++) {
+        write_entry_locked(batch[i]->level, timestamps[i], ctx_prefixes[i], batch[i]->message);
+    }
+    flush_outputs_locked();
     pthread_mutex_unlock(&logger.mutex);
 
-    if (write_json_log) {
-        char iso_timestamp[32];
+    if (write_json_log_entry) {
+        for (int i = 0; i < n; i++) {
+            write_json_log_entry(batch[i]->level, iso_timestamps[i],
+                                 batch[i]->component, batch[i]->stream, batch[i]->message);
+        }
+        if (flush_json_log) {
+            flush_json_log();
+        }
+    }
+
+    pthread_mutex_lock(&log_tail.mutex);
+    for (int i = 0; i < n; i++) {
+        tail_append_locked(batch[i]->level, timestamps[i], ctx_prefixes[i], batch[i]->message);
+    }
+    pthread_mutex_unlock(&log_tail.mutex);
+
+    // Hand the slots back to producers
+    for (int i = 0; i < n; i++) {
+        if (batch[i]->message != batch[i]->inline_message) {
+            free(batch[i]->message);
+        }
+        atomic_store_explicit(&batch[i]->seq, pos + (size_t)i + LOG_QUEUE_SIZE,
+                              memory_order_release);
+    }
+    log_queue.dequeue_pos = pos + (size_t)n;
+
+    pthread_mutex_lock(&log_queue.flush_mutex);
+    log_queue.written_pos = log_queue.dequeue_pos;
+    pthread_cond_broadcast(&log_queue.flush_cond);
+    pthread_mutex_unlock(&log_queue.flush_mutex);
+
+    return n;
+}
+
+static void *log_writer_thread(void *arg) {
+    (void)arg;
+    int idle_waits = 0;
+
+    for (;;) {
+        if (writer_drain() > 0) {
+            continue;
+        }
+
+        if (atomic_load(&log_queue.stop)) {
+            // A producer may have claimed a slot just before the writer was
+            // stopped; give it a moment to fill it
+            if (atomic_load(&log_queue.enqueue_pos) == log_queue.dequeue_pos ||
+                ++idle_waits > 100) {
+                break;
+            }
+            usleep(1000);
+            continue;
+        }
+
+        while (sem_wait(&log_queue.wake) != 0 && errno == EINTR) {
+        }
+        atomic_store(&log_queue.wake_pending, 0);
+    }
+
+    return NULL;
+}
+
+static void reset_log_queue(void) {
+    for (size_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+        atomic_init(&log_queue.slots[i].seq, i);
+    }
+    atomic_store(&log_queue.enqueue_pos, 0);
+    log_queue.dequeue_pos = 0;
+    log_queue.written_pos = 0;
+    atomic_store(&log_queue.wake_pending, 0);
+    sem_init(&log_queue.wake, 0, 0);
+}
+
+// -----------------------------------------------------------------------
+// fork() support: the child has no writer thread, so it starts with an
+// empty queue (the parent still writes what was queued before the fork)
+// and starts its own writer on its first message.
+// -----------------------------------------------------------------------
+static atomic_int restart_after_fork;
+static int fork_locked_logger;
+
+static void log_atfork_prepare(void) {
+    log_flush();
+
+    fork_locked_logger = logger.initialized && !logger.shutdown;
+    if (fork_locked_logger) {
+        pthread_mutex_lock(&logger.mutex);
+    }
+    pthread_mutex_lock(&log_tail.mutex);
+    pthread_mutex_lock(&log_queue.flush_mutex);
+}
+
+static void log_atfork_parent(void) {
+    pthread_mutex_unlock(&log_queue.flush_mutex);
+    pthread_mutex_unlock(&log_tail.mutex);
+    if (fork_locked_logger) {
+        pthread_mutex_unlock(&logger.mutex);
+    }
+}
+
+static void log_atfork_child(void) {
+    log_atfork_parent();
+
+    if (atomic_exchange(&log_queue.running, 0)) {
+        reset_log_queue();
+        atomic_store(&restart_after_fork, 1);
+    }
+}
+
+static void init_log_queue(void) {
+    reset_log_queue();
+
+    pthread_atfork(log_atfork_prepare, log_atfork_parent, log_atfork_child);
+
+    // Write out whatever is still queued when the process exits
+    atexit(log_flush);
+}
+
+static void start_log_writer(void) {
+    pthread_once(&log_queue.once, init_log_queue);
 
-        strftime(iso_timestamp, sizeof(iso_timestamp), "%Y-%m-%dT%H:%M:%S",  &tm_buf);
-        write_json_log(level, iso_timestamp, message);
+    atomic_store(&log_queue.stop, 0);
+    if (pthread_create(&log_queue.thread, NULL, log_writer_thread, NULL) != 0) {
+        fprintf(stderr, "Failed to start log writer thread, logging synchronously\n");
+        return;
+    }
+    atomic_store(&log_queue.running, 1);
+}
+
+static void stop_log_writer(void) {
+    if (!atomic_exchange(&log_queue.running, 0)) {
+        return;
+    }
+
+    atomic_store(&log_queue.stop, 1);
+    sem_post(&log_queue.wake);
+    pthread_join(log_queue.thread, NULL);
+
+    // Pick up anything queued after the writer exited
+    while (writer_drain() > 0) {
+    }
+
+    pthread_mutex_lock(&log_queue.flush_mutex);
+    pthread_cond_broadcast(&log_queue.flush_cond);
+    pthread_mutex_unlock(&log_queue.flush_mutex);
+}
+
+void log_flush(void) {
+    if (!atomic_load(&log_queue.running)) {
+        return;
+    }
+
+    size_t target = atomic_load(&log_queue.enqueue_pos);
+    wake_writer();
+
+    pthread_mutex_lock(&log_queue.flush_mutex);
+    while ((intptr_t)(log_queue.written_pos - target) < 0 && atomic_load(&log_queue.running)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100 * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&log_queue.flush_cond, &log_queue.flush_mutex, &deadline);
     }
+    pthread_mutex_unlock(&log_queue.flush_mutex);
+}
+
+// -----------------------------------------------------------------------
+// Per-call-site rate limiting, keyed by the format string's address
+// -----------------------------------------------------------------------
+typedef struct {
+    _Atomic(const char *) site;
+    atomic_llong second;            // Second the count below belongs to
+    atomic_uint count;
+    atomic_uint suppressed;         // Dropped and not yet reported
+} log_rate_slot_t;
+
+static log_rate_slot_t log_rate_slots[LOG_RATE_SLOTS];
+static atomic_int log_rate_limit = LOG_RATE_LIMIT_DEFAULT;
+
+void set_log_rate_limit(int per_second) {
+    atomic_store(&log_rate_limit, per_second > 0 ? per_second : 0);
+}
+
+// Returns true if the message should be dropped. *reported is set to the
+// number of messages from this call site dropped in an earlier second that
+// have not been reported yet.
+static bool rate_limited(const char *site, time_t now, unsigned int *reported) {
+    *reported = 0;
+
+    int limit = atomic_load_explicit(&log_rate_limit, memory_order_relaxed);
+    if (limit <= 0 || !site) {
+        return false;
+    }
+
+    uint32_t hash = (uint32_t)((uintptr_t)site >> 3) * 2654435761u;
+
+    for (int probe = 0; probe < LOG_RATE_PROBES; probe++) {
+        log_rate_slot_t *slot = &log_rate_slots[(hash + (uint32_t)probe) & (LOG_RATE_SLOTS - 1)];
+
+        const char *current = atomic_load_explicit(&slot->site, memory_order_acquire);
+        if (current == NULL) {
+            const char *expected = NULL;
+            if (!atomic_compare_exchange_strong(&slot->site, &expected, site) &&
+                expected != site) {
+                continue;
+            }
+        } else if (current != site) {
+            continue;
+        }
+
+        long long second = atomic_load(&slot->second);
+        if (second != (long long)now &&
+            atomic_compare_exchange_strong(&slot->second, &second, (long long)now)) {
+            atomic_store(&slot->count, 0);
+            *reported = atomic_exchange(&slot->suppressed, 0);
+        }
+
+        if (atomic_fetch_add(&slot->count, 1) < (unsigned int)limit) {
+            return false;
+        }
+        atomic_fetch_add(&slot->suppressed, 1);
+        return true;
+    }
+
+    // Table full: leave untracked call sites alone
+    return false;
+}
+
+// Queue a message, or write it directly when the writer is not running
+static void dispatch_message(log_level_t level, const struct timespec *time,
+                             const char *component, const char *stream,
+                             const char *format, va_list args) {
+    if (!queue_message(level, time, component, stream, format, args)) {
+        log_sync(level, time, component, stream, format, args);
+    }
+}
+
+static void dispatch_messagef(log_level_t level, const struct timespec *time,
+                              const char *component, const char *stream,
+                              const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    dispatch_message(level, time, component, stream, format, args);
+    va_end(args);
+}
+
+// Core logging implementation shared by log_message_v and _log_message_ctx.
+// component and stream are already resolved by the caller; NULL or "" means
+// no prefix for that field.
+static void do_log_internal(log_level_t level,
+                             const char *component, const char *stream,
+                             const char *format, va_list args) {
+    // Only log messages at or below the configured log level.
+    if (level > logger.log_level) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    // CRITICAL: Check if logger is shutting down or destroyed.
+    // Write directly to console without the mutex to avoid use-after-destroy.
+    if (logger.shutdown) {
+        char timestamp[32];
+        format_timestamps(&now, timestamp, sizeof(timestamp), NULL, 0);
+
+        char message[LOG_MESSAGE_MAX];
+        vsnprintf(message, sizeof(message), format, args);
+
+        char ctx_prefix[224] = {0};
+        build_ctx_prefix(ctx_prefix, sizeof(ctx_prefix), component, stream);
+
+        FILE *console = (level == LOG_LEVEL_ERROR) ? stderr : stdout;
+        fprintf(console, "[%s] [%s] %s%s\n",
+                timestamp, log_level_strings[level], ctx_prefix, message);
+        fflush(console);
+        return;
+    }
+
+    if (atomic_load_explicit(&restart_after_fork, memory_order_relaxed) &&
+        atomic_exchange(&restart_after_fork, 0)) {
+        start_log_writer();
+    }
+
+    // Errors are never dropped
+    unsigned int suppressed = 0;
+    if (level != LOG_LEVEL_ERROR && rate_limited(format, now.tv_sec, &suppressed)) {
+        return;
+    }
+    if (suppressed > 0) {
+        dispatch_messagef(level, &now, component, stream,
+                          "(%u similar messages suppressed)", suppressed);
+    }
+
+    dispatch_message(level, &now, component, stream, format, args);
 }
 
 // Log a message at the specified level with va_list.
@@ -119,14 +119,17 @@ void shutdown_json_logger(void) {
 }
 
 /**
- * @brief Write a log entry to the JSON log file
- * 
+ * @brief Write a log entry to the JSON log file without flushing it
+ *
  * @param level Log level
  * @param timestamp Timestamp string
+ * @param component Component label, or NULL/"" for none
+ * @param stream_name Stream name, or NULL/"" for none
  * @param message Log message
  * @return int 0 on success, non-zero on error
  */
-int write_json_log(log_level_t level, const char *timestamp, const char *message) {
+int write_json_log_entry(log_level_t level, const char *timestamp, const char *component,
+                         const char *stream_name, const char *message) {
     if (!json_logger.initialized || !json_logger.log_file) {
         return -1;
     }
@@ -142,13 +145,10 @@ int write_json_log(log_level_t level, const char *timestamp, const char *message
     }
     
     // Add timestamp, level, optional context fields, and message.
-    // Component and stream are read from per-thread storage (log_get_thread_*);
-    // they are only added to the JSON object when non-empty so that log
-    // entries from threads without context remain unchanged.
+    // Component and stream are only added to the JSON object when non-empty
+    // so that log entries without context remain unchanged.
     cJSON_AddStringToObject(log_entry, "timestamp", timestamp);
     cJSON_AddStringToObject(log_entry, "level", json_log_level_strings[level]);
-    const char *component   = log_get_thread_component();
-    const char *stream_name = log_get_thread_stream();
     if (component && component[0] != '\0') {
         cJSON_AddStringToObject(log_entry, "component", component);
     }
@@ -169,12 +169,10 @@ int write_json_log(log_level_t level, const char *timestamp, const char *message
     pthread_mutex_lock(&json_logger.mutex);
     
     int result = 0;
-    if (fprintf(json_logger.log_file, "%s\n", json_str) < 0) {
+    if (!json_logger.log_file || fprintf(json_logger.log_file, "%s\n", json_str) < 0) {
         result = -1;
     }
     
-    fflush(json_logger.log_file);
-    
     pthread_mutex_unlock(&json_logger.mutex);
     
     free(json_str);
@@ -182,6 +180,39 @@ int write_json_log(log_level_t level, const char *timestamp, const char *message
     return result;
 }
 
+/**
+ * @brief Flush entries written with write_json_log_entry() to disk
+ */
+void flush_json_log(void) {
+    if (!json_logger.initialized) {
+        return;
+    }
+
+    pthread_mutex_lock(&json_logger.mutex);
+    if (json_logger.log_file) {
+        fflush(json_logger.log_file);
+    }
+    pthread_mutex_unlock(&json_logger.mutex);
+}
+
+/**
+ * @brief Write a log entry to the JSON log file
+ * 
+ * @param level Log level
+ * @param timestamp Timestamp string
+ * @param message Log message
+ * @return int 0 on success, non-zero on error
+ */
+int write_json_log(log_level_t level, const char *timestamp, const char *message) {
+    // Component and stream are read from per-thread storage (log_get_thread_*)
+    int result = write_json_log_entry(level, timestamp, log_get_thread_component(),
+                                      log_get_thread_stream(), message);
+    if (result == 0) {
+        flush_json_log();
+    }
+    return result;
+}
+
 /**
  * @brief Get logs from the JSON log file with timestamp-based pagination
  * 
@@ -61,6 +61,7 @@ void init_recordings_system(void);
 #include "database/db_schema_cache.h"
 #include "database/db_core.h"
 #include "database/db_recordings_sync.h"
+#include "database/db_auth.h"
 #include <sqlite3.h>
 #include "web/http_server.h"
 #include "web/libuv_server.h"
@@ -1412,6 +1413,9 @@ cleanup:
         log_info("Ensuring all database operations are complete...");
         __sync_synchronize();
 
+        // Write back cached session activity while the database is still open
+        db_auth_shutdown();
+
         // Free schema cache first to ensure all schema-related statements are finalized
         log_info("Freeing schema cache...");
         free_schema_cache();
@@ -1508,6 +1512,9 @@ cleanup:
         log_info("Ensuring all database operations are complete...");
         __sync_synchronize();
 
+        // Write back cached session activity while the database is still open
+        db_auth_shutdown();
+
         // Free schema cache first
         log_info("Freeing schema cache...");
         free_schema_cache();
@@ -18,6 +18,8 @@
 #include "database/db_streams.h"
 #include "utils/strings.h"
 #include "video/go2rtc/go2rtc_snapshot.h"
+#include "video/frame_bus.h"
+#include "video/ffmpeg_utils.h"
 
 #define MAX_TOPIC_LENGTH 512
 
@@ -845,8 +847,101 @@ void mqtt_set_motion_state(const char *stream_name, const detection_result_t *re
     }
 }
 
+// Snapshot source for one stream, owned by the snapshot thread: frames come
+// from the detection thread's decoder through the frame bus when it runs
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    frame_bus_subscriber_t *sub;
+    jpeg_encoder_cache_t *encoder;
+    int width;
+    int height;
+    bool seen;                      // Still configured this round
+} ha_snapshot_source_t;
+
+#define HA_SNAPSHOT_JPEG_QUALITY 85
+
+static ha_snapshot_source_t *snapshot_source(ha_snapshot_source_t *sources, const char *stream_name) {
+    ha_snapshot_source_t *free_source = NULL;
+    for (int i = 0; i < MAX_MOTION_STREAMS; i++) {
+        if (sources[i].sub) {
+            if (strcmp(sources[i].stream_name, stream_name) == 0) {
+                return &sources[i];
+            }
+        } else if (!free_source) {
+            free_source = &sources[i];
+        }
+    }
+    if (!free_source) {
+        return NULL;
+    }
+
+    // Ask for RGB frames at twice the publish rate so a snapshot is never
+    // more than half an interval older than the one a fresh decode would give
+    frame_bus_sub_config_t sub_config = {
+        .interval_ms = mqtt_config->mqtt_ha_snapshot_interval * 500,
+        .pix_fmt = AV_PIX_FMT_RGB24,
+    };
+    free_source->sub = frame_bus_subscribe(stream_name, &sub_config);
+    if (!free_source->sub) {
+        return NULL;
+    }
+    safe_strcpy(free_source->stream_name, stream_name, sizeof(free_source->stream_name), 0);
+    return free_source;
+}
+
+static void release_snapshot_source(ha_snapshot_source_t *source) {
+    frame_bus_unsubscribe(source->sub);
+    jpeg_encoder_cache_destroy(source->encoder);
+    memset(source, 0, sizeof(*source));
+}
+
+/**
+ * Encode the newest frame the detection thread decoded for a stream
+ *
+ * @return true with *jpeg_data set (caller frees), false if no new frame was
+ *         published since the last snapshot
+ */
+static bool snapshot_from_frame_bus(ha_snapshot_source_t *source,
+                                    unsigned char **jpeg_data, size_t *jpeg_size) {
+    AVFrame *frame = frame_bus_acquire(source->sub);
+    if (!frame) {
+        return false;
+    }
+
+    if (!source->encoder || source->width != frame->width || source->height != frame->height) {
+        jpeg_encoder_cache_destroy(source->encoder);
+        source->encoder = jpeg_encoder_cache_create(frame->width, frame->height, 3,
+                                                    HA_SNAPSHOT_JPEG_QUALITY);
+        source->width = frame->width;
+        source->height = frame->height;
+    }
+
+    // The encoder takes tightly packed rows
+    int row_size = frame->width * 3;
+    const unsigned char *pixels = frame->data[0];
+    unsigned char *packed = NULL;
+    if (frame->linesize[0] != row_size) {
+        packed = malloc((size_t)row_size * frame->height);
+        if (packed) {
+            for (int y = 0; y < frame->height; y++) {
+                memcpy(packed + (size_t)y * row_size, frame->data[0] + (size_t)y * frame->linesize[0], row_size);
+            }
+        }
+        pixels = packed;
+    }
+
+    bool ok = source->encoder && pixels &&
+              jpeg_encoder_cache_encode_to_memory(source->encoder, pixels, jpeg_data, jpeg_size) == 0;
+    free(packed);
+    av_frame_free(&frame);
+    return ok;
+}
+
 /**
  * Background thread: periodically publishes JPEG snapshots for each stream.
+ *
+ * A stream with a running detection thread is snapshotted from that thread's
+ * decoded frames; the others are fetched from go2rtc.
  */
 static void *ha_snapshot_thread_func(void *arg) {
     (void)arg;
@@ -854,6 +949,9 @@ static void *ha_snapshot_thread_func(void *arg) {
     log_info("MQTT HA: Snapshot publishing thread started (interval=%ds)",
              mqtt_config->mqtt_ha_snapshot_interval);
 
+    ha_snapshot_source_t sources[MAX_MOTION_STREAMS];
+    memset(sources, 0, sizeof(sources));
+
     while (ha_services_running) {
         if (!mqtt_is_connected() || !mqtt_config) {
             sleep(1);
@@ -863,6 +961,10 @@ static void *ha_snapshot_thread_func(void *arg) {
         stream_config_t streams[MAX_MOTION_STREAMS];
         int num_streams = get_all_stream_configs(streams, MAX_MOTION_STREAMS);
 
+        for (int i = 0; i < MAX_MOTION_STREAMS; i++) {
+            sources[i].seen = false;
+        }
+
         for (int i = 0; i < num_streams && ha_services_running; i++) {
             if (!streams[i].enabled || streams[i].name[0] == '\0') {
                 continue;
@@ -871,7 +973,13 @@ static void *ha_snapshot_thread_func(void *arg) {
             unsigned char *jpeg_data = NULL;
             size_t jpeg_size = 0;
 
-            if (go2rtc_get_snapshot(streams[i].name, &jpeg_data, &jpeg_size)) {
+            ha_snapshot_source_t *source = snapshot_source(sources, streams[i].name);
+            if (source) {
+                source->seen = true;
+            }
+
+            if ((source && snapshot_from_frame_bus(source, &jpeg_data, &jpeg_size)) ||
+                go2rtc_get_snapshot(streams[i].name, &jpeg_data, &jpeg_size)) {
                 char safe_name[256];
                 sanitize_stream_name(streams[i].name, safe_name, sizeof(safe_name));
                 char topic[MAX_TOPIC_LENGTH];
@@ -886,12 +994,24 @@ static void *ha_snapshot_thread_func(void *arg) {
             }
         }
 
+        // Stop taking frames for streams that were removed or disabled
+        for (int i = 0; i < MAX_MOTION_STREAMS; i++) {
+            if (sources[i].sub && !sources[i].seen) {
+                release_snapshot_source(&sources[i]);
+            }
+        }
+
         // Sleep in 1-second increments so we can check ha_services_running
         for (int s = 0; s < mqtt_config->mqtt_ha_snapshot_interval && ha_services_running; s++) {
             sleep(1);
         }
     }
 
+    for (int i = 0; i < MAX_MOTION_STREAMS; i++) {
+        if (sources[i].sub) {
+            release_snapshot_source(&sources[i]);
+        }
+    }
     go2rtc_snapshot_cleanup_thread();
     log_info("MQTT HA: Snapshot publishing thread stopped");
     return NULL;
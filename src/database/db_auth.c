@@ -14,8 +14,10 @@
 #include <unistd.h>
 #include <sys/time.h>
 #include <arpa/inet.h>
+#include <pthread.h>
 
 #include "database/db_auth.h"
+#include "database/db_auth_cache.h"
 #include "database/db_core.h"
 #include "database/db_schema_cache.h"  // For cached_column_exists
 #include "core/logger.h"
@@ -39,6 +41,12 @@
 // Default trusted device expiry time (30 days)
 #define DEFAULT_TRUSTED_DEVICE_EXPIRY 2592000
 
+// Cached session activity is written back to the database at most this often
+#define SESSION_ACTIVITY_FLUSH_INTERVAL 60
+
+static pthread_mutex_t activity_flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+static time_t last_activity_flush = 0;
+
 // Role names
 static const char *role_names[] = {
     "admin",
@@ -475,6 +483,11 @@ static int hash_token_identifier(const char *token, char *token_hash, size_t tok
     return bin_to_hex(digest, SHA256_DIGEST_LENGTH, token_hash, token_hash_size);
 }
 
+// Cache keys are the raw SHA-256 of the credential
+static void auth_cache_key_for(const char *credential, uint8_t key[AUTH_CACHE_KEY_SIZE]) {
+    mbedtls_sha256((const unsigned char *)credential, strlen(credential), key, 0);
+}
+
 /**
  * Convert hexadecimal string to binary data
  *
@@ -779,6 +792,8 @@ int db_auth_update_user(int64_t user_id, const char *username, const char *email
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("User updated successfully: %lld", (long long)user_id);
     return 0;
 }
@@ -901,6 +916,8 @@ int db_auth_change_password(int64_t user_id, const char *new_password) {
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("Password changed successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -951,6 +968,8 @@ int db_auth_delete_user(int64_t user_id) {
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("User deleted successfully: %lld", (long long)user_id);
     return 0;
 }
@@ -1038,6 +1057,17 @@ int db_auth_get_user_by_api_key(const char *api_key, user_t *user) {
         return -1;
     }
 
+    time_t now = time(NULL);
+    auth_cache_entry_t entry;
+    uint8_t key[AUTH_CACHE_KEY_SIZE];
+    auth_cache_key_for(api_key, key);
+    if (auth_cache_get(key, AUTH_CACHE_API_KEY, now, &entry)) {
+        *user = entry.user;
+        return 0;
+    }
+
+    uint64_t generation = auth_cache_generation();
+
     sqlite3 *db = get_db_handle();
     if (!db) {
         log_error("Database not initialized");
@@ -1063,6 +1093,13 @@ int db_auth_get_user_by_api_key(const char *api_key, user_t *user) {
 
     sqlite3_finalize(stmt);
 
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.key, key, AUTH_CACHE_KEY_SIZE);
+    entry.kind = AUTH_CACHE_API_KEY;
+    entry.loaded_at = now;
+    entry.user = *user;
+    auth_cache_put_if_current(&entry, now, generation);
+
     return 0;
 }
 
@@ -1128,6 +1165,8 @@ int db_auth_generate_api_key(int64_t user_id, char *api_key, size_t api_key_size
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("API key generated successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -1370,6 +1409,8 @@ int db_auth_set_password_lock(int64_t user_id, bool locked) {
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("Password lock status updated for user: %lld (locked: %d)", (long long)user_id, locked);
     return 0;
 }
@@ -1488,15 +1529,11 @@ int db_auth_create_session(int64_t user_id, const char *ip_address, const char *
 }
 
 /**
- * Validate a session token
+ * Read a session and its user from the database
+ *
+ * Fails for unknown or expired sessions and for inactive users.
  */
-int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
-                                          const char *ip_address, const char *user_agent) {
-    if (!token) {
-        log_error("Token is required");
-        return -1;
-    }
-
+static int load_session_entry(const char *token, time_t now, auth_cache_entry_t *entry) {
     sqlite3 *db = get_db_handle();
     if (!db) {
         log_error("Database not initialized");
@@ -1509,22 +1546,21 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
     bool has_ua_column = cached_column_exists("sessions", "user_agent");
     bool has_tracking_columns = has_idle_expires_column && has_last_activity_column;
 
-    // Query the session
+    char sql[512];
+    int written = snprintf(sql, sizeof(sql),
+                           "SELECT s.id, s.user_id, s.expires_at, %s, %s, %s, %s, u.is_active "
+                           "FROM sessions s "
+                           "JOIN users u ON s.user_id = u.id "
+                           "WHERE s.token = ?;",
+                           has_idle_expires_column ? "s.idle_expires_at" : "s.expires_at",
+                           has_tracking_columns ? "COALESCE(s.last_activity_at, s.created_at)" : "0",
+                           has_ip_column ? "COALESCE(s.ip_address, '')" : "''",
+                           has_ua_column ? "COALESCE(s.user_agent, '')" : "''");
+    if (written < 0 || (size_t)written >= sizeof(sql)) {
+        return -1;
+    }
+
     sqlite3_stmt *stmt;
-    const char *sql = has_tracking_columns
-        ? "SELECT s.id, s.user_id, s.expires_at, s.idle_expires_at, COALESCE(s.last_activity_at, s.created_at), u.is_active "
-          "FROM sessions s "
-          "JOIN users u ON s.user_id = u.id "
-          "WHERE s.token = ?;"
-        : has_idle_expires_column
-        ? "SELECT s.id, s.user_id, s.expires_at, s.idle_expires_at, u.is_active "
-          "FROM sessions s "
-          "JOIN users u ON s.user_id = u.id "
-          "WHERE s.token = ?;"
-        : "SELECT s.id, s.user_id, s.expires_at, u.is_active "
-          "FROM sessions s "
-          "JOIN users u ON s.user_id = u.id "
-          "WHERE s.token = ?;";
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
@@ -1539,140 +1575,323 @@ int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
         return -1;
     }
 
-    int64_t session_id = sqlite3_column_int64(stmt, 0);
+    memset(entry, 0, sizeof(*entry));
+    entry->kind = AUTH_CACHE_SESSION;
+    entry->session_id = sqlite3_column_int64(stmt, 0);
+    int64_t user_id = sqlite3_column_int64(stmt, 1);
+    entry->expires_at = sqlite3_column_int64(stmt, 2);
+    entry->idle_expires_at = sqlite3_column_int64(stmt, 3);
+    entry->last_activity_at = sqlite3_column_int64(stmt, 4);
+    entry->stored_activity_at = entry->last_activity_at;
+    entry->loaded_at = now;
 
-    // Check if the session has expired
-    time_t expires_at = sqlite3_column_int64(stmt, 2);
-    time_t idle_expires_at = has_idle_expires_column ? sqlite3_column_int64(stmt, 3) : expires_at;
-    time_t last_activity_at = has_tracking_columns ? sqlite3_column_int64(stmt, 4) : 0;
-    time_t now = time(NULL);
+    const char *stored_ip = (const char *)sqlite3_column_text(stmt, 5);
+    const char *stored_ua = (const char *)sqlite3_column_text(stmt, 6);
+    safe_strcpy(entry->ip_address, stored_ip ? stored_ip : "", sizeof(entry->ip_address), 0);
+    safe_strcpy(entry->user_agent, stored_ua ? stored_ua : "", sizeof(entry->user_agent), 0);
+
+    int is_active = sqlite3_column_int(stmt, 7);
+    sqlite3_finalize(stmt);
 
-    if (now > expires_at || now > idle_expires_at) {
+    // Check if the session has expired
+    if (now > entry->expires_at || now > entry->idle_expires_at) {
         log_debug("Session has expired");
-        sqlite3_finalize(stmt);
         return -1;
     }
 
     // Check if the user is active
-    int is_active = sqlite3_column_int(stmt, has_tracking_columns ? 5 : (has_idle_expires_column ? 4 : 3));
     if (!is_active) {
         log_debug("User is inactive");
-        sqlite3_finalize(stmt);
         return -1;
     }
 
-    // Session is valid
-    int64_t id = sqlite3_column_int64(stmt, 1);
-    if (user_id) {
-        *user_id = id;
+    if (db_auth_get_user_by_id(user_id, &entry->user) != 0) {
+        return -1;
     }
 
-    sqlite3_finalize(stmt);
+    return 0;
+}
 
-    bool update_ip = false;
-    bool update_ua = false;
-    if ((has_ip_column && ip_address) || (has_ua_column && user_agent)) {
-        const char *tracking_sql = has_ip_column && has_ua_column
-            ? "SELECT COALESCE(ip_address, ''), COALESCE(user_agent, '') FROM sessions WHERE id = ?;"
-            : has_ip_column
-            ? "SELECT COALESCE(ip_address, '') FROM sessions WHERE id = ?;"
-            : has_ua_column
-            ? "SELECT COALESCE(user_agent, '') FROM sessions WHERE id = ?;"
-            : NULL;
-        if (tracking_sql) {
-            rc = sqlite3_prepare_v2(db, tracking_sql, -1, &stmt, NULL);
-            if (rc == SQLITE_OK) {
-                sqlite3_bind_int64(stmt, 1, session_id);
-                if (sqlite3_step(stmt) == SQLITE_ROW) {
-                    int column_index = 0;
-                    const char *stored_ip = has_ip_column
-                        ? (const char *)sqlite3_column_text(stmt, column_index++)
-                        : "";
-                    const char *stored_ua = has_ua_column
-                        ? (const char *)sqlite3_column_text(stmt, column_index)
-                        : "";
-                    update_ip = has_ip_column && tracking_value_differs(stored_ip, ip_address);
-                    update_ua = has_ua_column && tracking_value_differs(stored_ua, user_agent);
-                }
-                sqlite3_finalize(stmt);
-            } else {
-                log_warn("Failed to prepare session client-context lookup for session %lld: %s",
-                         (long long)session_id, sqlite3_errmsg(db));
-            }
-        }
+/**
+ * Resolve a session token through the cache, loading it on a miss
+ */
+static int get_session_entry(const char *token, time_t now, uint8_t key[AUTH_CACHE_KEY_SIZE],
+                             auth_cache_entry_t *entry) {
+    auth_cache_key_for(token, key);
+
+    if (auth_cache_get(key, AUTH_CACHE_SESSION, now, entry)) {
+        return 0;
     }
 
-    bool refresh_tracking = has_tracking_columns && should_refresh_session_tracking(now, last_activity_at, idle_expires_at);
-    if (refresh_tracking || update_ip || update_ua) {
-        time_t new_idle_expires_at = now + default_session_idle_expiry_seconds();
-        if (new_idle_expires_at > expires_at) {
-            new_idle_expires_at = expires_at;
-        }
+    // An invalidation after this point means the row just read may be revoked
+    uint64_t generation = auth_cache_generation();
 
-        char update_sql[256] = "UPDATE sessions SET ";
-        size_t sql_len = strlen(update_sql);
-        bool need_comma = false;
-        if (refresh_tracking) {
-            int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
-                                   "%slast_activity_at = ?, idle_expires_at = ?",
-                                   need_comma ? ", " : "");
-            if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
-                log_warn("Failed to build session refresh SQL for session %lld", (long long)session_id);
-                return 0;
-            }
-            sql_len += (size_t)written;
-            need_comma = true;
-        }
-        if (update_ip) {
-            int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
-                                   "%sip_address = ?", need_comma ? ", " : "");
-            if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
-                log_warn("Failed to build session IP refresh SQL for session %lld", (long long)session_id);
-                return 0;
-            }
-            sql_len += (size_t)written;
-            need_comma = true;
+    if (load_session_entry(token, now, entry) != 0) {
+        // Drop a stale copy of a session that is gone from the database
+        auth_cache_invalidate_key(key, AUTH_CACHE_SESSION);
+        return -1;
+    }
+
+    memcpy(entry->key, key, AUTH_CACHE_KEY_SIZE);
+    int put = auth_cache_put_if_current(entry, now, generation);
+    if (put < 0) {
+        log_debug("Session cache shard full, continuing uncached");
+    } else if (put > 0) {
+        log_debug("Session changed while loading, not caching it");
+    }
+
+    return 0;
+}
+
+/**
+ * Write session tracking columns straight to the database
+ */
+static void write_session_tracking(int64_t session_id, bool refresh_tracking, time_t now,
+                                   time_t new_idle_expires_at, const char *ip_address,
+                                   const char *user_agent) {
+    sqlite3 *db = get_db_handle();
+    if (!db) {
+        return;
+    }
+
+    refresh_tracking = refresh_tracking &&
+                       cached_column_exists("sessions", "idle_expires_at") &&
+                       cached_column_exists("sessions", "last_activity_at");
+    bool update_ip = ip_address && cached_column_exists("sessions", "ip_address");
+    bool update_ua = user_agent && cached_column_exists("sessions", "user_agent");
+    if (!refresh_tracking && !update_ip && !update_ua) {
+        return;
+    }
+
+    char update_sql[256] = "UPDATE sessions SET ";
+    size_t sql_len = strlen(update_sql);
+    bool need_comma = false;
+    if (refresh_tracking) {
+        int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
+                               "%slast_activity_at = ?, idle_expires_at = ?",
+                               need_comma ? ", " : "");
+        if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
+            log_warn("Failed to build session refresh SQL for session %lld", (long long)session_id);
+            return;
         }
-        if (update_ua) {
-            int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
-                                   "%suser_agent = ?", need_comma ? ", " : "");
-            if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
-                log_warn("Failed to build session user-agent refresh SQL for session %lld", (long long)session_id);
-                return 0;
-            }
-            sql_len += (size_t)written;
+        sql_len += (size_t)written;
+        need_comma = true;
+    }
+    if (update_ip) {
+        int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
+                               "%sip_address = ?", need_comma ? ", " : "");
+        if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
+            log_warn("Failed to build session IP refresh SQL for session %lld", (long long)session_id);
+            return;
         }
-        int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len, " WHERE id = ?;");
+        sql_len += (size_t)written;
+        need_comma = true;
+    }
+    if (update_ua) {
+        int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len,
+                               "%suser_agent = ?", need_comma ? ", " : "");
         if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
-            log_warn("Failed to finalize session refresh SQL for session %lld", (long long)session_id);
-            return 0;
+            log_warn("Failed to build session user-agent refresh SQL for session %lld", (long long)session_id);
+            return;
         }
+        sql_len += (size_t)written;
+    }
+    int written = snprintf(update_sql + sql_len, sizeof(update_sql) - sql_len, " WHERE id = ?;");
+    if (written < 0 || (size_t)written >= sizeof(update_sql) - sql_len) {
+        log_warn("Failed to finalize session refresh SQL for session %lld", (long long)session_id);
+        return;
+    }
 
-        rc = sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL);
-        if (rc == SQLITE_OK) {
-            int param = 1;
-            if (refresh_tracking) {
-                sqlite3_bind_int64(stmt, param++, now);
-                sqlite3_bind_int64(stmt, param++, new_idle_expires_at);
-            }
-            if (update_ip) {
-                sqlite3_bind_text(stmt, param++, ip_address ? ip_address : "", -1, SQLITE_STATIC);
-            }
-            if (update_ua) {
-                sqlite3_bind_text(stmt, param++, user_agent ? user_agent : "", -1, SQLITE_STATIC);
-            }
-            sqlite3_bind_int64(stmt, param, session_id);
-            if (sqlite3_step(stmt) != SQLITE_DONE) {
-                log_warn("Failed to refresh tracking for session %lld: %s",
-                         (long long)session_id, sqlite3_errmsg(db));
-            }
-            sqlite3_finalize(stmt);
-        } else {
-            log_warn("Failed to prepare tracking refresh for session %lld: %s",
-                     (long long)session_id, sqlite3_errmsg(db));
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        log_warn("Failed to prepare tracking refresh for session %lld: %s",
+                 (long long)session_id, sqlite3_errmsg(db));
+        return;
+    }
+
+    int param = 1;
+    if (refresh_tracking) {
+        sqlite3_bind_int64(stmt, param++, now);
+        sqlite3_bind_int64(stmt, param++, new_idle_expires_at);
+    }
+    if (update_ip) {
+        sqlite3_bind_text(stmt, param++, ip_address, -1, SQLITE_STATIC);
+    }
+    if (update_ua) {
+        sqlite3_bind_text(stmt, param++, user_agent, -1, SQLITE_STATIC);
+    }
+    sqlite3_bind_int64(stmt, param, session_id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        log_warn("Failed to refresh tracking for session %lld: %s",
+                 (long long)session_id, sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+}
+
+/**
+ * Write pending session activity from the cache in one transaction
+ *
+ * Caller must hold activity_flush_mutex.
+ */
+static int flush_session_activity_locked(void) {
+    auth_cache_activity_t pending[AUTH_CACHE_SHARDS * AUTH_CACHE_SHARD_SLOTS];
+    int count = auth_cache_take_activity(pending, AUTH_CACHE_SHARDS * AUTH_CACHE_SHARD_SLOTS);
+    if (count == 0) {
+        return 0;
+    }
+
+    if (!cached_column_exists("sessions", "idle_expires_at") ||
+        !cached_column_exists("sessions", "last_activity_at")) {
+        return 0;
+    }
+
+    sqlite3 *db = get_db_handle();
+    if (!db) {
+        return -1;
+    }
+
+    pthread_mutex_t *db_mutex = get_db_mutex();
+    pthread_mutex_lock(db_mutex);
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_warn("Failed to begin session activity flush: %s", err_msg ? err_msg : "unknown error");
+        sqlite3_free(err_msg);
+        pthread_mutex_unlock(db_mutex);
+        return -1;
+    }
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db,
+                                "UPDATE sessions SET last_activity_at = ?, idle_expires_at = ? WHERE id = ?;",
+                                -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        log_warn("Failed to prepare session activity flush: %s", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        pthread_mutex_unlock(db_mutex);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int64(stmt, 1, pending[i].last_activity_at);
+        sqlite3_bind_int64(stmt, 2, pending[i].idle_expires_at);
+        sqlite3_bind_int64(stmt, 3, pending[i].session_id);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            log_warn("Failed to flush activity for session %lld: %s",
+                     (long long)pending[i].session_id, sqlite3_errmsg(db));
         }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_exec(db, "COMMIT;", NULL, NULL, &err_msg) != SQLITE_OK) {
+        log_warn("Failed to commit session activity flush: %s", err_msg ? err_msg : "unknown error");
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        pthread_mutex_unlock(db_mutex);
+        return -1;
     }
 
+    pthread_mutex_unlock(db_mutex);
+
+    log_debug("Flushed activity for %d sessions", count);
+    return count;
+}
+
+// Whichever request notices the interval has passed does the flush; the
+// others never wait on it.
+static void maybe_flush_session_activity(time_t now) {
+    if (pthread_mutex_trylock(&activity_flush_mutex) != 0) {
+        return;
+    }
+
+    if (last_activity_flush == 0 || now < last_activity_flush) {
+        last_activity_flush = now;
+    } else if (now - last_activity_flush >= SESSION_ACTIVITY_FLUSH_INTERVAL) {
+        last_activity_flush = now;
+        flush_session_activity_locked();
+    }
+
+    pthread_mutex_unlock(&activity_flush_mutex);
+}
+
+int db_auth_flush_session_activity(void) {
+    pthread_mutex_lock(&activity_flush_mutex);
+    last_activity_flush = time(NULL);
+    int rc = flush_session_activity_locked();
+    pthread_mutex_unlock(&activity_flush_mutex);
+    return rc;
+}
+
+void db_auth_shutdown(void) {
+    db_auth_flush_session_activity();
+    auth_cache_clear();
+}
+
+int db_auth_get_session_user(const char *token, user_t *user) {
+    if (!token || !user) {
+        log_error("Token and user pointer are required");
+        return -1;
+    }
+
+    uint8_t key[AUTH_CACHE_KEY_SIZE];
+    auth_cache_entry_t entry;
+    if (get_session_entry(token, time(NULL), key, &entry) != 0) {
+        return -1;
+    }
+
+    *user = entry.user;
+    return 0;
+}
+
+/**
+ * Validate a session token
+ *
+ * Served from the session cache; activity is recorded in memory and written
+ * back in batches, while a changed client IP or user agent is stored at once.
+ */
+int db_auth_validate_session_with_context(const char *token, int64_t *user_id,
+                                          const char *ip_address, const char *user_agent) {
+    if (!token) {
+        log_error("Token is required");
+        return -1;
+    }
+
+    time_t now = time(NULL);
+    uint8_t key[AUTH_CACHE_KEY_SIZE];
+    auth_cache_entry_t entry;
+    if (get_session_entry(token, now, key, &entry) != 0) {
+        return -1;
+    }
+
+    // Session is valid
+    if (user_id) {
+        *user_id = entry.user.id;
+    }
+
+    time_t new_idle_expires_at = now + default_session_idle_expiry_seconds();
+    if (new_idle_expires_at > entry.expires_at) {
+        new_idle_expires_at = entry.expires_at;
+    }
+
+    int changed = auth_cache_record_activity(key, now, default_session_idle_expiry_seconds(),
+                                             ip_address, user_agent, NULL);
+    if (changed > 0) {
+        write_session_tracking(entry.session_id, false, now, new_idle_expires_at,
+                               ip_address, user_agent);
+    } else if (changed < 0) {
+        // Not cached (shard full): fall back to throttled direct writes
+        bool refresh_tracking = should_refresh_session_tracking(now, entry.last_activity_at,
+                                                                entry.idle_expires_at);
+        const char *new_ip = tracking_value_differs(entry.ip_address, ip_address) ? ip_address : NULL;
+        const char *new_ua = tracking_value_differs(entry.user_agent, user_agent) ? user_agent : NULL;
+        write_session_tracking(entry.session_id, refresh_tracking, now, new_idle_expires_at,
+                               new_ip, new_ua);
+    }
+
+    maybe_flush_session_activity(now);
     return 0;
 }
 
@@ -1714,6 +1933,10 @@ int db_auth_delete_session(const char *token) {
 
     sqlite3_finalize(stmt);
 
+    uint8_t key[AUTH_CACHE_KEY_SIZE];
+    auth_cache_key_for(token, key);
+    auth_cache_invalidate_key(key, AUTH_CACHE_SESSION);
+
     log_info("Session deleted successfully");
     return 0;
 }
@@ -1747,6 +1970,8 @@ int db_auth_delete_user_sessions(int64_t user_id) {
 
     sqlite3_finalize(stmt);
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("Sessions deleted successfully for user: %lld", (long long)user_id);
     return 0;
 }
@@ -1761,6 +1986,9 @@ int db_auth_cleanup_sessions(void) {
         return -1;
     }
 
+    // Write cached activity first so active sessions are not idle-expired
+    db_auth_flush_session_activity();
+
     // Delete expired or idle-expired sessions
     sqlite3_stmt *stmt;
     const char *sql = cached_column_exists("sessions", "idle_expires_at")
@@ -1813,6 +2041,9 @@ int db_auth_list_user_sessions(int64_t user_id, session_t *sessions, int max_cou
         return -1;
     }
 
+    // Report activity that is still only in the session cache
+    db_auth_flush_session_activity();
+
     bool has_idle_expires_column = cached_column_exists("sessions", "idle_expires_at");
     bool has_last_activity_column = cached_column_exists("sessions", "last_activity_at");
     time_t now = time(NULL);
@@ -1898,6 +2129,9 @@ int db_auth_delete_session_by_id(int64_t user_id, int64_t session_id) {
     rc = sqlite3_step(stmt);
     int changes = (rc == SQLITE_DONE) ? sqlite3_changes(db) : 0;
     sqlite3_finalize(stmt);
+    if (changes > 0) {
+        auth_cache_invalidate_session(session_id);
+    }
     return (rc == SQLITE_DONE && changes > 0) ? 0 : -1;
 }
 
@@ -2278,6 +2512,8 @@ int db_auth_enable_totp(int64_t user_id, bool enabled) {
         return -1;
     }
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("TOTP %s for user %lld", enabled ? "enabled" : "disabled", (long long)user_id);
     return 0;
 }
@@ -2324,6 +2560,8 @@ int db_auth_set_allowed_tags(int64_t user_id, const char *allowed_tags) {
         return -1;
     }
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("allowed_tags updated for user %lld: %s", (long long)user_id,
              allowed_tags ? allowed_tags : "(unrestricted)");
     return 0;
@@ -2379,6 +2617,8 @@ int db_auth_set_allowed_login_cidrs(int64_t user_id, const char *allowed_login_c
         return -1;
     }
 
+    auth_cache_invalidate_user(user_id);
+
     log_info("allowed_login_cidrs updated for user %lld: %s", (long long)user_id,
              has_entries ? normalized : "(unrestricted)");
     return 0;
@@ -0,0 +1,311 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "database/db_auth_cache.h"
+#include "utils/strings.h"
+
+typedef struct {
+    pthread_mutex_t lock;
+    bool used[AUTH_CACHE_SHARD_SLOTS];
+    auth_cache_entry_t slots[AUTH_CACHE_SHARD_SLOTS];
+} auth_cache_shard_t;
+
+static auth_cache_shard_t shards[AUTH_CACHE_SHARDS];
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
+
+// Bumped by every invalidation, before any entry is removed
+static uint64_t invalidation_generation;
+
+static void init_shards(void) {
+    for (int i = 0; i < AUTH_CACHE_SHARDS; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+    }
+}
+
+// Keys are SHA-256 digests, so any byte is uniformly distributed
+static auth_cache_shard_t *shard_for_key(const uint8_t key[AUTH_CACHE_KEY_SIZE]) {
+    pthread_once(&shards_once, init_shards);
+    return &shards[key[0] % AUTH_CACHE_SHARDS];
+}
+
+static int find_slot(const auth_cache_shard_t *shard, const uint8_t key[AUTH_CACHE_KEY_SIZE],
+                     auth_cache_kind_t kind) {
+    for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS; i++) {
+        if (shard->used[i] && shard->slots[i].kind == kind &&
+            memcmp(shard->slots[i].key, key, AUTH_CACHE_KEY_SIZE) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool entry_expired(const auth_cache_entry_t *e, time_t now) {
+    if (e->expires_at > 0 && now > e->expires_at) {
+        return true;
+    }
+    if (e->idle_expires_at > 0 && now > e->idle_expires_at) {
+        return true;
+    }
+    return false;
+}
+
+static bool entry_stale(const auth_cache_entry_t *e, time_t now) {
+    return now < e->loaded_at || now - e->loaded_at >= AUTH_CACHE_TTL_SECONDS;
+}
+
+static bool entry_has_pending_activity(const auth_cache_entry_t *e) {
+    return e->kind == AUTH_CACHE_SESSION && e->last_activity_at > e->stored_activity_at;
+}
+
+bool auth_cache_get(const uint8_t key[AUTH_CACHE_KEY_SIZE], auth_cache_kind_t kind,
+                    time_t now, auth_cache_entry_t *out) {
+    if (!key) {
+        return false;
+    }
+
+    auth_cache_shard_t *shard = shard_for_key(key);
+    bool hit = false;
+
+    pthread_mutex_lock(&shard->lock);
+    int i = find_slot(shard, key, kind);
+    if (i >= 0) {
+        auth_cache_entry_t *e = &shard->slots[i];
+        if (entry_expired(e, now)) {
+            shard->used[i] = false;
+        } else if (!entry_stale(e, now)) {
+            if (out) {
+                *out = *e;
+            }
+            hit = true;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return hit;
+}
+
+uint64_t auth_cache_generation(void) {
+    return __atomic_load_n(&invalidation_generation, __ATOMIC_ACQUIRE);
+}
+
+static void bump_generation(void) {
+    __atomic_add_fetch(&invalidation_generation, 1, __ATOMIC_ACQ_REL);
+}
+
+static int put_locked(auth_cache_shard_t *shard, const auth_cache_entry_t *entry, time_t now) {
+    int rc = 0;
+
+    int slot = find_slot(shard, entry->key, entry->kind);
+    if (slot >= 0) {
+        const auth_cache_entry_t *old = &shard->slots[slot];
+        auth_cache_entry_t merged = *entry;
+        if (old->session_id == entry->session_id && old->last_activity_at > entry->last_activity_at) {
+            merged.last_activity_at = old->last_activity_at;
+            if (old->idle_expires_at > merged.idle_expires_at) {
+                merged.idle_expires_at = old->idle_expires_at;
+            }
+        }
+        shard->slots[slot] = merged;
+        return 0;
+    }
+
+    // Prefer a free slot, then a dead entry, then the oldest entry with
+    // nothing left to write.  Entries with pending activity are never evicted.
+    int victim = -1;
+    for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS && victim < 0; i++) {
+        if (!shard->used[i]) {
+            victim = i;
+        }
+    }
+    for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS && victim < 0; i++) {
+        const auth_cache_entry_t *e = &shard->slots[i];
+        if (entry_expired(e, now) || (entry_stale(e, now) && !entry_has_pending_activity(e))) {
+            victim = i;
+        }
+    }
+    if (victim < 0) {
+        for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS; i++) {
+            const auth_cache_entry_t *e = &shard->slots[i];
+            if (entry_has_pending_activity(e)) {
+                continue;
+            }
+            if (victim < 0 || e->loaded_at < shard->slots[victim].loaded_at) {
+                victim = i;
+            }
+        }
+    }
+
+    if (victim >= 0) {
+        shard->slots[victim] = *entry;
+        shard->used[victim] = true;
+    } else {
+        rc = -1;
+    }
+
+    return rc;
+}
+
+int auth_cache_put(const auth_cache_entry_t *entry, time_t now) {
+    if (!entry) {
+        return -1;
+    }
+
+    auth_cache_shard_t *shard = shard_for_key(entry->key);
+    pthread_mutex_lock(&shard->lock);
+    int rc = put_locked(shard, entry, now);
+    pthread_mutex_unlock(&shard->lock);
+    return rc;
+}
+
+int auth_cache_put_if_current(const auth_cache_entry_t *entry, time_t now, uint64_t generation) {
+    if (!entry) {
+        return -1;
+    }
+
+    // Checked under the shard lock: an invalidation that bumped the
+    // generation after this check removes the entry once the lock is free
+    auth_cache_shard_t *shard = shard_for_key(entry->key);
+    pthread_mutex_lock(&shard->lock);
+    int rc = 1;
+    if (auth_cache_generation() == generation) {
+        rc = put_locked(shard, entry, now);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return rc;
+}
+
+int auth_cache_record_activity(const uint8_t key[AUTH_CACHE_KEY_SIZE], time_t now,
+                               int idle_seconds, const char *ip_address,
+                               const char *user_agent, auth_cache_entry_t *out) {
+    if (!key) {
+        return -1;
+    }
+
+    auth_cache_shard_t *shard = shard_for_key(key);
+    int rc = -1;
+
+    pthread_mutex_lock(&shard->lock);
+    int i = find_slot(shard, key, AUTH_CACHE_SESSION);
+    if (i >= 0) {
+        auth_cache_entry_t *e = &shard->slots[i];
+        if (entry_expired(e, now)) {
+            shard->used[i] = false;
+        } else {
+            rc = 0;
+
+            if (now > e->last_activity_at) {
+                e->last_activity_at = now;
+            }
+            time_t idle_expires_at = now + idle_seconds;
+            if (e->expires_at > 0 && idle_expires_at > e->expires_at) {
+                idle_expires_at = e->expires_at;
+            }
+            if (idle_expires_at > e->idle_expires_at) {
+                e->idle_expires_at = idle_expires_at;
+            }
+
+            if (ip_address && strcmp(e->ip_address, ip_address) != 0) {
+                safe_strcpy(e->ip_address, ip_address, sizeof(e->ip_address), 0);
+                rc = 1;
+            }
+            if (user_agent && strcmp(e->user_agent, user_agent) != 0) {
+                safe_strcpy(e->user_agent, user_agent, sizeof(e->user_agent), 0);
+                rc = 1;
+            }
+
+            if (out) {
+                *out = *e;
+            }
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return rc;
+}
+
+int auth_cache_take_activity(auth_cache_activity_t *out, int max) {
+    if (!out || max <= 0) {
+        return 0;
+    }
+
+    pthread_once(&shards_once, init_shards);
+
+    int count = 0;
+    for (int s = 0; s < AUTH_CACHE_SHARDS && count < max; s++) {
+        auth_cache_shard_t *shard = &shards[s];
+        pthread_mutex_lock(&shard->lock);
+        for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS && count < max; i++) {
+            auth_cache_entry_t *e = &shard->slots[i];
+            if (!shard->used[i] || !entry_has_pending_activity(e)) {
+                continue;
+            }
+            out[count].session_id = e->session_id;
+            out[count].last_activity_at = e->last_activity_at;
+            out[count].idle_expires_at = e->idle_expires_at;
+            count++;
+            e->stored_activity_at = e->last_activity_at;
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    return count;
+}
+
+void auth_cache_invalidate_key(const uint8_t key[AUTH_CACHE_KEY_SIZE], auth_cache_kind_t kind) {
+    if (!key) {
+        return;
+    }
+
+    bump_generation();
+
+    auth_cache_shard_t *shard = shard_for_key(key);
+    pthread_mutex_lock(&shard->lock);
+    int i = find_slot(shard, key, kind);
+    if (i >= 0) {
+        shard->used[i] = false;
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+// Session ids and user ids are not part of the key, so these walk every shard
+static void invalidate_matching(int64_t session_id, int64_t user_id) {
+    pthread_once(&shards_once, init_shards);
+    bump_generation();
+
+    for (int s = 0; s < AUTH_CACHE_SHARDS; s++) {
+        auth_cache_shard_t *shard = &shards[s];
+        pthread_mutex_lock(&shard->lock);
+        for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS; i++) {
+            if (!shard->used[i]) {
+                continue;
+            }
+            const auth_cache_entry_t *e = &shard->slots[i];
+            if ((session_id > 0 && e->kind == AUTH_CACHE_SESSION && e->session_id == session_id) ||
+                (user_id > 0 && e->user.id == user_id) ||
+                (session_id <= 0 && user_id <= 0)) {
+                shard->used[i] = false;
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+void auth_cache_invalidate_session(int64_t session_id) {
+    if (session_id > 0) {
+        invalidate_matching(session_id, 0);
+    }
+}
+
+void auth_cache_invalidate_user(int64_t user_id) {
+    if (user_id > 0) {
+        invalidate_matching(0, user_id);
+    }
+}
+
+void auth_cache_clear(void) {
+    invalidate_matching(0, 0);
+}
@@ -594,189 +594,589 @@ int get_recording_metadata(time_t start_time, time_t end_time,
     return count;
 }
 
-// Get total count of recordings matching filter criteria
-int get_recording_count(time_t start_time, time_t end_time,
-                       const char *stream_name, int has_detection,
-                       const char *detection_label, int protected_filter,
-                       const char * const *allowed_streams, int allowed_streams_count,
-                       const char *tag_filter, const char *capture_method_filter) {
-    int rc;
-    sqlite3_stmt *stmt;
-    int count = 0;
-    char stream_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char detection_label_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char tag_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char capture_method_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    int stream_filter_count = parse_csv_filter_values(stream_name, stream_filters, MAX_MULTI_FILTER_VALUES);
-    int detection_label_count = parse_csv_filter_values(detection_label, detection_label_filters, MAX_MULTI_FILTER_VALUES);
-    int tag_filter_count = parse_csv_filter_values(tag_filter, tag_filters, MAX_MULTI_FILTER_VALUES);
-    int capture_method_count = parse_csv_filter_values(capture_method_filter, capture_method_filters, MAX_MULTI_FILTER_VALUES);
+/*
+ * Recordings list queries
+ *
+ * get_recording_count(), get_recording_metadata_paginated() and
+ * get_recording_metadata_after() share one filter set.  Three tables
+ * maintained by triggers (migration 0043) keep them fast on large archives:
+ *
+ * - recording_day_counts holds the number of listable recordings per stream
+ *   and day, so a count filtered only by stream and time sums whole days and
+ *   counts the two partial edge days, and a deep page sorted by start_time
+ *   skips whole days before applying the remaining offset;
+ * - recording_labels maps labels to candidate recordings, so a label filter
+ *   only checks the detections of recordings that have seen the label;
+ * - recording_label_names resolves label patterns to exact labels.
+ */
 
-    sqlite3 *db = get_db_handle();
-    pthread_mutex_t *db_mutex = get_db_mutex();
+#define SECONDS_PER_DAY 86400
+
+// Day bounds used for an open end of the time filter
+#define DAY_MIN (-(1LL << 40))
+#define DAY_MAX (1LL << 40)
+
+// Filters of the recordings list, parsed once per query
+typedef struct {
+    time_t start_time;
+    time_t end_time;
+    int has_detection;
+    int protected_filter;
+    char streams[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN];
+    int stream_count;
+    const char * const *allowed_streams;
+    int allowed_streams_count;
+    char labels[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN];
+    int label_count;
+    char tags[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN];
+    int tag_count;
+    char capture_methods[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN];
+    int capture_method_count;
+} recording_list_filter_t;
+
+static void parse_list_filter(recording_list_filter_t *f,
+                              time_t start_time, time_t end_time,
+                              const char *stream_name, int has_detection,
+                              const char *detection_label, int protected_filter,
+                              const char * const *allowed_streams, int allowed_streams_count,
+                              const char *tag_filter, const char *capture_method_filter) {
+    memset(f, 0, sizeof(*f));
+    f->start_time = start_time;
+    f->end_time = end_time;
+    f->has_detection = has_detection;
+    f->protected_filter = protected_filter;
+    f->stream_count = parse_csv_filter_values(stream_name, f->streams, MAX_MULTI_FILTER_VALUES);
+    if (allowed_streams && allowed_streams_count > 0) {
+        f->allowed_streams = allowed_streams;
+        f->allowed_streams_count = allowed_streams_count;
+    }
+    f->label_count = parse_csv_filter_values(detection_label, f->labels, MAX_MULTI_FILTER_VALUES);
+    f->tag_count = parse_csv_filter_values(tag_filter, f->tags, MAX_MULTI_FILTER_VALUES);
+    f->capture_method_count = parse_csv_filter_values(capture_method_filter, f->capture_methods,
+                                                      MAX_MULTI_FILTER_VALUES);
+}
 
-    if (!db) {
-        log_error("Database not initialized");
-        return -1;
+// Append "AND <column> IN (?,...)" for the stream filter, or the RBAC whitelist
+static void append_stream_filter_sql(const recording_list_filter_t *f, const char *column,
+                                     char *sql, size_t sql_size) {
+    int n = f->stream_count > 0 ? f->stream_count : f->allowed_streams_count;
+    if (n == 0) {
+        return;
     }
 
-    pthread_mutex_lock(db_mutex);
+    safe_strcat(sql, " AND ", sql_size);
+    safe_strcat(sql, column, sql_size);
+    safe_strcat(sql, " IN (", sql_size);
+    for (int i = 0; i < n; i++) {
+        if (i > 0) safe_strcat(sql, ",", sql_size);
+        safe_strcat(sql, "?", sql_size);
+    }
+    safe_strcat(sql, ")", sql_size);
+}
 
-    // Build query based on filters
-    char sql[8192];
+static int bind_stream_filter(sqlite3_stmt *stmt, const recording_list_filter_t *f, int param_index) {
+    if (f->stream_count > 0) {
+        for (int i = 0; i < f->stream_count; i++) {
+            sqlite3_bind_text(stmt, param_index++, f->streams[i], -1, SQLITE_TRANSIENT);
+        }
+    } else {
+        for (int i = 0; i < f->allowed_streams_count; i++) {
+            sqlite3_bind_text(stmt, param_index++, f->allowed_streams[i], -1, SQLITE_STATIC);
+        }
+    }
+    return param_index;
+}
 
-    // Use trigger_type and/or detections table to filter detection-based recordings
-    safe_strcpy(sql, "SELECT COUNT(*) FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL", sizeof(sql), 0);
+static void append_label_likes(const recording_list_filter_t *f, const char *column,
+                               char *sql, size_t sql_size) {
+    for (int i = 0; i < f->label_count; i++) {
+        if (i > 0) safe_strcat(sql, " OR ", sql_size);
+        safe_strcat(sql, column, sql_size);
+        safe_strcat(sql, " LIKE ?", sql_size);
+    }
+}
 
-    if (has_detection == 1) {
+// Append the WHERE conditions of every filter (after the base condition)
+static void append_list_filter_sql(const recording_list_filter_t *f, char *sql, size_t sql_size) {
+    if (f->has_detection == 1) {
         // Filter by trigger_type = 'detection' OR existence of linked detections via recording_id (fast index lookup)
         // Falls back to timestamp range scan for legacy detections without recording_id
         safe_strcat(sql, " AND (r.trigger_type = 'detection'"
                     " OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
                     " OR EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
                     " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time))",
-                    sizeof(sql));
-        log_debug("Adding detection filter (trigger_type OR recording_id OR timestamp range)");
-    } else if (has_detection == -1) {
+                    sql_size);
+    } else if (f->has_detection == -1) {
         // Filter to recordings with NO detections
         safe_strcat(sql, " AND (r.trigger_type != 'detection' OR r.trigger_type IS NULL)"
                     " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
                     " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
                     " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)",
-                    sizeof(sql));
-        log_debug("Adding no-detection filter (no trigger_type AND no linked detections)");
+                    sql_size);
     }
 
-    if (detection_label_count > 0) {
-        // Filter by specific detection label - prefer recording_id FK lookup, fall back to timestamp range
+    if (f->label_count > 0) {
+        // Candidates come from the label index; the detections are still
+        // checked because the index may hold labels of deleted detections
+        safe_strcat(sql, " AND r.id IN (SELECT rl.recording_id FROM recording_labels rl"
+                    " WHERE rl.label IN (SELECT n.label FROM recording_label_names n WHERE ",
+                    sql_size);
+        append_label_likes(f, "n.label", sql, sql_size);
+        safe_strcat(sql, "))", sql_size);
+
+        // Prefer recording_id FK lookup, fall back to timestamp range
         safe_strcat(sql, " AND (EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id AND (",
-                sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
+                    sql_size);
+        append_label_likes(f, "d.label", sql, sql_size);
         safe_strcat(sql, ")) OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id IS NULL"
                     " AND d.stream_name = r.stream_name AND d.timestamp >= r.start_time"
                     " AND d.timestamp <= r.end_time AND (",
-                    sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
-        safe_strcat(sql, ")))", sizeof(sql));
-        log_debug("Adding %d detection_label filters", detection_label_count);
+                    sql_size);
+        append_label_likes(f, "d.label", sql, sql_size);
+        safe_strcat(sql, ")))", sql_size);
     }
 
-    if (start_time > 0) {
-        safe_strcat(sql, " AND r.start_time >= ?", sizeof(sql));
-        log_debug("Adding start_time filter: %ld", (long)start_time);
+    if (f->start_time > 0) {
+        safe_strcat(sql, " AND r.start_time >= ?", sql_size);
     }
 
-    if (end_time > 0) {
-        safe_strcat(sql, " AND r.start_time <= ?", sizeof(sql));
-        log_debug("Adding end_time filter: %ld", (long)end_time);
+    if (f->end_time > 0) {
+        safe_strcat(sql, " AND r.start_time <= ?", sql_size);
     }
 
-    if (stream_filter_count > 0) {
-        safe_strcat(sql, " AND r.stream_name IN (", sizeof(sql));
-        for (int i = 0; i < stream_filter_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, ")", sizeof(sql));
-    } else if (allowed_streams && allowed_streams_count > 0) {
-        // Tag-based RBAC: restrict to the user's whitelisted streams via IN clause
-        safe_strcat(sql, " AND r.stream_name IN (", sizeof(sql));
-        for (int i = 0; i < allowed_streams_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, ")", sizeof(sql));
-        log_debug("Adding allowed_streams IN filter (%d streams)", allowed_streams_count);
-    }
+    append_stream_filter_sql(f, "r.stream_name", sql, sql_size);
 
-    if (protected_filter == 0) {
-        safe_strcat(sql, " AND r.protected = 0", sizeof(sql));
-        log_debug("Adding protected_filter=0 (unprotected only)");
-    } else if (protected_filter == 1) {
-        safe_strcat(sql, " AND r.protected = 1", sizeof(sql));
-        log_debug("Adding protected_filter=1 (protected only)");
+    if (f->protected_filter == 0) {
+        safe_strcat(sql, " AND r.protected = 0", sql_size);
+    } else if (f->protected_filter == 1) {
+        safe_strcat(sql, " AND r.protected = 1", sql_size);
     }
 
-    if (tag_filter_count > 0) {
+    if (f->tag_count > 0) {
         safe_strcat(sql, " AND EXISTS (SELECT 1 FROM recording_tags rt WHERE rt.recording_id = r.id AND rt.tag IN (",
-                sizeof(sql));
-        for (int i = 0; i < tag_filter_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
+                    sql_size);
+        for (int i = 0; i < f->tag_count; i++) {
+            if (i > 0) safe_strcat(sql, ",", sql_size);
+            safe_strcat(sql, "?", sql_size);
         }
-        safe_strcat(sql, "))", sizeof(sql));
-        log_debug("Adding %d tag filters", tag_filter_count);
+        safe_strcat(sql, "))", sql_size);
     }
 
-    if (capture_method_count > 0) {
-        safe_strcat(sql, " AND COALESCE(r.trigger_type, 'scheduled') IN (", sizeof(sql));
-        for (int i = 0; i < capture_method_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
+    if (f->capture_method_count > 0) {
+        safe_strcat(sql, " AND COALESCE(r.trigger_type, 'scheduled') IN (", sql_size);
+        for (int i = 0; i < f->capture_method_count; i++) {
+            if (i > 0) safe_strcat(sql, ",", sql_size);
+            safe_strcat(sql, "?", sql_size);
         }
-        safe_strcat(sql, ")", sizeof(sql));
-        log_debug("Adding %d capture_method filters", capture_method_count);
+        safe_strcat(sql, ")", sql_size);
     }
 
-    log_debug("SQL query for get_recording_count: %s", sql);
+    log_debug("Recordings list filters: streams=%d allowed=%d labels=%d tags=%d capture=%d "
+              "has_detection=%d protected=%d start=%ld end=%ld",
+              f->stream_count, f->allowed_streams_count, f->label_count, f->tag_count,
+              f->capture_method_count, f->has_detection, f->protected_filter,
+              (long)f->start_time, (long)f->end_time);
+}
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
+// Bind the parameters added by append_list_filter_sql(); returns the next index
+static int bind_list_filter(sqlite3_stmt *stmt, const recording_list_filter_t *f, int param_index) {
+    // Label patterns are used three times: label names, linked and unlinked detections
+    for (int pass = 0; pass < 3 && f->label_count > 0; pass++) {
+        for (int i = 0; i < f->label_count; i++) {
+            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
+            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", f->labels[i]);
+            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
+        }
+    }
+
+    if (f->start_time > 0) {
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)f->start_time);
+    }
+
+    if (f->end_time > 0) {
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)f->end_time);
+    }
+
+    param_index = bind_stream_filter(stmt, f, param_index);
+
+    for (int i = 0; i < f->tag_count; i++) {
+        sqlite3_bind_text(stmt, param_index++, f->tags[i], -1, SQLITE_TRANSIENT);
+    }
+
+    for (int i = 0; i < f->capture_method_count; i++) {
+        sqlite3_bind_text(stmt, param_index++, f->capture_methods[i], -1, SQLITE_TRANSIENT);
+    }
+
+    return param_index;
+}
+
+// Whether the per-day counters answer this filter (stream and time filters only)
+static bool list_filter_uses_day_counts(const recording_list_filter_t *f) {
+    return f->has_detection == 0 && f->label_count == 0 &&
+           f->protected_filter != 0 && f->protected_filter != 1 &&
+           f->tag_count == 0 && f->capture_method_count == 0;
+}
+
+// Whole days inside the time filter, and the partial days around them
+typedef struct {
+    long long first_day;    // First and last whole day (first > last when none)
+    long long last_day;
+    long long low_from;     // Partial range below first_day (from > to when empty)
+    long long low_to;
+    long long high_from;    // Partial range above last_day (from > to when empty)
+    long long high_to;
+} day_split_t;
+
+static void split_time_filter(const recording_list_filter_t *f, day_split_t *s) {
+    long long from = f->start_time > 0 ? (long long)f->start_time : DAY_MIN * SECONDS_PER_DAY;
+    long long to = f->end_time > 0 ? (long long)f->end_time : DAY_MAX * SECONDS_PER_DAY - 1;
+
+    s->first_day = from / SECONDS_PER_DAY + (from % SECONDS_PER_DAY != 0 ? 1 : 0);
+    s->last_day = (to + 1) / SECONDS_PER_DAY - 1;
+
+    if (s->first_day <= s->last_day) {
+        s->low_from = from;
+        s->low_to = s->first_day * SECONDS_PER_DAY - 1;
+        s->high_from = (s->last_day + 1) * SECONDS_PER_DAY;
+        s->high_to = to;
+    } else {
+        s->low_from = from;
+        s->low_to = to;
+        s->high_from = 1;
+        s->high_to = 0;
+    }
+}
+
+// Count listable recordings with start_time in [from, to] for the stream filter
+static int count_recordings_in_range(sqlite3 *db, const recording_list_filter_t *f,
+                                     long long from, long long to) {
+    if (from > to) {
+        return 0;
+    }
+
+    char sql[4096];
+    safe_strcpy(sql, "SELECT COUNT(*) FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL"
+                " AND r.start_time >= ? AND r.start_time <= ?", sizeof(sql), 0);
+    append_stream_filter_sql(f, "r.stream_name", sql, sizeof(sql));
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
         return -1;
     }
 
-    // No longer tracking statements - each function is responsible for finalizing its own statements
+    sqlite3_bind_int64(stmt, 1, from);
+    sqlite3_bind_int64(stmt, 2, to);
+    bind_stream_filter(stmt, f, 3);
 
-    // Bind parameters
-    int param_index = 1;
+    int count = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    } else {
+        log_error("Error while counting recordings: %s", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
 
-    if (detection_label_count > 0) {
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
+// Prepare "SELECT day, SUM(count)" over the whole days of the filter, in the given order
+static sqlite3_stmt *prepare_day_counts(sqlite3 *db, const recording_list_filter_t *f,
+                                        const day_split_t *s, bool grouped, bool descending) {
+    char sql[4096];
+    safe_strcpy(sql, grouped ? "SELECT c.day, SUM(c.count) FROM recording_day_counts c"
+                             : "SELECT 0, COALESCE(SUM(c.count), 0) FROM recording_day_counts c",
+                sizeof(sql), 0);
+    safe_strcat(sql, " WHERE c.day >= ? AND c.day <= ?", sizeof(sql));
+    append_stream_filter_sql(f, "c.stream_name", sql, sizeof(sql));
+    if (grouped) {
+        safe_strcat(sql, descending ? " GROUP BY c.day ORDER BY c.day DESC"
+                                    : " GROUP BY c.day ORDER BY c.day ASC", sizeof(sql));
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+        return NULL;
+    }
+
+    sqlite3_bind_int64(stmt, 1, s->first_day);
+    sqlite3_bind_int64(stmt, 2, s->last_day);
+    bind_stream_filter(stmt, f, 3);
+    return stmt;
+}
+
+// Count from the per-day counters; the caller holds the database mutex
+static int count_from_day_counts(sqlite3 *db, const recording_list_filter_t *f) {
+    day_split_t s;
+    split_time_filter(f, &s);
+
+    int count = 0;
+    if (s.first_day <= s.last_day) {
+        sqlite3_stmt *stmt = prepare_day_counts(db, f, &s, false, false);
+        if (!stmt) {
+            return -1;
         }
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            count = (int)sqlite3_column_int64(stmt, 1);
+        } else {
+            log_error("Error while reading recording day counts: %s", sqlite3_errmsg(db));
+            count = -1;
+        }
+        sqlite3_finalize(stmt);
+        if (count < 0) {
+            return -1;
         }
     }
 
-    if (start_time > 0) {
-        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)start_time);
+    int low = count_recordings_in_range(db, f, s.low_from, s.low_to);
+    int high = count_recordings_in_range(db, f, s.high_from, s.high_to);
+    if (low < 0 || high < 0) {
+        return -1;
     }
 
-    if (end_time > 0) {
-        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)end_time);
+    return count + low + high;
+}
+
+/*
+ * Skip whole days of a start_time-ordered page
+ *
+ * Narrows the time filter past the recordings the offset skips and reduces
+ * the offset by their number, so SQLite only steps over the rest.  The
+ * caller holds the database mutex.
+ */
+static void seek_by_day_counts(sqlite3 *db, recording_list_filter_t *f, bool descending, int *offset) {
+    day_split_t s;
+    split_time_filter(f, &s);
+    if (s.first_day > s.last_day) {
+        return;
     }
 
-    if (stream_filter_count > 0) {
-        for (int i = 0; i < stream_filter_count; i++) {
-            sqlite3_bind_text(stmt, param_index++, stream_filters[i], -1, SQLITE_TRANSIENT);
-        }
-    } else if (allowed_streams && allowed_streams_count > 0) {
-        for (int i = 0; i < allowed_streams_count; i++) {
-            sqlite3_bind_text(stmt, param_index++, allowed_streams[i], -1, SQLITE_STATIC);
+    // Recordings of the partial day that comes first in sort order
+    int edge = descending ? count_recordings_in_range(db, f, s.high_from, s.high_to)
+                          : count_recordings_in_range(db, f, s.low_from, s.low_to);
+    if (edge < 0 || *offset < edge) {
+        return;
+    }
+
+    int remaining = *offset - edge;
+    long long bound = descending ? s.high_from - 1 : s.low_to + 1;
+
+    sqlite3_stmt *stmt = prepare_day_counts(db, f, &s, true, descending);
+    if (!stmt) {
+        return;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        long long day = sqlite3_column_int64(stmt, 0);
+        int day_count = (int)sqlite3_column_int64(stmt, 1);
+        long long next = descending ? day * SECONDS_PER_DAY - 1 : (day + 1) * SECONDS_PER_DAY;
+        if (remaining < day_count || next <= 0) {
+            break;
         }
+        remaining -= day_count;
+        bound = next;
+    }
+    sqlite3_finalize(stmt);
+
+    // A bound of 0 would mean "no filter"; nothing is stored that early
+    if (bound <= 0) {
+        return;
+    }
+
+    if (descending) {
+        f->end_time = (time_t)bound;
+    } else {
+        f->start_time = (time_t)bound;
+    }
+    log_debug("Skipped %d recordings by day counts, offset now %d", *offset - remaining, remaining);
+    *offset = remaining;
+}
+
+// Copy the columns of a recordings list row
+static void read_recording_row(sqlite3_stmt *stmt, recording_metadata_t *m) {
+    m->id = (uint64_t)sqlite3_column_int64(stmt, 0);
+
+    const char *stream = (const char *)sqlite3_column_text(stmt, 1);
+    if (stream) {
+        safe_strcpy(m->stream_name, stream, sizeof(m->stream_name), 0);
+    } else {
+        m->stream_name[0] = '\0';
+    }
+
+    const char *path = (const char *)sqlite3_column_text(stmt, 2);
+    if (path) {
+        safe_strcpy(m->file_path, path, sizeof(m->file_path), 0);
+    } else {
+        m->file_path[0] = '\0';
+    }
+
+    m->start_time = (time_t)sqlite3_column_int64(stmt, 3);
+
+    if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) {
+        m->end_time = (time_t)sqlite3_column_int64(stmt, 4);
+    } else {
+        m->end_time = 0;
+    }
+
+    m->size_bytes = (uint64_t)sqlite3_column_int64(stmt, 5);
+    m->width = sqlite3_column_int(stmt, 6);
+    m->height = sqlite3_column_int(stmt, 7);
+    m->fps = sqlite3_column_int(stmt, 8);
+
+    const char *codec = (const char *)sqlite3_column_text(stmt, 9);
+    if (codec) {
+        safe_strcpy(m->codec, codec, sizeof(m->codec), 0);
+    } else {
+        m->codec[0] = '\0';
+    }
+
+    m->is_complete = sqlite3_column_int(stmt, 10) != 0;
+
+    const char *trigger_type = (const char *)sqlite3_column_text(stmt, 11);
+    if (trigger_type) {
+        safe_strcpy(m->trigger_type, trigger_type, sizeof(m->trigger_type), 0);
+    } else {
+        safe_strcpy(m->trigger_type, "scheduled", sizeof(m->trigger_type), 0);
+    }
+
+    m->protected = sqlite3_column_int(stmt, 12) != 0;
+
+    if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) {
+        m->retention_override_days = sqlite3_column_int(stmt, 13);
+    } else {
+        m->retention_override_days = -1;
+    }
+
+    m->retention_tier = (sqlite3_column_type(stmt, 14) != SQLITE_NULL)
+        ? sqlite3_column_int(stmt, 14) : RETENTION_TIER_STANDARD;
+    m->disk_pressure_eligible = (sqlite3_column_type(stmt, 15) != SQLITE_NULL)
+        ? (sqlite3_column_int(stmt, 15) != 0) : true;
+}
+
+/*
+ * Run a recordings list page query; the caller holds the database mutex
+ *
+ * sort_field must already be validated.  With after set, the page starts
+ * just past that recording in (start_time, id) order and sort_field must be
+ * start_time.
+ */
+static int query_recording_page(sqlite3 *db, const recording_list_filter_t *f,
+                                const char *sort_field, bool descending,
+                                const recording_cursor_t *after,
+                                recording_metadata_t *metadata, int limit, int offset) {
+    char sql[8192];
+    safe_strcpy(sql,
+                "SELECT r.id, r.stream_name, r.file_path, r.start_time, r.end_time, "
+                "r.size_bytes, r.width, r.height, r.fps, r.codec, r.is_complete, r.trigger_type, "
+                "r.protected, r.retention_override_days, r.retention_tier, r.disk_pressure_eligible "
+                "FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL",
+                sizeof(sql), 0);
+
+    append_list_filter_sql(f, sql, sizeof(sql));
+
+    if (after) {
+        safe_strcat(sql, descending
+                    ? " AND r.start_time <= ? AND (r.start_time < ? OR r.id < ?)"
+                    : " AND r.start_time >= ? AND (r.start_time > ? OR r.id > ?)",
+                    sizeof(sql));
+    }
+
+    // id breaks ties so that pages never overlap or skip rows
+    const char *order = descending ? "DESC" : "ASC";
+    char order_clause[96];
+    if (strcmp(sort_field, "id") == 0) {
+        snprintf(order_clause, sizeof(order_clause), " ORDER BY r.id %s", order);
+    } else {
+        snprintf(order_clause, sizeof(order_clause), " ORDER BY r.%s %s, r.id %s",
+                 sort_field, order, order);
     }
+    safe_strcat(sql, order_clause, sizeof(sql));
+    safe_strcat(sql, " LIMIT ? OFFSET ?", sizeof(sql));
+
+    log_debug("SQL query for recordings page: %s", sql);
+
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    int param_index = bind_list_filter(stmt, f, 1);
+    if (after) {
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)after->start_time);
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)after->start_time);
+        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)after->id);
+    }
+    sqlite3_bind_int(stmt, param_index++, limit);
+    sqlite3_bind_int(stmt, param_index, offset);
 
-    for (int i = 0; i < tag_filter_count; i++) {
-        sqlite3_bind_text(stmt, param_index++, tag_filters[i], -1, SQLITE_TRANSIENT);
+    int count = 0;
+    int rc_step;
+    while ((rc_step = sqlite3_step(stmt)) == SQLITE_ROW && count < limit) {
+        read_recording_row(stmt, &metadata[count]);
+        count++;
     }
 
-    for (int i = 0; i < capture_method_count; i++) {
-        sqlite3_bind_text(stmt, param_index++, capture_method_filters[i], -1, SQLITE_TRANSIENT);
+    if (rc_step != SQLITE_DONE && rc_step != SQLITE_ROW) {
+        log_error("Error while fetching recordings: %s", sqlite3_errmsg(db));
     }
 
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+// Get total count of recordings matching filter criteria
+int get_recording_count(time_t start_time, time_t end_time,
+                       const char *stream_name, int has_detection,
+                       const char *detection_label, int protected_filter,
+                       const char * const *allowed_streams, int allowed_streams_count,
+                       const char *tag_filter, const char *capture_method_filter) {
+    int rc;
+    sqlite3_stmt *stmt;
+    int count = 0;
+    recording_list_filter_t filter;
+    parse_list_filter(&filter, start_time, end_time, stream_name, has_detection,
+                      detection_label, protected_filter, allowed_streams, allowed_streams_count,
+                      tag_filter, capture_method_filter);
+
+    sqlite3 *db = get_db_handle();
+    pthread_mutex_t *db_mutex = get_db_mutex();
+
+    if (!db) {
+        log_error("Database not initialized");
+        return -1;
+    }
+
+    pthread_mutex_lock(db_mutex);
+
+    if (list_filter_uses_day_counts(&filter)) {
+        count = count_from_day_counts(db, &filter);
+        pthread_mutex_unlock(db_mutex);
+        log_debug("Total count of recordings matching criteria (day counts): %d", count);
+        return count;
+    }
+
+    // Build query based on filters.  With a label filter the unary + keeps
+    // SQLite from scanning the is_complete index, so it counts by walking the
+    // label index's candidates instead.
+    char sql[8192];
+    safe_strcpy(sql, filter.label_count > 0
+                ? "SELECT COUNT(*) FROM recordings r WHERE +r.is_complete = 1 AND r.end_time IS NOT NULL"
+                : "SELECT COUNT(*) FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL",
+                sizeof(sql), 0);
+    append_list_filter_sql(&filter, sql, sizeof(sql));
+
+    log_debug("SQL query for get_recording_count: %s", sql);
+
+    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+        pthread_mutex_unlock(db_mutex);
+        return -1;
+    }
+
+    bind_list_filter(stmt, &filter, 1);
+
     // Execute query and get count
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
@@ -803,17 +1203,10 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
                                    int limit, int offset,
                                    const char * const *allowed_streams, int allowed_streams_count,
                                    const char *tag_filter, const char *capture_method_filter) {
-    int rc;
-    sqlite3_stmt *stmt;
-    int count = 0;
-    char stream_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char detection_label_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char tag_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    char capture_method_filters[MAX_MULTI_FILTER_VALUES][MAX_MULTI_FILTER_VALUE_LEN] = {{0}};
-    int stream_filter_count = parse_csv_filter_values(stream_name, stream_filters, MAX_MULTI_FILTER_VALUES);
-    int detection_label_count = parse_csv_filter_values(detection_label, detection_label_filters, MAX_MULTI_FILTER_VALUES);
-    int tag_filter_count = parse_csv_filter_values(tag_filter, tag_filters, MAX_MULTI_FILTER_VALUES);
-    int capture_method_count = parse_csv_filter_values(capture_method_filter, capture_method_filters, MAX_MULTI_FILTER_VALUES);
+    recording_list_filter_t filter;
+    parse_list_filter(&filter, start_time, end_time, stream_name, has_detection,
+                      detection_label, protected_filter, allowed_streams, allowed_streams_count,
+                      tag_filter, capture_method_filter);
 
     sqlite3 *db = get_db_handle();
     pthread_mutex_t *db_mutex = get_db_mutex();
@@ -828,7 +1221,9 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
         return -1;
     }
 
-    pthread_mutex_lock(db_mutex);
+    if (offset < 0) {
+        offset = 0;
+    }
 
     // Validate and sanitize sort field to prevent SQL injection
     char safe_sort_field[32] = "start_time"; // Default sort field
@@ -845,267 +1240,71 @@ int get_recording_metadata_paginated(time_t start_time, time_t end_time,
     }
 
     // Validate sort order
-    char safe_sort_order[8] = "DESC"; // Default sort order
+    bool descending = true; // Default sort order
     if (sort_order) {
         if (strcasecmp(sort_order, "asc") == 0) {
-            strcpy(safe_sort_order, "ASC");
-        } else if (strcasecmp(sort_order, "desc") == 0) {
-            strcpy(safe_sort_order, "DESC");
-        } else {
+            descending = false;
+        } else if (strcasecmp(sort_order, "desc") != 0) {
             log_warn("Invalid sort order: %s, using default", sort_order);
         }
     }
 
-    // Build query based on filters
-    char sql[8192];
-
-    // Use trigger_type and/or detections table to filter detection-based recordings
-    snprintf(sql, sizeof(sql),
-            "SELECT r.id, r.stream_name, r.file_path, r.start_time, r.end_time, "
-            "r.size_bytes, r.width, r.height, r.fps, r.codec, r.is_complete, r.trigger_type, "
-            "r.protected, r.retention_override_days, r.retention_tier, r.disk_pressure_eligible "
-            "FROM recordings r WHERE r.is_complete = 1 AND r.end_time IS NOT NULL");
-
-    if (has_detection == 1) {
-        // Filter by trigger_type = 'detection' OR existence of linked detections via recording_id (fast index lookup)
-        // Falls back to timestamp range scan for legacy detections without recording_id
-        safe_strcat(sql, " AND (r.trigger_type = 'detection'"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " OR EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time))",
-                    sizeof(sql));
-        log_info("Adding detection filter (trigger_type OR recording_id OR timestamp range)");
-    } else if (has_detection == -1) {
-        // Filter to recordings with NO detections
-        safe_strcat(sql, " AND (r.trigger_type != 'detection' OR r.trigger_type IS NULL)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id)"
-                    " AND NOT EXISTS (SELECT 1 FROM detections d WHERE d.stream_name = r.stream_name"
-                    " AND d.timestamp >= r.start_time AND d.timestamp <= r.end_time)",
-                    sizeof(sql));
-        log_info("Adding no-detection filter (no trigger_type AND no linked detections)");
-    }
-
-    if (detection_label_count > 0) {
-        // Filter by specific detection label - prefer recording_id FK lookup, fall back to timestamp range
-        safe_strcat(sql, " AND (EXISTS (SELECT 1 FROM detections d WHERE d.recording_id = r.id AND (",
-                sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
-        safe_strcat(sql, ")) OR EXISTS (SELECT 1 FROM detections d WHERE d.recording_id IS NULL"
-                    " AND d.stream_name = r.stream_name AND d.timestamp >= r.start_time"
-                    " AND d.timestamp <= r.end_time AND (",
-                    sizeof(sql));
-        for (int i = 0; i < detection_label_count; i++) {
-            if (i > 0) safe_strcat(sql, " OR ", sizeof(sql));
-            safe_strcat(sql, "d.label LIKE ?", sizeof(sql));
-        }
-        safe_strcat(sql, ")))", sizeof(sql));
-        log_info("Adding %d detection_label filters", detection_label_count);
-    }
-
-    if (start_time > 0) {
-        safe_strcat(sql, " AND r.start_time >= ?", sizeof(sql));
-        log_info("Adding start_time filter to paginated query: %ld", (long)start_time);
-    }
-
-    if (end_time > 0) {
-        safe_strcat(sql, " AND r.start_time <= ?", sizeof(sql));
-        log_info("Adding end_time filter to paginated query: %ld", (long)end_time);
-    }
-
-    if (stream_filter_count > 0) {
-        safe_strcat(sql, " AND r.stream_name IN (", sizeof(sql));
-        for (int i = 0; i < stream_filter_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, ")", sizeof(sql));
-    } else if (allowed_streams && allowed_streams_count > 0) {
-        // Tag-based RBAC: restrict to the user's whitelisted streams via IN clause
-        safe_strcat(sql, " AND r.stream_name IN (", sizeof(sql));
-        for (int i = 0; i < allowed_streams_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, ")", sizeof(sql));
-        log_debug("Adding allowed_streams IN filter (%d streams) to paginated query", allowed_streams_count);
-    }
+    pthread_mutex_lock(db_mutex);
 
-    if (protected_filter == 0) {
-        safe_strcat(sql, " AND r.protected = 0", sizeof(sql));
-        log_debug("Adding protected_filter=0 (unprotected only) to paginated query");
-    } else if (protected_filter == 1) {
-        safe_strcat(sql, " AND r.protected = 1", sizeof(sql));
-        log_debug("Adding protected_filter=1 (protected only) to paginated query");
+    int page_offset = offset;
+    if (page_offset > 0 && strcmp(safe_sort_field, "start_time") == 0 &&
+        list_filter_uses_day_counts(&filter)) {
+        seek_by_day_counts(db, &filter, descending, &page_offset);
     }
 
-    if (tag_filter_count > 0) {
-        safe_strcat(sql, " AND EXISTS (SELECT 1 FROM recording_tags rt WHERE rt.recording_id = r.id AND rt.tag IN (",
-                sizeof(sql));
-        for (int i = 0; i < tag_filter_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, "))", sizeof(sql));
-        log_debug("Adding %d tag filters to paginated query", tag_filter_count);
-    }
+    int count = query_recording_page(db, &filter, safe_sort_field, descending, NULL,
+                                     metadata, limit, page_offset);
 
-    if (capture_method_count > 0) {
-        safe_strcat(sql, " AND COALESCE(r.trigger_type, 'scheduled') IN (", sizeof(sql));
-        for (int i = 0; i < capture_method_count; i++) {
-            if (i > 0) safe_strcat(sql, ",", sizeof(sql));
-            safe_strcat(sql, "?", sizeof(sql));
-        }
-        safe_strcat(sql, ")", sizeof(sql));
-        log_debug("Adding %d capture_method filters to paginated query", capture_method_count);
-    }
+    pthread_mutex_unlock(db_mutex);
 
-    // Add ORDER BY clause with sanitized field and order
-    char order_clause[64];
-    snprintf(order_clause, sizeof(order_clause), " ORDER BY r.%s %s", safe_sort_field, safe_sort_order);
-    safe_strcat(sql, order_clause, sizeof(sql));
+    log_debug("Found %d recordings in database matching criteria (page %d, limit %d)",
+             count, (offset / limit) + 1, limit);
+    return count;
+}
 
-    // Add LIMIT and OFFSET for pagination
-    char limit_clause[64];
-    safe_strcpy(limit_clause, " LIMIT ? OFFSET ?", sizeof(limit_clause), 0);
-    safe_strcat(sql, limit_clause, sizeof(sql));
+// Get the page of recordings that follows a cursor, ordered by start time
+int get_recording_metadata_after(time_t start_time, time_t end_time,
+                                 const char *stream_name, int has_detection,
+                                 const char *detection_label,
+                                 int protected_filter,
+                                 const char *sort_order,
+                                 const recording_cursor_t *after,
+                                 recording_metadata_t *metadata, int limit,
+                                 const char * const *allowed_streams, int allowed_streams_count,
+                                 const char *tag_filter, const char *capture_method_filter) {
+    recording_list_filter_t filter;
+    parse_list_filter(&filter, start_time, end_time, stream_name, has_detection,
+                      detection_label, protected_filter, allowed_streams, allowed_streams_count,
+                      tag_filter, capture_method_filter);
 
-    log_debug("SQL query for get_recording_metadata_paginated: %s", sql);
+    sqlite3 *db = get_db_handle();
+    pthread_mutex_t *db_mutex = get_db_mutex();
 
-    rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        pthread_mutex_unlock(db_mutex);
+    if (!db) {
+        log_error("Database not initialized");
         return -1;
     }
 
-    // No longer tracking statements - each function is responsible for finalizing its own statements
-
-    // Bind parameters
-    int param_index = 1;
-
-    if (detection_label_count > 0) {
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
-        for (int i = 0; i < detection_label_count; i++) {
-            char label_pattern[MAX_MULTI_FILTER_VALUE_LEN + 2];
-            snprintf(label_pattern, sizeof(label_pattern), "%%%s%%", detection_label_filters[i]);
-            sqlite3_bind_text(stmt, param_index++, label_pattern, -1, SQLITE_TRANSIENT);
-        }
-    }
-
-    if (start_time > 0) {
-        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)start_time);
-    }
-
-    if (end_time > 0) {
-        sqlite3_bind_int64(stmt, param_index++, (sqlite3_int64)end_time);
-    }
-
-    if (stream_filter_count > 0) {
-        for (int i = 0; i < stream_filter_count; i++) {
-            sqlite3_bind_text(stmt, param_index++, stream_filters[i], -1, SQLITE_TRANSIENT);
-        }
-    } else if (allowed_streams && allowed_streams_count > 0) {
-        for (int i = 0; i < allowed_streams_count; i++) {
-            sqlite3_bind_text(stmt, param_index++, allowed_streams[i], -1, SQLITE_STATIC);
-        }
-    }
-
-    for (int i = 0; i < tag_filter_count; i++) {
-        sqlite3_bind_text(stmt, param_index++, tag_filters[i], -1, SQLITE_TRANSIENT);
-    }
-
-    for (int i = 0; i < capture_method_count; i++) {
-        sqlite3_bind_text(stmt, param_index++, capture_method_filters[i], -1, SQLITE_TRANSIENT);
-    }
-
-    // Bind LIMIT and OFFSET parameters
-    sqlite3_bind_int(stmt, param_index++, limit);
-    sqlite3_bind_int(stmt, param_index, offset);
-
-    // Execute query and fetch results
-    int rc_step;
-    while ((rc_step = sqlite3_step(stmt)) == SQLITE_ROW && count < limit) {
-        // Safely copy data to metadata structure
-        {
-            metadata[count].id = (uint64_t)sqlite3_column_int64(stmt, 0);
-
-            const char *stream = (const char *)sqlite3_column_text(stmt, 1);
-            if (stream) {
-                safe_strcpy(metadata[count].stream_name, stream, sizeof(metadata[count].stream_name), 0);
-            } else {
-                metadata[count].stream_name[0] = '\0';
-            }
-
-            const char *path = (const char *)sqlite3_column_text(stmt, 2);
-            if (path) {
-                safe_strcpy(metadata[count].file_path, path, sizeof(metadata[count].file_path), 0);
-            } else {
-                metadata[count].file_path[0] = '\0';
-            }
-
-            metadata[count].start_time = (time_t)sqlite3_column_int64(stmt, 3);
-
-            if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) {
-                metadata[count].end_time = (time_t)sqlite3_column_int64(stmt, 4);
-            } else {
-                metadata[count].end_time = 0;
-            }
-
-            metadata[count].size_bytes = (uint64_t)sqlite3_column_int64(stmt, 5);
-            metadata[count].width = sqlite3_column_int(stmt, 6);
-            metadata[count].height = sqlite3_column_int(stmt, 7);
-            metadata[count].fps = sqlite3_column_int(stmt, 8);
-
-            const char *codec = (const char *)sqlite3_column_text(stmt, 9);
-            if (codec) {
-                safe_strcpy(metadata[count].codec, codec, sizeof(metadata[count].codec), 0);
-            } else {
-                metadata[count].codec[0] = '\0';
-            }
-
-            metadata[count].is_complete = sqlite3_column_int(stmt, 10) != 0;
-
-            const char *trigger_type = (const char *)sqlite3_column_text(stmt, 11);
-            if (trigger_type) {
-                safe_strcpy(metadata[count].trigger_type, trigger_type, sizeof(metadata[count].trigger_type), 0);
-            } else {
-                safe_strcpy(metadata[count].trigger_type, "scheduled", sizeof(metadata[count].trigger_type), 0);
-            }
-
-            metadata[count].protected = sqlite3_column_int(stmt, 12) != 0;
-
-            if (sqlite3_column_type(stmt, 13) != SQLITE_NULL) {
-                metadata[count].retention_override_days = sqlite3_column_int(stmt, 13);
-            } else {
-                metadata[count].retention_override_days = -1;
-            }
-
-            metadata[count].retention_tier = (sqlite3_column_type(stmt, 14) != SQLITE_NULL)
-                ? sqlite3_column_int(stmt, 14) : RETENTION_TIER_STANDARD;
-            metadata[count].disk_pressure_eligible = (sqlite3_column_type(stmt, 15) != SQLITE_NULL)
-                ? (sqlite3_column_int(stmt, 15) != 0) : true;
-
-            count++;
-        }
+    if (!metadata || limit <= 0) {
+        log_error("Invalid parameters for get_recording_metadata_after");
+        return -1;
     }
 
-    if (rc_step != SQLITE_DONE && rc_step != SQLITE_ROW) {
-        log_error("Error while fetching recordings: %s", sqlite3_errmsg(db));
-    }
+    bool descending = !(sort_order && strcasecmp(sort_order, "asc") == 0);
 
-    // Finalize the prepared statement
-    sqlite3_finalize(stmt);
+    pthread_mutex_lock(db_mutex);
+    int count = query_recording_page(db, &filter, "start_time", descending, after,
+                                     metadata, limit, 0);
     pthread_mutex_unlock(db_mutex);
 
-    log_debug("Found %d recordings in database matching criteria (page %d, limit %d)",
-             count, (offset / limit) + 1, limit);
+    log_debug("Found %d recordings after cursor %ld:%llu", count,
+              after ? (long)after->start_time : 0L,
+              after ? (unsigned long long)after->id : 0ULL);
     return count;
 }
 
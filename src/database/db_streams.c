@@ -13,6 +13,7 @@
 #include "database/db_core.h"
 #include "database/db_schema.h"
 #include "database/db_schema_cache.h"
+#include "database/db_zones.h"
 #include "core/logger.h"
 #include "core/config.h"
 #include "utils/strings.h"
@@ -133,7 +134,8 @@ uint64_t add_stream_config(const stream_config_t *stream) {
                                 "onvif_username = ?, onvif_password = ?, onvif_profile = ?, onvif_port = ?, "
                                 "record_on_schedule = ?, recording_schedule = ?, tags = ?, admin_url = ?, "
                                 "privacy_mode = ?, motion_trigger_source = ?, go2rtc_source_override = ?, "
-                                "sub_stream_url = ? "
+                                "sub_stream_url = ?, detection_decode_mode = ?, detection_decode_gop_interval = ?, "
+                                "recording_format = ? "
                                 "WHERE id = ?;";
 
         rc = sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL);
@@ -218,8 +220,15 @@ uint64_t add_stream_config(const stream_config_t *stream) {
         sqlite3_bind_text(stmt, 46, stream->go2rtc_source_override, -1, SQLITE_STATIC);
         sqlite3_bind_text(stmt, 47, stream->sub_stream_url, -1, SQLITE_STATIC);
 
+        // Bind detection decode strategy
+        sqlite3_bind_text(stmt, 48, stream->detection_decode_mode, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 49, stream->detection_decode_gop_interval);
+
+        // Bind recording container format
+        sqlite3_bind_text(stmt, 50, stream->recording_format, -1, SQLITE_STATIC);
+
         // Bind ID parameter
-        sqlite3_bind_int64(stmt, 48, (sqlite3_int64)existing_id);
+        sqlite3_bind_int64(stmt, 51, (sqlite3_int64)existing_id);
 
         // Execute statement
         rc = sqlite3_step(stmt);
@@ -268,8 +277,9 @@ uint64_t add_stream_config(const stream_config_t *stream) {
           "ptz_enabled, ptz_max_x, ptz_max_y, ptz_max_z, ptz_has_home, "
           "onvif_username, onvif_password, onvif_profile, onvif_port, "
           "record_on_schedule, recording_schedule, tags, admin_url, privacy_mode, motion_trigger_source, "
-          "go2rtc_source_override, sub_stream_url) "
-          "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+          "go2rtc_source_override, sub_stream_url, detection_decode_mode, detection_decode_gop_interval, "
+          "recording_format) "
+          "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
@@ -354,6 +364,13 @@ uint64_t add_stream_config(const stream_config_t *stream) {
     sqlite3_bind_text(stmt, 47, stream->go2rtc_source_override, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 48, stream->sub_stream_url, -1, SQLITE_STATIC);
 
+    // Bind detection decode strategy
+    sqlite3_bind_text(stmt, 49, stream->detection_decode_mode, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 50, stream->detection_decode_gop_interval);
+
+    // Bind recording container format
+    sqlite3_bind_text(stmt, 51, stream->recording_format, -1, SQLITE_STATIC);
+
     // Execute statement
     rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
@@ -424,7 +441,8 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
                       "onvif_username = ?, onvif_password = ?, onvif_profile = ?, onvif_port = ?, "
                       "record_on_schedule = ?, recording_schedule = ?, tags = ?, admin_url = ?, privacy_mode = ?, "
                       "motion_trigger_source = ?, go2rtc_source_override = ?, "
-                      "sub_stream_url = ? "
+                      "sub_stream_url = ?, detection_decode_mode = ?, detection_decode_gop_interval = ?, "
+                      "recording_format = ? "
                       "WHERE name = ?;";
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -510,8 +528,15 @@ int update_stream_config(const char *name, const stream_config_t *stream) {
     sqlite3_bind_text(stmt, 47, stream->go2rtc_source_override, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 48, stream->sub_stream_url, -1, SQLITE_STATIC);
 
+    // Bind detection decode strategy
+    sqlite3_bind_text(stmt, 49, stream->detection_decode_mode, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 50, stream->detection_decode_gop_interval);
+
+    // Bind recording container format
+    sqlite3_bind_text(stmt, 51, stream->recording_format, -1, SQLITE_STATIC);
+
     // Bind the WHERE clause parameter
-    sqlite3_bind_text(stmt, 49, name, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 52, name, -1, SQLITE_STATIC);
 
     // Execute statement
     rc = sqlite3_step(stmt);
@@ -734,6 +759,8 @@ int delete_stream_config_internal(const char *name, bool permanent) {
     }
 
     if (permanent) {
+        // Zones go with the stream (ON DELETE CASCADE)
+        bump_detection_zones_version();
         log_info("Permanently deleted stream configuration: %s", name);
     } else {
         log_info("Disabled stream configuration: %s", name);
@@ -784,7 +811,8 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
         "ptz_enabled, ptz_max_x, ptz_max_y, ptz_max_z, ptz_has_home, "
         "onvif_username, onvif_password, onvif_profile, onvif_port, "
         "record_on_schedule, recording_schedule, tags, admin_url, privacy_mode, motion_trigger_source, "
-        "go2rtc_source_override, sub_stream_url "
+        "go2rtc_source_override, sub_stream_url, detection_decode_mode, detection_decode_gop_interval, "
+        "recording_format "
         "FROM streams WHERE name = ?;";
 
     // Column index constants for readability
@@ -800,7 +828,8 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
         COL_PTZ_ENABLED, COL_PTZ_MAX_X, COL_PTZ_MAX_Y, COL_PTZ_MAX_Z, COL_PTZ_HAS_HOME,
         COL_ONVIF_USERNAME, COL_ONVIF_PASSWORD, COL_ONVIF_PROFILE, COL_ONVIF_PORT,
         COL_RECORD_ON_SCHEDULE, COL_RECORDING_SCHEDULE, COL_TAGS, COL_ADMIN_URL, COL_PRIVACY_MODE,
-        COL_MOTION_TRIGGER_SOURCE, COL_GO2RTC_SOURCE_OVERRIDE, COL_SUB_STREAM_URL
+        COL_MOTION_TRIGGER_SOURCE, COL_GO2RTC_SOURCE_OVERRIDE, COL_SUB_STREAM_URL,
+        COL_DETECTION_DECODE_MODE, COL_DETECTION_DECODE_GOP_INTERVAL, COL_RECORDING_FORMAT
     };
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -977,6 +1006,18 @@ int get_stream_config_by_name(const char *name, stream_config_t *stream) {
             stream->sub_stream_url[0] = '\0';
         }
 
+        // Detection decode strategy
+        const char *decode_mode = (const char *)sqlite3_column_text(stmt, COL_DETECTION_DECODE_MODE);
+        safe_strcpy(stream->detection_decode_mode, (decode_mode && decode_mode[0]) ? decode_mode : "keyframes",
+                    sizeof(stream->detection_decode_mode), 0);
+        stream->detection_decode_gop_interval = (sqlite3_column_type(stmt, COL_DETECTION_DECODE_GOP_INTERVAL) != SQLITE_NULL)
+            ? sqlite3_column_int(stmt, COL_DETECTION_DECODE_GOP_INTERVAL) : 2;
+
+        // Recording container format
+        const char *recording_format = (const char *)sqlite3_column_text(stmt, COL_RECORDING_FORMAT);
+        safe_strcpy(stream->recording_format, (recording_format && recording_format[0]) ? recording_format : "mp4",
+                    sizeof(stream->recording_format), 0);
+
         result = 0;
     }
 
@@ -1029,7 +1070,8 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
         "ptz_enabled, ptz_max_x, ptz_max_y, ptz_max_z, ptz_has_home, "
         "onvif_username, onvif_password, onvif_profile, onvif_port, "
         "record_on_schedule, recording_schedule, tags, admin_url, privacy_mode, motion_trigger_source, "
-        "go2rtc_source_override, sub_stream_url "
+        "go2rtc_source_override, sub_stream_url, detection_decode_mode, detection_decode_gop_interval, "
+        "recording_format "
         "FROM streams ORDER BY name;";
 
     // Column index constants (same as get_stream_config_by_name)
@@ -1045,7 +1087,8 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
         COL_PTZ_ENABLED, COL_PTZ_MAX_X, COL_PTZ_MAX_Y, COL_PTZ_MAX_Z, COL_PTZ_HAS_HOME,
         COL_ONVIF_USERNAME, COL_ONVIF_PASSWORD, COL_ONVIF_PROFILE, COL_ONVIF_PORT,
         COL_RECORD_ON_SCHEDULE, COL_RECORDING_SCHEDULE, COL_TAGS, COL_ADMIN_URL, COL_PRIVACY_MODE,
-        COL_MOTION_TRIGGER_SOURCE, COL_GO2RTC_SOURCE_OVERRIDE, COL_SUB_STREAM_URL
+        COL_MOTION_TRIGGER_SOURCE, COL_GO2RTC_SOURCE_OVERRIDE, COL_SUB_STREAM_URL,
+        COL_DETECTION_DECODE_MODE, COL_DETECTION_DECODE_GOP_INTERVAL, COL_RECORDING_FORMAT
     };
 
     rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -1221,6 +1264,18 @@ int get_all_stream_configs(stream_config_t *streams, int max_count) {
             s->sub_stream_url[0] = '\0';
         }
 
+        // Detection decode strategy
+        const char *decode_mode = (const char *)sqlite3_column_text(stmt, COL_DETECTION_DECODE_MODE);
+        safe_strcpy(s->detection_decode_mode, (decode_mode && decode_mode[0]) ? decode_mode : "keyframes",
+                    sizeof(s->detection_decode_mode), 0);
+        s->detection_decode_gop_interval = (sqlite3_column_type(stmt, COL_DETECTION_DECODE_GOP_INTERVAL) != SQLITE_NULL)
+            ? sqlite3_column_int(stmt, COL_DETECTION_DECODE_GOP_INTERVAL) : 2;
+
+        // Recording container format
+        const char *recording_format = (const char *)sqlite3_column_text(stmt, COL_RECORDING_FORMAT);
+        safe_strcpy(s->recording_format, (recording_format && recording_format[0]) ? recording_format : "mp4",
+                    sizeof(s->recording_format), 0);
+
         count++;
     }
 
@@ -220,6 +220,41 @@ static int validate_migration_file_security(const char *filepath) {
     return 0;
 }
 
+/**
+ * Find the end of the SQL statement starting at sql.
+ *
+ * Returns a pointer to the terminating semicolon, or to the closing NUL when
+ * the statement is not terminated.  Semicolons inside single-quoted strings
+ * do not end a statement, and neither do the ones inside the BEGIN ... END
+ * body of a CREATE TRIGGER: a trigger ends at the first "END;" outside a
+ * string, so trigger bodies must not contain CASE ... END;.
+ */
+static const char *find_statement_end(const char *sql) {
+    int is_trigger = strncasecmp(sql, "CREATE TRIGGER", 14) == 0 &&
+                     isspace((unsigned char)sql[14]);
+    int in_str = 0;
+    const char *p = sql;
+
+    for (; *p; p++) {
+        if (*p == '\'') {
+            in_str = !in_str;
+            continue;
+        }
+        if (*p != ';' || in_str) continue;
+        if (!is_trigger) break;
+
+        // Only "END" (as a whole word) followed by ';' ends a trigger
+        const char *q = p;
+        while (q > sql && isspace((unsigned char)q[-1])) q--;
+        if (q - sql >= 3 && strncasecmp(q - 3, "END", 3) == 0 &&
+            (q - 3 == sql || !(isalnum((unsigned char)q[-4]) || q[-4] == '_'))) {
+            break;
+        }
+    }
+
+    return p;
+}
+
 /**
  * Validate that SQL from a migration file only contains allowlisted statement
  * types (DDL + safe DML).  This acts as a sanitization boundary between the
@@ -296,14 +331,9 @@ static int validate_migration_sql(const char *sql) {
         }
 
         /* Advance past this statement (to the next semicolon),
-         * respecting single-quoted string literals.              */
-        int in_str = 0;
-        while (*p) {
-            if (*p == '\'' && !in_str) { in_str = 1; p++; continue; }
-            if (*p == '\'' &&  in_str) { in_str = 0; p++; continue; }
-            if (*p == ';'  && !in_str) { p++; break; }
-            p++;
-        }
+         * respecting string literals and trigger bodies.         */
+        p = find_statement_end(p);
+        if (*p == ';') p++;
     }
 
     return 0;
@@ -718,18 +748,7 @@ static int execute_sql(sqlite3 *db, const char *sql) {
         }
 
         // Find end of statement (semicolon)
-        end = start;
-        int in_string = 0;
-        while (*end) {
-            if (*end == '\'' && !in_string) {
-                in_string = 1;
-            } else if (*end == '\'' && in_string) {
-                in_string = 0;
-            } else if (*end == ';' && !in_string) {
-                break;
-            }
-            end++;
-        }
+        end = find_statement_end(start);
 
         if (end == start) {
             start = end + 1;
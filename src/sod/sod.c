@@ -2317,6 +2317,7 @@ struct layer {
 
 	float * weights;
 	float * weight_updates;
+	float * winograd_weights; /* 3x3 filters in the Winograd domain, see forward_convolutional_winograd() */
 
 	float * col_image;
 	float * delta;
@@ -3659,6 +3660,9 @@ static void free_layer(layer *l, layer *p)
 	if (l->cweights) {
 		free(l->cweights);
 	}
+	if (l->winograd_weights) {
+		free(l->winograd_weights);
+	}
 	if (l->indexes) {
 		free(l->indexes);
 	}
@@ -4633,6 +4637,276 @@ static inline void im2col_cpu(float* data_im,
 		c++;
 	}
 }
+/*
+ * Parallel-for over an index range, backed by a small process-wide worker pool.
+ * The pool is empty (everything runs on the calling thread) until the
+ * SOD_CNN_THREADS configuration verb asks for more threads. Only one job runs
+ * at a time: a caller that finds the pool busy, typically another network
+ * running on behalf of another camera, runs its range inline instead of
+ * queueing, so several concurrent detectors never oversubscribe the CPU.
+ */
+typedef void(*ProcSodParallel)(void *pCtx, int iStart, int iEnd);
+#define SOD_MAX_THREADS 16
+#if defined(_WIN32) || defined(SOD_DISABLE_THREADS)
+static void sod_parallel_for(int nTotal, int nGrain, ProcSodParallel xJob, void *pCtx)
+{
+	(void)nGrain;
+	if (nTotal > 0) xJob(pCtx, 0, nTotal);
+}
+static int sod_pool_set_threads(int nThreads)
+{
+	(void)nThreads;
+	return SOD_UNSUPPORTED;
+}
+#else
+#include <pthread.h>
+typedef struct sod_pool sod_pool;
+struct sod_pool {
+	pthread_mutex_t submit; /* Held by the submitting thread for a whole job */
+	pthread_mutex_t lock;   /* Protects everything below */
+	pthread_cond_t wake;
+	pthread_cond_t done;
+	pthread_t aThread[SOD_MAX_THREADS];
+	int nThread;            /* Worker threads, not counting the caller */
+	int shutdown;
+	ProcSodParallel xJob;
+	void *pCtx;
+	int nTotal;
+	int nChunk;
+	int iNext;
+	int nDone;
+};
+static sod_pool sPool = {
+	.submit = PTHREAD_MUTEX_INITIALIZER,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.wake = PTHREAD_COND_INITIALIZER,
+	.done = PTHREAD_COND_INITIALIZER
+};
+/* Run chunks of the current job until none are left. Called with sPool.lock held */
+static void sod_pool_drain(void)
+{
+	while (sPool.iNext < sPool.nTotal) {
+		ProcSodParallel xJob = sPool.xJob;
+		void *pCtx = sPool.pCtx;
+		int iStart = sPool.iNext;
+		int iEnd = iStart + sPool.nChunk;
+		if (iEnd > sPool.nTotal) iEnd = sPool.nTotal;
+		sPool.iNext = iEnd;
+		pthread_mutex_unlock(&sPool.lock);
+		xJob(pCtx, iStart, iEnd);
+		pthread_mutex_lock(&sPool.lock);
+		sPool.nDone += iEnd - iStart;
+		if (sPool.nDone >= sPool.nTotal) {
+			pthread_cond_broadcast(&sPool.done);
+		}
+	}
+}
+static void * sod_pool_worker(void *pArg)
+{
+	(void)pArg;
+	pthread_mutex_lock(&sPool.lock);
+	for (;;) {
+		while (!sPool.shutdown && sPool.iNext >= sPool.nTotal) {
+			pthread_cond_wait(&sPool.wake, &sPool.lock);
+		}
+		if (sPool.shutdown) break;
+		sod_pool_drain();
+	}
+	pthread_mutex_unlock(&sPool.lock);
+	return 0;
+}
+static void sod_parallel_for(int nTotal, int nGrain, ProcSodParallel xJob, void *pCtx)
+{
+	int nChunk;
+	if (nTotal <= 0) return;
+	if (nGrain < 1) nGrain = 1;
+	if (nTotal < 2 * nGrain || pthread_mutex_trylock(&sPool.submit) != 0) {
+		xJob(pCtx, 0, nTotal);
+		return;
+	}
+	if (sPool.nThread < 1) {
+		pthread_mutex_unlock(&sPool.submit);
+		xJob(pCtx, 0, nTotal);
+		return;
+	}
+	/* A few chunks per thread so uneven progress still balances out */
+	nChunk = (nTotal + 4 * (sPool.nThread + 1) - 1) / (4 * (sPool.nThread + 1));
+	if (nChunk < nGrain) nChunk = nGrain;
+	pthread_mutex_lock(&sPool.lock);
+	sPool.xJob = xJob;
+	sPool.pCtx = pCtx;
+	sPool.nChunk = nChunk;
+	sPool.nDone = 0;
+	sPool.iNext = 0;
+	sPool.nTotal = nTotal;
+	pthread_cond_broadcast(&sPool.wake);
+	sod_pool_drain();
+	while (sPool.nDone < sPool.nTotal) {
+		pthread_cond_wait(&sPool.done, &sPool.lock);
+	}
+	sPool.xJob = 0;
+	sPool.pCtx = 0;
+	pthread_mutex_unlock(&sPool.lock);
+	pthread_mutex_unlock(&sPool.submit);
+}
+/*
+ * Resize the pool to nThreads in total (the calling thread included).
+ * nThreads <= 0 selects one thread per online CPU.
+ */
+static int sod_pool_set_threads(int nThreads)
+{
+	int nWorker, i;
+	if (nThreads <= 0) {
+		long nCpu = sysconf(_SC_NPROCESSORS_ONLN);
+		nThreads = nCpu > 0 ? (int)nCpu : 1;
+	}
+	nWorker = nThreads - 1;
+	if (nWorker > SOD_MAX_THREADS) nWorker = SOD_MAX_THREADS;
+	pthread_mutex_lock(&sPool.submit);
+	if (nWorker == sPool.nThread) {
+		pthread_mutex_unlock(&sPool.submit);
+		return SOD_OK;
+	}
+	/* Stop the current workers; no job can be running while submit is held */
+	pthread_mutex_lock(&sPool.lock);
+	sPool.shutdown = 1;
+	pthread_cond_broadcast(&sPool.wake);
+	pthread_mutex_unlock(&sPool.lock);
+	for (i = 0; i < sPool.nThread; ++i) {
+		pthread_join(sPool.aThread[i], 0);
+	}
+	sPool.shutdown = 0;
+	sPool.nThread = 0;
+	for (i = 0; i < nWorker; ++i) {
+		if (pthread_create(&sPool.aThread[i], 0, sod_pool_worker, 0) != 0) {
+			break;
+		}
+		sPool.nThread++;
+	}
+	pthread_mutex_unlock(&sPool.submit);
+	return sPool.nThread == nWorker ? SOD_OK : SOD_ABORT;
+}
+#endif /* _WIN32 || SOD_DISABLE_THREADS */
+/*
+ * Vector primitives for the GEMM micro-kernel. AVX2/FMA, SSE and NEON are
+ * selected at compile time from the target flags (see SOD_NATIVE_ARCH in
+ * CMakeLists.txt); anything else gets a 4-lane scalar fallback that the
+ * compiler is free to auto-vectorize.
+ */
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define SOD_VEC_WIDTH 8
+typedef __m256 sod_vec;
+#define sod_vec_zero()          _mm256_setzero_ps()
+#define sod_vec_load(P)         _mm256_loadu_ps(P)
+#define sod_vec_store(P, V)     _mm256_storeu_ps(P, V)
+#define sod_vec_set1(X)         _mm256_set1_ps(X)
+#define sod_vec_fma(ACC, A, B)  _mm256_fmadd_ps(A, B, ACC)
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define SOD_VEC_WIDTH 4
+typedef __m128 sod_vec;
+#define sod_vec_zero()          _mm_setzero_ps()
+#define sod_vec_load(P)         _mm_loadu_ps(P)
+#define sod_vec_store(P, V)     _mm_storeu_ps(P, V)
+#define sod_vec_set1(X)         _mm_set1_ps(X)
+#define sod_vec_fma(ACC, A, B)  _mm_add_ps(ACC, _mm_mul_ps(A, B))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SOD_VEC_WIDTH 4
+typedef float32x4_t sod_vec;
+#define sod_vec_zero()          vdupq_n_f32(0.0f)
+#define sod_vec_load(P)         vld1q_f32(P)
+#define sod_vec_store(P, V)     vst1q_f32(P, V)
+#define sod_vec_set1(X)         vdupq_n_f32(X)
+#if defined(__aarch64__)
+#define sod_vec_fma(ACC, A, B)  vfmaq_f32(ACC, A, B)
+#else
+#define sod_vec_fma(ACC, A, B)  vmlaq_f32(ACC, A, B)
+#endif
+#else
+#define SOD_VEC_WIDTH 4
+typedef struct { float v[4]; } sod_vec;
+static inline sod_vec sod_vec_zero(void) { sod_vec r = { { 0, 0, 0, 0 } }; return r; }
+static inline sod_vec sod_vec_load(const float *p) { sod_vec r; memcpy(r.v, p, sizeof(r.v)); return r; }
+static inline void sod_vec_store(float *p, sod_vec v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline sod_vec sod_vec_set1(float x) { sod_vec r = { { x, x, x, x } }; return r; }
+static inline sod_vec sod_vec_fma(sod_vec acc, sod_vec a, sod_vec b)
+{
+	int i;
+	for (i = 0; i < 4; ++i) acc.v[i] += a.v[i] * b.v[i];
+	return acc;
+}
+#endif
+/*
+ * Cache-blocked GEMM (C += ALPHA * A * B, row-major, no transposes).
+ * K is processed in SOD_GEMM_KC slices. For each slice a SOD_GEMM_NR wide
+ * panel of B is packed into a contiguous, zero padded buffer that stays in L1
+ * while the micro-kernel sweeps SOD_GEMM_MR rows of A down the whole of M,
+ * accumulating an MR x NR tile of C in registers.
+ */
+#define SOD_GEMM_MR 4
+#define SOD_GEMM_NR (2 * SOD_VEC_WIDTH)
+#define SOD_GEMM_KC 256
+static void sod_gemm_kernel(int kc, const float *pA[SOD_GEMM_MR], const float *pB, float ALPHA,
+	float *C, int ldc, int mr, int nr)
+{
+	sod_vec acc[SOD_GEMM_MR][2];
+	int r, k, j;
+	for (r = 0; r < SOD_GEMM_MR; ++r) {
+		acc[r][0] = sod_vec_zero();
+		acc[r][1] = sod_vec_zero();
+	}
+	for (k = 0; k < kc; ++k) {
+		sod_vec b0 = sod_vec_load(pB);
+		sod_vec b1 = sod_vec_load(pB + SOD_VEC_WIDTH);
+		for (r = 0; r < SOD_GEMM_MR; ++r) {
+			sod_vec a = sod_vec_set1(pA[r][k]);
+			acc[r][0] = sod_vec_fma(acc[r][0], a, b0);
+			acc[r][1] = sod_vec_fma(acc[r][1], a, b1);
+		}
+		pB += SOD_GEMM_NR;
+	}
+	for (r = 0; r < mr; ++r) {
+		float aTile[SOD_GEMM_NR];
+		float *c = &C[r * ldc];
+		sod_vec_store(aTile, acc[r][0]);
+		sod_vec_store(aTile + SOD_VEC_WIDTH, acc[r][1]);
+		for (j = 0; j < nr; ++j) {
+			c[j] += ALPHA * aTile[j];
+		}
+	}
+}
+/* Rows [iStart, iEnd) of C += ALPHA * A * B */
+static void sod_gemm_nn_rows(int iStart, int iEnd, int N, int K, float ALPHA,
+	const float *A, int lda,
+	const float *B, int ldb,
+	float *C, int ldc)
+{
+	float aPack[SOD_GEMM_KC * SOD_GEMM_NR];
+	int k0, j0, i0, k, j, r;
+	for (k0 = 0; k0 < K; k0 += SOD_GEMM_KC) {
+		int kc = K - k0 < SOD_GEMM_KC ? K - k0 : SOD_GEMM_KC;
+		for (j0 = 0; j0 < N; j0 += SOD_GEMM_NR) {
+			int nr = N - j0 < SOD_GEMM_NR ? N - j0 : SOD_GEMM_NR;
+			for (k = 0; k < kc; ++k) {
+				const float *b = &B[(k0 + k) * ldb + j0];
+				float *p = &aPack[k * SOD_GEMM_NR];
+				for (j = 0; j < nr; ++j) p[j] = b[j];
+				for (; j < SOD_GEMM_NR; ++j) p[j] = 0;
+			}
+			for (i0 = iStart; i0 < iEnd; i0 += SOD_GEMM_MR) {
+				const float *pA[SOD_GEMM_MR];
+				int mr = iEnd - i0 < SOD_GEMM_MR ? iEnd - i0 : SOD_GEMM_MR;
+				/* Short blocks repeat their last row; the extra results are discarded */
+				for (r = 0; r < SOD_GEMM_MR; ++r) {
+					pA[r] = &A[(i0 + (r < mr ? r : mr - 1)) * lda + k0];
+				}
+				sod_gemm_kernel(kc, pA, aPack, ALPHA, &C[i0 * ldc + j0], ldc, mr, nr);
+			}
+		}
+	}
+}
 #ifdef SOD_EMBEDDED_COMMERCIAL_LICENSE
 /* 
  * Multi-core CPU support for SOD which is available in the commercial version of the library.
@@ -4648,27 +4922,40 @@ static inline void im2col_cpu(float* data_im,
  */
 #include "sod_threads.h"
 #else
+typedef struct gemm_job gemm_job;
+struct gemm_job {
+	int M, N, K;
+	float ALPHA;
+	float *A, *B, *C;
+	int lda, ldb, ldc;
+};
+static void gemm_nn_job(void *pCtx, int iStart, int iEnd)
+{
+	gemm_job *pJob = (gemm_job *)pCtx;
+	int iRow = iStart * SOD_GEMM_MR;
+	int iLast = iEnd * SOD_GEMM_MR;
+	if (iLast > pJob->M) iLast = pJob->M;
+	sod_gemm_nn_rows(iRow, iLast, pJob->N, pJob->K, pJob->ALPHA,
+		pJob->A, pJob->lda, pJob->B, pJob->ldb, pJob->C, pJob->ldc);
+}
+/* Below this many multiply-adds the pool hand-off costs more than it saves */
+#define SOD_GEMM_PARALLEL_MIN (1 << 20)
 static inline void gemm_nn(int M, int N, int K, float ALPHA,
 	float *A, int lda,
 	float *B, int ldb,
 	float *C, int ldc)
 {
-	register int i, j, k;
-	i = 0;
-	for (;;) {
-		if (i >= M)break;
-		k = 0;
-		for (;;) {
-			register float A_PART;
-			if (k >= K)break;
-			A_PART = ALPHA * A[i*lda + k];
-			for (j = 0; j < N; ++j) {
-				C[i*ldc + j] += A_PART * B[k*ldb + j];
-			}
-			k++;
-		}
-		i++;
+	gemm_job sJob;
+	if ((double)M * N * K < SOD_GEMM_PARALLEL_MIN) {
+		sod_gemm_nn_rows(0, M, N, K, ALPHA, A, lda, B, ldb, C, ldc);
+		return;
 	}
+	/* Split output rows (= output channels for a convolution) across the pool */
+	sJob.M = M; sJob.N = N; sJob.K = K;
+	sJob.ALPHA = ALPHA;
+	sJob.A = A; sJob.B = B; sJob.C = C;
+	sJob.lda = lda; sJob.ldb = ldb; sJob.ldc = ldc;
+	sod_parallel_for((M + SOD_GEMM_MR - 1) / SOD_GEMM_MR, 1, gemm_nn_job, &sJob);
 }
 #endif /*  SOD_EMBEDDED_COMMERCIAL_LICENSE */
 static inline void gemm_nt(int M, int N, int K, float ALPHA,
@@ -4883,6 +5170,171 @@ static inline void gradient_array(const float *x, const int n, const ACTIVATION
 		i++;
 	}
 }
+/*
+ * Winograd F(2x2, 3x3) for stride-1, pad-1 3x3 convolutions, used at
+ * inference time. Each 4x4 input tile yields a 2x2 output tile with 16
+ * multiplies per channel pair instead of 36, and the per-tile products turn
+ * into 16 independent (filters x channels) * (channels x tiles) GEMMs.
+ *
+ * Filters are transformed once, after the weights are loaded, into
+ * winograd_weights laid out as [16][n][c]. The input and product matrices
+ * live in the network workspace (see get_workspace_size()).
+ */
+#define WINOGRAD_TILES(l) ((((l).out_h + 1) / 2) * (((l).out_w + 1) / 2))
+static int conv_winograd_eligible(const layer *l)
+{
+	/* Shallow layers (e.g. the RGB input) gain little and keep the im2col path */
+	return l->type == CONVOLUTIONAL && l->size == 3 && l->stride == 1 && l->pad == 1 &&
+		!l->xnor && !l->binary && l->c >= 8 && l->n >= 8 &&
+		l->out_h == l->h && l->out_w == l->w;
+}
+static void winograd_transform_weights(layer *l)
+{
+	int nPlane = l->n * l->c;
+	int k, c, i;
+	for (k = 0; k < l->n; ++k) {
+		for (c = 0; c < l->c; ++c) {
+			const float *g = &l->weights[(k * l->c + c) * 9];
+			float t[4][3], u[4][4];
+			/* t = G g */
+			for (i = 0; i < 3; ++i) {
+				t[0][i] = g[i];
+				t[1][i] = 0.5f * (g[i] + g[3 + i] + g[6 + i]);
+				t[2][i] = 0.5f * (g[i] - g[3 + i] + g[6 + i]);
+				t[3][i] = g[6 + i];
+			}
+			/* u = t G^T */
+			for (i = 0; i < 4; ++i) {
+				u[i][0] = t[i][0];
+				u[i][1] = 0.5f * (t[i][0] + t[i][1] + t[i][2]);
+				u[i][2] = 0.5f * (t[i][0] - t[i][1] + t[i][2]);
+				u[i][3] = t[i][2];
+			}
+			for (i = 0; i < 16; ++i) {
+				l->winograd_weights[i * nPlane + k * l->c + c] = u[i / 4][i % 4];
+			}
+		}
+	}
+}
+/* Allocate and fill winograd_weights for every eligible layer */
+static void prepare_winograd_network(network *net)
+{
+	int i;
+	for (i = 0; i < net->n; ++i) {
+		layer *l = &net->layers[i];
+		if (!conv_winograd_eligible(l)) continue;
+		if (!l->winograd_weights) {
+			l->winograd_weights = malloc(16 * (size_t)l->n * l->c * sizeof(float));
+			if (!l->winograd_weights) continue; /* Falls back to im2col */
+		}
+		winograd_transform_weights(l);
+	}
+}
+typedef struct winograd_job winograd_job;
+struct winograd_job {
+	const layer *l;
+	const float *input;
+	float *output;
+	float *V;   /* [16][c][tiles] */
+	float *M;   /* [16][n][tiles] */
+	int tiles_w;
+	int tiles;
+};
+/* V = B^T d B for channels [iStart, iEnd) */
+static void winograd_input_job(void *pCtx, int iStart, int iEnd)
+{
+	winograd_job *pJob = (winograd_job *)pCtx;
+	const layer *l = pJob->l;
+	size_t nPlane = (size_t)l->c * pJob->tiles;
+	int c, p, i, j;
+	for (c = iStart; c < iEnd; ++c) {
+		const float *im = &pJob->input[(size_t)c * l->h * l->w];
+		for (p = 0; p < pJob->tiles; ++p) {
+			int y0 = (p / pJob->tiles_w) * 2 - 1;
+			int x0 = (p % pJob->tiles_w) * 2 - 1;
+			float d[4][4], t[4][4];
+			for (i = 0; i < 4; ++i) {
+				int y = y0 + i;
+				for (j = 0; j < 4; ++j) {
+					int x = x0 + j;
+					d[i][j] = (y < 0 || x < 0 || y >= l->h || x >= l->w) ? 0 : im[y * l->w + x];
+				}
+			}
+			for (j = 0; j < 4; ++j) {
+				t[0][j] = d[0][j] - d[2][j];
+				t[1][j] = d[1][j] + d[2][j];
+				t[2][j] = d[2][j] - d[1][j];
+				t[3][j] = d[1][j] - d[3][j];
+			}
+			for (i = 0; i < 4; ++i) {
+				float *v = &pJob->V[(size_t)(i * 4) * nPlane + (size_t)c * pJob->tiles + p];
+				v[0] = t[i][0] - t[i][2];
+				v[nPlane] = t[i][1] + t[i][2];
+				v[2 * nPlane] = t[i][2] - t[i][1];
+				v[3 * nPlane] = t[i][1] - t[i][3];
+			}
+		}
+	}
+}
+/* M[xi] = U[xi] * V[xi] for tile positions [iStart, iEnd) */
+static void winograd_gemm_job(void *pCtx, int iStart, int iEnd)
+{
+	winograd_job *pJob = (winograd_job *)pCtx;
+	const layer *l = pJob->l;
+	int xi;
+	for (xi = iStart; xi < iEnd; ++xi) {
+		float *M = &pJob->M[(size_t)xi * l->n * pJob->tiles];
+		memset(M, 0, (size_t)l->n * pJob->tiles * sizeof(float));
+		sod_gemm_nn_rows(0, l->n, pJob->tiles, l->c, 1,
+			&l->winograd_weights[(size_t)xi * l->n * l->c], l->c,
+			&pJob->V[(size_t)xi * l->c * pJob->tiles], pJob->tiles,
+			M, pJob->tiles);
+	}
+}
+/* Y = A^T m A for filters [iStart, iEnd) */
+static void winograd_output_job(void *pCtx, int iStart, int iEnd)
+{
+	winograd_job *pJob = (winograd_job *)pCtx;
+	const layer *l = pJob->l;
+	size_t nPlane = (size_t)l->n * pJob->tiles;
+	int k, p, i;
+	for (k = iStart; k < iEnd; ++k) {
+		float *out = &pJob->output[(size_t)k * l->out_h * l->out_w];
+		for (p = 0; p < pJob->tiles; ++p) {
+			const float *m = &pJob->M[(size_t)k * pJob->tiles + p];
+			int y0 = (p / pJob->tiles_w) * 2;
+			int x0 = (p % pJob->tiles_w) * 2;
+			float s[2][4];
+			for (i = 0; i < 4; ++i) {
+				float m0 = m[i * nPlane], m1 = m[(4 + i) * nPlane];
+				float m2 = m[(8 + i) * nPlane], m3 = m[(12 + i) * nPlane];
+				s[0][i] = m0 + m1 + m2;
+				s[1][i] = m1 - m2 - m3;
+			}
+			for (i = 0; i < 2 && y0 + i < l->out_h; ++i) {
+				float *o = &out[(y0 + i) * l->out_w + x0];
+				o[0] = s[i][0] + s[i][1] + s[i][2];
+				if (x0 + 1 < l->out_w) {
+					o[1] = s[i][1] - s[i][2] - s[i][3];
+				}
+			}
+		}
+	}
+}
+static void forward_convolutional_winograd(const layer *l, const float *input, float *output, float *workspace)
+{
+	winograd_job sJob;
+	sJob.l = l;
+	sJob.input = input;
+	sJob.output = output;
+	sJob.tiles_w = (l->out_w + 1) / 2;
+	sJob.tiles = WINOGRAD_TILES(*l);
+	sJob.V = workspace;
+	sJob.M = workspace + (size_t)16 * l->c * sJob.tiles;
+	sod_parallel_for(l->c, 1, winograd_input_job, &sJob);
+	sod_parallel_for(16, 1, winograd_gemm_job, &sJob);
+	sod_parallel_for(l->n, 1, winograd_output_job, &sJob);
+}
 static void forward_convolutional_layer(convolutional_layer l, network_state state)
 {
 	int out_h = convolutional_out_height(l);
@@ -4914,9 +5366,18 @@ static void forward_convolutional_layer(convolutional_layer l, network_state sta
 	for (;;) {
 		if (i >= l.batch)break;
 
-		im2col_cpu(state.input, l.c, l.h, l.w,
-			l.size, l.stride, l.pad, b);
-		gemm(0, 0, m, n, k, 1, a, k, b, n, 1, c, n);
+		if (l.winograd_weights && !state.train) {
+			forward_convolutional_winograd(&l, state.input, c, state.workspace);
+		}
+		else if (l.size == 1 && l.stride == 1 && l.pad == 0) {
+			/* im2col of a 1x1 convolution is the input itself */
+			gemm(0, 0, m, n, k, 1, a, k, state.input, n, 1, c, n);
+		}
+		else {
+			im2col_cpu(state.input, l.c, l.h, l.w,
+				l.size, l.stride, l.pad, b);
+			gemm(0, 0, m, n, k, 1, a, k, b, n, 1, c, n);
+		}
 		c += n * m;
 		state.input += l.c*l.h*l.w;
 
@@ -5075,9 +5536,18 @@ static void update_convolutional_layer(convolutional_layer l, int batch, float l
 	axpy_cpu(size, -decay * batch, l.weights, 1, l.weight_updates, 1);
 	axpy_cpu(size, learning_rate / batch, l.weight_updates, 1, l.weights, 1);
 	scal_cpu(size, momentum, l.weight_updates, 1);
+
+	if (l.winograd_weights) {
+		winograd_transform_weights(&l);
+	}
 }
 static size_t get_workspace_size(layer l) {
-	return (size_t)l.out_h*l.out_w*l.size*l.size*l.c * sizeof(float);
+	size_t im2col = (size_t)l.out_h*l.out_w*l.size*l.size*l.c * sizeof(float);
+	if (conv_winograd_eligible(&l)) {
+		size_t winograd = (size_t)16 * WINOGRAD_TILES(l) * (l.c + l.n) * sizeof(float);
+		if (winograd > im2col) return winograd;
+	}
+	return im2col;
 }
 static convolutional_layer make_convolutional_layer(int batch, int h, int w, int c, int n, int size, int stride, int padding, ACTIVATION activation, int batch_normalize, int binary, int xnor, int adam)
 {
@@ -8932,6 +9402,7 @@ int sod_cnn_create(sod_cnn **ppOut, const char *zArch, const char *zModelPath, c
 			goto fail;
 		}
 	}
+	prepare_winograd_network(&pNet->net);
 	/* Fill with default configuration */
 	SySetInit(&pNet->aBoxes, sizeof(sod_box));
 	SySetAlloc(&pNet->aBoxes, 8);
@@ -9057,6 +9528,12 @@ int sod_cnn_config(sod_cnn * pNet, SOD_CNN_CONFIG conf, ...)
 		}
 	}
 							  break;
+	case SOD_CNN_THREADS: {
+		/* The pool is process-wide: the last value set by any network wins */
+		int nThreads = va_arg(ap, int);
+		rc = sod_pool_set_threads(nThreads);
+	}
+						  break;
 	default:
 		rc = SOD_UNSUPPORTED;
 		break;
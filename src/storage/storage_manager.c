@@ -17,6 +17,7 @@
 #include "database/db_streams.h"
 #include "database/db_recordings.h"
 #include "web/api_handlers_recordings_thumbnail.h"
+#include "video/keyframe_index.h"
 #include "core/config.h"
 #include "core/logger.h"
 #include "core/mqtt_client.h"
@@ -67,6 +68,13 @@ static struct {
     .reserved_space = 0
 };
 
+// Whether a directory entry is a recording's keyframe index sidecar
+static bool is_keyframe_index_sidecar(const char *name) {
+    size_t len = strlen(name);
+    size_t ext_len = strlen(KEYFRAME_INDEX_EXTENSION);
+    return len > ext_len && strcmp(name + len - ext_len, KEYFRAME_INDEX_EXTENSION) == 0;
+}
+
 static bool delete_recording_file_and_metadata(const recording_metadata_t *recording,
                                                const char *context,
                                                uint64_t *freed_bytes) {
@@ -94,6 +102,9 @@ static bool delete_recording_file_and_metadata(const recording_metadata_t *recor
     }
 
     delete_recording_thumbnails(recording->id);
+    if (recording->file_path[0] != '\0') {
+        keyframe_index_delete(recording->file_path);
+    }
 
     if (delete_recording_metadata(recording->id) != 0) {
         log_warn("%s: failed to delete recording metadata for ID %llu",
@@ -235,6 +246,12 @@ int get_storage_stats(storage_stats_t *stats) {
 
                         struct stat rec_st;
                         if (stat(rec_path, &rec_st) == 0 && S_ISREG(rec_st.st_mode)) {
+                            // Keyframe index sidecars take space but are not recordings
+                            if (is_keyframe_index_sidecar(rec_entry->d_name)) {
+                                stats->total_recording_bytes += rec_st.st_size;
+                                continue;
+                            }
+
                             // Count recording and add size
                             stats->total_recordings++;
                             stats->total_recording_bytes += rec_st.st_size;
@@ -566,6 +583,11 @@ static int apply_legacy_retention_policy(void) {
                         char rec_path[MAX_RECORDING_PATH_LENGTH];
                         snprintf(rec_path, sizeof(rec_path), "%s/%s", stream_path, rec_entry->d_name);
 
+                        // A sidecar is tracked through the recording it belongs to
+                        if (is_keyframe_index_sidecar(rec_entry->d_name)) {
+                            rec_path[strlen(rec_path) - strlen(KEYFRAME_INDEX_EXTENSION)] = '\0';
+                        }
+
                         // Check if file is older than retention days
                         if (storage_manager.retention_days > 0 && rec_st.st_mtime < cutoff_time) {
                             // Check if this file is tracked in database
@@ -19,6 +19,11 @@
  * - More complex implementation
  * - Disk I/O for cold pages
  * - Fixed file size allocation
+ *
+ * Layout: header | index ring | data ring.  Packets are stored back to back
+ * as variable-length records in the data ring; the index ring holds one
+ * small entry per packet (offset, size, flags) so eviction and keyframe
+ * lookup do not have to read packet data.
  */
 
 #include <stdio.h>
@@ -37,7 +42,12 @@
 #include "core/path_utils.h"
 #include "utils/strings.h"
 
-// Packet entry in mmap buffer (fixed size for simplicity)
+// Packet record in the data ring
+//
+// Records are variable length (header + packet data, padded to
+// MMAP_RECORD_ALIGN) and never straddle the end of the ring: a record that
+// would not fit before the end is written at offset 0 and the skipped tail
+// bytes are charged to that record's index entry.
 typedef struct {
     uint32_t magic;                     // Magic value for validation
     uint32_t data_size;                 // Actual packet data size
@@ -50,23 +60,42 @@ typedef struct {
 } __attribute__((packed)) mmap_packet_entry_t;
 
 #define MMAP_MAGIC 0x4D4D5056            // "MMPV" - mmap packet video
-#define MAX_PACKET_SIZE ((size_t)256 * 1024)     // 256KB max per packet
+#define MMAP_RECORD_ALIGN 8
 #define ENTRY_SIZE(data_sz) (sizeof(mmap_packet_entry_t) + (data_sz))
-#define ENTRY_ALIGNED_SIZE(data_sz) (((ENTRY_SIZE(data_sz) + 4095) / 4096) * 4096)
+#define ENTRY_ALIGNED_SIZE(data_sz) ((ENTRY_SIZE(data_sz) + MMAP_RECORD_ALIGN - 1) & ~(size_t)(MMAP_RECORD_ALIGN - 1))
+
+// Data ring sizing when no disk limit is configured: assume up to ~8 Mbit/s
+#define MMAP_DEFAULT_BYTES_PER_SECOND ((size_t)1024 * 1024)
+#define MMAP_MIN_DATA_SIZE ((size_t)4 * 1024 * 1024)
+
+// Index entry: one per buffered packet, kept in its own ring so that
+// eviction, statistics and keyframe lookup never touch packet data pages
+typedef struct {
+    uint64_t offset;                    // Record offset in the data ring
+    uint32_t span;                      // Record size plus any wrap padding before it
+    uint32_t flags;                     // Packet flags (copied from the record)
+    time_t timestamp;                   // Wall clock timestamp
+} __attribute__((packed)) mmap_index_entry_t;
 
 // Mmap buffer header
 typedef struct {
     uint32_t magic;                     // File magic
     uint32_t version;                   // Format version
     uint32_t entry_count;               // Number of entries
-    uint32_t head;                      // Write position
-    uint32_t tail;                      // Read position
+    uint32_t head;                      // Index write position
+    uint32_t tail;                      // Index read position
     uint64_t total_size;                // Total mapped size
-    uint64_t data_offset;               // Offset to data area
+    uint64_t data_offset;               // Offset to data ring
     char stream_name[256];              // Stream name
+    uint64_t index_offset;              // Offset to index ring
+    uint32_t index_capacity;            // Index ring slots
+    uint64_t data_capacity;             // Data ring size in bytes
+    uint64_t data_head;                 // Next record write offset
+    uint64_t data_used;                 // Bytes in use (records + wrap padding)
 } __attribute__((packed)) mmap_buffer_header_t;
 
 #define MMAP_FILE_MAGIC 0x4E564D4D       // "NVMM" - NVR mmap
+#define MMAP_FILE_VERSION 2
 
 // Strategy private data
 typedef struct {
@@ -76,14 +105,16 @@ typedef struct {
     uint8_t *mapped_data;               // Mmap pointer
     size_t mapped_size;                 // Total mapped size
     mmap_buffer_header_t *header;       // Pointer to header
-    uint8_t *data_area;                 // Pointer to data area
-    
+    mmap_index_entry_t *index;          // Pointer to index ring
+    uint8_t *data_area;                 // Pointer to data ring
+
     int buffer_seconds;
-    int max_entries;                    // Maximum packet entries
-    size_t entry_size;                  // Size per entry slot
-    
+    int max_entries;                    // Index ring capacity
+    size_t data_capacity;               // Data ring size in bytes
+    bool keyframe_aligned_flush;        // Start flushes at the first keyframe
+
     pthread_mutex_t lock;
-    
+
     // Statistics
     int current_count;
     size_t current_bytes;
@@ -119,19 +150,30 @@ static int create_mmap_file(mmap_strategy_data_t *data, size_t size) {
         return -1;
     }
     
+    size_t index_offset = sizeof(mmap_buffer_header_t);
+    size_t data_offset = index_offset + (size_t)data->max_entries * sizeof(mmap_index_entry_t);
+    data_offset = (data_offset + MMAP_RECORD_ALIGN - 1) & ~(size_t)(MMAP_RECORD_ALIGN - 1);
+
     data->mapped_size = size;
     data->header = (mmap_buffer_header_t *)data->mapped_data;
-    data->data_area = data->mapped_data + sizeof(mmap_buffer_header_t);
+    data->index = (mmap_index_entry_t *)(data->mapped_data + index_offset);
+    data->data_area = data->mapped_data + data_offset;
+    data->data_capacity = size - data_offset;
     
     // Initialize header
     data->header->magic = MMAP_FILE_MAGIC;
-    data->header->version = 1;
+    data->header->version = MMAP_FILE_VERSION;
     data->header->entry_count = 0;
     data->header->head = 0;
     data->header->tail = 0;
     data->header->total_size = size;
-    data->header->data_offset = sizeof(mmap_buffer_header_t);
+    data->header->data_offset = data_offset;
     safe_strcpy(data->header->stream_name, data->stream_name, sizeof(data->header->stream_name), 0);
+    data->header->index_offset = index_offset;
+    data->header->index_capacity = (uint32_t)data->max_entries;
+    data->header->data_capacity = data->data_capacity;
+    data->header->data_head = 0;
+    data->header->data_used = 0;
     
     // Advise kernel about access pattern
     madvise(data->mapped_data, size, MADV_SEQUENTIAL);
@@ -141,26 +183,87 @@ static int create_mmap_file(mmap_strategy_data_t *data, size_t size) {
     return 0;
 }
 
+/**
+ * Drop the oldest buffered packet
+ *
+ * Only the index is read; the record itself is simply overwritten later.
+ * Must be called with data->lock held and a non-empty buffer.
+ */
+static void evict_oldest_locked(mmap_strategy_data_t *data) {
+    mmap_buffer_header_t *hdr = data->header;
+    const mmap_index_entry_t *oldest = &data->index[hdr->tail];
+
+    hdr->data_used -= oldest->span;
+    data->current_bytes -= oldest->span;
+    if (oldest->flags & AV_PKT_FLAG_KEY) {
+        data->keyframe_count--;
+    }
+
+    hdr->tail = (hdr->tail + 1) % (uint32_t)data->max_entries;
+    hdr->entry_count--;
+
+    if (hdr->entry_count == 0) {
+        // Empty ring: restart at the beginning so the next record never wraps
+        hdr->data_head = 0;
+        hdr->data_used = 0;
+        data->current_bytes = 0;
+        data->oldest_timestamp = 0;
+    } else {
+        data->oldest_timestamp = data->index[hdr->tail].timestamp;
+    }
+}
+
+/**
+ * Index position of the oldest buffered keyframe, or -1 if there is none
+ *
+ * Must be called with data->lock held.
+ */
+static int find_first_keyframe_locked(const mmap_strategy_data_t *data) {
+    if (data->keyframe_count <= 0) {
+        return -1;
+    }
+
+    uint32_t pos = data->header->tail;
+    for (uint32_t i = 0; i < data->header->entry_count; i++) {
+        if (data->index[pos].flags & AV_PKT_FLAG_KEY) {
+            return (int)pos;
+        }
+        pos = (pos + 1) % (uint32_t)data->max_entries;
+    }
+    return -1;
+}
+
 // --- Strategy interface methods ---
 
 static int mmap_strategy_init(pre_buffer_strategy_t *self, const buffer_config_t *config) {
     mmap_strategy_data_t *data = (mmap_strategy_data_t *)self->private_data;
 
     data->buffer_seconds = config->buffer_seconds;
+    data->keyframe_aligned_flush = config->prefer_keyframe_alignment;
 
     // Calculate buffer size
-    // Assume ~30 fps, ~50KB per frame average, 1.5x overhead
+    // Packets are stored back to back, so the data ring is sized by bitrate
+    // rather than by a worst-case packet size per slot.  The index only
+    // bounds the packet count: ~30 fps video plus audio, with 2x headroom.
     int estimated_frames = config->estimated_fps > 0 ? config->estimated_fps : 30;
-    data->max_entries = estimated_frames * config->buffer_seconds * 2;  // 2x for audio+video
-    data->entry_size = ENTRY_ALIGNED_SIZE(MAX_PACKET_SIZE);
+    int buffer_seconds = config->buffer_seconds > 0 ? config->buffer_seconds : 1;
+    data->max_entries = estimated_frames * buffer_seconds * 4;
+
+    size_t data_size = (size_t)buffer_seconds * MMAP_DEFAULT_BYTES_PER_SECOND;
+    if (data_size < MMAP_MIN_DATA_SIZE) {
+        data_size = MMAP_MIN_DATA_SIZE;
+    }
 
-    size_t total_size = sizeof(mmap_buffer_header_t) +
-                        (data->max_entries * data->entry_size);
+    size_t index_size = (size_t)data->max_entries * sizeof(mmap_index_entry_t);
+    size_t total_size = sizeof(mmap_buffer_header_t) + index_size + MMAP_RECORD_ALIGN + data_size;
 
     // Cap at configured limit if specified
     if (config->disk_limit_bytes > 0 && total_size > config->disk_limit_bytes) {
         total_size = config->disk_limit_bytes;
-        data->max_entries = (int)((total_size - sizeof(mmap_buffer_header_t)) / data->entry_size);
+        if (total_size < sizeof(mmap_buffer_header_t) + index_size + MMAP_RECORD_ALIGN + MMAP_MIN_DATA_SIZE / 4) {
+            log_error("Mmap disk limit of %zu bytes is too small for %s", total_size, data->stream_name);
+            return -1;
+        }
     }
 
     char safe_name[MAX_STREAM_NAME];
@@ -187,8 +290,8 @@ static int mmap_strategy_init(pre_buffer_strategy_t *self, const buffer_config_t
     }
 
     self->initialized = true;
-    log_info("Mmap strategy initialized for %s (%d entries, %zu bytes)",
-             data->stream_name, data->max_entries, total_size);
+    log_info("Mmap strategy initialized for %s (%d index entries, %zu data bytes, %zu bytes total)",
+             data->stream_name, data->max_entries, data->data_capacity, total_size);
 
     return 0;
 }
@@ -198,8 +301,9 @@ static void mmap_strategy_destroy(pre_buffer_strategy_t *self) {
 
     pthread_mutex_lock(&data->lock);
 
+    // The file is rebuilt from scratch on every create, so there is nothing
+    // worth syncing: just drop the mapping and remove the file
     if (data->mapped_data && data->mapped_data != MAP_FAILED) {
-        msync(data->mapped_data, data->mapped_size, MS_SYNC);
         munmap(data->mapped_data, data->mapped_size);
     }
 
@@ -207,8 +311,9 @@ static void mmap_strategy_destroy(pre_buffer_strategy_t *self) {
         close(data->fd);
     }
 
-    // Optionally remove the buffer file
-    // unlink(data->file_path);
+    if (data->file_path[0] != '\0' && unlink(data->file_path) != 0 && errno != ENOENT) {
+        log_warn("Failed to remove mmap buffer file %s: %s", data->file_path, strerror(errno));
+    }
 
     pthread_mutex_unlock(&data->lock);
     pthread_mutex_destroy(&data->lock);
@@ -223,50 +328,70 @@ static int mmap_strategy_add_packet(pre_buffer_strategy_t *self,
                                      time_t timestamp) {
     mmap_strategy_data_t *data = (mmap_strategy_data_t *)self->private_data;
 
-    if (!packet || packet->size > MAX_PACKET_SIZE) {
+    if (!packet || packet->size <= 0) {
+        return -1;
+    }
+
+    size_t record_size = ENTRY_ALIGNED_SIZE((size_t)packet->size);
+
+    // A single packet may not take more than half the ring, otherwise one
+    // oversized keyframe would wipe out the whole pre-roll
+    if (record_size > data->data_capacity / 2) {
+        log_warn("Packet of %d bytes too large for mmap buffer of %s", packet->size, data->stream_name);
         return -1;
     }
 
     pthread_mutex_lock(&data->lock);
 
-    // Calculate entry position
-    size_t offset = data->header->head * data->entry_size;
-    mmap_packet_entry_t *entry = (mmap_packet_entry_t *)(data->data_area + offset);
+    mmap_buffer_header_t *hdr = data->header;
 
-    // If buffer is full, advance tail
-    if (data->header->entry_count >= data->max_entries) {
-        // Remove oldest entry from stats
-        size_t tail_offset = data->header->tail * data->entry_size;
-        const mmap_packet_entry_t *tail_entry = (const mmap_packet_entry_t *)(data->data_area + tail_offset);
-        if (tail_entry->magic == MMAP_MAGIC) {
-            data->current_bytes -= tail_entry->data_size;
-            if (tail_entry->flags & AV_PKT_FLAG_KEY) {
-                data->keyframe_count--;
-            }
-        }
+    // Make room: the record needs record_size contiguous bytes starting at
+    // data_head, or at 0 if it does not fit before the end of the ring (the
+    // skipped tail bytes count as used until this record is evicted)
+    for (;;) {
+        size_t head = (size_t)hdr->data_head;
+        size_t padding = head + record_size > data->data_capacity ? data->data_capacity - head : 0;
+        size_t free_bytes = data->data_capacity - (size_t)hdr->data_used;
 
-        data->header->tail = (data->header->tail + 1) % data->max_entries;
-        data->header->entry_count--;
+        if (hdr->entry_count < (uint32_t)data->max_entries && free_bytes >= padding + record_size) {
+            break;
+        }
+        evict_oldest_locked(data);
     }
 
-    // Write entry
+    size_t head = (size_t)hdr->data_head;
+    size_t padding = head + record_size > data->data_capacity ? data->data_capacity - head : 0;
+    size_t offset = padding ? 0 : head;
+
+    // Write record
+    mmap_packet_entry_t *entry = (mmap_packet_entry_t *)(data->data_area + offset);
     entry->magic = MMAP_MAGIC;
-    entry->data_size = packet->size;
+    entry->data_size = (uint32_t)packet->size;
     entry->pts = packet->pts;
     entry->dts = packet->dts;
     entry->stream_index = packet->stream_index;
-    entry->flags = packet->flags;
+    entry->flags = (uint32_t)packet->flags;
     entry->timestamp = timestamp;
-    memcpy(entry->data, packet->data, packet->size);
+    memcpy(entry->data, packet->data, (size_t)packet->size);
+
+    // Write index entry
+    mmap_index_entry_t *idx = &data->index[hdr->head];
+    idx->offset = offset;
+    idx->span = (uint32_t)(padding + record_size);
+    idx->flags = (uint32_t)packet->flags;
+    idx->timestamp = timestamp;
 
     // Update head
-    data->header->head = (data->header->head + 1) % data->max_entries;
-    data->header->entry_count++;
-    data->current_count = (int)data->header->entry_count;
-    data->current_bytes += packet->size;
+    hdr->head = (hdr->head + 1) % (uint32_t)data->max_entries;
+    hdr->entry_count++;
+    hdr->data_head = (offset + record_size) % data->data_capacity;
+    hdr->data_used += idx->span;
+
+    data->current_count = (int)hdr->entry_count;
+    data->current_bytes += idx->span;
     data->newest_timestamp = timestamp;
 
-    if (data->header->entry_count == 1) {
+    if (hdr->entry_count == 1) {
         data->oldest_timestamp = timestamp;
     }
 
@@ -286,7 +411,7 @@ static int mmap_strategy_get_stats(pre_buffer_strategy_t *self, buffer_stats_t *
 
     pthread_mutex_lock(&data->lock);
 
-    stats->packet_count = data->current_count;
+    stats->packet_count = (int)data->header->entry_count;
     stats->memory_usage_bytes = 0;  // Memory managed by OS
     stats->disk_usage_bytes = data->mapped_size;
     stats->keyframe_count = data->keyframe_count;
@@ -318,6 +443,8 @@ static void mmap_strategy_clear(pre_buffer_strategy_t *self) {
     data->header->head = 0;
     data->header->tail = 0;
     data->header->entry_count = 0;
+    data->header->data_head = 0;
+    data->header->data_used = 0;
     data->current_count = 0;
     data->current_bytes = 0;
     data->keyframe_count = 0;
@@ -336,25 +463,39 @@ static int mmap_strategy_flush_to_callback(pre_buffer_strategy_t *self,
 
     int flushed = 0;
     uint32_t pos = data->header->tail;
+    uint32_t count = data->header->entry_count;
+
+    // Jump straight to the first keyframe using the index; packets before it
+    // cannot be decoded and would only produce a broken start of recording
+    if (data->keyframe_aligned_flush) {
+        int first_key = find_first_keyframe_locked(data);
+        if (first_key >= 0) {
+            uint32_t skipped = ((uint32_t)first_key + (uint32_t)data->max_entries - pos) % (uint32_t)data->max_entries;
+            pos = (uint32_t)first_key;
+            count -= skipped;
+        }
+    }
 
-    for (uint32_t i = 0; i < data->header->entry_count; i++) {
-        size_t offset = pos * data->entry_size;
-        mmap_packet_entry_t *entry = (mmap_packet_entry_t *)(data->data_area + offset);
+    // One packet struct is reused for the whole flush; each record gets a
+    // fresh buffer, so callbacks may still take their own reference
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt) {
+        pthread_mutex_unlock(&data->lock);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const mmap_index_entry_t *idx = &data->index[pos];
+        const mmap_packet_entry_t *entry = (const mmap_packet_entry_t *)(data->data_area + idx->offset);
 
         if (entry->magic != MMAP_MAGIC) {
             log_warn("Invalid mmap entry at position %u", pos);
-            pos = (pos + 1) % data->max_entries;
+            pos = (pos + 1) % (uint32_t)data->max_entries;
             continue;
         }
 
         // Reconstruct AVPacket
-        AVPacket *pkt = av_packet_alloc();
-        if (!pkt) {
-            break;
-        }
-
         if (av_new_packet(pkt, (int)entry->data_size) < 0) {
-            av_packet_free(&pkt);
             break;
         }
 
@@ -365,16 +506,18 @@ static int mmap_strategy_flush_to_callback(pre_buffer_strategy_t *self,
         pkt->flags = (int)entry->flags;
 
         int ret = callback(pkt, user_data);
-        av_packet_free(&pkt);
+        av_packet_unref(pkt);
 
         if (ret < 0) {
             break;
         }
 
         flushed++;
-        pos = (pos + 1) % data->max_entries;
+        pos = (pos + 1) % (uint32_t)data->max_entries;
     }
 
+    av_packet_free(&pkt);
+
     pthread_mutex_unlock(&data->lock);
 
     log_debug("Flushed %d packets from mmap buffer", flushed);
@@ -26,6 +26,7 @@
 #include "../../include/video/api_detection.h"
 #include "../../include/video/onvif_detection.h"
 #include "../../include/video/unified_detection_thread.h"
+#include "../../include/video/inference_scheduler.h"
 #include "../../include/video/ffmpeg_utils.h"  // For comprehensive_ffmpeg_cleanup
 #include "../../include/core/logger.h"
 #include "../../include/core/config.h"  // For MAX_PATH_LENGTH
@@ -45,6 +46,26 @@ static void video_timeout_handler(int sig) {
     }
 }
 
+/**
+ * Number of inference scheduler workers for this host
+ *
+ * A SOD forward pass runs on [models] sod_threads cores (0 = all of them), so
+ * one worker per sod_threads cores keeps every core busy: the default gives a
+ * single worker, sod_threads = 1 gives one worker per CPU.
+ */
+static int inference_worker_count(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores <= 0) {
+        return 1;
+    }
+
+    int per_pass = g_config.sod_threads;
+    if (per_pass <= 0 || per_pass > cores) {
+        return 1;
+    }
+    return (int)(cores / per_pass);
+}
+
 /**
  * Initialize the detection system
  */
@@ -56,6 +77,13 @@ int init_detection_system(void) {
         return model_ret;
     }
 
+    // Embedded models are shared by all streams and run by the scheduler's
+    // workers, sized so the forward passes in flight fill the CPUs
+    if (inference_scheduler_init(inference_worker_count(), NULL) != 0) {
+        log_error("Failed to start inference scheduler");
+        log_warn("Detection threads will load and run their own models");
+    }
+
     // Initialize motion detection system
     int motion_ret = init_motion_detection_system();
     if (motion_ret != 0) {
@@ -94,6 +122,9 @@ void shutdown_detection_system(void) {
     // Shutdown unified detection thread system first (it may depend on models)
     shutdown_unified_detection_system();
 
+    // Stop the inference workers and unload the shared models
+    inference_scheduler_shutdown();
+
     // Shutdown the model system
     shutdown_detection_model_system();
 
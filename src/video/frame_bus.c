@@ -0,0 +1,496 @@
+/**
+ * Per-stream decoded frame bus
+ *
+ * One slot per stream holds the most recently published frame (a reference,
+ * never a copy) and the list of subscribers.  Subscribers pull frames at
+ * their own rate; the publisher only pays for frames someone is waiting for.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+
+#include "video/frame_bus.h"
+#include "core/config.h"
+#include "core/logger.h"
+#include "utils/strings.h"
+
+struct frame_bus_subscriber {
+    struct frame_bus_slot *slot;
+    frame_bus_sub_config_t config;
+
+    uint64_t last_seq;              // Sequence number of the last frame delivered
+    int64_t last_delivered_ms;      // Monotonic time of the last delivery
+
+    // Scaler for subscribers that asked for a different size or format;
+    // only touched by the subscriber's own thread
+    struct SwsContext *sws_ctx;
+
+    struct frame_bus_subscriber *next;
+};
+
+typedef struct frame_bus_slot {
+    bool initialized;               // mutex/cond created (slots are never torn down)
+    bool in_use;
+    char stream_name[MAX_STREAM_NAME];
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    AVFrame *latest;                // Reference to the newest published frame
+    uint64_t seq;                   // Incremented on every publish
+    int64_t last_publish_ms;
+
+    frame_bus_subscriber_t *subscribers;
+    int subscriber_count;
+
+    uint64_t frames_published;
+    uint64_t frames_delivered;
+} frame_bus_slot_t;
+
+static frame_bus_slot_t bus_slots[MAX_STREAMS];
+static pthread_mutex_t bus_slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Slots in use; lets the publisher skip the lock and the slot search on
+// every decoded frame while nobody is subscribed anywhere
+static atomic_int bus_slots_in_use;
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Find the slot for a stream, optionally claiming a free one
+ *
+ * Must be called with bus_slots_mutex held.
+ */
+static frame_bus_slot_t *find_slot_locked(const char *stream_name, bool create) {
+    frame_bus_slot_t *free_slot = NULL;
+
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        frame_bus_slot_t *slot = &bus_slots[i];
+        if (slot->in_use) {
+            if (strcmp(slot->stream_name, stream_name) == 0) {
+                return slot;
+            }
+        } else if (!free_slot) {
+            free_slot = slot;
+        }
+    }
+
+    if (!create || !free_slot) {
+        return NULL;
+    }
+
+    if (!free_slot->initialized) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_mutex_init(&free_slot->mutex, NULL);
+        pthread_cond_init(&free_slot->cond, &attr);
+        pthread_condattr_destroy(&attr);
+        free_slot->initialized = true;
+    }
+
+    safe_strcpy(free_slot->stream_name, stream_name, sizeof(free_slot->stream_name), 0);
+    free_slot->latest = NULL;
+    free_slot->seq = 0;
+    free_slot->last_publish_ms = 0;
+    free_slot->subscribers = NULL;
+    free_slot->subscriber_count = 0;
+    free_slot->frames_published = 0;
+    free_slot->frames_delivered = 0;
+    free_slot->in_use = true;
+    atomic_fetch_add(&bus_slots_in_use, 1);
+    return free_slot;
+}
+
+/**
+ * Smallest delivery interval requested by any subscriber
+ *
+ * Must be called with slot->mutex held.  Returns -1 without subscribers.
+ */
+static int min_interval_locked(const frame_bus_slot_t *slot) {
+    int min_interval = -1;
+    for (const frame_bus_subscriber_t *sub = slot->subscribers; sub; sub = sub->next) {
+        if (min_interval < 0 || sub->config.interval_ms < min_interval) {
+            min_interval = sub->config.interval_ms;
+        }
+    }
+    return min_interval;
+}
+
+/**
+ * Check whether any subscriber would take a frame published now
+ *
+ * Must be called with slot->mutex held.
+ */
+static bool wants_frame_locked(const frame_bus_slot_t *slot, int64_t now_ms) {
+    int min_interval = min_interval_locked(slot);
+    if (min_interval < 0) {
+        return false;
+    }
+    return slot->latest == NULL || now_ms - slot->last_publish_ms >= min_interval;
+}
+
+/**
+ * Check whether a subscriber has a new frame due
+ *
+ * Must be called with slot->mutex held.  On false, *wait_ms (if set) receives
+ * how long until the pending frame becomes due, or -1 if there is none.
+ */
+static bool frame_due_locked(const frame_bus_subscriber_t *sub, int64_t now_ms, int64_t *wait_ms) {
+    const frame_bus_slot_t *slot = sub->slot;
+
+    if (!slot->latest || slot->seq == sub->last_seq) {
+        if (wait_ms) *wait_ms = -1;
+        return false;
+    }
+
+    int64_t elapsed = now_ms - sub->last_delivered_ms;
+    if (sub->last_seq != 0 && elapsed < sub->config.interval_ms) {
+        if (wait_ms) *wait_ms = sub->config.interval_ms - elapsed;
+        return false;
+    }
+
+    return true;
+}
+
+int frame_bus_publish(const char *stream_name, const AVFrame *frame) {
+    if (!stream_name || !frame) {
+        return -1;
+    }
+    if (atomic_load_explicit(&bus_slots_in_use, memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    // Lock the slot before dropping bus_slots_mutex so it cannot be released
+    // and handed to another stream in between
+    pthread_mutex_lock(&bus_slots_mutex);
+    frame_bus_slot_t *slot = find_slot_locked(stream_name, false);
+    if (!slot) {
+        // Nobody is subscribed to this stream
+        pthread_mutex_unlock(&bus_slots_mutex);
+        return 0;
+    }
+    pthread_mutex_lock(&slot->mutex);
+    pthread_mutex_unlock(&bus_slots_mutex);
+
+    int64_t now_ms = monotonic_ms();
+
+    if (!wants_frame_locked(slot, now_ms)) {
+        pthread_mutex_unlock(&slot->mutex);
+        return 0;
+    }
+
+    if (!slot->latest) {
+        slot->latest = av_frame_alloc();
+        if (!slot->latest) {
+            pthread_mutex_unlock(&slot->mutex);
+            return -1;
+        }
+    } else {
+        av_frame_unref(slot->latest);
+    }
+
+    if (av_frame_ref(slot->latest, frame) < 0) {
+        av_frame_free(&slot->latest);
+        pthread_mutex_unlock(&slot->mutex);
+        log_warn("[%s] Frame bus: failed to reference published frame", stream_name);
+        return -1;
+    }
+
+    slot->seq++;
+    slot->last_publish_ms = now_ms;
+    slot->frames_published++;
+
+    pthread_cond_broadcast(&slot->cond);
+    pthread_mutex_unlock(&slot->mutex);
+
+    return 1;
+}
+
+bool frame_bus_wants_frame(const char *stream_name) {
+    if (!stream_name) {
+        return false;
+    }
+    if (atomic_load_explicit(&bus_slots_in_use, memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&bus_slots_mutex);
+    frame_bus_slot_t *slot = find_slot_locked(stream_name, false);
+    if (!slot) {
+        pthread_mutex_unlock(&bus_slots_mutex);
+        return false;
+    }
+    pthread_mutex_lock(&slot->mutex);
+    pthread_mutex_unlock(&bus_slots_mutex);
+
+    bool wants = wants_frame_locked(slot, monotonic_ms());
+    pthread_mutex_unlock(&slot->mutex);
+
+    return wants;
+}
+
+void frame_bus_clear(const char *stream_name) {
+    if (!stream_name) {
+        return;
+    }
+
+    pthread_mutex_lock(&bus_slots_mutex);
+    frame_bus_slot_t *slot = find_slot_locked(stream_name, false);
+    if (slot) {
+        pthread_mutex_lock(&slot->mutex);
+        av_frame_free(&slot->latest);
+        pthread_mutex_unlock(&slot->mutex);
+    }
+    pthread_mutex_unlock(&bus_slots_mutex);
+}
+
+frame_bus_subscriber_t *frame_bus_subscribe(const char *stream_name, const frame_bus_sub_config_t *config) {
+    if (!stream_name || stream_name[0] == '\0') {
+        return NULL;
+    }
+
+    frame_bus_subscriber_t *sub = calloc(1, sizeof(frame_bus_subscriber_t));
+    if (!sub) {
+        log_error("[%s] Frame bus: failed to allocate subscriber", stream_name);
+        return NULL;
+    }
+
+    if (config) {
+        sub->config = *config;
+    } else {
+        sub->config.pix_fmt = AV_PIX_FMT_NONE;
+    }
+    if (sub->config.interval_ms < 0) sub->config.interval_ms = 0;
+    if (sub->config.width < 0) sub->config.width = 0;
+    if (sub->config.height < 0) sub->config.height = 0;
+
+    pthread_mutex_lock(&bus_slots_mutex);
+    frame_bus_slot_t *slot = find_slot_locked(stream_name, true);
+    if (!slot) {
+        pthread_mutex_unlock(&bus_slots_mutex);
+        log_error("[%s] Frame bus: no free stream slots", stream_name);
+        free(sub);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&slot->mutex);
+    sub->slot = slot;
+    sub->next = slot->subscribers;
+    slot->subscribers = sub;
+    slot->subscriber_count++;
+    pthread_mutex_unlock(&slot->mutex);
+    pthread_mutex_unlock(&bus_slots_mutex);
+
+    log_debug("[%s] Frame bus: subscriber added (interval=%dms, size=%dx%d, fmt=%d)",
+              stream_name, sub->config.interval_ms, sub->config.width, sub->config.height,
+              sub->config.pix_fmt);
+    return sub;
+}
+
+void frame_bus_unsubscribe(frame_bus_subscriber_t *sub) {
+    if (!sub) {
+        return;
+    }
+
+    frame_bus_slot_t *slot = sub->slot;
+
+    pthread_mutex_lock(&bus_slots_mutex);
+    pthread_mutex_lock(&slot->mutex);
+
+    frame_bus_subscriber_t **link = &slot->subscribers;
+    while (*link && *link != sub) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = sub->next;
+        slot->subscriber_count--;
+    }
+
+    // Release the slot once the last subscriber is gone; the publisher finds
+    // no slot and stops retaining frames
+    if (slot->subscriber_count == 0) {
+        av_frame_free(&slot->latest);
+        slot->in_use = false;
+        atomic_fetch_sub(&bus_slots_in_use, 1);
+    }
+
+    pthread_mutex_unlock(&slot->mutex);
+    pthread_mutex_unlock(&bus_slots_mutex);
+
+    if (sub->sws_ctx) {
+        sws_freeContext(sub->sws_ctx);
+    }
+    free(sub);
+}
+
+/**
+ * Take a reference to the slot's frame for a subscriber if one is due
+ *
+ * Must be called with slot->mutex held.
+ */
+static AVFrame *take_frame_locked(frame_bus_subscriber_t *sub, int64_t now_ms) {
+    frame_bus_slot_t *slot = sub->slot;
+
+    AVFrame *ref = av_frame_alloc();
+    if (!ref) {
+        return NULL;
+    }
+    if (av_frame_ref(ref, slot->latest) < 0) {
+        av_frame_free(&ref);
+        return NULL;
+    }
+
+    sub->last_seq = slot->seq;
+    sub->last_delivered_ms = now_ms;
+    slot->frames_delivered++;
+    return ref;
+}
+
+/**
+ * Convert a delivered frame to the subscriber's requested size and format
+ *
+ * Takes ownership of src.  Returns src untouched when no conversion is needed.
+ */
+static AVFrame *convert_for_subscriber(frame_bus_subscriber_t *sub, AVFrame *src) {
+    int dst_width = sub->config.width > 0 ? sub->config.width : src->width;
+    int dst_height = sub->config.height > 0 ? sub->config.height : src->height;
+    enum AVPixelFormat dst_format = sub->config.pix_fmt != AV_PIX_FMT_NONE
+                                    ? sub->config.pix_fmt : (enum AVPixelFormat)src->format;
+
+    if (dst_width == src->width && dst_height == src->height && dst_format == src->format) {
+        return src;
+    }
+
+    sub->sws_ctx = sws_getCachedContext(sub->sws_ctx,
+                                        src->width, src->height, (enum AVPixelFormat)src->format,
+                                        dst_width, dst_height, dst_format,
+                                        SWS_BILINEAR, NULL, NULL, NULL);
+    if (!sub->sws_ctx) {
+        log_error("[%s] Frame bus: failed to create scaler (%dx%d fmt %d -> %dx%d fmt %d)",
+                  sub->slot->stream_name, src->width, src->height, src->format,
+                  dst_width, dst_height, dst_format);
+        av_frame_free(&src);
+        return NULL;
+    }
+
+    AVFrame *dst = av_frame_alloc();
+    if (!dst) {
+        av_frame_free(&src);
+        return NULL;
+    }
+
+    dst->width = dst_width;
+    dst->height = dst_height;
+    dst->format = dst_format;
+    if (av_frame_get_buffer(dst, 0) < 0) {
+        av_frame_free(&dst);
+        av_frame_free(&src);
+        return NULL;
+    }
+    av_frame_copy_props(dst, src);
+
+    sws_scale(sub->sws_ctx, (const uint8_t * const *)src->data, src->linesize,
+              0, src->height, dst->data, dst->linesize);
+
+    av_frame_free(&src);
+    return dst;
+}
+
+AVFrame *frame_bus_acquire(frame_bus_subscriber_t *sub) {
+    if (!sub) {
+        return NULL;
+    }
+
+    frame_bus_slot_t *slot = sub->slot;
+    int64_t now_ms = monotonic_ms();
+    AVFrame *frame = NULL;
+
+    pthread_mutex_lock(&slot->mutex);
+    if (frame_due_locked(sub, now_ms, NULL)) {
+        frame = take_frame_locked(sub, now_ms);
+    }
+    pthread_mutex_unlock(&slot->mutex);
+
+    // Scaling happens outside the lock so a slow subscriber never holds up
+    // the publisher
+    return frame ? convert_for_subscriber(sub, frame) : NULL;
+}
+
+AVFrame *frame_bus_acquire_wait(frame_bus_subscriber_t *sub, int timeout_ms) {
+    if (!sub) {
+        return NULL;
+    }
+
+    frame_bus_slot_t *slot = sub->slot;
+    int64_t deadline_ms = monotonic_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    AVFrame *frame = NULL;
+
+    pthread_mutex_lock(&slot->mutex);
+    for (;;) {
+        int64_t now_ms = monotonic_ms();
+        int64_t wait_ms = -1;
+
+        if (frame_due_locked(sub, now_ms, &wait_ms)) {
+            frame = take_frame_locked(sub, now_ms);
+            break;
+        }
+        if (now_ms >= deadline_ms) {
+            break;
+        }
+
+        // Sleep until a publish, until the pending frame is due, or until
+        // the deadline, whichever comes first
+        int64_t wake_ms = deadline_ms;
+        if (wait_ms >= 0 && now_ms + wait_ms < wake_ms) {
+            wake_ms = now_ms + wait_ms;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)(wake_ms / 1000);
+        ts.tv_nsec = (long)(wake_ms % 1000) * 1000000L;
+        int rc = pthread_cond_timedwait(&slot->cond, &slot->mutex, &ts);
+        if (rc != 0 && rc != ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&slot->mutex);
+
+    return frame ? convert_for_subscriber(sub, frame) : NULL;
+}
+
+int frame_bus_get_stats(const char *stream_name, frame_bus_stats_t *stats) {
+    if (!stream_name || !stats) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bus_slots_mutex);
+    frame_bus_slot_t *slot = find_slot_locked(stream_name, false);
+    if (!slot) {
+        pthread_mutex_unlock(&bus_slots_mutex);
+        return -1;
+    }
+
+    pthread_mutex_lock(&slot->mutex);
+    stats->subscribers = slot->subscriber_count;
+    stats->frames_published = slot->frames_published;
+    stats->frames_delivered = slot->frames_delivered;
+    pthread_mutex_unlock(&slot->mutex);
+    pthread_mutex_unlock(&bus_slots_mutex);
+
+    return 0;
+}
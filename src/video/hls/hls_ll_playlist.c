@@ -0,0 +1,180 @@
+/**
+ * Low-latency HLS playlist
+ *
+ * Pure bookkeeping: the HLS writer reports parts and segment boundaries as it
+ * cuts them, and renders the playlist after each change.  Nothing here touches
+ * FFmpeg or the memory store, so the rules can be tested on their own.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "video/hls/hls_ll_playlist.h"
+
+// Parts are only listed for segments this many target durations from the
+// live edge; older segments are referenced as whole segments only
+#define HLS_LL_PART_LIST_TARGETS 3
+
+// Requests may block on at most this many segments past the one being built
+#define HLS_LL_MAX_FUTURE_SEGMENTS 2
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} render_buf_t;
+
+static void append(render_buf_t *out, const char *fmt, ...) {
+    if (out->overflow) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out->buf + out->len, out->size - out->len, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= out->size - out->len) {
+        out->overflow = true;
+        return;
+    }
+    out->len += (size_t)n;
+}
+
+static void append_parts(render_buf_t *out, const hls_ll_segment_t *seg) {
+    for (int i = 0; i < seg->part_count; i++) {
+        append(out, "#EXT-X-PART:DURATION=%.5f,URI=\"part_%lld_%d.ts\"%s\n",
+               seg->parts[i].duration, (long long)seg->msn, i,
+               seg->parts[i].independent ? ",INDEPENDENT=YES" : "");
+    }
+}
+
+int hls_ll_playlist_init(hls_ll_playlist_t *pl, int target_duration, double part_target,
+                         int window, int max_parts) {
+    if (!pl || target_duration <= 0 || part_target <= 0.0 || window <= 0 || max_parts <= 0) {
+        return -1;
+    }
+
+    memset(pl, 0, sizeof(*pl));
+    pl->segments = calloc((size_t)window, sizeof(hls_ll_segment_t));
+    if (!pl->segments) {
+        return -1;
+    }
+
+    pl->target_duration = target_duration;
+    pl->part_target = part_target;
+    pl->max_parts = max_parts;
+    pl->window = window;
+    return 0;
+}
+
+void hls_ll_playlist_free(hls_ll_playlist_t *pl) {
+    if (!pl) {
+        return;
+    }
+    free(pl->segments);
+    pl->segments = NULL;
+    pl->count = 0;
+}
+
+int hls_ll_playlist_add_part(hls_ll_playlist_t *pl, double duration, bool independent) {
+    if (!pl || pl->current.part_count >= HLS_LL_MAX_PARTS) {
+        return -1;
+    }
+
+    int index = pl->current.part_count++;
+    pl->current.parts[index].duration = duration;
+    pl->current.parts[index].independent = independent;
+    pl->current.duration += duration;
+    return index;
+}
+
+int64_t hls_ll_playlist_end_segment(hls_ll_playlist_t *pl) {
+    if (!pl || pl->current.part_count == 0) {
+        return -1;
+    }
+
+    // EXT-X-TARGETDURATION must cover every segment, including ones that ran
+    // long while waiting for a keyframe
+    int rounded = (int)(pl->current.duration + 0.5);
+    if (rounded > pl->target_duration) {
+        pl->target_duration = rounded;
+    }
+
+    if (pl->count == pl->window) {
+        pl->head = (pl->head + 1) % pl->window;
+        pl->count--;
+    }
+    pl->segments[(pl->head + pl->count) % pl->window] = pl->current;
+    pl->count++;
+
+    int64_t msn = pl->current.msn;
+    memset(&pl->current, 0, sizeof(pl->current));
+    pl->current.msn = msn + 1;
+    return msn;
+}
+
+int hls_ll_playlist_render(const hls_ll_playlist_t *pl, char *buf, size_t size) {
+    if (!pl || !buf || size == 0) {
+        return -1;
+    }
+
+    render_buf_t out = { .buf = buf, .size = size };
+    int64_t first_msn = pl->count > 0 ? pl->segments[pl->head].msn : pl->current.msn;
+
+    append(&out, "#EXTM3U\n");
+    append(&out, "#EXT-X-VERSION:6\n");
+    append(&out, "#EXT-X-TARGETDURATION:%d\n", pl->target_duration);
+    append(&out, "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=%.3f\n",
+           pl->part_target * 3.0);
+    append(&out, "#EXT-X-PART-INF:PART-TARGET=%.3f\n", pl->part_target);
+    append(&out, "#EXT-X-MEDIA-SEQUENCE:%lld\n", (long long)first_msn);
+    append(&out, "#EXT-X-INDEPENDENT-SEGMENTS\n");
+
+    // Work out, newest first, which completed segments still get their parts
+    // listed: they must be close to the live edge and still held by the store
+    int first_with_parts = pl->count;
+    int budget = pl->max_parts - pl->current.part_count;
+    double age = pl->current.duration;
+    for (int i = pl->count - 1; i >= 0; i--) {
+        const hls_ll_segment_t *seg = &pl->segments[(pl->head + i) % pl->window];
+        if (age >= (double)(pl->target_duration * HLS_LL_PART_LIST_TARGETS) ||
+            seg->part_count > budget) {
+            break;
+        }
+        budget -= seg->part_count;
+        age += seg->duration;
+        first_with_parts = i;
+    }
+
+    for (int i = 0; i < pl->count; i++) {
+        const hls_ll_segment_t *seg = &pl->segments[(pl->head + i) % pl->window];
+        if (i >= first_with_parts) {
+            append_parts(&out, seg);
+        }
+        append(&out, "#EXTINF:%.5f,\nsegment_%lld.ts\n", seg->duration, (long long)seg->msn);
+    }
+
+    append_parts(&out, &pl->current);
+    append(&out, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"part_%lld_%d.ts\"\n",
+           (long long)pl->current.msn, pl->current.part_count);
+
+    return out.overflow ? -1 : (int)out.len;
+}
+
+hls_ll_request_state_t hls_ll_playlist_request_state(int64_t cur_msn, int cur_parts,
+                                                     int64_t msn, int part) {
+    if (msn > cur_msn + HLS_LL_MAX_FUTURE_SEGMENTS) {
+        return HLS_LL_REQUEST_INVALID;
+    }
+    if (msn < cur_msn) {
+        return HLS_LL_REQUEST_READY;
+    }
+    if (msn == cur_msn && part >= 0 && part < cur_parts) {
+        return HLS_LL_REQUEST_READY;
+    }
+    return HLS_LL_REQUEST_WAIT;
+}
@@ -0,0 +1,534 @@
+/**
+ * In-memory HLS segment store
+ *
+ * One store per stream, kept in a mutex-protected list.  Segments live in a
+ * fixed-size ring ordered by arrival; the playlist is a single buffer that is
+ * swapped on every update.  File contents are reference counted: a reader
+ * takes a reference under the store lock and makes its private copy after
+ * releasing it, so a large segment copy never holds up other streams, and a
+ * buffer can be replaced or evicted while a reader is still copying it.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "core/logger.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/hls/hls_memory_store.h"
+
+#define HLS_MEMORY_FILE_NAME 64
+
+// Immutable file contents shared by the store and readers still copying them
+typedef struct {
+    atomic_int refs;
+    size_t size;
+    unsigned char data[];
+} hls_memory_blob_t;
+
+typedef struct {
+    char name[HLS_MEMORY_FILE_NAME];
+    hls_memory_blob_t *blob;
+    unsigned char *data;            // blob->data, NULL when the slot is empty
+    size_t size;
+} hls_memory_file_t;
+
+typedef struct hls_memory_store {
+    char stream_name[MAX_STREAM_NAME];
+    hls_memory_file_t playlist;
+
+    // Segment ring: segments[(head + i) % max_segments] for i < count, oldest first
+    hls_memory_file_t *segments;
+    int max_segments;
+    int head;
+    int count;
+
+    // Names of segments spilled to disk, oldest first (same ring layout)
+    char spill_dir[MAX_PATH_LENGTH];
+    char (*spilled)[HLS_MEMORY_FILE_NAME];
+    int spill_segments;
+    int spill_head;
+    int spill_count;
+
+    // Low-latency parts: a second ring without spilling, plus the position
+    // (segment being built, parts published in it) of the newest playlist
+    hls_memory_file_t *parts;
+    int max_parts;
+    int parts_head;
+    int parts_count;
+    int64_t position_msn;
+    int position_parts;
+    int target_duration;
+
+    size_t bytes;
+    struct hls_memory_store *next;
+} hls_memory_store_t;
+
+static hls_memory_store_t *g_stores = NULL;
+static pthread_mutex_t g_stores_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void (*g_listener)(void) = NULL;
+
+static bool is_playlist(const char *file_name) {
+    size_t len = strlen(file_name);
+    return len >= 5 && strcmp(file_name + len - 5, ".m3u8") == 0;
+}
+
+static bool is_part(const hls_memory_store_t *store, const char *file_name) {
+    return store->max_parts > 0 && strncmp(file_name, "part_", 5) == 0;
+}
+
+static hls_memory_store_t *find_store(const char *stream_name) {
+    for (hls_memory_store_t *store = g_stores; store; store = store->next) {
+        if (strcmp(store->stream_name, stream_name) == 0) {
+            return store;
+        }
+    }
+    return NULL;
+}
+
+static void blob_release(hls_memory_blob_t *blob) {
+    if (blob && atomic_fetch_sub(&blob->refs, 1) == 1) {
+        free(blob);
+    }
+}
+
+static void free_file(hls_memory_file_t *file) {
+    blob_release(file->blob);
+    file->blob = NULL;
+    file->data = NULL;
+    file->size = 0;
+    file->name[0] = '\0';
+}
+
+/**
+ * Delete spilled segments and release the store
+ */
+static void free_store(hls_memory_store_t *store) {
+    for (int i = 0; i < store->spill_count; i++) {
+        char path[MAX_PATH_LENGTH + HLS_MEMORY_FILE_NAME + 1];
+        snprintf(path, sizeof(path), "%s/%s", store->spill_dir,
+                 store->spilled[(store->spill_head + i) % store->spill_segments]);
+        unlink(path);
+    }
+    for (int i = 0; i < store->count; i++) {
+        free_file(&store->segments[(store->head + i) % store->max_segments]);
+    }
+    for (int i = 0; i < store->parts_count; i++) {
+        free_file(&store->parts[(store->parts_head + i) % store->max_parts]);
+    }
+    free_file(&store->playlist);
+    free(store->segments);
+    free(store->parts);
+    free(store->spilled);
+    free(store);
+}
+
+/**
+ * Write an evicted segment to the spill directory
+ */
+static int spill_segment(const char *spill_dir, const hls_memory_file_t *file) {
+    char path[MAX_PATH_LENGTH + HLS_MEMORY_FILE_NAME + 1];
+    snprintf(path, sizeof(path), "%s/%s", spill_dir, file->name);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_warn("Failed to spill HLS segment %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    size_t written = 0;
+    while (written < file->size) {
+        ssize_t n = write(fd, file->data + written, file->size - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            log_warn("Failed to write spilled HLS segment %s: %s", path, strerror(errno));
+            close(fd);
+            unlink(path);
+            return -1;
+        }
+        written += (size_t)n;
+    }
+
+    close(fd);
+    return 0;
+}
+
+int hls_memory_store_open(const char *stream_name, int max_segments,
+                          const char *spill_dir, int spill_segments) {
+    if (!stream_name || max_segments <= 0) {
+        return -1;
+    }
+
+    hls_memory_store_t *store = calloc(1, sizeof(hls_memory_store_t));
+    if (!store) {
+        log_error("Failed to allocate HLS memory store for stream %s", stream_name);
+        return -1;
+    }
+
+    safe_strcpy(store->stream_name, stream_name, sizeof(store->stream_name), 0);
+    store->max_segments = max_segments;
+    store->position_msn = -1;
+    store->segments = calloc((size_t)max_segments, sizeof(hls_memory_file_t));
+
+    if (spill_dir && spill_dir[0] != '\0' && spill_segments > 0) {
+        safe_strcpy(store->spill_dir, spill_dir, sizeof(store->spill_dir), 0);
+        store->spill_segments = spill_segments;
+        store->spilled = calloc((size_t)spill_segments, HLS_MEMORY_FILE_NAME);
+    }
+
+    if (!store->segments || (store->spill_segments > 0 && !store->spilled)) {
+        log_error("Failed to allocate HLS memory store for stream %s", stream_name);
+        free(store->segments);
+        free(store->spilled);
+        free(store);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_stores_mutex);
+
+    // Replace any store left over from a previous writer
+    hls_memory_store_t **link = &g_stores;
+    while (*link && strcmp((*link)->stream_name, stream_name) != 0) {
+        link = &(*link)->next;
+    }
+    hls_memory_store_t *old = *link;
+    if (old) {
+        *link = old->next;
+    }
+
+    store->next = g_stores;
+    g_stores = store;
+
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    if (old) {
+        free_store(old);
+    }
+
+    log_info("Serving HLS for stream %s from memory (%d segments, %d spilled to disk)",
+             stream_name, max_segments, store->spill_segments);
+    return 0;
+}
+
+void hls_memory_store_close(const char *stream_name) {
+    if (!stream_name) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_stores_mutex);
+
+    hls_memory_store_t **link = &g_stores;
+    while (*link && strcmp((*link)->stream_name, stream_name) != 0) {
+        link = &(*link)->next;
+    }
+    hls_memory_store_t *store = *link;
+    if (store) {
+        *link = store->next;
+    }
+    void (*listener)(void) = g_listener;
+
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    if (store) {
+        bool had_parts = store->max_parts > 0;
+        free_store(store);
+        log_info("Closed HLS memory store for stream %s", stream_name);
+
+        // Let requests blocked on this stream's parts give up right away
+        if (had_parts && listener) {
+            listener();
+        }
+    }
+}
+
+void hls_memory_store_close_all(void) {
+    pthread_mutex_lock(&g_stores_mutex);
+    hls_memory_store_t *stores = g_stores;
+    g_stores = NULL;
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    while (stores) {
+        hls_memory_store_t *next = stores->next;
+        free_store(stores);
+        stores = next;
+    }
+}
+
+bool hls_memory_store_is_open(const char *stream_name) {
+    if (!stream_name) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_stores_mutex);
+    bool open = find_store(stream_name) != NULL;
+    pthread_mutex_unlock(&g_stores_mutex);
+    return open;
+}
+
+int hls_memory_store_put(const char *stream_name, const char *file_name,
+                         const unsigned char *data, size_t size) {
+    if (!stream_name || !file_name || (!data && size > 0)) {
+        return -1;
+    }
+
+    // Copy outside the lock; readers only ever wait for pointer swaps
+    hls_memory_blob_t *copy = malloc(sizeof(hls_memory_blob_t) + size);
+    if (!copy) {
+        log_error("Failed to allocate %zu bytes for HLS file %s", size, file_name);
+        return -1;
+    }
+    atomic_init(&copy->refs, 1);
+    copy->size = size;
+    if (size > 0) {
+        memcpy(copy->data, data, size);
+    }
+
+    hls_memory_file_t evicted = {0};
+    hls_memory_file_t replaced = {0};
+    char spill_dir[MAX_PATH_LENGTH] = {0};
+    char expired_spill[HLS_MEMORY_FILE_NAME] = {0};
+
+    pthread_mutex_lock(&g_stores_mutex);
+
+    hls_memory_store_t *store = find_store(stream_name);
+    if (!store) {
+        pthread_mutex_unlock(&g_stores_mutex);
+        blob_release(copy);
+        return -1;
+    }
+
+    hls_memory_file_t *slot = NULL;
+    if (is_playlist(file_name)) {
+        slot = &store->playlist;
+    } else if (is_part(store, file_name)) {
+        // Parts are only useful near the live edge and are never spilled
+        if (store->parts_count == store->max_parts) {
+            evicted = store->parts[store->parts_head];
+            memset(&store->parts[store->parts_head], 0, sizeof(hls_memory_file_t));
+            store->bytes -= evicted.size;
+            store->parts_head = (store->parts_head + 1) % store->max_parts;
+            store->parts_count--;
+        }
+        slot = &store->parts[(store->parts_head + store->parts_count) % store->max_parts];
+        store->parts_count++;
+    } else {
+        // A rewrite of a segment still in the ring replaces it in place
+        for (int i = 0; i < store->count; i++) {
+            hls_memory_file_t *file = &store->segments[(store->head + i) % store->max_segments];
+            if (strcmp(file->name, file_name) == 0) {
+                slot = file;
+                break;
+            }
+        }
+
+        if (!slot) {
+            if (store->count == store->max_segments) {
+                evicted = store->segments[store->head];
+                memset(&store->segments[store->head], 0, sizeof(hls_memory_file_t));
+                store->bytes -= evicted.size;
+                store->head = (store->head + 1) % store->max_segments;
+                store->count--;
+
+                if (store->spill_segments > 0) {
+                    safe_strcpy(spill_dir, store->spill_dir, sizeof(spill_dir), 0);
+                    if (store->spill_count == store->spill_segments) {
+                        safe_strcpy(expired_spill, store->spilled[store->spill_head],
+                                    sizeof(expired_spill), 0);
+                        store->spill_head = (store->spill_head + 1) % store->spill_segments;
+                        store->spill_count--;
+                    }
+                    safe_strcpy(store->spilled[(store->spill_head + store->spill_count) % store->spill_segments],
+                                evicted.name, HLS_MEMORY_FILE_NAME, 0);
+                    store->spill_count++;
+                }
+            }
+            slot = &store->segments[(store->head + store->count) % store->max_segments];
+            store->count++;
+        }
+    }
+
+    replaced = *slot;
+    store->bytes -= replaced.size;
+    safe_strcpy(slot->name, file_name, sizeof(slot->name), 0);
+    slot->blob = copy;
+    slot->data = copy->data;
+    slot->size = size;
+    store->bytes += size;
+
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    blob_release(replaced.blob);
+
+    // Disk work happens after the lock is released so readers never wait on it
+    if (evicted.data) {
+        if (spill_dir[0] != '\0') {
+            spill_segment(spill_dir, &evicted);
+        }
+        blob_release(evicted.blob);
+    }
+    if (expired_spill[0] != '\0') {
+        char path[MAX_PATH_LENGTH + HLS_MEMORY_FILE_NAME + 1];
+        snprintf(path, sizeof(path), "%s/%s", spill_dir, expired_spill);
+        if (unlink(path) != 0 && errno != ENOENT) {
+            log_debug("Failed to delete spilled HLS segment %s: %s", path, strerror(errno));
+        }
+    }
+
+    return 0;
+}
+
+int hls_memory_store_get(const char *stream_name, const char *file_name,
+                         unsigned char **data, size_t *size) {
+    if (!stream_name || !file_name || !data || !size) {
+        return -1;
+    }
+    *data = NULL;
+    *size = 0;
+
+    int result = -1;
+    pthread_mutex_lock(&g_stores_mutex);
+
+    const hls_memory_store_t *store = find_store(stream_name);
+    const hls_memory_file_t *found = NULL;
+    if (store) {
+        if (is_playlist(file_name)) {
+            if (store->playlist.data && strcmp(store->playlist.name, file_name) == 0) {
+                found = &store->playlist;
+            }
+        } else if (is_part(store, file_name)) {
+            for (int i = store->parts_count - 1; i >= 0; i--) {
+                const hls_memory_file_t *file = &store->parts[(store->parts_head + i) % store->max_parts];
+                if (strcmp(file->name, file_name) == 0) {
+                    found = file;
+                    break;
+                }
+            }
+        } else {
+            // Newest first: live clients almost always want the latest segment
+            for (int i = store->count - 1; i >= 0; i--) {
+                const hls_memory_file_t *file = &store->segments[(store->head + i) % store->max_segments];
+                if (strcmp(file->name, file_name) == 0) {
+                    found = file;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Hold the contents by reference and copy them once the lock is released
+    hls_memory_blob_t *blob = found ? found->blob : NULL;
+    if (blob) {
+        atomic_fetch_add(&blob->refs, 1);
+    }
+
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    if (blob) {
+        *data = malloc(blob->size > 0 ? blob->size : 1);
+        if (*data) {
+            memcpy(*data, blob->data, blob->size);
+            *size = blob->size;
+            result = 0;
+        }
+        blob_release(blob);
+    }
+    return result;
+}
+
+int hls_memory_store_enable_parts(const char *stream_name, int max_parts, int target_duration) {
+    if (!stream_name || max_parts <= 0) {
+        return -1;
+    }
+
+    hls_memory_file_t *parts = calloc((size_t)max_parts, sizeof(hls_memory_file_t));
+    if (!parts) {
+        log_error("Failed to allocate HLS part ring for stream %s", stream_name);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_stores_mutex);
+    hls_memory_store_t *store = find_store(stream_name);
+    if (!store || store->max_parts > 0) {
+        pthread_mutex_unlock(&g_stores_mutex);
+        free(parts);
+        return -1;
+    }
+    store->parts = parts;
+    store->max_parts = max_parts;
+    store->target_duration = target_duration;
+    pthread_mutex_unlock(&g_stores_mutex);
+    return 0;
+}
+
+int hls_memory_store_set_position(const char *stream_name, int64_t msn, int parts) {
+    if (!stream_name) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_stores_mutex);
+    hls_memory_store_t *store = find_store(stream_name);
+    if (store) {
+        store->position_msn = msn;
+        store->position_parts = parts;
+    }
+    void (*listener)(void) = g_listener;
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    if (!store) {
+        return -1;
+    }
+
+    // Outside the lock: the listener only wakes the web server's event loop
+    if (listener) {
+        listener();
+    }
+    return 0;
+}
+
+int hls_memory_store_get_position(const char *stream_name, int64_t *msn, int *parts,
+                                  int *target_duration) {
+    if (!stream_name) {
+        return -1;
+    }
+
+    int result = -1;
+    pthread_mutex_lock(&g_stores_mutex);
+    const hls_memory_store_t *store = find_store(stream_name);
+    if (store && store->max_parts > 0 && store->position_msn >= 0) {
+        if (msn) *msn = store->position_msn;
+        if (parts) *parts = store->position_parts;
+        if (target_duration) *target_duration = store->target_duration;
+        result = 0;
+    }
+    pthread_mutex_unlock(&g_stores_mutex);
+    return result;
+}
+
+void hls_memory_store_set_listener(void (*listener)(void)) {
+    pthread_mutex_lock(&g_stores_mutex);
+    g_listener = listener;
+    pthread_mutex_unlock(&g_stores_mutex);
+}
+
+void hls_memory_store_get_usage(int *streams, size_t *bytes) {
+    int count = 0;
+    size_t total = 0;
+
+    pthread_mutex_lock(&g_stores_mutex);
+    for (const hls_memory_store_t *store = g_stores; store; store = store->next) {
+        count++;
+        total += store->bytes;
+    }
+    pthread_mutex_unlock(&g_stores_mutex);
+
+    if (streams) *streams = count;
+    if (bytes) *bytes = total;
+}
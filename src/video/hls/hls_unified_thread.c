@@ -116,6 +116,7 @@ static void global_ffmpeg_cleanup(void) {
 #include "video/streams.h"
 #include "video/hls_writer.h"
 #include "video/stream_protocol.h"
+#include "video/stream_ingest.h"
 #include "video/thread_utils.h"
 #include "video/timestamp_manager.h"
 #include "video/detection_frame_processing.h"
@@ -133,6 +134,10 @@ static void global_ffmpeg_cleanup(void) {
 // Maximum reconnection delay in milliseconds (30 seconds)
 #define MAX_RECONNECT_DELAY_MS 30000
 
+// Packets the HLS writer may fall behind a shared ingest before it skips to
+// the next keyframe
+#define HLS_INGEST_QUEUE_PACKETS 512
+
 // Forward declaration for go2rtc integration
 extern bool go2rtc_integration_is_using_go2rtc_for_hls(const char *stream_name);
 extern bool go2rtc_get_rtsp_url(const char *stream_name, char *url, size_t url_size);
@@ -767,6 +772,30 @@ static int interruptible_sleep_ms(int total_ms, hls_unified_thread_ctx_t *ctx,
     return 0;  // Completed normally
 }
 
+/**
+ * Open the input for a stream
+ *
+ * With shared ingest enabled the camera connection is shared with MP4
+ * recording and detection; otherwise the stream gets its own demuxer.
+ *
+ * @param input_ctx Output format context
+ * @param stream_name The stream name
+ * @param url Source URL
+ * @param protocol STREAM_PROTOCOL_TCP or STREAM_PROTOCOL_UDP
+ * @return 0 on success, negative AVERROR on failure
+ */
+static int open_hls_input(AVFormatContext **input_ctx, const char *stream_name,
+                          const char *url, int protocol) {
+    if (g_config.shared_ingest) {
+        stream_ingest_consumer_config_t ingest_cfg = {
+            .queue_packets = HLS_INGEST_QUEUE_PACKETS,
+            .drop_policy = STREAM_INGEST_DROP_TO_KEYFRAME,
+        };
+        return stream_ingest_open_input(input_ctx, stream_name, url, protocol, &ingest_cfg);
+    }
+    return open_input_stream(input_ctx, url, protocol);
+}
+
 /**
  * Check RTSP connection by sending an OPTIONS request
  *
@@ -1147,7 +1176,7 @@ void *hls_unified_thread_func(void *arg) {
                 // This ensures all previous memory operations are completed
                 __sync_synchronize();
 
-                ret = open_input_stream(&input_ctx, local_rtsp_url, local_protocol);
+                ret = open_hls_input(&input_ctx, stream_name, local_rtsp_url, local_protocol);
                 if (ret < 0) {
                     char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
                     av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
@@ -1367,7 +1396,7 @@ void *hls_unified_thread_func(void *arg) {
                 }
 
                 // Read packet
-                ret = av_read_frame(input_ctx, pkt);
+                ret = stream_ingest_read_frame(input_ctx, pkt);
 
                 if (ret < 0) {
                     // Handle read errors
@@ -1574,7 +1603,7 @@ void *hls_unified_thread_func(void *arg) {
                 // This ensures all previous memory operations are completed
                 __sync_synchronize();
 
-                ret = open_input_stream(&input_ctx, reconnect_rtsp_url, reconnect_protocol);
+                ret = open_hls_input(&input_ctx, stream_name, reconnect_rtsp_url, reconnect_protocol);
                 if (ret < 0) {
                     char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
                     av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
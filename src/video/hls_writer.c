@@ -15,13 +15,16 @@
 #include <signal.h> // For alarm
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
+#include <libavutil/avstring.h>
 #include <libavutil/avutil.h>
 #include <libavutil/time.h>
+#include <libavutil/opt.h>
 
 #include "core/logger.h"
 #include "core/path_utils.h"
 #include "utils/strings.h"
 #include "video/hls/hls_directory.h"
+#include "video/hls/hls_memory_store.h"
 #include "video/hls_writer.h"
 #include "video/detection_integration.h"
 #include "video/detection_frame_processing.h"
@@ -36,114 +39,381 @@ extern int get_detection_interval(const char *stream_name);
 static void register_hls_writer(hls_writer_t *writer);
 static void unregister_hls_writer(hls_writer_t *writer);
 
+// URL scheme for the playlist in memory mode; unknown to FFmpeg, so the HLS
+// muxer doesn't treat it as a local file (see hls_writer_setup_memory_output)
+#define HLS_MEMORY_URL_SCHEME "nvrmem:"
+
+// AVIO buffer between the MPEG-TS muxer and the low-latency part buffer
+#define HLS_LL_IO_BUFFER_SIZE 32768
+
 /**
- * Clean up old HLS segments that are no longer in the playlist
+ * Muxer io_open hook for memory mode: every file the HLS muxer writes
+ * (segments and the playlist) goes into a dynamic buffer instead of a file
  */
-static void cleanup_old_segments(const char *output_dir, int max_segments) {
-    DIR *dir;
-    struct dirent *entry;
-    struct stat st;
-    char filepath[HLS_MAX_PATH_LENGTH];
-
-    // Keep track of segments to delete
-    typedef struct {
-        char filename[256];
-        time_t mtime;
-    } segment_info_t;
-
-    segment_info_t *segments = NULL;
-    int segment_count = 0;
-    int actual_count = 0;
-
-    // Open directory
-    dir = opendir(output_dir);
-    if (!dir) {
-        log_error("Failed to open directory for cleanup: %s", output_dir);
-        return;
+static int hls_memory_io_open(AVFormatContext *s, AVIOContext **pb, const char *url,
+                              int flags, AVDictionary **options) {
+    hls_writer_t *writer = (hls_writer_t *)s->opaque;
+    if (!writer) {
+        return AVERROR(EINVAL);
+    }
+    if (!(flags & AVIO_FLAG_WRITE) || (flags & AVIO_FLAG_READ)) {
+        return writer->default_io_open(s, pb, url, flags, options);
     }
 
-    // Count segment files first
-    while ((entry = readdir(dir)) != NULL) {
-        // Check for both .ts and .m4s files (support both formats)
-        if (strstr(entry->d_name, ".m4s") != NULL || strstr(entry->d_name, ".ts") != NULL) {
-            segment_count++;
+    int slot = -1;
+    for (int i = 0; i < HLS_MEMORY_OPEN_FILES; i++) {
+        if (!writer->memory_files[i].pb) {
+            slot = i;
+            break;
         }
     }
+    if (slot < 0) {
+        log_error("Too many open in-memory HLS files for stream %s", writer->stream_name);
+        return AVERROR(EMFILE);
+    }
 
-    // If we don't have more than the max, no cleanup needed.
-    // Also guard against segment_count == 0 (e.g. when max_segments is negative)
-    // to avoid a calloc(0, ...) call which has implementation-defined behaviour.
-    if (segment_count <= max_segments || segment_count <= 0) {
-        closedir(dir);
-        return;
+    int ret = avio_open_dyn_buf(pb);
+    if (ret < 0) {
+        return ret;
     }
 
-    // Allocate array for segment info with proper alignment
-    // Use calloc instead of malloc to ensure memory is initialized to zero
-    segments = (segment_info_t *)calloc((size_t)segment_count, sizeof(segment_info_t));
-    if (!segments) {
-        log_error("Failed to allocate memory for segment cleanup");
-        closedir(dir);
-        return;
+    const char *name = strrchr(url, '/');
+    name = name ? name + 1 : url;
+    writer->memory_files[slot].pb = *pb;
+    safe_strcpy(writer->memory_files[slot].name, name, sizeof(writer->memory_files[slot].name), 0);
+
+    // The muxer only renames temp files on the file protocol, which memory
+    // mode avoids; should one still arrive, publish it under its final name
+    // since the rename that would follow can't reach the store
+    char *file_name = writer->memory_files[slot].name;
+    size_t len = strlen(file_name);
+    if (len > 4 && strcmp(file_name + len - 4, ".tmp") == 0) {
+        file_name[len - 4] = '\0';
     }
+    return 0;
+}
 
-    // Rewind directory
-    rewinddir(dir);
+/**
+ * Muxer io_close2 hook for memory mode: publish the finished file to the
+ * memory store
+ */
+static int hls_memory_io_close(AVFormatContext *s, AVIOContext *pb) {
+    hls_writer_t *writer = (hls_writer_t *)s->opaque;
+    if (!writer || !pb) {
+        return 0;
+    }
 
-    // Collect segment info
-    int i = 0;
-    while ((entry = readdir(dir)) != NULL && i < segment_count) {
-        // Check for both .ts and .m4s files (support both formats)
-        if (strstr(entry->d_name, ".m4s") == NULL && strstr(entry->d_name, ".ts") == NULL) {
+    for (int i = 0; i < HLS_MEMORY_OPEN_FILES; i++) {
+        if (writer->memory_files[i].pb != pb) {
             continue;
         }
 
-        // Get file stats
-        snprintf(filepath, sizeof(filepath), "%s/%s", output_dir, entry->d_name);
-        if (stat(filepath, &st) == 0) {
-            safe_strcpy(segments[i].filename, entry->d_name, 256, 0);
-            segments[i].mtime = st.st_mtime;
-            i++;
+        uint8_t *buf = NULL;
+        int size = avio_close_dyn_buf(pb, &buf);
+        if (size >= 0 &&
+            hls_memory_store_put(writer->stream_name, writer->memory_files[i].name, buf, (size_t)size) != 0) {
+            log_warn("Failed to store HLS file %s for stream %s in memory",
+                    writer->memory_files[i].name, writer->stream_name);
         }
+        av_free(buf);
+
+        writer->memory_files[i].pb = NULL;
+        writer->memory_files[i].name[0] = '\0';
+        return 0;
     }
 
-    // Store the actual number of segments we found
-    actual_count = i;
+    return writer->default_io_close2 ? writer->default_io_close2(s, pb) : 0;
+}
 
-    closedir(dir);
+/**
+ * Configure the muxer to write into the HLS memory store instead of files
+ */
+static int hls_writer_setup_memory_output(hls_writer_t *writer, const config_t *global_config) {
+    int list_size = global_config->hls_memory_segments + global_config->hls_spill_segments;
 
-    // Sort segments by modification time (oldest first)
-    // Simple bubble sort for now
-    for (int j = 0; j < actual_count - 1; j++) {
-        for (int k = 0; k < actual_count - j - 1; k++) {
-            if (segments[k].mtime > segments[k + 1].mtime) {
-                segment_info_t temp = segments[k];
-                segments[k] = segments[k + 1];
-                segments[k + 1] = temp;
-            }
+    // Same layout as the file-based writer, minus the flags that only make
+    // sense for files: the store trims old segments itself and publishes
+    // each file atomically when the muxer closes it
+    AVDictionary *options = NULL;
+    char hls_time[16];
+    char hls_list_size[16];
+    char segment_format[MAX_PATH_LENGTH + 32];
+    snprintf(hls_time, sizeof(hls_time), "%d", writer->segment_duration);
+    snprintf(hls_list_size, sizeof(hls_list_size), "%d", list_size);
+    snprintf(segment_format, sizeof(segment_format), "%s/segment_%%d.ts", writer->output_dir);
+
+    av_dict_set(&options, "hls_time", hls_time, 0);
+    av_dict_set(&options, "hls_list_size", hls_list_size, 0);
+    av_dict_set(&options, "hls_segment_type", "mpegts", 0);
+    av_dict_set(&options, "hls_flags", "independent_segments+program_date_time", 0);
+    av_dict_set(&options, "start_number", "0", 0);
+    av_dict_set(&options, "avoid_negative_ts", "make_non_negative", 0);
+    av_dict_set(&options, "hls_segment_filename", segment_format, 0);
+
+    int ret = av_opt_set_dict2(writer->output_ctx, &options, AV_OPT_SEARCH_CHILDREN);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
+        log_error("Failed to set in-memory HLS options for stream %s: %s", writer->stream_name, error_buf);
+        return ret;
+    }
+
+    int spill = global_config->hls_spill_segments;
+    if (hls_memory_store_open(writer->stream_name,
+                              global_config->hls_memory_segments + HLS_MEMORY_STORE_SLACK_SEGMENTS,
+                              writer->output_dir,
+                              spill > 0 ? spill + HLS_MEMORY_STORE_SLACK_SEGMENTS : 0) != 0) {
+        return -1;
+    }
+
+    // Without a file:// URL the muxer writes the playlist in place instead of
+    // to index.m3u8.tmp followed by a rename, which has no meaning in memory
+    char *url = av_asprintf(HLS_MEMORY_URL_SCHEME "%s", writer->output_ctx->url);
+    if (!url) {
+        hls_memory_store_close(writer->stream_name);
+        return AVERROR(ENOMEM);
+    }
+    av_free(writer->output_ctx->url);
+    writer->output_ctx->url = url;
+
+    writer->memory_mode = 1;
+    writer->default_io_open = writer->output_ctx->io_open;
+    writer->default_io_close2 = writer->output_ctx->io_close2;
+    writer->output_ctx->opaque = writer;
+    writer->output_ctx->io_open = hls_memory_io_open;
+    writer->output_ctx->io_close2 = hls_memory_io_close;
+
+    log_info("HLS writer for stream %s keeps %d segments in memory (playlist: %d, spilled to disk: %d)",
+            writer->stream_name, global_config->hls_memory_segments, list_size, spill);
+    return 0;
+}
+
+static int hls_byte_buffer_append(hls_byte_buffer_t *buffer, const uint8_t *data, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 65536;
+        while (capacity < buffer->size + size) {
+            capacity *= 2;
+        }
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (!grown) {
+            return -1;
         }
+        buffer->data = grown;
+        buffer->capacity = capacity;
     }
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return 0;
+}
 
-    // Delete oldest segments beyond our limit
-    int to_delete = actual_count - max_segments;
-    if (to_delete > 0 && to_delete <= actual_count) { // Safety check to prevent out-of-bounds access
-        for (int j = 0; j < to_delete && j < actual_count; j++) { // Additional bounds check
-            // Ensure filename is valid before using it
-            if (segments[j].filename[0] != '\0') {
-                snprintf(filepath, sizeof(filepath), "%s/%s", output_dir, segments[j].filename);
-                if (unlink(filepath) == 0) {
-                    log_debug("Deleted old HLS segment: %s", segments[j].filename);
-                } else {
-                    log_warn("Failed to delete old HLS segment: %s (error: %s)",
-                            segments[j].filename, strerror(errno));
-                }
-            }
+/**
+ * AVIO write callback for low-latency mode: the MPEG-TS muxer output
+ * accumulates in the part being built
+ */
+#if defined(FF_API_AVIO_WRITE_NONCONST) && !FF_API_AVIO_WRITE_NONCONST
+static int hls_ll_write(void *opaque, const uint8_t *buf, int buf_size) {
+#else
+static int hls_ll_write(void *opaque, uint8_t *buf, int buf_size) {
+#endif
+    hls_writer_t *writer = (hls_writer_t *)opaque;
+    if (hls_byte_buffer_append(&writer->ll_part, buf, (size_t)buf_size) != 0) {
+        log_error("Failed to grow LL-HLS part buffer for stream %s", writer->stream_name);
+        return AVERROR(ENOMEM);
+    }
+    return buf_size;
+}
+
+/**
+ * Publish the current LL-HLS playlist and wake blocked playlist requests
+ */
+static void hls_ll_publish_playlist(hls_writer_t *writer) {
+    int len = hls_ll_playlist_render(&writer->ll_playlist, writer->ll_playlist_buf,
+                                     writer->ll_playlist_size);
+    if (len < 0) {
+        log_error("LL-HLS playlist for stream %s does not fit in %zu bytes",
+                 writer->stream_name, writer->ll_playlist_size);
+        return;
+    }
+
+    hls_memory_store_put(writer->stream_name, "index.m3u8",
+                         (const unsigned char *)writer->ll_playlist_buf, (size_t)len);
+    hls_memory_store_set_position(writer->stream_name, writer->ll_playlist.current.msn,
+                                  writer->ll_playlist.current.part_count);
+}
+
+/**
+ * Close the part being built at @p dts and, if requested (or the segment is
+ * full), the segment it belongs to
+ */
+static void hls_ll_cut(hls_writer_t *writer, int64_t dts, bool end_segment) {
+    // Drain the muxer so the part holds every packet written before dts
+    av_write_frame(writer->output_ctx, NULL);
+    avio_flush(writer->ll_pb);
+
+    AVRational tb = writer->output_ctx->streams[0]->time_base;
+    double duration = (double)(dts - writer->ll_part_start) * av_q2d(tb);
+    int64_t msn = writer->ll_playlist.current.msn;
+    int index = hls_ll_playlist_add_part(&writer->ll_playlist, duration, writer->ll_part_independent);
+
+    if (index >= 0) {
+        char name[64];
+        snprintf(name, sizeof(name), "part_%lld_%d.ts", (long long)msn, index);
+        if (hls_memory_store_put(writer->stream_name, name, writer->ll_part.data, writer->ll_part.size) != 0 ||
+            hls_byte_buffer_append(&writer->ll_segment, writer->ll_part.data, writer->ll_part.size) != 0) {
+            log_warn("Failed to store LL-HLS part %s for stream %s", name, writer->stream_name);
+        }
+    }
+    writer->ll_part.size = 0;
+    writer->ll_part_start = dts;
+
+    if (end_segment || writer->ll_playlist.current.part_count >= HLS_LL_MAX_PARTS) {
+        char name[64];
+        snprintf(name, sizeof(name), "segment_%lld.ts", (long long)msn);
+        if (hls_memory_store_put(writer->stream_name, name, writer->ll_segment.data, writer->ll_segment.size) != 0) {
+            log_warn("Failed to store LL-HLS segment %s for stream %s", name, writer->stream_name);
+        }
+        writer->ll_segment.size = 0;
+        writer->ll_segment_start = dts;
+        hls_ll_playlist_end_segment(&writer->ll_playlist);
+
+        // Start every segment with PAT/PMT so it can be decoded on its own
+        av_opt_set(writer->output_ctx->priv_data, "mpegts_flags", "+resend_headers", 0);
+    }
+
+    hls_ll_publish_playlist(writer);
+}
+
+/**
+ * Decide where a packet falls in low-latency mode, cutting parts and
+ * segments in front of it as needed
+ *
+ * @return 0 to write the packet, 1 to drop it (waiting for the first keyframe)
+ */
+static int hls_ll_prepare_packet(hls_writer_t *writer, const AVPacket *pkt) {
+    bool key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+
+    if (!writer->ll_started) {
+        if (!key) {
+            return 1;
         }
+        writer->ll_started = 1;
+        writer->ll_segment_start = pkt->dts;
+        writer->ll_part_start = pkt->dts;
+        writer->ll_last_dts = pkt->dts;
+        writer->ll_frame_interval = 0;
+        writer->ll_part_independent = 1;
+        return 0;
+    }
+
+    if (pkt->dts > writer->ll_last_dts) {
+        writer->ll_frame_interval = pkt->dts - writer->ll_last_dts;
+    }
+    writer->ll_last_dts = pkt->dts;
+
+    AVRational tb = writer->output_ctx->streams[0]->time_base;
+    double segment_elapsed = (double)(pkt->dts - writer->ll_segment_start) * av_q2d(tb);
+    double part_elapsed = (double)(pkt->dts - writer->ll_part_start) * av_q2d(tb);
+    double frame = (double)writer->ll_frame_interval * av_q2d(tb);
+
+    if (key && segment_elapsed >= writer->segment_duration) {
+        hls_ll_cut(writer, pkt->dts, true);
+        writer->ll_part_independent = 1;
+    } else if (part_elapsed > 0.0 && part_elapsed + frame > writer->ll_part_target + 0.001) {
+        // Cut before the frame that would push the part past its target,
+        // since no part may be longer than PART-TARGET
+        hls_ll_cut(writer, pkt->dts, false);
+        writer->ll_part_independent = key;
+    } else if (key) {
+        writer->ll_part_independent = 1;
     }
 
-    // Always free the allocated memory
-    free(segments);
-    segments = NULL;
+    return 0;
+}
+
+/**
+ * Configure the writer for low-latency HLS: the output context is a plain
+ * MPEG-TS muxer whose bytes are cut into parts and segments here, because
+ * FFmpeg's HLS muxer cannot produce partial segments
+ */
+static int hls_writer_setup_ll_output(hls_writer_t *writer, const config_t *global_config) {
+    int part_ms = global_config->hls_part_duration_ms;
+    int window = global_config->hls_memory_segments + global_config->hls_spill_segments;
+
+    // The playlist lists parts for three target durations plus the segment
+    // being built; the store keeps one more segment's worth for clients
+    // holding a slightly older playlist
+    int parts_per_segment = (writer->segment_duration * 1000 + part_ms - 1) / part_ms;
+    int max_parts = 4 * parts_per_segment + 1;
+
+    if (hls_ll_playlist_init(&writer->ll_playlist, writer->segment_duration,
+                             part_ms / 1000.0, window, max_parts) != 0) {
+        log_error("Failed to initialize LL-HLS playlist for stream %s", writer->stream_name);
+        return -1;
+    }
+    writer->ll_part_target = part_ms / 1000.0;
+    writer->ll_playlist_size = 1024 + (size_t)window * 64 + (size_t)(max_parts + HLS_LL_MAX_PARTS) * 96;
+    writer->ll_playlist_buf = malloc(writer->ll_playlist_size);
+
+    unsigned char *io_buffer = av_malloc(HLS_LL_IO_BUFFER_SIZE);
+    if (io_buffer) {
+        writer->ll_pb = avio_alloc_context(io_buffer, HLS_LL_IO_BUFFER_SIZE, 1, writer,
+                                           NULL, hls_ll_write, NULL);
+    }
+    if (!writer->ll_playlist_buf || !writer->ll_pb) {
+        log_error("Failed to allocate LL-HLS buffers for stream %s", writer->stream_name);
+        if (writer->ll_pb) {
+            avio_context_free(&writer->ll_pb);
+        }
+        av_free(io_buffer);
+        free(writer->ll_playlist_buf);
+        writer->ll_playlist_buf = NULL;
+        hls_ll_playlist_free(&writer->ll_playlist);
+        return -1;
+    }
+
+    int spill = global_config->hls_spill_segments;
+    if (hls_memory_store_open(writer->stream_name,
+                              global_config->hls_memory_segments + HLS_MEMORY_STORE_SLACK_SEGMENTS,
+                              writer->output_dir,
+                              spill > 0 ? spill + HLS_MEMORY_STORE_SLACK_SEGMENTS : 0) != 0 ||
+        hls_memory_store_enable_parts(writer->stream_name, max_parts + parts_per_segment,
+                                      writer->segment_duration) != 0) {
+        hls_memory_store_close(writer->stream_name);
+        av_free(io_buffer);
+        avio_context_free(&writer->ll_pb);
+        free(writer->ll_playlist_buf);
+        writer->ll_playlist_buf = NULL;
+        hls_ll_playlist_free(&writer->ll_playlist);
+        return -1;
+    }
+
+    writer->memory_mode = 1;
+    writer->low_latency = 1;
+    writer->output_ctx->pb = writer->ll_pb;
+    writer->output_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    log_info("LL-HLS writer for stream %s: %d ms parts, %d segments in playlist",
+            writer->stream_name, part_ms, window);
+    return 0;
+}
+
+/**
+ * Release the low-latency muxer I/O and buffers (the output context must
+ * already be detached from ll_pb)
+ */
+static void hls_ll_free(hls_writer_t *writer) {
+    if (writer->ll_pb) {
+        av_freep(&writer->ll_pb->buffer);
+        avio_context_free(&writer->ll_pb);
+    }
+    free(writer->ll_part.data);
+    free(writer->ll_segment.data);
+    free(writer->ll_playlist_buf);
+    memset(&writer->ll_part, 0, sizeof(writer->ll_part));
+    memset(&writer->ll_segment, 0, sizeof(writer->ll_segment));
+    writer->ll_playlist_buf = NULL;
+    hls_ll_playlist_free(&writer->ll_playlist);
 }
 
 hls_writer_t *hls_writer_create(const char *output_dir, const char *stream_name, int segment_duration) {
@@ -198,9 +468,13 @@ hls_writer_t *hls_writer_create(const char *output_dir, const char *stream_name,
     char output_path[MAX_PATH_LENGTH];
     snprintf(output_path, MAX_PATH_LENGTH, "%s/index.m3u8", writer->output_dir);
 
+    // Low-latency HLS cuts its own parts from a plain MPEG-TS muxer
+    const config_t *global_config = get_streaming_config();
+    bool low_latency = global_config && global_config->hls_memory_store && global_config->hls_low_latency;
+
     // Allocate output format context
     int ret = avformat_alloc_output_context2(
-        &writer->output_ctx, NULL, "hls", output_path);
+        &writer->output_ctx, NULL, low_latency ? "mpegts" : "hls", low_latency ? NULL : output_path);
 
     if (ret < 0) {
         char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
@@ -211,6 +485,25 @@ hls_writer_t *hls_writer_create(const char *output_dir, const char *stream_name,
         return NULL;
     }
 
+    // In-memory mode: nothing is opened on disk; the muxer's file hooks (or
+    // the low-latency part cutter) feed the HLS memory store that the web
+    // server serves from
+    if (global_config && global_config->hls_memory_store) {
+        int setup = low_latency ? hls_writer_setup_ll_output(writer, global_config)
+                                : hls_writer_setup_memory_output(writer, global_config);
+        if (setup != 0) {
+            avformat_free_context(writer->output_ctx);
+            pthread_mutex_destroy(&writer->mutex);
+            free(writer);
+            return NULL;
+        }
+
+        log_info("Created in-memory HLS writer for stream %s with segment duration %d seconds",
+                stream_name, segment_duration);
+        register_hls_writer(writer);
+        return writer;
+    }
+
     // Set HLS options - optimized for stability and compatibility
     AVDictionary *options = NULL;
     char hls_time[16];
@@ -605,6 +898,12 @@ int hls_writer_write_packet(hls_writer_t *writer, const AVPacket *pkt, const AVS
                  writer->stream_name, (long long)out_pkt_ptr->pts, (long long)out_pkt_ptr->dts, out_pkt_ptr->size);
     }
 
+    // Low-latency mode cuts parts and segments in front of this packet
+    if (writer->low_latency && hls_ll_prepare_packet(writer, out_pkt_ptr) != 0) {
+        av_packet_free(&out_pkt_ptr);
+        return 0;
+    }
+
     result = av_interleaved_write_frame(writer->output_ctx, out_pkt_ptr);
 
     // Clean up packet
@@ -772,6 +1071,9 @@ void cleanup_all_hls_writers(void) {
         }
     }
 
+    // Drop any store whose writer was already gone
+    hls_memory_store_close_all();
+
     log_info("Completed cleanup of %d HLS writers", writers_count);
 }
 
@@ -899,7 +1201,8 @@ void hls_writer_close(hls_writer_t *writer) {
         // Check if the context is valid and has streams
         if (local_output_ctx->nb_streams > 0) {
             // Verify all critical pointers are valid
-            if (local_output_ctx->oformat && local_output_ctx->pb) {
+            // The HLS muxer opens its own files; pb is only set up in file mode
+            if (local_output_ctx->oformat && (local_output_ctx->pb || writer->memory_mode)) {
                 // Additional validation of each stream
                 bool all_streams_valid = true;
                 for (unsigned int i = 0; i < local_output_ctx->nb_streams; i++) {
@@ -947,6 +1250,12 @@ void hls_writer_close(hls_writer_t *writer) {
             log_warn("Skipping trailer write for stream %s: invalid context state", stream_name);
         }
 
+        // The low-latency AVIO context is ours, not one avio_open2 created
+        if (writer->low_latency) {
+            local_output_ctx->pb = NULL;
+            hls_ll_free(writer);
+        }
+
         // Close AVIO context if it exists
         if (local_output_ctx->pb) {
             log_info("Closing AVIO context for HLS writer for stream %s", stream_name);
@@ -984,6 +1293,19 @@ void hls_writer_close(hls_writer_t *writer) {
         log_info("Successfully freed format context for HLS writer for stream %s", stream_name);
     }
 
+    // Release anything the muxer left open and drop the stream's memory store
+    if (writer->memory_mode) {
+        for (int i = 0; i < HLS_MEMORY_OPEN_FILES; i++) {
+            if (writer->memory_files[i].pb) {
+                uint8_t *buf = NULL;
+                avio_close_dyn_buf(writer->memory_files[i].pb, &buf);
+                av_free(buf);
+                writer->memory_files[i].pb = NULL;
+            }
+        }
+        hls_memory_store_close(stream_name);
+    }
+
     // Free bitstream filter context if it exists
     if (writer->bsf_ctx) {
         log_info("Freeing bitstream filter context for HLS writer for stream %s", stream_name);
@@ -0,0 +1,569 @@
+/**
+ * Cross-stream inference scheduler for embedded detection models
+ *
+ * Submitting threads put a job on the caller's stack into a small queue and
+ * sleep on done_cond.  Workers take the most urgent runnable job, gather the
+ * other queued jobs for the same model into a batch, run it with the model
+ * slot marked busy, then wake the submitters.  Workers that pick up the same
+ * model at once each run their own instance of it.  A submitter whose job is still
+ * queued at its deadline takes it back out itself, so a slow batch never
+ * makes other streams wait past their deadline.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "video/inference_scheduler.h"
+#include "video/detection.h"
+#include "core/config.h"
+#define LOG_COMPONENT "Inference"
+#include "core/logger.h"
+#include "utils/strings.h"
+
+// Each stream has at most one frame queued
+#define INFERENCE_QUEUE_CAPACITY MAX_STREAMS
+
+#define INFERENCE_MAX_WORKERS 8
+#define INFERENCE_DEFAULT_PRIORITY 5
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE
+} job_state_t;
+
+typedef struct {
+    const inference_request_t *req;
+    detection_result_t *result;
+    int priority;
+    double submit_time;
+    double deadline;
+    job_state_t state;
+    int status;
+} inference_job_t;
+
+typedef struct {
+    bool in_use;
+    bool busy;                      // A worker is running this model
+    char model_path[MAX_PATH_LENGTH];
+    float threshold;
+    detection_model_t model;        // NULL until first loaded
+    double last_used;
+} model_slot_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;       // Queue changed or a model became idle
+    pthread_cond_t done_cond;       // A job finished or was dropped
+
+    bool running;
+    int worker_count;
+    pthread_t workers[INFERENCE_MAX_WORKERS];
+    inference_backend_t backend;
+
+    inference_job_t *queue[INFERENCE_QUEUE_CAPACITY];
+    int queue_len;
+
+    model_slot_t models[INFERENCE_MAX_MODELS];
+    inference_scheduler_stats_t stats;
+} sched;
+
+static pthread_once_t sched_once = PTHREAD_ONCE_INIT;
+
+static const double histogram_bounds[INFERENCE_HISTOGRAM_BUCKETS] = INFERENCE_HISTOGRAM_BOUNDS;
+
+static void init_primitives(void) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&sched.mutex, NULL);
+    pthread_cond_init(&sched.work_cond, &attr);
+    pthread_cond_init(&sched.done_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void histogram_observe(inference_histogram_t *h, double seconds) {
+    for (int i = 0; i < INFERENCE_HISTOGRAM_BUCKETS; i++) {
+        if (seconds <= histogram_bounds[i]) {
+            h->buckets[i]++;
+        }
+    }
+    h->count++;
+    h->sum += seconds;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Default backend: the detection model system                        */
+/* ------------------------------------------------------------------ */
+
+// SOD and RealNet networks only predict one image at a time, so a batch
+// runs back to back on the worker's model instance
+static void default_detect_batch(detection_model_t model, const inference_frame_t *frames, int count,
+                                 detection_result_t *results, int *status) {
+    for (int i = 0; i < count; i++) {
+        status[i] = detect_objects(model, frames[i].data, frames[i].width, frames[i].height,
+                                   frames[i].channels, &results[i]);
+    }
+}
+
+static const inference_backend_t default_backend = {
+    .load = load_detection_model,
+    .unload = unload_detection_model,
+    .detect_batch = default_detect_batch,
+};
+
+/* ------------------------------------------------------------------ */
+/*  Queue and model slots (sched.mutex held)                           */
+/* ------------------------------------------------------------------ */
+
+static bool job_matches_model(const inference_job_t *job, const model_slot_t *slot) {
+    return strcmp(job->req->model_path, slot->model_path) == 0 &&
+           job->req->threshold == slot->threshold;
+}
+
+static bool jobs_share_model(const inference_job_t *a, const inference_job_t *b) {
+    return strcmp(a->req->model_path, b->req->model_path) == 0 &&
+           a->req->threshold == b->req->threshold;
+}
+
+// Higher priority first, then the earlier deadline
+static bool job_more_urgent(const inference_job_t *a, const inference_job_t *b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return a->deadline < b->deadline;
+}
+
+static void queue_remove_at(int index) {
+    memmove(&sched.queue[index], &sched.queue[index + 1],
+            (sched.queue_len - index - 1) * sizeof(sched.queue[0]));
+    sched.queue_len--;
+}
+
+static void queue_remove(const inference_job_t *job) {
+    for (int i = 0; i < sched.queue_len; i++) {
+        if (sched.queue[i] == job) {
+            queue_remove_at(i);
+            return;
+        }
+    }
+}
+
+static void finish_job(inference_job_t *job, int status) {
+    job->state = JOB_DONE;
+    job->status = status;
+}
+
+/**
+ * Find or claim a model instance for a job
+ *
+ * Each worker may need its own instance of a model, so up to worker_count
+ * slots can hold the same (path, threshold).  Returns NULL if the job cannot
+ * run now: every instance of its model is busy and no more may be loaded, or
+ * every slot holds another busy model.  A model evicted to make room is
+ * returned in *evicted for the caller to unload once the mutex is released.
+ */
+static model_slot_t *acquire_model(const inference_job_t *job, detection_model_t *evicted) {
+    int instances = 0;
+    for (int i = 0; i < INFERENCE_MAX_MODELS; i++) {
+        model_slot_t *slot = &sched.models[i];
+        if (slot->in_use && job_matches_model(job, slot)) {
+            if (!slot->busy) {
+                return slot;
+            }
+            instances++;
+        }
+    }
+    if (instances >= sched.worker_count) {
+        return NULL;
+    }
+
+    model_slot_t *victim = NULL;
+    for (int i = 0; i < INFERENCE_MAX_MODELS; i++) {
+        model_slot_t *s = &sched.models[i];
+        if (!s->in_use) {
+            victim = s;
+            break;
+        }
+        if (!s->busy && (!victim || s->last_used < victim->last_used)) {
+            victim = s;
+        }
+    }
+    if (!victim) {
+        return NULL;
+    }
+
+    if (victim->in_use && victim->model) {
+        log_info("Unloading idle model %s to load %s", victim->model_path, job->req->model_path);
+        *evicted = victim->model;
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->in_use = true;
+    safe_strcpy(victim->model_path, job->req->model_path, sizeof(victim->model_path), 0);
+    victim->threshold = job->req->threshold;
+    return victim;
+}
+
+/**
+ * Drop queued jobs past their deadline
+ */
+static void drop_expired(double now) {
+    bool dropped = false;
+    for (int i = 0; i < sched.queue_len;) {
+        inference_job_t *job = sched.queue[i];
+        if (now >= job->deadline) {
+            queue_remove_at(i);
+            finish_job(job, INFERENCE_DROPPED);
+            sched.stats.dropped_deadline++;
+            dropped = true;
+        } else {
+            i++;
+        }
+    }
+    if (dropped) {
+        pthread_cond_broadcast(&sched.done_cond);
+    }
+}
+
+/**
+ * Take the next batch off the queue
+ *
+ * The most urgent job whose model can run now leads the batch; the most
+ * urgent of the remaining jobs for the same model fill it up.
+ *
+ * @return Number of jobs in batch, 0 if nothing can run now
+ */
+static int take_batch(inference_job_t **batch, model_slot_t **slot_out, detection_model_t *evicted) {
+    inference_job_t *skipped[INFERENCE_QUEUE_CAPACITY];
+    int skipped_count = 0;
+    model_slot_t *slot = NULL;
+    int count = 0;
+
+    // Lead job: most urgent with a model that is not busy
+    while (!slot) {
+        int best = -1;
+        for (int i = 0; i < sched.queue_len; i++) {
+            bool is_skipped = false;
+            for (int s = 0; s < skipped_count; s++) {
+                if (skipped[s] == sched.queue[i]) {
+                    is_skipped = true;
+                    break;
+                }
+            }
+            if (!is_skipped && (best < 0 || job_more_urgent(sched.queue[i], sched.queue[best]))) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            return 0;
+        }
+        slot = acquire_model(sched.queue[best], evicted);
+        if (!slot) {
+            skipped[skipped_count++] = sched.queue[best];
+            continue;
+        }
+        batch[count++] = sched.queue[best];
+        queue_remove_at(best);
+    }
+
+    while (count < INFERENCE_MAX_BATCH) {
+        int best = -1;
+        for (int i = 0; i < sched.queue_len; i++) {
+            if (jobs_share_model(sched.queue[i], batch[0]) &&
+                (best < 0 || job_more_urgent(sched.queue[i], sched.queue[best]))) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        batch[count++] = sched.queue[best];
+        queue_remove_at(best);
+    }
+
+    *slot_out = slot;
+    return count;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Workers                                                            */
+/* ------------------------------------------------------------------ */
+
+static void run_batch(model_slot_t *slot, inference_job_t **batch, int count) {
+    inference_frame_t frames[INFERENCE_MAX_BATCH];
+    detection_result_t results[INFERENCE_MAX_BATCH];
+    int status[INFERENCE_MAX_BATCH];
+
+    detection_model_t model = slot->model;
+    if (!model) {
+        model = sched.backend.load(batch[0]->req->model_path, batch[0]->req->threshold);
+        if (model) {
+            log_info("Loaded detection model instance %s", batch[0]->req->model_path);
+        } else {
+            log_warn("Failed to load detection model %s", batch[0]->req->model_path);
+        }
+    }
+
+    double start = monotonic_seconds();
+    if (model) {
+        for (int i = 0; i < count; i++) {
+            frames[i] = batch[i]->req->frame;
+            memset(&results[i], 0, sizeof(results[i]));
+            status[i] = -1;
+        }
+        sched.backend.detect_batch(model, frames, count, results, status);
+    }
+    double end = monotonic_seconds();
+
+    pthread_mutex_lock(&sched.mutex);
+
+    slot->model = model;
+    slot->busy = false;
+    slot->last_used = end;
+
+    if (model) {
+        sched.stats.batches++;
+        sched.stats.batch_sizes[count - 1]++;
+        histogram_observe(&sched.stats.latency, end - start);
+    }
+    for (int i = 0; i < count; i++) {
+        inference_job_t *job = batch[i];
+        histogram_observe(&sched.stats.queue_wait, start - job->submit_time);
+        if (model && status[i] == 0) {
+            *job->result = results[i];
+            finish_job(job, INFERENCE_OK);
+            sched.stats.completed++;
+        } else {
+            finish_job(job, INFERENCE_ERROR);
+            sched.stats.failed++;
+        }
+    }
+
+    pthread_cond_broadcast(&sched.done_cond);
+    // Another worker may have been waiting for this model
+    pthread_cond_broadcast(&sched.work_cond);
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&sched.mutex);
+    while (sched.running) {
+        inference_job_t *batch[INFERENCE_MAX_BATCH];
+        model_slot_t *slot = NULL;
+        detection_model_t evicted = NULL;
+
+        drop_expired(monotonic_seconds());
+        int count = take_batch(batch, &slot, &evicted);
+        if (count == 0) {
+            pthread_cond_wait(&sched.work_cond, &sched.mutex);
+            continue;
+        }
+
+        slot->busy = true;
+        for (int i = 0; i < count; i++) {
+            batch[i]->state = JOB_RUNNING;
+        }
+        pthread_mutex_unlock(&sched.mutex);
+
+        if (evicted) {
+            sched.backend.unload(evicted);
+        }
+        // Returns with the mutex held
+        run_batch(slot, batch, count);
+    }
+    pthread_mutex_unlock(&sched.mutex);
+
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API                                                         */
+/* ------------------------------------------------------------------ */
+
+int inference_scheduler_init(int workers, const inference_backend_t *backend) {
+    pthread_once(&sched_once, init_primitives);
+
+    if (workers <= 0) {
+        workers = 1;
+    }
+    if (workers > INFERENCE_MAX_WORKERS) {
+        workers = INFERENCE_MAX_WORKERS;
+    }
+
+    pthread_mutex_lock(&sched.mutex);
+    if (sched.running || sched.worker_count > 0) {
+        pthread_mutex_unlock(&sched.mutex);
+        return sched.running ? 0 : -1;
+    }
+
+    sched.backend = backend ? *backend : default_backend;
+    sched.queue_len = 0;
+    memset(sched.models, 0, sizeof(sched.models));
+    memset(&sched.stats, 0, sizeof(sched.stats));
+    sched.running = true;
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&sched.workers[i], NULL, worker_main, NULL) != 0) {
+            log_error("Failed to create inference worker %d", i);
+            break;
+        }
+        sched.worker_count++;
+    }
+
+    if (sched.worker_count == 0) {
+        sched.running = false;
+        pthread_mutex_unlock(&sched.mutex);
+        return -1;
+    }
+    pthread_mutex_unlock(&sched.mutex);
+
+    log_info("Inference scheduler started with %d worker(s)", sched.worker_count);
+    return 0;
+}
+
+void inference_scheduler_shutdown(void) {
+    pthread_once(&sched_once, init_primitives);
+
+    pthread_mutex_lock(&sched.mutex);
+    if (!sched.running) {
+        pthread_mutex_unlock(&sched.mutex);
+        return;
+    }
+    sched.running = false;
+
+    for (int i = 0; i < sched.queue_len; i++) {
+        finish_job(sched.queue[i], INFERENCE_ERROR);
+    }
+    sched.queue_len = 0;
+
+    int worker_count = sched.worker_count;
+    pthread_cond_broadcast(&sched.work_cond);
+    pthread_cond_broadcast(&sched.done_cond);
+    pthread_mutex_unlock(&sched.mutex);
+
+    // Workers finish the batch they are running before exiting
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(sched.workers[i], NULL);
+    }
+
+    pthread_mutex_lock(&sched.mutex);
+    sched.worker_count = 0;
+    for (int i = 0; i < INFERENCE_MAX_MODELS; i++) {
+        model_slot_t *slot = &sched.models[i];
+        if (slot->in_use && slot->model) {
+            sched.backend.unload(slot->model);
+        }
+        memset(slot, 0, sizeof(*slot));
+    }
+    pthread_mutex_unlock(&sched.mutex);
+
+    log_info("Inference scheduler stopped");
+}
+
+bool inference_scheduler_is_running(void) {
+    pthread_once(&sched_once, init_primitives);
+
+    pthread_mutex_lock(&sched.mutex);
+    bool running = sched.running;
+    pthread_mutex_unlock(&sched.mutex);
+    return running;
+}
+
+int inference_scheduler_detect(const inference_request_t *req, detection_result_t *result) {
+    if (!req || !result || !req->stream_name || !req->model_path || !req->frame.data) {
+        return INFERENCE_ERROR;
+    }
+
+    pthread_once(&sched_once, init_primitives);
+
+    inference_job_t job = {
+        .req = req,
+        .result = result,
+        .priority = req->priority > 0 ? req->priority : INFERENCE_DEFAULT_PRIORITY,
+        .state = JOB_QUEUED,
+        .status = INFERENCE_ERROR,
+    };
+    job.submit_time = monotonic_seconds();
+    job.deadline = job.submit_time +
+                   (req->deadline_ms > 0 ? req->deadline_ms : INFERENCE_DEFAULT_DEADLINE_MS) / 1000.0;
+
+    pthread_mutex_lock(&sched.mutex);
+    if (!sched.running) {
+        pthread_mutex_unlock(&sched.mutex);
+        return INFERENCE_ERROR;
+    }
+
+    // A newer frame from the same stream replaces the one still waiting
+    for (int i = 0; i < sched.queue_len; i++) {
+        inference_job_t *old = sched.queue[i];
+        if (strcmp(old->req->stream_name, req->stream_name) == 0) {
+            queue_remove_at(i);
+            finish_job(old, INFERENCE_DROPPED);
+            sched.stats.dropped_superseded++;
+            pthread_cond_broadcast(&sched.done_cond);
+            break;
+        }
+    }
+
+    sched.stats.submitted++;
+    if (sched.queue_len >= INFERENCE_QUEUE_CAPACITY) {
+        sched.stats.failed++;
+        pthread_mutex_unlock(&sched.mutex);
+        log_warn("[%s] Inference queue full", req->stream_name);
+        return INFERENCE_ERROR;
+    }
+    sched.queue[sched.queue_len++] = &job;
+    pthread_cond_signal(&sched.work_cond);
+
+    while (job.state != JOB_DONE) {
+        if (job.state == JOB_QUEUED) {
+            if (monotonic_seconds() >= job.deadline) {
+                queue_remove(&job);
+                finish_job(&job, INFERENCE_DROPPED);
+                sched.stats.dropped_deadline++;
+                break;
+            }
+            struct timespec ts;
+            ts.tv_sec = (time_t)job.deadline;
+            ts.tv_nsec = (long)((job.deadline - (double)ts.tv_sec) * 1e9);
+            pthread_cond_timedwait(&sched.done_cond, &sched.mutex, &ts);
+        } else {
+            pthread_cond_wait(&sched.done_cond, &sched.mutex);
+        }
+    }
+    pthread_mutex_unlock(&sched.mutex);
+
+    return job.status;
+}
+
+void inference_scheduler_get_stats(inference_scheduler_stats_t *stats) {
+    if (!stats) {
+        return;
+    }
+
+    pthread_once(&sched_once, init_primitives);
+
+    pthread_mutex_lock(&sched.mutex);
+    *stats = sched.stats;
+    stats->workers = sched.running ? sched.worker_count : 0;
+    stats->queue_depth = sched.queue_len;
+    stats->models_loaded = 0;
+    for (int i = 0; i < INFERENCE_MAX_MODELS; i++) {
+        if (sched.models[i].in_use && sched.models[i].model) {
+            stats->models_loaded++;
+        }
+    }
+    pthread_mutex_unlock(&sched.mutex);
+}
@@ -0,0 +1,362 @@
+/**
+ * Keyframe index sidecar for recordings
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <libavformat/avformat.h>
+
+#include "video/keyframe_index.h"
+#define LOG_COMPONENT "KeyframeIndex"
+#include "core/logger.h"
+
+#define KFI_MAGIC "LKFI"
+#define KFI_HEADER_SIZE 28
+#define KFI_ENTRY_SIZE 24
+
+// A sidecar describing more keyframes than this is treated as corrupt
+#define KFI_MAX_ENTRIES (1 << 20)
+
+struct keyframe_index_recorder {
+    int64_t *wall_ms;
+    int count;
+    int capacity;
+};
+
+/* ---- little-endian helpers ---- */
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_i64(uint8_t *p, int64_t v) {
+    uint64_t u = (uint64_t)v;
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(u >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static int64_t get_i64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return (int64_t)v;
+}
+
+/* ---- recorder ---- */
+
+keyframe_index_recorder_t *keyframe_index_recorder_create(void) {
+    return calloc(1, sizeof(keyframe_index_recorder_t));
+}
+
+void keyframe_index_recorder_add(keyframe_index_recorder_t *rec, int64_t wall_ms) {
+    if (!rec) return;
+
+    if (rec->count == rec->capacity) {
+        int capacity = rec->capacity ? rec->capacity * 2 : 64;
+        int64_t *grown = realloc(rec->wall_ms, (size_t)capacity * sizeof(int64_t));
+        if (!grown) {
+            // Missing keyframes only degrade the wall-clock times to extrapolation
+            return;
+        }
+        rec->wall_ms = grown;
+        rec->capacity = capacity;
+    }
+    rec->wall_ms[rec->count++] = wall_ms;
+}
+
+void keyframe_index_recorder_free(keyframe_index_recorder_t *rec) {
+    if (!rec) return;
+    free(rec->wall_ms);
+    free(rec);
+}
+
+int keyframe_index_recorder_finish(keyframe_index_recorder_t *rec, const char *recording_path) {
+    if (!rec || !recording_path || rec->count == 0) {
+        return -1;
+    }
+
+    AVFormatContext *fmt_ctx = NULL;
+    int ret = avformat_open_input(&fmt_ctx, recording_path, NULL, NULL);
+    if (ret < 0) {
+        log_warn("Cannot open %s to build keyframe index", recording_path);
+        return -1;
+    }
+
+    int result = -1;
+    keyframe_index_t index = {0};
+
+    // The mov demuxer builds the full sample index from the moov atom in
+    // read_header, so stream info probing is not needed here
+    int video_idx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (video_idx < 0) {
+        log_warn("No video stream in %s, skipping keyframe index", recording_path);
+        goto cleanup;
+    }
+
+    AVStream *st = fmt_ctx->streams[video_idx];
+    int nb_entries = avformat_index_get_entries_count(st);
+    if (nb_entries <= 0) {
+        log_warn("No sample index in %s, skipping keyframe index", recording_path);
+        goto cleanup;
+    }
+
+    index.entries = malloc((size_t)nb_entries * sizeof(keyframe_index_entry_t));
+    if (!index.entries) {
+        goto cleanup;
+    }
+    index.tb_num = st->time_base.num;
+    index.tb_den = st->time_base.den;
+
+    for (int i = 0; i < nb_entries; i++) {
+        const AVIndexEntry *ie = avformat_index_get_entry(st, i);
+        if (ie && (ie->flags & AVINDEX_KEYFRAME)) {
+            index.entries[index.count].pts = ie->timestamp;
+            index.entries[index.count].offset = ie->pos;
+            index.count++;
+        }
+    }
+
+    // Media data ends after the last sample of any stream
+    for (unsigned int s = 0; s < fmt_ctx->nb_streams; s++) {
+        int n = avformat_index_get_entries_count(fmt_ctx->streams[s]);
+        const AVIndexEntry *last = n > 0 ? avformat_index_get_entry(fmt_ctx->streams[s], n - 1) : NULL;
+        if (last && last->pos + last->size > index.data_end) {
+            index.data_end = last->pos + last->size;
+        }
+    }
+
+    if (index.count == 0) {
+        log_warn("No keyframes indexed in %s", recording_path);
+        goto cleanup;
+    }
+
+    if (index.count == rec->count) {
+        for (int i = 0; i < index.count; i++) {
+            index.entries[i].wall_ms = rec->wall_ms[i];
+        }
+    } else {
+        log_debug("Keyframe count mismatch for %s (file %d, recorded %d), extrapolating wall times",
+                  recording_path, index.count, rec->count);
+        int64_t first_pts = index.entries[0].pts;
+        for (int i = 0; i < index.count; i++) {
+            int64_t delta_ms = av_rescale_q(index.entries[i].pts - first_pts, st->time_base,
+                                            (AVRational){1, 1000});
+            index.entries[i].wall_ms = rec->wall_ms[0] + delta_ms;
+        }
+    }
+
+    char sidecar[1024];
+    if (keyframe_index_sidecar_path(recording_path, sidecar, sizeof(sidecar)) == 0 &&
+        keyframe_index_save(&index, sidecar) == 0) {
+        log_debug("Wrote keyframe index %s (%d keyframes)", sidecar, index.count);
+        result = 0;
+    }
+
+cleanup:
+    free(index.entries);
+    avformat_close_input(&fmt_ctx);
+    return result;
+}
+
+/* ---- sidecar file ---- */
+
+int keyframe_index_sidecar_path(const char *recording_path, char *path, size_t path_size) {
+    if (!recording_path || !path) return -1;
+    int n = snprintf(path, path_size, "%s%s", recording_path, KEYFRAME_INDEX_EXTENSION);
+    return (n < 0 || (size_t)n >= path_size) ? -1 : 0;
+}
+
+int keyframe_index_save(const keyframe_index_t *index, const char *sidecar_path) {
+    if (!index || !sidecar_path || index->count < 0 || index->count > KFI_MAX_ENTRIES) {
+        return -1;
+    }
+
+    size_t size = KFI_HEADER_SIZE + (size_t)index->count * KFI_ENTRY_SIZE;
+    uint8_t *buf = malloc(size);
+    if (!buf) return -1;
+
+    memcpy(buf, KFI_MAGIC, 4);
+    put_u16(buf + 4, KEYFRAME_INDEX_VERSION);
+    put_u16(buf + 6, 0);
+    put_u32(buf + 8, (uint32_t)index->tb_num);
+    put_u32(buf + 12, (uint32_t)index->tb_den);
+    put_u32(buf + 16, (uint32_t)index->count);
+    put_i64(buf + 20, index->data_end);
+
+    uint8_t *p = buf + KFI_HEADER_SIZE;
+    for (int i = 0; i < index->count; i++, p += KFI_ENTRY_SIZE) {
+        put_i64(p, index->entries[i].pts);
+        put_i64(p + 8, index->entries[i].offset);
+        put_i64(p + 16, index->entries[i].wall_ms);
+    }
+
+    char tmp_path[1100];
+    int n = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", sidecar_path);
+    int result = -1;
+    if (n > 0 && (size_t)n < sizeof(tmp_path)) {
+        FILE *fp = fopen(tmp_path, "wb");
+        if (fp) {
+            bool ok = fwrite(buf, 1, size, fp) == size;
+            ok = (fclose(fp) == 0) && ok;
+            if (ok && rename(tmp_path, sidecar_path) == 0) {
+                result = 0;
+            } else {
+                log_warn("Failed to write keyframe index %s: %s", sidecar_path, strerror(errno));
+                unlink(tmp_path);
+            }
+        } else {
+            log_warn("Failed to create keyframe index %s: %s", tmp_path, strerror(errno));
+        }
+    }
+
+    free(buf);
+    return result;
+}
+
+keyframe_index_t *keyframe_index_load(const char *recording_path) {
+    char sidecar[1024];
+    if (keyframe_index_sidecar_path(recording_path, sidecar, sizeof(sidecar)) != 0) {
+        return NULL;
+    }
+
+    FILE *fp = fopen(sidecar, "rb");
+    if (!fp) {
+        return NULL;
+    }
+
+    keyframe_index_t *index = NULL;
+    uint8_t header[KFI_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), fp) != sizeof(header) ||
+        memcmp(header, KFI_MAGIC, 4) != 0 ||
+        get_u16(header + 4) != KEYFRAME_INDEX_VERSION) {
+        log_warn("Ignoring invalid keyframe index %s", sidecar);
+        goto done;
+    }
+
+    uint32_t count = get_u32(header + 16);
+    int tb_num = (int)get_u32(header + 8);
+    int tb_den = (int)get_u32(header + 12);
+    if (count > KFI_MAX_ENTRIES || tb_num <= 0 || tb_den <= 0) {
+        log_warn("Ignoring invalid keyframe index %s", sidecar);
+        goto done;
+    }
+
+    size_t body_size = (size_t)count * KFI_ENTRY_SIZE;
+    uint8_t *body = malloc(body_size ? body_size : 1);
+    index = calloc(1, sizeof(*index));
+    keyframe_index_entry_t *entries = calloc(count ? count : 1, sizeof(*entries));
+    if (!body || !index || !entries || fread(body, 1, body_size, fp) != body_size) {
+        free(body);
+        free(entries);
+        free(index);
+        index = NULL;
+        goto done;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *p = body + (size_t)i * KFI_ENTRY_SIZE;
+        entries[i].pts = get_i64(p);
+        entries[i].offset = get_i64(p + 8);
+        entries[i].wall_ms = get_i64(p + 16);
+    }
+    free(body);
+
+    index->tb_num = tb_num;
+    index->tb_den = tb_den;
+    index->data_end = get_i64(header + 20);
+    index->count = (int)count;
+    index->entries = entries;
+
+done:
+    fclose(fp);
+    return index;
+}
+
+void keyframe_index_free(keyframe_index_t *index) {
+    if (!index) return;
+    free(index->entries);
+    free(index);
+}
+
+void keyframe_index_delete(const char *recording_path) {
+    char sidecar[1024];
+    if (keyframe_index_sidecar_path(recording_path, sidecar, sizeof(sidecar)) != 0) {
+        return;
+    }
+    if (unlink(sidecar) != 0 && errno != ENOENT) {
+        log_warn("Failed to delete keyframe index %s: %s", sidecar, strerror(errno));
+    }
+}
+
+/* ---- lookups ---- */
+
+static void fill_range(const keyframe_index_t *index, int i, keyframe_gop_range_t *range) {
+    const keyframe_index_entry_t *e = &index->entries[i];
+    int64_t end = i + 1 < index->count ? index->entries[i + 1].offset : index->data_end;
+    if (end < e->offset) {
+        // Samples are not stored in timestamp order; fall back to the end of the data
+        end = index->data_end > e->offset ? index->data_end : e->offset;
+    }
+
+    range->offset = e->offset;
+    range->length = end - e->offset;
+    range->pts = e->pts;
+    range->media_seconds = (double)(e->pts - index->entries[0].pts) * index->tb_num / index->tb_den;
+    range->wall_ms = e->wall_ms;
+}
+
+int keyframe_index_find_gop(const keyframe_index_t *index, int64_t wall_ms,
+                            keyframe_gop_range_t *range) {
+    if (!index || !range || index->count <= 0) return -1;
+
+    // Last keyframe at or before wall_ms
+    int lo = 0, hi = index->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (index->entries[mid].wall_ms <= wall_ms) lo = mid;
+        else hi = mid - 1;
+    }
+
+    fill_range(index, lo, range);
+    return 0;
+}
+
+int keyframe_index_find_gop_at(const keyframe_index_t *index, double media_seconds,
+                               keyframe_gop_range_t *range) {
+    if (!index || !range || index->count <= 0) return -1;
+
+    int64_t target = index->entries[0].pts +
+                     (int64_t)(media_seconds * index->tb_den / index->tb_num);
+
+    int lo = 0, hi = index->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (index->entries[mid].pts <= target) lo = mid;
+        else hi = mid - 1;
+    }
+
+    fill_range(index, lo, range);
+    return 0;
+}
@@ -16,6 +16,7 @@
 
 #include "core/logger.h"
 #include "video/motion_detection.h"
+#include "video/motion_kernels.h"
 #include "video/streams.h"
 #include "video/detection_result.h"
 #include "video/zone_filter.h"
@@ -28,13 +29,13 @@
 #define DEFAULT_COOLDOWN_TIME 3
 #define DEFAULT_MOTION_HISTORY 2         // Reduced from 3 to save memory
 #define DEFAULT_BLUR_RADIUS 1            // Radius for simple box blur
+#define MAX_BLUR_RADIUS 15               // Running-sum blur cost does not grow with radius
 #define DEFAULT_NOISE_THRESHOLD 10       // Noise filtering threshold
 #define DEFAULT_USE_GRID_DETECTION true  // Use grid-based detection
 #define DEFAULT_GRID_SIZE 6              // Reduced from 8 to 6 for performance
 #define DEFAULT_DOWNSCALE_ENABLED true   // Enable downscaling for embedded devices
 #define DEFAULT_DOWNSCALE_FACTOR 2       // Downscale factor (2 = half size)
 #define MOTION_LABEL "motion"
-#define EMBEDDED_DEVICE_OPTIMIZATION 1   // Enable embedded device optimizations
 
 // Structure to store frame data for temporal filtering
 typedef struct {
@@ -42,6 +43,24 @@ typedef struct {
     time_t timestamp;
 } frame_history_t;
 
+// Per-stream scratch buffers reused across frames
+//
+// Carved out of a single allocation that is sized from the input geometry and
+// downscale factor, and only reallocated when either changes.
+typedef struct {
+    unsigned char *base;                 // Backing allocation for every buffer below
+    size_t size;                         // Bytes allocated at base
+    int input_width;                     // Input geometry the arena was sized for
+    int input_height;
+    int factor;                          // Downscale factor the arena was sized for
+    bool has_gray;                       // Whether a full-resolution gray buffer is included
+    unsigned char *gray;                 // Full-resolution grayscale (RGB input with downscaling)
+    unsigned char *processing;           // Processing-resolution frame
+    unsigned char *blur_tmp;             // Intermediate pass of the box blur
+    unsigned char *diff_row;             // One row of sampled differences for grid scoring
+    uint32_t *integral;                  // Integral image of sampled differences
+} motion_scratch_t;
+
 // Structure to store previous frame data for a stream
 typedef struct {
     char stream_name[MAX_STREAM_NAME];
@@ -69,6 +88,7 @@ typedef struct {
     int downscale_factor;                // Factor by which to downscale (2 = half size)
     int downscaled_width;                // Width after downscaling
     int downscaled_height;               // Height after downscaling
+    motion_scratch_t scratch;            // Per-frame working buffers
     
     // Performance monitoring
     size_t allocated_memory;             // Total allocated memory in bytes
@@ -131,6 +151,9 @@ void free_motion_stream(motion_stream_t* stream) {
         stream->grid_scores = NULL;
     }
 
+    free(stream->scratch.base);
+    memset(&stream->scratch, 0, sizeof(stream->scratch));
+
     if (stream->frame_history) {
         for (int j = 0; j < stream->history_size; j++) {
             if (stream->frame_history[j].frame) {
@@ -149,17 +172,19 @@ void free_motion_stream(motion_stream_t* stream) {
 }
 
 // Forward declarations for helper functions
-static void apply_box_blur(const unsigned char *src, unsigned char *dst, int width, int height, int radius);
+static void apply_box_blur(const unsigned char *src, unsigned char *dst, unsigned char *tmp,
+                           int width, int height, int radius);
 static void update_background_model(unsigned char *background, const unsigned char *current,
                                     int width, int height, float learning_rate);
 static float calculate_grid_motion(const unsigned char *curr_frame, const unsigned char *prev_frame,
                                   const unsigned char *background, int width, int height,
                                   float sensitivity, int noise_threshold, int grid_size,
                                   float *grid_scores, float *motion_area,
-                                  const bool *zone_mask);
-static unsigned char *rgb_to_grayscale(const unsigned char *rgb_data, int width, int height);
-static unsigned char *downscale_grayscale(const unsigned char *src, int width, int height, int factor, 
-                                         int *out_width, int *out_height);
+                                  const bool *zone_mask, const motion_scratch_t *scratch);
+static void processing_size(int width, int height, int factor, int *out_width, int *out_height);
+static int ensure_scratch_arena(motion_stream_t *stream, int width, int height, int factor, bool need_gray);
+static void downscale_luma(const unsigned char *luma, int stride, int width, int height,
+                           int factor, bool full_range, unsigned char *dst, int dst_width, int dst_height);
 
 /**
  * Initialize the motion detection system - optimized for embedded devices
@@ -178,7 +203,7 @@ int init_motion_detection_system(void) {
     initialized = true;
     pthread_mutex_unlock(&motion_streams_mutex);
 
-    log_info("Motion detection system initialized with embedded device optimizations");
+    log_info("Motion detection system initialized (pixel kernels: %s)", motion_kernels_get()->name);
     return 0;
 }
 
@@ -327,7 +352,7 @@ int configure_advanced_motion_detection(const char *stream_name, int blur_radius
     int old_history_size = stream->history_size;
 
     // Validate and set parameters
-    stream->blur_radius = (blur_radius >= 0 && blur_radius <= 5) ?
+    stream->blur_radius = (blur_radius >= 0 && blur_radius <= MAX_BLUR_RADIUS) ?
                            blur_radius : DEFAULT_BLUR_RADIUS;
 
     stream->noise_threshold = (noise_threshold >= 0 && noise_threshold <= 50) ?
@@ -395,12 +420,8 @@ int configure_motion_detection_optimizations(const char *stream_name, bool downs
 
     // If dimensions are already set, update downscaled dimensions
     if (stream->width > 0 && stream->height > 0) {
-        stream->downscaled_width = stream->width / stream->downscale_factor;
-        stream->downscaled_height = stream->height / stream->downscale_factor;
-        
-        // Ensure minimum size
-        if (stream->downscaled_width < 32) stream->downscaled_width = 32;
-        if (stream->downscaled_height < 32) stream->downscaled_height = 32;
+        processing_size(stream->width, stream->height, stream->downscale_factor,
+                        &stream->downscaled_width, &stream->downscaled_height);
     }
 
     pthread_mutex_unlock(&stream->mutex);
@@ -499,238 +520,128 @@ bool is_motion_detection_enabled(const char *stream_name) {
 }
 
 /**
- * Convert RGB frame to grayscale - optimized for embedded devices
+ * Compute the processing resolution for an input frame
+ *
+ * Both the RGB and luma paths use this so they produce identically sized
+ * processing frames.  A minimum of 32x32 applies only when downscaling.
  */
-static unsigned char *rgb_to_grayscale(const unsigned char *rgb_data, int width, int height) {
-    unsigned char *gray_data = (unsigned char *)malloc((size_t)width * height);
-    if (!gray_data) {
-        log_error("Failed to allocate memory for grayscale conversion");
-        return NULL;
-    }
-
-    #if EMBEDDED_DEVICE_OPTIMIZATION
-    // Use integer arithmetic for faster conversion
-    // Pre-compute fixed-point coefficients (8-bit fraction)
-    const int r_coeff = (int)(0.299f * 256);
-    const int g_coeff = (int)(0.587f * 256);
-    const int b_coeff = (int)(0.114f * 256);
-    
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int rgb_idx = (y * width + x) * 3;
-            int gray_idx = y * width + x;
-
-            // Convert RGB to grayscale using integer arithmetic
-            int gray_value = (r_coeff * rgb_data[rgb_idx] + 
-                             g_coeff * rgb_data[rgb_idx + 1] + 
-                             b_coeff * rgb_data[rgb_idx + 2]) >> 8;
-                             
-            // Clamp to 0-255 range
-            if (gray_value > 255) gray_value = 255;
-            
-            gray_data[gray_idx] = (unsigned char)gray_value;
-        }
-    }
-    #else
-    // Original implementation for non-embedded devices
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int rgb_idx = (y * width + x) * 3;
-            int gray_idx = y * width + x;
-
-            // Convert RGB to grayscale using standard luminance formula
-            gray_data[gray_idx] = (unsigned char)(
-                0.299f * rgb_data[rgb_idx] +      // R
-                0.587f * rgb_data[rgb_idx + 1] +  // G
-                0.114f * rgb_data[rgb_idx + 2]    // B
-            );
-        }
-    }
-    #endif
-
-    return gray_data;
-}
-
-/**
- * Downscale a grayscale image for faster processing
- */
-static unsigned char *downscale_grayscale(const unsigned char *src, int width, int height, int factor, 
-                                         int *out_width, int *out_height) {
+static void processing_size(int width, int height, int factor, int *out_width, int *out_height) {
     if (factor <= 1) {
-        // No downscaling needed
-        unsigned char *copy = (unsigned char *)malloc((size_t)width * height);
-        if (!copy) {
-            log_error("Failed to allocate memory for image copy");
-            return NULL;
-        }
-        memcpy(copy, src, (size_t)width * height);
         *out_width = width;
         *out_height = height;
-        return copy;
+        return;
     }
-    
-    // Calculate new dimensions
+
     int new_width = width / factor;
     int new_height = height / factor;
-    
+
     // Ensure minimum size
     if (new_width < 32) new_width = 32;
     if (new_height < 32) new_height = 32;
-    
-    // Allocate memory for downscaled image
-    unsigned char *dst = (unsigned char *)malloc((size_t)new_width * new_height);
-    if (!dst) {
-        log_error("Failed to allocate memory for downscaled image");
-        return NULL;
-    }
-    
-    // Perform downscaling by averaging blocks of pixels
-    for (int y = 0; y < new_height; y++) {
-        for (int x = 0; x < new_width; x++) {
-            int sum = 0;
-            int count = 0;
-            
-            // Average the pixels in the block
-            for (int dy = 0; dy < factor && (y * factor + dy) < height; dy++) {
-                for (int dx = 0; dx < factor && (x * factor + dx) < width; dx++) {
-                    sum += src[(y * factor + dy) * width + (x * factor + dx)];
-                    count++;
-                }
-            }
-            
-            // Store the average (guard against divide-by-zero if no pixels in block)
-            dst[y * new_width + x] = (count > 0) ? (unsigned char)(sum / count) : 0;
-        }
-    }
-    
+
     *out_width = new_width;
     *out_height = new_height;
-    return dst;
 }
 
+// Scratch buffers start on cache-line boundaries
+#define SCRATCH_ALIGN 64
+#define SCRATCH_ROUND(n) (((n) + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1))
+
 /**
- * Apply a fast box blur to reduce noise - optimized for embedded devices
+ * Make sure the stream's scratch arena fits the given input geometry
+ *
+ * The arena is reallocated only when the input size, downscale factor or need
+ * for a full-resolution gray buffer changes; otherwise this is a no-op.  Must
+ * be called with stream->mutex held.
+ *
+ * @return 0 on success, -1 if the arena could not be allocated
  */
-static void apply_box_blur(const unsigned char *src, unsigned char *dst, int width, int height, int radius) {
-    // Skip if radius is 0
-    if (radius <= 0) {
-        memcpy(dst, src, (size_t)width * height);
-        return;
-    }
+static int ensure_scratch_arena(motion_stream_t *stream, int width, int height, int factor, bool need_gray) {
+    motion_scratch_t *scratch = &stream->scratch;
 
-    // For embedded devices, use a faster approximation with reduced radius
-    #if EMBEDDED_DEVICE_OPTIMIZATION
-    // Use a simplified blur for embedded devices - horizontal and vertical passes
-    // Horizontal pass
-    for (int y = 0; y < height; y++) {
-        int row_offset = y * width;
-        
-        // Initialize sliding window sum for the row
-        int sum = 0;
-        int count = 0;
-        
-        // Initialize the sum with the first radius+1 pixels
-        for (int i = 0; i <= radius && i < width; i++) {
-            sum += src[row_offset + i];
-            count++;
-        }
-        
-        // Process first pixel
-        dst[row_offset] = (unsigned char)(sum / count);
-        
-        // Slide the window for the rest of the row
-        for (int x = 1; x < width; x++) {
-            // Add new pixel to the right
-            if (x + radius < width) {
-                sum += src[row_offset + x + radius]; // NOLINT(clang-analyzer-security.ArrayBound)
-                count++;
-            }
-            
-            // Remove pixel from the left
-            if (x - radius - 1 >= 0) {
-                sum -= src[row_offset + x - radius - 1];
-                count--;
-            }
-            
-            dst[row_offset + x] = (unsigned char)(sum / count);
-        }
-    }
-    
-    // Vertical pass (using dst as source and writing back to dst)
-    unsigned char *temp = (unsigned char *)malloc((size_t)width * height);
-    if (!temp) {
-        // If memory allocation fails, just return the horizontal blur
-        return;
+    if (scratch->base && scratch->input_width == width && scratch->input_height == height &&
+        scratch->factor == factor && scratch->has_gray == need_gray) {
+        return 0;
     }
 
-    memcpy(temp, dst, (size_t)width * height);
-    
-    for (int x = 0; x < width; x++) {
-        // Initialize sliding window sum for the column
-        int sum = 0;
-        int count = 0;
-        
-        // Initialize the sum with the first radius+1 pixels
-        for (int i = 0; i <= radius && i < height; i++) {
-            sum += temp[i * width + x];
-            count++;
-        }
-        
-        // Process first pixel
-        dst[x] = (unsigned char)(sum / count);
-        
-        // Slide the window for the rest of the column
-        for (int y = 1; y < height; y++) {
-            // Add new pixel below
-            if (y + radius < height) {
-                sum += temp[(y + radius) * width + x]; // NOLINT(clang-analyzer-security.ArrayBound)
-                count++;
-            }
-            
-            // Remove pixel from above
-            if (y - radius - 1 >= 0) {
-                sum -= temp[(y - radius - 1) * width + x];
-                count--;
-            }
-            
-            dst[y * width + x] = (unsigned char)(sum / count);
-        }
+    int pw = 0;
+    int ph = 0;
+    processing_size(width, height, factor, &pw, &ph);
+
+    size_t frame_bytes = SCRATCH_ROUND((size_t)pw * ph);
+    size_t sample_width = (size_t)(pw + 1) / 2;
+    size_t sample_height = (size_t)(ph + 1) / 2;
+    size_t diff_row_bytes = SCRATCH_ROUND(sample_width);
+    size_t integral_bytes = SCRATCH_ROUND((sample_width + 1) * (sample_height + 1) * sizeof(uint32_t));
+    size_t gray_bytes = need_gray ? SCRATCH_ROUND((size_t)width * height) : 0;
+    size_t total = 2 * frame_bytes + diff_row_bytes + integral_bytes + gray_bytes;
+
+    unsigned char *base = NULL;
+    if (posix_memalign((void **)&base, SCRATCH_ALIGN, total) != 0) {
+        log_error("[%s] Failed to allocate %zu byte motion scratch arena", stream->stream_name, total);
+        return -1;
     }
-    
-    free(temp);
-    temp = NULL;  // Set to NULL after freeing to prevent use-after-free
-    #else
-    // Original implementation for non-embedded devices
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int sum = 0;
-            int count = 0;
-
-            // Calculate average of pixels in the radius
-            for (int dy = -radius; dy <= radius; dy++) {
-                for (int dx = -radius; dx <= radius; dx++) {
-                    int nx = x + dx;
-                    int ny = y + dy;
-
-                    // Skip out of bounds pixels
-                    if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
-                        continue;
-                    }
 
-                    sum += src[ny * width + nx];
-                    count++;
-                }
-            }
+    free(scratch->base);
+
+    unsigned char *p = base;
+    scratch->processing = p;  p += frame_bytes;
+    scratch->blur_tmp = p;    p += frame_bytes;
+    scratch->integral = (uint32_t *)p;  p += integral_bytes;
+    scratch->diff_row = p;    p += diff_row_bytes;
+    scratch->gray = need_gray ? p : NULL;
+
+    scratch->base = base;
+    scratch->size = total;
+    scratch->input_width = width;
+    scratch->input_height = height;
+    scratch->factor = factor;
+    scratch->has_gray = need_gray;
+
+    log_debug("[%s] Motion scratch arena sized for %dx%d input (factor %d): %zu bytes",
+              stream->stream_name, width, height, factor, total);
+    return 0;
+}
+
+/**
+ * Downscale a luma (Y) plane straight out of a decoded frame
+ *
+ * Reads the plane through its stride and block-averages while reading, so no
+ * full-resolution copy is ever made.  dst must be sized with processing_size().
+ * Limited-range (16-235) luma is expanded to full range so sensitivity and
+ * noise thresholds behave the same as for RGB input.
+ */
+static void downscale_luma(const unsigned char *luma, int stride, int width, int height,
+                           int factor, bool full_range, unsigned char *dst, int dst_width, int dst_height) {
+    motion_kernels_get()->downscale(luma, stride, width, height, factor, dst, dst_width, dst_height);
+
+    // Expand limited-range (16-235) luma to full range: (y - 16) * 255 / 219
+    if (!full_range) {
+        unsigned char range_lut[256];
+        for (int i = 0; i < 256; i++) {
+            int v = ((i - 16) * 255 + 109) / 219;
+            range_lut[i] = (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
 
-            // Set pixel to average value
-            dst[y * width + x] = (unsigned char)(sum / count);
+        size_t count = (size_t)dst_width * dst_height;
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = range_lut[dst[i]];
         }
     }
-    #endif
 }
 
 /**
- * Update the background model using running average - optimized for embedded devices
+ * Apply a separable box blur to reduce noise
+ *
+ * tmp must hold width*height bytes.
+ */
+static void apply_box_blur(const unsigned char *src, unsigned char *dst, unsigned char *tmp,
+                           int width, int height, int radius) {
+    motion_kernels_get()->box_blur(src, dst, tmp, width, height, radius);
+}
+
+/**
+ * Update the background model using running average
  */
 static void update_background_model(unsigned char *background, const unsigned char *current,
                                     int width, int height, float learning_rate) {
@@ -738,29 +649,21 @@ static void update_background_model(unsigned char *background, const unsigned ch
         return;
     }
 
-    #if EMBEDDED_DEVICE_OPTIMIZATION
-    // For embedded devices, use integer arithmetic for speed
-    // Convert learning_rate to fixed-point (8-bit fraction)
+    // background = (1-alpha) * background + alpha * current, alpha in 8-bit fixed point
     int alpha = (int)(learning_rate * 256);
-    int inv_alpha = 256 - alpha;
-    
-    for (int i = 0; i < width * height; i++) {
-        // background = (1-alpha) * background + alpha * current
-        // Using fixed-point arithmetic (8-bit fraction)
-        background[i] = (unsigned char)((inv_alpha * background[i] + alpha * current[i]) >> 8);
-    }
-    #else
-    // Original implementation for non-embedded devices
-    for (int i = 0; i < width * height; i++) {
-        // background = (1-alpha) * background + alpha * current
-        background[i] = (unsigned char)((1.0f - learning_rate) * background[i] +
-                                       learning_rate * current[i]);
-    }
-    #endif
+    if (alpha < 0) alpha = 0;
+    if (alpha > 256) alpha = 256;
+
+    motion_kernels_get()->update_background(background, current, width * height, alpha);
 }
 
 /**
- * Calculate motion using grid-based approach - optimized for embedded devices
+ * Calculate motion using grid-based approach
+ *
+ * Thresholded differences are sampled on every other pixel in both dimensions
+ * and accumulated into a single integral image, so each cell's sum is four
+ * lookups and the cost no longer depends on grid_size.
+ *
  * @param zone_mask  Optional boolean mask (grid_size*grid_size).  If non-NULL,
  *                   cells where zone_mask[idx]==false are skipped entirely.
  *                   When NULL, all cells are processed.
@@ -769,8 +672,9 @@ static float calculate_grid_motion(const unsigned char *curr_frame, const unsign
                                   const unsigned char *background, int width, int height,
                                   float sensitivity, int noise_threshold, int grid_size,
                                   float *grid_scores, float *motion_area,
-                                  const bool *zone_mask) {
-    if (!curr_frame || !prev_frame || !background || !grid_scores || !motion_area) {
+                                  const bool *zone_mask, const motion_scratch_t *scratch) {
+    if (!curr_frame || !prev_frame || !background || !grid_scores || !motion_area ||
+        !scratch || !scratch->integral || !scratch->diff_row) {
         return 0.0f;
     }
 
@@ -780,80 +684,39 @@ static float calculate_grid_motion(const unsigned char *curr_frame, const unsign
     int cells_with_motion = 0;
     float max_cell_score = 0.0f;
 
-    #if EMBEDDED_DEVICE_OPTIMIZATION
-    // Convert sensitivity to fixed-point for faster comparison
+    // A pixel counts when its difference exceeds both the noise threshold and
+    // the sensitivity threshold (sensitivity in fixed-point 0-255)
     int sensitivity_threshold = (int)(sensitivity * 255.0f);
-
-    // Calculate motion for each grid cell
-    for (int gy = 0; gy < grid_size; gy++) {
-        for (int gx = 0; gx < grid_size; gx++) {
-            int cell_idx = gy * grid_size + gx;
-
-            // Skip cells outside configured zones
-            if (zone_mask && !zone_mask[cell_idx]) {
-                grid_scores[cell_idx] = 0.0f;
-                continue;
-            }
-            total_cells++;
-
-            int cell_start_x = gx * cell_width;
-            int cell_start_y = gy * cell_height;
-            int cell_end_x = (gx + 1) * cell_width;
-            int cell_end_y = (gy + 1) * cell_height;
-
-            // Ensure we don't go out of bounds
-            if (cell_end_x > width) cell_end_x = width;
-            if (cell_end_y > height) cell_end_y = height;
-
-            int cell_pixels = 0;
-            int changed_pixels = 0;
-            int total_diff = 0;
-
-            // Process each pixel in the cell - use sampling for better performance
-            // Sample every other pixel in both dimensions
-            for (int y = cell_start_y; y < cell_end_y; y += 2) {
-                for (int x = cell_start_x; x < cell_end_x; x += 2) {
-                    int idx = y * width + x;
-
-                    // Calculate differences from previous frame and background
-                    int frame_diff = abs((int)curr_frame[idx] - (int)prev_frame[idx]);
-                    int bg_diff = abs((int)curr_frame[idx] - (int)background[idx]);
-
-                    // Use the larger of the two differences
-                    int diff = (frame_diff > bg_diff) ? frame_diff : bg_diff;
-
-                    // Apply noise threshold
-                    if (diff > noise_threshold) {
-                        // Pixel difference exceeds sensitivity threshold
-                        if (diff > sensitivity_threshold) {
-                            changed_pixels++;
-                            total_diff += diff;
-                        }
-                    }
-
-                    cell_pixels++;
-                }
-            }
-
-            // Calculate cell motion score
-            float cell_score = (cell_pixels > 0)
-                ? (float)total_diff / (float)(cell_pixels * 255)
-                : 0.0f;
-
-            // Store cell score
-            grid_scores[cell_idx] = cell_score;
-
-            // Track overall motion
-            if (cell_score > 0.01f) {  // Cell has meaningful motion
-                cells_with_motion++;
-                if (cell_score > max_cell_score) {
-                    max_cell_score = cell_score;
-                }
-            }
+    int diff_threshold = (noise_threshold > sensitivity_threshold) ? noise_threshold : sensitivity_threshold;
+    const motion_kernels_t *kernels = motion_kernels_get();
+
+    // Sampled lattice: pixel (2i, 2j) maps to sample (i, j)
+    int sample_width = (width + 1) / 2;
+    int sample_height = (height + 1) / 2;
+    int integral_stride = sample_width + 1;
+    uint32_t *integral = scratch->integral;
+    unsigned char *diff_row = scratch->diff_row;
+
+    // Top row of the integral image is all zeros; every other row starts with one
+    memset(integral, 0, (size_t)integral_stride * sizeof(uint32_t));
+
+    // integral[(j+1)*stride + (i+1)] = sum of samples in [0, i] x [0, j]
+    for (int j = 0; j < sample_height; j++) {
+        size_t row = (size_t)(2 * j) * width;
+        kernels->diff_row(curr_frame + row, prev_frame + row, background + row,
+                          width, diff_threshold, diff_row);
+
+        const uint32_t *above = integral + (size_t)j * integral_stride;
+        uint32_t *out = integral + (size_t)(j + 1) * integral_stride;
+        uint32_t row_sum = 0;
+        out[0] = 0;
+        for (int i = 0; i < sample_width; i++) {
+            row_sum += diff_row[i];
+            out[i + 1] = above[i + 1] + row_sum;
         }
     }
-    #else
-    // Original implementation for non-embedded devices
+
+    // Calculate motion for each grid cell
     for (int gy = 0; gy < grid_size; gy++) {
         for (int gx = 0; gx < grid_size; gx++) {
             int cell_idx = gy * grid_size + gx;
@@ -874,43 +737,22 @@ static float calculate_grid_motion(const unsigned char *curr_frame, const unsign
             if (cell_end_x > width) cell_end_x = width;
             if (cell_end_y > height) cell_end_y = height;
 
-            int cell_pixels = 0;
-            int changed_pixels = 0;
-            int total_diff = 0;
-
-            // Process each pixel in the cell
-            for (int y = cell_start_y; y < cell_end_y; y++) {
-                for (int x = cell_start_x; x < cell_end_x; x++) {
-                    int idx = y * width + x;
-
-                    // Calculate differences from previous frame and background
-                    int frame_diff = abs((int)curr_frame[idx] - (int)prev_frame[idx]);
-                    int bg_diff = abs((int)curr_frame[idx] - (int)background[idx]);
-
-                    // Use the larger of the two differences
-                    int diff = (frame_diff > bg_diff) ? frame_diff : bg_diff;
-
-                    // Apply noise threshold
-                    if (diff > noise_threshold) {
-                        // Pixel difference exceeds sensitivity threshold
-                        if (diff > (sensitivity * 255.0f)) {
-                            changed_pixels++;
-                            total_diff += diff;
-                        }
-                    }
+            // Samples whose pixel falls in [start, end) on each axis
+            int sx0 = (cell_start_x + 1) / 2;
+            int sx1 = (cell_end_x + 1) / 2;
+            int sy0 = (cell_start_y + 1) / 2;
+            int sy1 = (cell_end_y + 1) / 2;
+            int cell_pixels = (sx1 - sx0) * (sy1 - sy0);
 
-                    cell_pixels++;
-                }
-            }
+            uint32_t total_diff = integral[(size_t)sy1 * integral_stride + sx1]
+                                - integral[(size_t)sy0 * integral_stride + sx1]
+                                - integral[(size_t)sy1 * integral_stride + sx0]
+                                + integral[(size_t)sy0 * integral_stride + sx0];
 
             // Calculate cell motion score
-            float cell_area = (cell_pixels > 0)
-                ? (float)changed_pixels / (float)cell_pixels
-                : 0.0f;
             float cell_score = (cell_pixels > 0)
                 ? (float)total_diff / (float)(cell_pixels * 255)
                 : 0.0f;
-            (void)cell_area; // suppress unused warning
 
             // Store cell score
             grid_scores[cell_idx] = cell_score;
@@ -924,7 +766,6 @@ static float calculate_grid_motion(const unsigned char *curr_frame, const unsign
             }
         }
     }
-    #endif
 
     // Calculate overall motion metrics (only among in-zone cells)
     if (total_cells > 0) {
@@ -946,16 +787,14 @@ static void add_frame_to_history(motion_stream_t *stream, const unsigned char *f
         return;
     }
 
-    // Free the old frame if it exists
-    if (stream->frame_history[stream->history_index].frame) {
-        free(stream->frame_history[stream->history_index].frame);
-    }
-
-    // Allocate and copy new frame
-    stream->frame_history[stream->history_index].frame = (unsigned char *)malloc((size_t)stream->width * stream->height);
+    // History slots are allocated on first use and then reused; they are
+    // released whenever the processing geometry changes
     if (!stream->frame_history[stream->history_index].frame) {
-        log_error("Failed to allocate memory for frame history");
-        return;
+        stream->frame_history[stream->history_index].frame = (unsigned char *)malloc((size_t)stream->width * stream->height);
+        if (!stream->frame_history[stream->history_index].frame) {
+            log_error("Failed to allocate memory for frame history");
+            return;
+        }
     }
 
     memcpy(stream->frame_history[stream->history_index].frame, frame, (size_t)stream->width * stream->height);
@@ -976,110 +815,48 @@ static float get_time_ms() {
 
 /**
  * Update memory usage statistics
+ *
+ * Reports the stream's steady-state footprint: the scratch arena plus the
+ * persistent frame, background, history and grid buffers.
  */
-static void update_memory_usage(motion_stream_t *stream, size_t allocated) {
+static void update_memory_usage(motion_stream_t *stream) {
     if (!stream) return;
-    
-    stream->allocated_memory = allocated;
-    if (allocated > stream->peak_memory) {
-        stream->peak_memory = allocated;
-    }
-}
-
-/**
- * Process a frame for motion detection - optimized for embedded devices
- */
-int detect_motion(const char *stream_name, const unsigned char *frame_data,
-                 int width, int height, int channels, time_t frame_time,
-                 detection_result_t *result) {
-    if (!stream_name || !frame_data || !result || width <= 0 || height <= 0 || channels <= 0) {
-        log_error("Invalid parameters for detect_motion");
-        return -1;
-    }
 
-    // Initialize result
-    memset(result, 0, sizeof(detection_result_t));
+    size_t frame_bytes = (size_t)stream->width * stream->height;
+    size_t allocated = stream->scratch.size;
 
-    // Get motion stream
-    motion_stream_t *stream = get_motion_stream(stream_name);
-    if (!stream) {
-        log_error("Failed to get motion stream for %s", stream_name);
-        return -1;
-    }
-
-    pthread_mutex_lock(&stream->mutex);
-    
-    // Start performance monitoring
-    struct timespec start_time;
-    clock_gettime(CLOCK_MONOTONIC, &start_time);
-    stream->last_frame_start = start_time;
-    
-    // Track memory usage
-    size_t current_memory = 0;
-
-    // Check if motion detection is enabled
-    if (!stream->enabled) {
-        pthread_mutex_unlock(&stream->mutex);
-        return 0;
-    }
-
-    // Check cooldown period
-    if (stream->last_detection_time > 0 &&
-        (frame_time - stream->last_detection_time) < stream->cooldown_time) {
-        pthread_mutex_unlock(&stream->mutex);
-        return 0;
+    if (stream->prev_frame) allocated += frame_bytes;
+    if (stream->blur_buffer) allocated += frame_bytes;
+    if (stream->background) allocated += frame_bytes;
+    if (stream->grid_scores) {
+        allocated += (size_t)stream->grid_size * stream->grid_size * sizeof(float);
     }
-
-    // Convert to grayscale if needed
-    unsigned char *gray_frame = NULL;
-    if (channels == 3) {
-        gray_frame = rgb_to_grayscale(frame_data, width, height);
-        if (!gray_frame) {
-            pthread_mutex_unlock(&stream->mutex);
-            return -1;
-        }
-        current_memory += (size_t)width * height;
-    } else if (channels == 1) {
-        // If input is already grayscale, just make a copy
-        gray_frame = (unsigned char *)malloc((size_t)width * height);
-        if (!gray_frame) {
-            log_error("Failed to allocate memory for gray frame");
-            pthread_mutex_unlock(&stream->mutex);
-            return -1;
+    if (stream->frame_history) {
+        allocated += (size_t)stream->history_size * sizeof(frame_history_t);
+        for (int i = 0; i < stream->history_size; i++) {
+            if (stream->frame_history[i].frame) allocated += frame_bytes;
         }
-        memcpy(gray_frame, frame_data, (size_t)width * height);
-        current_memory += (size_t)width * height;
-    } else {
-        log_error("Unsupported number of channels: %d", channels);
-        pthread_mutex_unlock(&stream->mutex);
-        return -1;
     }
 
-    // Downscale the frame if enabled
-    unsigned char *processing_frame = gray_frame;
-    int processing_width = width;
-    int processing_height = height;
-    
-    if (stream->downscale_enabled && stream->downscale_factor > 1) {
-        unsigned char *downscaled = downscale_grayscale(gray_frame, width, height, 
-                                                      stream->downscale_factor,
-                                                      &processing_width, &processing_height);
-        if (downscaled) {
-            // Use the downscaled frame for processing
-            free(gray_frame);
-            gray_frame = NULL;
-            processing_frame = downscaled;
-            
-            // Update memory tracking
-            current_memory = current_memory - (size_t)width * height + (size_t)processing_width * processing_height;
-            
-            log_debug("Downscaled frame from %dx%d to %dx%d for motion detection",
-                     width, height, processing_width, processing_height);
-        } else {
-            log_warn("Failed to downscale frame, using original resolution");
-        }
+    stream->allocated_memory = allocated;
+    if (allocated > stream->peak_memory) {
+        stream->peak_memory = allocated;
     }
+}
 
+/**
+ * Run motion analysis on a prepared grayscale processing frame
+ *
+ * Shared by detect_motion() and detect_motion_luma() once the input has been
+ * reduced to a single-channel frame at processing resolution.  Must be called
+ * with stream->mutex held and the scratch arena sized for the current input;
+ * does not take ownership of processing_frame.
+ */
+static int process_motion_frame(motion_stream_t *stream, const char *stream_name,
+                                const unsigned char *processing_frame,
+                                int processing_width, int processing_height,
+                                time_t frame_time, const struct timespec *start_time,
+                                detection_result_t *result) {
     // Check if we need to allocate or reallocate resources
     if (!stream->prev_frame || stream->width != processing_width || stream->height != processing_height) {
         // Free old resources if they exist
@@ -1136,8 +913,6 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
                 stream->background = NULL;
             }
 
-            free(processing_frame);
-            pthread_mutex_unlock(&stream->mutex);
             return -1;
         }
 
@@ -1150,8 +925,6 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
             stream->grid_scores = (float *)malloc((size_t)stream->grid_size * stream->grid_size * sizeof(float));
             if (!stream->grid_scores) {
                 log_error("Failed to allocate memory for grid scores");
-                free(processing_frame);
-                pthread_mutex_unlock(&stream->mutex);
                 return -1;
             }
             memset(stream->grid_scores, 0, (size_t)stream->grid_size * stream->grid_size * sizeof(float));
@@ -1165,8 +938,6 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
                 free(stream->grid_scores);
                 stream->grid_scores = NULL;
             }
-            free(processing_frame);
-            pthread_mutex_unlock(&stream->mutex);
             return -1;
         }
         memset(stream->frame_history, 0, stream->history_size * sizeof(frame_history_t));
@@ -1179,13 +950,13 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
         stream->downscaled_width = processing_width;
         stream->downscaled_height = processing_height;
 
-        free(processing_frame);
-        pthread_mutex_unlock(&stream->mutex);
+        update_memory_usage(stream);
         return 0;  // Skip motion detection on first frame
     }
 
     // Apply blur to reduce noise
-    apply_box_blur(processing_frame, stream->blur_buffer, processing_width, processing_height, stream->blur_radius);
+    apply_box_blur(processing_frame, stream->blur_buffer, stream->scratch.blur_tmp,
+                   processing_width, processing_height, stream->blur_radius);
 
     bool motion_detected = false;
     float motion_score = 0.0f;
@@ -1214,65 +985,29 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
             stream->blur_buffer, stream->prev_frame, stream->background,
             processing_width, processing_height, stream->sensitivity, stream->noise_threshold,
             stream->grid_size, stream->grid_scores, &motion_area,
-            zone_mask
+            zone_mask, &stream->scratch
         );
 
         // Determine if motion is detected based on area threshold
         motion_detected = (motion_area >= stream->min_motion_area) && (motion_score > 0.01f);
     } else {
-        // Simple frame differencing (original approach with improvements)
+        // Simple frame differencing, sampling every other pixel in both dimensions
         int changed_pixels = 0;
-        int total_diff = 0;
-        #if EMBEDDED_DEVICE_OPTIMIZATION
-        // pixel_count adjusted after sampling loop (1/4 of pixels processed)
-        int pixel_count = 0;
-        // For embedded devices, use sampling to reduce computation
-        // Process every other pixel in both dimensions
+        uint32_t total_diff = 0;
+        int sensitivity_threshold = (int)(stream->sensitivity * 255.0f);
+        int diff_threshold = (stream->noise_threshold > sensitivity_threshold) ?
+                             stream->noise_threshold : sensitivity_threshold;
+        const motion_kernels_t *kernels = motion_kernels_get();
+
         for (int y = 0; y < processing_height; y += 2) {
-            for (int x = 0; x < processing_width; x += 2) {
-                int idx = y * processing_width + x;
-
-                // Calculate differences from previous frame and background
-                int frame_diff = abs((int)stream->blur_buffer[idx] - (int)stream->prev_frame[idx]);
-                int bg_diff = abs((int)stream->blur_buffer[idx] - (int)stream->background[idx]);
-
-                // Use the larger of the two differences
-                int diff = (frame_diff > bg_diff) ? frame_diff : bg_diff;
-
-                // Apply noise threshold
-                if (diff > stream->noise_threshold) {
-                    // Count pixels that changed more than the sensitivity threshold
-                    if ((float)diff > (stream->sensitivity * 255.0f)) {
-                        changed_pixels++;
-                        total_diff += diff;
-                    }
-                }
-            }
+            size_t row = (size_t)y * processing_width;
+            total_diff += kernels->diff_sum(stream->blur_buffer + row, stream->prev_frame + row,
+                                            stream->background + row, processing_width,
+                                            diff_threshold, &changed_pixels);
         }
 
         // Adjust for sampling (we only processed 1/4 of the pixels)
-        pixel_count = (processing_width * processing_height) / 4;
-        #else
-        // Original implementation for non-embedded devices
-        int pixel_count = processing_width * processing_height;
-        for (int i = 0; i < pixel_count; i++) {
-            // Calculate differences from previous frame and background
-            int frame_diff = abs((int)stream->blur_buffer[i] - (int)stream->prev_frame[i]);
-            int bg_diff = abs((int)stream->blur_buffer[i] - (int)stream->background[i]);
-
-            // Use the larger of the two differences
-            int diff = (frame_diff > bg_diff) ? frame_diff : bg_diff;
-
-            // Apply noise threshold
-            if (diff > stream->noise_threshold) {
-                // Count pixels that changed more than the sensitivity threshold
-                if (diff > (stream->sensitivity * 255.0f)) {
-                    changed_pixels++;
-                    total_diff += diff;
-                }
-            }
-        }
-        #endif
+        int pixel_count = (processing_width * processing_height) / 4;
 
         // Calculate motion metrics
         motion_area = (float)changed_pixels / (float)pixel_count;
@@ -1436,17 +1171,14 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
         free(zone_mask);
     }
 
-    // Clean up
-    free(processing_frame);
-    
     // End performance monitoring
     struct timespec end_time;
     clock_gettime(CLOCK_MONOTONIC, &end_time);
     
     // Calculate processing time in milliseconds
     float processing_time =
-        (float)(end_time.tv_sec - start_time.tv_sec) * 1000.0f +
-        (float)(end_time.tv_nsec - start_time.tv_nsec) / 1000000.0f;
+        (float)(end_time.tv_sec - start_time->tv_sec) * 1000.0f +
+        (float)(end_time.tv_nsec - start_time->tv_nsec) / 1000000.0f;
 
     // Update performance statistics
     stream->last_processing_time = processing_time;
@@ -1463,11 +1195,165 @@ int detect_motion(const char *stream_name, const unsigned char *frame_data,
     }
     
     // Update memory usage statistics
-    update_memory_usage(stream, current_memory);
+    update_memory_usage(stream);
+
+    return 0;
+}
+
+/**
+ * Process a frame for motion detection - optimized for embedded devices
+ */
+int detect_motion(const char *stream_name, const unsigned char *frame_data,
+                 int width, int height, int channels, time_t frame_time,
+                 detection_result_t *result) {
+    if (!stream_name || !frame_data || !result || width <= 0 || height <= 0 || channels <= 0) {
+        log_error("Invalid parameters for detect_motion");
+        return -1;
+    }
+
+    // Initialize result
+    memset(result, 0, sizeof(detection_result_t));
+
+    // Get motion stream
+    motion_stream_t *stream = get_motion_stream(stream_name);
+    if (!stream) {
+        log_error("Failed to get motion stream for %s", stream_name);
+        return -1;
+    }
+
+    pthread_mutex_lock(&stream->mutex);
     
+    // Start performance monitoring
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    stream->last_frame_start = start_time;
+    
+    // Check if motion detection is enabled
+    if (!stream->enabled) {
+        pthread_mutex_unlock(&stream->mutex);
+        return 0;
+    }
+
+    // Check cooldown period
+    if (stream->last_detection_time > 0 &&
+        (frame_time - stream->last_detection_time) < stream->cooldown_time) {
+        pthread_mutex_unlock(&stream->mutex);
+        return 0;
+    }
+
+    if (channels != 1 && channels != 3) {
+        log_error("Unsupported number of channels: %d", channels);
+        pthread_mutex_unlock(&stream->mutex);
+        return -1;
+    }
+
+    int factor = (stream->downscale_enabled && stream->downscale_factor > 1) ? stream->downscale_factor : 1;
+
+    // RGB input that is downscaled needs a full-resolution gray buffer first;
+    // every other case lands directly in the processing buffer
+    bool need_gray = (channels == 3 && factor > 1);
+    if (ensure_scratch_arena(stream, width, height, factor, need_gray) != 0) {
+        pthread_mutex_unlock(&stream->mutex);
+        return -1;
+    }
+
+    int processing_width = 0;
+    int processing_height = 0;
+    processing_size(width, height, factor, &processing_width, &processing_height);
+
+    const motion_kernels_t *kernels = motion_kernels_get();
+    const unsigned char *processing_frame = stream->scratch.processing;
+
+    if (channels == 3) {
+        unsigned char *gray = need_gray ? stream->scratch.gray : stream->scratch.processing;
+        kernels->rgb_to_gray(frame_data, gray, width * height);
+        if (factor > 1) {
+            kernels->downscale(gray, width, width, height, factor,
+                               stream->scratch.processing, processing_width, processing_height);
+        }
+    } else if (factor > 1) {
+        kernels->downscale(frame_data, width, width, height, factor,
+                           stream->scratch.processing, processing_width, processing_height);
+    } else {
+        // Grayscale at full resolution: analyse the caller's buffer in place
+        processing_frame = frame_data;
+    }
+
+    if (factor > 1) {
+        log_debug("Downscaled frame from %dx%d to %dx%d for motion detection",
+                 width, height, processing_width, processing_height);
+    }
+
+    int ret = process_motion_frame(stream, stream_name, processing_frame,
+                                   processing_width, processing_height,
+                                   frame_time, &start_time, result);
+
     pthread_mutex_unlock(&stream->mutex);
 
-    return 0;
+    return ret;
+}
+
+/**
+ * Process a decoded frame's luma plane for motion detection
+ */
+int detect_motion_luma(const char *stream_name, const unsigned char *luma,
+                       int width, int height, int stride, bool full_range,
+                       time_t frame_time, detection_result_t *result) {
+    if (!stream_name || !luma || !result || width <= 0 || height <= 0 || stride < width) {
+        log_error("Invalid parameters for detect_motion_luma");
+        return -1;
+    }
+
+    // Initialize result
+    memset(result, 0, sizeof(detection_result_t));
+
+    // Get motion stream
+    motion_stream_t *stream = get_motion_stream(stream_name);
+    if (!stream) {
+        log_error("Failed to get motion stream for %s", stream_name);
+        return -1;
+    }
+
+    pthread_mutex_lock(&stream->mutex);
+
+    // Start performance monitoring
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    stream->last_frame_start = start_time;
+
+    // Check if motion detection is enabled
+    if (!stream->enabled) {
+        pthread_mutex_unlock(&stream->mutex);
+        return 0;
+    }
+
+    // Check cooldown period
+    if (stream->last_detection_time > 0 &&
+        (frame_time - stream->last_detection_time) < stream->cooldown_time) {
+        pthread_mutex_unlock(&stream->mutex);
+        return 0;
+    }
+
+    // Downscale directly from the luma plane (factor 1 still strips the stride)
+    int factor = (stream->downscale_enabled && stream->downscale_factor > 1) ? stream->downscale_factor : 1;
+    if (ensure_scratch_arena(stream, width, height, factor, false) != 0) {
+        pthread_mutex_unlock(&stream->mutex);
+        return -1;
+    }
+
+    int processing_width = 0;
+    int processing_height = 0;
+    processing_size(width, height, factor, &processing_width, &processing_height);
+    downscale_luma(luma, stride, width, height, factor, full_range,
+                   stream->scratch.processing, processing_width, processing_height);
+
+    int ret = process_motion_frame(stream, stream_name, stream->scratch.processing,
+                                   processing_width, processing_height,
+                                   frame_time, &start_time, result);
+
+    pthread_mutex_unlock(&stream->mutex);
+
+    return ret;
 }
 
 /**
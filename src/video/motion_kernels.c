@@ -0,0 +1,918 @@
+/**
+ * Motion detection pixel kernels
+ *
+ * Scalar reference implementations plus SSE2/AVX2 (x86) and NEON (ARM)
+ * variants of the per-pixel loops used by motion_detection.c.  The vector
+ * paths only handle the interior of each image; borders and tails go through
+ * the same scalar helpers as the reference set so results are bit-identical.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MOTION_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#define MOTION_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "video/motion_kernels.h"
+
+// Fixed-point (8-bit fraction) luminance coefficients: 0.299, 0.587, 0.114
+#define GRAY_R_COEFF 76
+#define GRAY_G_COEFF 150
+#define GRAY_B_COEFF 29
+
+// Columns per strip in the scalar vertical blur pass (running sums live on the stack)
+#define BLUR_STRIP_WIDTH 256
+
+// ---------------------------------------------------------------------------
+// Scalar helpers (shared by every kernel set for borders and tails)
+// ---------------------------------------------------------------------------
+
+static inline uint8_t downscale_block(const uint8_t *src, int src_stride, int width, int height,
+                                      int factor, int x, int y) {
+    int sum = 0;
+    int count = 0;
+
+    for (int dy = 0; dy < factor && (y * factor + dy) < height; dy++) {
+        const uint8_t *row = src + (size_t)(y * factor + dy) * src_stride;
+        for (int dx = 0; dx < factor && (x * factor + dx) < width; dx++) {
+            sum += row[x * factor + dx];
+            count++;
+        }
+    }
+
+    return (count > 0) ? (uint8_t)(sum / count) : 0;
+}
+
+/**
+ * Downscale every output pixel outside the rectangle [0, x_done) x [0, y_done)
+ */
+static void downscale_remainder(const uint8_t *src, int src_stride, int width, int height, int factor,
+                                uint8_t *dst, int dst_width, int dst_height, int x_done, int y_done) {
+    for (int y = 0; y < dst_height; y++) {
+        int x_start = (y < y_done) ? x_done : 0;
+        for (int x = x_start; x < dst_width; x++) {
+            dst[(size_t)y * dst_width + x] = downscale_block(src, src_stride, width, height, factor, x, y);
+        }
+    }
+}
+
+static inline uint8_t blur_h_pixel(const uint8_t *row, int width, int x, int radius) {
+    int x0 = x - radius < 0 ? 0 : x - radius;
+    int x1 = x + radius >= width ? width - 1 : x + radius;
+    int sum = 0;
+    for (int i = x0; i <= x1; i++) {
+        sum += row[i];
+    }
+    return (uint8_t)(sum / (x1 - x0 + 1));
+}
+
+static inline uint8_t blur_v_pixel(const uint8_t *src, int width, int height, int x, int y, int radius) {
+    int y0 = y - radius < 0 ? 0 : y - radius;
+    int y1 = y + radius >= height ? height - 1 : y + radius;
+    int sum = 0;
+    for (int i = y0; i <= y1; i++) {
+        sum += src[(size_t)i * width + x];
+    }
+    return (uint8_t)(sum / (y1 - y0 + 1));
+}
+
+static inline uint32_t diff_sum_tail(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                                     int start, int n, int threshold, int *changed) {
+    uint32_t sum = 0;
+    for (int i = start; i < n; i += 2) {
+        int frame_diff = curr[i] > prev[i] ? curr[i] - prev[i] : prev[i] - curr[i];
+        int bg_diff = curr[i] > bg[i] ? curr[i] - bg[i] : bg[i] - curr[i];
+        int diff = frame_diff > bg_diff ? frame_diff : bg_diff;
+        if (diff > threshold) {
+            sum += (uint32_t)diff;
+            (*changed)++;
+        }
+    }
+    return sum;
+}
+
+static inline void diff_row_tail(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                                 int start, int n, int threshold, uint8_t *out) {
+    for (int i = start; i < n; i += 2) {
+        int frame_diff = curr[i] > prev[i] ? curr[i] - prev[i] : prev[i] - curr[i];
+        int bg_diff = curr[i] > bg[i] ? curr[i] - bg[i] : bg[i] - curr[i];
+        int diff = frame_diff > bg_diff ? frame_diff : bg_diff;
+        out[i / 2] = diff > threshold ? (uint8_t)diff : 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference kernels
+// ---------------------------------------------------------------------------
+
+static void scalar_rgb_to_gray(const uint8_t *rgb, uint8_t *gray, int npixels) {
+    for (int i = 0; i < npixels; i++) {
+        const uint8_t *p = rgb + (size_t)i * 3;
+        gray[i] = (uint8_t)((GRAY_R_COEFF * p[0] + GRAY_G_COEFF * p[1] + GRAY_B_COEFF * p[2]) >> 8);
+    }
+}
+
+static void scalar_downscale(const uint8_t *src, int src_stride, int width, int height, int factor,
+                             uint8_t *dst, int dst_width, int dst_height) {
+    if (factor <= 1 && dst_width <= width && dst_height <= height) {
+        for (int y = 0; y < dst_height; y++) {
+            memcpy(dst + (size_t)y * dst_width, src + (size_t)y * src_stride, (size_t)dst_width);
+        }
+        return;
+    }
+
+    if (factor < 1) factor = 1;
+    downscale_remainder(src, src_stride, width, height, factor, dst, dst_width, dst_height, 0, 0);
+}
+
+static void scalar_box_blur(const uint8_t *src, uint8_t *dst, uint8_t *tmp,
+                            int width, int height, int radius) {
+    if (radius <= 0) {
+        memcpy(dst, src, (size_t)width * height);
+        return;
+    }
+
+    // Horizontal pass: sliding window sum per row
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = src + (size_t)y * width;
+        uint8_t *out = tmp + (size_t)y * width;
+        int sum = 0;
+        int count = 0;
+
+        for (int i = 0; i <= radius && i < width; i++) {
+            sum += row[i];
+            count++;
+        }
+        out[0] = (uint8_t)(sum / count);
+
+        for (int x = 1; x < width; x++) {
+            if (x + radius < width) {
+                sum += row[x + radius];
+                count++;
+            }
+            if (x - radius - 1 >= 0) {
+                sum -= row[x - radius - 1];
+                count--;
+            }
+            out[x] = (uint8_t)(sum / count);
+        }
+    }
+
+    // Vertical pass: running column sums, one strip of columns at a time so
+    // the sums stay on the stack and every read walks a row
+    for (int x0 = 0; x0 < width; x0 += BLUR_STRIP_WIDTH) {
+        int strip = width - x0 < BLUR_STRIP_WIDTH ? width - x0 : BLUR_STRIP_WIDTH;
+        uint32_t col_sum[BLUR_STRIP_WIDTH];
+        int count = 0;
+
+        memset(col_sum, 0, sizeof(col_sum));
+        for (int i = 0; i <= radius && i < height; i++) {
+            const uint8_t *row = tmp + (size_t)i * width + x0;
+            for (int x = 0; x < strip; x++) {
+                col_sum[x] += row[x];
+            }
+            count++;
+        }
+
+        for (int y = 0; y < height; y++) {
+            if (y > 0 && y + radius < height) {
+                const uint8_t *row = tmp + (size_t)(y + radius) * width + x0;
+                for (int x = 0; x < strip; x++) {
+                    col_sum[x] += row[x];
+                }
+                count++;
+            }
+            if (y - radius - 1 >= 0) {
+                const uint8_t *row = tmp + (size_t)(y - radius - 1) * width + x0;
+                for (int x = 0; x < strip; x++) {
+                    col_sum[x] -= row[x];
+                }
+                count--;
+            }
+
+            uint8_t *out = dst + (size_t)y * width + x0;
+            for (int x = 0; x < strip; x++) {
+                out[x] = (uint8_t)(col_sum[x] / (uint32_t)count);
+            }
+        }
+    }
+}
+
+static void scalar_update_background(uint8_t *bg, const uint8_t *cur, int npixels, int alpha) {
+    int inv_alpha = 256 - alpha;
+    for (int i = 0; i < npixels; i++) {
+        bg[i] = (uint8_t)((inv_alpha * bg[i] + alpha * cur[i]) >> 8);
+    }
+}
+
+static uint32_t scalar_diff_sum(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                                int n, int threshold, int *changed) {
+    return diff_sum_tail(curr, prev, bg, 0, n, threshold, changed);
+}
+
+static void scalar_diff_row(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                            int n, int threshold, uint8_t *out) {
+    diff_row_tail(curr, prev, bg, 0, n, threshold, out);
+}
+
+static const motion_kernels_t scalar_kernels = {
+    .name = "scalar",
+    .rgb_to_gray = scalar_rgb_to_gray,
+    .downscale = scalar_downscale,
+    .box_blur = scalar_box_blur,
+    .update_background = scalar_update_background,
+    .diff_sum = scalar_diff_sum,
+    .diff_row = scalar_diff_row,
+};
+
+// Reciprocal for exact truncating division of window sums (<= 255 * n) by
+// n = 2 * radius + 1 using a 16x16 -> high-16 multiply; exact for 3 <= n <= 11.
+static inline uint16_t blur_reciprocal(int radius) {
+    int n = 2 * radius + 1;
+    return (uint16_t)((65536 + n - 1) / n);
+}
+
+// ---------------------------------------------------------------------------
+// x86: SSE2 / SSSE3 / AVX2
+// ---------------------------------------------------------------------------
+
+#ifdef MOTION_KERNELS_X86
+
+__attribute__((target("sse2")))
+static void sse2_downscale(const uint8_t *src, int src_stride, int width, int height, int factor,
+                           uint8_t *dst, int dst_width, int dst_height) {
+    if (factor != 2) {
+        scalar_downscale(src, src_stride, width, height, factor, dst, dst_width, dst_height);
+        return;
+    }
+
+    // Rectangle of output pixels whose 2x2 block lies fully inside the source
+    int x_full = width / 2 < dst_width ? width / 2 : dst_width;
+    int y_full = height / 2 < dst_height ? height / 2 : dst_height;
+    int x_done = x_full & ~15;
+    const __m128i low_mask = _mm_set1_epi16(0x00FF);
+
+    for (int y = 0; y < y_full; y++) {
+        const uint8_t *r0 = src + (size_t)(2 * y) * src_stride;
+        const uint8_t *r1 = r0 + src_stride;
+        uint8_t *out = dst + (size_t)y * dst_width;
+
+        for (int x = 0; x < x_done; x += 16) {
+            __m128i a0 = _mm_loadu_si128((const __m128i *)(r0 + 2 * x));
+            __m128i a1 = _mm_loadu_si128((const __m128i *)(r0 + 2 * x + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i *)(r1 + 2 * x));
+            __m128i b1 = _mm_loadu_si128((const __m128i *)(r1 + 2 * x + 16));
+
+            __m128i s0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, low_mask), _mm_srli_epi16(a0, 8)),
+                                       _mm_add_epi16(_mm_and_si128(b0, low_mask), _mm_srli_epi16(b0, 8)));
+            __m128i s1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, low_mask), _mm_srli_epi16(a1, 8)),
+                                       _mm_add_epi16(_mm_and_si128(b1, low_mask), _mm_srli_epi16(b1, 8)));
+
+            _mm_storeu_si128((__m128i *)(out + x),
+                             _mm_packus_epi16(_mm_srli_epi16(s0, 2), _mm_srli_epi16(s1, 2)));
+        }
+    }
+
+    downscale_remainder(src, src_stride, width, height, factor, dst, dst_width, dst_height,
+                        x_done, y_full);
+}
+
+__attribute__((target("sse2")))
+static void sse2_box_blur(const uint8_t *src, uint8_t *dst, uint8_t *tmp,
+                          int width, int height, int radius) {
+    if (radius <= 0 || radius > 5) {
+        scalar_box_blur(src, dst, tmp, width, height, radius);
+        return;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i recip = _mm_set1_epi16((short)blur_reciprocal(radius));
+
+    // Horizontal pass
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = src + (size_t)y * width;
+        uint8_t *out = tmp + (size_t)y * width;
+        int x = 0;
+
+        for (; x < radius && x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+        for (; x + 16 + radius <= width; x += 16) {
+            __m128i lo = zero;
+            __m128i hi = zero;
+            for (int k = -radius; k <= radius; k++) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(row + x + k));
+                lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+                hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+            }
+            _mm_storeu_si128((__m128i *)(out + x),
+                             _mm_packus_epi16(_mm_mulhi_epu16(lo, recip), _mm_mulhi_epu16(hi, recip)));
+        }
+        for (; x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+    }
+
+    // Vertical pass
+    for (int y = 0; y < height; y++) {
+        uint8_t *out = dst + (size_t)y * width;
+        int x = 0;
+
+        if (y >= radius && y + radius < height) {
+            for (; x + 16 <= width; x += 16) {
+                __m128i lo = zero;
+                __m128i hi = zero;
+                for (int k = -radius; k <= radius; k++) {
+                    __m128i v = _mm_loadu_si128((const __m128i *)(tmp + (size_t)(y + k) * width + x));
+                    lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+                    hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+                }
+                _mm_storeu_si128((__m128i *)(out + x),
+                                 _mm_packus_epi16(_mm_mulhi_epu16(lo, recip), _mm_mulhi_epu16(hi, recip)));
+            }
+        }
+        for (; x < width; x++) {
+            out[x] = blur_v_pixel(tmp, width, height, x, y, radius);
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static void sse2_update_background(uint8_t *bg, const uint8_t *cur, int npixels, int alpha) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i va = _mm_set1_epi16((short)alpha);
+    const __m128i vi = _mm_set1_epi16((short)(256 - alpha));
+    int i = 0;
+
+    // inv_alpha * bg + alpha * cur <= 256 * 255, so unsigned 16-bit lanes never overflow
+    for (; i + 16 <= npixels; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(bg + i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(cur + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), vi),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), va));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), vi),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), va));
+        _mm_storeu_si128((__m128i *)(bg + i),
+                         _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+
+    scalar_update_background(bg + i, cur + i, npixels - i, alpha);
+}
+
+__attribute__((target("sse2")))
+static uint32_t sse2_diff_sum(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                              int n, int threshold, int *changed) {
+    if (threshold >= 255) {
+        return 0;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i even_mask = _mm_set1_epi16(0x00FF);
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i min_diff = _mm_set1_epi8((char)(threshold + 1));
+    __m128i sum = zero;
+    __m128i cnt = zero;
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(curr + i));
+        __m128i p = _mm_loadu_si128((const __m128i *)(prev + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(bg + i));
+        __m128i d1 = _mm_or_si128(_mm_subs_epu8(c, p), _mm_subs_epu8(p, c));
+        __m128i d2 = _mm_or_si128(_mm_subs_epu8(c, b), _mm_subs_epu8(b, c));
+        __m128i d = _mm_max_epu8(d1, d2);
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(d, min_diff), d), even_mask);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_and_si128(d, hit), zero));
+        cnt = _mm_add_epi64(cnt, _mm_sad_epu8(_mm_and_si128(hit, ones), zero));
+    }
+
+    uint32_t total = (uint32_t)(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+    *changed += _mm_cvtsi128_si32(cnt) + _mm_cvtsi128_si32(_mm_srli_si128(cnt, 8));
+
+    return total + diff_sum_tail(curr, prev, bg, i, n, threshold, changed);
+}
+
+__attribute__((target("sse2")))
+static void sse2_diff_row(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                          int n, int threshold, uint8_t *out) {
+    if (threshold >= 255) {
+        memset(out, 0, (size_t)(n + 1) / 2);
+        return;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const __m128i even_mask = _mm_set1_epi16(0x00FF);
+    const __m128i min_diff = _mm_set1_epi8((char)(threshold + 1));
+    int i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m128i d[2];
+        for (int h = 0; h < 2; h++) {
+            __m128i c = _mm_loadu_si128((const __m128i *)(curr + i + h * 16));
+            __m128i p = _mm_loadu_si128((const __m128i *)(prev + i + h * 16));
+            __m128i b = _mm_loadu_si128((const __m128i *)(bg + i + h * 16));
+            __m128i d1 = _mm_or_si128(_mm_subs_epu8(c, p), _mm_subs_epu8(p, c));
+            __m128i d2 = _mm_or_si128(_mm_subs_epu8(c, b), _mm_subs_epu8(b, c));
+            __m128i v = _mm_max_epu8(d1, d2);
+            __m128i hit = _mm_cmpeq_epi8(_mm_max_epu8(v, min_diff), v);
+            d[h] = _mm_and_si128(_mm_and_si128(v, hit), even_mask);
+        }
+        _mm_storeu_si128((__m128i *)(out + i / 2), _mm_packus_epi16(d[0], d[1]));
+    }
+
+    diff_row_tail(curr, prev, bg, i, n, threshold, out);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_rgb_to_gray(const uint8_t *rgb, uint8_t *gray, int npixels) {
+    // Shuffle masks gathering channel c of 16 pixels from three 16-byte loads
+    uint8_t masks[3][3][16];
+    for (int c = 0; c < 3; c++) {
+        for (int part = 0; part < 3; part++) {
+            for (int j = 0; j < 16; j++) {
+                int byte = 3 * j + c;
+                masks[c][part][j] = (byte / 16 == part) ? (uint8_t)(byte % 16) : 0x80;
+            }
+        }
+    }
+
+    __m128i m[3][3];
+    for (int c = 0; c < 3; c++) {
+        for (int part = 0; part < 3; part++) {
+            m[c][part] = _mm_loadu_si128((const __m128i *)masks[c][part]);
+        }
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i kr = _mm_set1_epi16(GRAY_R_COEFF);
+    const __m128i kg = _mm_set1_epi16(GRAY_G_COEFF);
+    const __m128i kb = _mm_set1_epi16(GRAY_B_COEFF);
+    int i = 0;
+
+    for (; i + 16 <= npixels; i += 16) {
+        const uint8_t *p = rgb + (size_t)i * 3;
+        __m128i v0 = _mm_loadu_si128((const __m128i *)p);
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(p + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(p + 32));
+
+        __m128i ch[3];
+        for (int c = 0; c < 3; c++) {
+            ch[c] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, m[c][0]), _mm_shuffle_epi8(v1, m[c][1])),
+                                 _mm_shuffle_epi8(v2, m[c][2]));
+        }
+
+        // 76*R + 150*G + 29*B <= 255 * 255, fits unsigned 16-bit lanes
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(ch[0], zero), kr),
+                                                 _mm_mullo_epi16(_mm_unpacklo_epi8(ch[1], zero), kg)),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(ch[2], zero), kb));
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(ch[0], zero), kr),
+                                                 _mm_mullo_epi16(_mm_unpackhi_epi8(ch[1], zero), kg)),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(ch[2], zero), kb));
+        _mm_storeu_si128((__m128i *)(gray + i),
+                         _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+
+    scalar_rgb_to_gray(rgb + (size_t)i * 3, gray + i, npixels - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m128i avx2_pack_u16(__m256i v) {
+    return _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+}
+
+__attribute__((target("avx2")))
+static void avx2_box_blur(const uint8_t *src, uint8_t *dst, uint8_t *tmp,
+                          int width, int height, int radius) {
+    if (radius <= 0 || radius > 5) {
+        scalar_box_blur(src, dst, tmp, width, height, radius);
+        return;
+    }
+
+    const __m256i recip = _mm256_set1_epi16((short)blur_reciprocal(radius));
+
+    // Horizontal pass
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = src + (size_t)y * width;
+        uint8_t *out = tmp + (size_t)y * width;
+        int x = 0;
+
+        for (; x < radius && x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+        for (; x + 16 + radius <= width; x += 16) {
+            __m256i acc = _mm256_setzero_si256();
+            for (int k = -radius; k <= radius; k++) {
+                acc = _mm256_add_epi16(acc, _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128((const __m128i *)(row + x + k))));
+            }
+            _mm_storeu_si128((__m128i *)(out + x), avx2_pack_u16(_mm256_mulhi_epu16(acc, recip)));
+        }
+        for (; x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+    }
+
+    // Vertical pass
+    for (int y = 0; y < height; y++) {
+        uint8_t *out = dst + (size_t)y * width;
+        int x = 0;
+
+        if (y >= radius && y + radius < height) {
+            for (; x + 16 <= width; x += 16) {
+                __m256i acc = _mm256_setzero_si256();
+                for (int k = -radius; k <= radius; k++) {
+                    acc = _mm256_add_epi16(acc, _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128((const __m128i *)(tmp + (size_t)(y + k) * width + x))));
+                }
+                _mm_storeu_si128((__m128i *)(out + x), avx2_pack_u16(_mm256_mulhi_epu16(acc, recip)));
+            }
+        }
+        for (; x < width; x++) {
+            out[x] = blur_v_pixel(tmp, width, height, x, y, radius);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void avx2_update_background(uint8_t *bg, const uint8_t *cur, int npixels, int alpha) {
+    const __m256i va = _mm256_set1_epi16((short)alpha);
+    const __m256i vi = _mm256_set1_epi16((short)(256 - alpha));
+    int i = 0;
+
+    for (; i + 16 <= npixels; i += 16) {
+        __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(bg + i)));
+        __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(cur + i)));
+        __m256i r = _mm256_add_epi16(_mm256_mullo_epi16(b, vi), _mm256_mullo_epi16(c, va));
+        _mm_storeu_si128((__m128i *)(bg + i), avx2_pack_u16(_mm256_srli_epi16(r, 8)));
+    }
+
+    scalar_update_background(bg + i, cur + i, npixels - i, alpha);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2_diff_sum(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                              int n, int threshold, int *changed) {
+    if (threshold >= 255) {
+        return 0;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i even_mask = _mm256_set1_epi16(0x00FF);
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i min_diff = _mm256_set1_epi8((char)(threshold + 1));
+    __m256i sum = zero;
+    __m256i cnt = zero;
+    int i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(curr + i));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(prev + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(bg + i));
+        __m256i d1 = _mm256_or_si256(_mm256_subs_epu8(c, p), _mm256_subs_epu8(p, c));
+        __m256i d2 = _mm256_or_si256(_mm256_subs_epu8(c, b), _mm256_subs_epu8(b, c));
+        __m256i d = _mm256_max_epu8(d1, d2);
+        __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(d, min_diff), d), even_mask);
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_and_si256(d, hit), zero));
+        cnt = _mm256_add_epi64(cnt, _mm256_sad_epu8(_mm256_and_si256(hit, ones), zero));
+    }
+
+    uint64_t s[4];
+    uint64_t k[4];
+    _mm256_storeu_si256((__m256i *)s, sum);
+    _mm256_storeu_si256((__m256i *)k, cnt);
+    *changed += (int)(k[0] + k[1] + k[2] + k[3]);
+
+    // i is a multiple of 32, so the tail keeps sampling even offsets
+    return (uint32_t)(s[0] + s[1] + s[2] + s[3]) + diff_sum_tail(curr, prev, bg, i, n, threshold, changed);
+}
+
+__attribute__((target("avx2")))
+static void avx2_diff_row(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                          int n, int threshold, uint8_t *out) {
+    if (threshold >= 255) {
+        memset(out, 0, (size_t)(n + 1) / 2);
+        return;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const __m256i even_mask = _mm256_set1_epi16(0x00FF);
+    const __m256i min_diff = _mm256_set1_epi8((char)(threshold + 1));
+    int i = 0;
+
+    for (; i + 64 <= n; i += 64) {
+        __m256i d[2];
+        for (int h = 0; h < 2; h++) {
+            __m256i c = _mm256_loadu_si256((const __m256i *)(curr + i + h * 32));
+            __m256i p = _mm256_loadu_si256((const __m256i *)(prev + i + h * 32));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(bg + i + h * 32));
+            __m256i d1 = _mm256_or_si256(_mm256_subs_epu8(c, p), _mm256_subs_epu8(p, c));
+            __m256i d2 = _mm256_or_si256(_mm256_subs_epu8(c, b), _mm256_subs_epu8(b, c));
+            __m256i v = _mm256_max_epu8(d1, d2);
+            __m256i hit = _mm256_cmpeq_epi8(_mm256_max_epu8(v, min_diff), v);
+            d[h] = _mm256_and_si256(_mm256_and_si256(v, hit), even_mask);
+        }
+        // packus works per 128-bit lane; restore linear order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(d[0], d[1]), 0xD8);
+        _mm256_storeu_si256((__m256i *)(out + i / 2), packed);
+    }
+
+    diff_row_tail(curr, prev, bg, i, n, threshold, out);
+}
+
+static const motion_kernels_t sse2_kernels = {
+    .name = "sse2",
+    .rgb_to_gray = scalar_rgb_to_gray,
+    .downscale = sse2_downscale,
+    .box_blur = sse2_box_blur,
+    .update_background = sse2_update_background,
+    .diff_sum = sse2_diff_sum,
+    .diff_row = sse2_diff_row,
+};
+
+static const motion_kernels_t avx2_kernels = {
+    .name = "avx2",
+    .rgb_to_gray = ssse3_rgb_to_gray,
+    .downscale = sse2_downscale,
+    .box_blur = avx2_box_blur,
+    .update_background = avx2_update_background,
+    .diff_sum = avx2_diff_sum,
+    .diff_row = avx2_diff_row,
+};
+
+#endif /* MOTION_KERNELS_X86 */
+
+// ---------------------------------------------------------------------------
+// ARM: NEON
+// ---------------------------------------------------------------------------
+
+#ifdef MOTION_KERNELS_NEON
+
+static inline uint32_t neon_sum_u32(uint32x4_t v) {
+    uint64x2_t s = vpaddlq_u32(v);
+    return (uint32_t)(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+}
+
+static inline uint8x16_t neon_div_window(uint16x8_t lo, uint16x8_t hi, uint16x4_t recip) {
+    uint16x8_t qlo = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(lo), recip), 16),
+                                  vshrn_n_u32(vmull_u16(vget_high_u16(lo), recip), 16));
+    uint16x8_t qhi = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(hi), recip), 16),
+                                  vshrn_n_u32(vmull_u16(vget_high_u16(hi), recip), 16));
+    return vcombine_u8(vqmovn_u16(qlo), vqmovn_u16(qhi));
+}
+
+static void neon_rgb_to_gray(const uint8_t *rgb, uint8_t *gray, int npixels) {
+    const uint8x8_t kr = vdup_n_u8(GRAY_R_COEFF);
+    const uint8x8_t kg = vdup_n_u8(GRAY_G_COEFF);
+    const uint8x8_t kb = vdup_n_u8(GRAY_B_COEFF);
+    int i = 0;
+
+    for (; i + 16 <= npixels; i += 16) {
+        uint8x16x3_t px = vld3q_u8(rgb + (size_t)i * 3);
+        uint16x8_t lo = vmull_u8(vget_low_u8(px.val[0]), kr);
+        lo = vmlal_u8(lo, vget_low_u8(px.val[1]), kg);
+        lo = vmlal_u8(lo, vget_low_u8(px.val[2]), kb);
+        uint16x8_t hi = vmull_u8(vget_high_u8(px.val[0]), kr);
+        hi = vmlal_u8(hi, vget_high_u8(px.val[1]), kg);
+        hi = vmlal_u8(hi, vget_high_u8(px.val[2]), kb);
+        vst1q_u8(gray + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+
+    scalar_rgb_to_gray(rgb + (size_t)i * 3, gray + i, npixels - i);
+}
+
+static void neon_downscale(const uint8_t *src, int src_stride, int width, int height, int factor,
+                           uint8_t *dst, int dst_width, int dst_height) {
+    if (factor != 2) {
+        scalar_downscale(src, src_stride, width, height, factor, dst, dst_width, dst_height);
+        return;
+    }
+
+    int x_full = width / 2 < dst_width ? width / 2 : dst_width;
+    int y_full = height / 2 < dst_height ? height / 2 : dst_height;
+    int x_done = x_full & ~15;
+
+    for (int y = 0; y < y_full; y++) {
+        const uint8_t *r0 = src + (size_t)(2 * y) * src_stride;
+        const uint8_t *r1 = r0 + src_stride;
+        uint8_t *out = dst + (size_t)y * dst_width;
+
+        for (int x = 0; x < x_done; x += 16) {
+            uint16x8_t s0 = vpadalq_u8(vpaddlq_u8(vld1q_u8(r0 + 2 * x)), vld1q_u8(r1 + 2 * x));
+            uint16x8_t s1 = vpadalq_u8(vpaddlq_u8(vld1q_u8(r0 + 2 * x + 16)), vld1q_u8(r1 + 2 * x + 16));
+            vst1q_u8(out + x, vcombine_u8(vshrn_n_u16(s0, 2), vshrn_n_u16(s1, 2)));
+        }
+    }
+
+    downscale_remainder(src, src_stride, width, height, factor, dst, dst_width, dst_height,
+                        x_done, y_full);
+}
+
+static void neon_box_blur(const uint8_t *src, uint8_t *dst, uint8_t *tmp,
+                          int width, int height, int radius) {
+    if (radius <= 0 || radius > 5) {
+        scalar_box_blur(src, dst, tmp, width, height, radius);
+        return;
+    }
+
+    const uint16x4_t recip = vdup_n_u16(blur_reciprocal(radius));
+
+    // Horizontal pass
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = src + (size_t)y * width;
+        uint8_t *out = tmp + (size_t)y * width;
+        int x = 0;
+
+        for (; x < radius && x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+        for (; x + 16 + radius <= width; x += 16) {
+            uint16x8_t lo = vdupq_n_u16(0);
+            uint16x8_t hi = vdupq_n_u16(0);
+            for (int k = -radius; k <= radius; k++) {
+                uint8x16_t v = vld1q_u8(row + x + k);
+                lo = vaddw_u8(lo, vget_low_u8(v));
+                hi = vaddw_u8(hi, vget_high_u8(v));
+            }
+            vst1q_u8(out + x, neon_div_window(lo, hi, recip));
+        }
+        for (; x < width; x++) {
+            out[x] = blur_h_pixel(row, width, x, radius);
+        }
+    }
+
+    // Vertical pass
+    for (int y = 0; y < height; y++) {
+        uint8_t *out = dst + (size_t)y * width;
+        int x = 0;
+
+        if (y >= radius && y + radius < height) {
+            for (; x + 16 <= width; x += 16) {
+                uint16x8_t lo = vdupq_n_u16(0);
+                uint16x8_t hi = vdupq_n_u16(0);
+                for (int k = -radius; k <= radius; k++) {
+                    uint8x16_t v = vld1q_u8(tmp + (size_t)(y + k) * width + x);
+                    lo = vaddw_u8(lo, vget_low_u8(v));
+                    hi = vaddw_u8(hi, vget_high_u8(v));
+                }
+                vst1q_u8(out + x, neon_div_window(lo, hi, recip));
+            }
+        }
+        for (; x < width; x++) {
+            out[x] = blur_v_pixel(tmp, width, height, x, y, radius);
+        }
+    }
+}
+
+static void neon_update_background(uint8_t *bg, const uint8_t *cur, int npixels, int alpha) {
+    // Both weights must fit in 8 bits for the widening multiply
+    if (alpha <= 0 || alpha >= 256) {
+        scalar_update_background(bg, cur, npixels, alpha);
+        return;
+    }
+
+    const uint8x8_t va = vdup_n_u8((uint8_t)alpha);
+    const uint8x8_t vi = vdup_n_u8((uint8_t)(256 - alpha));
+    int i = 0;
+
+    for (; i + 16 <= npixels; i += 16) {
+        uint8x16_t b = vld1q_u8(bg + i);
+        uint8x16_t c = vld1q_u8(cur + i);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(b), vi), vget_low_u8(c), va);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(b), vi), vget_high_u8(c), va);
+        vst1q_u8(bg + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+
+    scalar_update_background(bg + i, cur + i, npixels - i, alpha);
+}
+
+static uint32_t neon_diff_sum(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                              int n, int threshold, int *changed) {
+    if (threshold >= 255) {
+        return 0;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const uint8x16_t even_mask = vreinterpretq_u8_u16(vdupq_n_u16(0x00FF));
+    const uint8x16_t ones = vdupq_n_u8(1);
+    const uint8x16_t min_diff = vdupq_n_u8((uint8_t)(threshold + 1));
+    uint32x4_t sum = vdupq_n_u32(0);
+    uint32x4_t cnt = vdupq_n_u32(0);
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t c = vld1q_u8(curr + i);
+        uint8x16_t d = vmaxq_u8(vabdq_u8(c, vld1q_u8(prev + i)), vabdq_u8(c, vld1q_u8(bg + i)));
+        uint8x16_t hit = vandq_u8(vcgeq_u8(d, min_diff), even_mask);
+        sum = vpadalq_u16(sum, vpaddlq_u8(vandq_u8(d, hit)));
+        cnt = vpadalq_u16(cnt, vpaddlq_u8(vandq_u8(hit, ones)));
+    }
+
+    *changed += (int)neon_sum_u32(cnt);
+    return neon_sum_u32(sum) + diff_sum_tail(curr, prev, bg, i, n, threshold, changed);
+}
+
+static void neon_diff_row(const uint8_t *curr, const uint8_t *prev, const uint8_t *bg,
+                          int n, int threshold, uint8_t *out) {
+    if (threshold >= 255) {
+        memset(out, 0, (size_t)(n + 1) / 2);
+        return;
+    }
+    if (threshold < 0) {
+        threshold = -1;
+    }
+
+    const uint8x16_t min_diff = vdupq_n_u8((uint8_t)(threshold + 1));
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t c = vld1q_u8(curr + i);
+        uint8x16_t d = vmaxq_u8(vabdq_u8(c, vld1q_u8(prev + i)), vabdq_u8(c, vld1q_u8(bg + i)));
+        d = vandq_u8(d, vcgeq_u8(d, min_diff));
+        // Narrowing keeps the low (even-offset) byte of each 16-bit pair
+        vst1_u8(out + i / 2, vmovn_u16(vreinterpretq_u16_u8(d)));
+    }
+
+    diff_row_tail(curr, prev, bg, i, n, threshold, out);
+}
+
+static const motion_kernels_t neon_kernels = {
+    .name = "neon",
+    .rgb_to_gray = neon_rgb_to_gray,
+    .downscale = neon_downscale,
+    .box_blur = neon_box_blur,
+    .update_background = neon_update_background,
+    .diff_sum = neon_diff_sum,
+    .diff_row = neon_diff_row,
+};
+
+#endif /* MOTION_KERNELS_NEON */
+
+// ---------------------------------------------------------------------------
+// Runtime selection
+// ---------------------------------------------------------------------------
+
+static const motion_kernels_t *selected_kernels = &scalar_kernels;
+static pthread_once_t select_once = PTHREAD_ONCE_INIT;
+
+static void select_kernels(void) {
+    const motion_kernels_t *available[4];
+    int count = motion_kernels_available(available, 4);
+    selected_kernels = available[count - 1];
+}
+
+const motion_kernels_t *motion_kernels_get(void) {
+    pthread_once(&select_once, select_kernels);
+    return selected_kernels;
+}
+
+const motion_kernels_t *motion_kernels_scalar(void) {
+    return &scalar_kernels;
+}
+
+int motion_kernels_available(const motion_kernels_t **out, int max) {
+    int count = 0;
+
+    if (!out || max <= 0) {
+        return 0;
+    }
+
+    out[count++] = &scalar_kernels;
+
+#ifdef MOTION_KERNELS_X86
+    __builtin_cpu_init();
+    if (count < max && __builtin_cpu_supports("sse2")) {
+        out[count++] = &sse2_kernels;
+    }
+    if (count < max && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("ssse3")) {
+        out[count++] = &avx2_kernels;
+    }
+#endif
+
+#ifdef MOTION_KERNELS_NEON
+    if (count < max) {
+        out[count++] = &neon_kernels;
+    }
+#endif
+
+    return count;
+}
@@ -182,6 +182,7 @@ static void *mp4_recording_thread(void *arg) {
 
     // Configure audio recording based on stream config BEFORE anything else uses the writer
     mp4_writer_set_audio(ctx->mp4_writer, ctx->config.record_audio ? 1 : 0);
+    mp4_writer_set_recording_format(ctx->mp4_writer, ctx->config.recording_format);
 
     // Set trigger type on the writer
     if (ctx->trigger_type[0] != '\0') {
@@ -32,8 +32,15 @@
 #include "video/mp4_writer.h"
 #include "video/mp4_writer_internal.h"
 #include "video/mp4_segment_recorder.h"
+#include "video/stream_ingest.h"
+#include "video/stream_protocol.h"
+#include "video/keyframe_index.h"
 #include "telemetry/stream_metrics.h"
 
+// Packets a shared-ingest recorder may fall behind the camera (a few GOPs)
+// before it drops to the next keyframe, e.g. while a segment is finalised
+#define MP4_RECORDER_INGEST_QUEUE_PACKETS 1024
+
 // DTS/PTS limits for MP4 format handling
 // MP4 containers use a signed 32-bit time scale; exceeding this can cause failures.
 #define MP4_DTS_MAX_VALUE         0x7fffffff
@@ -281,6 +288,8 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
     // Flag to track if trailer has been written (initialized here so cleanup can
     // always test it safely, even when entered via an early goto before the main loop)
     bool trailer_written = false;
+    // Keyframe wall-clock times for the recording's .kfi sidecar
+    keyframe_index_recorder_t *kf_index = NULL;
 
 
     // Track how long we've been waiting for the final keyframe to end a segment.
@@ -339,60 +348,64 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
         input_ctx->interrupt_callback.callback = interrupt_callback;
         input_ctx->interrupt_callback.opaque = shutdown_flag;
 
-        // Set up RTSP options for low latency
-        av_dict_set(&opts, "rtsp_transport", "tcp", 0);  // Use TCP for RTSP (more reliable than UDP)
-        // BUGFIX: Add genpts to regenerate presentation timestamps from the actual
-        // frame data.  When go2rtc proxies the RTSP stream, the original SDP
-        // framerate (e.g. 15fps) may not be propagated, causing FFmpeg to assume
-        // a wrong framerate and produce incorrect timestamps.  genpts fixes this
-        // by computing PTS from DTS and packet duration.
-        av_dict_set(&opts, "fflags", "nobuffer", 0);
-        av_dict_set(&opts, "fflags", "+genpts", AV_DICT_APPEND);
-        av_dict_set(&opts, "flags", "low_delay", 0);     // Low delay mode
-        av_dict_set(&opts, "max_delay", "500000", 0);    // Maximum delay of 500ms
-        av_dict_set(&opts, "stimeout", "5000000", 0);    // Socket timeout in microseconds (5 seconds)
-
-        // Set analyzeduration and probesize to help FFmpeg detect stream
-        // parameters from go2rtc's RTSP output.  Use the FFmpeg defaults (5s / 5MB)
-        // to give go2rtc enough time to connect to the upstream camera and start
-        // forwarding frames — the dead-recording timer issue is separately handled
-        // by updating last_packet_time during retries.
-        av_dict_set(&opts, "analyzeduration", "5000000", 0);  // 5 seconds (FFmpeg default)
-        av_dict_set(&opts, "probesize", "5242880", 0);        // 5 MB (5 * 1024 * 1024 bytes, FFmpeg default)
-
-        // Open input
-        log_info("Opening RTSP connection to %s (analyzeduration=5s, probesize=5MB)", rtsp_url);
-        ret = avformat_open_input(&input_ctx, rtsp_url, NULL, &opts);
-        if (ret < 0) {
-            char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
-            av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
-            if (ret == AVERROR_EXIT) {
-                log_warn("RTSP open interrupted (AVERROR_EXIT) for %s — "
-                         "thread shutdown was requested during connection", rtsp_url);
-            } else {
-                log_error("Failed to open RTSP input %s: %d (%s)", rtsp_url, ret, error_buf);
+        if (g_config.shared_ingest) {
+            // Share the camera connection with HLS and detection; the shared
+            // context already carries the probed stream layout
+            stream_ingest_consumer_config_t ingest_cfg = {
+                .queue_packets = MP4_RECORDER_INGEST_QUEUE_PACKETS,
+                .drop_policy = STREAM_INGEST_DROP_TO_KEYFRAME,
+            };
+            const char *ingest_name = segment_info_ptr->stream_name[0] != '\0'
+                                          ? segment_info_ptr->stream_name : output_file;
+            ret = stream_ingest_open_input(&input_ctx, ingest_name, rtsp_url, STREAM_PROTOCOL_TCP, &ingest_cfg);
+            if (ret < 0) {
+                char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
+                log_error("Failed to open shared input %s: %d (%s)", rtsp_url, ret, error_buf);
+                goto cleanup;
             }
+        } else {
+            // Set up RTSP options for low latency
+            av_dict_set(&opts, "rtsp_transport", "tcp", 0);  // Use TCP for RTSP (more reliable than UDP)
+            // Low delay, regenerated PTS (go2rtc may not pass the SDP framerate on)
+            // and a 5s / 5MB probe; the dead-recording timer issue is separately
+            // handled by updating last_packet_time during retries.
+            set_recording_input_options(&opts);
+
+            // Open input
+            log_info("Opening RTSP connection to %s (analyzeduration=5s, probesize=5MB)", rtsp_url);
+            ret = avformat_open_input(&input_ctx, rtsp_url, NULL, &opts);
+            if (ret < 0) {
+                char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
+                if (ret == AVERROR_EXIT) {
+                    log_warn("RTSP open interrupted (AVERROR_EXIT) for %s — "
+                             "thread shutdown was requested during connection", rtsp_url);
+                } else {
+                    log_error("Failed to open RTSP input %s: %d (%s)", rtsp_url, ret, error_buf);
+                }
 
-            // Ensure input_ctx is NULL after a failed open
-            if (input_ctx) {
-                avformat_free_context(input_ctx);
-                input_ctx = NULL;
-            }
+                // Ensure input_ctx is NULL after a failed open
+                if (input_ctx) {
+                    avformat_free_context(input_ctx);
+                    input_ctx = NULL;
+                }
 
-            // Don't quit, just return an error code so the caller can retry
-            goto cleanup;
-        }
+                // Don't quit, just return an error code so the caller can retry
+                goto cleanup;
+            }
 
-        // Find stream info
-        log_info("Probing stream info for %s ...", rtsp_url);
-        ret = avformat_find_stream_info(input_ctx, NULL);
-        if (ret < 0) {
-            char err_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
-            av_strerror(ret, err_buf, sizeof(err_buf));
-            log_error("Failed to find stream info for %s: %d (%s)", rtsp_url, ret, err_buf);
-            goto cleanup;
+            // Find stream info
+            log_info("Probing stream info for %s ...", rtsp_url);
+            ret = avformat_find_stream_info(input_ctx, NULL);
+            if (ret < 0) {
+                char err_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(ret, err_buf, sizeof(err_buf));
+                log_error("Failed to find stream info for %s: %d (%s)", rtsp_url, ret, err_buf);
+                goto cleanup;
+            }
+            log_info("Stream info detected for %s: %d streams", rtsp_url, input_ctx->nb_streams);
         }
-        log_info("Stream info detected for %s: %d streams", rtsp_url, input_ctx->nb_streams);
     }
 
     // Log input stream info
@@ -403,7 +416,7 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
         goto cleanup;
     }
 
-    log_debug("Input format: %s", input_ctx->iformat->name);
+    log_debug("Input format: %s", input_ctx->iformat ? input_ctx->iformat->name : "shared ingest");
     log_debug("Number of streams: %d", input_ctx->nb_streams);
 
     // Find video and audio streams
@@ -517,7 +530,7 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
                                     last_progress_log = now;
                                 }
 
-                                int probe_ret = av_read_frame(input_ctx, probe_pkt);
+                                int probe_ret = stream_ingest_read_frame(input_ctx, probe_pkt);
                                 if (probe_ret < 0) {
                                     if (probe_ret == AVERROR(EAGAIN)) {
                                         av_usleep(10000);
@@ -719,10 +732,18 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
         }
     }
 
-    // Use faststart to move moov atom to beginning for better compatibility
-    // This creates standard MP4 files that play in all applications
-    // The + prefix adds to existing flags rather than replacing them
-    av_dict_set(&out_opts, "movflags", "+faststart", 0);
+    if (segment_info_ptr->fragmented) {
+        // Fragmented MP4: an empty moov up front, then one moof/mdat fragment
+        // per keyframe.  The file is only ever appended to, so closing the
+        // segment does not rewrite it and a crash loses at most one fragment.
+        av_dict_set(&out_opts, "movflags", "+frag_keyframe+empty_moov+default_base_moof", 0);
+        av_dict_set(&out_opts, "flush_packets", "1", 0);
+    } else {
+        // Use faststart to move moov atom to beginning for better compatibility
+        // This creates standard MP4 files that play in all applications
+        // The + prefix adds to existing flags rather than replacing them
+        av_dict_set(&out_opts, "movflags", "+faststart", 0);
+    }
 
     // CRITICAL FIX: Validate output_file parameter before attempting to open
     if (!output_file || output_file[0] == '\0') {
@@ -851,6 +872,9 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
     pkt->size = 0;
     pkt->stream_index = -1;
 
+    // Without a collector the recording simply has no sidecar
+    kf_index = keyframe_index_recorder_create();
+
     // Start recording
     start_time = av_gettime();
     log_info("Recording started...");
@@ -913,10 +937,10 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
 				// Defensive: don't get stuck if we somehow stored an empty packet
 				av_packet_free(&segment_info_ptr->pending_video_keyframe);
 				segment_info_ptr->pending_video_keyframe = NULL;
-				ret = av_read_frame(input_ctx, pkt);
+				ret = stream_ingest_read_frame(input_ctx, pkt);
 			}
 		} else {
-			ret = av_read_frame(input_ctx, pkt);
+			ret = stream_ingest_read_frame(input_ctx, pkt);
 		}
 
 		if (ret < 0) {
@@ -1146,7 +1170,11 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
                     pkt->stream_index = out_video_stream->index;
 
                     // Write packet
+                    bool final_is_key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
                     ret = av_interleaved_write_frame(output_ctx, pkt);
+                    if (ret >= 0 && final_is_key) {
+                        keyframe_index_recorder_add(kf_index, av_gettime() / 1000);
+                    }
                     if (ret < 0) {
                         log_error("Error writing final video frame: %d", ret);
                         if (ret == AVERROR(ENOSPC) || ret == AVERROR(EIO)) {
@@ -1249,8 +1277,12 @@ int record_segment(const char *rtsp_url, const char *output_file, int duration,
             // Set output stream index
             pkt->stream_index = out_video_stream->index;
 
-            // Write packet
+            // Write packet (the muxer takes the packet's data, so note the flag first)
+            bool write_is_key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
             ret = av_interleaved_write_frame(output_ctx, pkt);
+            if (ret >= 0 && write_is_key) {
+                keyframe_index_recorder_add(kf_index, av_gettime() / 1000);
+            }
             if (ret < 0) {
                 char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
                 av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
@@ -1632,6 +1664,15 @@ cleanup:
         output_ctx = NULL;
     }
 
+    // The file is closed and its moov final: resolve keyframe offsets for the sidecar
+    if (kf_index) {
+        if (trailer_written && keyframe_index_recorder_finish(kf_index, output_file) != 0) {
+            log_debug("No keyframe index written for %s", output_file);
+        }
+        keyframe_index_recorder_free(kf_index);
+        kf_index = NULL;
+    }
+
     // CRITICAL FIX: Properly handle the input context to prevent memory leaks
     log_debug("Handling input context cleanup");
 
@@ -1859,7 +1900,15 @@ int mp4_segment_recorder_write_packet(mp4_writer_t *writer, const AVPacket *pkt,
     }
 
     // Write the packet to the output
+    bool is_video_key = input_stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO &&
+                        (out_pkt->flags & AV_PKT_FLAG_KEY);
     ret = av_interleaved_write_frame(writer->output_ctx, out_pkt);
+    if (ret >= 0 && is_video_key) {
+        if (!writer->keyframe_index) {
+            writer->keyframe_index = keyframe_index_recorder_create();
+        }
+        keyframe_index_recorder_add(writer->keyframe_index, av_gettime() / 1000);
+    }
     if (ret < 0) {
         char error_buf[AV_ERROR_MAX_STRING_SIZE] = {0};
         av_strerror(ret, error_buf, AV_ERROR_MAX_STRING_SIZE);
@@ -111,6 +111,23 @@ void mp4_writer_set_segment_duration(mp4_writer_t *writer, int segment_duration)
              segment_duration, writer->stream_name ? writer->stream_name : "unknown");
 }
 
+/**
+ * Select the container layout for new segments
+ */
+void mp4_writer_set_recording_format(mp4_writer_t *writer, const char *format) {
+    if (!writer) {
+        log_error("NULL writer passed to mp4_writer_set_recording_format");
+        return;
+    }
+
+    int fragmented = (format && strcmp(format, "fmp4") == 0) ? 1 : 0;
+    if (writer->fragmented != fragmented) {
+        writer->fragmented = fragmented;
+        log_info("Recording format for stream %s set to %s", writer->stream_name,
+                 fragmented ? "fragmented MP4" : "MP4 (faststart)");
+    }
+}
+
 /**
  * Get the actual end time of a recording based on its start time and video duration
  */
@@ -210,6 +227,14 @@ void mp4_writer_close(mp4_writer_t *writer) {
         writer->output_ctx = NULL;
     }
 
+    if (writer->keyframe_index) {
+        if (writer->is_initialized && writer->output_path[0] != '\0') {
+            keyframe_index_recorder_finish(writer->keyframe_index, writer->output_path);
+        }
+        keyframe_index_recorder_free(writer->keyframe_index);
+        writer->keyframe_index = NULL;
+    }
+
     /* ------------------------------------------------------------------ *
      * 4-6. Now that the file is closed: stat size, read actual duration, *
      *      then update the database with accurate values.                *
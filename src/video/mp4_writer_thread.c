@@ -105,6 +105,7 @@ static void *mp4_writer_rtsp_thread(void *arg) {
     thread_ctx->segment_info.segment_index = 0;
     thread_ctx->segment_info.has_audio = false;
     thread_ctx->segment_info.last_frame_was_key = false;
+    thread_ctx->segment_info.fragmented = false;
     thread_ctx->segment_info.pending_video_keyframe = NULL;
     memset(thread_ctx->segment_info.stream_name, 0, sizeof(thread_ctx->segment_info.stream_name));
     if (thread_ctx->writer && thread_ctx->writer->stream_name[0] != '\0') {
@@ -217,6 +218,10 @@ static void *mp4_writer_rtsp_thread(void *arg) {
                 }
             }
 
+            // Container layout only affects segments that have not been opened
+            // yet, so it can follow the database without a reconnect
+            mp4_writer_set_recording_format(thread_ctx->writer, db_stream_config.recording_format);
+
             // Update audio recording setting if it has changed
             int has_audio = db_stream_config.record_audio ? 1 : 0;
             if (thread_ctx->writer->has_audio != has_audio) {
@@ -429,6 +434,7 @@ static void *mp4_writer_rtsp_thread(void *arg) {
         // BUGFIX: Pass per-thread shutdown_requested flag so the FFmpeg interrupt callback
         // can interrupt blocking calls when this specific thread needs to be stopped
         // (e.g., during dead recording recovery), not just during global shutdown.
+        thread_ctx->segment_info.fragmented = thread_ctx->writer->fragmented != 0;
         time_t segment_start = time(NULL);
         ret = record_segment(thread_ctx->rtsp_url, thread_ctx->writer->output_path,
                            segment_duration, thread_ctx->writer->has_audio,
@@ -1379,9 +1379,15 @@ skip_audio_stream:
     av_dict_set(&writer->output_ctx->metadata, "title", writer->stream_name, 0);
     av_dict_set(&writer->output_ctx->metadata, "encoder", "LightNVR", 0);
 
-    // Set options for fast start - EXACTLY match rtsp_recorder.c
+    // Set options for fast start - EXACTLY match rtsp_recorder.c, unless the
+    // stream records fragmented MP4 (append-only, no rewrite on close)
     AVDictionary *opts = NULL;
-    av_dict_set(&opts, "movflags", "+faststart", 0);  // This is the ONLY option in rtsp_recorder.c
+    if (writer->fragmented) {
+        av_dict_set(&opts, "movflags", "+frag_keyframe+empty_moov+default_base_moof", 0);
+        av_dict_set(&opts, "flush_packets", "1", 0);
+    } else {
+        av_dict_set(&opts, "movflags", "+faststart", 0);  // This is the ONLY option in rtsp_recorder.c
+    }
 
     // Open output file
     ret = avio_open(&writer->output_ctx->pb, writer->output_path, AVIO_FLAG_WRITE);
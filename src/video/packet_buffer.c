@@ -14,6 +14,7 @@
 #include <errno.h>
 
 #include "video/packet_buffer.h"
+#include "video/packet_buffer_internal.h"
 #include "video/streams.h"
 #include "core/logger.h"
 #include "core/config.h"
@@ -24,6 +25,517 @@
 static packet_buffer_pool_t buffer_pool;
 static bool pool_initialized = false;
 
+/* ---- Memory accounting ---- */
+
+// Buffer and pool usage are read by the pool policy and the metrics API
+// without the buffer mutex, so they are only updated atomically.
+static void memory_add_locked(packet_buffer_t *buffer, size_t bytes) {
+    size_t usage = __atomic_add_fetch(&buffer->current_memory_usage, bytes, __ATOMIC_RELAXED);
+    if (usage > buffer->peak_memory_usage) {
+        buffer->peak_memory_usage = usage;
+    }
+    __atomic_add_fetch(&buffer_pool.current_memory_usage, bytes, __ATOMIC_RELAXED);
+}
+
+static void memory_sub_locked(packet_buffer_t *buffer, size_t bytes) {
+    __atomic_sub_fetch(&buffer->current_memory_usage, bytes, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&buffer_pool.current_memory_usage, bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * Budget this buffer must stay within, combining the pool's assignment with
+ * the per-buffer limit (0 = unlimited)
+ */
+static size_t effective_budget(const packet_buffer_t *buffer) {
+    size_t budget = __atomic_load_n(&buffer->memory_budget, __ATOMIC_RELAXED);
+    size_t limit = __atomic_load_n(&buffer->memory_limit, __ATOMIC_RELAXED);
+    if (limit > 0 && (budget == 0 || limit < budget)) {
+        budget = limit;
+    }
+    return budget;
+}
+
+/* ---- Pooled mode packet ring ---- */
+
+static bool is_pooled(const packet_buffer_t *buffer) {
+    return buffer->mode == BUFFER_MODE_MEMORY_POOLED;
+}
+
+/**
+ * Allocate the byte ring and metadata arrays for a pooled buffer
+ */
+static int ring_alloc(packet_buffer_t *buffer) {
+    packet_ring_t *ring = &buffer->ring;
+    size_t n = (size_t)buffer->max_packets;
+
+    ring->data = malloc(PACKET_RING_INITIAL_BYTES);
+    ring->capacity = PACKET_RING_INITIAL_BYTES;
+    ring->offset = calloc(n, sizeof(*ring->offset));
+    ring->size = calloc(n, sizeof(*ring->size));
+    ring->span = calloc(n, sizeof(*ring->span));
+    ring->pts = calloc(n, sizeof(*ring->pts));
+    ring->dts = calloc(n, sizeof(*ring->dts));
+    ring->duration = calloc(n, sizeof(*ring->duration));
+    ring->timestamp = calloc(n, sizeof(*ring->timestamp));
+    ring->stream_index = calloc(n, sizeof(*ring->stream_index));
+    ring->flags = calloc(n, sizeof(*ring->flags));
+    ring->side_data_pkt = calloc(n, sizeof(*ring->side_data_pkt));
+
+    if (!ring->data || !ring->offset || !ring->size || !ring->span || !ring->pts ||
+        !ring->dts || !ring->duration || !ring->timestamp || !ring->stream_index ||
+        !ring->flags || !ring->side_data_pkt) {
+        return -1;
+    }
+    memory_add_locked(buffer, ring->capacity);
+    return 0;
+}
+
+static void ring_free(packet_buffer_t *buffer) {
+    packet_ring_t *ring = &buffer->ring;
+
+    if (ring->side_data_pkt) {
+        for (int i = 0; i < buffer->max_packets; i++) {
+            av_packet_free(&ring->side_data_pkt[i]);
+        }
+    }
+
+    free(ring->data);
+    free(ring->offset);
+    free(ring->size);
+    free(ring->span);
+    free(ring->pts);
+    free(ring->dts);
+    free(ring->duration);
+    free(ring->timestamp);
+    free(ring->stream_index);
+    free(ring->flags);
+    free(ring->side_data_pkt);
+    memset(ring, 0, sizeof(*ring));
+}
+
+/**
+ * Largest byte ring the buffer's budget allows
+ *
+ * Pooled buffers are charged for the whole ring, so the ring never grows
+ * past the budget.
+ */
+static size_t ring_capacity_limit(const packet_buffer_t *buffer) {
+    size_t budget = effective_budget(buffer);
+    return budget == 0 || budget > PACKET_RING_MAX_BYTES ? PACKET_RING_MAX_BYTES : budget;
+}
+
+/**
+ * Reallocate the byte ring to new_capacity, compacting records in order
+ *
+ * new_capacity must hold every buffered record; 0 releases the ring of an
+ * empty buffer.  The pool is charged (or credited) the difference.
+ */
+static int ring_resize_locked(packet_buffer_t *buffer, size_t new_capacity) {
+    packet_ring_t *ring = &buffer->ring;
+
+    uint8_t *new_data = NULL;
+    if (new_capacity > 0) {
+        new_data = malloc(new_capacity);
+        if (!new_data) {
+            return -1;
+        }
+    }
+
+    size_t pos = 0;
+    for (int i = 0; i < buffer->count; i++) {
+        int idx = (buffer->tail + i) % buffer->max_packets;
+        memcpy(new_data + pos, ring->data + ring->offset[idx], ring->size[idx]);
+        ring->offset[idx] = pos;
+        ring->span[idx] = ring->size[idx];
+        pos += ring->size[idx];
+    }
+
+    free(ring->data);
+    if (new_capacity > ring->capacity) {
+        memory_add_locked(buffer, new_capacity - ring->capacity);
+    } else {
+        memory_sub_locked(buffer, ring->capacity - new_capacity);
+    }
+    log_debug("Resized packet ring for stream %s from %zu to %zu bytes",
+              buffer->stream_name, ring->capacity, new_capacity);
+
+    ring->data = new_data;
+    ring->capacity = new_capacity;
+    ring->head = new_capacity > 0 ? pos % new_capacity : 0;
+    ring->used = pos;
+    return 0;
+}
+
+/**
+ * Grow the byte ring to at least min_capacity, within the budget
+ *
+ * Only happens while a buffer warms up to its steady-state size (or after
+ * a spill released the ring).
+ */
+static int ring_grow_locked(packet_buffer_t *buffer, size_t min_capacity) {
+    packet_ring_t *ring = &buffer->ring;
+
+    // An empty ring may always hold one packet, just as an unpooled buffer
+    // keeps its newest packet whatever the budget
+    size_t limit = ring_capacity_limit(buffer);
+    if (buffer->count == 0 && limit < min_capacity) {
+        limit = min_capacity;
+    }
+
+    size_t new_capacity = ring->capacity ? ring->capacity : PACKET_RING_INITIAL_BYTES;
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    if (new_capacity > limit) {
+        new_capacity = limit;
+    }
+    if (new_capacity <= ring->capacity) {
+        return -1;
+    }
+    return ring_resize_locked(buffer, new_capacity);
+}
+
+/**
+ * Shrink the byte ring back within a budget that has dropped since it grew
+ *
+ * Must be called once the buffered records fit the new limit.
+ */
+static void ring_fit_budget_locked(packet_buffer_t *buffer) {
+    size_t limit = ring_capacity_limit(buffer);
+    if (buffer->ring.capacity > limit && buffer->ring.used <= limit) {
+        ring_resize_locked(buffer, limit);
+    }
+}
+
+/**
+ * Bytes a record of the given size needs at the current head, including the
+ * padding skipped when it does not fit before the end of the ring
+ */
+static size_t ring_needed_bytes(const packet_ring_t *ring, size_t size) {
+    size_t padding = ring->head + size > ring->capacity ? ring->capacity - ring->head : 0;
+    return padding + size;
+}
+
+/**
+ * Build a standalone AVPacket from a pooled slot
+ */
+static AVPacket *ring_make_packet(const packet_buffer_t *buffer, int idx) {
+    const packet_ring_t *ring = &buffer->ring;
+
+    if (ring->side_data_pkt[idx]) {
+        return av_packet_clone(ring->side_data_pkt[idx]);
+    }
+
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt) {
+        return NULL;
+    }
+    if (av_new_packet(pkt, (int)ring->size[idx]) < 0) {
+        av_packet_free(&pkt);
+        return NULL;
+    }
+
+    memcpy(pkt->data, ring->data + ring->offset[idx], ring->size[idx]);
+    pkt->pts = ring->pts[idx];
+    pkt->dts = ring->dts[idx];
+    pkt->duration = ring->duration[idx];
+    pkt->stream_index = ring->stream_index[idx];
+    pkt->flags = ring->flags[idx];
+    return pkt;
+}
+
+/* ---- Slot accessors shared by both storage layouts ---- */
+
+static time_t slot_timestamp(const packet_buffer_t *buffer, int idx) {
+    return is_pooled(buffer) ? buffer->ring.timestamp[idx] : buffer->packets[idx].timestamp;
+}
+
+static bool slot_is_keyframe(const packet_buffer_t *buffer, int idx) {
+    return is_pooled(buffer) ? (buffer->ring.flags[idx] & AV_PKT_FLAG_KEY) != 0
+                             : buffer->packets[idx].is_keyframe;
+}
+
+/**
+ * Release the oldest packet and advance the tail
+ *
+ * Must be called with buffer->mutex held and a non-empty buffer.
+ */
+static void evict_oldest_locked(packet_buffer_t *buffer) {
+    int idx = buffer->tail;
+
+    if (slot_is_keyframe(buffer, idx)) {
+        buffer->keyframe_count--;
+    }
+
+    if (is_pooled(buffer)) {
+        // The ring itself is what is charged to the pool, not its records
+        packet_ring_t *ring = &buffer->ring;
+        ring->used -= ring->span[idx];
+        if (ring->side_data_pkt[idx]) {
+            av_packet_free(&ring->side_data_pkt[idx]);
+        }
+    } else if (buffer->packets[idx].packet) {
+        memory_sub_locked(buffer, buffer->packets[idx].data_size);
+        av_packet_free(&buffer->packets[idx].packet);
+    }
+
+    buffer->tail = (buffer->tail + 1) % buffer->max_packets;
+    buffer->count--;
+
+    if (buffer->count == 0 && is_pooled(buffer)) {
+        // Empty: restart at the beginning so the next record never wraps
+        buffer->ring.head = 0;
+        buffer->ring.used = 0;
+    }
+}
+
+/**
+ * Drop every buffered packet
+ *
+ * Must be called with buffer->mutex held.
+ */
+static void clear_locked(packet_buffer_t *buffer) {
+    while (buffer->count > 0) {
+        evict_oldest_locked(buffer);
+    }
+
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->count = 0;
+    buffer->keyframe_count = 0;
+    if (is_pooled(buffer)) {
+        buffer->ring.head = 0;
+        buffer->ring.used = 0;
+    }
+}
+
+/**
+ * Store a packet in the slot at buffer->head (pooled mode)
+ *
+ * Makes room in the byte ring first, growing it during warm-up and evicting
+ * the oldest packets once it has reached PACKET_RING_MAX_BYTES.
+ * Must be called with buffer->mutex held and a free slot at head.
+ */
+static int ring_store_locked(packet_buffer_t *buffer, const AVPacket *packet, time_t timestamp) {
+    packet_ring_t *ring = &buffer->ring;
+    size_t size = (size_t)packet->size;
+
+    if (size > PACKET_RING_MAX_BYTES / 2) {
+        log_warn("Packet of %zu bytes too large for packet ring of stream %s", size, buffer->stream_name);
+        return -1;
+    }
+
+    if (ring->capacity == 0 && ring_grow_locked(buffer, size) != 0) {
+        return -1;
+    }
+    while (ring->capacity - ring->used < ring_needed_bytes(ring, size)) {
+        if (ring_grow_locked(buffer, ring->used + size) == 0) {
+            continue;
+        }
+        if (buffer->count == 0) {
+            return -1;
+        }
+        evict_oldest_locked(buffer);
+        buffer->total_packets_dropped++;
+    }
+
+    int idx = buffer->head;
+
+    // Packets carrying side data (e.g. new extradata) are rare; keep a clone
+    // so nothing is lost, and store the payload in the ring as usual
+    if (packet->side_data_elems > 0) {
+        ring->side_data_pkt[idx] = av_packet_clone(packet);
+        if (!ring->side_data_pkt[idx]) {
+            return -1;
+        }
+    }
+
+    size_t padding = ring->head + size > ring->capacity ? ring->capacity - ring->head : 0;
+    size_t offset = padding ? 0 : ring->head;
+
+    if (size > 0) {
+        memcpy(ring->data + offset, packet->data, size);
+    }
+    ring->offset[idx] = offset;
+    ring->size[idx] = (uint32_t)size;
+    ring->span[idx] = (uint32_t)(padding + size);
+    ring->pts[idx] = packet->pts;
+    ring->dts[idx] = packet->dts;
+    ring->duration[idx] = packet->duration;
+    ring->timestamp[idx] = timestamp;
+    ring->stream_index[idx] = packet->stream_index;
+    ring->flags[idx] = packet->flags;
+
+    ring->head = (offset + size) % ring->capacity;
+    ring->used += padding + size;
+
+    return 0;
+}
+
+/* ---- Admission control ---- */
+
+/**
+ * Update the estimate of how many bytes the full pre-roll window needs
+ *
+ * Based on the measured ingest rate rather than on what is buffered, so a
+ * buffer trimmed to a small budget still reports its real demand.
+ * Must be called with buffer->mutex held.
+ */
+static void update_demand_locked(packet_buffer_t *buffer, size_t size, time_t timestamp) {
+    if (buffer->rate_window_start == 0 || timestamp < buffer->rate_window_start) {
+        buffer->rate_window_start = timestamp;
+        buffer->rate_window_bytes = 0;
+    }
+    buffer->rate_window_bytes += size;
+
+    time_t elapsed = timestamp - buffer->rate_window_start;
+    if (elapsed < 1) {
+        return;
+    }
+
+    size_t rate = buffer->rate_window_bytes / (size_t)elapsed;
+    buffer->byte_rate = buffer->byte_rate ? (buffer->byte_rate * 3 + rate) / 4 : rate;
+    buffer->rate_window_start = timestamp;
+    buffer->rate_window_bytes = 0;
+
+    __atomic_store_n(&buffer->memory_demand, buffer->byte_rate * (size_t)buffer->buffer_seconds,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * Create the disk-backed buffer a spill moves into
+ *
+ * Creates and maps the backing file, so it is called without buffer->mutex
+ * held; spill_start_locked() then swaps it in.
+ */
+static struct pre_buffer_strategy *spill_create(const packet_buffer_t *buffer) {
+    return packet_buffer_spill_create(buffer->stream_name, buffer->buffer_seconds,
+                                      buffer->max_packets / buffer->buffer_seconds);
+}
+
+/**
+ * Move a buffer's packets to a disk-backed mmap buffer made by spill_create()
+ *
+ * Takes ownership of spill, which may be NULL if creating it failed.
+ * Must be called with buffer->mutex held.
+ */
+static int spill_start_locked(packet_buffer_t *buffer, struct pre_buffer_strategy *spill) {
+    buffer->spill = spill;
+    if (!buffer->spill) {
+        log_warn("[%s] Failed to create disk spill buffer, shrinking pre-buffer instead", buffer->stream_name);
+        return -1;
+    }
+
+    // Hand over what is already buffered so the memory is released now
+    for (int i = 0; i < buffer->count; i++) {
+        int idx = (buffer->tail + i) % buffer->max_packets;
+        if (is_pooled(buffer)) {
+            AVPacket *pkt = ring_make_packet(buffer, idx);
+            if (pkt) {
+                packet_buffer_spill_add(buffer->spill, pkt, buffer->ring.timestamp[idx]);
+                av_packet_free(&pkt);
+            }
+        } else if (buffer->packets[idx].packet) {
+            packet_buffer_spill_add(buffer->spill, buffer->packets[idx].packet, buffer->packets[idx].timestamp);
+        }
+    }
+    int moved = buffer->count;
+    clear_locked(buffer);
+    if (is_pooled(buffer)) {
+        // Nothing goes into the ring while spilled; give its memory back
+        ring_resize_locked(buffer, 0);
+    }
+
+    log_warn("[%s] Pre-buffer memory exhausted, spilled %d packets to disk", buffer->stream_name, moved);
+    return 0;
+}
+
+static void spill_stop_locked(packet_buffer_t *buffer) {
+    packet_buffer_spill_destroy(buffer->spill);
+    buffer->spill = NULL;
+    log_info("[%s] Pre-buffer back in memory", buffer->stream_name);
+}
+
+/**
+ * Start or retire the disk spill as the pool policy asks
+ *
+ * Once RAM is available again, new packets go back to memory and the spill
+ * is kept only while it still holds packets inside the pre-roll window.
+ * Must be called with buffer->mutex held.
+ *
+ * @param requested spill_requested as read when new_spill was prepared
+ * @param new_spill From spill_create() when requested and no spill was
+ *                  running; consumed in exactly that case
+ * @return true if the packet being added belongs in the spill buffer
+ */
+static bool spill_route_locked(packet_buffer_t *buffer, time_t timestamp, bool requested,
+                               struct pre_buffer_strategy *new_spill) {
+    if (requested && !buffer->spill && spill_start_locked(buffer, new_spill) != 0) {
+        // Keep shrinking in memory; the next rebalance asks again
+        __atomic_store_n(&buffer->spill_requested, false, __ATOMIC_RELAXED);
+        requested = false;
+    } else if (!requested && buffer->spill) {
+        int keyframes;
+        time_t oldest, newest;
+        if (packet_buffer_spill_stats(buffer->spill, &keyframes, &oldest, &newest) == 0 ||
+            timestamp - newest > (time_t)buffer->buffer_seconds) {
+            spill_stop_locked(buffer);
+        }
+    }
+
+    return requested && buffer->spill;
+}
+
+/**
+ * Packet count, keyframe count and time span across memory and any disk spill
+ *
+ * Must be called with buffer->mutex held.
+ *
+ * @return Number of buffered packets
+ */
+static int combined_stats_locked(const packet_buffer_t *buffer, int *keyframes, time_t *oldest, time_t *newest) {
+    int count = buffer->count;
+    *keyframes = buffer->keyframe_count;
+    *oldest = buffer->oldest_packet_time;
+    *newest = buffer->newest_packet_time;
+
+    int spill_keyframes;
+    time_t spill_oldest, spill_newest;
+    int spilled = buffer->spill
+                  ? packet_buffer_spill_stats(buffer->spill, &spill_keyframes, &spill_oldest, &spill_newest)
+                  : 0;
+    if (spilled > 0) {
+        if (count == 0) {
+            *newest = spill_newest;
+        }
+        *oldest = spill_oldest;
+        count += spilled;
+        *keyframes += spill_keyframes;
+    }
+    return count;
+}
+
+/**
+ * Recompute budgets if the pool is limited and the last rebalance is older
+ * than the interval
+ */
+static void maybe_rebalance(void) {
+    if (__atomic_load_n(&buffer_pool.total_memory_limit, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    time_t now = time(NULL);
+    time_t last = __atomic_load_n(&buffer_pool.last_rebalance, __ATOMIC_RELAXED);
+    if (now - last < PACKET_BUFFER_REBALANCE_INTERVAL) {
+        return;
+    }
+    // Only one ingest thread pays for the rebalance
+    if (__atomic_compare_exchange_n(&buffer_pool.last_rebalance, &last, now, false,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        packet_buffer_rebalance_pool();
+    }
+}
+
 /**
  * Initialize the packet buffer pool
  */
@@ -189,6 +701,8 @@ int reinit_packet_buffer_pool(size_t new_memory_limit_mb) {
 
     pthread_mutex_unlock(&buffer_pool.pool_mutex);
 
+    packet_buffer_rebalance_pool();
+
     log_info("Packet buffer pool memory limit updated: %zu MB -> %zu MB",
              old_limit_mb, new_memory_limit_mb);
     return 0;
@@ -241,18 +755,30 @@ packet_buffer_t* create_packet_buffer(const char *stream_name, int buffer_second
     safe_strcpy(buffer->stream_name, stream_name, sizeof(buffer->stream_name), 0);
     buffer->buffer_seconds = buffer_seconds;
     buffer->mode = mode;
+    buffer->priority = PACKET_BUFFER_DEFAULT_PRIORITY;
 
     // Estimate packet count (assume 15 FPS average)
     buffer->max_packets = packet_buffer_estimate_packet_count(15, buffer_seconds);
 
-    // Allocate packet array
-    buffer->packets = (buffered_packet_t *)calloc(buffer->max_packets, sizeof(buffered_packet_t));
-    if (!buffer->packets) {
-        log_error("Failed to allocate packet array for buffer");
-        pthread_mutex_destroy(&buffer->mutex);
-        buffer->mutex_initialized = false;
-        pthread_mutex_unlock(&buffer_pool.pool_mutex);
-        return NULL;
+    // Allocate packet storage
+    if (mode == BUFFER_MODE_MEMORY_POOLED) {
+        if (ring_alloc(buffer) != 0) {
+            log_error("Failed to allocate packet ring for buffer");
+            ring_free(buffer);
+            pthread_mutex_destroy(&buffer->mutex);
+            buffer->mutex_initialized = false;
+            pthread_mutex_unlock(&buffer_pool.pool_mutex);
+            return NULL;
+        }
+    } else {
+        buffer->packets = (buffered_packet_t *)calloc(buffer->max_packets, sizeof(buffered_packet_t));
+        if (!buffer->packets) {
+            log_error("Failed to allocate packet array for buffer");
+            pthread_mutex_destroy(&buffer->mutex);
+            buffer->mutex_initialized = false;
+            pthread_mutex_unlock(&buffer_pool.pool_mutex);
+            return NULL;
+        }
     }
 
     buffer->head = 0;
@@ -283,6 +809,8 @@ packet_buffer_t* create_packet_buffer(const char *stream_name, int buffer_second
     log_info("Created packet buffer for stream: %s (duration: %ds, max packets: %d, mode: %d)",
              stream_name, buffer_seconds, buffer->max_packets, mode);
 
+    packet_buffer_rebalance_pool();
+
     return buffer;
 }
 
@@ -300,6 +828,9 @@ void destroy_packet_buffer(packet_buffer_t *buffer) {
     }
 
     // Free all buffered packets
+    if (is_pooled(buffer)) {
+        ring_free(buffer);
+    }
     if (buffer->packets) {
         for (int i = 0; i < buffer->max_packets; i++) {
             if (buffer->packets[i].packet) {
@@ -315,10 +846,14 @@ void destroy_packet_buffer(packet_buffer_t *buffer) {
         fclose(buffer->disk_buffer_file);
         buffer->disk_buffer_file = NULL;
     }
+    if (buffer->spill) {
+        packet_buffer_spill_destroy(buffer->spill);
+        buffer->spill = NULL;
+    }
 
     // Update pool statistics
     pthread_mutex_lock(&buffer_pool.pool_mutex);
-    buffer_pool.current_memory_usage -= buffer->current_memory_usage;
+    memory_sub_locked(buffer, buffer->current_memory_usage);
     buffer_pool.active_buffers--;
     pthread_mutex_unlock(&buffer_pool.pool_mutex);
 
@@ -334,6 +869,9 @@ void destroy_packet_buffer(packet_buffer_t *buffer) {
     }
 
     log_info("Destroyed packet buffer for stream: %s", stream_name_copy);
+
+    // Hand the released memory to the remaining buffers
+    packet_buffer_rebalance_pool();
 }
 
 /**
@@ -346,19 +884,44 @@ int packet_buffer_add_packet(packet_buffer_t *buffer, const AVPacket *packet, ti
 
     pthread_mutex_lock(&buffer->mutex);
 
+    // Creating the spill file is disk I/O: do it with the buffer unlocked so
+    // readers are not held up, then swap it in below
+    bool spill_requested = __atomic_load_n(&buffer->spill_requested, __ATOMIC_RELAXED);
+    struct pre_buffer_strategy *new_spill = NULL;
+    if (spill_requested && !buffer->spill) {
+        pthread_mutex_unlock(&buffer->mutex);
+        new_spill = spill_create(buffer);
+        pthread_mutex_lock(&buffer->mutex);
+
+        // Another writer for the same stream got there first
+        if (new_spill && buffer->spill) {
+            pthread_mutex_unlock(&buffer->mutex);
+            packet_buffer_spill_destroy(new_spill);
+            new_spill = NULL;
+            pthread_mutex_lock(&buffer->mutex);
+        }
+    }
+
+    // The pool has no RAM left for this stream's minimum pre-roll: buffer on disk
+    if (spill_route_locked(buffer, timestamp, spill_requested, new_spill)) {
+        int ret = packet_buffer_spill_add(buffer->spill, packet, timestamp);
+        if (ret == 0) {
+            buffer->total_bytes_buffered += packet->size;
+            buffer->total_packets_buffered++;
+        }
+        update_demand_locked(buffer, (size_t)packet->size, timestamp);
+        pthread_mutex_unlock(&buffer->mutex);
+        maybe_rebalance();
+        return ret;
+    }
+
     // Time-based eviction: remove packets older than buffer_seconds regardless of FPS.
     // This ensures the pre-buffer never exceeds the configured window even when the
     // stream runs at a much lower FPS than the 15 fps assumed by max_packets estimation.
     while (buffer->count > 0) {
-        time_t oldest = buffer->packets[buffer->tail].timestamp;
+        time_t oldest = slot_timestamp(buffer, buffer->tail);
         if ((timestamp - oldest) > (time_t)buffer->buffer_seconds) {
-            if (buffer->packets[buffer->tail].packet) {
-                buffer->current_memory_usage -= buffer->packets[buffer->tail].data_size;
-                av_packet_free(&buffer->packets[buffer->tail].packet);
-                buffer->packets[buffer->tail].packet = NULL;
-            }
-            buffer->tail = (buffer->tail + 1) % buffer->max_packets;
-            buffer->count--;
+            evict_oldest_locked(buffer);
             buffer->total_packets_dropped++;
         } else {
             break;
@@ -368,38 +931,58 @@ int packet_buffer_add_packet(packet_buffer_t *buffer, const AVPacket *packet, ti
     // Fallback: if buffer is still full (burst of packets within the time window),
     // evict the oldest by packet count to guarantee a free slot.
     if (buffer->count >= buffer->max_packets) {
-        if (buffer->packets[buffer->tail].packet) {
-            buffer->current_memory_usage -= buffer->packets[buffer->tail].data_size;
-            av_packet_free(&buffer->packets[buffer->tail].packet);
-            buffer->packets[buffer->tail].packet = NULL;
-        }
-        buffer->tail = (buffer->tail + 1) % buffer->max_packets;
-        buffer->count--;
+        evict_oldest_locked(buffer);
         buffer->total_packets_dropped++;
     }
 
-    // Clone the packet
-    AVPacket *cloned_packet = av_packet_clone(packet);
-    if (!cloned_packet) {
-        log_error("Failed to clone packet for buffer");
-        pthread_mutex_unlock(&buffer->mutex);
-        return -1;
+    // Stay within the budget assigned by the pool by shortening the pre-roll
+    // from the oldest end, so one busy stream cannot starve the others.
+    // A pooled buffer is charged for its whole ring: its records must fit the
+    // budget, and a ring grown under a larger budget is shrunk to the new one.
+    size_t budget = effective_budget(buffer);
+    while (budget > 0 && buffer->count > 0 &&
+           (is_pooled(buffer) ? buffer->ring.used : buffer->current_memory_usage) +
+           (size_t)packet->size > budget) {
+        evict_oldest_locked(buffer);
+        buffer->total_packets_dropped++;
+        __atomic_add_fetch(&buffer->total_packets_shed, 1, __ATOMIC_RELAXED);
+    }
+    if (is_pooled(buffer)) {
+        ring_fit_budget_locked(buffer);
+
+        // Copy into the byte ring: no per-packet allocation
+        if (ring_store_locked(buffer, packet, timestamp) != 0) {
+            log_error("Failed to store packet in packet ring for stream %s", buffer->stream_name);
+            pthread_mutex_unlock(&buffer->mutex);
+            return -1;
+        }
+    } else {
+        // Clone the packet
+        AVPacket *cloned_packet = av_packet_clone(packet);
+        if (!cloned_packet) {
+            log_error("Failed to clone packet for buffer");
+            pthread_mutex_unlock(&buffer->mutex);
+            return -1;
+        }
+
+        // Store packet in buffer
+        buffered_packet_t *slot = &buffer->packets[buffer->head];
+        slot->packet = cloned_packet;
+        slot->timestamp = timestamp;
+        slot->pts = packet->pts;
+        slot->dts = packet->dts;
+        slot->stream_index = packet->stream_index;
+        slot->is_keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        slot->data_size = packet->size;
     }
 
-    // Store packet in buffer
-    buffered_packet_t *slot = &buffer->packets[buffer->head];
-    slot->packet = cloned_packet;
-    slot->timestamp = timestamp;
-    slot->pts = packet->pts;
-    slot->dts = packet->dts;
-    slot->stream_index = packet->stream_index;
-    slot->is_keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
-    slot->data_size = packet->size;
+    if (packet->flags & AV_PKT_FLAG_KEY) {
+        buffer->keyframe_count++;
+    }
 
     // Update statistics
-    buffer->current_memory_usage += packet->size;
-    if (buffer->current_memory_usage > buffer->peak_memory_usage) {
-        buffer->peak_memory_usage = buffer->current_memory_usage;
+    if (!is_pooled(buffer)) {
+        memory_add_locked(buffer, (size_t)packet->size);
     }
     buffer->total_bytes_buffered += packet->size;
     buffer->total_packets_buffered++;
@@ -408,7 +991,7 @@ int packet_buffer_add_packet(packet_buffer_t *buffer, const AVPacket *packet, ti
     if (buffer->count == 0) {
         buffer->oldest_packet_time = timestamp;
     } else {
-        buffer->oldest_packet_time = buffer->packets[buffer->tail].timestamp;
+        buffer->oldest_packet_time = slot_timestamp(buffer, buffer->tail);
     }
     buffer->newest_packet_time = timestamp;
 
@@ -416,8 +999,12 @@ int packet_buffer_add_packet(packet_buffer_t *buffer, const AVPacket *packet, ti
     buffer->head = (buffer->head + 1) % buffer->max_packets;
     buffer->count++;
 
+    update_demand_locked(buffer, (size_t)packet->size, timestamp);
+
     pthread_mutex_unlock(&buffer->mutex);
 
+    maybe_rebalance();
+
     return 0;
 }
 
@@ -437,7 +1024,11 @@ int packet_buffer_peek_oldest(packet_buffer_t *buffer, AVPacket **packet) {
     }
 
     // Clone the oldest packet
-    *packet = av_packet_clone(buffer->packets[buffer->tail].packet);
+    if (is_pooled(buffer)) {
+        *packet = ring_make_packet(buffer, buffer->tail);
+    } else {
+        *packet = av_packet_clone(buffer->packets[buffer->tail].packet);
+    }
 
     pthread_mutex_unlock(&buffer->mutex);
 
@@ -460,19 +1051,24 @@ int packet_buffer_pop_oldest(packet_buffer_t *buffer, AVPacket **packet) {
     }
 
     // Transfer ownership of the packet
-    *packet = buffer->packets[buffer->tail].packet;
-    buffer->packets[buffer->tail].packet = NULL;
-
-    // Update statistics
-    buffer->current_memory_usage -= buffer->packets[buffer->tail].data_size;
+    if (is_pooled(buffer)) {
+        *packet = ring_make_packet(buffer, buffer->tail);
+        if (!*packet) {
+            pthread_mutex_unlock(&buffer->mutex);
+            return -1;
+        }
+    } else {
+        *packet = buffer->packets[buffer->tail].packet;
+        buffer->packets[buffer->tail].packet = NULL;
+        memory_sub_locked(buffer, buffer->packets[buffer->tail].data_size);
+    }
 
-    // Advance tail
-    buffer->tail = (buffer->tail + 1) % buffer->max_packets;
-    buffer->count--;
+    // Update statistics and advance tail (the slot no longer owns a packet)
+    evict_oldest_locked(buffer);
 
     // Update oldest packet time
     if (buffer->count > 0) {
-        buffer->oldest_packet_time = buffer->packets[buffer->tail].timestamp;
+        buffer->oldest_packet_time = slot_timestamp(buffer, buffer->tail);
     }
 
     pthread_mutex_unlock(&buffer->mutex);
@@ -495,8 +1091,48 @@ int packet_buffer_flush(packet_buffer_t *buffer,
     int flushed_count = 0;
     int current_count = buffer->count;
 
+    // Anything spilled to disk is older than what is in memory
+    if (buffer->spill) {
+        flushed_count += packet_buffer_spill_flush(buffer->spill, callback, user_data);
+        if (!__atomic_load_n(&buffer->spill_requested, __ATOMIC_RELAXED)) {
+            spill_stop_locked(buffer);
+        }
+    }
+
     // Process all packets in order (oldest to newest)
-    for (int i = 0; i < current_count; i++) {
+    if (is_pooled(buffer)) {
+        // One packet struct for the whole flush; each record gets a fresh
+        // buffer so callbacks may still take their own reference
+        AVPacket *pkt = av_packet_alloc();
+        for (int i = 0; pkt && i < current_count; i++) {
+            int index = (buffer->tail + i) % buffer->max_packets;
+            const packet_ring_t *ring = &buffer->ring;
+            int result;
+
+            if (ring->side_data_pkt[index]) {
+                result = callback(ring->side_data_pkt[index], user_data);
+            } else {
+                if (av_new_packet(pkt, (int)ring->size[index]) < 0) {
+                    break;
+                }
+                memcpy(pkt->data, ring->data + ring->offset[index], ring->size[index]);
+                pkt->pts = ring->pts[index];
+                pkt->dts = ring->dts[index];
+                pkt->duration = ring->duration[index];
+                pkt->stream_index = ring->stream_index[index];
+                pkt->flags = ring->flags[index];
+                result = callback(pkt, user_data);
+                av_packet_unref(pkt);
+            }
+            if (result == 0) {
+                flushed_count++;
+            }
+        }
+        av_packet_free(&pkt);
+        clear_locked(buffer);
+    }
+
+    for (int i = 0; !is_pooled(buffer) && i < current_count; i++) {
         int index = (buffer->tail + i) % buffer->max_packets;
 
         if (buffer->packets[index].packet) {
@@ -507,7 +1143,7 @@ int packet_buffer_flush(packet_buffer_t *buffer,
             }
 
             // Free the packet
-            buffer->current_memory_usage -= buffer->packets[index].data_size;
+            memory_sub_locked(buffer, buffer->packets[index].data_size);
             av_packet_free(&buffer->packets[index].packet);
             buffer->packets[index].packet = NULL;
         }
@@ -517,6 +1153,7 @@ int packet_buffer_flush(packet_buffer_t *buffer,
     buffer->head = 0;
     buffer->tail = 0;
     buffer->count = 0;
+    buffer->keyframe_count = 0;
 
     pthread_mutex_unlock(&buffer->mutex);
 
@@ -536,19 +1173,11 @@ void packet_buffer_clear(packet_buffer_t *buffer) {
     pthread_mutex_lock(&buffer->mutex);
 
     // Free all packets
-    for (int i = 0; i < buffer->max_packets; i++) {
-        if (buffer->packets[i].packet) {
-            buffer->current_memory_usage -= buffer->packets[i].data_size;
-            av_packet_free(&buffer->packets[i].packet);
-            buffer->packets[i].packet = NULL;
-        }
+    clear_locked(buffer);
+    if (buffer->spill) {
+        packet_buffer_spill_clear(buffer->spill);
     }
 
-    // Reset buffer
-    buffer->head = 0;
-    buffer->tail = 0;
-    buffer->count = 0;
-
     pthread_mutex_unlock(&buffer->mutex);
 
     log_debug("Cleared buffer for stream: %s", buffer->stream_name);
@@ -564,16 +1193,20 @@ int packet_buffer_get_stats(packet_buffer_t *buffer, int *count, size_t *memory_
 
     pthread_mutex_lock(&buffer->mutex);
 
+    int keyframes;
+    time_t oldest, newest;
+    int total = combined_stats_locked(buffer, &keyframes, &oldest, &newest);
+
     if (count) {
-        *count = buffer->count;
+        *count = total;
     }
 
     if (memory_usage) {
         *memory_usage = buffer->current_memory_usage;
     }
 
-    if (duration && buffer->count > 0) {
-        *duration = (int)(buffer->newest_packet_time - buffer->oldest_packet_time);
+    if (duration && total > 0) {
+        *duration = (int)(newest - oldest);
     } else if (duration) {
         *duration = 0;
     }
@@ -616,8 +1249,10 @@ bool packet_buffer_is_ready(packet_buffer_t *buffer) {
     pthread_mutex_lock(&buffer->mutex);
 
     bool ready = false;
-    if (buffer->count > 0) {
-        int duration = (int)(buffer->newest_packet_time - buffer->oldest_packet_time);
+    int keyframes;
+    time_t oldest, newest;
+    if (combined_stats_locked(buffer, &keyframes, &oldest, &newest) > 0) {
+        int duration = (int)(newest - oldest);
         ready = (duration >= buffer->buffer_seconds);
     }
 
@@ -636,13 +1271,9 @@ int packet_buffer_get_keyframe_count(packet_buffer_t *buffer) {
 
     pthread_mutex_lock(&buffer->mutex);
 
-    int keyframe_count = 0;
-    for (int i = 0; i < buffer->count; i++) {
-        int index = (buffer->tail + i) % buffer->max_packets;
-        if (buffer->packets[index].is_keyframe) {
-            keyframe_count++;
-        }
-    }
+    int keyframe_count;
+    time_t oldest, newest;
+    combined_stats_locked(buffer, &keyframe_count, &oldest, &newest);
 
     pthread_mutex_unlock(&buffer->mutex);
 
@@ -657,26 +1288,194 @@ int packet_buffer_set_memory_limit(packet_buffer_t *buffer, size_t limit_mb) {
         return -1;
     }
 
-    // This is a placeholder for future implementation
-    // Currently, memory is managed at the pool level
+    __atomic_store_n(&buffer->memory_limit, limit_mb * 1024 * 1024, __ATOMIC_RELAXED);
     log_info("Memory limit set to %zu MB for buffer: %s", limit_mb, buffer->stream_name);
 
+    packet_buffer_rebalance_pool();
     return 0;
 }
 
 /**
- * Get total memory usage
+ * Set buffer priority
  */
-size_t packet_buffer_get_total_memory_usage(void) {
+int packet_buffer_set_priority(packet_buffer_t *buffer, int priority) {
+    if (!buffer || !buffer->active) {
+        return -1;
+    }
+
+    if (priority < 1) priority = 1;
+    if (priority > 10) priority = 10;
+
+    __atomic_store_n(&buffer->priority, priority, __ATOMIC_RELAXED);
+    log_debug("Priority set to %d for buffer: %s", priority, buffer->stream_name);
+
+    packet_buffer_rebalance_pool();
+    return 0;
+}
+
+/**
+ * Recompute per-buffer budgets
+ *
+ * Runs under pool_mutex only.  Per-buffer fields shared with ingest threads
+ * are accessed atomically, so no buffer mutex is taken and ingest never
+ * waits on another stream.  Buffers apply a smaller budget by trimming
+ * their oldest packets on the next add.
+ */
+void packet_buffer_rebalance_pool(void) {
     if (!pool_initialized) {
+        return;
+    }
+
+    pthread_mutex_lock(&buffer_pool.pool_mutex);
+
+    size_t limit = buffer_pool.total_memory_limit;
+    int order[MAX_STREAMS];
+    size_t demand[MAX_STREAMS];
+    size_t floor_bytes[MAX_STREAMS];
+    int n = 0;
+
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        packet_buffer_t *b = &buffer_pool.buffers[i];
+        if (!b->active) {
+            continue;
+        }
+        if (limit == 0) {
+            __atomic_store_n(&b->memory_budget, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&b->spill_requested, false, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        size_t d = __atomic_load_n(&b->memory_demand, __ATOMIC_RELAXED);
+        size_t cap = __atomic_load_n(&b->memory_limit, __ATOMIC_RELAXED);
+        if (cap > 0 && d > cap) {
+            d = cap;
+        }
+        int min_seconds = b->buffer_seconds < PACKET_BUFFER_MIN_PREROLL_SECONDS
+                          ? b->buffer_seconds : PACKET_BUFFER_MIN_PREROLL_SECONDS;
+
+        demand[i] = d;
+        floor_bytes[i] = d / (size_t)b->buffer_seconds * (size_t)min_seconds;
+
+        // Insertion sort by priority, highest first; ties keep slot order
+        int prio = __atomic_load_n(&b->priority, __ATOMIC_RELAXED);
+        int j = n++;
+        while (j > 0 && __atomic_load_n(&buffer_pool.buffers[order[j - 1]].priority, __ATOMIC_RELAXED) < prio) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    // Grant every buffer its minimum pre-roll, highest priority first; those
+    // that no longer fit in RAM are asked to spill to disk
+    size_t remaining = limit;
+    size_t budget[MAX_STREAMS];
+    bool spill[MAX_STREAMS];
+    for (int k = 0; k < n; k++) {
+        int i = order[k];
+        budget[i] = floor_bytes[i];
+        spill[i] = floor_bytes[i] > remaining;
+        if (!spill[i]) {
+            remaining -= floor_bytes[i];
+        }
+    }
+
+    // Hand out the rest up to each buffer's demand, highest priority first
+    for (int k = 0; k < n && remaining > 0; k++) {
+        int i = order[k];
+        if (spill[i]) {
+            continue;
+        }
+        size_t extra = demand[i] - floor_bytes[i];
+        if (extra > remaining) {
+            extra = remaining;
+        }
+        budget[i] += extra;
+        remaining -= extra;
+    }
+
+    // Buffers without a demand estimate yet (new or idle) share what is left
+    // until the next rebalance has measured them
+    int unmeasured = 0;
+    for (int k = 0; k < n; k++) {
+        if (demand[order[k]] == 0) {
+            unmeasured++;
+        }
+    }
+    size_t unmeasured_share = unmeasured > 0 ? remaining / (size_t)unmeasured : 0;
+
+    for (int k = 0; k < n; k++) {
+        int i = order[k];
+        packet_buffer_t *b = &buffer_pool.buffers[i];
+
+        if (demand[i] == 0) {
+            budget[i] = unmeasured_share;
+        }
+        if (budget[i] == 0) {
+            budget[i] = 1;
+        }
+
+        bool was_spilled = __atomic_load_n(&b->spill_requested, __ATOMIC_RELAXED);
+        if (spill[i] != was_spilled) {
+            log_info("[%s] Pre-buffer %s (priority %d, pool limit %zu MB)", b->stream_name,
+                     spill[i] ? "marked for disk spill" : "returned to memory",
+                     __atomic_load_n(&b->priority, __ATOMIC_RELAXED), limit / ((size_t)1024 * 1024));
+        }
+        __atomic_store_n(&b->memory_budget, budget[i], __ATOMIC_RELAXED);
+        __atomic_store_n(&b->spill_requested, spill[i], __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&buffer_pool.pool_mutex);
+}
+
+/**
+ * Snapshot admission control state
+ */
+int packet_buffer_get_budgets(packet_buffer_budget_t *budgets, int max_budgets, size_t *memory_limit) {
+    if (memory_limit) {
+        *memory_limit = 0;
+    }
+    if (!pool_initialized || !budgets || max_budgets <= 0) {
         return 0;
     }
 
     pthread_mutex_lock(&buffer_pool.pool_mutex);
-    size_t total = buffer_pool.current_memory_usage;
+
+    if (memory_limit) {
+        *memory_limit = buffer_pool.total_memory_limit;
+    }
+
+    int n = 0;
+    for (int i = 0; i < MAX_STREAMS && n < max_budgets; i++) {
+        packet_buffer_t *b = &buffer_pool.buffers[i];
+        if (!b->active) {
+            continue;
+        }
+
+        packet_buffer_budget_t *out = &budgets[n++];
+        safe_strcpy(out->stream_name, b->stream_name, sizeof(out->stream_name), 0);
+        out->priority = __atomic_load_n(&b->priority, __ATOMIC_RELAXED);
+        out->memory_usage = __atomic_load_n(&b->current_memory_usage, __ATOMIC_RELAXED);
+        out->memory_budget = effective_budget(b);
+        out->memory_demand = __atomic_load_n(&b->memory_demand, __ATOMIC_RELAXED);
+        out->spilled = __atomic_load_n(&b->spill_requested, __ATOMIC_RELAXED);
+        out->packets_shed = __atomic_load_n(&b->total_packets_shed, __ATOMIC_RELAXED);
+    }
+
     pthread_mutex_unlock(&buffer_pool.pool_mutex);
 
-    return total;
+    return n;
+}
+
+/**
+ * Get total memory usage
+ */
+size_t packet_buffer_get_total_memory_usage(void) {
+    if (!pool_initialized) {
+        return 0;
+    }
+
+    return __atomic_load_n(&buffer_pool.current_memory_usage, __ATOMIC_RELAXED);
 }
 
 /**
@@ -689,7 +1488,11 @@ int packet_buffer_set_disk_fallback(packet_buffer_t *buffer, bool enable, const
 
     pthread_mutex_lock(&buffer->mutex);
 
-    if (enable) {
+    if (is_pooled(buffer)) {
+        // Storage layout is fixed at creation; pooled buffers spill through
+        // the pool's admission control instead
+        log_info("Disk fallback for pooled buffer %s is managed by the pool", buffer->stream_name);
+    } else if (enable) {
         buffer->mode = BUFFER_MODE_HYBRID;
         if (disk_path) {
             safe_strcpy(buffer->disk_buffer_path, disk_path, sizeof(buffer->disk_buffer_path), 0);
@@ -0,0 +1,65 @@
+/**
+ * Packet Buffer Disk Spill
+ *
+ * Thin wrappers around the mmap pre-detection strategy, used by the packet
+ * buffer pool when RAM cannot hold a stream's minimum pre-roll.
+ */
+
+#include <string.h>
+
+#include "video/packet_buffer_internal.h"
+#include "video/pre_detection_buffer.h"
+#include "core/logger.h"
+
+pre_buffer_strategy_t *packet_buffer_spill_create(const char *stream_name, int buffer_seconds,
+                                                  int estimated_fps) {
+    buffer_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.buffer_seconds = buffer_seconds;
+    config.estimated_fps = estimated_fps;
+    config.storage_path = NULL;             // Global storage path
+    config.prefer_keyframe_alignment = false; // Same as an in-memory flush
+
+    return create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, stream_name, &config);
+}
+
+void packet_buffer_spill_destroy(pre_buffer_strategy_t *spill) {
+    destroy_buffer_strategy(spill);
+}
+
+int packet_buffer_spill_add(pre_buffer_strategy_t *spill, const AVPacket *packet, time_t timestamp) {
+    if (!spill || !spill->add_packet) {
+        return -1;
+    }
+    return spill->add_packet(spill, packet, timestamp);
+}
+
+int packet_buffer_spill_flush(pre_buffer_strategy_t *spill,
+                              int (*callback)(const AVPacket *packet, void *user_data),
+                              void *user_data) {
+    if (!spill || !spill->flush_to_callback) {
+        return 0;
+    }
+
+    int flushed = spill->flush_to_callback(spill, callback, user_data);
+    spill->clear(spill);
+    return flushed > 0 ? flushed : 0;
+}
+
+void packet_buffer_spill_clear(pre_buffer_strategy_t *spill) {
+    if (spill && spill->clear) {
+        spill->clear(spill);
+    }
+}
+
+int packet_buffer_spill_stats(pre_buffer_strategy_t *spill, int *keyframes, time_t *oldest, time_t *newest) {
+    buffer_stats_t stats;
+    if (!spill || !spill->get_stats || spill->get_stats(spill, &stats) != 0) {
+        return 0;
+    }
+
+    *keyframes = stats.keyframe_count;
+    *oldest = stats.oldest_timestamp;
+    *newest = stats.newest_timestamp;
+    return stats.packet_count;
+}
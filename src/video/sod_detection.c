@@ -256,6 +256,11 @@ detection_model_t load_sod_model(const char *model_path, float threshold) {
     // Use static linking
     sod_cnn_config(cnn_model, SOD_CNN_DETECTION_THRESHOLD, threshold);
 
+    // Size the worker pool shared by every SOD model in the process
+    if (sod_cnn_config(cnn_model, SOD_CNN_THREADS, g_config.sod_threads) != 0) {
+        log_warn("Failed to start SOD worker threads, running detection single-threaded");
+    }
+
     // Create model structure
     model_t *model = (model_t *)malloc(sizeof(model_t));
     if (!model) {
@@ -0,0 +1,734 @@
+/**
+ * Per-stream shared ingest
+ *
+ * One ingest thread per source URL owns the only demuxer for that camera and
+ * fans every packet out to its consumers.  Each consumer has a bounded
+ * single-producer/single-consumer ring of packet references; the ingest
+ * thread never waits on a consumer, it drops according to the consumer's
+ * policy instead.
+ *
+ * A consumer's AVFormatContext carries a copy of the source's stream
+ * parameters and a placeholder AVIOContext whose io_close2 hook releases
+ * the subscription, so the existing avformat_close_input() and
+ * safe_avformat_cleanup() call sites need no changes.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/time.h>
+
+#include "video/stream_ingest.h"
+#include "video/stream_ingest_internal.h"
+#include "video/stream_protocol.h"
+#include "core/config.h"
+#include "core/logger.h"
+#include "core/shutdown_coordinator.h"
+#include "core/url_utils.h"
+#include "utils/strings.h"
+
+// How long stream_ingest_open_input() waits for the source to connect
+#define INGEST_OPEN_TIMEOUT_MS 15000
+
+// How long stream_ingest_read_frame() waits for a packet before giving up;
+// the ingest thread's own read timeout normally reports a dead source first
+#define INGEST_READ_TIMEOUT_MS 10000
+
+// Longest single wait, so interrupt callbacks are polled regularly
+#define INGEST_POLL_MS 100
+
+#define INGEST_MAX_STREAMS 8
+#define INGEST_MAX_QUEUE_PACKETS 4096
+#define INGEST_RECONNECT_MIN_MS 500
+#define INGEST_RECONNECT_MAX_MS 5000
+#define INGEST_PB_BUFFER_SIZE 64
+
+struct stream_ingest_queue {
+    AVPacket **slots;
+    unsigned int capacity;              // Power of two
+    unsigned int mask;
+
+    atomic_uint head;                   // Next slot the producer fills
+    atomic_uint tail;                   // Next slot the consumer takes
+
+    stream_ingest_drop_policy_t drop_policy;
+    bool waiting_for_keyframe;          // Producer only
+    atomic_bool lost;
+
+    sem_t ready;                        // Posted for every queued packet and on loss
+
+    atomic_uint_fast64_t delivered;
+    atomic_uint_fast64_t dropped;
+};
+
+typedef struct ingest_stream_params {
+    AVCodecParameters *codecpar;
+    AVRational time_base;
+    AVRational avg_frame_rate;
+    AVRational r_frame_rate;
+    int64_t start_time;
+    int id;
+} ingest_stream_params_t;
+
+typedef struct ingest_consumer {
+    struct ingest_source *source;
+    stream_ingest_queue_t *queue;
+    struct ingest_consumer *next;
+} ingest_consumer_t;
+
+typedef struct ingest_source {
+    char url[MAX_URL_LENGTH];
+    char stream_name[MAX_STREAM_NAME];
+    int protocol;
+
+    pthread_t thread;
+    atomic_bool running;
+    int refs;                           // Consumers plus opens in progress; guarded by sources_mutex
+
+    pthread_mutex_t mutex;              // Guards everything below
+    pthread_cond_t connected_cond;
+    bool connected;
+    ingest_consumer_t *consumers;
+    int consumer_count;
+    int nb_streams;
+    ingest_stream_params_t streams[INGEST_MAX_STREAMS];
+    int64_t start_time;
+
+    struct ingest_source *next;
+} ingest_source_t;
+
+static ingest_source_t *sources = NULL;
+static pthread_mutex_t sources_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* ----------------------------------------------------------------
+ * Consumer rings
+ * ---------------------------------------------------------------- */
+
+stream_ingest_queue_t *stream_ingest_queue_create(const stream_ingest_consumer_config_t *config) {
+    int requested = (config && config->queue_packets > 0) ? config->queue_packets
+                                                          : STREAM_INGEST_DEFAULT_QUEUE_PACKETS;
+    if (requested > INGEST_MAX_QUEUE_PACKETS) {
+        requested = INGEST_MAX_QUEUE_PACKETS;
+    }
+
+    unsigned int capacity = 1;
+    while (capacity < (unsigned int)requested) {
+        capacity <<= 1;
+    }
+
+    stream_ingest_queue_t *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+
+    queue->slots = calloc(capacity, sizeof(AVPacket *));
+    if (!queue->slots || sem_init(&queue->ready, 0, 0) != 0) {
+        free(queue->slots);
+        free(queue);
+        return NULL;
+    }
+
+    queue->capacity = capacity;
+    queue->mask = capacity - 1;
+    queue->drop_policy = config ? config->drop_policy : STREAM_INGEST_DROP_TO_KEYFRAME;
+    queue->waiting_for_keyframe = true;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->lost, false);
+    atomic_init(&queue->delivered, 0);
+    atomic_init(&queue->dropped, 0);
+    return queue;
+}
+
+void stream_ingest_queue_destroy(stream_ingest_queue_t *queue) {
+    if (!queue) return;
+
+    unsigned int tail = atomic_load(&queue->tail);
+    unsigned int head = atomic_load(&queue->head);
+    for (; tail != head; tail++) {
+        av_packet_free(&queue->slots[tail & queue->mask]);
+    }
+
+    sem_destroy(&queue->ready);
+    free(queue->slots);
+    free(queue);
+}
+
+int stream_ingest_queue_push(stream_ingest_queue_t *queue, const AVPacket *pkt, bool is_video) {
+    if (!queue || !pkt) return -1;
+
+    if (atomic_load(&queue->lost)) {
+        atomic_fetch_add(&queue->dropped, 1);
+        return 0;
+    }
+
+    if (queue->waiting_for_keyframe) {
+        if (!is_video || !(pkt->flags & AV_PKT_FLAG_KEY)) {
+            atomic_fetch_add(&queue->dropped, 1);
+            return 0;
+        }
+        queue->waiting_for_keyframe = false;
+    }
+
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail >= queue->capacity) {
+        atomic_fetch_add(&queue->dropped, 1);
+        if (queue->drop_policy == STREAM_INGEST_DROP_TO_KEYFRAME) {
+            queue->waiting_for_keyframe = true;
+        }
+        return 0;
+    }
+
+    AVPacket *ref = av_packet_clone(pkt);
+    if (!ref) {
+        return -1;
+    }
+
+    queue->slots[head & queue->mask] = ref;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    sem_post(&queue->ready);
+    return 1;
+}
+
+int stream_ingest_queue_pop(stream_ingest_queue_t *queue, AVPacket *pkt,
+                            const AVIOInterruptCB *interrupt, int timeout_ms) {
+    if (!queue || !pkt) return AVERROR(EINVAL);
+
+    int64_t deadline = av_gettime_relative() + (int64_t)timeout_ms * 1000;
+
+    for (;;) {
+        unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+        if (tail != head) {
+            AVPacket *ref = queue->slots[tail & queue->mask];
+            queue->slots[tail & queue->mask] = NULL;
+            atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+            av_packet_move_ref(pkt, ref);
+            av_packet_free(&ref);
+            atomic_fetch_add(&queue->delivered, 1);
+            return 0;
+        }
+
+        if (atomic_load(&queue->lost)) {
+            // A packet may have been queued just before the loss was flagged
+            if (atomic_load_explicit(&queue->head, memory_order_acquire) != tail) {
+                continue;
+            }
+            return AVERROR_EOF;
+        }
+
+        if (interrupt && interrupt->callback && interrupt->callback(interrupt->opaque)) {
+            return AVERROR_EXIT;
+        }
+
+        int64_t remaining_us = deadline - av_gettime_relative();
+        if (remaining_us <= 0) {
+            return AVERROR(EAGAIN);
+        }
+        if (remaining_us > INGEST_POLL_MS * 1000) {
+            remaining_us = INGEST_POLL_MS * 1000;
+        }
+
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += (long)(remaining_us * 1000);
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        while (sem_timedwait(&queue->ready, &ts) != 0 && errno == EINTR) {
+            // Retry after a signal
+        }
+    }
+}
+
+void stream_ingest_queue_mark_lost(stream_ingest_queue_t *queue) {
+    if (!queue) return;
+    atomic_store(&queue->lost, true);
+    sem_post(&queue->ready);
+}
+
+void stream_ingest_queue_stats(stream_ingest_queue_t *queue, stream_ingest_stats_t *stats) {
+    if (!queue || !stats) return;
+    stats->queued = (int)(atomic_load(&queue->head) - atomic_load(&queue->tail));
+    stats->packets_delivered = atomic_load(&queue->delivered);
+    stats->packets_dropped = atomic_load(&queue->dropped);
+}
+
+/* ----------------------------------------------------------------
+ * Ingest thread
+ * ---------------------------------------------------------------- */
+
+static int ingest_interrupt_callback(void *opaque) {
+    ingest_source_t *source = (ingest_source_t *)opaque;
+    if (!source) return 1;
+    return !atomic_load(&source->running) || is_shutdown_initiated();
+}
+
+static void clear_stream_params_locked(ingest_source_t *source) {
+    for (int i = 0; i < source->nb_streams; i++) {
+        avcodec_parameters_free(&source->streams[i].codecpar);
+    }
+    source->nb_streams = 0;
+}
+
+/**
+ * Record the source's stream layout and wake consumers waiting to open
+ */
+static int publish_stream_params(ingest_source_t *source, const AVFormatContext *input_ctx) {
+    int ret = 0;
+
+    pthread_mutex_lock(&source->mutex);
+    clear_stream_params_locked(source);
+
+    unsigned int count = input_ctx->nb_streams;
+    if (count > INGEST_MAX_STREAMS) {
+        log_warn("[%s] Source has %u streams, sharing only the first %d",
+                 source->stream_name, count, INGEST_MAX_STREAMS);
+        count = INGEST_MAX_STREAMS;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        const AVStream *st = input_ctx->streams[i];
+        ingest_stream_params_t *params = &source->streams[i];
+
+        params->codecpar = avcodec_parameters_alloc();
+        if (!params->codecpar || avcodec_parameters_copy(params->codecpar, st->codecpar) < 0) {
+            avcodec_parameters_free(&params->codecpar);
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        params->time_base = st->time_base;
+        params->avg_frame_rate = st->avg_frame_rate;
+        params->r_frame_rate = st->r_frame_rate;
+        params->start_time = st->start_time;
+        params->id = st->id;
+        source->nb_streams = (int)i + 1;
+    }
+
+    if (ret < 0) {
+        clear_stream_params_locked(source);
+    } else {
+        source->start_time = input_ctx->start_time;
+        source->connected = true;
+        pthread_cond_broadcast(&source->connected_cond);
+    }
+    pthread_mutex_unlock(&source->mutex);
+    return ret;
+}
+
+/**
+ * Hand a packet to every consumer of the source
+ */
+static void fan_out(ingest_source_t *source, const AVPacket *pkt) {
+    pthread_mutex_lock(&source->mutex);
+    if (pkt->stream_index >= 0 && pkt->stream_index < source->nb_streams) {
+        bool is_video = source->streams[pkt->stream_index].codecpar->codec_type == AVMEDIA_TYPE_VIDEO;
+        for (ingest_consumer_t *c = source->consumers; c; c = c->next) {
+            stream_ingest_queue_push(c->queue, pkt, is_video);
+        }
+    }
+    pthread_mutex_unlock(&source->mutex);
+}
+
+/**
+ * Tell the current consumers the source went away
+ *
+ * They drain what is queued, then read AVERROR_EOF and reopen.
+ */
+static void mark_source_lost(ingest_source_t *source) {
+    pthread_mutex_lock(&source->mutex);
+    source->connected = false;
+    clear_stream_params_locked(source);
+    for (ingest_consumer_t *c = source->consumers; c; c = c->next) {
+        stream_ingest_queue_mark_lost(c->queue);
+    }
+    pthread_mutex_unlock(&source->mutex);
+}
+
+static void ingest_sleep_ms(ingest_source_t *source, int ms) {
+    while (ms > 0 && !ingest_interrupt_callback(source)) {
+        int step = ms < INGEST_POLL_MS ? ms : INGEST_POLL_MS;
+        av_usleep((unsigned int)step * 1000);
+        ms -= step;
+    }
+}
+
+static void *ingest_thread_func(void *arg) {
+    ingest_source_t *source = (ingest_source_t *)arg;
+    int backoff_ms = INGEST_RECONNECT_MIN_MS;
+
+    AVPacket *pkt = av_packet_alloc();
+    if (!pkt) {
+        log_error("[%s] Failed to allocate ingest packet", source->stream_name);
+        return NULL;
+    }
+
+    // The MP4 recorder reads through this connection, so open it the way the
+    // recorder opens its own (genpts matters behind go2rtc)
+    AVDictionary *open_options = NULL;
+    set_recording_input_options(&open_options);
+
+    while (!ingest_interrupt_callback(source)) {
+        AVFormatContext *input_ctx = NULL;
+        // Tie the open and probe to source->running so the last consumer's
+        // release doesn't wait out the RTSP connect and probe timeouts
+        AVIOInterruptCB interrupt = { .callback = ingest_interrupt_callback, .opaque = source };
+        int ret = open_input_stream_interruptible(&input_ctx, source->url, source->protocol,
+                                                  &interrupt, open_options);
+        if (ret < 0 || !input_ctx) {
+            log_warn("[%s] Shared ingest failed to open source, retrying in %d ms",
+                     source->stream_name, backoff_ms);
+            ingest_sleep_ms(source, backoff_ms);
+            backoff_ms = backoff_ms * 2 > INGEST_RECONNECT_MAX_MS ? INGEST_RECONNECT_MAX_MS : backoff_ms * 2;
+            continue;
+        }
+
+        if (publish_stream_params(source, input_ctx) < 0) {
+            log_error("[%s] Failed to copy source stream parameters", source->stream_name);
+            avformat_close_input(&input_ctx);
+            ingest_sleep_ms(source, backoff_ms);
+            continue;
+        }
+        backoff_ms = INGEST_RECONNECT_MIN_MS;
+        log_info("[%s] Shared ingest connected (%u streams)", source->stream_name, input_ctx->nb_streams);
+
+        while (!ingest_interrupt_callback(source)) {
+            ret = av_read_frame(input_ctx, pkt);
+            if (ret == AVERROR(EAGAIN)) {
+                av_usleep(10000);
+                continue;
+            }
+            if (ret < 0) {
+                if (ret != AVERROR_EXIT) {
+                    char err_buf[AV_ERROR_MAX_STRING_SIZE];
+                    av_strerror(ret, err_buf, sizeof(err_buf));
+                    log_warn("[%s] Shared ingest read failed: %s", source->stream_name, err_buf);
+                }
+                break;
+            }
+
+            fan_out(source, pkt);
+            av_packet_unref(pkt);
+        }
+
+        mark_source_lost(source);
+        avformat_close_input(&input_ctx);
+    }
+
+    av_dict_free(&open_options);
+    av_packet_free(&pkt);
+    log_info("[%s] Shared ingest stopped", source->stream_name);
+    return NULL;
+}
+
+/* ----------------------------------------------------------------
+ * Source registry
+ * ---------------------------------------------------------------- */
+
+static void free_source(ingest_source_t *source) {
+    clear_stream_params_locked(source);
+    pthread_cond_destroy(&source->connected_cond);
+    pthread_mutex_destroy(&source->mutex);
+    free(source);
+}
+
+/**
+ * Find or start the ingest for a URL and take a reference to it
+ */
+static ingest_source_t *acquire_source(const char *stream_name, const char *url, int protocol) {
+    pthread_mutex_lock(&sources_mutex);
+
+    for (ingest_source_t *s = sources; s; s = s->next) {
+        if (strcmp(s->url, url) == 0) {
+            s->refs++;
+            pthread_mutex_unlock(&sources_mutex);
+            return s;
+        }
+    }
+
+    ingest_source_t *source = calloc(1, sizeof(*source));
+    if (!source) {
+        pthread_mutex_unlock(&sources_mutex);
+        return NULL;
+    }
+
+    safe_strcpy(source->url, url, sizeof(source->url), 0);
+    safe_strcpy(source->stream_name, stream_name, sizeof(source->stream_name), 0);
+    source->protocol = protocol;
+    source->refs = 1;
+    atomic_init(&source->running, true);
+    pthread_mutex_init(&source->mutex, NULL);
+    pthread_cond_init(&source->connected_cond, NULL);
+
+    if (pthread_create(&source->thread, NULL, ingest_thread_func, source) != 0) {
+        log_error("[%s] Failed to start shared ingest thread", stream_name);
+        pthread_mutex_unlock(&sources_mutex);
+        free_source(source);
+        return NULL;
+    }
+
+    source->next = sources;
+    sources = source;
+    pthread_mutex_unlock(&sources_mutex);
+
+    char safe_url[MAX_URL_LENGTH];
+    if (url_redact_for_logging(url, safe_url, sizeof(safe_url)) != 0) {
+        safe_strcpy(safe_url, "[invalid-url]", sizeof(safe_url), 0);
+    }
+    log_info("[%s] Started shared ingest for %s", stream_name, safe_url);
+    return source;
+}
+
+/**
+ * Drop a reference; the last one stops the ingest thread
+ */
+static void release_source(ingest_source_t *source) {
+    pthread_mutex_lock(&sources_mutex);
+    if (--source->refs > 0) {
+        pthread_mutex_unlock(&sources_mutex);
+        return;
+    }
+
+    for (ingest_source_t **pp = &sources; *pp; pp = &(*pp)->next) {
+        if (*pp == source) {
+            *pp = source->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sources_mutex);
+
+    atomic_store(&source->running, false);
+    pthread_join(source->thread, NULL);
+    free_source(source);
+}
+
+/* ----------------------------------------------------------------
+ * Consumer contexts
+ * ---------------------------------------------------------------- */
+
+static void detach_consumer(ingest_consumer_t *consumer) {
+    ingest_source_t *source = consumer->source;
+
+    pthread_mutex_lock(&source->mutex);
+    for (ingest_consumer_t **pp = &source->consumers; *pp; pp = &(*pp)->next) {
+        if (*pp == consumer) {
+            *pp = consumer->next;
+            source->consumer_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&source->mutex);
+
+    release_source(source);
+    stream_ingest_queue_destroy(consumer->queue);
+    free(consumer);
+}
+
+/**
+ * io_close2 hook: avformat_close_input() on a shared input lands here
+ */
+static int ingest_io_close(AVFormatContext *s, AVIOContext *pb) {
+    (void)s;
+    if (!pb) return 0;
+
+    ingest_consumer_t *consumer = (ingest_consumer_t *)pb->opaque;
+    if (consumer) {
+        detach_consumer(consumer);
+    }
+
+    av_freep(&pb->buffer);
+    avio_context_free(&pb);
+    return 0;
+}
+
+/**
+ * Give the consumer context a copy of the source's streams
+ */
+static int build_streams_locked(ingest_source_t *source, AVFormatContext *ctx) {
+    for (int i = 0; i < source->nb_streams; i++) {
+        const ingest_stream_params_t *params = &source->streams[i];
+        AVStream *st = avformat_new_stream(ctx, NULL);
+        if (!st) {
+            return AVERROR(ENOMEM);
+        }
+
+        int ret = avcodec_parameters_copy(st->codecpar, params->codecpar);
+        if (ret < 0) {
+            return ret;
+        }
+        st->time_base = params->time_base;
+        st->avg_frame_rate = params->avg_frame_rate;
+        st->r_frame_rate = params->r_frame_rate;
+        st->start_time = params->start_time;
+        st->id = params->id;
+    }
+    ctx->start_time = source->start_time;
+    return 0;
+}
+
+static int shutdown_interrupt_callback(void *opaque) {
+    (void)opaque;
+    return is_shutdown_initiated();
+}
+
+static bool caller_interrupted(const AVFormatContext *ctx) {
+    return ctx->interrupt_callback.callback &&
+           ctx->interrupt_callback.callback(ctx->interrupt_callback.opaque);
+}
+
+int stream_ingest_open_input(AVFormatContext **ctx, const char *stream_name, const char *url,
+                             int protocol, const stream_ingest_consumer_config_t *config) {
+    if (!ctx || !stream_name || !url || url[0] == '\0') {
+        return AVERROR(EINVAL);
+    }
+
+    if (is_shutdown_initiated()) {
+        log_info("[%s] Skipping shared input open during shutdown", stream_name);
+        if (*ctx) {
+            avformat_free_context(*ctx);
+            *ctx = NULL;
+        }
+        return AVERROR(EINTR);
+    }
+
+    AVFormatContext *s = *ctx ? *ctx : avformat_alloc_context();
+    *ctx = NULL;
+    if (!s) {
+        return AVERROR(ENOMEM);
+    }
+
+    // Callers without their own interrupt callback still stop waiting on shutdown
+    if (!s->interrupt_callback.callback) {
+        s->interrupt_callback.callback = shutdown_interrupt_callback;
+        s->interrupt_callback.opaque = NULL;
+    }
+
+    ingest_consumer_t *consumer = calloc(1, sizeof(*consumer));
+    if (consumer) {
+        consumer->queue = stream_ingest_queue_create(config);
+    }
+    if (!consumer || !consumer->queue) {
+        free(consumer);
+        avformat_free_context(s);
+        return AVERROR(ENOMEM);
+    }
+
+    ingest_source_t *source = acquire_source(stream_name, url, protocol);
+    if (!source) {
+        stream_ingest_queue_destroy(consumer->queue);
+        free(consumer);
+        avformat_free_context(s);
+        return AVERROR(ENOMEM);
+    }
+    consumer->source = source;
+
+    // Wait for the ingest thread to connect, then copy the stream layout and
+    // join the fan-out list under the same lock so no packet of this
+    // connection is seen with a stale layout
+    int ret = 0;
+    int waited_ms = 0;
+    pthread_mutex_lock(&source->mutex);
+    while (!source->connected) {
+        if (caller_interrupted(s)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (waited_ms >= INGEST_OPEN_TIMEOUT_MS) {
+            ret = AVERROR(ETIMEDOUT);
+            break;
+        }
+
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += INGEST_POLL_MS * 1000000L;
+        ts.tv_sec += ts.tv_nsec / 1000000000L;
+        ts.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait(&source->connected_cond, &source->mutex, &ts);
+        waited_ms += INGEST_POLL_MS;
+    }
+
+    if (ret == 0) {
+        ret = build_streams_locked(source, s);
+    }
+    if (ret == 0) {
+        consumer->next = source->consumers;
+        source->consumers = consumer;
+        source->consumer_count++;
+    }
+    int consumer_count = source->consumer_count;
+    pthread_mutex_unlock(&source->mutex);
+
+    if (ret < 0) {
+        char err_buf[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(ret, err_buf, sizeof(err_buf));
+        log_warn("[%s] Failed to open shared input: %s", stream_name, err_buf);
+        release_source(source);
+        stream_ingest_queue_destroy(consumer->queue);
+        free(consumer);
+        avformat_free_context(s);
+        return ret;
+    }
+
+    // Placeholder I/O context: never read, only there so avformat_close_input()
+    // calls ingest_io_close() and the subscription is released with the context
+    unsigned char *pb_buffer = av_malloc(INGEST_PB_BUFFER_SIZE);
+    AVIOContext *pb = pb_buffer ? avio_alloc_context(pb_buffer, INGEST_PB_BUFFER_SIZE, 0, consumer,
+                                                     NULL, NULL, NULL)
+                                : NULL;
+    if (!pb) {
+        av_free(pb_buffer);
+        detach_consumer(consumer);
+        avformat_free_context(s);
+        return AVERROR(ENOMEM);
+    }
+    s->pb = pb;
+    s->io_close2 = ingest_io_close;
+
+    log_info("[%s] Opened shared input (%u streams, %d consumers)", stream_name, s->nb_streams, consumer_count);
+    *ctx = s;
+    return 0;
+}
+
+bool stream_ingest_is_shared(const AVFormatContext *ctx) {
+    return ctx && ctx->pb && ctx->io_close2 == ingest_io_close;
+}
+
+int stream_ingest_read_frame(AVFormatContext *ctx, AVPacket *pkt) {
+    if (!stream_ingest_is_shared(ctx)) {
+        return av_read_frame(ctx, pkt);
+    }
+
+    ingest_consumer_t *consumer = (ingest_consumer_t *)ctx->pb->opaque;
+    int ret = stream_ingest_queue_pop(consumer->queue, pkt, &ctx->interrupt_callback, INGEST_READ_TIMEOUT_MS);
+    if (ret == AVERROR(EAGAIN)) {
+        return AVERROR(ETIMEDOUT);
+    }
+    return ret;
+}
+
+int stream_ingest_get_stats(const AVFormatContext *ctx, stream_ingest_stats_t *stats) {
+    if (!stream_ingest_is_shared(ctx) || !stats) {
+        return -1;
+    }
+
+    ingest_consumer_t *consumer = (ingest_consumer_t *)ctx->pb->opaque;
+    memset(stats, 0, sizeof(*stats));
+    stream_ingest_queue_stats(consumer->queue, stats);
+
+    pthread_mutex_lock(&consumer->source->mutex);
+    stats->source_consumers = consumer->source->consumer_count;
+    pthread_mutex_unlock(&consumer->source->mutex);
+    return 0;
+}
@@ -257,11 +257,45 @@ static bool check_rtsp_stream_exists(const char *url) {
     return true;
 }
 
+/**
+ * Options for a connection that feeds MP4 recordings
+ */
+void set_recording_input_options(AVDictionary **options) {
+    // BUGFIX: Add genpts to regenerate presentation timestamps from the actual
+    // frame data.  When go2rtc proxies the RTSP stream, the original SDP
+    // framerate (e.g. 15fps) may not be propagated, causing FFmpeg to assume
+    // a wrong framerate and produce incorrect timestamps.  genpts fixes this
+    // by computing PTS from DTS and packet duration.
+    av_dict_set(options, "fflags", "nobuffer", 0);
+    av_dict_set(options, "fflags", "+genpts", AV_DICT_APPEND);
+    av_dict_set(options, "flags", "low_delay", 0);     // Low delay mode
+    av_dict_set(options, "max_delay", "500000", 0);    // Maximum delay of 500ms
+    av_dict_set(options, "stimeout", "5000000", 0);    // Socket timeout in microseconds (5 seconds)
+
+    // Set analyzeduration and probesize to help FFmpeg detect stream
+    // parameters from go2rtc's RTSP output.  Use the FFmpeg defaults (5s / 5MB)
+    // to give go2rtc enough time to connect to the upstream camera and start
+    // forwarding frames.
+    av_dict_set(options, "analyzeduration", "5000000", 0);  // 5 seconds (FFmpeg default)
+    av_dict_set(options, "probesize", "5242880", 0);        // 5 MB (5 * 1024 * 1024 bytes, FFmpeg default)
+}
+
 /**
  * Open input stream with appropriate options based on protocol
  * Enhanced with more robust error handling and synchronization for UDP streams
  */
 int open_input_stream(AVFormatContext **input_ctx, const char *url, int protocol) {
+    return open_input_stream_interruptible(input_ctx, url, protocol, NULL, NULL);
+}
+
+/**
+ * Open input stream with a caller-supplied interrupt callback, so the open
+ * and the stream probe can be abandoned as soon as the caller stops wanting
+ * the stream instead of only at shutdown, and with caller-supplied options
+ * replacing the protocol defaults
+ */
+int open_input_stream_interruptible(AVFormatContext **input_ctx, const char *url, int protocol,
+                                    const AVIOInterruptCB *interrupt, const AVDictionary *overrides) {
     int ret;
     AVDictionary *input_options = NULL;
     bool is_multicast = false;
@@ -479,6 +513,11 @@ int open_input_stream(AVFormatContext **input_ctx, const char *url, int protocol
     av_dict_set(&input_options, "analyzeduration", "10000000", 0); // 10 seconds (increased from default)
     av_dict_set(&input_options, "probesize", "10000000", 0); // 10MB (increased from default 5MB)
 
+    // Caller-supplied options win over everything above
+    if (overrides) {
+        av_dict_copy(&input_options, overrides, 0);
+    }
+
     // CRITICAL FIX: Allocate context first and set interrupt callback BEFORE opening
     // This allows avformat_open_input itself to be interrupted during shutdown
     local_ctx = avformat_alloc_context();
@@ -489,8 +528,13 @@ int open_input_stream(AVFormatContext **input_ctx, const char *url, int protocol
     }
 
     // Set up interrupt callback so blocking operations can be interrupted during shutdown
-    local_ctx->interrupt_callback.callback = ffmpeg_interrupt_callback;
-    local_ctx->interrupt_callback.opaque = NULL;
+    // (or whenever the caller's own callback says so)
+    if (interrupt && interrupt->callback) {
+        local_ctx->interrupt_callback = *interrupt;
+    } else {
+        local_ctx->interrupt_callback.callback = ffmpeg_interrupt_callback;
+        local_ctx->interrupt_callback.opaque = NULL;
+    }
 
     // Open the input stream
     ret = avformat_open_input(&local_ctx, local_url, NULL, &input_options);
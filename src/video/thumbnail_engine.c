@@ -0,0 +1,413 @@
+/**
+ * In-process recording thumbnail engine
+ *
+ * Decodes a single frame at the keyframe nearest (at or before) the
+ * requested position and encodes it to JPEG in memory.  The scaler, the RGB
+ * staging buffer and the JPEG encoder are all cached per thread.  The encoder
+ * deliberately does not come from the shared jpeg_encoder_get_cached() pool:
+ * workers render at different sizes, and that pool destroys the encoder it
+ * evicts while another thread may still be encoding with it.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+
+#include "video/thumbnail_engine.h"
+#include "video/ffmpeg_utils.h"
+#define LOG_COMPONENT "Thumbnail"
+#include "core/logger.h"
+
+// Give up if no frame decodes within this many video packets after the seek
+#define THUMBNAIL_MAX_PACKETS 600
+
+#define THUMBNAIL_CACHE_BUCKETS 256
+
+// Per-thread scaler and packed RGB24 staging buffer
+static __thread struct SwsContext *tls_sws = NULL;
+static __thread uint8_t *tls_rgb = NULL;
+static __thread size_t tls_rgb_size = 0;
+
+// Per-thread JPEG encoder, recreated when the output size or quality changes
+static __thread jpeg_encoder_cache_t *tls_encoder = NULL;
+static __thread int tls_encoder_w = 0;
+static __thread int tls_encoder_h = 0;
+static __thread int tls_encoder_quality = 0;
+
+static jpeg_encoder_cache_t *thread_encoder(int width, int height, int quality) {
+    if (tls_encoder && tls_encoder_w == width && tls_encoder_h == height &&
+        tls_encoder_quality == quality) {
+        return tls_encoder;
+    }
+
+    jpeg_encoder_cache_destroy(tls_encoder);
+    tls_encoder = jpeg_encoder_cache_create(width, height, 3, quality);
+    tls_encoder_w = width;
+    tls_encoder_h = height;
+    tls_encoder_quality = quality;
+    return tls_encoder;
+}
+
+/**
+ * Decode the first frame at or after the keyframe preceding seek_seconds
+ */
+static AVFrame *decode_frame_at(AVFormatContext *fmt_ctx, int video_idx, AVCodecContext *dec_ctx,
+                                double seek_seconds, const char *input_path) {
+    AVStream *st = fmt_ctx->streams[video_idx];
+
+    if (seek_seconds > 0) {
+        int64_t ts = (int64_t)(seek_seconds / av_q2d(st->time_base));
+        if (st->start_time != AV_NOPTS_VALUE) {
+            ts += st->start_time;
+        }
+        int ret = av_seek_frame(fmt_ctx, video_idx, ts, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            // Decode from the start rather than failing outright
+            log_debug("Seek to %.2fs failed for %s, using first frame", seek_seconds, input_path);
+        }
+    }
+
+    AVPacket *pkt = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    if (!pkt || !frame) {
+        av_packet_free(&pkt);
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    int packets = 0;
+    bool got_frame = false;
+    while (!got_frame && packets < THUMBNAIL_MAX_PACKETS) {
+        int ret = av_read_frame(fmt_ctx, pkt);
+        if (ret < 0) {
+            // End of file: drain frames still inside the decoder
+            avcodec_send_packet(dec_ctx, NULL);
+            got_frame = avcodec_receive_frame(dec_ctx, frame) == 0;
+            break;
+        }
+
+        if (pkt->stream_index == video_idx) {
+            packets++;
+            if (avcodec_send_packet(dec_ctx, pkt) >= 0) {
+                got_frame = avcodec_receive_frame(dec_ctx, frame) == 0;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+    if (!got_frame) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+    return frame;
+}
+
+int thumbnail_engine_render(const char *input_path, double seek_seconds, int width, int quality,
+                            unsigned char **jpeg, size_t *jpeg_size) {
+    if (!input_path || !jpeg || !jpeg_size || width <= 0) {
+        return -1;
+    }
+    *jpeg = NULL;
+    *jpeg_size = 0;
+    if (seek_seconds < 0) seek_seconds = 0;
+
+    int result = -1;
+    AVFormatContext *fmt_ctx = NULL;
+    AVCodecContext *dec_ctx = NULL;
+    AVFrame *frame = NULL;
+
+    int ret = avformat_open_input(&fmt_ctx, input_path, NULL, NULL);
+    if (ret < 0) {
+        log_ffmpeg_error(ret, "Failed to open recording for thumbnail");
+        return -1;
+    }
+
+    ret = avformat_find_stream_info(fmt_ctx, NULL);
+    if (ret < 0) {
+        log_ffmpeg_error(ret, "Failed to read recording stream info for thumbnail");
+        goto cleanup;
+    }
+
+    const AVCodec *decoder = NULL;
+    int video_idx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+    if (video_idx < 0 || !decoder) {
+        log_warn("No decodable video stream in %s", input_path);
+        goto cleanup;
+    }
+
+    dec_ctx = avcodec_alloc_context3(decoder);
+    if (!dec_ctx ||
+        avcodec_parameters_to_context(dec_ctx, fmt_ctx->streams[video_idx]->codecpar) < 0) {
+        log_error("Failed to set up thumbnail decoder for %s", input_path);
+        goto cleanup;
+    }
+    // One frame per request: frame threading would only add latency
+    dec_ctx->thread_count = 1;
+
+    ret = avcodec_open2(dec_ctx, decoder, NULL);
+    if (ret < 0) {
+        log_ffmpeg_error(ret, "Failed to open thumbnail decoder");
+        goto cleanup;
+    }
+
+    frame = decode_frame_at(fmt_ctx, video_idx, dec_ctx, seek_seconds, input_path);
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        log_warn("No frame decoded for thumbnail of %s at %.2fs", input_path, seek_seconds);
+        goto cleanup;
+    }
+
+    // Keep the aspect ratio, never upscale, and keep dimensions even for the encoder
+    int out_w = frame->width < width ? frame->width : width;
+    int out_h = (int)((int64_t)frame->height * out_w / frame->width);
+    out_w &= ~1;
+    out_h &= ~1;
+    if (out_w < 2) out_w = 2;
+    if (out_h < 2) out_h = 2;
+
+    tls_sws = sws_getCachedContext(tls_sws, frame->width, frame->height, frame->format,
+                                   out_w, out_h, AV_PIX_FMT_RGB24,
+                                   SWS_BILINEAR, NULL, NULL, NULL);
+    if (!tls_sws) {
+        log_error("Failed to create thumbnail scaler for %s", input_path);
+        goto cleanup;
+    }
+
+    size_t rgb_size = (size_t)out_w * out_h * 3;
+    if (rgb_size > tls_rgb_size) {
+        uint8_t *buf = realloc(tls_rgb, rgb_size);
+        if (!buf) {
+            log_error("Failed to allocate thumbnail buffer (%zu bytes)", rgb_size);
+            goto cleanup;
+        }
+        tls_rgb = buf;
+        tls_rgb_size = rgb_size;
+    }
+
+    uint8_t *dst_data[4] = { tls_rgb, NULL, NULL, NULL };
+    int dst_linesize[4] = { out_w * 3, 0, 0, 0 };
+    sws_scale(tls_sws, (const uint8_t *const *)frame->data, frame->linesize, 0, frame->height,
+              dst_data, dst_linesize);
+
+    jpeg_encoder_cache_t *encoder = thread_encoder(out_w, out_h, quality);
+    if (!encoder) {
+        log_error("No JPEG encoder for %dx%d thumbnail", out_w, out_h);
+        goto cleanup;
+    }
+
+    if (jpeg_encoder_cache_encode_to_memory(encoder, tls_rgb, jpeg, jpeg_size) != 0) {
+        goto cleanup;
+    }
+
+    log_debug("Rendered thumbnail for %s at %.2fs: %dx%d, %zu bytes",
+              input_path, seek_seconds, out_w, out_h, *jpeg_size);
+    result = 0;
+
+cleanup:
+    av_frame_free(&frame);
+    avcodec_free_context(&dec_ctx);
+    avformat_close_input(&fmt_ctx);
+    return result;
+}
+
+void thumbnail_engine_thread_cleanup(void) {
+    sws_freeContext(tls_sws);
+    tls_sws = NULL;
+    free(tls_rgb);
+    tls_rgb = NULL;
+    tls_rgb_size = 0;
+    jpeg_encoder_cache_destroy(tls_encoder);
+    tls_encoder = NULL;
+}
+
+/* ----------------------------------------------------------------
+ * LRU memory cache
+ * ---------------------------------------------------------------- */
+
+typedef struct thumbnail_cache_entry {
+    char *key;
+    unsigned char *data;
+    size_t size;
+    struct thumbnail_cache_entry *hash_next;
+    struct thumbnail_cache_entry *lru_prev;    // Towards most recently used
+    struct thumbnail_cache_entry *lru_next;    // Towards least recently used
+} thumbnail_cache_entry_t;
+
+static struct {
+    pthread_mutex_t mutex;
+    thumbnail_cache_entry_t *buckets[THUMBNAIL_CACHE_BUCKETS];
+    thumbnail_cache_entry_t *lru_head;         // Most recently used
+    thumbnail_cache_entry_t *lru_tail;         // Least recently used
+    size_t max_bytes;
+    size_t bytes;
+    int entries;
+} g_thumb_cache = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .max_bytes = THUMBNAIL_CACHE_DEFAULT_BYTES,
+};
+
+static unsigned int cache_bucket(const char *key) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h % THUMBNAIL_CACHE_BUCKETS;
+}
+
+static thumbnail_cache_entry_t *cache_find_locked(const char *key) {
+    for (thumbnail_cache_entry_t *e = g_thumb_cache.buckets[cache_bucket(key)]; e; e = e->hash_next) {
+        if (strcmp(e->key, key) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink_locked(thumbnail_cache_entry_t *e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else g_thumb_cache.lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else g_thumb_cache.lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push_front_locked(thumbnail_cache_entry_t *e) {
+    e->lru_prev = NULL;
+    e->lru_next = g_thumb_cache.lru_head;
+    if (g_thumb_cache.lru_head) g_thumb_cache.lru_head->lru_prev = e;
+    g_thumb_cache.lru_head = e;
+    if (!g_thumb_cache.lru_tail) g_thumb_cache.lru_tail = e;
+}
+
+static void cache_delete_locked(thumbnail_cache_entry_t *e) {
+    thumbnail_cache_entry_t **pp = &g_thumb_cache.buckets[cache_bucket(e->key)];
+    while (*pp && *pp != e) {
+        pp = &(*pp)->hash_next;
+    }
+    if (*pp) *pp = e->hash_next;
+
+    lru_unlink_locked(e);
+    g_thumb_cache.bytes -= e->size;
+    g_thumb_cache.entries--;
+    free(e->key);
+    free(e->data);
+    free(e);
+}
+
+static void cache_evict_locked(size_t max_bytes) {
+    while (g_thumb_cache.lru_tail && g_thumb_cache.bytes > max_bytes) {
+        cache_delete_locked(g_thumb_cache.lru_tail);
+    }
+}
+
+void thumbnail_cache_set_limit(size_t max_bytes) {
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    g_thumb_cache.max_bytes = max_bytes;
+    cache_evict_locked(max_bytes);
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+}
+
+int thumbnail_cache_get(const char *key, unsigned char **data, size_t *size) {
+    if (!key || !data || !size) return -1;
+
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    thumbnail_cache_entry_t *e = cache_find_locked(key);
+    if (!e) {
+        pthread_mutex_unlock(&g_thumb_cache.mutex);
+        return -1;
+    }
+
+    unsigned char *copy = malloc(e->size);
+    if (!copy) {
+        pthread_mutex_unlock(&g_thumb_cache.mutex);
+        return -1;
+    }
+    memcpy(copy, e->data, e->size);
+    *data = copy;
+    *size = e->size;
+
+    lru_unlink_locked(e);
+    lru_push_front_locked(e);
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+    return 0;
+}
+
+int thumbnail_cache_put(const char *key, const unsigned char *data, size_t size) {
+    if (!key || !data || size == 0) return -1;
+
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    if (size > g_thumb_cache.max_bytes) {
+        pthread_mutex_unlock(&g_thumb_cache.mutex);
+        return -1;
+    }
+
+    thumbnail_cache_entry_t *old = cache_find_locked(key);
+    if (old) {
+        cache_delete_locked(old);
+    }
+
+    thumbnail_cache_entry_t *e = calloc(1, sizeof(*e));
+    if (e) {
+        e->key = strdup(key);
+        e->data = malloc(size);
+    }
+    if (!e || !e->key || !e->data) {
+        if (e) {
+            free(e->key);
+            free(e->data);
+            free(e);
+        }
+        pthread_mutex_unlock(&g_thumb_cache.mutex);
+        return -1;
+    }
+    memcpy(e->data, data, size);
+    e->size = size;
+
+    cache_evict_locked(g_thumb_cache.max_bytes - size);
+
+    unsigned int b = cache_bucket(key);
+    e->hash_next = g_thumb_cache.buckets[b];
+    g_thumb_cache.buckets[b] = e;
+    lru_push_front_locked(e);
+    g_thumb_cache.bytes += size;
+    g_thumb_cache.entries++;
+
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+    return 0;
+}
+
+void thumbnail_cache_remove(const char *key) {
+    if (!key) return;
+
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    thumbnail_cache_entry_t *e = cache_find_locked(key);
+    if (e) {
+        cache_delete_locked(e);
+    }
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+}
+
+void thumbnail_cache_clear(void) {
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    cache_evict_locked(0);
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+}
+
+void thumbnail_cache_get_usage(int *entries, size_t *bytes) {
+    pthread_mutex_lock(&g_thumb_cache.mutex);
+    if (entries) *entries = g_thumb_cache.entries;
+    if (bytes) *bytes = g_thumb_cache.bytes;
+    pthread_mutex_unlock(&g_thumb_cache.mutex);
+}
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <time.h>
@@ -42,11 +43,14 @@
 #include "video/packet_buffer.h"
 #include "video/detection.h"
 #include "video/detection_model.h"
+#include "video/inference_scheduler.h"
 #include "video/detection_result.h"
 #include "video/api_detection.h"
 #include "video/motion_detection.h"
 #include "video/onvif_detection.h"
 #include "video/zone_filter.h"
+#include "video/frame_bus.h"
+#include "video/stream_ingest.h"
 #include "video/mp4_writer.h"
 #include "video/mp4_writer_internal.h"
 #include "video/mp4_recording.h"
@@ -105,6 +109,11 @@ static int connect_to_stream(unified_detection_ctx_t *ctx);
 static void disconnect_from_stream(unified_detection_ctx_t *ctx);
 static int process_packet(unified_detection_ctx_t *ctx, AVPacket *pkt);
 static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt);
+static uint8_t *udt_frame_to_rgb(unified_detection_ctx_t *ctx, const AVFrame *frame);
+static bool udt_frame_has_luma_plane(const AVFrame *frame);
+static void udt_release_frame_cache(unified_detection_ctx_t *ctx);
+static void udt_decode_latest_frame(unified_detection_ctx_t *ctx, const AVPacket *pkt);
+static AVFrame *udt_decode_detection_frame(unified_detection_ctx_t *ctx, const AVPacket *pkt);
 static int udt_start_recording(unified_detection_ctx_t *ctx);
 static int udt_stop_recording(unified_detection_ctx_t *ctx);
 static int flush_prebuffer_to_recording(unified_detection_ctx_t *ctx);
@@ -661,7 +670,10 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
     // Use the global segment_duration config for chunking detection recordings (same as continuous recordings)
     ctx->segment_duration = (global_cfg && global_cfg->mp4_segment_duration > 0) ? global_cfg->mp4_segment_duration : 30;
     ctx->detection_interval = config.detection_interval > 0 ? config.detection_interval : DEFAULT_DETECTION_INTERVAL;
+    ctx->decode_mode = udt_decode_mode_from_string(config.detection_decode_mode);
+    ctx->decode_gop_interval = config.detection_decode_gop_interval > 0 ? config.detection_decode_gop_interval : 1;
     ctx->record_audio = config.record_audio;
+    safe_strcpy(ctx->recording_format, config.recording_format, sizeof(ctx->recording_format), 0);
     ctx->annotation_only = annotation_only;
     atomic_store(&ctx->external_motion_trigger, 0);  // no pending external trigger
 
@@ -728,8 +740,10 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
         return -1;
     }
 
-    // Create circular buffer for pre-detection content
-    ctx->packet_buffer = create_packet_buffer(stream_name, ctx->pre_buffer_seconds, BUFFER_MODE_MEMORY);
+    // Create circular buffer for pre-detection content.  Pooled mode copies
+    // packets into a per-stream byte ring, so the ingest loop does no
+    // per-packet allocation once the buffer has warmed up.
+    ctx->packet_buffer = create_packet_buffer(stream_name, ctx->pre_buffer_seconds, BUFFER_MODE_MEMORY_POOLED);
     if (!ctx->packet_buffer) {
         log_error("Failed to create pre-detection buffer for stream %s", stream_name);
         pthread_mutex_destroy(&ctx->mutex);
@@ -737,6 +751,9 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
         pthread_mutex_unlock(&contexts_mutex);
         return -1;
     }
+    // Under pool memory pressure, lower-priority streams give up pre-roll first
+    ctx->priority = config.priority > 0 ? config.priority : PACKET_BUFFER_DEFAULT_PRIORITY;
+    packet_buffer_set_priority(ctx->packet_buffer, ctx->priority);
 
     // Initialize atomic variables
     atomic_store(&ctx->running, 1);
@@ -804,8 +821,9 @@ int start_unified_detection_thread(const char *stream_name, const char *model_pa
 
     pthread_mutex_unlock(&contexts_mutex);
 
-    log_info("Started unified detection thread for stream %s (model=%s, threshold=%.2f, interval=%d, pre-buffer=%ds, post-buffer=%ds, segment=%ds)",
+    log_info("Started unified detection thread for stream %s (model=%s, threshold=%.2f, interval=%d, decode=%s/%d, pre-buffer=%ds, post-buffer=%ds, segment=%ds)",
              stream_name, ctx->model_path, ctx->detection_threshold, ctx->detection_interval,
+             udt_decode_mode_to_string(ctx->decode_mode), ctx->decode_gop_interval,
              ctx->pre_buffer_seconds, ctx->post_buffer_seconds, ctx->segment_duration);
 
     return 0;
@@ -969,6 +987,61 @@ int get_unified_detection_stats(const char *stream_name,
     return 0;
 }
 
+/**
+ * Parse a stream's detection_decode_mode setting
+ */
+udt_decode_mode_t udt_decode_mode_from_string(const char *mode) {
+    if (!mode || mode[0] == '\0') {
+        return UDT_DECODE_KEYFRAMES;
+    }
+    if (strcasecmp(mode, "gop") == 0) {
+        return UDT_DECODE_GOP;
+    }
+    if (strcasecmp(mode, "full") == 0) {
+        return UDT_DECODE_FULL;
+    }
+    return UDT_DECODE_KEYFRAMES;
+}
+
+/**
+ * Get the configuration string for a decode mode
+ */
+const char *udt_decode_mode_to_string(udt_decode_mode_t mode) {
+    switch (mode) {
+        case UDT_DECODE_GOP:  return "gop";
+        case UDT_DECODE_FULL: return "full";
+        case UDT_DECODE_KEYFRAMES:
+        default:              return "keyframes";
+    }
+}
+
+/**
+ * Get detection frame conversion cache statistics for a unified detection thread
+ */
+int get_unified_detection_frame_cache_stats(const char *stream_name,
+                                            udt_frame_cache_stats_t *stats) {
+    if (!stream_name || !stats) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&contexts_mutex);
+
+    unified_detection_ctx_t *ctx = find_context_by_name(stream_name);
+    if (!ctx) {
+        pthread_mutex_unlock(&contexts_mutex);
+        return -1;
+    }
+
+    stats->scaler_rebuilds = atomic_load(&ctx->scaler_rebuilds);
+    stats->scaler_reuses = atomic_load(&ctx->scaler_reuses);
+    stats->buffer_allocs = atomic_load(&ctx->frame_buffer_allocs);
+    stats->buffer_reuses = atomic_load(&ctx->frame_buffer_reuses);
+
+    pthread_mutex_unlock(&contexts_mutex);
+
+    return 0;
+}
+
 /**
  * Notify a UDT-managed stream of an externally-detected motion event.
  *
@@ -1024,32 +1097,49 @@ static int connect_to_stream(unified_detection_ctx_t *ctx) {
     ctx->input_ctx->interrupt_callback.callback = ffmpeg_interrupt_callback;
     ctx->input_ctx->interrupt_callback.opaque = ctx;
 
-    // Set RTSP options
-    AVDictionary *opts = NULL;
-    av_dict_set(&opts, "rtsp_transport", "tcp", 0);
-    av_dict_set(&opts, "stimeout", "5000000", 0);  // 5 second timeout
-    av_dict_set(&opts, "analyzeduration", "1000000", 0);
-    av_dict_set(&opts, "probesize", "1000000", 0);
+    int ret;
+    if (g_config.shared_ingest) {
+        // Share the camera connection with HLS and MP4 recording
+        stream_ingest_consumer_config_t ingest_cfg = {
+            .queue_packets = STREAM_INGEST_DEFAULT_QUEUE_PACKETS,
+            .drop_policy = STREAM_INGEST_DROP_TO_KEYFRAME,
+        };
+        ret = stream_ingest_open_input(&ctx->input_ctx, ctx->stream_name, ctx->rtsp_url,
+                                       STREAM_PROTOCOL_TCP, &ingest_cfg);
+        if (ret < 0) {
+            char err_buf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, err_buf, sizeof(err_buf));
+            log_error("[%s] Failed to open shared input: %s", ctx->stream_name, err_buf);
+            return -1;
+        }
+    } else {
+        // Set RTSP options
+        AVDictionary *opts = NULL;
+        av_dict_set(&opts, "rtsp_transport", "tcp", 0);
+        av_dict_set(&opts, "stimeout", "5000000", 0);  // 5 second timeout
+        av_dict_set(&opts, "analyzeduration", "1000000", 0);
+        av_dict_set(&opts, "probesize", "1000000", 0);
 
-    // Open input
-    int ret = avformat_open_input(&ctx->input_ctx, ctx->rtsp_url, NULL, &opts);
-    av_dict_free(&opts);
+        // Open input
+        ret = avformat_open_input(&ctx->input_ctx, ctx->rtsp_url, NULL, &opts);
+        av_dict_free(&opts);
 
-    if (ret < 0) {
-        char err_buf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, err_buf, sizeof(err_buf));
-        log_error("[%s] Failed to open input: %s", ctx->stream_name, err_buf);
-        avformat_free_context(ctx->input_ctx);
-        ctx->input_ctx = NULL;
-        return -1;
-    }
+        if (ret < 0) {
+            char err_buf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, err_buf, sizeof(err_buf));
+            log_error("[%s] Failed to open input: %s", ctx->stream_name, err_buf);
+            avformat_free_context(ctx->input_ctx);
+            ctx->input_ctx = NULL;
+            return -1;
+        }
 
-    // Find stream info
-    ret = avformat_find_stream_info(ctx->input_ctx, NULL);
-    if (ret < 0) {
-        log_error("[%s] Failed to find stream info", ctx->stream_name);
-        avformat_close_input(&ctx->input_ctx);
-        return -1;
+        // Find stream info
+        ret = avformat_find_stream_info(ctx->input_ctx, NULL);
+        if (ret < 0) {
+            log_error("[%s] Failed to find stream info", ctx->stream_name);
+            avformat_close_input(&ctx->input_ctx);
+            return -1;
+        }
     }
 
     // Find video stream
@@ -1095,6 +1185,14 @@ static int connect_to_stream(unified_detection_ctx_t *ctx) {
         return -1;
     }
 
+    // Unless every frame is decoded, only keyframes are ever sent to the
+    // decoder; have it discard anything else instead of producing frames
+    // with missing references
+    if (ctx->decode_mode != UDT_DECODE_FULL) {
+        ctx->decoder_ctx->skip_frame = AVDISCARD_NONKEY;
+    }
+    ctx->keyframes_seen = 0;
+
     ret = avcodec_open2(ctx->decoder_ctx, decoder, NULL);
     if (ret < 0) {
         log_error("[%s] Failed to open decoder", ctx->stream_name);
@@ -1194,6 +1292,9 @@ static void udt_update_stream_video_params(unified_detection_ctx_t *ctx,
 static void disconnect_from_stream(unified_detection_ctx_t *ctx) {
     if (!ctx) return;
 
+    av_frame_free(&ctx->latest_frame);
+    frame_bus_clear(ctx->stream_name);
+
     if (ctx->decoder_ctx) {
         avcodec_free_context(&ctx->decoder_ctx);
         ctx->decoder_ctx = NULL;
@@ -1304,7 +1405,8 @@ static void *unified_detection_thread_func(void *arg) {
                 }
 
                 // Read packet
-                if (av_read_frame(ctx->input_ctx, pkt) >= 0) {
+                int read_ret = stream_ingest_read_frame(ctx->input_ctx, pkt);
+                if (read_ret >= 0) {
                     atomic_store(&ctx->last_packet_time, (int_fast64_t)time(NULL));
 
                     // Process packet (buffer, detect, record)
@@ -1315,6 +1417,11 @@ static void *unified_detection_thread_func(void *arg) {
                     state = atomic_load(&ctx->state);
 
                     av_packet_unref(pkt);
+                } else if (read_ret == AVERROR_EOF && stream_ingest_is_shared(ctx->input_ctx)) {
+                    // The shared ingest lost the camera; reopen once it reconnects
+                    log_warn("[%s] Shared input ended, reconnecting", stream_name);
+                    disconnect_from_stream(ctx);
+                    state = UDT_STATE_RECONNECTING;
                 } else {
                     // Read error - check if timeout
                     time_t now = time(NULL);
@@ -1395,6 +1502,9 @@ static void *unified_detection_thread_func(void *arg) {
     // (e.g., during shutdown while in BUFFERING/RECORDING state)
     disconnect_from_stream(ctx);
 
+    // Release the cached detection scaler and frame buffers
+    udt_release_frame_cache(ctx);
+
     // Clean up thread-local CURL handle used by go2rtc_get_snapshot()
     // This must be called from the same thread that created the handle
     go2rtc_snapshot_cleanup_thread();
@@ -1752,10 +1862,38 @@ stats_done:
         current_state = (unified_detection_state_t)atomic_load(&ctx->state);
     }
 
+    // In full decode mode every video packet goes through the decoder so a
+    // clean frame is available at any point in the GOP
+    if (is_video && ctx->decode_mode == UDT_DECODE_FULL && !is_onvif_detection_model(ctx->model_path)) {
+        udt_decode_latest_frame(ctx, pkt);
+    }
+
+    // Pick the sampling points for detection from the decode strategy:
+    //  - keyframes: every keyframe is a candidate, gated by detection_interval
+    //  - gop:       every Nth keyframe runs detection, no time gate
+    //  - full:      every decoded video frame is a candidate, gated by detection_interval
+    bool sample_point = false;
+    switch (ctx->decode_mode) {
+        case UDT_DECODE_GOP:
+            if (is_keyframe) {
+                sample_point = (ctx->keyframes_seen++ % (uint64_t)ctx->decode_gop_interval) == 0;
+            }
+            break;
+        case UDT_DECODE_FULL:
+            sample_point = is_video && (ctx->latest_frame != NULL || is_onvif_detection_model(ctx->model_path));
+            break;
+        case UDT_DECODE_KEYFRAMES:
+        default:
+            sample_point = is_keyframe;
+            break;
+    }
+
+    uint64_t frames_decoded_before = ctx->frames_decoded;
+
     // Run detection based on time interval (in seconds)
-    // We check on keyframes as a convenient trigger point, but the decision is time-based
+    // Sampling points are a convenient trigger, but outside gop mode the decision is time-based
     // This ensures detection_interval is interpreted as seconds, not keyframe count
-    if (is_keyframe && current_state != UDT_STATE_POST_BUFFER) {
+    if (sample_point && current_state != UDT_STATE_POST_BUFFER) {
 
         time_t time_since_last_check = now - (time_t)atomic_load(&ctx->last_detection_check_time);
 
@@ -1767,7 +1905,7 @@ stats_done:
         }
 
         // Run detection if enough time has passed (detection_interval is in seconds)
-        if (time_since_last_check >= ctx->detection_interval) {
+        if (ctx->decode_mode == UDT_DECODE_GOP || time_since_last_check >= ctx->detection_interval) {
             atomic_store(&ctx->last_detection_check_time, (long long)now);
 
             log_info("[%s] Running detection (interval=%ds, elapsed=%lds, model=%s)",
@@ -1851,6 +1989,17 @@ stats_done:
         }
     }
 
+    // Frame bus subscribers (MQTT snapshots, ...) share this thread's
+    // decoder instead of opening the camera again.  Outside full decode mode
+    // only the keyframes detection needed were decoded above, so decode this
+    // one too if a subscriber is waiting for a frame.
+    if (is_keyframe && ctx->decode_mode != UDT_DECODE_FULL &&
+        ctx->frames_decoded == frames_decoded_before &&
+        frame_bus_wants_frame(ctx->stream_name)) {
+        AVFrame *bus_frame = udt_decode_detection_frame(ctx, pkt);
+        av_frame_free(&bus_frame);
+    }
+
     return 0;
 }
 
@@ -1896,6 +2045,8 @@ static int udt_start_recording(unified_detection_ctx_t *ctx) {
         return -1;
     }
 
+    mp4_writer_set_recording_format(ctx->mp4_writer, ctx->recording_format);
+
     // Configure audio recording based on stream settings
     if (ctx->record_audio && ctx->audio_stream_idx >= 0) {
         mp4_writer_set_audio(ctx->mp4_writer, 1);
@@ -2110,6 +2261,229 @@ static int flush_prebuffer_to_recording(unified_detection_ctx_t *ctx) {
     return 0;
 }
 
+/**
+ * Convert a decoded frame to packed RGB24 using the context's cached scaler
+ * and frame pool.
+ *
+ * The scaler is rebuilt only when the source width, height or pixel format
+ * changes, and the pool buffers are reallocated only when the output size
+ * changes.  The returned buffer belongs to ctx->frame_pool and remains valid
+ * until UDT_FRAME_POOL_SIZE further conversions; callers must not free it.
+ *
+ * @param ctx The unified detection context
+ * @param frame Decoded video frame
+ * @return Pointer to width * height * 3 bytes of RGB24, or NULL on error
+ */
+static uint8_t *udt_frame_to_rgb(unified_detection_ctx_t *ctx, const AVFrame *frame) {
+    if (!ctx || !frame || frame->width <= 0 || frame->height <= 0) {
+        return NULL;
+    }
+
+    int width = frame->width;
+    int height = frame->height;
+
+    if (!ctx->sws_ctx ||
+        ctx->sws_src_width != width ||
+        ctx->sws_src_height != height ||
+        ctx->sws_src_format != frame->format) {
+
+        if (ctx->sws_ctx) {
+            log_info("[%s] Detection frame geometry changed (%dx%d fmt %d -> %dx%d fmt %d), rebuilding scaler",
+                     ctx->stream_name, ctx->sws_src_width, ctx->sws_src_height, ctx->sws_src_format,
+                     width, height, frame->format);
+            sws_freeContext(ctx->sws_ctx);
+            ctx->sws_ctx = NULL;
+        }
+
+        ctx->sws_ctx = sws_getContext(width, height, frame->format,
+                                      width, height, AV_PIX_FMT_RGB24,
+                                      SWS_BILINEAR, NULL, NULL, NULL);
+        if (!ctx->sws_ctx) {
+            log_error("[%s] Failed to create sws context", ctx->stream_name);
+            ctx->sws_src_width = 0;
+            ctx->sws_src_height = 0;
+            ctx->sws_src_format = AV_PIX_FMT_NONE;
+            return NULL;
+        }
+
+        ctx->sws_src_width = width;
+        ctx->sws_src_height = height;
+        ctx->sws_src_format = frame->format;
+        atomic_fetch_add(&ctx->scaler_rebuilds, 1);
+    } else {
+        atomic_fetch_add(&ctx->scaler_reuses, 1);
+    }
+
+    // Resize the pool if the output size changed
+    size_t needed = (size_t)width * height * 3;
+    if (needed != ctx->frame_pool_buf_size) {
+        for (int i = 0; i < UDT_FRAME_POOL_SIZE; i++) {
+            av_freep(&ctx->frame_pool[i]);
+        }
+        ctx->frame_pool_buf_size = needed;
+        ctx->frame_pool_next = 0;
+    }
+
+    int slot = ctx->frame_pool_next;
+    ctx->frame_pool_next = (slot + 1) % UDT_FRAME_POOL_SIZE;
+
+    if (!ctx->frame_pool[slot]) {
+        ctx->frame_pool[slot] = av_malloc(needed);
+        if (!ctx->frame_pool[slot]) {
+            log_error("[%s] Failed to allocate RGB buffer (%zu bytes)", ctx->stream_name, needed);
+            return NULL;
+        }
+        atomic_fetch_add(&ctx->frame_buffer_allocs, 1);
+    } else {
+        atomic_fetch_add(&ctx->frame_buffer_reuses, 1);
+    }
+
+    uint8_t *rgb_data[4] = {ctx->frame_pool[slot], NULL, NULL, NULL};
+    int rgb_linesize[4] = {width * 3, 0, 0, 0};
+
+    sws_scale(ctx->sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
+              0, height, rgb_data, rgb_linesize);
+
+    return ctx->frame_pool[slot];
+}
+
+/**
+ * Check whether a decoded frame stores 8-bit luma as its first plane
+ *
+ * True for the planar and semi-planar YUV formats that H.264/HEVC decoders
+ * produce, where data[0]/linesize[0] is a full-resolution Y plane.
+ */
+static bool udt_frame_has_luma_plane(const AVFrame *frame) {
+    if (!frame || !frame->data[0] || frame->linesize[0] < frame->width) {
+        return false;
+    }
+
+    switch (frame->format) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_YUV422P:
+        case AV_PIX_FMT_YUVJ422P:
+        case AV_PIX_FMT_YUV444P:
+        case AV_PIX_FMT_YUVJ444P:
+        case AV_PIX_FMT_NV12:
+        case AV_PIX_FMT_NV21:
+        case AV_PIX_FMT_GRAY8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Feed a video packet to the decoder and keep the newest frame it produces
+ *
+ * Used in UDT_DECODE_FULL mode, where every video packet is decoded so that
+ * detection can sample any frame rather than waiting for the next keyframe.
+ * Decoded frames are also offered to the stream's frame bus.
+ */
+static void udt_decode_latest_frame(unified_detection_ctx_t *ctx, const AVPacket *pkt) {
+    if (!ctx->decoder_ctx) return;
+
+    int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
+    if (ret < 0 && ret != AVERROR(EAGAIN)) {
+        log_debug("[%s] Full decode: avcodec_send_packet error %d", ctx->stream_name, ret);
+        return;
+    }
+
+    if (!ctx->latest_frame) {
+        ctx->latest_frame = av_frame_alloc();
+        if (!ctx->latest_frame) return;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) return;
+
+    // Drain everything the decoder has ready; only the newest frame is kept
+    bool decoded = false;
+    while (avcodec_receive_frame(ctx->decoder_ctx, frame) == 0) {
+        av_frame_unref(ctx->latest_frame);
+        av_frame_move_ref(ctx->latest_frame, frame);
+        decoded = true;
+    }
+    av_frame_free(&frame);
+
+    if (decoded) {
+        ctx->frames_decoded++;
+        frame_bus_publish(ctx->stream_name, ctx->latest_frame);
+    }
+
+    // Nothing decoded yet (e.g. still waiting for the first keyframe)
+    if (!ctx->latest_frame->data[0]) {
+        av_frame_free(&ctx->latest_frame);
+    }
+}
+
+/**
+ * Get a decoded frame to run detection on
+ *
+ * In UDT_DECODE_FULL mode this returns a new reference to the newest frame
+ * already decoded by udt_decode_latest_frame(); otherwise pkt (a keyframe) is
+ * decoded on its own and published to the stream's frame bus.  The caller
+ * must av_frame_free() the result.
+ *
+ * @return Decoded frame, or NULL if none is available
+ */
+static AVFrame *udt_decode_detection_frame(unified_detection_ctx_t *ctx, const AVPacket *pkt) {
+    if (ctx->decode_mode == UDT_DECODE_FULL) {
+        return ctx->latest_frame ? av_frame_clone(ctx->latest_frame) : NULL;
+    }
+
+    if (!pkt || !ctx->decoder_ctx) return NULL;
+
+    int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
+    if (ret < 0) {
+        return NULL;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        return NULL;
+    }
+
+    ret = avcodec_receive_frame(ctx->decoder_ctx, frame);
+    if (ret < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    ctx->frames_decoded++;
+    frame_bus_publish(ctx->stream_name, frame);
+
+    return frame;
+}
+
+/**
+ * Free the cached detection scaler and frame pool
+ */
+static void udt_release_frame_cache(unified_detection_ctx_t *ctx) {
+    if (!ctx) return;
+
+    if (ctx->sws_ctx) {
+        sws_freeContext(ctx->sws_ctx);
+        ctx->sws_ctx = NULL;
+    }
+    for (int i = 0; i < UDT_FRAME_POOL_SIZE; i++) {
+        av_freep(&ctx->frame_pool[i]);
+    }
+    ctx->frame_pool_buf_size = 0;
+    ctx->frame_pool_next = 0;
+    ctx->sws_src_width = 0;
+    ctx->sws_src_height = 0;
+    ctx->sws_src_format = AV_PIX_FMT_NONE;
+
+    log_debug("[%s] Detection frame cache released (scaler rebuilds=%llu reuses=%llu, buffer allocs=%llu reuses=%llu)",
+              ctx->stream_name,
+              (unsigned long long)atomic_load(&ctx->scaler_rebuilds),
+              (unsigned long long)atomic_load(&ctx->scaler_reuses),
+              (unsigned long long)atomic_load(&ctx->frame_buffer_allocs),
+              (unsigned long long)atomic_load(&ctx->frame_buffer_reuses));
+}
+
 /**
  * Run detection on a keyframe
  *
@@ -2159,63 +2533,27 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
             }
 
             // Decode the packet to get a frame
-            int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
-            if (ret < 0) {
-                log_debug("[%s] Fallback decode failed: avcodec_send_packet error %d", ctx->stream_name, ret);
-                return false;
-            }
-
-            AVFrame *frame = av_frame_alloc();
+            AVFrame *frame = udt_decode_detection_frame(ctx, pkt);
             if (!frame) {
-                log_debug("[%s] Fallback decode failed: could not allocate frame", ctx->stream_name);
-                return false;
-            }
-
-            ret = avcodec_receive_frame(ctx->decoder_ctx, frame);
-            if (ret < 0) {
-                av_frame_free(&frame);
-                log_debug("[%s] Fallback decode failed: avcodec_receive_frame error %d", ctx->stream_name, ret);
+                log_debug("[%s] Fallback decode failed: no frame available", ctx->stream_name);
                 return false;
             }
 
-            // Convert frame to RGB for API detection
+            // Convert frame to RGB for API detection (buffer owned by ctx->frame_pool)
             int width = frame->width;
             int height = frame->height;
             int channels = 3;  // RGB
 
-            struct SwsContext *sws_ctx = sws_getContext(
-                width, height, frame->format,
-                width, height, AV_PIX_FMT_RGB24,
-                SWS_BILINEAR, NULL, NULL, NULL);
-
-            if (!sws_ctx) {
-                log_error("[%s] Fallback: failed to create sws context", ctx->stream_name);
-                av_frame_free(&frame);
-                return false;
-            }
-
-            size_t rgb_buffer_size = (size_t)width * height * channels;
-            uint8_t *rgb_buffer = malloc(rgb_buffer_size);
+            uint8_t *rgb_buffer = udt_frame_to_rgb(ctx, frame);
+            av_frame_free(&frame);
             if (!rgb_buffer) {
-                log_error("[%s] Fallback: failed to allocate RGB buffer", ctx->stream_name);
-                sws_freeContext(sws_ctx);
-                av_frame_free(&frame);
+                log_error("[%s] Fallback: failed to convert frame to RGB", ctx->stream_name);
                 return false;
             }
 
-            uint8_t *rgb_data[4] = {rgb_buffer, NULL, NULL, NULL};
-            int rgb_linesize[4] = {width * channels, 0, 0, 0};
-
-            sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
-                      0, height, rgb_data, rgb_linesize);
-
-            sws_freeContext(sws_ctx);
-            av_frame_free(&frame);
-
             // Get the actual API URL
             const char *actual_api_url = get_actual_api_url(ctx->stream_name, ctx->model_path);
             if (actual_api_url == NULL) {
-                free(rgb_buffer);
                 return false;
             }
 
@@ -2225,8 +2563,6 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
             detect_ret = detect_objects_api(actual_api_url, rgb_buffer, width, height, channels,
                                             &result, ctx->stream_name, ctx->detection_threshold, rec_id);
 
-            free(rgb_buffer);
-
             if (detect_ret != 0) {
                 log_warn("[%s] Fallback API detection failed with error %d", ctx->stream_name, detect_ret);
                 return false;
@@ -2267,62 +2603,43 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
         if (!pkt || !ctx->decoder_ctx) return false;
 
         // Decode the packet to get a frame
-        int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
-        if (ret < 0) {
-            return false;
-        }
-
-        AVFrame *motion_frame = av_frame_alloc();
+        AVFrame *motion_frame = udt_decode_detection_frame(ctx, pkt);
         if (!motion_frame) {
             return false;
         }
 
-        ret = avcodec_receive_frame(ctx->decoder_ctx, motion_frame);
-        if (ret < 0) {
-            av_frame_free(&motion_frame);
-            return false;
-        }
-
-        // Convert frame to RGB for motion detection
-        int mot_width = motion_frame->width;
-        int mot_height = motion_frame->height;
-        int mot_channels = 3;  // RGB
-
-        struct SwsContext *mot_sws_ctx = sws_getContext(
-            mot_width, mot_height, motion_frame->format,
-            mot_width, mot_height, AV_PIX_FMT_RGB24,
-            SWS_BILINEAR, NULL, NULL, NULL);
-
-        if (!mot_sws_ctx) {
-            log_error("[%s] Failed to create sws context for motion detection", ctx->stream_name);
+        time_t mot_frame_time = time(NULL);
+        int mot_ret;
+
+        if (udt_frame_has_luma_plane(motion_frame)) {
+            // Fast path: run motion detection straight on the decoded Y plane,
+            // skipping the RGB conversion that would only be thrown away again
+            bool full_range = motion_frame->color_range == AVCOL_RANGE_JPEG ||
+                              motion_frame->format == AV_PIX_FMT_YUVJ420P ||
+                              motion_frame->format == AV_PIX_FMT_YUVJ422P ||
+                              motion_frame->format == AV_PIX_FMT_YUVJ444P ||
+                              motion_frame->format == AV_PIX_FMT_GRAY8;
+            mot_ret = detect_motion_luma(ctx->stream_name, motion_frame->data[0],
+                                         motion_frame->width, motion_frame->height,
+                                         motion_frame->linesize[0], full_range,
+                                         mot_frame_time, &result);
             av_frame_free(&motion_frame);
-            return false;
-        }
+        } else {
+            // Convert frame to RGB for motion detection (buffer owned by ctx->frame_pool)
+            int mot_width = motion_frame->width;
+            int mot_height = motion_frame->height;
+            int mot_channels = 3;  // RGB
 
-        size_t mot_buffer_size = (size_t)mot_width * mot_height * mot_channels;
-        uint8_t *mot_rgb_buffer = malloc(mot_buffer_size);
-        if (!mot_rgb_buffer) {
-            log_error("[%s] Failed to allocate RGB buffer for motion detection", ctx->stream_name);
-            sws_freeContext(mot_sws_ctx);
+            uint8_t *mot_rgb_buffer = udt_frame_to_rgb(ctx, motion_frame);
             av_frame_free(&motion_frame);
-            return false;
-        }
-
-        uint8_t *mot_rgb_data[4] = {mot_rgb_buffer, NULL, NULL, NULL};
-        int mot_rgb_linesize[4] = {mot_width * mot_channels, 0, 0, 0};
-
-        sws_scale(mot_sws_ctx, (const uint8_t * const *)motion_frame->data, motion_frame->linesize,
-                  0, mot_height, mot_rgb_data, mot_rgb_linesize);
-
-        sws_freeContext(mot_sws_ctx);
-        av_frame_free(&motion_frame);
+            if (!mot_rgb_buffer) {
+                log_error("[%s] Failed to convert frame to RGB for motion detection", ctx->stream_name);
+                return false;
+            }
 
-        // Run built-in motion detection
-        time_t mot_frame_time = time(NULL);
-        int mot_ret = detect_motion(ctx->stream_name, mot_rgb_buffer, mot_width, mot_height,
+            mot_ret = detect_motion(ctx->stream_name, mot_rgb_buffer, mot_width, mot_height,
                                     mot_channels, mot_frame_time, &result);
-
-        free(mot_rgb_buffer);
+        }
 
         if (mot_ret != 0) {
             log_warn("[%s] Motion detection failed with error %d", ctx->stream_name, mot_ret);
@@ -2422,8 +2739,9 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
     // Embedded model detection - requires frame decoding
     if (!pkt || !ctx->decoder_ctx) return false;
 
-    // Check if we have a detection model loaded
-    if (!ctx->model) {
+    // Without the shared inference scheduler each stream runs its own model
+    bool use_scheduler = inference_scheduler_is_running();
+    if (!use_scheduler && !ctx->model) {
         // Try to load the model if we have a path
         if (ctx->model_path[0] != '\0') {
             ctx->model = load_detection_model(ctx->model_path, ctx->detection_threshold);
@@ -2438,63 +2756,43 @@ static bool run_detection_on_frame(unified_detection_ctx_t *ctx, AVPacket *pkt)
     }
 
     // Decode the packet to get a frame
-    int ret = avcodec_send_packet(ctx->decoder_ctx, pkt);
-    if (ret < 0) {
-        return false;
-    }
-
-    AVFrame *frame = av_frame_alloc();
+    AVFrame *frame = udt_decode_detection_frame(ctx, pkt);
     if (!frame) {
         return false;
     }
 
-    ret = avcodec_receive_frame(ctx->decoder_ctx, frame);
-    if (ret < 0) {
-        av_frame_free(&frame);
-        return false;
-    }
-
-    // Convert frame to RGB for detection
+    // Convert frame to RGB for detection (buffer owned by ctx->frame_pool)
     int width = frame->width;
     int height = frame->height;
     int channels = 3;  // RGB
 
-    // Create software scaler for conversion
-    struct SwsContext *sws_ctx = sws_getContext(
-        width, height, frame->format,
-        width, height, AV_PIX_FMT_RGB24,
-        SWS_BILINEAR, NULL, NULL, NULL);
-
-    if (!sws_ctx) {
-        log_error("[%s] Failed to create sws context", ctx->stream_name);
-        av_frame_free(&frame);
-        return false;
-    }
-
-    // Allocate RGB buffer
-    size_t rgb_buffer_size = (size_t)width * height * channels;
-    uint8_t *rgb_buffer = malloc(rgb_buffer_size);
+    uint8_t *rgb_buffer = udt_frame_to_rgb(ctx, frame);
+    av_frame_free(&frame);
     if (!rgb_buffer) {
-        log_error("[%s] Failed to allocate RGB buffer", ctx->stream_name);
-        sws_freeContext(sws_ctx);
-        av_frame_free(&frame);
+        log_error("[%s] Failed to convert frame to RGB", ctx->stream_name);
         return false;
     }
 
-    // Convert frame to RGB
-    uint8_t *rgb_data[4] = {rgb_buffer, NULL, NULL, NULL};
-    int rgb_linesize[4] = {width * channels, 0, 0, 0};
-
-    sws_scale(sws_ctx, (const uint8_t * const *)frame->data, frame->linesize,
-              0, height, rgb_data, rgb_linesize);
-
-    sws_freeContext(sws_ctx);
-    av_frame_free(&frame);
-
     // Run detection
-    int detect_ret = detect_objects(ctx->model, rgb_buffer, width, height, channels, &result);
-
-    free(rgb_buffer);
+    int detect_ret;
+    if (use_scheduler) {
+        // The frame is stale once the next detection check is due
+        inference_request_t req = {
+            .stream_name = ctx->stream_name,
+            .model_path = ctx->model_path,
+            .threshold = ctx->detection_threshold,
+            .frame = { rgb_buffer, width, height, channels },
+            .priority = ctx->priority,
+            .deadline_ms = ctx->detection_interval * 1000,
+        };
+        detect_ret = inference_scheduler_detect(&req, &result);
+        if (detect_ret == INFERENCE_DROPPED) {
+            log_debug("[%s] Detection frame dropped by the inference scheduler", ctx->stream_name);
+            return false;
+        }
+    } else {
+        detect_ret = detect_objects(ctx->model, rgb_buffer, width, height, channels, &result);
+    }
 
     if (detect_ret != 0) {
         log_warn("[%s] Detection failed with error %d", ctx->stream_name, detect_ret);
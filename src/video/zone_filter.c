@@ -1,5 +1,20 @@
+/**
+ * Detection zone filtering
+ *
+ * Zones are read from the database once per stream and compiled into an
+ * immutable zone_geometry_t: the enabled zones with their class filters
+ * already split, plus a ZONE_RASTER_SIZE x ZONE_RASTER_SIZE raster of the
+ * normalized frame.  Each raster cell holds a bitmask of the zones that
+ * cover it entirely and a bitmask of the zones whose outline crosses it, so
+ * a point lookup is one cell read and only runs the polygon test for zones
+ * whose edge passes through that cell.  The compiled geometry is reused
+ * until the zones table version changes.
+ */
+
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "video/zone_filter.h"
 #include "database/db_zones.h"
@@ -8,6 +23,46 @@
 #include "core/config.h"
 #include "utils/strings.h"
 
+// Raster cells per side; only changes how often the exact polygon test runs
+#define ZONE_RASTER_SIZE 64
+
+// Widen cells slightly when testing edges so float rounding near a cell
+// border never hides an edge from the cell
+#define ZONE_EDGE_EPSILON 1e-5f
+
+// Enabled zones are indexed by bit in a uint16_t mask
+_Static_assert(MAX_ZONES_PER_STREAM <= 16, "zone masks are 16 bits wide");
+
+typedef struct {
+    char id[MAX_ZONE_ID];
+    char name[MAX_ZONE_NAME];
+    zone_point_t polygon[MAX_ZONE_POINTS];
+    int polygon_count;
+    float min_confidence;
+    bool has_class_filter;
+    int class_count;
+    char class_buf[256];                // filter_classes split in place
+    uint8_t class_offsets[128];         // Start of each trimmed class name in class_buf
+} compiled_zone_t;
+
+typedef struct {
+    int refs;                           // Cache reference plus one per reader
+    uint64_t version;                   // Zones table version it was built from
+    int zone_count;                     // Enabled zones
+    compiled_zone_t zones[MAX_ZONES_PER_STREAM];
+    uint16_t inside[ZONE_RASTER_SIZE * ZONE_RASTER_SIZE];  // Zones covering the whole cell
+    uint16_t edge[ZONE_RASTER_SIZE * ZONE_RASTER_SIZE];    // Zones whose outline crosses the cell
+} zone_geometry_t;
+
+typedef struct {
+    char stream_name[MAX_STREAM_NAME];
+    zone_geometry_t *geometry;
+} zone_cache_entry_t;
+
+static zone_cache_entry_t zone_cache[MAX_STREAMS];
+static int zone_cache_next_evict;
+static pthread_mutex_t zone_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Check if a point is inside a polygon using ray casting algorithm
  */
@@ -32,60 +87,274 @@ static bool point_in_polygon(float x, float y, const zone_point_t *polygon, int
     return inside;
 }
 
+/* ------------------------------------------------------------------ */
+/*  Compiling zones                                                    */
+/* ------------------------------------------------------------------ */
+
 /**
- * Check if a detection's center point is within a zone
+ * Check whether a segment touches an axis-aligned box (Liang-Barsky clip)
  */
-static bool detection_in_zone(const detection_t *detection, const detection_zone_t *zone) {
-    if (!detection || !zone || !zone->enabled) {
-        return false;
+static bool segment_touches_box(float x0, float y0, float x1, float y1,
+                                float min_x, float min_y, float max_x, float max_y) {
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float p[4] = { -dx, dx, -dy, dy };
+    float q[4] = { x0 - min_x, max_x - x0, y0 - min_y, max_y - y0 };
+
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f) {
+                return false;
+            }
+            continue;
+        }
+        float t = q[i] / p[i];
+        if (p[i] < 0.0f) {
+            if (t > t1) return false;
+            if (t > t0) t0 = t;
+        } else {
+            if (t < t0) return false;
+            if (t < t1) t1 = t;
+        }
     }
+    return true;
+}
 
-    // Calculate center point of detection bounding box
-    float center_x = detection->x + (detection->width / 2.0f);
-    float center_y = detection->y + (detection->height / 2.0f);
+static int raster_cell(float v) {
+    int c = (int)floorf(v * ZONE_RASTER_SIZE);
+    if (c < 0) return 0;
+    if (c >= ZONE_RASTER_SIZE) return ZONE_RASTER_SIZE - 1;
+    return c;
+}
+
+static void rasterize_zone(zone_geometry_t *geom, const compiled_zone_t *zone, uint16_t bit) {
+    const float cell = 1.0f / ZONE_RASTER_SIZE;
+
+    // Mark every cell an edge passes through
+    for (int i = 0, j = zone->polygon_count - 1; i < zone->polygon_count; j = i++) {
+        const zone_point_t *a = &zone->polygon[j];
+        const zone_point_t *b = &zone->polygon[i];
+
+        int cx0 = raster_cell(fminf(a->x, b->x) - ZONE_EDGE_EPSILON);
+        int cx1 = raster_cell(fmaxf(a->x, b->x) + ZONE_EDGE_EPSILON);
+        int cy0 = raster_cell(fminf(a->y, b->y) - ZONE_EDGE_EPSILON);
+        int cy1 = raster_cell(fmaxf(a->y, b->y) + ZONE_EDGE_EPSILON);
+
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                if (segment_touches_box(a->x, a->y, b->x, b->y,
+                                        cx * cell - ZONE_EDGE_EPSILON, cy * cell - ZONE_EDGE_EPSILON,
+                                        (cx + 1) * cell + ZONE_EDGE_EPSILON,
+                                        (cy + 1) * cell + ZONE_EDGE_EPSILON)) {
+                    geom->edge[cy * ZONE_RASTER_SIZE + cx] |= bit;
+                }
+            }
+        }
+    }
 
-    // Check if center is in polygon
-    return point_in_polygon(center_x, center_y, zone->polygon, zone->polygon_count);
+    // No outline crosses the remaining cells, so their center decides
+    for (int cy = 0; cy < ZONE_RASTER_SIZE; cy++) {
+        for (int cx = 0; cx < ZONE_RASTER_SIZE; cx++) {
+            int idx = cy * ZONE_RASTER_SIZE + cx;
+            if (!(geom->edge[idx] & bit) &&
+                point_in_polygon((cx + 0.5f) * cell, (cy + 0.5f) * cell,
+                                 zone->polygon, zone->polygon_count)) {
+                geom->inside[idx] |= bit;
+            }
+        }
+    }
 }
 
 /**
- * Check if a detection's class matches the zone's filter
+ * Split a comma-separated class list, trimming spaces around each name
  */
-static bool detection_class_matches(const detection_t *detection, const detection_zone_t *zone) {
-    // If no filter is set, all classes match
-    if (!zone->filter_classes || zone->filter_classes[0] == '\0') {
-        return true;
+static void compile_class_filter(compiled_zone_t *cz, const char *filter_classes) {
+    cz->has_class_filter = filter_classes[0] != '\0';
+    cz->class_count = 0;
+    if (!cz->has_class_filter) {
+        return;
     }
 
-    // Check if detection label is in the comma-separated filter list
-    char filter_copy[256];
-    safe_strcpy(filter_copy, zone->filter_classes, sizeof(filter_copy), 0);
+    safe_strcpy(cz->class_buf, filter_classes, sizeof(cz->class_buf), 0);
 
-    char *token = strtok(filter_copy, ",");
-    while (token) {
-        // Trim whitespace
+    char *saveptr = NULL;
+    char *token = strtok_r(cz->class_buf, ",", &saveptr);
+    while (token && cz->class_count < (int)sizeof(cz->class_offsets)) {
         while (*token == ' ') token++;
         char *end = token + strlen(token) - 1;
         while (end > token && *end == ' ') {
             *end = '\0';
             end--;
         }
+        cz->class_offsets[cz->class_count++] = (uint8_t)(token - cz->class_buf);
+        token = strtok_r(NULL, ",", &saveptr);
+    }
+}
 
-        // Check if it matches
-        if (strcmp(token, detection->label) == 0) {
-            return true;
+static zone_geometry_t *compile_zones(const detection_zone_t *zones, int count, uint64_t version) {
+    zone_geometry_t *geom = calloc(1, sizeof(*geom));
+    if (!geom) {
+        return NULL;
+    }
+    geom->refs = 1;
+    geom->version = version;
+
+    for (int i = 0; i < count; i++) {
+        const detection_zone_t *zone = &zones[i];
+        if (!zone->enabled) {
+            continue;
         }
 
-        token = strtok(NULL, ",");
+        compiled_zone_t *cz = &geom->zones[geom->zone_count];
+        safe_strcpy(cz->id, zone->id, sizeof(cz->id), 0);
+        safe_strcpy(cz->name, zone->name, sizeof(cz->name), 0);
+        memcpy(cz->polygon, zone->polygon, sizeof(cz->polygon));
+        cz->polygon_count = zone->polygon_count;
+        cz->min_confidence = zone->min_confidence;
+        compile_class_filter(cz, zone->filter_classes);
+
+        if (cz->polygon_count >= 3) {
+            rasterize_zone(geom, cz, (uint16_t)(1u << geom->zone_count));
+        }
+        geom->zone_count++;
+    }
+
+    return geom;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Cache                                                              */
+/* ------------------------------------------------------------------ */
+
+static void release_geometry(zone_geometry_t *geom) {
+    if (!geom) {
+        return;
+    }
+    pthread_mutex_lock(&zone_cache_mutex);
+    bool last = --geom->refs == 0;
+    pthread_mutex_unlock(&zone_cache_mutex);
+    if (last) {
+        free(geom);
+    }
+}
+
+/**
+ * Get the compiled zones for a stream, loading them if the cached copy is
+ * missing or older than the zones table
+ *
+ * @return Geometry to pass to release_geometry(), or NULL on error
+ */
+static zone_geometry_t *acquire_geometry(const char *stream_name) {
+    uint64_t version = get_detection_zones_version();
+
+    pthread_mutex_lock(&zone_cache_mutex);
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        zone_cache_entry_t *e = &zone_cache[i];
+        if (e->geometry && e->geometry->version == version &&
+            strcmp(e->stream_name, stream_name) == 0) {
+            e->geometry->refs++;
+            zone_geometry_t *geom = e->geometry;
+            pthread_mutex_unlock(&zone_cache_mutex);
+            return geom;
+        }
+    }
+    pthread_mutex_unlock(&zone_cache_mutex);
+
+    detection_zone_t zones[MAX_ZONES_PER_STREAM];
+    int zone_count = get_detection_zones(stream_name, zones, MAX_ZONES_PER_STREAM);
+    if (zone_count < 0) {
+        log_error("Failed to get detection zones for stream %s", stream_name);
+        return NULL;
     }
 
+    zone_geometry_t *geom = compile_zones(zones, zone_count, version);
+    if (!geom) {
+        log_error("Failed to compile detection zones for stream %s", stream_name);
+        return NULL;
+    }
+    log_debug("Compiled %d enabled zones for stream %s (zones version %llu)",
+              geom->zone_count, stream_name, (unsigned long long)version);
+
+    // Install it, replacing the stream's old entry or the next slot in turn
+    zone_geometry_t *old = NULL;
+    pthread_mutex_lock(&zone_cache_mutex);
+    zone_cache_entry_t *slot = NULL;
+    for (int i = 0; i < MAX_STREAMS && !slot; i++) {
+        if (zone_cache[i].geometry && strcmp(zone_cache[i].stream_name, stream_name) == 0) {
+            slot = &zone_cache[i];
+        }
+    }
+    for (int i = 0; i < MAX_STREAMS && !slot; i++) {
+        if (!zone_cache[i].geometry) {
+            slot = &zone_cache[i];
+        }
+    }
+    if (!slot) {
+        slot = &zone_cache[zone_cache_next_evict];
+        zone_cache_next_evict = (zone_cache_next_evict + 1) % MAX_STREAMS;
+    }
+    if (!slot->geometry || slot->geometry->version <= version) {
+        old = slot->geometry;
+        safe_strcpy(slot->stream_name, stream_name, sizeof(slot->stream_name), 0);
+        slot->geometry = geom;
+        geom->refs++;
+    }
+    pthread_mutex_unlock(&zone_cache_mutex);
+
+    release_geometry(old);
+    return geom;
+}
+
+/**
+ * Bitmask of the enabled zones containing a point
+ */
+static uint16_t zones_at_point(const zone_geometry_t *geom, float x, float y) {
+    uint16_t hits = 0;
+    uint16_t candidates;
+
+    if (x >= 0.0f && x < 1.0f && y >= 0.0f && y < 1.0f) {
+        int idx = raster_cell(y) * ZONE_RASTER_SIZE + raster_cell(x);
+        hits = geom->inside[idx];
+        candidates = geom->edge[idx];
+    } else {
+        // Outside the raster (or NaN): test every zone
+        candidates = (uint16_t)((1u << geom->zone_count) - 1);
+    }
+
+    while (candidates) {
+        int z = __builtin_ctz(candidates);
+        candidates &= (uint16_t)(candidates - 1);
+        const compiled_zone_t *cz = &geom->zones[z];
+        if (point_in_polygon(x, y, cz->polygon, cz->polygon_count)) {
+            hits |= (uint16_t)(1u << z);
+        }
+    }
+    return hits;
+}
+
+/**
+ * Check if a detection's class matches the zone's filter
+ */
+static bool detection_class_matches(const detection_t *detection, const compiled_zone_t *zone) {
+    // If no filter is set, all classes match
+    if (!zone->has_class_filter) {
+        return true;
+    }
+
+    for (int i = 0; i < zone->class_count; i++) {
+        if (strcmp(zone->class_buf + zone->class_offsets[i], detection->label) == 0) {
+            return true;
+        }
+    }
     return false;
 }
 
 /**
  * Check if a detection meets the zone's confidence threshold
  */
-static bool detection_meets_confidence(const detection_t *detection, const detection_zone_t *zone) {
+static bool detection_meets_confidence(const detection_t *detection, const compiled_zone_t *zone) {
     // If no minimum confidence is set (0.0), accept all
     if (zone->min_confidence <= 0.0f) {
         return true;
@@ -108,37 +377,20 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
         return 0;
     }
 
-    // Get zones for this stream
-    detection_zone_t zones[MAX_ZONES_PER_STREAM];
-    int zone_count = get_detection_zones(stream_name, zones, MAX_ZONES_PER_STREAM);
-
-    if (zone_count < 0) {
-        log_error("Failed to get detection zones for stream %s", stream_name);
+    zone_geometry_t *geom = acquire_geometry(stream_name);
+    if (!geom) {
         return -1;
     }
 
-    // If no zones are configured, don't filter (allow all detections)
-    if (zone_count == 0) {
-        log_debug("No zones configured for stream %s, allowing all detections", stream_name);
-        return 0;
-    }
-
-    // Count enabled zones
-    int enabled_zone_count = 0;
-    for (int i = 0; i < zone_count; i++) {
-        if (zones[i].enabled) {
-            enabled_zone_count++;
-        }
-    }
-
-    // If no enabled zones, don't filter (allow all detections)
-    if (enabled_zone_count == 0) {
+    // If no zones are configured or none are enabled, don't filter (allow all detections)
+    if (geom->zone_count == 0) {
         log_debug("No enabled zones for stream %s, allowing all detections", stream_name);
+        release_geometry(geom);
         return 0;
     }
 
     log_info("Filtering %d detections using %d enabled zones for stream %s",
-             result->count, enabled_zone_count, stream_name);
+             result->count, geom->zone_count, stream_name);
 
     // Create a filtered result
     detection_result_t filtered;
@@ -147,21 +399,16 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
     // Check each detection against all zones
     for (int i = 0; i < result->count; i++) {
         detection_t *det = &result->detections[i];
-        bool detection_accepted = false;
-        const char *matched_zone_id = NULL;
-
-        // Check if detection is in any enabled zone
-        for (int j = 0; j < zone_count; j++) {
-            detection_zone_t *zone = &zones[j];
+        const compiled_zone_t *matched_zone = NULL;
 
-            if (!zone->enabled) {
-                continue;
-            }
+        // Zones containing the center of the bounding box, checked in order
+        float center_x = det->x + (det->width / 2.0f);
+        float center_y = det->y + (det->height / 2.0f);
+        uint16_t hits = zones_at_point(geom, center_x, center_y);
 
-            // Check if detection is in this zone
-            if (!detection_in_zone(det, zone)) {
-                continue;
-            }
+        while (hits) {
+            const compiled_zone_t *zone = &geom->zones[__builtin_ctz(hits)];
+            hits &= (uint16_t)(hits - 1);
 
             // Check if detection class matches zone filter
             if (!detection_class_matches(det, zone)) {
@@ -178,34 +425,32 @@ int filter_detections_by_zones(const char *stream_name, detection_result_t *resu
             }
 
             // Detection passed all checks for this zone
-            detection_accepted = true;
-            matched_zone_id = zone->id;
+            matched_zone = zone;
             log_info("Detection %s (%.2f%%) accepted by zone %s",
                     det->label, det->confidence * 100.0f, zone->name);
             break;
         }
 
         // If detection was accepted by at least one zone, add it to filtered result
-        if (detection_accepted) {
+        if (matched_zone) {
             memcpy(&filtered.detections[filtered.count], det, sizeof(detection_t));
 
             // Set the zone_id for this detection
-            if (matched_zone_id) {
-                safe_strcpy(filtered.detections[filtered.count].zone_id, matched_zone_id,
-                       sizeof(filtered.detections[filtered.count].zone_id), 0);
-            }
+            safe_strcpy(filtered.detections[filtered.count].zone_id, matched_zone->id,
+                   sizeof(filtered.detections[filtered.count].zone_id), 0);
 
             filtered.count++;
         } else {
             log_debug("Detection %s (%.2f%%) at [%.2f, %.2f] rejected (not in any enabled zone)",
-                     det->label, det->confidence * 100.0f,
-                     det->x + det->width / 2.0f, det->y + det->height / 2.0f);
+                     det->label, det->confidence * 100.0f, center_x, center_y);
         }
     }
 
     log_info("Zone filtering: %d detections -> %d detections (filtered out %d)",
              result->count, filtered.count, result->count - filtered.count);
 
+    release_geometry(geom);
+
     // Replace original result with filtered result
     memcpy(result, &filtered, sizeof(detection_result_t));
 
@@ -333,12 +578,8 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
 
     int total_cells = grid_size * grid_size;
 
-    // Get zones for this stream
-    detection_zone_t zones[MAX_ZONES_PER_STREAM];
-    int zone_count = get_detection_zones(stream_name, zones, MAX_ZONES_PER_STREAM);
-
-    if (zone_count < 0) {
-        log_error("Failed to get detection zones for stream %s", stream_name);
+    zone_geometry_t *geom = acquire_geometry(stream_name);
+    if (!geom) {
         // On error, allow all cells (don't block motion detection)
         for (int i = 0; i < total_cells; i++) {
             zone_mask[i] = true;
@@ -346,16 +587,10 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
         return -1;
     }
 
-    // Count enabled zones
-    int enabled_zone_count = 0;
-    for (int i = 0; i < zone_count; i++) {
-        if (zones[i].enabled) {
-            enabled_zone_count++;
-        }
-    }
-
     // If no zones configured or none enabled, all cells are active
-    if (zone_count == 0 || enabled_zone_count == 0) {
+    int enabled_zone_count = geom->zone_count;
+    if (enabled_zone_count == 0) {
+        release_geometry(geom);
         for (int i = 0; i < total_cells; i++) {
             zone_mask[i] = true;
         }
@@ -363,28 +598,23 @@ int build_motion_zone_mask(const char *stream_name, int grid_size, bool *zone_ma
     }
 
     // For each grid cell, check if its center is inside any enabled zone
+    int active_cells = 0;
     for (int gy = 0; gy < grid_size; gy++) {
         for (int gx = 0; gx < grid_size; gx++) {
             // Compute normalized center of this cell (0.0 - 1.0)
             float center_x = ((float)gx + 0.5f) / (float)grid_size;
             float center_y = ((float)gy + 0.5f) / (float)grid_size;
 
-            bool in_any_zone = false;
-            for (int z = 0; z < zone_count; z++) {
-                if (!zones[z].enabled) continue;
-                if (point_in_polygon(center_x, center_y,
-                                     zones[z].polygon, zones[z].polygon_count)) {
-                    in_any_zone = true;
-                    break;
-                }
-            }
-
+            bool in_any_zone = zones_at_point(geom, center_x, center_y) != 0;
             zone_mask[gy * grid_size + gx] = in_any_zone;
+            active_cells += in_any_zone;
         }
     }
 
+    release_geometry(geom);
+
     log_debug("Built zone mask for stream %s: %d/%d cells active (%d enabled zones)",
-              stream_name, enabled_zone_count, total_cells, enabled_zone_count);
+              stream_name, active_cells, total_cells, enabled_zone_count);
 
     return enabled_zone_count;
-}
\ No newline at end of file
+}
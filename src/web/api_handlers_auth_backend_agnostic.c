@@ -656,7 +656,7 @@ void handle_auth_sessions_delete(const http_request_t *req, http_response_t *res
     }
 
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/sessions/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Missing session ID");
         return;
     }
@@ -734,7 +734,7 @@ void handle_auth_trusted_devices_delete(const http_request_t *req, http_response
     }
 
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/trusted-devices/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Missing trusted device ID");
         return;
     }
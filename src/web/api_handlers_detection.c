@@ -34,7 +34,7 @@
 void handle_get_detection_results(const http_request_t *req, http_response_t *res) {
     // Extract stream name from URL
     char stream_name[MAX_STREAM_NAME];
-    if (http_request_extract_path_param(req, "/api/detection/results/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         log_error("Failed to extract stream name from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
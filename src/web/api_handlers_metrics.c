@@ -18,6 +18,8 @@
 #include "telemetry/stream_metrics.h"
 #include "telemetry/player_telemetry.h"
 #include "video/stream_manager.h"
+#include "video/packet_buffer.h"
+#include "video/inference_scheduler.h"
 #include "storage/storage_manager.h"
 #define LOG_COMPONENT "MetricsAPI"
 #include "core/logger.h"
@@ -72,6 +74,19 @@ static void prom_buf_free(prom_buf_t *b) {
     b->len = b->cap = 0;
 }
 
+static void prom_append_histogram(prom_buf_t *buf, const char *name, const char *help,
+                                  const inference_histogram_t *h) {
+    static const double bounds[INFERENCE_HISTOGRAM_BUCKETS] = INFERENCE_HISTOGRAM_BOUNDS;
+
+    prom_buf_append(buf, "# HELP %s %s\n", name, help);
+    prom_buf_append(buf, "# TYPE %s histogram\n", name);
+    for (int i = 0; i < INFERENCE_HISTOGRAM_BUCKETS; i++)
+        prom_buf_append(buf, "%s_bucket{le=\"%g\"} %llu\n", name, bounds[i], (unsigned long long)h->buckets[i]);
+    prom_buf_append(buf, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)h->count);
+    prom_buf_append(buf, "%s_sum %.6f\n", name, h->sum);
+    prom_buf_append(buf, "%s_count %llu\n", name, (unsigned long long)h->count);
+}
+
 /* ------------------------------------------------------------------ */
 /*  Instance-level helpers                                              */
 /* ------------------------------------------------------------------ */
@@ -248,6 +263,83 @@ void handle_get_metrics(const http_request_t *req, http_response_t *res) {
     prom_buf_append(&buf, "# TYPE lightnvr_storage_available_bytes gauge\n");
     prom_buf_append(&buf, "lightnvr_storage_available_bytes %.0f\n", (double)storage_health.free_space_bytes);
 
+    /* --- Pre-detection buffer admission control --- */
+    packet_buffer_budget_t *budgets = calloc(MAX_STREAMS, sizeof(packet_buffer_budget_t));
+    if (budgets) {
+        size_t pool_limit = 0;
+        int nb = packet_buffer_get_budgets(budgets, MAX_STREAMS, &pool_limit);
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_pool_limit_bytes Memory limit shared by all pre-detection buffers (0 = unlimited)\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_pool_limit_bytes gauge\n");
+        prom_buf_append(&buf, "lightnvr_prebuffer_pool_limit_bytes %zu\n", pool_limit);
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_pool_memory_bytes Memory used by all pre-detection buffers\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_pool_memory_bytes gauge\n");
+        prom_buf_append(&buf, "lightnvr_prebuffer_pool_memory_bytes %zu\n", packet_buffer_get_total_memory_usage());
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_memory_bytes Packet bytes held in memory by the stream's pre-detection buffer\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_memory_bytes gauge\n");
+        for (int i = 0; i < nb; i++)
+            prom_buf_append(&buf, "lightnvr_prebuffer_memory_bytes{stream=\"%s\"} %zu\n", budgets[i].stream_name, budgets[i].memory_usage);
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_budget_bytes Memory budget assigned to the stream's pre-detection buffer (0 = unlimited)\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_budget_bytes gauge\n");
+        for (int i = 0; i < nb; i++)
+            prom_buf_append(&buf, "lightnvr_prebuffer_budget_bytes{stream=\"%s\",priority=\"%d\"} %zu\n", budgets[i].stream_name, budgets[i].priority, budgets[i].memory_budget);
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_demand_bytes Estimated memory needed for the stream's full pre-roll\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_demand_bytes gauge\n");
+        for (int i = 0; i < nb; i++)
+            prom_buf_append(&buf, "lightnvr_prebuffer_demand_bytes{stream=\"%s\"} %zu\n", budgets[i].stream_name, budgets[i].memory_demand);
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_spilled Whether the stream's pre-detection buffer is spilled to disk\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_spilled gauge\n");
+        for (int i = 0; i < nb; i++)
+            prom_buf_append(&buf, "lightnvr_prebuffer_spilled{stream=\"%s\"} %d\n", budgets[i].stream_name, budgets[i].spilled ? 1 : 0);
+
+        prom_buf_append(&buf, "# HELP lightnvr_prebuffer_shed_packets_total Packets evicted early to stay within the memory budget\n");
+        prom_buf_append(&buf, "# TYPE lightnvr_prebuffer_shed_packets_total counter\n");
+        for (int i = 0; i < nb; i++)
+            prom_buf_append(&buf, "lightnvr_prebuffer_shed_packets_total{stream=\"%s\"} %llu\n", budgets[i].stream_name, (unsigned long long)budgets[i].packets_shed);
+
+        free(budgets);
+    }
+
+    /* --- Inference scheduler --- */
+    inference_scheduler_stats_t inf;
+    inference_scheduler_get_stats(&inf);
+
+    prom_buf_append(&buf, "# HELP lightnvr_inference_queue_depth Frames waiting for an inference worker\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_inference_queue_depth gauge\n");
+    prom_buf_append(&buf, "lightnvr_inference_queue_depth %d\n", inf.queue_depth);
+    prom_buf_append(&buf, "# HELP lightnvr_inference_models_loaded Detection models loaded by the inference scheduler\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_inference_models_loaded gauge\n");
+    prom_buf_append(&buf, "lightnvr_inference_models_loaded %d\n", inf.models_loaded);
+
+    prom_buf_append(&buf, "# HELP lightnvr_inference_frames_total Frames submitted to the inference scheduler by outcome\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_inference_frames_total counter\n");
+    prom_buf_append(&buf, "lightnvr_inference_frames_total{outcome=\"completed\"} %llu\n", (unsigned long long)inf.completed);
+    prom_buf_append(&buf, "lightnvr_inference_frames_total{outcome=\"failed\"} %llu\n", (unsigned long long)inf.failed);
+    prom_buf_append(&buf, "lightnvr_inference_frames_total{outcome=\"dropped_deadline\"} %llu\n", (unsigned long long)inf.dropped_deadline);
+    prom_buf_append(&buf, "lightnvr_inference_frames_total{outcome=\"dropped_superseded\"} %llu\n", (unsigned long long)inf.dropped_superseded);
+
+    prom_buf_append(&buf, "# HELP lightnvr_inference_batch_size Frames per inference batch\n");
+    prom_buf_append(&buf, "# TYPE lightnvr_inference_batch_size histogram\n");
+    uint64_t batch_cumulative = 0;
+    uint64_t batch_frames = 0;
+    for (int i = 0; i < INFERENCE_MAX_BATCH; i++) {
+        batch_cumulative += inf.batch_sizes[i];
+        batch_frames += inf.batch_sizes[i] * (uint64_t)(i + 1);
+        prom_buf_append(&buf, "lightnvr_inference_batch_size_bucket{le=\"%d\"} %llu\n", i + 1, (unsigned long long)batch_cumulative);
+    }
+    prom_buf_append(&buf, "lightnvr_inference_batch_size_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)inf.batches);
+    prom_buf_append(&buf, "lightnvr_inference_batch_size_sum %llu\n", (unsigned long long)batch_frames);
+    prom_buf_append(&buf, "lightnvr_inference_batch_size_count %llu\n", (unsigned long long)inf.batches);
+
+    prom_append_histogram(&buf, "lightnvr_inference_queue_wait_seconds",
+                          "Time from frame submission to the start of its inference batch", &inf.queue_wait);
+    prom_append_histogram(&buf, "lightnvr_inference_latency_seconds",
+                          "Duration of one inference batch", &inf.latency);
+
     /* --- Instance-level metrics --- */
     prom_buf_append(&buf, "# HELP lightnvr_instance_streams_configured Number of streams configured\n");
     prom_buf_append(&buf, "# TYPE lightnvr_instance_streams_configured gauge\n");
@@ -25,7 +25,7 @@
 void handle_test_motion_event(const http_request_t *req, http_response_t *res) {
     char stream_name[256] = {0};
 
-    if (http_request_extract_path_param(req, "/api/motion/test/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name");
         return;
     }
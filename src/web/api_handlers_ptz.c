@@ -68,18 +68,7 @@ static const char* get_profile_token(const stream_config_t *config) {
  * URL format: /api/streams/{stream_name}/ptz/{action}
  */
 static int extract_ptz_stream_name(const http_request_t *req, char *stream_name, size_t name_size) {
-    // Extract stream name from URL
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, name_size) != 0) {
-        return -1;
-    }
-
-    // Remove "/ptz..." suffix from stream_name
-    char *ptz_suffix = strstr(stream_name, "/ptz");
-    if (ptz_suffix) {
-        *ptz_suffix = '\0';
-    }
-
-    return 0;
+    return http_request_get_path_param(req, 0, stream_name, name_size);
 }
 
 void handle_ptz_move(const http_request_t *req, http_response_t *res) {
@@ -105,12 +105,10 @@ void handle_get_recording_tags_by_id(const http_request_t *req, http_response_t
     }
 
     char id_str[32] = {0};
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Invalid recording ID in URL");
         return;
     }
-    char *suffix = strstr(id_str, "/tags");
-    if (suffix) *suffix = '\0';
 
     uint64_t id = strtoull(id_str, NULL, 10);
     if (id == 0) {
@@ -154,12 +152,10 @@ void handle_put_recording_tags(const http_request_t *req, http_response_t *res)
     }
 
     char id_str[32] = {0};
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Invalid recording ID in URL");
         return;
     }
-    char *suffix = strstr(id_str, "/tags");
-    if (suffix) *suffix = '\0';
 
     uint64_t id = strtoull(id_str, NULL, 10);
     if (id == 0) {
@@ -28,6 +28,7 @@
 #include "database/db_auth.h"
 #include "utils/strings.h"
 #include "web/api_handlers_recordings_thumbnail.h"
+#include "video/keyframe_index.h"
 #include "storage/storage_manager_streams_cache.h"
 
 /**
@@ -45,7 +46,7 @@ void handle_get_recording(const http_request_t *req, http_response_t *res) {
 
     // Extract recording ID from URL
     char id_str[32];
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract recording ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -211,7 +212,7 @@ void handle_delete_recording(const http_request_t *req, http_response_t *res) {
 
     // Extract recording ID from URL
     char id_str[32];
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract recording ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -269,6 +270,8 @@ void handle_delete_recording(const http_request_t *req, http_response_t *res) {
     // Delete associated thumbnails
     delete_recording_thumbnails(id);
 
+    keyframe_index_delete(file_path_copy);
+
     // Update stream storage cache so System page stats reflect the deletion immediately.
     update_stream_storage_cache_remove_recording(recording.stream_name, recording.size_bytes);
 
@@ -359,6 +362,8 @@ static void *batch_delete_worker_thread(void *arg) {
                     // Delete associated thumbnails
                     delete_recording_thumbnails(id);
 
+                    keyframe_index_delete(file_path_copy);
+
                     // Update stream storage cache so System page stats stay current.
                     update_stream_storage_cache_remove_recording(recording.stream_name,
                                                                  recording.size_bytes);
@@ -543,6 +548,8 @@ static void *batch_delete_worker_thread(void *arg) {
                 // Delete associated thumbnails
                 delete_recording_thumbnails(id);
 
+                keyframe_index_delete(file_path_copy);
+
                 // Update stream storage cache so System page stats stay current.
                 update_stream_storage_cache_remove_recording(recordings[i].stream_name,
                                                              recordings[i].size_bytes);
@@ -697,7 +704,7 @@ void handle_batch_delete_progress(const http_request_t *req, http_response_t *re
     // Extract job ID from URL
     // URL format: /api/recordings/batch-delete/progress/:job_id
     char job_id[64] = {0};
-    if (http_request_extract_path_param(req, "/api/recordings/batch-delete/progress/", job_id, sizeof(job_id)) != 0) {
+    if (http_request_get_path_param(req, 0, job_id, sizeof(job_id)) != 0) {
         log_error("Failed to extract job ID from URL");
         http_response_set_json_error(res, 400, "Missing or invalid job ID");
         return;
@@ -49,7 +49,7 @@ void handle_recordings_download(const http_request_t *req, http_response_t *res)
 
     // Extract recording ID from URL
     char id_str[32];
-    if (http_request_extract_path_param(req, "/api/recordings/download/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract recording ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
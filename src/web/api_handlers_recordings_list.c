@@ -64,6 +64,8 @@ static int parse_selected_streams(const char *csv,
  * - end: End time (ISO 8601 format)
  * - page: Page number (default: 1)
  * - limit: Results per page (default: 20, max: 1000)
+ * - cursor: Continue after this recording, as "start_time:id" from the previous
+ *   page's pagination.next_cursor (start_time sort only; page is then ignored)
  * - sort: Sort field (default: "start_time")
  * - order: Sort order "asc" or "desc" (default: "desc")
  * - has_detection: Filter by detection status (0 or 1)
@@ -117,6 +119,7 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     char protected_str[8] = {0};
     char tag_filter_str[512] = {0};
     char capture_method_str[128] = {0};
+    char cursor_str[48] = {0};
 
     http_request_get_query_param(req, "stream", stream_name, sizeof(stream_name));
     http_request_get_query_param(req, "start", start_time_str, sizeof(start_time_str));
@@ -130,6 +133,7 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     http_request_get_query_param(req, "protected", protected_str, sizeof(protected_str));
     http_request_get_query_param(req, "tag", tag_filter_str, sizeof(tag_filter_str));
     http_request_get_query_param(req, "capture_method", capture_method_str, sizeof(capture_method_str));
+    http_request_get_query_param(req, "cursor", cursor_str, sizeof(cursor_str));
 
     // Parse numeric parameters
     int page = page_str[0] ? (int)strtol(page_str, NULL, 10) : 1;
@@ -153,6 +157,23 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     // Calculate offset from page and limit
     int offset = (page - 1) * limit;
 
+    // Cursors walk the list in (start_time, id) order, so they only apply to
+    // the start_time sort
+    bool keyset_sort = strcmp(sort_field, "start_time") == 0;
+    recording_cursor_t cursor = {0};
+    bool have_cursor = false;
+    if (cursor_str[0] != '\0') {
+        long long cursor_time = 0;
+        unsigned long long cursor_id = 0;
+        if (!keyset_sort || sscanf(cursor_str, "%lld:%llu", &cursor_time, &cursor_id) != 2) {
+            http_response_set_json_error(res, 400, "Invalid cursor");
+            return;
+        }
+        cursor.start_time = (time_t)cursor_time;
+        cursor.id = (uint64_t)cursor_id;
+        have_cursor = true;
+    }
+
     // Parse time strings to time_t
     time_t start_time = 0;
     time_t end_time = 0;
@@ -329,8 +350,19 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
         return;
     }
 
-    // Get recordings with pagination
-    int count = get_recording_metadata_paginated(start_time, end_time,
+    // Get recordings after the cursor, or by page
+    int count;
+    if (have_cursor && !all_limit_requested) {
+        count = get_recording_metadata_after(start_time, end_time,
+                                             stream_name[0] != '\0' ? stream_name : NULL,
+                                             has_detection, label_filter, protected_filter,
+                                             sort_order, &cursor,
+                                             recordings, limit,
+                                             streams_filter, streams_filter_count,
+                                             tag_filt,
+                                             capture_method_str[0] != '\0' ? capture_method_str : NULL);
+    } else {
+        count = get_recording_metadata_paginated(start_time, end_time,
                                                  stream_name[0] != '\0' ? stream_name : NULL,
                                                  has_detection, label_filter, protected_filter,
                                                  sort_field, sort_order,
@@ -338,6 +370,7 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
                                                  streams_filter, streams_filter_count,
                                                  tag_filt,
                                                  capture_method_str[0] != '\0' ? capture_method_str : NULL);
+    }
 
     if (count < 0) {
         log_error("Failed to get recordings from database");
@@ -386,6 +419,15 @@ void handle_get_recordings(const http_request_t *req, http_response_t *res) {
     cJSON_AddNumberToObject(pagination, "total", total_count);
     cJSON_AddNumberToObject(pagination, "limit", limit);
 
+    // A full page may have more after it; hand out a cursor for it
+    if (keyset_sort && !all_limit_requested && count == limit) {
+        char next_cursor[48];
+        snprintf(next_cursor, sizeof(next_cursor), "%lld:%llu",
+                 (long long)recordings[count - 1].start_time,
+                 (unsigned long long)recordings[count - 1].id);
+        cJSON_AddStringToObject(pagination, "next_cursor", next_cursor);
+    }
+
     // Add pagination object to response
     cJSON_AddItemToObject(response, "pagination", pagination);
 
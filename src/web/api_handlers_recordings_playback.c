@@ -8,6 +8,8 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <strings.h>
+#include <cjson/cJSON.h>
 
 #include "web/request_response.h"
 #include "web/httpd_utils.h"
@@ -16,6 +18,7 @@
 #include "core/config.h"
 #include "database/database_manager.h"
 #include "database/db_recordings.h"
+#include "video/keyframe_index.h"
 
 /**
  * @brief Backend-agnostic handler for GET /api/recordings/play/:id
@@ -49,7 +52,7 @@ void handle_recordings_playback(const http_request_t *req, http_response_t *res)
 
     // Extract recording ID from URL
     char id_str[32];
-    if (http_request_extract_path_param(req, "/api/recordings/play/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract recording ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -132,3 +135,102 @@ void handle_recordings_playback(const http_request_t *req, http_response_t *res)
     log_info("File serving initiated for GET /api/recordings/play/%llu", (unsigned long long)id);
 }
 
+
+/**
+ * @brief Backend-agnostic handler for GET /api/recordings/keyframe/:id
+ *
+ * Answers the byte range of the GOP containing a point in a recording from
+ * its keyframe index sidecar.  The point is given either as a wall-clock
+ * time (?t=<unix seconds>) or as a position in the recording
+ * (?offset=<seconds>).
+ */
+void handle_recordings_keyframe(const http_request_t *req, http_response_t *res) {
+    if (!req || !res) {
+        log_error("Invalid parameters for handle_recordings_keyframe");
+        return;
+    }
+
+    if (g_config.web_auth_enabled) {
+        user_t user;
+        if (g_config.demo_mode) {
+            if (!httpd_check_viewer_access(req, &user)) {
+                http_response_set_json_error(res, 401, "Unauthorized");
+                return;
+            }
+        } else {
+            if (!httpd_get_authenticated_user(req, &user)) {
+                http_response_set_json_error(res, 401, "Unauthorized");
+                return;
+            }
+        }
+    }
+
+    char id_str[32];
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
+        http_response_set_json_error(res, 400, "Invalid request path");
+        return;
+    }
+
+    uint64_t id = strtoull(id_str, NULL, 10);
+    if (id == 0) {
+        http_response_set_json_error(res, 400, "Invalid recording ID");
+        return;
+    }
+
+    char t_str[32] = {0};
+    char offset_str[32] = {0};
+    bool has_t = http_request_get_query_param(req, "t", t_str, sizeof(t_str)) == 0 && t_str[0];
+    bool has_offset = http_request_get_query_param(req, "offset", offset_str, sizeof(offset_str)) == 0 &&
+                      offset_str[0];
+    if (!has_t && !has_offset) {
+        http_response_set_json_error(res, 400, "Missing t or offset parameter");
+        return;
+    }
+
+    recording_metadata_t recording = {0};
+    if (get_recording_metadata_by_id(id, &recording) != 0) {
+        http_response_set_json_error(res, 404, "Recording not found");
+        return;
+    }
+
+    keyframe_index_t *index = keyframe_index_load(recording.file_path);
+    if (!index) {
+        http_response_set_json_error(res, 404, "No keyframe index for recording");
+        return;
+    }
+
+    keyframe_gop_range_t range;
+    int found;
+    if (has_t) {
+        found = keyframe_index_find_gop(index, (int64_t)(strtod(t_str, NULL) * 1000.0), &range);
+    } else {
+        found = keyframe_index_find_gop_at(index, strtod(offset_str, NULL), &range);
+    }
+    keyframe_index_free(index);
+
+    if (found != 0) {
+        http_response_set_json_error(res, 404, "No keyframes in recording");
+        return;
+    }
+
+    cJSON *response = cJSON_CreateObject();
+    if (!response) {
+        http_response_set_json_error(res, 500, "Failed to create response JSON");
+        return;
+    }
+    cJSON_AddNumberToObject(response, "id", (double)id);
+    cJSON_AddNumberToObject(response, "offset", (double)range.offset);
+    cJSON_AddNumberToObject(response, "length", (double)range.length);
+    cJSON_AddNumberToObject(response, "media_time", range.media_seconds);
+    cJSON_AddNumberToObject(response, "keyframe_time", (double)range.wall_ms / 1000.0);
+
+    char *json_str = cJSON_PrintUnformatted(response);
+    cJSON_Delete(response);
+    if (!json_str) {
+        http_response_set_json_error(res, 500, "Failed to serialize response JSON");
+        return;
+    }
+
+    http_response_set_json(res, 200, json_str);
+    free(json_str);
+}
@@ -2,8 +2,9 @@
  * @file api_handlers_recordings_thumbnail.c
  * @brief Backend-agnostic handler for recording thumbnail generation and serving
  *
- * Implements lazy thumbnail generation: thumbnails are generated on first request
- * using ffmpeg, then cached to disk for subsequent requests.
+ * Implements lazy thumbnail generation: thumbnails are rendered in-process on
+ * first request, then kept in an LRU memory cache in front of the on-disk
+ * thumbnail cache for subsequent requests.
  */
 
 #define _XOPEN_SOURCE
@@ -13,18 +14,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <unistd.h>
-#include <fcntl.h>
 #include <time.h>
 #include <errno.h>
-#include <signal.h>
 
 #include "web/api_handlers_recordings_thumbnail.h"
 #include "web/request_response.h"
 #include "web/httpd_utils.h"
 #include "web/thumbnail_thread.h"
 #include "web/libuv_server.h"
+#include "video/thumbnail_engine.h"
 #define LOG_COMPONENT "RecordingsAPI"
 #include "core/logger.h"
 #include "core/config.h"
@@ -32,7 +31,7 @@
 #include "database/database_manager.h"
 #include "database/db_recordings.h"
 
-
+#define THUMBNAIL_CACHE_HEADER "Cache-Control: public, max-age=86400\r\n"
 
 /**
  * @brief Ensure the thumbnails directory exists
@@ -55,6 +54,51 @@ static int ensure_thumbnails_dir(const char *storage_path) {
     return 0;
 }
 
+/**
+ * @brief Set a response body from JPEG data held in memory
+ *
+ * Takes ownership of data (freed by http_response_free).
+ */
+static void set_thumbnail_response(http_response_t *res, unsigned char *data, size_t size) {
+    res->status_code = 200;
+    strncpy(res->content_type, "image/jpeg", sizeof(res->content_type) - 1);
+    res->content_type[sizeof(res->content_type) - 1] = '\0';
+    http_response_add_header(res, "Cache-Control", "public, max-age=86400");
+    res->body = data;
+    res->body_length = size;
+    res->body_allocated = true;
+}
+
+/**
+ * @brief Read a disk-cached thumbnail into the memory cache
+ *
+ * @param data Output: the JPEG data read, for the caller to serve (takes ownership)
+ * @return 0 if the thumbnail was read, -1 if it is too large to cache or unreadable
+ */
+static int promote_thumbnail_file(const char *thumb_path, size_t size, unsigned char **data) {
+    if (size == 0 || size > THUMBNAIL_CACHE_DEFAULT_BYTES / 16) {
+        return -1;
+    }
+
+    FILE *fp = fopen(thumb_path, "rb");
+    if (!fp) {
+        return -1;
+    }
+
+    unsigned char *buf = malloc(size);
+    int ret = -1;
+    if (buf && fread(buf, 1, size, fp) == size) {
+        // A full cache just means the next request reads the file again
+        thumbnail_cache_put(thumb_path, buf, size);
+        *data = buf;
+        buf = NULL;
+        ret = 0;
+    }
+    free(buf);
+    fclose(fp);
+    return ret;
+}
+
 /**
  * @brief Callback invoked when thumbnail generation completes
  *
@@ -65,10 +109,20 @@ static void thumbnail_complete_callback(deferred_action_handle_t handle,
     libuv_connection_t *conn = (libuv_connection_t *)handle;
 
     if (result == 0 && output_path) {
-        // Success - serve the generated thumbnail
+        // Success - the worker left the JPEG in the memory cache
+        unsigned char *data = NULL;
+        size_t size = 0;
+        if (thumbnail_cache_get(output_path, &data, &size) == 0) {
+            log_debug("Serving generated thumbnail from memory: %s", output_path);
+            set_thumbnail_response(&conn->response, data, size);
+            conn->async_response_pending = false;
+            libuv_send_response_ex(conn, &conn->response, conn->deferred_action);
+            return;
+        }
+
+        // Evicted already (cache disabled or under pressure) - fall back to disk
         log_debug("Serving generated thumbnail: %s", output_path);
-        if (libuv_serve_file(conn, output_path, "image/jpeg",
-                            "Cache-Control: public, max-age=86400\r\n") != 0) {
+        if (libuv_serve_file(conn, output_path, "image/jpeg", THUMBNAIL_CACHE_HEADER) != 0) {
             http_response_set_json_error(&conn->response, 500, "Failed to serve thumbnail");
             libuv_send_response_ex(conn, &conn->response, conn->deferred_action);
         }
@@ -80,89 +134,6 @@ static void thumbnail_complete_callback(deferred_action_handle_t handle,
     }
 }
 
-/**
- * @brief Generate a thumbnail using ffmpeg
- */
-static int generate_thumbnail(const char *input_path, const char *output_path,
-                              double seek_seconds) {
-    // Clamp seek time to 0 minimum
-    if (seek_seconds < 0) seek_seconds = 0;
-
-    char seek_str[32];
-    snprintf(seek_str, sizeof(seek_str), "%.2f", seek_seconds);
-
-    log_debug("Generating thumbnail: ffmpeg -ss %s -i \"%s\" -> \"%s\"",
-              seek_str, input_path, output_path);
-
-    // Use fork/execvp instead of system() to avoid spawning a shell
-    pid_t pid = fork();
-    if (pid < 0) {
-        log_warn("fork() failed for thumbnail generation: %s", strerror(errno));
-        return -1;
-    }
-
-    if (pid == 0) {
-        // Child process: redirect stderr to /dev/null, then exec ffmpeg
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
-        }
-        const char *args[] = {
-            "ffmpeg", "-ss", seek_str,
-            "-i", input_path,
-            "-frames:v", "1",
-            "-vf", "scale=320:-1",
-            "-q:v", "8",
-            "-y", output_path,
-            NULL
-        };
-        execvp("ffmpeg", (char *const *)args);
-        _exit(127);
-    }
-
-    // Parent: wait up to 5 seconds for child to complete
-    int ret = -1;
-    time_t deadline = time(NULL) + 5;
-    while (time(NULL) < deadline) {
-        int status = 0;
-        pid_t result = waitpid(pid, &status, WNOHANG);
-        if (result == pid) {
-            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-                ret = 0;
-            }
-            pid = -1;
-            break;
-        }
-        if (result < 0) {
-            pid = -1;
-            break;
-        }
-        usleep(50000);
-    }
-    if (pid > 0) {
-        kill(pid, SIGKILL);
-        waitpid(pid, NULL, 0);
-    }
-
-    if (ret != 0) {
-        log_warn("ffmpeg thumbnail generation failed for: %s", input_path);
-        return -1;
-    }
-
-    // Verify the file was created
-    struct stat st;
-    if (stat(output_path, &st) != 0 || st.st_size == 0) {
-        log_warn("Thumbnail file not created or empty: %s", output_path);
-        unlink(output_path); // Clean up empty file
-        return -1;
-    }
-
-    log_debug("Generated thumbnail: %s (%lld bytes)", output_path,
-              (long long)st.st_size);
-    return 0;
-}
-
 void handle_recordings_thumbnail(const http_request_t *req, http_response_t *res) {
     if (!req || !res) {
         log_error("Invalid parameters for handle_recordings_thumbnail");
@@ -191,23 +162,17 @@ void handle_recordings_thumbnail(const http_request_t *req, http_response_t *res
         return;
     }
 
-    // Extract path parameter: /api/recordings/thumbnail/{id}/{index}
-    char param_buf[64];
-    if (http_request_extract_path_param(req, "/api/recordings/thumbnail/",
-                                         param_buf, sizeof(param_buf)) != 0) {
+    // Extract path parameters: /api/recordings/thumbnail/{id}/{index}
+    char id_str[32];
+    char index_str[16];
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
-
-    // Parse id and index from "id/index"
-    char *slash = strchr(param_buf, '/');
-    if (!slash) {
+    if (http_request_get_path_param(req, 1, index_str, sizeof(index_str)) != 0) {
         http_response_set_json_error(res, 400, "Missing thumbnail index");
         return;
     }
-    *slash = '\0';
-    const char *id_str = param_buf;
-    const char *index_str = slash + 1;
 
     uint64_t id = strtoull(id_str, NULL, 10);
     int index = (int)strtol(index_str, NULL, 10);
@@ -226,13 +191,28 @@ void handle_recordings_thumbnail(const http_request_t *req, http_response_t *res
     snprintf(thumb_path, sizeof(thumb_path), "%s/thumbnails/%llu_%d.jpg",
              g_config.storage_path, (unsigned long long)id, index);
 
-    // Check if thumbnail already exists (cached)
+    // Memory cache first: no file system access at all
+    unsigned char *cached = NULL;
+    size_t cached_size = 0;
+    if (thumbnail_cache_get(thumb_path, &cached, &cached_size) == 0) {
+        log_debug("Serving thumbnail from memory: %s", thumb_path);
+        set_thumbnail_response(res, cached, cached_size);
+        return;
+    }
+
+    // Check if thumbnail already exists on disk
     struct stat st;
     if (stat(thumb_path, &st) == 0 && st.st_size > 0) {
-        // Serve cached thumbnail
+        // Keep it in memory for the next request and serve the bytes just
+        // read; only thumbnails too large to cache are streamed from disk
+        unsigned char *data = NULL;
+        if (promote_thumbnail_file(thumb_path, (size_t)st.st_size, &data) == 0) {
+            log_debug("Serving cached thumbnail: %s", thumb_path);
+            set_thumbnail_response(res, data, (size_t)st.st_size);
+            return;
+        }
         log_debug("Serving cached thumbnail: %s", thumb_path);
-        if (http_serve_file(req, res, thumb_path, "image/jpeg",
-                            "Cache-Control: public, max-age=86400\r\n") != 0) {
+        if (http_serve_file(req, res, thumb_path, "image/jpeg", THUMBNAIL_CACHE_HEADER) != 0) {
             http_response_set_json_error(res, 500, "Failed to serve thumbnail");
         }
         return;
@@ -293,12 +273,12 @@ void handle_recordings_thumbnail(const http_request_t *req, http_response_t *res
         return;
     }
 
-    // Submit thumbnail generation to detached pthread
+    // Submit thumbnail generation to the worker pool
     // The callback will be invoked on the event loop thread when complete
     if (thumbnail_thread_submit(id, index, recording.file_path, thumb_path,
                                seek_seconds, (deferred_action_handle_t)conn,
                                thumbnail_complete_callback) != 0) {
-        // Submission failed (likely at concurrency limit)
+        // Submission failed (likely the pending queue is full)
         http_response_add_header(res, "Retry-After", "2");
         http_response_set_json_error(res, 503,
             "Thumbnail generation busy, try again later");
@@ -318,6 +298,7 @@ void delete_recording_thumbnails(uint64_t recording_id) {
         char thumb_path[MAX_PATH_LENGTH];
         snprintf(thumb_path, sizeof(thumb_path), "%s/thumbnails/%llu_%d.jpg",
                  g_config.storage_path, (unsigned long long)recording_id, i);
+        thumbnail_cache_remove(thumb_path);
         if (unlink(thumb_path) == 0) {
             log_debug("Deleted thumbnail: %s", thumb_path);
         }
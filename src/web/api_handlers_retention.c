@@ -28,17 +28,11 @@ void handle_get_stream_retention(const http_request_t *req, http_response_t *res
 
     // Extract stream name from URL
     char stream_name[MAX_STREAM_NAME] = {0};
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name in URL");
         return;
     }
 
-    // Remove /retention suffix if present
-    char *suffix = strstr(stream_name, "/retention");
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     // Get retention config
     stream_retention_config_t config;
     if (get_stream_retention_config(stream_name, &config) != 0) {
@@ -69,17 +63,11 @@ void handle_put_stream_retention(const http_request_t *req, http_response_t *res
 
     // Extract stream name from URL
     char stream_name[MAX_STREAM_NAME] = {0};
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name in URL");
         return;
     }
 
-    // Remove /retention suffix if present
-    char *suffix = strstr(stream_name, "/retention");
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     // Parse JSON body
     cJSON *json = httpd_parse_json_body(req);
     if (!json) {
@@ -147,17 +135,11 @@ void handle_put_recording_protect(const http_request_t *req, http_response_t *re
 
     // Extract recording ID from URL
     char id_str[32] = {0};
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Invalid recording ID in URL");
         return;
     }
 
-    // Remove /protect suffix if present
-    char *suffix = strstr(id_str, "/protect");
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     // Parse ID
     uint64_t id = strtoull(id_str, NULL, 10);
     if (id == 0) {
@@ -213,17 +195,11 @@ void handle_put_recording_retention(const http_request_t *req, http_response_t *
 
     // Extract recording ID from URL
     char id_str[32] = {0};
-    if (http_request_extract_path_param(req, "/api/recordings/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         http_response_set_json_error(res, 400, "Invalid recording ID in URL");
         return;
     }
 
-    // Remove /retention suffix if present
-    char *suffix = strstr(id_str, "/retention");
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     // Parse ID
     uint64_t id = strtoull(id_str, NULL, 10);
     if (id == 0) {
@@ -1306,6 +1306,8 @@ void handle_post_settings(const http_request_t *req, http_response_t *res) {
         log_info("Shutting down stream manager to change database path...");
         shutdown_stream_manager();
         
+        db_auth_shutdown();
+
         log_info("Shutting down database...");
         shutdown_database();
         
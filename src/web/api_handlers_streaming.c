@@ -13,6 +13,130 @@
 #include "utils/strings.h"
 #include "web/http_server.h"
 #include "video/streams.h"
+#include "video/hls/hls_memory_store.h"
+#include "video/hls/hls_ll_playlist.h"
+#include "web/hls_blocking_reload.h"
+#include "web/libuv_server.h"
+
+/**
+ * Content type for an HLS file name
+ */
+static const char *hls_content_type(const char *file_name) {
+    if (strstr(file_name, ".m3u8")) {
+        return "application/vnd.apple.mpegurl";
+    } else if (strstr(file_name, ".ts")) {
+        return "video/mp2t";
+    } else if (strstr(file_name, ".m4s")) {
+        return "video/iso.segment";
+    } else if (strstr(file_name, "init.mp4")) {
+        return "video/mp4";
+    }
+    return "application/octet-stream";
+}
+
+/**
+ * Cache policy for an HLS file name:
+ * - .m3u8 playlists change every few seconds (new segments added, old removed) → must not cache
+ * - .ts segments are immutable (identified by sequence number) → safe to cache
+ */
+static const char *hls_cache_control(const char *file_name) {
+    if (strstr(file_name, ".m3u8")) {
+        return "no-cache, no-store, must-revalidate";
+    }
+    // Segments are immutable once written - cache for 5 minutes
+    return "public, max-age=300";
+}
+
+/**
+ * Answer from the HLS memory store if it holds the file
+ *
+ * @return true if the response was filled in
+ */
+static bool hls_respond_from_memory(http_response_t *res, const char *stream_name,
+                                    const char *file_name) {
+    unsigned char *mem_data = NULL;
+    size_t mem_size = 0;
+    if (hls_memory_store_get(stream_name, file_name, &mem_data, &mem_size) != 0) {
+        return false;
+    }
+
+    res->status_code = 200;
+    safe_strcpy(res->content_type, hls_content_type(file_name), sizeof(res->content_type), 0);
+    http_response_add_header(res, "Cache-Control", hls_cache_control(file_name));
+    http_response_add_header(res, "Access-Control-Allow-Origin", "*");
+    http_response_add_header(res, "Access-Control-Allow-Methods", "GET, OPTIONS");
+    http_response_add_header(res, "Access-Control-Allow-Headers", "Origin, Content-Type, Accept, Authorization");
+    res->body = mem_data;
+    res->body_length = mem_size;
+    res->body_allocated = true;
+    return true;
+}
+
+/**
+ * Response for a blocking LL-HLS request once it has been released
+ * (runs on the event loop thread)
+ */
+static void hls_reload_respond(http_response_t *res, const char *stream_name,
+                               const char *file_name, int result) {
+    if (result != 0) {
+        http_response_set_json_error(res, 503, "Timed out waiting for HLS part");
+    } else if (!hls_respond_from_memory(res, stream_name, file_name)) {
+        http_response_set_json_error(res, 404, "HLS file not found");
+    }
+}
+
+/**
+ * Check whether an LL-HLS request has to block: a playlist reload with
+ * _HLS_msn/_HLS_part, or a part that is announced but not yet published
+ * (the preload hint).  Parks the request and returns true when it does;
+ * answers 400 for requests too far into the future.
+ */
+static bool hls_handle_blocking_request(const http_request_t *req, http_response_t *res,
+                                        const char *stream_name, const char *file_name) {
+    int64_t cur_msn = 0;
+    int cur_parts = 0;
+    if (hls_memory_store_get_position(stream_name, &cur_msn, &cur_parts, NULL) != 0) {
+        return false;
+    }
+
+    long long msn = -1;
+    int part = -1;
+    char value[32];
+    if (strstr(file_name, ".m3u8")) {
+        if (http_request_get_query_param(req, "_HLS_msn", value, sizeof(value)) != 0) {
+            return false;
+        }
+        msn = strtoll(value, NULL, 10);
+        if (http_request_get_query_param(req, "_HLS_part", value, sizeof(value)) == 0) {
+            part = atoi(value);
+        }
+    } else if (sscanf(file_name, "part_%lld_%d.ts", &msn, &part) != 2) {
+        return false;
+    }
+    if (msn < 0) {
+        return false;
+    }
+
+    hls_ll_request_state_t state = hls_ll_playlist_request_state(cur_msn, cur_parts, msn, part);
+    if (state == HLS_LL_REQUEST_INVALID) {
+        http_response_set_json_error(res, 400, "Requested HLS segment is too far in the future");
+        return true;
+    }
+    if (state == HLS_LL_REQUEST_READY) {
+        return false;
+    }
+
+    libuv_connection_t *conn = (libuv_connection_t *)req->user_data;
+    if (!conn || hls_blocking_reload_defer(conn, stream_name, file_name, msn, part,
+                                           hls_reload_respond) != 0) {
+        // Answer with what is there now; the player simply asks again
+        return false;
+    }
+
+    log_debug("Holding HLS request %s/%s until %lld.%d (at %lld.%d)", stream_name, file_name,
+              msn, part, (long long)cur_msn, cur_parts);
+    return true;
+}
 
 /**
  * @brief Backend-agnostic handler for direct HLS requests
@@ -77,6 +201,18 @@ void handle_direct_hls_request(const http_request_t *req, http_response_t *res)
         return;
     }
 
+    // Low-latency streams hold playlist reloads and preload-hinted parts
+    // until the writer publishes what they ask for
+    if (hls_handle_blocking_request(req, res, stream_name, file_name)) {
+        return;
+    }
+
+    // Streams served from memory never touch the disk for the playlist or the
+    // newest segments; anything else (spilled segments) falls through below
+    if (hls_respond_from_memory(res, stream_name, file_name)) {
+        return;
+    }
+
     // Get the config to find the storage path - make a local copy of needed values
     const config_t *global_config = get_streaming_config();
     if (!global_config) {
@@ -114,39 +250,20 @@ void handle_direct_hls_request(const http_request_t *req, http_response_t *res)
     struct stat st;
     if (stat(hls_file_path, &st) == 0 && S_ISREG(st.st_mode)) {
         // Determine content type based on file extension
-        const char *content_type = "application/octet-stream";
-        if (strstr(file_name, ".m3u8")) {
-            content_type = "application/vnd.apple.mpegurl";
-        } else if (strstr(file_name, ".ts")) {
-            content_type = "video/mp2t";
-        } else if (strstr(file_name, ".m4s")) {
-            content_type = "video/iso.segment";
-        } else if (strstr(file_name, "init.mp4")) {
-            content_type = "video/mp4";
-        }
+        const char *content_type = hls_content_type(file_name);
 
         // Build extra headers with cache control and CORS
         // Note: Do NOT include "Connection: close" - it kills keep-alive and forces
         // new TCP handshakes for every HLS segment, severely degrading performance
         char extra_headers[512];
 
-        // Use different cache policies for playlists vs segments:
-        // - .m3u8 playlists change every few seconds (new segments added, old removed) → must not cache
-        // - .ts segments are immutable (identified by sequence number) → safe to cache
-        const char *cache_control;
-        if (strstr(file_name, ".m3u8")) {
-            cache_control = "Cache-Control: no-cache, no-store, must-revalidate\r\n";
-        } else {
-            // Segments are immutable once written - cache for 5 minutes
-            cache_control = "Cache-Control: public, max-age=300\r\n";
-        }
-
+        // Use different cache policies for playlists vs segments
         snprintf(extra_headers, sizeof(extra_headers),
-            "%s"
+            "Cache-Control: %s\r\n"
             "Access-Control-Allow-Origin: *\r\n"
             "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
             "Access-Control-Allow-Headers: Origin, Content-Type, Accept, Authorization\r\n",
-            cache_control);
+            hls_cache_control(file_name));
 
         // Serve the file using backend-agnostic function
         http_serve_file(req, res, hls_file_path, content_type, extra_headers);
@@ -199,12 +199,15 @@ void handle_get_streams(const http_request_t *req, http_response_t *res) {
         cJSON_AddNumberToObject(stream_obj, "detection_threshold", threshold_percent);
 
         cJSON_AddNumberToObject(stream_obj, "detection_interval", db_streams[i].detection_interval);
+        cJSON_AddStringToObject(stream_obj, "detection_decode_mode", db_streams[i].detection_decode_mode);
+        cJSON_AddNumberToObject(stream_obj, "detection_decode_gop_interval", db_streams[i].detection_decode_gop_interval);
         cJSON_AddNumberToObject(stream_obj, "pre_detection_buffer", db_streams[i].pre_detection_buffer);
         cJSON_AddNumberToObject(stream_obj, "post_detection_buffer", db_streams[i].post_detection_buffer);
         cJSON_AddStringToObject(stream_obj, "detection_object_filter", db_streams[i].detection_object_filter);
         cJSON_AddStringToObject(stream_obj, "detection_object_filter_list", db_streams[i].detection_object_filter_list);
         cJSON_AddNumberToObject(stream_obj, "protocol", (int)db_streams[i].protocol);
         cJSON_AddBoolToObject(stream_obj, "record_audio", db_streams[i].record_audio);
+        cJSON_AddStringToObject(stream_obj, "recording_format", db_streams[i].recording_format);
         cJSON_AddBoolToObject(stream_obj, "isOnvif", db_streams[i].is_onvif);
         cJSON_AddBoolToObject(stream_obj, "backchannel_enabled", db_streams[i].backchannel_enabled);
         cJSON_AddNumberToObject(stream_obj, "retention_days", db_streams[i].retention_days);
@@ -296,7 +299,7 @@ void handle_get_streams(const http_request_t *req, http_response_t *res) {
 void handle_get_stream(const http_request_t *req, http_response_t *res) {
     // Extract stream ID from URL
     char stream_id[MAX_STREAM_NAME];
-    if (http_request_extract_path_param(req, "/api/streams/", stream_id, sizeof(stream_id)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_id, sizeof(stream_id)) != 0) {
         log_error("Failed to extract stream ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -357,12 +360,15 @@ void handle_get_stream(const http_request_t *req, http_response_t *res) {
     cJSON_AddNumberToObject(stream_obj, "detection_threshold", threshold_percent);
 
     cJSON_AddNumberToObject(stream_obj, "detection_interval", config.detection_interval);
+    cJSON_AddStringToObject(stream_obj, "detection_decode_mode", config.detection_decode_mode);
+    cJSON_AddNumberToObject(stream_obj, "detection_decode_gop_interval", config.detection_decode_gop_interval);
     cJSON_AddNumberToObject(stream_obj, "pre_detection_buffer", config.pre_detection_buffer);
     cJSON_AddNumberToObject(stream_obj, "post_detection_buffer", config.post_detection_buffer);
     cJSON_AddStringToObject(stream_obj, "detection_object_filter", config.detection_object_filter);
     cJSON_AddStringToObject(stream_obj, "detection_object_filter_list", config.detection_object_filter_list);
     cJSON_AddNumberToObject(stream_obj, "protocol", (int)config.protocol);
     cJSON_AddBoolToObject(stream_obj, "record_audio", config.record_audio);
+    cJSON_AddStringToObject(stream_obj, "recording_format", config.recording_format);
     cJSON_AddBoolToObject(stream_obj, "isOnvif", config.is_onvif);
     cJSON_AddBoolToObject(stream_obj, "backchannel_enabled", config.backchannel_enabled);
     cJSON_AddNumberToObject(stream_obj, "retention_days", config.retention_days);
@@ -445,19 +451,12 @@ void handle_get_stream(const http_request_t *req, http_response_t *res) {
 void handle_get_stream_full(const http_request_t *req, http_response_t *res) {
     // Extract stream ID from URL
     char stream_id[MAX_STREAM_NAME];
-    if (http_request_extract_path_param(req, "/api/streams/", stream_id, sizeof(stream_id)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_id, sizeof(stream_id)) != 0) {
         log_error("Failed to extract stream ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
 
-    // If the router matched '/api/streams/#/full', decoded_id may include the trailing segment
-    // (e.g., "Cam01/full"). Trim anything after the first '/'.
-    char *slash = strchr(stream_id, '/');
-    if (slash) {
-        *slash = '\0';
-    }
-
     log_info("Handling GET /api/streams/%s/full request", stream_id);
 
     // Find the stream by name
@@ -509,12 +508,15 @@ void handle_get_stream_full(const http_request_t *req, http_response_t *res) {
     int threshold_percent = (int)(config.detection_threshold * 100.0f);
     cJSON_AddNumberToObject(stream_obj, "detection_threshold", threshold_percent);
     cJSON_AddNumberToObject(stream_obj, "detection_interval", config.detection_interval);
+    cJSON_AddStringToObject(stream_obj, "detection_decode_mode", config.detection_decode_mode);
+    cJSON_AddNumberToObject(stream_obj, "detection_decode_gop_interval", config.detection_decode_gop_interval);
     cJSON_AddNumberToObject(stream_obj, "pre_detection_buffer", config.pre_detection_buffer);
     cJSON_AddNumberToObject(stream_obj, "post_detection_buffer", config.post_detection_buffer);
     cJSON_AddStringToObject(stream_obj, "detection_object_filter", config.detection_object_filter);
     cJSON_AddStringToObject(stream_obj, "detection_object_filter_list", config.detection_object_filter_list);
     cJSON_AddNumberToObject(stream_obj, "protocol", (int)config.protocol);
     cJSON_AddBoolToObject(stream_obj, "record_audio", config.record_audio);
+    cJSON_AddStringToObject(stream_obj, "recording_format", config.recording_format);
     cJSON_AddBoolToObject(stream_obj, "isOnvif", config.is_onvif);
     cJSON_AddBoolToObject(stream_obj, "backchannel_enabled", config.backchannel_enabled);
     cJSON_AddNumberToObject(stream_obj, "retention_days", config.retention_days);
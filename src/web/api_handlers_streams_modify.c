@@ -140,6 +140,28 @@ static void redact_url_for_log(const char *url, char *out_url, size_t out_size)
     }
 }
 
+/**
+ * @brief Check the detection decode fields of a stream request
+ *
+ * @return Error message for a 400 response, or NULL if the fields are absent or valid
+ */
+static const char *validate_detection_decode(const cJSON *stream_json) {
+    const cJSON *mode = cJSON_GetObjectItem(stream_json, "detection_decode_mode");
+    if (mode && cJSON_IsString(mode) &&
+        strcmp(mode->valuestring, "keyframes") != 0 &&
+        strcmp(mode->valuestring, "gop") != 0 &&
+        strcmp(mode->valuestring, "full") != 0) {
+        return "detection_decode_mode must be one of keyframes, gop, full";
+    }
+
+    const cJSON *gop_interval = cJSON_GetObjectItem(stream_json, "detection_decode_gop_interval");
+    if (gop_interval && cJSON_IsNumber(gop_interval) && gop_interval->valueint <= 0) {
+        return "detection_decode_gop_interval must be a positive integer";
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Worker function for PUT stream update
  *
@@ -437,6 +459,14 @@ void handle_post_stream(const http_request_t *req, http_response_t *res) {
         return;
     }
 
+    const char *decode_error = validate_detection_decode(stream_json);
+    if (decode_error) {
+        log_error("Invalid stream configuration: %s", decode_error);
+        cJSON_Delete(stream_json);
+        http_response_set_json_error(res, 400, decode_error);
+        return;
+    }
+
     // Extract stream configuration
     stream_config_t config;
     memset(&config, 0, sizeof(config));
@@ -482,11 +512,14 @@ void handle_post_stream(const http_request_t *req, http_response_t *res) {
     config.segment_duration = 60;
     config.detection_based_recording = false;
     config.detection_interval = 10;
+    safe_strcpy(config.detection_decode_mode, "keyframes", sizeof(config.detection_decode_mode), 0);
+    config.detection_decode_gop_interval = 2;
     config.detection_threshold = 0.5f;
     config.pre_detection_buffer = 5;
     config.post_detection_buffer = 5;
     config.protocol = STREAM_PROTOCOL_TCP;
     config.record_audio = true; // Default to true for new streams
+    safe_strcpy(config.recording_format, "mp4", sizeof(config.recording_format), 0);
 
     // Override with provided values
     cJSON *enabled = cJSON_GetObjectItem(stream_json, "enabled");
@@ -539,6 +572,16 @@ void handle_post_stream(const http_request_t *req, http_response_t *res) {
         config.detection_interval = detection_interval->valueint;
     }
 
+    cJSON *detection_decode_mode = cJSON_GetObjectItem(stream_json, "detection_decode_mode");
+    if (detection_decode_mode && cJSON_IsString(detection_decode_mode)) {
+        safe_strcpy(config.detection_decode_mode, detection_decode_mode->valuestring, sizeof(config.detection_decode_mode), 0);
+    }
+
+    cJSON *detection_decode_gop_interval = cJSON_GetObjectItem(stream_json, "detection_decode_gop_interval");
+    if (detection_decode_gop_interval && cJSON_IsNumber(detection_decode_gop_interval)) {
+        config.detection_decode_gop_interval = detection_decode_gop_interval->valueint;
+    }
+
     cJSON *pre_detection_buffer = cJSON_GetObjectItem(stream_json, "pre_detection_buffer");
     if (pre_detection_buffer && cJSON_IsNumber(pre_detection_buffer)) {
         config.pre_detection_buffer = pre_detection_buffer->valueint;
@@ -571,6 +614,17 @@ void handle_post_stream(const http_request_t *req, http_response_t *res) {
                 config.record_audio ? "enabled" : "disabled", config.name);
     }
 
+    cJSON *recording_format = cJSON_GetObjectItem(stream_json, "recording_format");
+    if (recording_format && cJSON_IsString(recording_format)) {
+        if (strcmp(recording_format->valuestring, "mp4") == 0 ||
+            strcmp(recording_format->valuestring, "fmp4") == 0) {
+            safe_strcpy(config.recording_format, recording_format->valuestring, sizeof(config.recording_format), 0);
+        } else {
+            log_warn("Ignoring unknown recording_format '%s' for stream %s",
+                    recording_format->valuestring, config.name);
+        }
+    }
+
     // Check if backchannel_enabled flag is set in the request
     cJSON *backchannel_enabled = cJSON_GetObjectItem(stream_json, "backchannel_enabled");
     if (backchannel_enabled && cJSON_IsBool(backchannel_enabled)) {
@@ -893,7 +947,7 @@ void handle_post_stream(const http_request_t *req, http_response_t *res) {
 void handle_put_stream(const http_request_t *req, http_response_t *res) {
     // Extract stream ID from URL
     char stream_id[MAX_STREAM_NAME];
-    if (http_request_extract_path_param(req, "/api/streams/", stream_id, sizeof(stream_id)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_id, sizeof(stream_id)) != 0) {
         log_error("Failed to extract stream ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -925,6 +979,14 @@ void handle_put_stream(const http_request_t *req, http_response_t *res) {
         return;
     }
 
+    const char *decode_error = validate_detection_decode(stream_json);
+    if (decode_error) {
+        log_error("Invalid configuration for stream %s: %s", stream_id, decode_error);
+        cJSON_Delete(stream_json);
+        http_response_set_json_error(res, 400, decode_error);
+        return;
+    }
+
     // Update configuration with provided values
     bool config_changed = false;
     bool requires_restart = false;  // Flag for changes that require stream restart
@@ -1042,6 +1104,27 @@ void handle_put_stream(const http_request_t *req, http_response_t *res) {
         non_dynamic_config_changed = true;
     }
 
+    // The decode strategy is read when the detection thread starts, so treat a
+    // change like an interval change and let the thread be restarted
+    cJSON *detection_decode_mode_json = cJSON_GetObjectItem(stream_json, "detection_decode_mode");
+    if (detection_decode_mode_json && cJSON_IsString(detection_decode_mode_json) &&
+        strcmp(config.detection_decode_mode, detection_decode_mode_json->valuestring) != 0) {
+        safe_strcpy(config.detection_decode_mode, detection_decode_mode_json->valuestring,
+                    sizeof(config.detection_decode_mode), 0);
+        has_detection_interval = true;
+        config_changed = true;
+        non_dynamic_config_changed = true;
+    }
+
+    cJSON *detection_decode_gop_json = cJSON_GetObjectItem(stream_json, "detection_decode_gop_interval");
+    if (detection_decode_gop_json && cJSON_IsNumber(detection_decode_gop_json) &&
+        config.detection_decode_gop_interval != detection_decode_gop_json->valueint) {
+        config.detection_decode_gop_interval = detection_decode_gop_json->valueint;
+        has_detection_interval = true;
+        config_changed = true;
+        non_dynamic_config_changed = true;
+    }
+
     cJSON *pre_detection_buffer = cJSON_GetObjectItem(stream_json, "pre_detection_buffer");
     if (pre_detection_buffer && cJSON_IsNumber(pre_detection_buffer)) {
         config.pre_detection_buffer = pre_detection_buffer->valueint;
@@ -1082,6 +1165,23 @@ void handle_put_stream(const http_request_t *req, http_response_t *res) {
         }
     }
 
+    // The recording thread re-reads the format before every segment, so a
+    // change applies from the next segment without a restart
+    cJSON *recording_format_json = cJSON_GetObjectItem(stream_json, "recording_format");
+    if (recording_format_json && cJSON_IsString(recording_format_json) &&
+        strcmp(config.recording_format, recording_format_json->valuestring) != 0) {
+        if (strcmp(recording_format_json->valuestring, "mp4") == 0 ||
+            strcmp(recording_format_json->valuestring, "fmp4") == 0) {
+            log_info("Recording format changed from %s to %s",
+                    config.recording_format, recording_format_json->valuestring);
+            safe_strcpy(config.recording_format, recording_format_json->valuestring,
+                        sizeof(config.recording_format), 0);
+            config_changed = true;
+        } else {
+            log_warn("Ignoring unknown recording_format '%s'", recording_format_json->valuestring);
+        }
+    }
+
     cJSON *backchannel_enabled = cJSON_GetObjectItem(stream_json, "backchannel_enabled");
     if (backchannel_enabled && cJSON_IsBool(backchannel_enabled)) {
         bool original_backchannel = config.backchannel_enabled;
@@ -1762,7 +1862,7 @@ static void delete_stream_worker(delete_stream_task_t *task) {
 void handle_delete_stream(const http_request_t *req, http_response_t *res) {
     // Extract stream ID from URL
     char stream_id[MAX_STREAM_NAME];
-    if (http_request_extract_path_param(req, "/api/streams/", stream_id, sizeof(stream_id)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_id, sizeof(stream_id)) != 0) {
         log_error("Failed to extract stream ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -1941,18 +2041,12 @@ void handle_post_stream_refresh(const http_request_t *req, http_response_t *res)
 
     // Extract stream name from URL
     char stream_name[MAX_STREAM_NAME] = {0};
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         log_error("Failed to extract stream name from URL");
         http_response_set_json_error(res, 400, "Invalid stream name in URL");
         return;
     }
 
-    // Remove /refresh suffix if present
-    char *suffix = strstr(stream_name, "/refresh");
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     log_info("Refreshing go2rtc registration for stream: %s", stream_name);
 
     // Check if the stream exists
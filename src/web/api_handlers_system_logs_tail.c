@@ -19,7 +19,27 @@
 
 
 /**
- * @brief Get JSON logs by parsing log file
+ * @brief Append one in-memory tail entry to a cJSON array
+ */
+static void add_tail_entry(const log_tail_entry_t *entry, void *user_data) {
+    cJSON *logs_array = user_data;
+
+    cJSON *log_entry = cJSON_CreateObject();
+    if (!log_entry) {
+        return;
+    }
+
+    cJSON_AddStringToObject(log_entry, "timestamp", entry->timestamp);
+    cJSON_AddItemToObject(log_entry, "level",
+                          cJSON_CreateStringReference(get_log_level_string(entry->level)));
+    cJSON_AddStringToObject(log_entry, "message", entry->text);
+
+    cJSON_AddItemToArray(logs_array, log_entry);
+}
+
+/**
+ * @brief Get JSON logs from the logger's in-memory tail, or by parsing the
+ * log file when the tail does not hold every requested line
  *
  * @param max_verbosity Maximum log level to include
  * @param last_timestamp Last timestamp received by client (for pagination)
@@ -27,16 +47,27 @@
  * @return The allocated cJSON array of log entries
  */
 cJSON * get_json_logs_tail(int max_verbosity, const char *last_timestamp, int max_lines) {
+    // Default to 500 lines if not specified
+    if (max_lines == 0) {
+        max_lines = 500;
+    }
+
+    // Polls with a timestamp and initial loads that fit in the tail are
+    // normally answered from memory
+    if (max_lines > 0) {
+        cJSON *tail_array = cJSON_CreateArray();
+        if (tail_array && log_tail_foreach((log_level_t)max_verbosity, last_timestamp, max_lines,
+                                           add_tail_entry, tail_array) >= 0) {
+            return tail_array;
+        }
+        cJSON_Delete(tail_array);
+    }
+
     // Check if log file is set
     if (g_config.log_file[0] == '\0') {
         log_error("Log file not configured");
         return NULL;
     }
-    
-    // Default to 500 lines if not specified
-    if (max_lines == 0) {
-        max_lines = 500;
-    }
 
     // Open the log file directly — no shell or popen needed
     FILE *fp = fopen(g_config.log_file, "r");
@@ -145,7 +176,7 @@ cJSON * get_json_logs_tail(int max_verbosity, const char *last_timestamp, int ma
         cJSON *json_lvl = cJSON_CreateStringReference(level);
 
         cJSON_AddStringToObject(log_entry, "timestamp", timestamp[0] ? timestamp : "Unknown");
-        cJSON_AddItemReferenceToObject(log_entry, "level", json_lvl);
+        cJSON_AddItemToObject(log_entry, "level", json_lvl);
         cJSON_AddStringToObject(log_entry, "message", message);
 
         cJSON_AddItemToArray(logs_array, log_entry);
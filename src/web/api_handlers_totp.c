@@ -226,12 +226,9 @@ static int totp_generate_secret(char *secret_b32, size_t secret_size) {
 
 static int extract_totp_user_id(const http_request_t *req, int64_t *user_id) {
     char param[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", param, sizeof(param)) != 0) {
+    if (http_request_get_path_param(req, 0, param, sizeof(param)) != 0) {
         return -1;
     }
-    /* param may be "123/totp/setup" - extract just the numeric part */
-    char *slash = strchr(param, '/');
-    if (slash) *slash = '\0';
     *user_id = strtoll(param, NULL, 10);
     return (*user_id > 0) ? 0 : -1;
 }
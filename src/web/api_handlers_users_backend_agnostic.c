@@ -283,7 +283,7 @@ void handle_users_get(const http_request_t *req, http_response_t *res) {
 
     // Extract user ID from URL
     char user_id_str[32];
-    if (http_request_extract_path_param(req, "/api/auth/users/", user_id_str, sizeof(user_id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, user_id_str, sizeof(user_id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -482,17 +482,12 @@ void handle_users_update(const http_request_t *req, http_response_t *res) {
 
     // Extract user ID from URL
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
 
-    char *suffix = strchr(id_str, '/');
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     int64_t user_id = strtoll(id_str, NULL, 10);
     bool is_admin = (current_user.role == USER_ROLE_ADMIN);
     bool is_self_update = (current_user.id == user_id);
@@ -674,17 +669,12 @@ void handle_users_delete(const http_request_t *req, http_response_t *res) {
 
     // Extract user ID from URL
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
 
-    char *suffix = strchr(id_str, '/');
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     int64_t user_id = strtoll(id_str, NULL, 10);
 
     // Check if the user has permission to delete this user (includes self-delete check)
@@ -764,17 +754,12 @@ void handle_users_generate_api_key(const http_request_t *req, http_response_t *r
 
     // Extract user ID from URL
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
 
-    char *suffix = strchr(id_str, '/');
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     int64_t user_id = strtoll(id_str, NULL, 10);
 
     // Check if the user has permission to generate API key for this user
@@ -831,7 +816,7 @@ void handle_users_change_password(const http_request_t *req, http_response_t *re
 
     // Extract user ID from URL
     char id_str[16] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -946,7 +931,7 @@ void handle_users_password_lock(const http_request_t *req, http_response_t *res)
 
     // Extract user ID from URL
     char id_str[16] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
@@ -1022,17 +1007,12 @@ void handle_users_clear_login_lockout(const http_request_t *req, http_response_t
     }
 
     char id_str[64] = {0};
-    if (http_request_extract_path_param(req, "/api/auth/users/", id_str, sizeof(id_str)) != 0) {
+    if (http_request_get_path_param(req, 0, id_str, sizeof(id_str)) != 0) {
         log_error("Failed to extract user ID from URL");
         http_response_set_json_error(res, 400, "Invalid request path");
         return;
     }
 
-    char *suffix = strchr(id_str, '/');
-    if (suffix) {
-        *suffix = '\0';
-    }
-
     int64_t user_id = strtoll(id_str, NULL, 10);
     user_t user;
     int rc = db_auth_get_user_by_id(user_id, &user);
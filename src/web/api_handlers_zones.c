@@ -30,17 +30,11 @@ void handle_get_zones(const http_request_t *req, http_response_t *res) {
     char stream_name[MAX_STREAM_NAME];
 
     // Extract stream name from URL
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name");
         return;
     }
 
-    // Remove "/zones" suffix from stream_name if present
-    char *zones_suffix = strstr(stream_name, "/zones");
-    if (zones_suffix) {
-        *zones_suffix = '\0';
-    }
-
     log_info("GET /api/streams/%s/zones", stream_name);
 
     // Get zones from database
@@ -126,17 +120,11 @@ void handle_post_zones(const http_request_t *req, http_response_t *res) {
     char stream_name[MAX_STREAM_NAME];
 
     // Extract stream name from URL
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name");
         return;
     }
 
-    // Remove "/zones" suffix from stream_name if present
-    char *zones_suffix = strstr(stream_name, "/zones");
-    if (zones_suffix) {
-        *zones_suffix = '\0';
-    }
-
     log_info("POST /api/streams/%s/zones", stream_name);
 
     // Parse JSON body
@@ -275,17 +263,11 @@ void handle_delete_zones(const http_request_t *req, http_response_t *res) {
     char stream_name[MAX_STREAM_NAME];
 
     // Extract stream name from URL
-    if (http_request_extract_path_param(req, "/api/streams/", stream_name, sizeof(stream_name)) != 0) {
+    if (http_request_get_path_param(req, 0, stream_name, sizeof(stream_name)) != 0) {
         http_response_set_json_error(res, 400, "Invalid stream name");
         return;
     }
 
-    // Remove "/zones" suffix from stream_name if present
-    char *zones_suffix = strstr(stream_name, "/zones");
-    if (zones_suffix) {
-        *zones_suffix = '\0';
-    }
-
     log_info("DELETE /api/streams/%s/zones", stream_name);
 
     // Delete zones from database
@@ -1,11 +1,17 @@
 /**
  * @file go2rtc_proxy_thread.c
- * @brief Detached-pthread proxy for go2rtc reverse-proxy requests
+ * @brief Event-loop proxy for go2rtc reverse-proxy requests
  *
- * Bypasses the shared libuv thread pool (UV_THREADPOOL_SIZE=16) by spawning
- * one short-lived detached pthread per proxy request.  Completed responses are
- * delivered back to the event-loop thread via a uv_async_t handle so that
- * libuv_send_response_ex() is always called from the loop thread, as required.
+ * Proxy requests are curl easy handles on one curl multi handle that is
+ * driven by the server's event loop (uv_poll per upstream socket plus a
+ * uv_timer for curl's timeouts), so no thread is created per request and
+ * the shared libuv thread pool is not touched.  The multi handle keeps the
+ * connections to go2rtc alive between requests.
+ *
+ * Response bodies are passed to the client as curl delivers them.  When the
+ * client socket has too much queued, the transfer is paused until the writes
+ * drain, which bounds the memory a large snapshot or a long MJPEG stream can
+ * take.  Everything in this file runs on the event-loop thread.
  */
 
 #ifdef HTTP_BACKEND_LIBUV
@@ -15,56 +21,90 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
-#include <unistd.h>
 #include <strings.h>
+#include <llhttp.h>
 #include <curl/curl.h>
 
 #include "web/go2rtc_proxy_thread.h"
 #include "web/libuv_connection.h"
 #include "web/request_response.h"
 #include "core/config.h"
+#include "core/curl_init.h"
 #define LOG_COMPONENT "go2rtcProxy"
 #include "core/logger.h"
 #include "utils/memory.h"
 #include "utils/strings.h"
 
-// Maximum concurrent proxy threads (independent of UV_THREADPOOL_SIZE)
-#define MAX_CONCURRENT_PROXY_THREADS 32
+// Maximum proxy requests in flight or queued for an upstream connection
+#define MAX_PROXY_TRANSFERS 64
+
+// Idle easy handles kept for reuse
+#define MAX_IDLE_EASY_HANDLES 8
+
+// Pause the upstream transfer once this much is queued for the client, and
+// resume once the queue drains below the low-water mark
+#define PROXY_CLIENT_HIGH_WATER ((size_t)512 * 1024)
+#define PROXY_CLIENT_LOW_WATER  ((size_t)128 * 1024)
+
+// A transfer that moves no data for this long is aborted.  There is no total
+// timeout, so MJPEG and other long-lived streams keep flowing.
+#define PROXY_STALL_TIMEOUT_SEC 30L
 
 // ============================================================================
 // Internal types
 // ============================================================================
 
+typedef enum {
+    PROXY_BODY_LENGTH,      // Upstream Content-Length forwarded
+    PROXY_BODY_CHUNKED,     // Re-framed with chunked transfer encoding
+    PROXY_BODY_UNTIL_CLOSE  // HTTP/1.0 client: body ends when the connection closes
+} proxy_body_mode_t;
+
 /**
- * @brief Per-request context — allocated before the thread is spawned.
+ * @brief One proxied request
  *
- * All fields needed by the blocking curl call are captured here so the thread
- * never touches the (potentially freed) connection struct.  The connection
- * pointer is only accessed from the event-loop thread in proxy_async_cb().
+ * Lives until the upstream transfer has finished and every write to the
+ * client has completed.  conn is cleared if the connection is destroyed
+ * first.
  */
-typedef struct proxy_thread_ctx {
-    // Captured request data
+typedef struct proxy_transfer {
+    CURL *easy;                 // NULL once the transfer is finished
+    struct curl_slist *headers;
     char url[2048];
-    char method[16];
-    char *body;                 // malloc'd copy, NULL if no body
-    size_t body_len;
-    char content_type[256];
+    char *body;                 // Request body copy, NULL if none
     write_complete_action_t action;
-
-    // Connection for response delivery (safe only on event-loop thread)
     libuv_connection_t *conn;
 
-    // Response populated by the worker thread
-    char *response_buffer;      // malloc'd body, may be NULL
-    size_t response_size;
-    char response_content_type[256];
-    long http_code;
-    bool error;
+    // Upstream response headers (reset on every status line, for redirects)
+    char content_type[256];
+    long long content_length;   // -1 if not sent
+
+    bool headers_sent;
+    proxy_body_mode_t body_mode;
+    bool paused;                // Waiting for the client to drain
+    bool failed;                // Client write failed or the transfer was aborted
+    int pending_writes;
+    size_t bytes_sent;
+
+    struct proxy_transfer *next;    // Active transfer list
+} proxy_transfer_t;
+
+/**
+ * @brief A client write, freed by its callback
+ */
+typedef struct {
+    uv_write_t req;             // Must be first
+    uv_buf_t buf;
+    proxy_transfer_t *transfer;
+} proxy_write_t;
 
-    // Intrusive linked-list node for the done queue
-    struct proxy_thread_ctx *next;
-} proxy_thread_ctx_t;
+/**
+ * @brief uv_poll handle for one upstream socket
+ */
+typedef struct {
+    uv_poll_t poll;
+    curl_socket_t sockfd;
+} proxy_socket_t;
 
 // ============================================================================
 // Global state
@@ -72,200 +112,453 @@ typedef struct proxy_thread_ctx {
 
 static struct {
     uv_loop_t *loop;
-    uv_async_t async_handle;
-    pthread_mutex_t done_mutex;
-    proxy_thread_ctx_t *done_head;
-    proxy_thread_ctx_t *done_tail;
-    volatile int active_count;
-    volatile bool shutting_down;
+    uv_timer_t timer;
+    CURLM *multi;
+    proxy_transfer_t *transfers;
+    int active_count;
+    CURL *idle_easy[MAX_IDLE_EASY_HANDLES];
+    int idle_count;
+    bool shutting_down;
     bool initialized;
 } g_proxy_state = {0};
 
+static void proxy_transfer_finish(proxy_transfer_t *t, CURLcode result);
+static void proxy_check_multi_info(void);
+
 // ============================================================================
-// curl write/header callbacks
+// Transfer bookkeeping
 // ============================================================================
 
-static size_t proxy_write_cb(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t total = size * nmemb;
-    proxy_thread_ctx_t *ctx = (proxy_thread_ctx_t *)userp;
+static CURL *proxy_easy_acquire(void) {
+    if (g_proxy_state.idle_count > 0) {
+        CURL *easy = g_proxy_state.idle_easy[--g_proxy_state.idle_count];
+        curl_easy_reset(easy);
+        return easy;
+    }
+    return curl_easy_init();
+}
 
-    char *new_buf = realloc(ctx->response_buffer, ctx->response_size + total);
-    if (!new_buf) {
-        log_error("go2rtc proxy thread: Response buffer realloc failed");
-        ctx->error = true;
-        return 0;
+static void proxy_easy_release(CURL *easy) {
+    if (g_proxy_state.idle_count < MAX_IDLE_EASY_HANDLES && !g_proxy_state.shutting_down) {
+        g_proxy_state.idle_easy[g_proxy_state.idle_count++] = easy;
+    } else {
+        curl_easy_cleanup(easy);
     }
-    ctx->response_buffer = new_buf;
-    memcpy(ctx->response_buffer + ctx->response_size, contents, total);
-    ctx->response_size += total;
-    return total;
 }
 
-static size_t proxy_header_cb(char *buffer, size_t size, size_t nitems, void *userp) {
-    size_t total = size * nitems;
-    proxy_thread_ctx_t *ctx = (proxy_thread_ctx_t *)userp;
-
-    if (total > 14 && strncasecmp(buffer, "Content-Type:", 13) == 0) {
-        const char *val = buffer + 13;
-        while (*val == ' ' || *val == '\t') val++;
-        size_t len = total - (size_t)(val - buffer);
-        while (len > 0 && (val[len - 1] == '\r' || val[len - 1] == '\n')) len--;
-        if (len >= sizeof(ctx->response_content_type))
-            len = sizeof(ctx->response_content_type) - 1;
-        memcpy(ctx->response_content_type, val, len);
-        ctx->response_content_type[len] = '\0';
+static void proxy_transfer_unlink(proxy_transfer_t *t) {
+    proxy_transfer_t **link = &g_proxy_state.transfers;
+    while (*link) {
+        if (*link == t) {
+            *link = t->next;
+            g_proxy_state.active_count--;
+            return;
+        }
+        link = &(*link)->next;
     }
-    return total;
+}
+
+/**
+ * @brief Stop the upstream side of a transfer
+ */
+static void proxy_transfer_stop(proxy_transfer_t *t) {
+    if (!t->easy) {
+        return;
+    }
+    curl_multi_remove_handle(g_proxy_state.multi, t->easy);
+    proxy_easy_release(t->easy);
+    t->easy = NULL;
+    if (t->headers) {
+        curl_slist_free_all(t->headers);
+        t->headers = NULL;
+    }
+    proxy_transfer_unlink(t);
+}
+
+static void proxy_transfer_free_if_done(proxy_transfer_t *t) {
+    if (t->easy || t->pending_writes > 0 || t->conn) {
+        return;
+    }
+    if (t->body) free(t->body);
+    safe_free(t);
+}
+
+/**
+ * @brief Hand the connection back once the response is fully written
+ */
+static void proxy_release_connection(proxy_transfer_t *t) {
+    libuv_connection_t *conn = t->conn;
+    if (!conn || t->easy || t->pending_writes > 0) {
+        return;
+    }
+
+    t->conn = NULL;
+    conn->proxy_transfer = NULL;
+    conn->async_response_pending = false;
+
+    if (!g_proxy_state.shutting_down && !conn->server->shutting_down &&
+        !uv_is_closing((uv_handle_t *)&conn->handle)) {
+        if (!t->failed && t->body_mode != PROXY_BODY_UNTIL_CLOSE &&
+            t->action == WRITE_ACTION_KEEP_ALIVE) {
+            libuv_connection_reset(conn);
+        } else {
+            libuv_connection_close(conn);
+        }
+    }
+    proxy_transfer_free_if_done(t);
 }
 
 // ============================================================================
-// Done-queue helpers (thread-safe)
+// Client writes
 // ============================================================================
 
-static void enqueue_done(proxy_thread_ctx_t *ctx) {
-    pthread_mutex_lock(&g_proxy_state.done_mutex);
-    ctx->next = NULL;
-    if (g_proxy_state.done_tail) {
-        g_proxy_state.done_tail->next = ctx;
+static void proxy_client_write_cb(uv_write_t *req, int status) {
+    proxy_write_t *w = (proxy_write_t *)req;
+    proxy_transfer_t *t = w->transfer;
+    safe_free(w->buf.base);
+    safe_free(w);
+    t->pending_writes--;
+
+    if (status < 0) {
+        if (!t->failed) {
+            log_debug("go2rtc proxy: Client write failed for %s: %s", t->url, uv_strerror(status));
+        }
+        t->failed = true;
+        proxy_transfer_stop(t);
+    } else if (t->paused && t->easy && t->conn &&
+               uv_stream_get_write_queue_size((uv_stream_t *)&t->conn->handle) <= PROXY_CLIENT_LOW_WATER) {
+        t->paused = false;
+        curl_easy_pause(t->easy, CURLPAUSE_CONT);
+    }
+
+    if (t->conn) {
+        proxy_release_connection(t);
     } else {
-        g_proxy_state.done_head = ctx;
+        proxy_transfer_free_if_done(t);
     }
-    g_proxy_state.done_tail = ctx;
-    pthread_mutex_unlock(&g_proxy_state.done_mutex);
 }
 
-static proxy_thread_ctx_t *dequeue_all_done(void) {
-    pthread_mutex_lock(&g_proxy_state.done_mutex);
-    proxy_thread_ctx_t *head = g_proxy_state.done_head;
-    g_proxy_state.done_head = NULL;
-    g_proxy_state.done_tail = NULL;
-    pthread_mutex_unlock(&g_proxy_state.done_mutex);
-    return head;
+/**
+ * @brief Queue bytes for the client; takes ownership of @p data
+ */
+static int proxy_client_write(proxy_transfer_t *t, char *data, size_t len) {
+    libuv_connection_t *conn = t->conn;
+    if (!conn || uv_is_closing((uv_handle_t *)&conn->handle)) {
+        safe_free(data);
+        return -1;
+    }
+
+    proxy_write_t *w = safe_malloc(sizeof(proxy_write_t));
+    if (!w) {
+        safe_free(data);
+        return -1;
+    }
+    w->buf = uv_buf_init(data, (unsigned int)len);
+    w->transfer = t;
+
+    int r = uv_write(&w->req, (uv_stream_t *)&conn->handle, &w->buf, 1, proxy_client_write_cb);
+    if (r != 0) {
+        log_error("go2rtc proxy: Client write failed: %s", uv_strerror(r));
+        safe_free(data);
+        safe_free(w);
+        return -1;
+    }
+    t->pending_writes++;
+    t->bytes_sent += len;
+    return 0;
 }
 
+/**
+ * @brief Send the response head once the upstream status is known
+ */
+static int proxy_send_headers(proxy_transfer_t *t) {
+    libuv_connection_t *conn = t->conn;
+    long code = 0;
+    curl_easy_getinfo(t->easy, CURLINFO_RESPONSE_CODE, &code);
+
+    char length_header[64] = "";
+    if (t->content_length >= 0) {
+        t->body_mode = PROXY_BODY_LENGTH;
+        snprintf(length_header, sizeof(length_header), "Content-Length: %lld\r\n",
+                 t->content_length);
+    } else if (conn->parser.http_major == 1 && conn->parser.http_minor == 0) {
+        t->body_mode = PROXY_BODY_UNTIL_CLOSE;
+    } else {
+        t->body_mode = PROXY_BODY_CHUNKED;
+        safe_strcpy(length_header, "Transfer-Encoding: chunked\r\n", sizeof(length_header), 0);
+    }
+
+    char content_type_header[300] = "";
+    if (t->content_type[0] != '\0') {
+        snprintf(content_type_header, sizeof(content_type_header), "Content-Type: %s\r\n",
+                 t->content_type);
+    }
 
+    char headers[1024];
+    int len = snprintf(headers, sizeof(headers),
+        "HTTP/1.1 %ld %s\r\n"
+        "%s"
+        "%s"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n"
+        "Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
+        "\r\n",
+        code, libuv_get_status_phrase((int)code), content_type_header, length_header);
+    if (len < 0 || (size_t)len >= sizeof(headers)) {
+        return -1;
+    }
+
+    char *buf = safe_malloc((size_t)len);
+    if (!buf) {
+        return -1;
+    }
+    memcpy(buf, headers, (size_t)len);
+    if (proxy_client_write(t, buf, (size_t)len) != 0) {
+        return -1;
+    }
+    t->headers_sent = true;
+    return 0;
+}
 
 // ============================================================================
-// Worker thread
+// curl callbacks
 // ============================================================================
 
-static void *proxy_worker_thread(void *arg) {
-    log_set_thread_context("go2rtcProxy", NULL);
-    proxy_thread_ctx_t *ctx = (proxy_thread_ctx_t *)arg;
+static size_t proxy_write_cb(char *data, size_t size, size_t nmemb, void *userp) {
+    size_t total = size * nmemb;
+    proxy_transfer_t *t = (proxy_transfer_t *)userp;
 
-    CURL *curl = curl_easy_init();
-    if (!curl) {
-        log_error("go2rtc proxy thread: curl_easy_init failed");
-        ctx->error = true;
-        goto done;
+    if (!t->conn || t->failed) {
+        return 0;   // Client is gone: abort the transfer
     }
 
-    curl_easy_setopt(curl, CURLOPT_URL, ctx->url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, proxy_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, ctx);
-    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, proxy_header_cb);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, ctx);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
+    if (!t->headers_sent && proxy_send_headers(t) != 0) {
+        t->failed = true;
+        return 0;
+    }
+    if (total == 0) {
+        return 0;
+    }
 
-    struct curl_slist *headers = NULL;
+    // Let the client catch up before accepting more; curl hands this
+    // data over again once the transfer is resumed
+    if (uv_stream_get_write_queue_size((uv_stream_t *)&t->conn->handle) > PROXY_CLIENT_HIGH_WATER) {
+        t->paused = true;
+        return CURL_WRITEFUNC_PAUSE;
+    }
 
-    if (strcmp(ctx->method, "POST") == 0) {
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        if (ctx->body && ctx->body_len > 0) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, ctx->body);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)ctx->body_len);
-        }
-    } else if (strcmp(ctx->method, "PUT") == 0) {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-        if (ctx->body && ctx->body_len > 0) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, ctx->body);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)ctx->body_len);
-        }
-    } else if (strcmp(ctx->method, "DELETE") == 0) {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    char prefix[24];
+    size_t prefix_len = 0;
+    size_t suffix_len = 0;
+    if (t->body_mode == PROXY_BODY_CHUNKED) {
+        prefix_len = (size_t)snprintf(prefix, sizeof(prefix), "%zx\r\n", total);
+        suffix_len = 2;
     }
 
-    if (ctx->content_type[0] != '\0') {
-        char ct_header[280];
-        snprintf(ct_header, sizeof(ct_header), "Content-Type: %s", ctx->content_type);
-        headers = curl_slist_append(headers, ct_header);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    }
-
-    {
-        CURLcode cres = curl_easy_perform(curl);
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &ctx->http_code);
-        if (headers) curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        if (cres != CURLE_OK || ctx->error) {
-            log_warn("go2rtc proxy thread: curl failed: %s", curl_easy_strerror(cres));
-            ctx->error = true;
-        }
+    char *buf = safe_malloc(prefix_len + total + suffix_len);
+    if (!buf) {
+        t->failed = true;
+        return 0;
     }
+    memcpy(buf, prefix, prefix_len);
+    memcpy(buf + prefix_len, data, total);
+    if (suffix_len) {
+        memcpy(buf + prefix_len + total, "\r\n", 2);
+    }
+
+    if (proxy_client_write(t, buf, prefix_len + total + suffix_len) != 0) {
+        t->failed = true;
+        return 0;
+    }
+    return total;
+}
+
+static size_t proxy_header_cb(char *buffer, size_t size, size_t nitems, void *userp) {
+    size_t total = size * nitems;
+    proxy_transfer_t *t = (proxy_transfer_t *)userp;
+
+    // A new status line starts a new response (e.g. after a redirect)
+    if (total > 5 && strncmp(buffer, "HTTP/", 5) == 0) {
+        t->content_type[0] = '\0';
+        t->content_length = -1;
+        return total;
+    }
+
+    const char *val = NULL;
+    bool is_type = false;
+    if (total > 13 && strncasecmp(buffer, "Content-Type:", 13) == 0) {
+        val = buffer + 13;
+        is_type = true;
+    } else if (total > 15 && strncasecmp(buffer, "Content-Length:", 15) == 0) {
+        val = buffer + 15;
+    } else {
+        return total;
+    }
+
+    while (*val == ' ' || *val == '\t') val++;
+    size_t len = total - (size_t)(val - buffer);
+    while (len > 0 && (val[len - 1] == '\r' || val[len - 1] == '\n')) len--;
 
-done:
-    enqueue_done(ctx);
-    uv_async_send(&g_proxy_state.async_handle);
-    __sync_sub_and_fetch(&g_proxy_state.active_count, 1);
-    return NULL;
+    if (is_type) {
+        if (len >= sizeof(t->content_type))
+            len = sizeof(t->content_type) - 1;
+        memcpy(t->content_type, val, len);
+        t->content_type[len] = '\0';
+    } else {
+        char num[32];
+        if (len >= sizeof(num)) len = sizeof(num) - 1;
+        memcpy(num, val, len);
+        num[len] = '\0';
+        t->content_length = strtoll(num, NULL, 10);
+    }
+    return total;
 }
 
 // ============================================================================
-// uv_async callback — runs on the event-loop thread
+// curl multi <-> libuv glue
 // ============================================================================
 
-static void proxy_async_cb(uv_async_t *handle) {
+static void proxy_socket_close_cb(uv_handle_t *handle) {
+    safe_free(handle->data);
+}
+
+static void proxy_poll_cb(uv_poll_t *handle, int status, int events) {
+    proxy_socket_t *ps = (proxy_socket_t *)handle->data;
+    int flags = 0;
+    if (status < 0) {
+        flags = CURL_CSELECT_ERR;
+    } else {
+        if (events & UV_READABLE) flags |= CURL_CSELECT_IN;
+        if (events & UV_WRITABLE) flags |= CURL_CSELECT_OUT;
+    }
+
+    int running = 0;
+    curl_multi_socket_action(g_proxy_state.multi, ps->sockfd, flags, &running);
+    proxy_check_multi_info();
+}
+
+static int proxy_socket_cb(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp) {
+    (void)easy;
+    (void)userp;
+    proxy_socket_t *ps = (proxy_socket_t *)socketp;
+
+    if (what == CURL_POLL_REMOVE) {
+        if (ps) {
+            curl_multi_assign(g_proxy_state.multi, s, NULL);
+            if (!uv_is_closing((uv_handle_t *)&ps->poll)) {
+                uv_poll_stop(&ps->poll);
+                uv_close((uv_handle_t *)&ps->poll, proxy_socket_close_cb);
+            }
+        }
+        return 0;
+    }
+
+    if (!ps) {
+        ps = safe_calloc(1, sizeof(proxy_socket_t));
+        if (!ps) {
+            return -1;
+        }
+        ps->sockfd = s;
+        if (uv_poll_init_socket(g_proxy_state.loop, &ps->poll, s) != 0) {
+            safe_free(ps);
+            return -1;
+        }
+        ps->poll.data = ps;
+        curl_multi_assign(g_proxy_state.multi, s, ps);
+    }
+
+    int events = 0;
+    if (what & CURL_POLL_IN) events |= UV_READABLE;
+    if (what & CURL_POLL_OUT) events |= UV_WRITABLE;
+    uv_poll_start(&ps->poll, events, proxy_poll_cb);
+    return 0;
+}
+
+static void proxy_timeout_cb(uv_timer_t *handle) {
     (void)handle;
+    int running = 0;
+    curl_multi_socket_action(g_proxy_state.multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    proxy_check_multi_info();
+}
 
-    proxy_thread_ctx_t *ctx = dequeue_all_done();
-    while (ctx) {
-        proxy_thread_ctx_t *next = ctx->next;
-        libuv_connection_t *conn = ctx->conn;
-
-        if (g_proxy_state.shutting_down) {
-            // Server shutting down — connection may already be torn down
-            if (ctx->response_buffer) free(ctx->response_buffer);
-            if (ctx->body) free(ctx->body);
-            safe_free(ctx);
-            ctx = next;
+static int proxy_timer_cb(CURLM *multi, long timeout_ms, void *userp) {
+    (void)multi;
+    (void)userp;
+    if (timeout_ms < 0) {
+        uv_timer_stop(&g_proxy_state.timer);
+    } else {
+        // Never call back into curl from here; a zero timeout runs on the
+        // next loop iteration
+        uv_timer_start(&g_proxy_state.timer, proxy_timeout_cb, (uint64_t)timeout_ms, 0);
+    }
+    return 0;
+}
+
+static void proxy_check_multi_info(void) {
+    CURLMsg *msg;
+    int pending = 0;
+    while ((msg = curl_multi_info_read(g_proxy_state.multi, &pending))) {
+        if (msg->msg != CURLMSG_DONE) {
             continue;
         }
-
-        if (ctx->error || ctx->http_code == 0) {
-            http_response_set_json_error(&conn->response, 502,
-                                         "Proxy error: go2rtc is not responding");
-        } else {
-            conn->response.status_code = (int)ctx->http_code;
-            if (ctx->response_content_type[0] != '\0') {
-                safe_strcpy(conn->response.content_type, ctx->response_content_type,
-                        sizeof(conn->response.content_type), 0);
-            }
-            http_response_add_header(&conn->response, "Access-Control-Allow-Origin", "*");
-            http_response_add_header(&conn->response, "Access-Control-Allow-Methods",
-                                     "GET, POST, PUT, DELETE, OPTIONS");
-            http_response_add_header(&conn->response, "Access-Control-Allow-Headers",
-                                     "Content-Type, Authorization");
-            // Transfer buffer ownership to the response (freed by http_response_free)
-            conn->response.body = ctx->response_buffer;
-            conn->response.body_length = ctx->response_size;
-            conn->response.body_allocated = true;
-            ctx->response_buffer = NULL;  // ownership transferred
-            log_debug("go2rtc proxy thread: %s -> %ld (%zu bytes)",
-                      ctx->url, ctx->http_code, ctx->response_size);
+        proxy_transfer_t *t = NULL;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&t);
+        if (t) {
+            proxy_transfer_finish(t, msg->data.result);
         }
+    }
+}
+
+/**
+ * @brief Complete the response once curl is done with a transfer
+ */
+static void proxy_transfer_finish(proxy_transfer_t *t, CURLcode result) {
+    long code = 0;
+    curl_easy_getinfo(t->easy, CURLINFO_RESPONSE_CODE, &code);
+    libuv_connection_t *conn = t->conn;
+
+    // An empty body never reaches the write callback
+    if (conn && !t->failed && result == CURLE_OK && code != 0 && !t->headers_sent &&
+        proxy_send_headers(t) != 0) {
+        t->failed = true;
+    }
+
+    proxy_transfer_stop(t);
+
+    if (!conn) {
+        proxy_transfer_free_if_done(t);
+        return;
+    }
 
+    if (!t->headers_sent) {
+        // Nothing has gone out yet, so the client can get a proper error
+        log_warn("go2rtc proxy: %s failed: %s", t->url, curl_easy_strerror(result));
+        t->conn = NULL;
+        conn->proxy_transfer = NULL;
         conn->async_response_pending = false;
-        libuv_send_response_ex(conn, &conn->response, ctx->action);
+        http_response_set_json_error(&conn->response, 502,
+                                     "Proxy error: go2rtc is not responding");
+        libuv_send_response_ex(conn, &conn->response, t->action);
+        proxy_transfer_free_if_done(t);
+        return;
+    }
+
+    if (result != CURLE_OK && !t->failed) {
+        // The response is already under way; all that can be done is cut it short
+        log_warn("go2rtc proxy: %s aborted after %zu bytes: %s", t->url, t->bytes_sent,
+                 curl_easy_strerror(result));
+        t->failed = true;
+    } else if (!t->failed && t->body_mode == PROXY_BODY_CHUNKED) {
+        char *last = safe_malloc(5);
+        if (!last || (memcpy(last, "0\r\n\r\n", 5), proxy_client_write(t, last, 5)) != 0) {
+            t->failed = true;
+        }
+    }
 
-        if (ctx->response_buffer) free(ctx->response_buffer);
-        if (ctx->body) free(ctx->body);
-        safe_free(ctx);
-        ctx = next;
+    if (!t->failed) {
+        log_debug("go2rtc proxy: %s -> %ld (%zu bytes)", t->url, code, t->bytes_sent);
     }
+    proxy_release_connection(t);
 }
 
 // ============================================================================
@@ -295,20 +588,34 @@ int go2rtc_proxy_thread_init(uv_loop_t *loop) {
     memset(&g_proxy_state, 0, sizeof(g_proxy_state));
     g_proxy_state.loop = loop;
 
-    if (pthread_mutex_init(&g_proxy_state.done_mutex, NULL) != 0) {
-        log_error("go2rtc_proxy_thread_init: Failed to initialize mutex");
+    if (curl_init_global() != 0) {
+        log_error("go2rtc_proxy_thread_init: libcurl initialization failed");
+        return -1;
+    }
+
+    if (uv_timer_init(loop, &g_proxy_state.timer) != 0) {
+        log_error("go2rtc_proxy_thread_init: Failed to initialize timer");
         return -1;
     }
 
-    if (uv_async_init(loop, &g_proxy_state.async_handle, proxy_async_cb) != 0) {
-        log_error("go2rtc_proxy_thread_init: Failed to initialize uv_async");
-        pthread_mutex_destroy(&g_proxy_state.done_mutex);
+    g_proxy_state.multi = curl_multi_init();
+    if (!g_proxy_state.multi) {
+        log_error("go2rtc_proxy_thread_init: curl_multi_init failed");
+        uv_close((uv_handle_t *)&g_proxy_state.timer, NULL);
         return -1;
     }
 
+    // Connections to go2rtc are kept alive and reused; requests beyond the
+    // connection limit wait inside curl for one to free up
+    long max_connections = g_config.go2rtc_proxy_max_inflight > 0 ? g_config.go2rtc_proxy_max_inflight : 16;
+    curl_multi_setopt(g_proxy_state.multi, CURLMOPT_SOCKETFUNCTION, proxy_socket_cb);
+    curl_multi_setopt(g_proxy_state.multi, CURLMOPT_TIMERFUNCTION, proxy_timer_cb);
+    curl_multi_setopt(g_proxy_state.multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_connections);
+    curl_multi_setopt(g_proxy_state.multi, CURLMOPT_MAXCONNECTS, max_connections);
+
     g_proxy_state.initialized = true;
-    log_info("go2rtc_proxy_thread_init: Initialized (max %d concurrent proxy threads)",
-             MAX_CONCURRENT_PROXY_THREADS);
+    log_info("go2rtc_proxy_thread_init: Initialized (up to %ld pooled connections to go2rtc)",
+             max_connections);
     return 0;
 }
 
@@ -321,100 +628,148 @@ int go2rtc_proxy_thread_submit(libuv_connection_t *conn, write_complete_action_t
         log_warn("go2rtc_proxy_thread_submit: Rejecting request during shutdown");
         return -1;
     }
-    if (__sync_fetch_and_add(&g_proxy_state.active_count, 0) >= MAX_CONCURRENT_PROXY_THREADS) {
-        log_warn("go2rtc_proxy_thread_submit: Max concurrent proxy threads (%d) reached",
-                 MAX_CONCURRENT_PROXY_THREADS);
+    if (g_proxy_state.active_count >= MAX_PROXY_TRANSFERS) {
+        log_warn("go2rtc_proxy_thread_submit: Max concurrent proxy requests (%d) reached",
+                 MAX_PROXY_TRANSFERS);
         return -1;
     }
 
     const http_request_t *req = &conn->request;
     int port = g_config.go2rtc_api_port > 0 ? g_config.go2rtc_api_port : 1984;
 
-    proxy_thread_ctx_t *ctx = safe_calloc(1, sizeof(proxy_thread_ctx_t));
-    if (!ctx) {
+    proxy_transfer_t *t = safe_calloc(1, sizeof(proxy_transfer_t));
+    if (!t) {
         log_error("go2rtc_proxy_thread_submit: Failed to allocate context");
         return -1;
     }
+    t->action = action;
+    t->content_length = -1;
 
     // Forward the full path as-is. go2rtc is configured with base_path: /go2rtc
     // (see GO2RTC_BASE_PATH), so it serves /go2rtc/api/streams directly.
     if (req->query_string[0] != '\0') {
-        snprintf(ctx->url, sizeof(ctx->url), "http://127.0.0.1:%d%s?%s",
+        snprintf(t->url, sizeof(t->url), "http://127.0.0.1:%d%s?%s",
                  port, req->path, req->query_string);
     } else {
-        snprintf(ctx->url, sizeof(ctx->url), "http://127.0.0.1:%d%s",
+        snprintf(t->url, sizeof(t->url), "http://127.0.0.1:%d%s",
                  port, req->path);
     }
 
-    safe_strcpy(ctx->method, req->method_str, sizeof(ctx->method), 0);
-    safe_strcpy(ctx->content_type, req->content_type, sizeof(ctx->content_type), 0);
-    ctx->action = action;
-    ctx->conn   = conn;
-
     if (req->body && req->body_len > 0) {
-        ctx->body = malloc(req->body_len);
-        if (!ctx->body) {
+        t->body = malloc(req->body_len);
+        if (!t->body) {
             log_error("go2rtc_proxy_thread_submit: Failed to copy request body");
-            safe_free(ctx);
+            safe_free(t);
             return -1;
         }
-        memcpy(ctx->body, req->body, req->body_len);
-        ctx->body_len = req->body_len;
+        memcpy(t->body, req->body, req->body_len);
     }
 
-    conn->async_response_pending = true;
-    __sync_add_and_fetch(&g_proxy_state.active_count, 1);
+    t->easy = proxy_easy_acquire();
+    if (!t->easy) {
+        log_error("go2rtc_proxy_thread_submit: curl_easy_init failed");
+        if (t->body) free(t->body);
+        safe_free(t);
+        return -1;
+    }
 
-    pthread_t thread;
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    CURL *curl = t->easy;
+    curl_easy_setopt(curl, CURLOPT_URL, t->url);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, t);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, proxy_write_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, t);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, proxy_header_cb);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, t);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, PROXY_STALL_TIMEOUT_SEC);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 3L);
 
-    if (pthread_create(&thread, &attr, proxy_worker_thread, ctx) != 0) {
-        log_error("go2rtc_proxy_thread_submit: pthread_create failed");
-        pthread_attr_destroy(&attr);
-        __sync_sub_and_fetch(&g_proxy_state.active_count, 1);
-        conn->async_response_pending = false;
-        if (ctx->body) free(ctx->body);
-        safe_free(ctx);
+    if (strcmp(req->method_str, "POST") == 0) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        if (t->body) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, t->body);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)req->body_len);
+        }
+    } else if (strcmp(req->method_str, "PUT") == 0) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+        if (t->body) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, t->body);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)req->body_len);
+        }
+    } else if (strcmp(req->method_str, "DELETE") == 0) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    }
+
+    if (req->content_type[0] != '\0') {
+        char ct_header[280];
+        snprintf(ct_header, sizeof(ct_header), "Content-Type: %s", req->content_type);
+        t->headers = curl_slist_append(t->headers, ct_header);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t->headers);
+    }
+
+    if (curl_multi_add_handle(g_proxy_state.multi, curl) != CURLM_OK) {
+        log_error("go2rtc_proxy_thread_submit: curl_multi_add_handle failed");
+        if (t->headers) curl_slist_free_all(t->headers);
+        proxy_easy_release(curl);
+        if (t->body) free(t->body);
+        safe_free(t);
         return -1;
     }
 
-    pthread_attr_destroy(&attr);
-    log_debug("go2rtc_proxy_thread_submit: Submitted %s %s", ctx->method, ctx->url);
+    t->conn = conn;
+    t->next = g_proxy_state.transfers;
+    g_proxy_state.transfers = t;
+    g_proxy_state.active_count++;
+    conn->proxy_transfer = t;
+    conn->async_response_pending = true;
+
+    log_debug("go2rtc_proxy_thread_submit: Submitted %s %s", req->method_str, t->url);
     return 0;
 }
 
+void go2rtc_proxy_detach(libuv_connection_t *conn) {
+    proxy_transfer_t *t = conn->proxy_transfer;
+    conn->proxy_transfer = NULL;
+    if (!t) {
+        return;
+    }
+
+    t->conn = NULL;
+    t->failed = true;
+    proxy_transfer_stop(t);
+    proxy_transfer_free_if_done(t);
+}
+
 void go2rtc_proxy_thread_shutdown(void) {
     if (!g_proxy_state.initialized) return;
 
     log_info("go2rtc_proxy_thread_shutdown: Shutting down");
     g_proxy_state.shutting_down = true;
 
-    // Wait up to 10 s for in-flight threads to finish
-    int wait_count = 0;
-    while (__sync_fetch_and_add(&g_proxy_state.active_count, 0) > 0 && wait_count < 100) {
-        usleep(100000);  // 100 ms
-        wait_count++;
-    }
-    if (g_proxy_state.active_count > 0) {
-        log_warn("go2rtc_proxy_thread_shutdown: %d threads still active after timeout",
-                 g_proxy_state.active_count);
+    // Connections were already torn down with the server; anything left has
+    // no client to answer
+    while (g_proxy_state.transfers) {
+        proxy_transfer_t *t = g_proxy_state.transfers;
+        if (t->conn) {
+            t->conn->proxy_transfer = NULL;
+            t->conn = NULL;
+        }
+        proxy_transfer_stop(t);
+        proxy_transfer_free_if_done(t);
     }
 
-    if (!uv_is_closing((uv_handle_t *)&g_proxy_state.async_handle)) {
-        uv_close((uv_handle_t *)&g_proxy_state.async_handle, NULL);
+    curl_multi_cleanup(g_proxy_state.multi);
+    g_proxy_state.multi = NULL;
+    while (g_proxy_state.idle_count > 0) {
+        curl_easy_cleanup(g_proxy_state.idle_easy[--g_proxy_state.idle_count]);
     }
-    pthread_mutex_destroy(&g_proxy_state.done_mutex);
 
-    // Drain any remaining done-queue items
-    proxy_thread_ctx_t *ctx = g_proxy_state.done_head;
-    while (ctx) {
-        proxy_thread_ctx_t *next = ctx->next;
-        if (ctx->response_buffer) free(ctx->response_buffer);
-        if (ctx->body) free(ctx->body);
-        safe_free(ctx);
-        ctx = next;
+    if (!uv_is_closing((uv_handle_t *)&g_proxy_state.timer)) {
+        uv_timer_stop(&g_proxy_state.timer);
+        uv_close((uv_handle_t *)&g_proxy_state.timer, NULL);
     }
 
     g_proxy_state.initialized = false;
@@ -0,0 +1,257 @@
+/**
+ * @file hls_blocking_reload.c
+ * @brief LL-HLS blocking playlist reloads parked on the event loop
+ *
+ * Everything here except hls_blocking_reload_defer() and the store listener
+ * runs on the event-loop thread, so the list of parked requests needs no
+ * lock.  HLS writers publish parts from their own threads; the memory store
+ * listener only calls uv_async_send, and the async callback re-checks every
+ * parked request against the published positions.
+ */
+
+#ifdef HTTP_BACKEND_LIBUV
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "web/hls_blocking_reload.h"
+#include "web/libuv_connection.h"
+#include "web/request_response.h"
+#include "video/hls/hls_memory_store.h"
+#include "video/hls/hls_ll_playlist.h"
+#include "core/config.h"
+#define LOG_COMPONENT "HLSReload"
+#include "core/logger.h"
+#include "utils/memory.h"
+#include "utils/strings.h"
+
+// How often parked requests are checked for their deadline
+#define HLS_RELOAD_TIMER_MS 250
+
+// Used when the stream has not reported a target duration
+#define HLS_RELOAD_DEFAULT_TARGET_DURATION 2
+
+// ============================================================================
+// Internal types
+// ============================================================================
+
+typedef struct hls_reload_waiter {
+    libuv_connection_t *conn;
+    char stream_name[MAX_STREAM_NAME];
+    char file_name[64];
+    int64_t msn;
+    int part;
+    uint64_t deadline;                  // uv_now() milliseconds
+    hls_reload_respond_t respond;
+    struct hls_reload_waiter *next;
+} hls_reload_waiter_t;
+
+static struct {
+    uv_loop_t *loop;
+    uv_async_t async_handle;
+    uv_timer_t timer;
+    hls_reload_waiter_t *waiters;
+    int waiter_count;
+    volatile bool initialized;
+} g_reload_state;
+
+// ============================================================================
+// Internal helpers
+// ============================================================================
+
+/**
+ * @brief Memory store listener - runs on an HLS writer thread
+ */
+static void hls_reload_wake(void) {
+    if (g_reload_state.initialized) {
+        uv_async_send(&g_reload_state.async_handle);
+    }
+}
+
+/**
+ * @brief Check whether a parked request can be answered
+ */
+static bool waiter_ready(const hls_reload_waiter_t *waiter) {
+    int64_t cur_msn = 0;
+    int cur_parts = 0;
+    if (hls_memory_store_get_position(waiter->stream_name, &cur_msn, &cur_parts, NULL) != 0) {
+        // Stream stopped (or no longer low-latency): answer with whatever is left
+        return true;
+    }
+    return hls_ll_playlist_request_state(cur_msn, cur_parts, waiter->msn, waiter->part)
+           != HLS_LL_REQUEST_WAIT;
+}
+
+/**
+ * @brief Send the response for a request and free it
+ */
+static void waiter_answer(hls_reload_waiter_t *waiter, int result) {
+    libuv_connection_t *conn = waiter->conn;
+
+    waiter->respond(&conn->response, waiter->stream_name, waiter->file_name, result);
+    conn->async_response_pending = false;
+    libuv_send_response_ex(conn, &conn->response, conn->deferred_action);
+    safe_free(waiter);
+}
+
+/**
+ * @brief Answer every parked request that is ready or past its deadline
+ */
+static void process_waiters(void) {
+    uint64_t now = uv_now(g_reload_state.loop);
+
+    hls_reload_waiter_t **link = &g_reload_state.waiters;
+    while (*link) {
+        hls_reload_waiter_t *waiter = *link;
+        int result;
+        if (waiter_ready(waiter)) {
+            result = 0;
+        } else if (now >= waiter->deadline) {
+            log_debug("Blocking reload of %s/%s timed out waiting for %lld.%d",
+                      waiter->stream_name, waiter->file_name,
+                      (long long)waiter->msn, waiter->part);
+            result = -1;
+        } else {
+            link = &waiter->next;
+            continue;
+        }
+
+        *link = waiter->next;
+        g_reload_state.waiter_count--;
+        waiter_answer(waiter, result);
+    }
+
+    if (!g_reload_state.waiters) {
+        uv_timer_stop(&g_reload_state.timer);
+    }
+}
+
+static void hls_reload_async_cb(uv_async_t *handle) {
+    (void)handle;
+    process_waiters();
+}
+
+static void hls_reload_timer_cb(uv_timer_t *handle) {
+    (void)handle;
+    process_waiters();
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int hls_blocking_reload_init(uv_loop_t *loop) {
+    if (!loop) {
+        log_error("hls_blocking_reload_init: NULL loop");
+        return -1;
+    }
+
+    memset(&g_reload_state, 0, sizeof(g_reload_state));
+    g_reload_state.loop = loop;
+
+    if (uv_async_init(loop, &g_reload_state.async_handle, hls_reload_async_cb) != 0) {
+        log_error("hls_blocking_reload_init: Failed to initialize uv_async");
+        return -1;
+    }
+    if (uv_timer_init(loop, &g_reload_state.timer) != 0) {
+        log_error("hls_blocking_reload_init: Failed to initialize timer");
+        uv_close((uv_handle_t *)&g_reload_state.async_handle, NULL);
+        return -1;
+    }
+
+    g_reload_state.initialized = true;
+    hls_memory_store_set_listener(hls_reload_wake);
+    return 0;
+}
+
+void hls_blocking_reload_shutdown(void) {
+    if (!g_reload_state.initialized) {
+        return;
+    }
+
+    hls_memory_store_set_listener(NULL);
+    g_reload_state.initialized = false;
+
+    if (!uv_is_closing((uv_handle_t *)&g_reload_state.timer)) {
+        uv_timer_stop(&g_reload_state.timer);
+        uv_close((uv_handle_t *)&g_reload_state.timer, NULL);
+    }
+    if (!uv_is_closing((uv_handle_t *)&g_reload_state.async_handle)) {
+        uv_close((uv_handle_t *)&g_reload_state.async_handle, NULL);
+    }
+
+    // The connections themselves are closed by the server shutdown
+    hls_reload_waiter_t *waiter = g_reload_state.waiters;
+    while (waiter) {
+        hls_reload_waiter_t *next = waiter->next;
+        safe_free(waiter);
+        waiter = next;
+    }
+    g_reload_state.waiters = NULL;
+    g_reload_state.waiter_count = 0;
+}
+
+int hls_blocking_reload_defer(libuv_connection_t *conn, const char *stream_name,
+                              const char *file_name, int64_t msn, int part,
+                              hls_reload_respond_t respond) {
+    if (!conn || !stream_name || !file_name || !respond || !g_reload_state.initialized) {
+        return -1;
+    }
+
+    hls_reload_waiter_t *waiter = safe_calloc(1, sizeof(hls_reload_waiter_t));
+    if (!waiter) {
+        return -1;
+    }
+
+    waiter->conn = conn;
+    safe_strcpy(waiter->stream_name, stream_name, sizeof(waiter->stream_name), 0);
+    safe_strcpy(waiter->file_name, file_name, sizeof(waiter->file_name), 0);
+    waiter->msn = msn;
+    waiter->part = part;
+    waiter->respond = respond;
+
+    conn->deferred_hls_reload = waiter;
+    return 0;
+}
+
+void hls_blocking_reload_start(libuv_connection_t *conn) {
+    hls_reload_waiter_t *waiter = conn->deferred_hls_reload;
+    conn->deferred_hls_reload = NULL;
+    if (!waiter) {
+        return;
+    }
+
+    // The part may have been published while the handler was returning
+    if (!g_reload_state.initialized || waiter_ready(waiter)) {
+        waiter_answer(waiter, 0);
+        return;
+    }
+
+    // Per the LL-HLS spec, give up after three target durations
+    int target_duration = 0;
+    hls_memory_store_get_position(waiter->stream_name, NULL, NULL, &target_duration);
+    if (target_duration <= 0) {
+        target_duration = HLS_RELOAD_DEFAULT_TARGET_DURATION;
+    }
+    waiter->deadline = uv_now(g_reload_state.loop) + (uint64_t)target_duration * 3000;
+
+    conn->async_response_pending = true;
+    waiter->next = g_reload_state.waiters;
+    g_reload_state.waiters = waiter;
+    g_reload_state.waiter_count++;
+
+    if (!uv_is_active((uv_handle_t *)&g_reload_state.timer)) {
+        uv_timer_start(&g_reload_state.timer, hls_reload_timer_cb,
+                       HLS_RELOAD_TIMER_MS, HLS_RELOAD_TIMER_MS);
+    }
+
+    log_debug("Parked blocking reload of %s/%s for %lld.%d (%d waiting)",
+              waiter->stream_name, waiter->file_name, (long long)waiter->msn,
+              waiter->part, g_reload_state.waiter_count);
+}
+
+#endif /* HTTP_BACKEND_LIBUV */
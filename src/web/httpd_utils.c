@@ -363,19 +363,16 @@ int httpd_get_authenticated_user(const http_request_t *req, user_t *user) {
     char session_token[64] = {0};
     if (httpd_get_session_token(req, session_token, sizeof(session_token)) == 0) {
         int64_t user_id;
-        int rc = db_auth_validate_session(session_token, &user_id);
-        if (rc == 0) {
-            rc = db_auth_get_user_by_id(user_id, user);
-            if (rc == 0 && db_auth_ip_allowed_for_user(user, effective_client_ip)) {
-                rc = db_auth_validate_session_with_context(session_token, &user_id,
-                                                           effective_client_ip, req->user_agent);
-                if (rc == 0) {
-                    return 1;
-                }
-            } else if (rc == 0) {
-                log_warn("Session auth blocked by allowed_login_cidrs for user '%s' from IP %s",
-                         user->username, effective_client_ip[0] != '\0' ? effective_client_ip : "(unknown)");
+        int rc = db_auth_get_session_user(session_token, user);
+        if (rc == 0 && db_auth_ip_allowed_for_user(user, effective_client_ip)) {
+            rc = db_auth_validate_session_with_context(session_token, &user_id,
+                                                       effective_client_ip, req->user_agent);
+            if (rc == 0) {
+                return 1;
             }
+        } else if (rc == 0) {
+            log_warn("Session auth blocked by allowed_login_cidrs for user '%s' from IP %s",
+                     user->username, effective_client_ip[0] != '\0' ? effective_client_ip : "(unknown)");
         }
     }
 
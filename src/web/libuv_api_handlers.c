@@ -176,6 +176,7 @@ int register_all_libuv_handlers(http_server_handle_t server) {
     // Note: More specific routes must come before wildcard routes
     http_server_register_handler(server, "/api/recordings/thumbnail/#/#", "GET", handle_recordings_thumbnail);
     http_server_register_handler(server, "/api/recordings/play/#", "GET", handle_recordings_playback);
+    http_server_register_handler(server, "/api/recordings/keyframe/#", "GET", handle_recordings_keyframe);
     http_server_register_handler(server, "/api/recordings/download/#", "GET", handle_recordings_download);
     http_server_register_handler(server, "/api/recordings/files/check", "GET", handle_check_recording_file);
     http_server_register_handler(server, "/api/recordings/files", "DELETE", handle_delete_recording_file);
@@ -17,6 +17,8 @@
 #include "web/libuv_server.h"
 #include "web/libuv_connection.h"
 #include "web/go2rtc_proxy_thread.h"
+#include "web/hls_blocking_reload.h"
+#include "web/libuv_zip_stream.h"
 #include "web/api_handlers_health.h"
 #define LOG_COMPONENT "HTTP"
 #include "core/logger.h"
@@ -151,6 +153,18 @@ void libuv_connection_destroy(libuv_connection_t *conn) {
     if (!conn) return;
     
     http_response_free(&conn->response);
+
+    // A blocking HLS reload that never got parked (worker cancelled)
+    if (conn->deferred_hls_reload) {
+        safe_free(conn->deferred_hls_reload);
+        conn->deferred_hls_reload = NULL;
+    }
+
+    // A ZIP download that never started, or one with a chunk read in flight
+    libuv_zip_stream_detach(conn);
+
+    // A go2rtc proxy request still streaming to this connection
+    go2rtc_proxy_detach(conn);
     
     if (conn->recv_buffer) {
         safe_free(conn->recv_buffer);
@@ -393,65 +407,6 @@ static int on_body(llhttp_t *parser, const char *at, size_t length) {
     return 0;
 }
 
-/**
- * @brief Message complete callback - dispatch to handler
- */
-/**
- * @brief Match a path against a pattern with wildcard support
- *
- * Supports '#' as a single-segment wildcard (matches anything except '/')
- * Examples:
- *   - "/api/streams" matches "/api/streams" exactly
- *   - "/api/streams/#" matches "/api/streams/foo" but not "/api/streams/foo/bar"
- *   - "/api/streams/#/zones" matches "/api/streams/foo/zones"
- *   - "/go2rtc/*" matches "/go2rtc/api/streams", "/go2rtc/api/hls/segment.m4s", etc.
- *
- * @param path The request path to match
- * @param pattern The pattern to match against
- * @return true if path matches pattern, false otherwise
- */
-static bool path_matches_pattern(const char *path, const char *pattern) {
-    const char *p = path;
-    const char *pat = pattern;
-
-    while (*pat) {
-        if (*pat == '*') {
-            // Glob wildcard - match everything remaining (including slashes)
-            return true;
-        } else if (*pat == '#') {
-            // Wildcard - match any characters except '/'
-            pat++; // Move past '#'
-
-            // Skip characters in path until we hit '/' or end
-            while (*p && *p != '/') {
-                p++;
-            }
-
-            // If pattern expects more after wildcard, continue matching
-            // Otherwise, we're done
-            if (!*pat) {
-                // Pattern ends with '#', path should also end here
-                return *p == '\0';
-            }
-
-            // Pattern continues, path must also continue
-            if (!*p) {
-                return false;
-            }
-        } else if (*pat == *p) {
-            // Exact character match
-            pat++;
-            p++;
-        } else {
-            // Mismatch
-            return false;
-        }
-    }
-
-    // Both should be at end for exact match
-    return *p == '\0' && *pat == '\0';
-}
-
 // ============================================================================
 // Thread pool handler offloading (uv_queue_work)
 // ============================================================================
@@ -518,6 +473,22 @@ static void handler_after_work_cb(uv_work_t *req, int status) {
         http_response_set_json_error(&conn->response, 500, "Failed to serve file");
     }
 
+    // Blocking LL-HLS reloads are parked on the loop thread until the part
+    // they ask for is published, without keeping a worker busy
+    if (conn->deferred_hls_reload) {
+        update_health_metrics(true);
+        hls_blocking_reload_start(conn);
+        return;
+    }
+
+    // Batch ZIP downloads stream from the loop thread with their own
+    // headers and connection handling
+    if (conn->zip_stream) {
+        update_health_metrics(true);
+        libuv_zip_stream_start(conn);
+        return;
+    }
+
     // Check if handler initiated async response directly (shouldn't happen
     // from worker thread, but handle it defensively)
     if (conn->async_response_pending) {
@@ -579,26 +550,25 @@ static void static_file_resolve_handler(const http_request_t *req, http_response
     }
 }
 
+/**
+ * @brief Message complete callback - dispatch to handler
+ */
 static int on_message_complete(llhttp_t *parser) {
     libuv_connection_t *conn = (libuv_connection_t *)parser->data;
     conn->message_complete = true;
 
-    // Find matching handler
+    // Find matching handler and capture its '#' path parameters
     libuv_server_t *server = conn->server;
     request_handler_t handler = NULL;
-
-    for (int i = 0; i < server->handler_count; i++) {
-        // Check method match (empty = any)
-        if (server->handlers[i].method[0] != '\0') {
-            if (strcmp(server->handlers[i].method, conn->request.method_str) != 0) {
-                continue;
-            }
-        }
-
-        // Check path match with wildcard support
-        if (path_matches_pattern(conn->request.path, server->handlers[i].path)) {
-            handler = server->handlers[i].handler;
-            break;
+    route_match_t match;
+
+    conn->request.num_path_params = 0;
+    if (route_trie_match(&server->routes, conn->request.method, conn->request.path, &match)) {
+        handler = match.handler;
+        conn->request.num_path_params = match.num_params;
+        for (int i = 0; i < match.num_params; i++) {
+            conn->request.path_params[i].offset = match.params[i].offset;
+            conn->request.path_params[i].length = match.params[i].length;
         }
     }
 
@@ -613,8 +583,8 @@ static int on_message_complete(llhttp_t *parser) {
     // Set user_data to point to connection (needed for file serving and proxy)
     conn->request.user_data = conn;
 
-    // Go2rtc proxy paths use dedicated detached threads to avoid starving the
-    // shared libuv thread pool with 30-second blocking curl calls.
+    // Go2rtc proxy paths run on the event loop via curl multi so they never
+    // occupy the shared libuv thread pool.
     if (go2rtc_proxy_path_matches(conn->request.path)) {
         uv_read_stop((uv_stream_t *)&conn->handle);
         if (go2rtc_proxy_thread_submit(conn, action) == 0) {
@@ -17,8 +17,10 @@
 #define LOG_COMPONENT "HTTP"
 #include "core/logger.h"
 
-// HTTP status reason phrases
-static const char *get_status_phrase(int status_code) {
+/**
+ * @brief HTTP status reason phrases
+ */
+const char *libuv_get_status_phrase(int status_code) {
     switch (status_code) {
         case 200: return "OK";
         case 201: return "Created";
@@ -214,7 +216,7 @@ int libuv_send_response(libuv_connection_t *conn, const http_response_t *respons
         int written = snprintf(buffer + offset, remaining,
                                "HTTP/1.1 %d %s\r\n",
                                response->status_code,
-                               get_status_phrase(response->status_code));
+                               libuv_get_status_phrase(response->status_code));
         if (written < 0 || (size_t)written >= remaining) {
             log_error("libuv_send_response: Failed to write status line");
             safe_free(buffer);
@@ -288,7 +290,7 @@ int libuv_send_response(libuv_connection_t *conn, const http_response_t *respons
     }
     
     log_debug("libuv_send_response: Sending %d %s (%zu bytes)",
-              response->status_code, get_status_phrase(response->status_code),
+              response->status_code, libuv_get_status_phrase(response->status_code),
               response->body_length);
     
     // Send the response (buffer will be freed after send)
@@ -333,7 +335,7 @@ int libuv_send_response_ex(libuv_connection_t *conn, const http_response_t *resp
         int written = snprintf(buffer + offset, remaining,
                                "HTTP/1.1 %d %s\r\n",
                                response->status_code,
-                               get_status_phrase(response->status_code));
+                               libuv_get_status_phrase(response->status_code));
         if (written < 0 || (size_t)written >= remaining) {
             log_error("libuv_send_response_ex: Failed to write status line");
             safe_free(buffer);
@@ -407,7 +409,7 @@ int libuv_send_response_ex(libuv_connection_t *conn, const http_response_t *resp
     }
 
     log_debug("libuv_send_response_ex: Sending %d %s (%zu bytes, action=%d)",
-              response->status_code, get_status_phrase(response->status_code),
+              response->status_code, libuv_get_status_phrase(response->status_code),
               response->body_length, action);
 
     // Send the response with the specified post-write action
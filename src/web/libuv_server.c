@@ -19,15 +19,13 @@
 #include "web/libuv_connection.h"
 #include "web/thumbnail_thread.h"
 #include "web/go2rtc_proxy_thread.h"
+#include "web/hls_blocking_reload.h"
 #include "web/api_handlers_health.h"
 #include "core/config.h"
 #define LOG_COMPONENT "HTTP"
 #include "core/logger.h"
 #include "utils/strings.h"
 
-// Initial handler capacity
-#define INITIAL_HANDLER_CAPACITY 32
-
 // Forward declarations
 static void on_connection(uv_stream_t *server, int status);
 static void server_thread_func(void *arg);
@@ -139,8 +137,7 @@ static http_server_handle_t libuv_server_init_internal(const http_server_config_
     server->stop_async.data = server;
 
     // Initialize handler registry
-    server->handlers = safe_calloc(INITIAL_HANDLER_CAPACITY, sizeof(*server->handlers));
-    if (!server->handlers) {
+    if (route_trie_init(&server->routes) != 0) {
         log_error("libuv_server_init: Failed to allocate handler registry");
         uv_close((uv_handle_t *)&server->listener, NULL);
         if (server->owns_loop) {
@@ -150,8 +147,6 @@ static http_server_handle_t libuv_server_init_internal(const http_server_config_
         safe_free(server);
         return NULL;
     }
-    server->handler_capacity = INITIAL_HANDLER_CAPACITY;
-    server->handler_count = 0;
     
     // TLS initialization (if enabled)
     if (config->ssl_enabled) {
@@ -172,6 +167,12 @@ static http_server_handle_t libuv_server_init_internal(const http_server_config_
         // Continue anyway - proxy requests will return 503
     }
 
+    // Initialize LL-HLS blocking playlist reloads
+    if (hls_blocking_reload_init(server->loop) != 0) {
+        log_error("libuv_server_init: Failed to initialize HLS blocking reload");
+        // Continue anyway - blocking reloads will be answered immediately
+    }
+
     log_info("libuv_server_init: Server initialized on %s:%d", config->bind_ip, config->port);
 
     // Cast to generic handle type (http_server_t* is compatible pointer)
@@ -289,6 +290,12 @@ int libuv_server_start(http_server_handle_t handle) {
         }
         server->stop_async.data = server;
 
+        // The thumbnail pool was shut down with the server
+        if (thumbnail_thread_init(server->loop) != 0) {
+            log_error("libuv_server_start: Failed to restart thumbnail thread subsystem");
+            // Continue anyway - thumbnails will just fail
+        }
+
         log_info("libuv_server_start: Handles reinitialized successfully");
     }
 
@@ -467,6 +474,10 @@ void libuv_server_stop(http_server_handle_t handle) {
 
     // Now that the event loop thread has stopped, we can safely manipulate the loop
 
+    // Answer thumbnail requests still waiting on the worker pool while their
+    // connections are alive; the pool is restarted by libuv_server_start
+    thumbnail_thread_shutdown();
+
     // Close the listener to stop accepting new connections
     if (!uv_is_closing((uv_handle_t *)&server->listener)) {
         uv_close((uv_handle_t *)&server->listener, NULL);
@@ -540,10 +551,11 @@ void libuv_server_destroy(http_server_handle_t handle) {
     // Shutdown go2rtc proxy thread subsystem
     go2rtc_proxy_thread_shutdown();
 
+    // Drop parked LL-HLS reloads
+    hls_blocking_reload_shutdown();
+
     // Free handler registry
-    if (server->handlers) {
-        safe_free(server->handlers);
-    }
+    route_trie_free(&server->routes);
 
     // Free TLS context if allocated
     if (server->tls_ctx) {
@@ -570,29 +582,11 @@ int libuv_server_register_handler(http_server_handle_t handle, const char *path,
         return -1;
     }
 
-    // Expand handler array if needed
-    if (server->handler_count >= server->handler_capacity) {
-        int new_capacity = server->handler_capacity * 2;
-        void *new_handlers = safe_realloc(server->handlers,
-                                          new_capacity * sizeof(*server->handlers));
-        if (!new_handlers) {
-            log_error("libuv_server_register_handler: Failed to expand handler registry");
-            return -1;
-        }
-        server->handlers = new_handlers;
-        server->handler_capacity = new_capacity;
-    }
-
-    // Add new handler
-    int idx = server->handler_count;
-    safe_strcpy(server->handlers[idx].path, path, sizeof(server->handlers[idx].path), 0);
-    if (method) {
-        safe_strcpy(server->handlers[idx].method, method, sizeof(server->handlers[idx].method), 0);
-    } else {
-        server->handlers[idx].method[0] = '\0';  // Match any method
+    if (route_trie_insert(&server->routes, path, method, handler) != 0) {
+        log_error("libuv_server_register_handler: Invalid route %s %s",
+                  method && method[0] ? method : "*", path);
+        return -1;
     }
-    server->handlers[idx].handler = handler;
-    server->handler_count++;
 
     log_debug("libuv_server_register_handler: Registered %s %s",
               method ? method : "*", path);
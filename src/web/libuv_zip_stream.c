@@ -0,0 +1,389 @@
+/**
+ * @file libuv_zip_stream.c
+ * @brief Stream a ZIP archive of files straight to a libuv connection
+ *
+ * One stream per connection, driven entirely from the event loop except for
+ * the chunk reads: those run on the libuv thread pool, where the blocking
+ * open()/pread() and the CRC-32 update happen together.  There is only ever
+ * one read or one write in flight, and the read buffer doubles as the write
+ * buffer, so the next chunk is read only after the socket has taken the
+ * previous one.
+ */
+
+#ifdef HTTP_BACKEND_LIBUV
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <llhttp.h>
+#include <uv.h>
+
+#include "utils/memory.h"
+#include "utils/strings.h"
+#include "web/libuv_server.h"
+#include "web/libuv_connection.h"
+#include "web/libuv_zip_stream.h"
+#define LOG_COMPONENT "HTTP"
+#include "core/logger.h"
+
+// Bytes read (and written) per step; also holds the headers between entries
+#define ZIP_STREAM_CHUNK_SIZE ((size_t)256 * 1024)
+
+// read_error value for a file that ended before its recorded size
+#define ZIP_STREAM_SHORT_READ (-1)
+
+typedef enum {
+    ZIP_PHASE_HEADER,
+    ZIP_PHASE_DATA,
+    ZIP_PHASE_DESCRIPTOR,
+    ZIP_PHASE_TRAILER,
+    ZIP_PHASE_DONE
+} zip_phase_t;
+
+typedef struct zip_stream_ctx {
+    uv_work_t work;                     // Chunk read on the thread pool
+    uv_write_t write_req;               // The single write in flight
+    uv_buf_t write_buf;
+    bool free_write_buf;                // write_buf was allocated for this write
+
+    libuv_connection_t *conn;           // NULL once the connection is destroyed
+    zip_stream_t zs;
+    char extra_headers[512];
+    bool started;
+
+    zip_phase_t phase;
+    int index;                          // Entry being sent
+    int fd;                             // Open file of that entry, or -1
+    uint64_t entry_pos;                 // Bytes of that entry sent so far
+    uint8_t *buffer;
+    size_t chunk_len;                   // Bytes read by the last chunk
+    int read_error;                     // errno of the last chunk, or ZIP_STREAM_SHORT_READ
+} zip_stream_ctx_t;
+
+static void zip_stream_advance(zip_stream_ctx_t *ctx);
+
+// ============================================================================
+// Internal helpers
+// ============================================================================
+
+static void zip_stream_ctx_free(zip_stream_ctx_t *ctx) {
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+    }
+    zip_stream_free(&ctx->zs);
+    safe_free(ctx->buffer);
+    safe_free(ctx);
+}
+
+/**
+ * @brief Tear down the stream and hand the connection back
+ *
+ * @param complete Whole archive was sent; otherwise the response is short of
+ *                 its Content-Length and the connection must be closed
+ */
+static void zip_stream_finish(zip_stream_ctx_t *ctx, bool complete) {
+    libuv_connection_t *conn = ctx->conn;
+    zip_stream_ctx_free(ctx);
+    if (!conn) {
+        return;
+    }
+
+    conn->zip_stream = NULL;
+    conn->async_response_pending = false;
+
+    if (conn->server->shutting_down) {
+        log_debug("zip_stream_finish: Server shutting down, skipping connection management");
+        return;
+    }
+
+    if (!uv_is_closing((uv_handle_t *)&conn->handle)) {
+        if (complete && conn->keep_alive && llhttp_should_keep_alive(&conn->parser)) {
+            libuv_connection_reset(conn);
+        } else {
+            libuv_connection_close(conn);
+        }
+    }
+}
+
+static void on_zip_write_complete(uv_write_t *req, int status) {
+    zip_stream_ctx_t *ctx = (zip_stream_ctx_t *)req->data;
+
+    if (ctx->free_write_buf) {
+        safe_free(ctx->write_buf.base);
+        ctx->free_write_buf = false;
+    }
+
+    if (status < 0) {
+        log_error("on_zip_write_complete: Write error: %s", uv_strerror(status));
+        zip_stream_finish(ctx, false);
+        return;
+    }
+
+    zip_stream_advance(ctx);
+}
+
+static void zip_stream_write(zip_stream_ctx_t *ctx, void *data, size_t len, bool free_after) {
+    libuv_connection_t *conn = ctx->conn;
+
+    if (uv_is_closing((uv_handle_t *)&conn->handle)) {
+        log_debug("zip_stream_write: Connection is closing, aborting archive");
+        if (free_after) {
+            safe_free(data);
+        }
+        zip_stream_finish(ctx, false);
+        return;
+    }
+
+    ctx->write_buf = uv_buf_init((char *)data, (unsigned int)len);
+    ctx->free_write_buf = free_after;
+    ctx->write_req.data = ctx;
+
+    int r = uv_write(&ctx->write_req, (uv_stream_t *)&conn->handle,
+                     &ctx->write_buf, 1, on_zip_write_complete);
+    if (r != 0) {
+        log_error("zip_stream_write: Write failed: %s", uv_strerror(r));
+        if (free_after) {
+            safe_free(data);
+        }
+        ctx->free_write_buf = false;
+        zip_stream_finish(ctx, false);
+    }
+}
+
+/**
+ * @brief Read the next chunk of the current entry - runs on the thread pool
+ */
+static void zip_read_work_cb(uv_work_t *req) {
+    zip_stream_ctx_t *ctx = (zip_stream_ctx_t *)req->data;
+    zip_stream_entry_t *e = &ctx->zs.entries[ctx->index];
+
+    ctx->read_error = 0;
+    ctx->chunk_len = 0;
+
+    if (ctx->fd < 0) {
+        ctx->fd = open(e->path, O_RDONLY | O_CLOEXEC);
+        if (ctx->fd < 0) {
+            ctx->read_error = errno;
+            return;
+        }
+    }
+
+    uint64_t remaining = e->size - ctx->entry_pos;
+    size_t want = remaining < ZIP_STREAM_CHUNK_SIZE ? (size_t)remaining : ZIP_STREAM_CHUNK_SIZE;
+    size_t got = 0;
+    while (got < want) {
+        ssize_t n = pread(ctx->fd, ctx->buffer + got, want - got,
+                          (off_t)(ctx->entry_pos + got));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ctx->read_error = errno;
+            return;
+        }
+        if (n == 0) {
+            // The size was promised in Content-Length and the local header
+            ctx->read_error = ZIP_STREAM_SHORT_READ;
+            return;
+        }
+        got += (size_t)n;
+    }
+
+    e->crc = zip_stream_crc32(e->crc, ctx->buffer, got);
+    ctx->chunk_len = got;
+
+    if (ctx->entry_pos + got == e->size) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+}
+
+static void zip_read_after_work_cb(uv_work_t *req, int status) {
+    zip_stream_ctx_t *ctx = (zip_stream_ctx_t *)req->data;
+
+    if (!ctx->conn) {
+        // Connection went away while the chunk was being read
+        zip_stream_ctx_free(ctx);
+        return;
+    }
+
+    if (status == UV_ECANCELED) {
+        zip_stream_finish(ctx, false);
+        return;
+    }
+
+    if (ctx->read_error != 0) {
+        const zip_stream_entry_t *e = &ctx->zs.entries[ctx->index];
+        log_error("Batch download aborted: %s %s", e->path,
+                  ctx->read_error == ZIP_STREAM_SHORT_READ ? "is shorter than when the download started"
+                                                           : strerror(ctx->read_error));
+        zip_stream_finish(ctx, false);
+        return;
+    }
+
+    ctx->entry_pos += ctx->chunk_len;
+    zip_stream_write(ctx, ctx->buffer, ctx->chunk_len, false);
+}
+
+/**
+ * @brief Send whatever comes next in the archive
+ */
+static void zip_stream_advance(zip_stream_ctx_t *ctx) {
+    for (;;) {
+        zip_stream_entry_t *e = ctx->index < ctx->zs.count ? &ctx->zs.entries[ctx->index] : NULL;
+        size_t len;
+
+        switch (ctx->phase) {
+            case ZIP_PHASE_HEADER:
+                ctx->entry_pos = 0;
+                ctx->phase = ZIP_PHASE_DATA;
+                len = zip_stream_local_header(e, ctx->buffer);
+                zip_stream_write(ctx, ctx->buffer, len, false);
+                return;
+
+            case ZIP_PHASE_DATA:
+                if (ctx->entry_pos == e->size) {
+                    ctx->phase = ZIP_PHASE_DESCRIPTOR;
+                    continue;
+                }
+                ctx->work.data = ctx;
+                if (uv_queue_work(ctx->conn->server->loop, &ctx->work,
+                                  zip_read_work_cb, zip_read_after_work_cb) != 0) {
+                    log_error("zip_stream_advance: Failed to queue read");
+                    zip_stream_finish(ctx, false);
+                }
+                return;
+
+            case ZIP_PHASE_DESCRIPTOR:
+                // The next local header goes out in the same write
+                len = zip_stream_data_descriptor(e, ctx->buffer);
+                ctx->index++;
+                if (ctx->index < ctx->zs.count) {
+                    len += zip_stream_local_header(&ctx->zs.entries[ctx->index], ctx->buffer + len);
+                    ctx->entry_pos = 0;
+                    ctx->phase = ZIP_PHASE_DATA;
+                } else {
+                    ctx->phase = ZIP_PHASE_TRAILER;
+                }
+                zip_stream_write(ctx, ctx->buffer, len, false);
+                return;
+
+            case ZIP_PHASE_TRAILER: {
+                uint8_t *trailer = zip_stream_build_trailer(&ctx->zs, &len);
+                if (!trailer) {
+                    log_error("zip_stream_advance: Failed to allocate central directory");
+                    zip_stream_finish(ctx, false);
+                    return;
+                }
+                ctx->phase = ZIP_PHASE_DONE;
+                zip_stream_write(ctx, trailer, len, true);
+                return;
+            }
+
+            case ZIP_PHASE_DONE:
+                log_info("Batch download sent: %d entries, %llu bytes", ctx->zs.count,
+                         (unsigned long long)zip_stream_total_size(&ctx->zs));
+                zip_stream_finish(ctx, true);
+                return;
+        }
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+int libuv_zip_stream_defer(libuv_connection_t *conn, zip_stream_t *zs,
+                           const char *extra_headers) {
+    if (!conn || !zs || conn->zip_stream) {
+        return -1;
+    }
+
+    zip_stream_ctx_t *ctx = safe_calloc(1, sizeof(zip_stream_ctx_t));
+    if (!ctx) {
+        return -1;
+    }
+    ctx->buffer = safe_malloc(ZIP_STREAM_CHUNK_SIZE);
+    if (!ctx->buffer) {
+        safe_free(ctx);
+        return -1;
+    }
+
+    ctx->conn = conn;
+    ctx->zs = *zs;
+    ctx->fd = -1;
+    ctx->phase = ctx->zs.count > 0 ? ZIP_PHASE_HEADER : ZIP_PHASE_TRAILER;
+    if (extra_headers) {
+        safe_strcpy(ctx->extra_headers, extra_headers, sizeof(ctx->extra_headers), 0);
+    }
+
+    memset(zs, 0, sizeof(*zs));
+    conn->zip_stream = ctx;
+    return 0;
+}
+
+void libuv_zip_stream_start(libuv_connection_t *conn) {
+    zip_stream_ctx_t *ctx = conn->zip_stream;
+    if (!ctx || ctx->started) {
+        return;
+    }
+    ctx->started = true;
+    conn->async_response_pending = true;
+
+    // Stored entries have known sizes, so the length is exact before any
+    // file has been read
+    char headers[1024];
+    int len = snprintf(headers, sizeof(headers),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/zip\r\n"
+        "Content-Length: %llu\r\n"
+        "%s"
+        "\r\n",
+        (unsigned long long)zip_stream_total_size(&ctx->zs), ctx->extra_headers);
+    if (len < 0 || (size_t)len >= sizeof(headers)) {
+        log_error("libuv_zip_stream_start: Response headers too long");
+        http_response_set_json_error(&conn->response, 500, "Failed to start download");
+        conn->zip_stream = NULL;
+        conn->async_response_pending = false;
+        zip_stream_ctx_free(ctx);
+        libuv_send_response_ex(conn, &conn->response, conn->deferred_action);
+        return;
+    }
+
+    char *header_buf = safe_malloc((size_t)len);
+    if (!header_buf) {
+        zip_stream_finish(ctx, false);
+        return;
+    }
+    memcpy(header_buf, headers, (size_t)len);
+
+    if (libuv_connection_send(conn, header_buf, (size_t)len, true) != 0) {
+        // libuv_connection_send already closed the connection
+        conn->zip_stream = NULL;
+        conn->async_response_pending = false;
+        zip_stream_ctx_free(ctx);
+        return;
+    }
+
+    zip_stream_advance(ctx);
+}
+
+void libuv_zip_stream_detach(libuv_connection_t *conn) {
+    zip_stream_ctx_t *ctx = conn->zip_stream;
+    conn->zip_stream = NULL;
+    if (!ctx) {
+        return;
+    }
+
+    if (ctx->started) {
+        // A chunk read is in flight; its after-work callback frees the stream
+        ctx->conn = NULL;
+    } else {
+        zip_stream_ctx_free(ctx);
+    }
+}
+
+#endif /* HTTP_BACKEND_LIBUV */
@@ -162,6 +162,21 @@ int http_request_extract_path_param(const http_request_t *req, const char *prefi
     return 0;
 }
 
+int http_request_get_path_param(const http_request_t *req, int index,
+                                char *param_buf, size_t buf_size) {
+    if (!req || !param_buf || buf_size == 0) return -1;
+    if (index < 0 || index >= req->num_path_params) return -1;
+
+    size_t offset = req->path_params[index].offset;
+    size_t param_len = req->path_params[index].length;
+    if (param_len == 0 || param_len >= buf_size) return -1;
+    if (offset + param_len > strnlen(req->path, sizeof(req->path))) return -1;
+
+    // See http_request_extract_path_param for the +1
+    url_decode(req->path + offset, param_buf, param_len + 1);
+    return 0;
+}
+
 int http_response_add_header(http_response_t *res, const char *name, const char *value) {
     if (!res || !name || !value) return -1;
     if (res->num_headers >= MAX_HEADERS) return -1;
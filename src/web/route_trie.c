@@ -0,0 +1,342 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "web/route_trie.h"
+
+// Handler slots per node: one per http_method_t, with HTTP_METHOD_UNKNOWN
+// standing for routes registered without a method
+#define ROUTE_METHOD_ANY HTTP_METHOD_UNKNOWN
+#define ROUTE_METHOD_SLOTS (HTTP_METHOD_UNKNOWN + 1)
+
+typedef struct {
+    request_handler_t handler;
+    int order;                          // Registration order, lower wins
+} route_entry_t;
+
+struct route_node {
+    char *label;                        // Literal segment (NULL for root and '#')
+    route_node_t **children;            // Literal children sorted by label
+    int child_count;
+    int child_capacity;
+    route_node_t *param;                // '#' child
+    route_entry_t exact[ROUTE_METHOD_SLOTS];  // Routes ending at this node
+    route_entry_t glob[ROUTE_METHOD_SLOTS];   // Routes ending in '*' below this node
+    int min_order;                      // Lowest order of any route in this subtree
+};
+
+static const char *method_names[] = {
+    [HTTP_METHOD_GET] = "GET",
+    [HTTP_METHOD_POST] = "POST",
+    [HTTP_METHOD_PUT] = "PUT",
+    [HTTP_METHOD_DELETE] = "DELETE",
+    [HTTP_METHOD_OPTIONS] = "OPTIONS",
+    [HTTP_METHOD_HEAD] = "HEAD",
+    [HTTP_METHOD_PATCH] = "PATCH",
+};
+
+static int method_slot(const char *method) {
+    if (!method || method[0] == '\0') {
+        return ROUTE_METHOD_ANY;
+    }
+    for (int i = 0; i < HTTP_METHOD_UNKNOWN; i++) {
+        if (strcmp(method, method_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static route_node_t *node_new(const char *label, size_t len) {
+    route_node_t *node = calloc(1, sizeof(*node));
+    if (!node) {
+        return NULL;
+    }
+    if (label) {
+        node->label = strndup(label, len);
+        if (!node->label) {
+            free(node);
+            return NULL;
+        }
+    }
+    node->min_order = INT_MAX;
+    return node;
+}
+
+static void node_free(route_node_t *node) {
+    if (!node) {
+        return;
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        node_free(node->children[i]);
+    }
+    node_free(node->param);
+    free(node->children);
+    free(node->label);
+    free(node);
+}
+
+static int segment_cmp(const char *label, const char *seg, size_t len) {
+    int c = strncmp(label, seg, len);
+    if (c != 0) {
+        return c;
+    }
+    return label[len] == '\0' ? 0 : 1;
+}
+
+// Binary search; returns the index of the match or -(insertion point) - 1
+static int find_child(const route_node_t *node, const char *seg, size_t len) {
+    int lo = 0;
+    int hi = node->child_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = segment_cmp(node->children[mid]->label, seg, len);
+        if (c == 0) {
+            return mid;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -lo - 1;
+}
+
+static route_node_t *get_or_add_child(route_node_t *node, const char *seg, size_t len) {
+    int idx = find_child(node, seg, len);
+    if (idx >= 0) {
+        return node->children[idx];
+    }
+    idx = -idx - 1;
+
+    if (node->child_count >= node->child_capacity) {
+        int new_capacity = node->child_capacity ? node->child_capacity * 2 : 4;
+        route_node_t **children = realloc(node->children, new_capacity * sizeof(*children));
+        if (!children) {
+            return NULL;
+        }
+        node->children = children;
+        node->child_capacity = new_capacity;
+    }
+
+    route_node_t *child = node_new(seg, len);
+    if (!child) {
+        return NULL;
+    }
+    memmove(&node->children[idx + 1], &node->children[idx],
+            (node->child_count - idx) * sizeof(*node->children));
+    node->children[idx] = child;
+    node->child_count++;
+    return child;
+}
+
+// Wildcards must be whole segments, '*' only last, and the depth and number
+// of '#' segments must fit the fixed-size match buffers
+static bool pattern_valid(const char *pattern) {
+    if (!pattern || pattern[0] != '/') {
+        return false;
+    }
+
+    int segments = 0;
+    int params = 0;
+    const char *seg = pattern + 1;
+    for (;;) {
+        const char *end = strchr(seg, '/');
+        size_t len = end ? (size_t)(end - seg) : strlen(seg);
+        bool wildcard = memchr(seg, '#', len) || memchr(seg, '*', len);
+
+        if (len == 1 && seg[0] == '*') {
+            return end == NULL;
+        }
+        if (len == 1 && seg[0] == '#') {
+            if (++params > MAX_PATH_PARAMS) {
+                return false;
+            }
+        } else if (wildcard) {
+            return false;
+        }
+        if (++segments > ROUTE_MAX_SEGMENTS) {
+            return false;
+        }
+        if (!end) {
+            return true;
+        }
+        seg = end + 1;
+    }
+}
+
+int route_trie_init(route_trie_t *trie) {
+    if (!trie) {
+        return -1;
+    }
+    memset(trie, 0, sizeof(*trie));
+    trie->root = node_new(NULL, 0);
+    return trie->root ? 0 : -1;
+}
+
+void route_trie_free(route_trie_t *trie) {
+    if (!trie) {
+        return;
+    }
+    node_free(trie->root);
+    memset(trie, 0, sizeof(*trie));
+}
+
+int route_trie_insert(route_trie_t *trie, const char *pattern, const char *method,
+                      request_handler_t handler) {
+    if (!trie || !trie->root || !handler || !pattern_valid(pattern)) {
+        return -1;
+    }
+    int slot = method_slot(method);
+    if (slot < 0) {
+        return -1;
+    }
+
+    int order = trie->route_count;
+    route_node_t *node = trie->root;
+    route_entry_t *entry = NULL;
+    const char *seg = pattern + 1;
+
+    for (;;) {
+        if (order < node->min_order) {
+            node->min_order = order;
+        }
+
+        const char *end = strchr(seg, '/');
+        size_t len = end ? (size_t)(end - seg) : strlen(seg);
+
+        if (len == 1 && seg[0] == '*') {
+            entry = &node->glob[slot];
+            break;
+        }
+
+        if (len == 1 && seg[0] == '#') {
+            if (!node->param) {
+                node->param = node_new(NULL, 0);
+            }
+            node = node->param;
+        } else {
+            node = get_or_add_child(node, seg, len);
+        }
+        if (!node) {
+            return -1;
+        }
+
+        if (!end) {
+            if (order < node->min_order) {
+                node->min_order = order;
+            }
+            entry = &node->exact[slot];
+            break;
+        }
+        seg = end + 1;
+    }
+
+    trie->route_count++;
+    if (!entry->handler) {
+        entry->handler = handler;
+        entry->order = order;
+    }
+    return 0;
+}
+
+typedef struct {
+    const char *path;
+    int seg_count;
+    uint16_t seg_offset[ROUTE_MAX_SEGMENTS + 1];
+    uint16_t seg_length[ROUTE_MAX_SEGMENTS + 1];
+    int slot;
+    int num_params;
+    int param_segments[MAX_PATH_PARAMS];
+    int best_order;
+    route_match_t *match;
+} match_ctx_t;
+
+static void consider(match_ctx_t *ctx, const route_entry_t *table) {
+    const route_entry_t *candidates[2] = { NULL, &table[ROUTE_METHOD_ANY] };
+    if (ctx->slot >= 0) {
+        candidates[0] = &table[ctx->slot];
+    }
+
+    for (int i = 0; i < 2; i++) {
+        const route_entry_t *e = candidates[i];
+        if (!e || !e->handler || e->order >= ctx->best_order) {
+            continue;
+        }
+        ctx->best_order = e->order;
+        ctx->match->handler = e->handler;
+        ctx->match->num_params = ctx->num_params;
+        for (int p = 0; p < ctx->num_params; p++) {
+            int s = ctx->param_segments[p];
+            ctx->match->params[p].offset = ctx->seg_offset[s];
+            ctx->match->params[p].length = ctx->seg_length[s];
+        }
+    }
+}
+
+static void search(match_ctx_t *ctx, const route_node_t *node, int i) {
+    // Nothing below can beat what has already been found
+    if (node->min_order >= ctx->best_order) {
+        return;
+    }
+
+    if (i == ctx->seg_count) {
+        consider(ctx, node->exact);
+        return;
+    }
+
+    consider(ctx, node->glob);
+
+    const char *seg = ctx->path + ctx->seg_offset[i];
+    int idx = find_child(node, seg, ctx->seg_length[i]);
+    if (idx >= 0) {
+        search(ctx, node->children[idx], i + 1);
+    }
+
+    if (node->param && ctx->num_params < MAX_PATH_PARAMS &&
+        !memchr(seg, '/', ctx->seg_length[i])) {
+        ctx->param_segments[ctx->num_params++] = i;
+        search(ctx, node->param, i + 1);
+        ctx->num_params--;
+    }
+}
+
+bool route_trie_match(const route_trie_t *trie, http_method_t method, const char *path,
+                      route_match_t *match) {
+    if (!trie || !trie->root || !path || path[0] != '/' || !match ||
+        strlen(path) > UINT16_MAX) {
+        return false;
+    }
+
+    match_ctx_t ctx;
+    ctx.path = path;
+    ctx.seg_count = 0;
+    ctx.slot = ((int)method >= 0 && method < HTTP_METHOD_UNKNOWN) ? (int)method : -1;
+    ctx.num_params = 0;
+    ctx.best_order = INT_MAX;
+    ctx.match = match;
+    match->handler = NULL;
+    match->num_params = 0;
+
+    // Split into segments; anything past the deepest possible pattern is
+    // kept as one span that only a '*' route can consume
+    const char *seg = path + 1;
+    for (;;) {
+        const char *end = ctx.seg_count < ROUTE_MAX_SEGMENTS ? strchr(seg, '/') : NULL;
+        size_t len = end ? (size_t)(end - seg) : strlen(seg);
+        ctx.seg_offset[ctx.seg_count] = (uint16_t)(seg - path);
+        ctx.seg_length[ctx.seg_count] = (uint16_t)len;
+        ctx.seg_count++;
+        if (!end) {
+            break;
+        }
+        seg = end + 1;
+    }
+
+    search(&ctx, trie->root, 0);
+    return match->handler != NULL;
+}
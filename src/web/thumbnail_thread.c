@@ -1,6 +1,6 @@
 /**
  * @file thumbnail_thread.c
- * @brief Detached pthread-based thumbnail generation with async completion
+ * @brief Worker-pool thumbnail generation with async completion
  */
 
 #define _XOPEN_SOURCE
@@ -11,21 +11,23 @@
 #include <string.h>
 #include <pthread.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <unistd.h>
 #include <fcntl.h>
-#include <time.h>
 #include <errno.h>
 
 #include "web/thumbnail_thread.h"
+#include "video/thumbnail_engine.h"
 #include "core/config.h"
 #define LOG_COMPONENT "Thumbnail"
 #include "core/logger.h"
 #include "utils/memory.h"
 #include "utils/strings.h"
 
-// Maximum concurrent thumbnail generations
-#define MAX_CONCURRENT_THUMBNAILS 4
+// Number of persistent worker threads (= maximum concurrent generations)
+#define THUMBNAIL_WORKER_COUNT 4
+
+// Requests waiting for a worker beyond this are rejected with 503
+#define THUMBNAIL_MAX_PENDING 64
 
 /**
  * @brief Work item for thumbnail generation
@@ -51,92 +53,86 @@ static struct {
     pthread_mutex_t done_mutex;
     thumbnail_work_t *done_queue_head;
     thumbnail_work_t *done_queue_tail;
+
+    // Pending queue consumed by the worker pool
+    pthread_mutex_t pending_mutex;
+    pthread_cond_t pending_cond;
+    thumbnail_work_t *pending_head;
+    thumbnail_work_t *pending_tail;
+    int pending_count;
+
+    pthread_t workers[THUMBNAIL_WORKER_COUNT];
+    int worker_count;
     volatile int active_count;
     volatile bool shutting_down;
+    bool initialized;
 } g_thumbnail_state = {0};
 
 /**
- * @brief Generate a thumbnail using ffmpeg
+ * @brief Write JPEG data to the disk cache atomically
+ *
+ * The data goes to a temporary file that is renamed into place, so a
+ * concurrent request never serves a partially written thumbnail.
  */
-static int generate_thumbnail_internal(const char *input_path, const char *output_path,
-                                       double seek_seconds) {
-    // Clamp seek time to 0 minimum
-    if (seek_seconds < 0) seek_seconds = 0;
-
-    char seek_str[32];
-    snprintf(seek_str, sizeof(seek_str), "%.2f", seek_seconds);
-
-    log_debug("Generating thumbnail: ffmpeg -ss %s -i \"%s\" -> \"%s\"",
-              seek_str, input_path, output_path);
-
-    // Use fork/execvp instead of system() to avoid spawning a shell
-    pid_t pid = fork();
-    if (pid < 0) {
-        log_warn("fork() failed for thumbnail generation: %s", strerror(errno));
+static int write_thumbnail_file(const char *output_path, const unsigned char *data, size_t size) {
+    char tmp_path[MAX_PATH_LENGTH];
+    int n = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%lu", output_path,
+                     (unsigned long)pthread_self());
+    if (n < 0 || (size_t)n >= sizeof(tmp_path)) {
         return -1;
     }
 
-    if (pid == 0) {
-        // Child process: redirect stderr to /dev/null, then exec ffmpeg
-        int devnull = open("/dev/null", O_WRONLY);
-        if (devnull >= 0) {
-            dup2(devnull, STDERR_FILENO);
-            close(devnull);
-        }
-        const char *args[] = {
-            "ffmpeg", "-ss", seek_str,
-            "-i", input_path,
-            "-frames:v", "1",
-            "-vf", "scale=320:-1",
-            "-q:v", "8",
-            "-y", output_path,
-            NULL
-        };
-        execvp("ffmpeg", (char *const *)args);
-        // execvp only returns on failure
-        _exit(127);
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if (fd < 0) {
+        log_warn("Failed to create thumbnail file %s: %s", tmp_path, strerror(errno));
+        return -1;
     }
 
-    // Parent: wait up to 5 seconds for child to complete
-    int ret = -1;
-    time_t deadline = time(NULL) + 5;
-    while (time(NULL) < deadline) {
-        int status = 0;
-        pid_t result = waitpid(pid, &status, WNOHANG);
-        if (result == pid) {
-            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-                ret = 0;
-            }
-            pid = -1;
-            break;
-        }
-        if (result < 0) {
-            pid = -1;
-            break;
+    size_t written = 0;
+    while (written < size) {
+        ssize_t w = write(fd, data + written, size - written);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            log_warn("Failed to write thumbnail file %s: %s", tmp_path, strerror(errno));
+            close(fd);
+            unlink(tmp_path);
+            return -1;
         }
-        usleep(50000); // 50 ms polling interval
-    }
-    if (pid > 0) {
-        // Timeout — kill the child
-        kill(pid, SIGKILL);
-        waitpid(pid, NULL, 0);
+        written += (size_t)w;
     }
+    close(fd);
 
-    if (ret != 0) {
-        log_warn("ffmpeg thumbnail generation failed for: %s", input_path);
+    if (rename(tmp_path, output_path) != 0) {
+        log_warn("Failed to move thumbnail into place %s: %s", output_path, strerror(errno));
+        unlink(tmp_path);
         return -1;
     }
+    return 0;
+}
+
+/**
+ * @brief Render a thumbnail in-process and store it in both caches
+ */
+static int generate_thumbnail_internal(const char *input_path, const char *output_path,
+                                       double seek_seconds) {
+    unsigned char *jpeg = NULL;
+    size_t jpeg_size = 0;
 
-    // Verify the file was created
-    struct stat st;
-    if (stat(output_path, &st) != 0 || st.st_size == 0) {
-        log_warn("Thumbnail file not created or empty: %s", output_path);
-        unlink(output_path); // Clean up empty file
+    if (thumbnail_engine_render(input_path, seek_seconds, THUMBNAIL_DEFAULT_WIDTH,
+                                THUMBNAIL_DEFAULT_QUALITY, &jpeg, &jpeg_size) != 0) {
+        log_warn("Thumbnail generation failed for: %s", input_path);
         return -1;
     }
 
-    log_debug("Generated thumbnail: %s (%lld bytes)", output_path,
-              (long long)st.st_size);
+    // The memory copy is what the completion callback serves
+    thumbnail_cache_put(output_path, jpeg, jpeg_size);
+
+    // A failed disk write only costs a re-render once the memory entry is evicted
+    if (write_thumbnail_file(output_path, jpeg, jpeg_size) == 0) {
+        log_debug("Generated thumbnail: %s (%zu bytes)", output_path, jpeg_size);
+    }
+
+    free(jpeg);
     return 0;
 }
 
@@ -168,37 +164,71 @@ static thumbnail_work_t *dequeue_all_done(void) {
 }
 
 /**
- * @brief Detached pthread worker function
+ * @brief Take the next pending work item, blocking until one arrives
+ *
+ * @return Work item, or NULL once the subsystem is shutting down
+ */
+static thumbnail_work_t *dequeue_pending(void) {
+    pthread_mutex_lock(&g_thumbnail_state.pending_mutex);
+    while (!g_thumbnail_state.pending_head && !g_thumbnail_state.shutting_down) {
+        pthread_cond_wait(&g_thumbnail_state.pending_cond, &g_thumbnail_state.pending_mutex);
+    }
+
+    thumbnail_work_t *work = NULL;
+    if (!g_thumbnail_state.shutting_down) {
+        work = g_thumbnail_state.pending_head;
+        g_thumbnail_state.pending_head = work->next;
+        if (!g_thumbnail_state.pending_head) {
+            g_thumbnail_state.pending_tail = NULL;
+        }
+        g_thumbnail_state.pending_count--;
+        work->next = NULL;
+    }
+    pthread_mutex_unlock(&g_thumbnail_state.pending_mutex);
+    return work;
+}
+
+/**
+ * @brief Pool worker: renders queued thumbnails until shutdown
  */
 static void *thumbnail_worker_thread(void *arg) {
+    (void)arg;
     log_set_thread_context("Thumbnail", NULL);
-    thumbnail_work_t *work = (thumbnail_work_t *)arg;
 
-    // Generate the thumbnail
-    work->result = generate_thumbnail_internal(work->input_path, work->output_path,
-                                               work->seek_seconds);
+    thumbnail_work_t *work;
+    while ((work = dequeue_pending()) != NULL) {
+        __sync_add_and_fetch(&g_thumbnail_state.active_count, 1);
+
+        // Another request may have produced this thumbnail while we were queued
+        unsigned char *cached = NULL;
+        size_t cached_size = 0;
+        if (thumbnail_cache_get(work->output_path, &cached, &cached_size) == 0) {
+            free(cached);
+            work->result = 0;
+        } else {
+            work->result = generate_thumbnail_internal(work->input_path, work->output_path,
+                                                       work->seek_seconds);
+        }
 
-    // Add to done queue
-    enqueue_done(work);
+        // Add to done queue
+        enqueue_done(work);
 
-    // Signal the event loop via uv_async
-    uv_async_send(&g_thumbnail_state.async_handle);
+        // Signal the event loop via uv_async
+        uv_async_send(&g_thumbnail_state.async_handle);
 
-    // Decrement active count
-    __sync_sub_and_fetch(&g_thumbnail_state.active_count, 1);
+        __sync_sub_and_fetch(&g_thumbnail_state.active_count, 1);
+    }
 
+    thumbnail_engine_thread_cleanup();
     return NULL;
 }
 
 /**
- * @brief uv_async callback - runs on the event loop thread
+ * @brief Send the response for each work item in a list and free the items
  *
- * Processes all completed thumbnail generations and sends responses.
+ * Must run on the event loop thread.
  */
-static void thumbnail_async_cb(uv_async_t *handle) {
-    (void)handle;
-
-    thumbnail_work_t *work = dequeue_all_done();
+static void complete_work_list(thumbnail_work_t *work) {
     while (work) {
         thumbnail_work_t *next = work->next;
 
@@ -217,6 +247,16 @@ static void thumbnail_async_cb(uv_async_t *handle) {
     }
 }
 
+/**
+ * @brief uv_async callback - runs on the event loop thread
+ *
+ * Processes all completed thumbnail generations and sends responses.
+ */
+static void thumbnail_async_cb(uv_async_t *handle) {
+    (void)handle;
+    complete_work_list(dequeue_all_done());
+}
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -227,57 +267,100 @@ int thumbnail_thread_init(uv_loop_t *loop) {
         return -1;
     }
 
+    if (g_thumbnail_state.initialized) {
+        return 0;
+    }
+
     memset(&g_thumbnail_state, 0, sizeof(g_thumbnail_state));
     g_thumbnail_state.loop = loop;
 
-    // Initialize mutex
+    // Initialize mutexes and the pending queue condition
     if (pthread_mutex_init(&g_thumbnail_state.done_mutex, NULL) != 0) {
         log_error("thumbnail_thread_init: Failed to initialize mutex");
         return -1;
     }
+    if (pthread_mutex_init(&g_thumbnail_state.pending_mutex, NULL) != 0 ||
+        pthread_cond_init(&g_thumbnail_state.pending_cond, NULL) != 0) {
+        log_error("thumbnail_thread_init: Failed to initialize pending queue");
+        pthread_mutex_destroy(&g_thumbnail_state.done_mutex);
+        return -1;
+    }
 
     // Initialize uv_async handle
     if (uv_async_init(loop, &g_thumbnail_state.async_handle, thumbnail_async_cb) != 0) {
         log_error("thumbnail_thread_init: Failed to initialize uv_async");
+        pthread_cond_destroy(&g_thumbnail_state.pending_cond);
+        pthread_mutex_destroy(&g_thumbnail_state.pending_mutex);
         pthread_mutex_destroy(&g_thumbnail_state.done_mutex);
         return -1;
     }
 
-    log_info("thumbnail_thread_init: Thumbnail thread subsystem initialized");
+    // Start the worker pool
+    for (int i = 0; i < THUMBNAIL_WORKER_COUNT; i++) {
+        if (pthread_create(&g_thumbnail_state.workers[i], NULL, thumbnail_worker_thread, NULL) != 0) {
+            log_error("thumbnail_thread_init: Failed to create worker thread %d", i);
+            break;
+        }
+        g_thumbnail_state.worker_count++;
+    }
+    if (g_thumbnail_state.worker_count == 0) {
+        uv_close((uv_handle_t *)&g_thumbnail_state.async_handle, NULL);
+        pthread_cond_destroy(&g_thumbnail_state.pending_cond);
+        pthread_mutex_destroy(&g_thumbnail_state.pending_mutex);
+        pthread_mutex_destroy(&g_thumbnail_state.done_mutex);
+        return -1;
+    }
+
+    thumbnail_cache_set_limit(THUMBNAIL_CACHE_DEFAULT_BYTES);
+    g_thumbnail_state.initialized = true;
+
+    log_info("thumbnail_thread_init: Thumbnail thread subsystem initialized (%d workers)",
+             g_thumbnail_state.worker_count);
     return 0;
 }
 
 void thumbnail_thread_shutdown(void) {
+    if (!g_thumbnail_state.initialized) {
+        return;
+    }
     log_info("thumbnail_thread_shutdown: Shutting down thumbnail thread subsystem");
-    g_thumbnail_state.shutting_down = true;
 
-    // Wait for all active threads to complete
-    int wait_count = 0;
-    while (__sync_fetch_and_add(&g_thumbnail_state.active_count, 0) > 0 && wait_count < 100) {
-        usleep(100000); // 100ms
-        wait_count++;
-    }
+    // Wake idle workers; busy ones exit after finishing their current render
+    pthread_mutex_lock(&g_thumbnail_state.pending_mutex);
+    g_thumbnail_state.shutting_down = true;
+    pthread_cond_broadcast(&g_thumbnail_state.pending_cond);
+    pthread_mutex_unlock(&g_thumbnail_state.pending_mutex);
 
-    if (g_thumbnail_state.active_count > 0) {
-        log_warn("thumbnail_thread_shutdown: %d threads still active after timeout",
-                 g_thumbnail_state.active_count);
+    for (int i = 0; i < g_thumbnail_state.worker_count; i++) {
+        pthread_join(g_thumbnail_state.workers[i], NULL);
     }
+    g_thumbnail_state.worker_count = 0;
 
     // Close uv_async handle
     if (!uv_is_closing((uv_handle_t *)&g_thumbnail_state.async_handle)) {
         uv_close((uv_handle_t *)&g_thumbnail_state.async_handle, NULL);
     }
 
-    // Destroy mutex
-    pthread_mutex_destroy(&g_thumbnail_state.done_mutex);
+    // Answer results the async callback never delivered, then fail the
+    // requests that never reached a worker, so no connection is left waiting
+    complete_work_list(dequeue_all_done());
 
-    // Free any remaining work items in the done queue
-    thumbnail_work_t *work = g_thumbnail_state.done_queue_head;
-    while (work) {
-        thumbnail_work_t *next = work->next;
-        safe_free(work);
-        work = next;
+    thumbnail_work_t *work = g_thumbnail_state.pending_head;
+    g_thumbnail_state.pending_head = NULL;
+    g_thumbnail_state.pending_tail = NULL;
+    g_thumbnail_state.pending_count = 0;
+    for (thumbnail_work_t *w = work; w; w = w->next) {
+        w->result = -1;
     }
+    complete_work_list(work);
+
+    // Destroy synchronization primitives
+    pthread_cond_destroy(&g_thumbnail_state.pending_cond);
+    pthread_mutex_destroy(&g_thumbnail_state.pending_mutex);
+    pthread_mutex_destroy(&g_thumbnail_state.done_mutex);
+
+    thumbnail_cache_clear();
+    g_thumbnail_state.initialized = false;
 
     log_info("thumbnail_thread_shutdown: Shutdown complete");
 }
@@ -291,12 +374,6 @@ int thumbnail_thread_submit(uint64_t recording_id, int index,
         return -1;
     }
 
-    // Enforce concurrency limit
-    if (__sync_fetch_and_add(&g_thumbnail_state.active_count, 0) >= MAX_CONCURRENT_THUMBNAILS) {
-        log_debug("thumbnail_thread_submit: Max concurrent thumbnails reached");
-        return -1;
-    }
-
     // Allocate work item
     thumbnail_work_t *work = safe_calloc(1, sizeof(thumbnail_work_t));
     if (!work) {
@@ -312,25 +389,25 @@ int thumbnail_thread_submit(uint64_t recording_id, int index,
     work->deferred_action = deferred_action;
     work->callback = callback;
 
-    // Increment active count
-    __sync_add_and_fetch(&g_thumbnail_state.active_count, 1);
-
-    // Spawn detached thread
-    pthread_t thread;
-    pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-
-    if (pthread_create(&thread, &attr, thumbnail_worker_thread, work) != 0) {
-        log_error("thumbnail_thread_submit: Failed to create thread");
-        pthread_attr_destroy(&attr);
-        __sync_sub_and_fetch(&g_thumbnail_state.active_count, 1);
+    pthread_mutex_lock(&g_thumbnail_state.pending_mutex);
+    if (g_thumbnail_state.shutting_down ||
+        g_thumbnail_state.pending_count >= THUMBNAIL_MAX_PENDING) {
+        pthread_mutex_unlock(&g_thumbnail_state.pending_mutex);
+        log_debug("thumbnail_thread_submit: Pending queue full");
         safe_free(work);
         return -1;
     }
+    if (g_thumbnail_state.pending_tail) {
+        g_thumbnail_state.pending_tail->next = work;
+    } else {
+        g_thumbnail_state.pending_head = work;
+    }
+    g_thumbnail_state.pending_tail = work;
+    g_thumbnail_state.pending_count++;
+    pthread_cond_signal(&g_thumbnail_state.pending_cond);
+    pthread_mutex_unlock(&g_thumbnail_state.pending_mutex);
 
-    pthread_attr_destroy(&attr);
-    log_debug("thumbnail_thread_submit: Submitted thumbnail generation for recording %llu index %d",
+    log_debug("thumbnail_thread_submit: Queued thumbnail generation for recording %llu index %d",
               (unsigned long long)recording_id, index);
     return 0;
 }
@@ -338,4 +415,3 @@ int thumbnail_thread_submit(uint64_t recording_id, int index,
 int thumbnail_thread_get_active_count(void) {
     return __sync_fetch_and_add(&g_thumbnail_state.active_count, 0);
 }
-
@@ -0,0 +1,327 @@
+/**
+ * Streaming ZIP archive layout
+ *
+ * Header builders and size bookkeeping for single-pass ZIP archives.  The
+ * libuv side (libuv_zip_stream.c) moves the bytes; everything that decides
+ * what those bytes are lives here.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "web/zip_stream.h"
+
+#define ZIP_SIG_LOCAL           0x04034b50u
+#define ZIP_SIG_DESCRIPTOR      0x08074b50u
+#define ZIP_SIG_CENTRAL         0x02014b50u
+#define ZIP_SIG_ZIP64_END       0x06064b50u
+#define ZIP_SIG_ZIP64_LOCATOR   0x07064b50u
+#define ZIP_SIG_END             0x06054b50u
+
+#define ZIP_VERSION_DEFAULT     20
+#define ZIP_VERSION_ZIP64       45
+#define ZIP_FLAG_DESCRIPTOR     0x0008
+#define ZIP_EXTRA_ZIP64         0x0001
+
+// Field value that defers to the ZIP64 extra field / end record
+#define ZIP_MAX32               0xFFFFFFFFu
+#define ZIP_MAX16               0xFFFF
+
+/* ─── CRC-32 (slicing-by-8) ──────────────────────────────────────────── */
+
+static uint32_t s_crc_table[8][256];
+static pthread_once_t s_crc_once = PTHREAD_ONCE_INIT;
+
+static void init_crc32(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; j++)
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        s_crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = s_crc_table[0][i];
+        for (int t = 1; t < 8; t++) {
+            c = s_crc_table[0][c & 0xFF] ^ (c >> 8);
+            s_crc_table[t][i] = c;
+        }
+    }
+}
+
+uint32_t zip_stream_crc32(uint32_t crc, const void *data, size_t len) {
+    pthread_once(&s_crc_once, init_crc32);
+
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+
+    // Eight bytes per step; assembled bytewise so alignment and host
+    // byte order do not matter
+    while (len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                             ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+        uint32_t hi = (uint32_t)p[4] | ((uint32_t)p[5] << 8) |
+                      ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+        crc = s_crc_table[7][lo & 0xFF] ^ s_crc_table[6][(lo >> 8) & 0xFF] ^
+              s_crc_table[5][(lo >> 16) & 0xFF] ^ s_crc_table[4][lo >> 24] ^
+              s_crc_table[3][hi & 0xFF] ^ s_crc_table[2][(hi >> 8) & 0xFF] ^
+              s_crc_table[1][(hi >> 16) & 0xFF] ^ s_crc_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ s_crc_table[0][(crc ^ *p++) & 0xFF];
+    }
+    return ~crc;
+}
+
+/* ─── Little-endian writers ──────────────────────────────────────────── */
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)((v >> (8 * i)) & 0xFF);
+    return p + 4;
+}
+
+static uint8_t *put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)((v >> (8 * i)) & 0xFF);
+    return p + 8;
+}
+
+/* ─── Sizes ──────────────────────────────────────────────────────────── */
+
+static bool size_needs_zip64(const zip_stream_entry_t *e) {
+    return e->size >= ZIP_MAX32;
+}
+
+static bool offset_needs_zip64(const zip_stream_entry_t *e) {
+    return e->offset >= ZIP_MAX32;
+}
+
+static size_t local_header_size(const zip_stream_entry_t *e) {
+    return 30 + strlen(e->name) + (size_needs_zip64(e) ? 20 : 0);
+}
+
+static size_t data_descriptor_size(const zip_stream_entry_t *e) {
+    return size_needs_zip64(e) ? 24 : 16;
+}
+
+static size_t central_extra_size(const zip_stream_entry_t *e) {
+    size_t fields = (size_needs_zip64(e) ? 2 : 0) + (offset_needs_zip64(e) ? 1 : 0);
+    return fields ? 4 + fields * 8 : 0;
+}
+
+static size_t central_directory_size(const zip_stream_t *zs) {
+    size_t total = 0;
+    for (int i = 0; i < zs->count; i++) {
+        const zip_stream_entry_t *e = &zs->entries[i];
+        total += 46 + strlen(e->name) + central_extra_size(e);
+    }
+    return total;
+}
+
+static bool end_needs_zip64(const zip_stream_t *zs, uint64_t cd_size) {
+    return zs->count >= ZIP_MAX16 || cd_size >= ZIP_MAX32 || zs->data_end >= ZIP_MAX32;
+}
+
+static size_t end_records_size(const zip_stream_t *zs, uint64_t cd_size) {
+    return 22 + (end_needs_zip64(zs, cd_size) ? 56 + 20 : 0);
+}
+
+/* ─── Archive ────────────────────────────────────────────────────────── */
+
+int zip_stream_init(zip_stream_t *zs, int capacity) {
+    if (!zs || capacity <= 0) {
+        return -1;
+    }
+
+    memset(zs, 0, sizeof(*zs));
+    zs->entries = calloc((size_t)capacity, sizeof(zip_stream_entry_t));
+    if (!zs->entries) {
+        return -1;
+    }
+    zs->capacity = capacity;
+    return 0;
+}
+
+void zip_stream_free(zip_stream_t *zs) {
+    if (!zs) {
+        return;
+    }
+    free(zs->entries);
+    zs->entries = NULL;
+    zs->count = 0;
+}
+
+int zip_stream_add(zip_stream_t *zs, const char *name, const char *path,
+                   uint64_t size, time_t mtime) {
+    if (!zs || !name || !path || zs->count >= zs->capacity) {
+        return -1;
+    }
+
+    zip_stream_entry_t *e = &zs->entries[zs->count];
+    memset(e, 0, sizeof(*e));
+    strncpy(e->name, name, sizeof(e->name) - 1);
+    strncpy(e->path, path, sizeof(e->path) - 1);
+    e->size = size;
+    e->offset = zs->data_end;
+
+    // DOS timestamps start in 1980 and have two-second resolution
+    struct tm tm_info;
+    localtime_r(&mtime, &tm_info);
+    if (tm_info.tm_year < 80) {
+        e->dos_date = (1 << 5) | 1;     // 1980-01-01
+        e->dos_time = 0;
+    } else {
+        e->dos_time = (uint16_t)(((tm_info.tm_hour & 0x1F) << 11) |
+                                 ((tm_info.tm_min & 0x3F) << 5) |
+                                 ((tm_info.tm_sec / 2) & 0x1F));
+        e->dos_date = (uint16_t)((((tm_info.tm_year - 80) & 0x7F) << 9) |
+                                 (((tm_info.tm_mon + 1) & 0x0F) << 5) |
+                                 (tm_info.tm_mday & 0x1F));
+    }
+
+    zs->data_end += local_header_size(e) + size + data_descriptor_size(e);
+    return zs->count++;
+}
+
+uint64_t zip_stream_total_size(const zip_stream_t *zs) {
+    size_t cd_size = central_directory_size(zs);
+    return zs->data_end + cd_size + end_records_size(zs, cd_size);
+}
+
+size_t zip_stream_local_header(const zip_stream_entry_t *e, uint8_t *out) {
+    bool zip64 = size_needs_zip64(e);
+    uint16_t namelen = (uint16_t)strlen(e->name);
+
+    // The CRC follows in the data descriptor.  The sizes are known, so they
+    // are filled in anyway for readers that walk local headers.
+    uint8_t *p = out;
+    p = put_u32(p, ZIP_SIG_LOCAL);
+    p = put_u16(p, zip64 ? ZIP_VERSION_ZIP64 : ZIP_VERSION_DEFAULT);
+    p = put_u16(p, ZIP_FLAG_DESCRIPTOR);
+    p = put_u16(p, 0);                                  // STORED
+    p = put_u16(p, e->dos_time);
+    p = put_u16(p, e->dos_date);
+    p = put_u32(p, 0);                                  // CRC-32
+    p = put_u32(p, zip64 ? ZIP_MAX32 : (uint32_t)e->size);
+    p = put_u32(p, zip64 ? ZIP_MAX32 : (uint32_t)e->size);
+    p = put_u16(p, namelen);
+    p = put_u16(p, zip64 ? 20 : 0);
+    memcpy(p, e->name, namelen);
+    p += namelen;
+    if (zip64) {
+        p = put_u16(p, ZIP_EXTRA_ZIP64);
+        p = put_u16(p, 16);
+        p = put_u64(p, e->size);
+        p = put_u64(p, e->size);
+    }
+    return (size_t)(p - out);
+}
+
+size_t zip_stream_data_descriptor(const zip_stream_entry_t *e, uint8_t *out) {
+    uint8_t *p = out;
+    p = put_u32(p, ZIP_SIG_DESCRIPTOR);
+    p = put_u32(p, e->crc);
+    if (size_needs_zip64(e)) {
+        p = put_u64(p, e->size);
+        p = put_u64(p, e->size);
+    } else {
+        p = put_u32(p, (uint32_t)e->size);
+        p = put_u32(p, (uint32_t)e->size);
+    }
+    return (size_t)(p - out);
+}
+
+uint8_t *zip_stream_build_trailer(const zip_stream_t *zs, size_t *len) {
+    size_t cd_size = central_directory_size(zs);
+    size_t total = cd_size + end_records_size(zs, cd_size);
+
+    uint8_t *buf = malloc(total);
+    if (!buf) {
+        return NULL;
+    }
+
+    uint8_t *p = buf;
+    for (int i = 0; i < zs->count; i++) {
+        const zip_stream_entry_t *e = &zs->entries[i];
+        bool zip64_size = size_needs_zip64(e);
+        bool zip64_offset = offset_needs_zip64(e);
+        uint16_t version = (zip64_size || zip64_offset) ? ZIP_VERSION_ZIP64 : ZIP_VERSION_DEFAULT;
+        uint16_t namelen = (uint16_t)strlen(e->name);
+        size_t extra = central_extra_size(e);
+
+        p = put_u32(p, ZIP_SIG_CENTRAL);
+        p = put_u16(p, version);                        // made by
+        p = put_u16(p, version);                        // needed
+        p = put_u16(p, ZIP_FLAG_DESCRIPTOR);
+        p = put_u16(p, 0);                              // STORED
+        p = put_u16(p, e->dos_time);
+        p = put_u16(p, e->dos_date);
+        p = put_u32(p, e->crc);
+        p = put_u32(p, zip64_size ? ZIP_MAX32 : (uint32_t)e->size);
+        p = put_u32(p, zip64_size ? ZIP_MAX32 : (uint32_t)e->size);
+        p = put_u16(p, namelen);
+        p = put_u16(p, (uint16_t)extra);
+        p = put_u16(p, 0);                              // comment
+        p = put_u16(p, 0);                              // disk
+        p = put_u16(p, 0);                              // internal attributes
+        p = put_u32(p, 0);                              // external attributes
+        p = put_u32(p, zip64_offset ? ZIP_MAX32 : (uint32_t)e->offset);
+        memcpy(p, e->name, namelen);
+        p += namelen;
+        if (extra) {
+            p = put_u16(p, ZIP_EXTRA_ZIP64);
+            p = put_u16(p, (uint16_t)(extra - 4));
+            if (zip64_size) {
+                p = put_u64(p, e->size);
+                p = put_u64(p, e->size);
+            }
+            if (zip64_offset) {
+                p = put_u64(p, e->offset);
+            }
+        }
+    }
+
+    bool zip64_end = end_needs_zip64(zs, cd_size);
+    if (zip64_end) {
+        uint64_t zip64_end_offset = zs->data_end + cd_size;
+
+        p = put_u32(p, ZIP_SIG_ZIP64_END);
+        p = put_u64(p, 44);                             // size of the rest of the record
+        p = put_u16(p, ZIP_VERSION_ZIP64);
+        p = put_u16(p, ZIP_VERSION_ZIP64);
+        p = put_u32(p, 0);                              // this disk
+        p = put_u32(p, 0);                              // central directory disk
+        p = put_u64(p, (uint64_t)zs->count);
+        p = put_u64(p, (uint64_t)zs->count);
+        p = put_u64(p, cd_size);
+        p = put_u64(p, zs->data_end);
+
+        p = put_u32(p, ZIP_SIG_ZIP64_LOCATOR);
+        p = put_u32(p, 0);
+        p = put_u64(p, zip64_end_offset);
+        p = put_u32(p, 1);                              // total disks
+    }
+
+    uint16_t count16 = zs->count >= ZIP_MAX16 ? ZIP_MAX16 : (uint16_t)zs->count;
+    p = put_u32(p, ZIP_SIG_END);
+    p = put_u16(p, 0);
+    p = put_u16(p, 0);
+    p = put_u16(p, count16);
+    p = put_u16(p, count16);
+    p = put_u32(p, cd_size >= ZIP_MAX32 ? ZIP_MAX32 : (uint32_t)cd_size);
+    p = put_u32(p, zs->data_end >= ZIP_MAX32 ? ZIP_MAX32 : (uint32_t)zs->data_end);
+    p = put_u16(p, 0);                                  // comment
+
+    *len = (size_t)(p - buf);
+    return buf;
+}
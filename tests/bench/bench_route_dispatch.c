@@ -0,0 +1,285 @@
+/**
+ * @file bench_route_dispatch.c
+ * @brief Microbenchmark: libuv route dispatch, linear scan vs. route trie
+ *
+ * Registers the API route table from libuv_api_handlers.c with both the
+ * original matcher (strcmp on the method plus path_matches_pattern() over
+ * every route in registration order) and route_trie_match(), then
+ * dispatches a fixed mix of request paths and reports lookups/second.
+ * The mix includes static asset paths, which match no route and therefore
+ * cost the linear scan a full pass over the table.
+ *
+ * Usage: bench_route_dispatch [lookups]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "web/route_trie.h"
+
+typedef struct {
+    const char *path;
+    const char *method;
+} bench_route_t;
+
+// Snapshot of register_all_libuv_handlers(), in registration order
+static const bench_route_t routes[] = {
+    { "/api/setup/status", "GET" },
+    { "/api/setup/status", "POST" },
+    { "/api/health", "GET" },
+    { "/api/health/hls", "GET" },
+    { "/api/metrics", "GET" },
+    { "/api/telemetry/player", "POST" },
+    { "/api/streams", "GET" },
+    { "/api/streams", "POST" },
+    { "/api/streams/test", "POST" },
+    { "/api/streams/#/zones", "GET" },
+    { "/api/streams/#/zones", "POST" },
+    { "/api/streams/#/zones", "DELETE" },
+    { "/api/streams/#/retention", "GET" },
+    { "/api/streams/#/retention", "PUT" },
+    { "/api/streams/#/refresh", "POST" },
+    { "/api/streams/#/ptz/capabilities", "GET" },
+    { "/api/streams/#/ptz/presets", "GET" },
+    { "/api/streams/#/ptz/move", "POST" },
+    { "/api/streams/#/ptz/stop", "POST" },
+    { "/api/streams/#/ptz/absolute", "POST" },
+    { "/api/streams/#/ptz/relative", "POST" },
+    { "/api/streams/#/ptz/home", "POST" },
+    { "/api/streams/#/ptz/set-home", "POST" },
+    { "/api/streams/#/ptz/goto-preset", "POST" },
+    { "/api/streams/#/ptz/preset", "PUT" },
+    { "/api/streams/#/full", "GET" },
+    { "/api/streams/#", "GET" },
+    { "/api/streams/#", "PUT" },
+    { "/api/streams/#", "DELETE" },
+    { "/api/settings", "GET" },
+    { "/api/settings", "POST" },
+    { "/api/ice-servers", "GET" },
+    { "/api/system", "GET" },
+    { "/api/system/info", "GET" },
+    { "/api/system/logs", "GET" },
+    { "/api/system/restart", "POST" },
+    { "/api/system/shutdown", "POST" },
+    { "/api/system/logs/clear", "POST" },
+    { "/api/system/backup", "POST" },
+    { "/api/system/status", "GET" },
+    { "/api/detection/results/#", "GET" },
+    { "/api/detection/models", "GET" },
+    { "/api/motion/test/#", "POST" },
+    { "/api/storage/health", "GET" },
+    { "/api/storage/cleanup", "POST" },
+    { "/api/auth/login/config", "GET" },
+    { "/api/auth/login", "POST" },
+    { "/api/auth/logout", "POST" },
+    { "/api/auth/verify", "GET" },
+    { "/api/auth/sessions", "GET" },
+    { "/api/auth/sessions/#", "DELETE" },
+    { "/api/auth/trusted-devices", "GET" },
+    { "/api/auth/trusted-devices/#", "DELETE" },
+    { "/logout", "GET" },
+    { "/api/auth/users", "GET" },
+    { "/api/auth/users", "POST" },
+    { "/api/auth/users/#", "GET" },
+    { "/api/auth/users/#", "PUT" },
+    { "/api/auth/users/#", "DELETE" },
+    { "/api/auth/users/#/api-key", "POST" },
+    { "/api/auth/users/#/password", "PUT" },
+    { "/api/auth/users/#/password-lock", "PUT" },
+    { "/api/auth/users/#/login-lockout/clear", "POST" },
+    { "/api/auth/users/#/totp/setup", "POST" },
+    { "/api/auth/users/#/totp/verify", "POST" },
+    { "/api/auth/users/#/totp/disable", "POST" },
+    { "/api/auth/users/#/totp/status", "GET" },
+    { "/api/auth/login/totp", "POST" },
+    { "/api/onvif/discovery/status", "GET" },
+    { "/api/onvif/devices", "GET" },
+    { "/api/onvif/discovery/discover", "POST" },
+    { "/api/onvif/device/profiles", "GET" },
+    { "/api/onvif/device/add", "POST" },
+    { "/api/onvif/device/test", "POST" },
+    { "/api/recordings/thumbnail/#/#", "GET" },
+    { "/api/recordings/play/#", "GET" },
+    { "/api/recordings/keyframe/#", "GET" },
+    { "/api/recordings/download/#", "GET" },
+    { "/api/recordings/files/check", "GET" },
+    { "/api/recordings/files", "DELETE" },
+    { "/api/recordings/batch-delete/progress/#", "GET" },
+    { "/api/recordings/batch-delete", "POST" },
+    { "/api/recordings/batch-download/status/#", "GET" },
+    { "/api/recordings/batch-download/result/#", "GET" },
+    { "/api/recordings/batch-download", "POST" },
+    { "/api/recordings/protected", "GET" },
+    { "/api/recordings/batch-protect", "POST" },
+    { "/api/recordings/sync", "POST" },
+    { "/api/recordings/tags", "GET" },
+    { "/api/recordings/detection-labels", "GET" },
+    { "/api/recordings/batch-tags", "POST" },
+    { "/api/recordings/#/tags", "GET" },
+    { "/api/recordings/#/tags", "PUT" },
+    { "/api/recordings/#/protect", "PUT" },
+    { "/api/recordings/#/retention", "PUT" },
+    { "/api/recordings/#", "GET" },
+    { "/api/recordings/#", "DELETE" },
+    { "/api/recordings", "GET" },
+    { "/api/timeline/segments-by-ids", "GET" },
+    { "/api/timeline/segments", "GET" },
+    { "/api/timeline/manifest", "GET" },
+    { "/api/timeline/play", "GET" },
+    { "/hls/#/#", "GET" },
+    { "/go2rtc/api/streams", "GET" },
+    { "/go2rtc/api/stream.m3u8", "GET" },
+    { "/go2rtc/api/hls/*", "GET" },
+    { "/go2rtc/api/frame.jpeg", "GET" },
+};
+#define ROUTE_COUNT ((int)(sizeof(routes) / sizeof(routes[0])))
+
+typedef struct {
+    http_method_t method;
+    const char *method_str;
+    const char *path;
+} bench_request_t;
+
+static const bench_request_t requests[] = {
+    { HTTP_METHOD_GET,  "GET",  "/api/streams" },
+    { HTTP_METHOD_GET,  "GET",  "/api/streams/front_door" },
+    { HTTP_METHOD_GET,  "GET",  "/api/streams/front_door/full" },
+    { HTTP_METHOD_POST, "POST", "/api/streams/front_door/ptz/move" },
+    { HTTP_METHOD_GET,  "GET",  "/api/recordings" },
+    { HTTP_METHOD_GET,  "GET",  "/api/recordings/12345" },
+    { HTTP_METHOD_GET,  "GET",  "/api/recordings/thumbnail/12345/1" },
+    { HTTP_METHOD_GET,  "GET",  "/api/timeline/segments" },
+    { HTTP_METHOD_GET,  "GET",  "/api/auth/verify" },
+    { HTTP_METHOD_GET,  "GET",  "/api/system/status" },
+    { HTTP_METHOD_GET,  "GET",  "/hls/front_door/index.m3u8" },
+    { HTTP_METHOD_GET,  "GET",  "/go2rtc/api/hls/segment.m4s" },
+    { HTTP_METHOD_GET,  "GET",  "/index.html" },
+    { HTTP_METHOD_GET,  "GET",  "/assets/js/app.js" },
+    { HTTP_METHOD_GET,  "GET",  "/assets/css/main.css" },
+    { HTTP_METHOD_GET,  "GET",  "/favicon.ico" },
+};
+#define REQUEST_COUNT ((int)(sizeof(requests) / sizeof(requests[0])))
+
+static void bench_handler(const http_request_t *req, http_response_t *res) {
+    (void)req;
+    (void)res;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// The matcher on_message_complete() used before the route trie
+static bool path_matches_pattern(const char *path, const char *pattern) {
+    const char *p = path;
+    const char *pat = pattern;
+
+    while (*pat) {
+        if (*pat == '*') {
+            return true;
+        } else if (*pat == '#') {
+            pat++;
+            while (*p && *p != '/') {
+                p++;
+            }
+            if (!*pat) {
+                return *p == '\0';
+            }
+            if (!*p) {
+                return false;
+            }
+        } else if (*pat == *p) {
+            pat++;
+            p++;
+        } else {
+            return false;
+        }
+    }
+
+    return *p == '\0' && *pat == '\0';
+}
+
+static int linear_match(const bench_request_t *req) {
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        if (routes[i].method[0] != '\0' && strcmp(routes[i].method, req->method_str) != 0) {
+            continue;
+        }
+        if (path_matches_pattern(req->path, routes[i].path)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static double run_linear(long lookups, long *hits) {
+    double start = now_seconds();
+    for (long i = 0; i < lookups; i++) {
+        if (linear_match(&requests[i % REQUEST_COUNT]) >= 0) {
+            (*hits)++;
+        }
+    }
+    return now_seconds() - start;
+}
+
+static double run_trie(const route_trie_t *trie, long lookups, long *hits) {
+    route_match_t match;
+    double start = now_seconds();
+    for (long i = 0; i < lookups; i++) {
+        const bench_request_t *req = &requests[i % REQUEST_COUNT];
+        if (route_trie_match(trie, req->method, req->path, &match)) {
+            (*hits)++;
+        }
+    }
+    return now_seconds() - start;
+}
+
+int main(int argc, char **argv) {
+    long lookups = argc > 1 ? atol(argv[1]) : 5000000;
+    if (lookups <= 0) lookups = 5000000;
+
+    route_trie_t trie;
+    if (route_trie_init(&trie) != 0) {
+        fprintf(stderr, "failed to create route trie\n");
+        return 1;
+    }
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        if (route_trie_insert(&trie, routes[i].path, routes[i].method, bench_handler) != 0) {
+            fprintf(stderr, "failed to add route %s %s\n", routes[i].method, routes[i].path);
+            route_trie_free(&trie);
+            return 1;
+        }
+    }
+
+    // Both matchers must agree on which requests are routed at all
+    for (int i = 0; i < REQUEST_COUNT; i++) {
+        route_match_t match;
+        bool linear = linear_match(&requests[i]) >= 0;
+        bool trie_hit = route_trie_match(&trie, requests[i].method, requests[i].path, &match);
+        if (linear != trie_hit) {
+            fprintf(stderr, "matchers disagree on %s %s\n", requests[i].method_str, requests[i].path);
+            route_trie_free(&trie);
+            return 1;
+        }
+    }
+
+    long linear_hits = 0;
+    long trie_hits = 0;
+    double linear_elapsed = run_linear(lookups, &linear_hits);
+    double trie_elapsed = run_trie(&trie, lookups, &trie_hits);
+
+    double linear_rate = (double)lookups / linear_elapsed;
+    double trie_rate = (double)lookups / trie_elapsed;
+    printf("%d routes, %d request paths\n", ROUTE_COUNT, REQUEST_COUNT);
+    printf("%-14s %10ld lookups in %7.3f s  %12.0f requests/s\n", "linear scan", lookups, linear_elapsed, linear_rate);
+    printf("%-14s %10ld lookups in %7.3f s  %12.0f requests/s\n", "route trie", lookups, trie_elapsed, trie_rate);
+    printf("trie / linear: %.2fx\n", trie_rate / linear_rate);
+
+    route_trie_free(&trie);
+    return linear_hits == trie_hits ? 0 : 1;
+}
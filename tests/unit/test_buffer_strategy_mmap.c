@@ -0,0 +1,215 @@
+/**
+ * @file test_buffer_strategy_mmap.c
+ * @brief Layer 3 Unity tests for video/buffer_strategy_mmap.c
+ *
+ * Tests that the mmap pre-detection buffer stores variable-size packets back
+ * to back, evicts the oldest packets across ring wrap-around, and flushes in
+ * order starting at the first keyframe.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+
+#include "unity.h"
+#include "video/pre_detection_buffer.h"
+
+#define TEST_STORAGE_PATH "/tmp/lightnvr_unit_mmap_test"
+#define TEST_DISK_LIMIT ((size_t)1536 * 1024)
+
+static pre_buffer_strategy_t *strategy;
+
+/* ---- helpers ---- */
+
+static buffer_config_t make_config(bool keyframe_aligned) {
+    buffer_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.buffer_seconds = 2;
+    cfg.estimated_fps = 10;              /* 80 index entries */
+    cfg.disk_limit_bytes = TEST_DISK_LIMIT;
+    cfg.storage_path = TEST_STORAGE_PATH;
+    cfg.prefer_keyframe_alignment = keyframe_aligned;
+    return cfg;
+}
+
+static void add_pkt(int64_t pts, int size_bytes, bool keyframe) {
+    AVPacket *pkt = av_packet_alloc();
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, av_new_packet(pkt, size_bytes));
+    memset(pkt->data, (int)(pts & 0xFF), size_bytes);
+    if (keyframe)
+        pkt->flags |= AV_PKT_FLAG_KEY;
+    pkt->pts = pts;
+    pkt->dts = pts;
+    TEST_ASSERT_EQUAL_INT(0, strategy->add_packet(strategy, pkt, (time_t)(1000 + pts)));
+    av_packet_free(&pkt);
+}
+
+typedef struct {
+    int count;
+    int64_t first_pts;
+    int64_t last_pts;
+    bool first_is_key;
+    bool in_order;
+    bool data_ok;
+} flush_result_t;
+
+static int collect_cb(const AVPacket *pkt, void *user_data) {
+    flush_result_t *r = (flush_result_t *)user_data;
+    if (r->count == 0) {
+        r->first_pts = pkt->pts;
+        r->first_is_key = (pkt->flags & AV_PKT_FLAG_KEY) != 0;
+    } else if (pkt->pts != r->last_pts + 1) {
+        r->in_order = false;
+    }
+    for (int i = 0; i < pkt->size; i++) {
+        if (pkt->data[i] != (uint8_t)(pkt->pts & 0xFF)) {
+            r->data_ok = false;
+            break;
+        }
+    }
+    r->last_pts = pkt->pts;
+    r->count++;
+    return 0;
+}
+
+static flush_result_t flush_all(void) {
+    flush_result_t r = { .in_order = true, .data_ok = true };
+    strategy->flush_to_callback(strategy, collect_cb, &r);
+    return r;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    strategy = NULL;
+}
+
+void tearDown(void) {
+    destroy_buffer_strategy(strategy);
+    strategy = NULL;
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_small_packets_are_not_padded_to_max_size(void) {
+    buffer_config_t cfg = make_config(false);
+    strategy = create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, "mmap_small", &cfg);
+    TEST_ASSERT_NOT_NULL(strategy);
+
+    /* 80 x 2 KB fits easily in a 1.5 MB file once records are variable size */
+    for (int i = 0; i < 80; i++) {
+        add_pkt(i, 2048, i % 10 == 0);
+    }
+
+    buffer_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, strategy->get_stats(strategy, &stats));
+    TEST_ASSERT_EQUAL_INT(80, stats.packet_count);
+    TEST_ASSERT_EQUAL_INT(8, stats.keyframe_count);
+
+    flush_result_t r = flush_all();
+    TEST_ASSERT_EQUAL_INT(80, r.count);
+    TEST_ASSERT_EQUAL_INT64(0, r.first_pts);
+    TEST_ASSERT_TRUE(r.in_order);
+    TEST_ASSERT_TRUE(r.data_ok);
+}
+
+void test_wraparound_evicts_oldest(void) {
+    buffer_config_t cfg = make_config(false);
+    strategy = create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, "mmap_wrap", &cfg);
+    TEST_ASSERT_NOT_NULL(strategy);
+
+    /* Mixed sizes so records land at uneven offsets and wrap with padding */
+    for (int i = 0; i < 60; i++) {
+        add_pkt(i, (i % 5 == 0) ? 150 * 1024 : 37 * 1024 + i, i % 5 == 0);
+    }
+
+    buffer_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, strategy->get_stats(strategy, &stats));
+    TEST_ASSERT_TRUE(stats.packet_count > 0);
+    TEST_ASSERT_TRUE(stats.packet_count < 60);
+    TEST_ASSERT_EQUAL_INT(1000 + 59, (int)stats.newest_timestamp);
+    TEST_ASSERT_EQUAL_INT(1000 + 60 - stats.packet_count, (int)stats.oldest_timestamp);
+
+    flush_result_t r = flush_all();
+    TEST_ASSERT_EQUAL_INT(stats.packet_count, r.count);
+    TEST_ASSERT_EQUAL_INT64(59, r.last_pts);
+    TEST_ASSERT_TRUE(r.in_order);
+    TEST_ASSERT_TRUE(r.data_ok);
+}
+
+void test_flush_starts_at_first_keyframe(void) {
+    buffer_config_t cfg = make_config(true);
+    strategy = create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, "mmap_key", &cfg);
+    TEST_ASSERT_NOT_NULL(strategy);
+
+    for (int i = 0; i < 60; i++) {
+        add_pkt(i, (i % 7 == 0) ? 120 * 1024 : 40 * 1024, i % 7 == 0);
+    }
+
+    flush_result_t r = flush_all();
+    TEST_ASSERT_TRUE(r.count > 0);
+    TEST_ASSERT_TRUE(r.first_is_key);
+    TEST_ASSERT_EQUAL_INT64(0, r.first_pts % 7);
+    TEST_ASSERT_EQUAL_INT64(59, r.last_pts);
+    TEST_ASSERT_TRUE(r.in_order);
+    TEST_ASSERT_TRUE(r.data_ok);
+}
+
+void test_rejects_packet_larger_than_half_the_ring(void) {
+    buffer_config_t cfg = make_config(false);
+    strategy = create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, "mmap_big", &cfg);
+    TEST_ASSERT_NOT_NULL(strategy);
+
+    AVPacket *pkt = av_packet_alloc();
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, av_new_packet(pkt, (int)(TEST_DISK_LIMIT / 2)));
+    TEST_ASSERT_EQUAL_INT(-1, strategy->add_packet(strategy, pkt, 1000));
+    av_packet_free(&pkt);
+}
+
+void test_clear_resets_ring(void) {
+    buffer_config_t cfg = make_config(false);
+    strategy = create_buffer_strategy(BUFFER_STRATEGY_MMAP_HYBRID, "mmap_clear", &cfg);
+    TEST_ASSERT_NOT_NULL(strategy);
+
+    for (int i = 0; i < 30; i++) {
+        add_pkt(i, 60 * 1024, i % 10 == 0);
+    }
+    strategy->clear(strategy);
+
+    buffer_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, strategy->get_stats(strategy, &stats));
+    TEST_ASSERT_EQUAL_INT(0, stats.packet_count);
+    TEST_ASSERT_EQUAL_INT(0, stats.keyframe_count);
+
+    add_pkt(100, 1024, true);
+    flush_result_t r = flush_all();
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    TEST_ASSERT_EQUAL_INT64(100, r.first_pts);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    mkdir(TEST_STORAGE_PATH, 0755);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_small_packets_are_not_padded_to_max_size);
+    RUN_TEST(test_wraparound_evicts_oldest);
+    RUN_TEST(test_flush_starts_at_first_keyframe);
+    RUN_TEST(test_rejects_packet_larger_than_half_the_ring);
+    RUN_TEST(test_clear_resets_ring);
+    return UNITY_END();
+}
@@ -4,7 +4,8 @@
  *
  * Tests db_auth_init, create/get user, authenticate, change_password,
  * create/validate/delete session, cleanup_sessions, role helpers,
- * generate_api_key, and TOTP set/get/enable round-trip.
+ * generate_api_key, TOTP set/get/enable round-trip, and invalidation and
+ * batched activity writes of the session cache.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -20,6 +21,7 @@
 #include "utils/strings.h"
 #include "database/db_core.h"
 #include "database/db_auth.h"
+#include "database/db_auth_cache.h"
 
 #define TEST_DB_PATH "/tmp/lightnvr_unit_auth_test.db"
 
@@ -283,6 +285,105 @@ void test_list_sessions_and_trusted_devices(void) {
     TEST_ASSERT_EQUAL_INT(0, device_count);
 }
 
+/* session cache: user edits and logout are visible immediately */
+void test_session_cache_invalidated_on_user_changes(void) {
+    int64_t uid = 0;
+    db_auth_create_user("cacheuser", "pass", NULL, USER_ROLE_USER, true, &uid);
+
+    char token[128];
+    int rc = db_auth_create_session(uid, NULL, NULL, 3600, token, sizeof(token));
+    TEST_ASSERT_EQUAL_INT(0, rc);
+
+    user_t user;
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_session_user(token, &user));
+    TEST_ASSERT_FALSE(user.has_tag_restriction);
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_set_allowed_tags(uid, "garage"));
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_session_user(token, &user));
+    TEST_ASSERT_TRUE(user.has_tag_restriction);
+    TEST_ASSERT_EQUAL_STRING("garage", user.allowed_tags);
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_update_user(uid, NULL, NULL, USER_ROLE_VIEWER, -1));
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_session_user(token, &user));
+    TEST_ASSERT_EQUAL_INT(USER_ROLE_VIEWER, user.role);
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_update_user(uid, NULL, NULL, -1, 0));
+    TEST_ASSERT_NOT_EQUAL(0, db_auth_validate_session(token, NULL));
+    TEST_ASSERT_NOT_EQUAL(0, db_auth_get_session_user(token, &user));
+}
+
+/* session cache: every revocation path advances the generation that keeps a
+ * concurrent cache miss from caching the row it read before the revocation */
+void test_session_revocation_advances_cache_generation(void) {
+    int64_t uid = 0;
+    db_auth_create_user("genuser", "pass", NULL, USER_ROLE_USER, true, &uid);
+
+    char token[128];
+    TEST_ASSERT_EQUAL_INT(0, db_auth_create_session(uid, NULL, NULL, 3600, token, sizeof(token)));
+
+    uint64_t generation = auth_cache_generation();
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_session(token));
+    TEST_ASSERT_NOT_EQUAL(generation, auth_cache_generation());
+
+    generation = auth_cache_generation();
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_user_sessions(uid));
+    TEST_ASSERT_NOT_EQUAL(generation, auth_cache_generation());
+
+    generation = auth_cache_generation();
+    TEST_ASSERT_EQUAL_INT(0, db_auth_change_password(uid, "newpass"));
+    TEST_ASSERT_NOT_EQUAL(generation, auth_cache_generation());
+
+    // A miss that read the session before the logout must not cache it
+    TEST_ASSERT_EQUAL_INT(0, db_auth_create_session(uid, NULL, NULL, 3600, token, sizeof(token)));
+    user_t user;
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_session_user(token, &user));
+    generation = auth_cache_generation();
+    TEST_ASSERT_EQUAL_INT(0, db_auth_delete_session(token));
+    TEST_ASSERT_NOT_EQUAL(0, db_auth_get_session_user(token, &user));
+    TEST_ASSERT_NOT_EQUAL(generation, auth_cache_generation());
+}
+
+/* session cache: activity is only written to the database on flush */
+void test_session_activity_is_batched(void) {
+    int64_t uid = 0;
+    db_auth_create_user("batchuser", "pass", NULL, USER_ROLE_USER, true, &uid);
+
+    char token[128];
+    int rc = db_auth_create_session(uid, NULL, NULL, 3600, token, sizeof(token));
+    TEST_ASSERT_EQUAL_INT(0, rc);
+
+    sqlite3 *db = get_db_handle();
+    sqlite3_stmt *stmt = NULL;
+    int64_t old_activity = (int64_t)time(NULL) - 120;
+    rc = sqlite3_prepare_v2(db, "UPDATE sessions SET last_activity_at = ? WHERE token = ?;",
+                            -1, &stmt, NULL);
+    TEST_ASSERT_EQUAL_INT(SQLITE_OK, rc);
+    sqlite3_bind_int64(stmt, 1, old_activity);
+    sqlite3_bind_text(stmt, 2, token, -1, SQLITE_STATIC);
+    TEST_ASSERT_EQUAL_INT(SQLITE_DONE, sqlite3_step(stmt));
+    sqlite3_finalize(stmt);
+
+    TEST_ASSERT_EQUAL_INT(0, db_auth_validate_session(token, NULL));
+    TEST_ASSERT_EQUAL_INT(0, db_auth_validate_session(token, NULL));
+
+    rc = sqlite3_prepare_v2(db, "SELECT last_activity_at FROM sessions WHERE token = ?;",
+                            -1, &stmt, NULL);
+    TEST_ASSERT_EQUAL_INT(SQLITE_OK, rc);
+    sqlite3_bind_text(stmt, 1, token, -1, SQLITE_STATIC);
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(stmt));
+    TEST_ASSERT_EQUAL_INT64(old_activity, sqlite3_column_int64(stmt, 0));
+    sqlite3_reset(stmt);
+
+    TEST_ASSERT_GREATER_OR_EQUAL_INT(1, db_auth_flush_session_activity());
+
+    TEST_ASSERT_EQUAL_INT(SQLITE_ROW, sqlite3_step(stmt));
+    TEST_ASSERT_TRUE(sqlite3_column_int64(stmt, 0) > old_activity);
+    sqlite3_finalize(stmt);
+
+    // Nothing left to write
+    TEST_ASSERT_EQUAL_INT(0, db_auth_flush_session_activity());
+}
+
 /* role name / id conversions */
 void test_role_name_conversions(void) {
     TEST_ASSERT_EQUAL_STRING("admin",  db_auth_get_role_name(USER_ROLE_ADMIN));
@@ -308,6 +409,12 @@ void test_generate_and_use_api_key(void) {
     rc = db_auth_get_user_by_api_key(api_key, &found);
     TEST_ASSERT_EQUAL_INT(0, rc);
     TEST_ASSERT_EQUAL_STRING("apiuser", found.username);
+
+    // Regenerating the key retires the cached old one
+    char new_key[64];
+    TEST_ASSERT_EQUAL_INT(0, db_auth_generate_api_key(uid, new_key, sizeof(new_key)));
+    TEST_ASSERT_NOT_EQUAL(0, db_auth_get_user_by_api_key(api_key, &found));
+    TEST_ASSERT_EQUAL_INT(0, db_auth_get_user_by_api_key(new_key, &found));
 }
 
 /* TOTP set/get/enable round-trip */
@@ -428,6 +535,9 @@ int main(void) {
     RUN_TEST(test_validate_session_updates_client_context_when_changed);
     RUN_TEST(test_delete_session);
     RUN_TEST(test_list_sessions_and_trusted_devices);
+    RUN_TEST(test_session_cache_invalidated_on_user_changes);
+    RUN_TEST(test_session_revocation_advances_cache_generation);
+    RUN_TEST(test_session_activity_is_batched);
     RUN_TEST(test_role_name_conversions);
     RUN_TEST(test_generate_and_use_api_key);
     RUN_TEST(test_totp_set_get_enable);
@@ -0,0 +1,225 @@
+/**
+ * @file test_db_auth_cache.c
+ * @brief Layer 2 Unity tests for database/db_auth_cache.c
+ *
+ * Exercises lookup, expiry, activity tracking and batching, reload merging,
+ * eviction when a shard is full, and invalidation by key, session and user.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "database/db_auth_cache.h"
+
+#define NOW 1700000000
+
+/* ---- helpers ---- */
+
+static void make_key(uint8_t key[AUTH_CACHE_KEY_SIZE], uint8_t shard, uint8_t id) {
+    memset(key, 0, AUTH_CACHE_KEY_SIZE);
+    key[0] = shard;
+    key[1] = id;
+}
+
+static auth_cache_entry_t make_session(uint8_t shard, uint8_t id, int64_t user_id) {
+    auth_cache_entry_t e;
+    memset(&e, 0, sizeof(e));
+    make_key(e.key, shard, id);
+    e.kind = AUTH_CACHE_SESSION;
+    e.session_id = (int64_t)shard * 1000 + id + 1;
+    e.expires_at = NOW + 3600;
+    e.idle_expires_at = NOW + 600;
+    e.last_activity_at = NOW - 10;
+    e.stored_activity_at = e.last_activity_at;
+    e.loaded_at = NOW;
+    e.user.id = user_id;
+    e.user.role = USER_ROLE_USER;
+    e.user.is_active = true;
+    return e;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    auth_cache_clear();
+}
+
+void tearDown(void) {}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_put_and_get(void) {
+    auth_cache_entry_t e = make_session(1, 1, 42);
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_put(&e, NOW));
+
+    auth_cache_entry_t out;
+    TEST_ASSERT_TRUE(auth_cache_get(e.key, AUTH_CACHE_SESSION, NOW, &out));
+    TEST_ASSERT_EQUAL_INT64(42, out.user.id);
+    TEST_ASSERT_EQUAL_INT64(e.session_id, out.session_id);
+
+    // Same digest under the other kind is a different entry
+    TEST_ASSERT_FALSE(auth_cache_get(e.key, AUTH_CACHE_API_KEY, NOW, &out));
+}
+
+void test_expired_session_is_dropped(void) {
+    auth_cache_entry_t e = make_session(2, 1, 42);
+    auth_cache_put(&e, NOW);
+
+    auth_cache_entry_t out;
+    TEST_ASSERT_FALSE(auth_cache_get(e.key, AUTH_CACHE_SESSION, NOW + 601, &out));
+    TEST_ASSERT_FALSE(auth_cache_get(e.key, AUTH_CACHE_SESSION, NOW, &out));
+}
+
+void test_stale_entry_is_a_miss(void) {
+    auth_cache_entry_t e = make_session(3, 1, 42);
+    e.idle_expires_at = e.expires_at;
+    auth_cache_put(&e, NOW);
+
+    auth_cache_entry_t out;
+    TEST_ASSERT_TRUE(auth_cache_get(e.key, AUTH_CACHE_SESSION, NOW + AUTH_CACHE_TTL_SECONDS - 1, &out));
+    TEST_ASSERT_FALSE(auth_cache_get(e.key, AUTH_CACHE_SESSION, NOW + AUTH_CACHE_TTL_SECONDS, &out));
+}
+
+void test_record_activity_extends_idle_expiry_and_batches(void) {
+    auth_cache_entry_t e = make_session(4, 1, 42);
+    auth_cache_put(&e, NOW);
+
+    auth_cache_entry_t out;
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_record_activity(e.key, NOW + 30, 600, NULL, NULL, &out));
+    TEST_ASSERT_EQUAL_INT64(NOW + 30, out.last_activity_at);
+    TEST_ASSERT_EQUAL_INT64(NOW + 630, out.idle_expires_at);
+
+    // Idle expiry never passes the absolute expiry
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_record_activity(e.key, NOW + 500, 3600, NULL, NULL, &out));
+    TEST_ASSERT_EQUAL_INT64(NOW + 3600, out.idle_expires_at);
+
+    auth_cache_activity_t pending[4];
+    TEST_ASSERT_EQUAL_INT(1, auth_cache_take_activity(pending, 4));
+    TEST_ASSERT_EQUAL_INT64(e.session_id, pending[0].session_id);
+    TEST_ASSERT_EQUAL_INT64(NOW + 500, pending[0].last_activity_at);
+    TEST_ASSERT_EQUAL_INT64(NOW + 3600, pending[0].idle_expires_at);
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_take_activity(pending, 4));
+}
+
+void test_record_activity_reports_client_changes(void) {
+    auth_cache_entry_t e = make_session(5, 1, 42);
+    strcpy(e.ip_address, "192.0.2.1");
+    strcpy(e.user_agent, "Agent/1");
+    auth_cache_put(&e, NOW);
+
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_record_activity(e.key, NOW, 600, "192.0.2.1", "Agent/1", NULL));
+    TEST_ASSERT_EQUAL_INT(1, auth_cache_record_activity(e.key, NOW, 600, "192.0.2.9", "Agent/1", NULL));
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_record_activity(e.key, NOW, 600, "192.0.2.9", NULL, NULL));
+
+    uint8_t unknown[AUTH_CACHE_KEY_SIZE];
+    make_key(unknown, 5, 99);
+    TEST_ASSERT_EQUAL_INT(-1, auth_cache_record_activity(unknown, NOW, 600, NULL, NULL, NULL));
+}
+
+void test_reload_keeps_unwritten_activity(void) {
+    auth_cache_entry_t e = make_session(6, 1, 42);
+    auth_cache_put(&e, NOW);
+    auth_cache_record_activity(e.key, NOW + 100, 600, NULL, NULL, NULL);
+
+    // A reload from the database still carries the older activity
+    auth_cache_entry_t reloaded = make_session(6, 1, 42);
+    reloaded.loaded_at = NOW + AUTH_CACHE_TTL_SECONDS;
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_put(&reloaded, NOW + AUTH_CACHE_TTL_SECONDS));
+
+    auth_cache_activity_t pending[4];
+    TEST_ASSERT_EQUAL_INT(1, auth_cache_take_activity(pending, 4));
+    TEST_ASSERT_EQUAL_INT64(NOW + 100, pending[0].last_activity_at);
+    TEST_ASSERT_EQUAL_INT64(NOW + 700, pending[0].idle_expires_at);
+}
+
+void test_full_shard_never_evicts_unwritten_activity(void) {
+    for (int i = 0; i < AUTH_CACHE_SHARD_SLOTS; i++) {
+        auth_cache_entry_t e = make_session(7, (uint8_t)i, 42);
+        TEST_ASSERT_EQUAL_INT(0, auth_cache_put(&e, NOW));
+        auth_cache_record_activity(e.key, NOW + 1, 600, NULL, NULL, NULL);
+    }
+
+    auth_cache_entry_t extra = make_session(7, 200, 43);
+    TEST_ASSERT_EQUAL_INT(-1, auth_cache_put(&extra, NOW));
+
+    // Once written back, the oldest entry can make room
+    auth_cache_activity_t pending[AUTH_CACHE_SHARD_SLOTS];
+    TEST_ASSERT_EQUAL_INT(AUTH_CACHE_SHARD_SLOTS, auth_cache_take_activity(pending, AUTH_CACHE_SHARD_SLOTS));
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_put(&extra, NOW));
+    TEST_ASSERT_TRUE(auth_cache_get(extra.key, AUTH_CACHE_SESSION, NOW, NULL));
+}
+
+void test_invalidation(void) {
+    auth_cache_entry_t a = make_session(8, 1, 42);
+    auth_cache_entry_t b = make_session(9, 1, 42);
+    auth_cache_entry_t c = make_session(10, 1, 43);
+    auth_cache_entry_t key = make_session(11, 1, 43);
+    key.kind = AUTH_CACHE_API_KEY;
+    key.session_id = 0;
+    auth_cache_put(&a, NOW);
+    auth_cache_put(&b, NOW);
+    auth_cache_put(&c, NOW);
+    auth_cache_put(&key, NOW);
+
+    auth_cache_invalidate_session(a.session_id);
+    TEST_ASSERT_FALSE(auth_cache_get(a.key, AUTH_CACHE_SESSION, NOW, NULL));
+    TEST_ASSERT_TRUE(auth_cache_get(b.key, AUTH_CACHE_SESSION, NOW, NULL));
+
+    auth_cache_invalidate_user(43);
+    TEST_ASSERT_TRUE(auth_cache_get(b.key, AUTH_CACHE_SESSION, NOW, NULL));
+    TEST_ASSERT_FALSE(auth_cache_get(c.key, AUTH_CACHE_SESSION, NOW, NULL));
+    TEST_ASSERT_FALSE(auth_cache_get(key.key, AUTH_CACHE_API_KEY, NOW, NULL));
+
+    auth_cache_invalidate_key(b.key, AUTH_CACHE_SESSION);
+    TEST_ASSERT_FALSE(auth_cache_get(b.key, AUTH_CACHE_SESSION, NOW, NULL));
+}
+
+void test_put_if_current_skips_entry_invalidated_while_loading(void) {
+    // A request misses, notes the generation and reads the session row...
+    auth_cache_entry_t loaded = make_session(12, 1, 44);
+    uint64_t generation = auth_cache_generation();
+
+    // ...the session is deleted before the request caches what it read
+    auth_cache_invalidate_session(loaded.session_id);
+
+    TEST_ASSERT_EQUAL_INT(1, auth_cache_put_if_current(&loaded, NOW, generation));
+    TEST_ASSERT_FALSE(auth_cache_get(loaded.key, AUTH_CACHE_SESSION, NOW, NULL));
+
+    // Same for an API key whose user changed
+    auth_cache_entry_t key = make_session(13, 1, 44);
+    key.kind = AUTH_CACHE_API_KEY;
+    key.session_id = 0;
+    generation = auth_cache_generation();
+    auth_cache_invalidate_user(44);
+    TEST_ASSERT_EQUAL_INT(1, auth_cache_put_if_current(&key, NOW, generation));
+    TEST_ASSERT_FALSE(auth_cache_get(key.key, AUTH_CACHE_API_KEY, NOW, NULL));
+
+    // Without an invalidation in between the entry is cached
+    generation = auth_cache_generation();
+    TEST_ASSERT_EQUAL_INT(0, auth_cache_put_if_current(&loaded, NOW, generation));
+    TEST_ASSERT_TRUE(auth_cache_get(loaded.key, AUTH_CACHE_SESSION, NOW, NULL));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_put_and_get);
+    RUN_TEST(test_expired_session_is_dropped);
+    RUN_TEST(test_stale_entry_is_a_miss);
+    RUN_TEST(test_record_activity_extends_idle_expiry_and_batches);
+    RUN_TEST(test_record_activity_reports_client_changes);
+    RUN_TEST(test_reload_keeps_unwritten_activity);
+    RUN_TEST(test_full_shard_never_evicts_unwritten_activity);
+    RUN_TEST(test_invalidation);
+    RUN_TEST(test_put_if_current_skips_entry_invalidated_while_loading);
+    return UNITY_END();
+}
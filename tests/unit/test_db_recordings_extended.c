@@ -196,6 +196,183 @@ void test_get_recording_metadata_paginated_supports_multi_value_detection_labels
     TEST_ASSERT_EQUAL_STRING("cam2", out[1].stream_name);
 }
 
+/* Counts filtered only by stream and time come from the per-day counters */
+void test_get_recording_count_day_counts_follow_inserts_updates_and_deletes(void) {
+    const time_t day = 86400;
+    const time_t base = (time_t)1700000000 - (time_t)1700000000 % day;
+
+    // 3 days x 4 recordings on cam1, 1 per day on cam2
+    uint64_t ids[12];
+    for (int i = 0; i < 12; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/day-%d.mp4", i);
+        recording_metadata_t m = make_rec("cam1", path, base + (i / 4) * day + (i % 4) * 3600);
+        ids[i] = add_recording_metadata(&m);
+    }
+    for (int i = 0; i < 3; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/day-cam2-%d.mp4", i);
+        recording_metadata_t m = make_rec("cam2", path, base + i * day);
+        add_recording_metadata(&m);
+    }
+
+    // An incomplete recording is not listed until it completes
+    recording_metadata_t open_rec = make_rec("cam1", "/rec/day-open.mp4", base + day + 7200 + 60);
+    open_rec.is_complete = false;
+    open_rec.end_time = 0;
+    uint64_t open_id = add_recording_metadata(&open_rec);
+
+    TEST_ASSERT_EQUAL_INT(15, get_recording_count(0, 0, NULL, 0, NULL, -1, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(12, get_recording_count(0, 0, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+
+    // Partial days at both ends: 2nd-4th recording of day 0, whole day 1, 1st-2nd of day 2
+    time_t from = base + 3600;
+    time_t to = base + 2 * day + 3600;
+    TEST_ASSERT_EQUAL_INT(9, get_recording_count(from, to, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(11, get_recording_count(from, to, NULL, 0, NULL, -1, NULL, 0, NULL, NULL));
+
+    // Both bounds inside one day
+    TEST_ASSERT_EQUAL_INT(2, get_recording_count(base + day + 1, base + day + 7200, "cam1",
+                                                 0, NULL, -1, NULL, 0, NULL, NULL));
+
+    // RBAC whitelist restricts the counters too
+    const char *allowed[] = { "cam2" };
+    TEST_ASSERT_EQUAL_INT(3, get_recording_count(0, 0, NULL, 0, NULL, -1, allowed, 1, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, update_recording_metadata(open_id, open_rec.start_time + 60, 1024, true));
+    TEST_ASSERT_EQUAL_INT(13, get_recording_count(0, 0, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, update_recording_start_time(ids[1], base - day + 60));
+    TEST_ASSERT_EQUAL_INT(9, get_recording_count(from, to, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(13, get_recording_count(0, 0, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, delete_recording_metadata(ids[5]));
+    TEST_ASSERT_EQUAL_INT(0, delete_recording_metadata(open_id));
+    TEST_ASSERT_EQUAL_INT(11, get_recording_count(0, 0, "cam1", 0, NULL, -1, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(14, get_recording_count(0, 0, NULL, 0, NULL, -1, NULL, 0, NULL, NULL));
+}
+
+/* Deep offsets skip whole days by the counters; pages must match a plain scan */
+void test_get_recording_metadata_paginated_deep_offset_matches_full_list(void) {
+    const time_t day = 86400;
+    const time_t base = (time_t)1700000000 - (time_t)1700000000 % day;
+
+    // 5 days, 5 recordings per day, two of them sharing a start time
+    for (int i = 0; i < 25; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/deep-%d.mp4", i);
+        int slot = i % 5;
+        recording_metadata_t m = make_rec(i % 2 ? "cam1" : "cam2", path,
+                                          base + (i / 5) * day + (slot == 4 ? 3 : slot) * 3600);
+        add_recording_metadata(&m);
+    }
+
+    const char *orders[] = { "desc", "asc" };
+    const time_t ranges[][2] = { { 0, 0 }, { base + 1800, base + 3 * day + 5400 } };
+    for (int o = 0; o < 2; o++) {
+        for (int r = 0; r < 2; r++) {
+            recording_metadata_t all[32];
+            int total = get_recording_metadata_paginated(ranges[r][0], ranges[r][1], NULL, 0, NULL, -1,
+                                                         "start_time", orders[o], all, 32, 0,
+                                                         NULL, 0, NULL, NULL);
+            TEST_ASSERT_EQUAL_INT(get_recording_count(ranges[r][0], ranges[r][1], NULL, 0, NULL, -1,
+                                                      NULL, 0, NULL, NULL), total);
+
+            for (int offset = 1; offset <= total; offset++) {
+                recording_metadata_t page[3];
+                int n = get_recording_metadata_paginated(ranges[r][0], ranges[r][1], NULL, 0, NULL, -1,
+                                                         "start_time", orders[o], page, 3, offset,
+                                                         NULL, 0, NULL, NULL);
+                int expected = total - offset < 3 ? total - offset : 3;
+                TEST_ASSERT_EQUAL_INT(expected, n);
+                for (int i = 0; i < n; i++) {
+                    TEST_ASSERT_EQUAL_UINT64(all[offset + i].id, page[i].id);
+                }
+            }
+        }
+    }
+}
+
+/* Keyset pages walk the list in (start_time, id) order without gaps or repeats */
+void test_get_recording_metadata_after_walks_all_pages(void) {
+    time_t now = time(NULL);
+    for (int i = 0; i < 7; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/rec/cursor-%d.mp4", i);
+        // Recordings 0-2 share a start time
+        recording_metadata_t m = make_rec("cam1", path, now - (i < 3 ? 0 : i) * 100);
+        add_recording_metadata(&m);
+    }
+
+    recording_metadata_t all[10];
+    int total = get_recording_metadata_paginated(0, 0, "cam1", 0, NULL, -1, "start_time", "desc",
+                                                 all, 10, 0, NULL, 0, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(7, total);
+
+    recording_cursor_t cursor;
+    const recording_cursor_t *after = NULL;
+    int seen = 0;
+    for (;;) {
+        recording_metadata_t page[2];
+        int n = get_recording_metadata_after(0, 0, "cam1", 0, NULL, -1, "desc", after,
+                                             page, 2, NULL, 0, NULL, NULL);
+        TEST_ASSERT_TRUE(n >= 0);
+        if (n == 0) break;
+        for (int i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT64(all[seen + i].id, page[i].id);
+        }
+        seen += n;
+        cursor.start_time = page[n - 1].start_time;
+        cursor.id = page[n - 1].id;
+        after = &cursor;
+    }
+    TEST_ASSERT_EQUAL_INT(7, seen);
+
+    // Ascending from the oldest recording returns the other six
+    cursor.start_time = all[6].start_time;
+    cursor.id = all[6].id;
+    recording_metadata_t asc[10];
+    int n = get_recording_metadata_after(0, 0, "cam1", 0, NULL, -1, "asc", &cursor,
+                                         asc, 10, NULL, 0, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(6, n);
+    TEST_ASSERT_EQUAL_UINT64(all[5].id, asc[0].id);
+    TEST_ASSERT_EQUAL_UINT64(all[0].id, asc[5].id);
+}
+
+/* Label filters see detections linked by time range, whichever was stored first */
+void test_detection_label_filter_matches_unlinked_detections_in_range(void) {
+    time_t now = time(NULL);
+    detection_result_t person = make_detection_result("person");
+    detection_result_t car = make_detection_result("car");
+
+    // Detection stored before its recording exists
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam1", &person, now + 10, 0));
+    recording_metadata_t rec1 = make_rec("cam1", "/rec/label-1.mp4", now);
+    uint64_t rec1_id = add_recording_metadata(&rec1);
+
+    // Detection stored after, without a recording id
+    recording_metadata_t rec2 = make_rec("cam1", "/rec/label-2.mp4", now + 120);
+    uint64_t rec2_id = add_recording_metadata(&rec2);
+    TEST_ASSERT_EQUAL_INT(0, store_detections_in_db("cam1", &car, now + 130, 0));
+
+    recording_metadata_t out[4];
+    int n = get_recording_metadata_paginated(0, 0, NULL, 0, "person", -1, "id", "asc",
+                                             out, 4, 0, NULL, 0, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_UINT64(rec1_id, out[0].id);
+
+    n = get_recording_metadata_paginated(0, 0, NULL, 0, "ca", -1, "id", "asc",
+                                         out, 4, 0, NULL, 0, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_UINT64(rec2_id, out[0].id);
+
+    TEST_ASSERT_EQUAL_INT(2, get_recording_count(0, 0, NULL, 0, "person,car", -1, NULL, 0, NULL, NULL));
+
+    // A deleted detection no longer matches even though the label index keeps it
+    sqlite3_exec(get_db_handle(), "DELETE FROM detections WHERE label = 'car';", NULL, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, get_recording_count(0, 0, NULL, 0, "car", -1, NULL, 0, NULL, NULL));
+}
+
 /* set_recording_retention_tier */
 void test_set_recording_retention_tier(void) {
     time_t now = time(NULL);
@@ -253,6 +430,10 @@ int main(void) {
     RUN_TEST(test_get_recording_count_supports_multi_value_stream_tag_and_capture_filters);
     RUN_TEST(test_get_recording_metadata_paginated);
     RUN_TEST(test_get_recording_metadata_paginated_supports_multi_value_detection_labels_and_tags);
+    RUN_TEST(test_get_recording_count_day_counts_follow_inserts_updates_and_deletes);
+    RUN_TEST(test_get_recording_metadata_paginated_deep_offset_matches_full_list);
+    RUN_TEST(test_get_recording_metadata_after_walks_all_pages);
+    RUN_TEST(test_detection_label_filter_matches_unlinked_detections_in_range);
     RUN_TEST(test_set_recording_retention_tier);
     RUN_TEST(test_set_recording_disk_pressure_eligible);
     RUN_TEST(test_set_recording_retention_override);
@@ -408,6 +408,85 @@ void test_sub_stream_url_in_get_all(void) {
     TEST_ASSERT_TRUE(found);
 }
 
+/* ================================================================
+ * detection decode mode fields
+ * ================================================================ */
+
+void test_detection_decode_mode_defaults_keyframes(void) {
+    stream_config_t s = make_stream("cam_dec_def", true);
+    add_stream_config(&s);
+
+    stream_config_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("cam_dec_def", &got));
+    TEST_ASSERT_EQUAL_STRING("keyframes", got.detection_decode_mode);
+}
+
+void test_detection_decode_mode_round_trip(void) {
+    stream_config_t s = make_stream("cam_dec_rt", true);
+    safe_strcpy(s.detection_decode_mode, "gop", sizeof(s.detection_decode_mode), 0);
+    s.detection_decode_gop_interval = 4;
+    add_stream_config(&s);
+
+    stream_config_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("cam_dec_rt", &got));
+    TEST_ASSERT_EQUAL_STRING("gop", got.detection_decode_mode);
+    TEST_ASSERT_EQUAL_INT(4, got.detection_decode_gop_interval);
+}
+
+void test_detection_decode_mode_update(void) {
+    stream_config_t s = make_stream("cam_dec_upd", true);
+    safe_strcpy(s.detection_decode_mode, "gop", sizeof(s.detection_decode_mode), 0);
+    s.detection_decode_gop_interval = 3;
+    add_stream_config(&s);
+
+    safe_strcpy(s.detection_decode_mode, "full", sizeof(s.detection_decode_mode), 0);
+    s.detection_decode_gop_interval = 1;
+    TEST_ASSERT_EQUAL_INT(0, update_stream_config("cam_dec_upd", &s));
+
+    stream_config_t out[10];
+    int n = get_all_stream_configs(out, 10);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_STRING("full", out[0].detection_decode_mode);
+    TEST_ASSERT_EQUAL_INT(1, out[0].detection_decode_gop_interval);
+}
+
+/* ================================================================
+ * recording format field
+ * ================================================================ */
+
+void test_recording_format_defaults_mp4(void) {
+    stream_config_t s = make_stream("cam_fmt_def", true);
+    add_stream_config(&s);
+
+    stream_config_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("cam_fmt_def", &got));
+    TEST_ASSERT_EQUAL_STRING("mp4", got.recording_format);
+}
+
+void test_recording_format_round_trip(void) {
+    stream_config_t s = make_stream("cam_fmt_rt", true);
+    safe_strcpy(s.recording_format, "fmp4", sizeof(s.recording_format), 0);
+    add_stream_config(&s);
+
+    stream_config_t got;
+    TEST_ASSERT_EQUAL_INT(0, get_stream_config_by_name("cam_fmt_rt", &got));
+    TEST_ASSERT_EQUAL_STRING("fmp4", got.recording_format);
+}
+
+void test_recording_format_update(void) {
+    stream_config_t s = make_stream("cam_fmt_upd", true);
+    safe_strcpy(s.recording_format, "fmp4", sizeof(s.recording_format), 0);
+    add_stream_config(&s);
+
+    safe_strcpy(s.recording_format, "mp4", sizeof(s.recording_format), 0);
+    TEST_ASSERT_EQUAL_INT(0, update_stream_config("cam_fmt_upd", &s));
+
+    stream_config_t out[10];
+    int n = get_all_stream_configs(out, 10);
+    TEST_ASSERT_EQUAL_INT(1, n);
+    TEST_ASSERT_EQUAL_STRING("mp4", out[0].recording_format);
+}
+
 void test_repair_onvif_embedded_credentials_migration_normalizes_legacy_rows(void) {
     sqlite3 *db = get_db_handle();
     exec_sql_or_fail(db, "DELETE FROM streams;");
@@ -469,6 +548,12 @@ int main(void) {
     RUN_TEST(test_sub_stream_url_round_trip);
     RUN_TEST(test_sub_stream_url_update);
     RUN_TEST(test_sub_stream_url_in_get_all);
+    RUN_TEST(test_detection_decode_mode_defaults_keyframes);
+    RUN_TEST(test_detection_decode_mode_round_trip);
+    RUN_TEST(test_detection_decode_mode_update);
+    RUN_TEST(test_recording_format_defaults_mp4);
+    RUN_TEST(test_recording_format_round_trip);
+    RUN_TEST(test_recording_format_update);
 
     int result = UNITY_END();
     shutdown_database();
@@ -0,0 +1,160 @@
+/**
+ * @file test_frame_bus.c
+ * @brief Layer 2 Unity tests for video/frame_bus.c
+ *
+ * Covers publish/subscribe without a publisher or subscriber, zero-copy
+ * delivery, per-subscriber intervals, scaling, and slot release on
+ * unsubscribe.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libavutil/frame.h>
+
+#include "unity.h"
+#include "video/frame_bus.h"
+
+static AVFrame *make_gray_frame(int width, int height, uint8_t value) {
+    AVFrame *frame = av_frame_alloc();
+    TEST_ASSERT_NOT_NULL(frame);
+    frame->width = width;
+    frame->height = height;
+    frame->format = AV_PIX_FMT_GRAY8;
+    TEST_ASSERT_EQUAL_INT(0, av_frame_get_buffer(frame, 0));
+    for (int y = 0; y < height; y++) {
+        memset(frame->data[0] + (size_t)y * frame->linesize[0], value, (size_t)width);
+    }
+    return frame;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_publish_without_subscribers_is_dropped(void) {
+    AVFrame *frame = make_gray_frame(16, 16, 10);
+
+    TEST_ASSERT_FALSE(frame_bus_wants_frame("fb_none"));
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_publish("fb_none", frame));
+
+    frame_bus_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(-1, frame_bus_get_stats("fb_none", &stats));
+
+    av_frame_free(&frame);
+}
+
+void test_subscriber_gets_zero_copy_reference(void) {
+    frame_bus_subscriber_t *sub = frame_bus_subscribe("fb_ref", NULL);
+    TEST_ASSERT_NOT_NULL(sub);
+    TEST_ASSERT_NULL(frame_bus_acquire(sub));
+    TEST_ASSERT_TRUE(frame_bus_wants_frame("fb_ref"));
+
+    AVFrame *frame = make_gray_frame(16, 16, 42);
+    TEST_ASSERT_EQUAL_INT(1, frame_bus_publish("fb_ref", frame));
+
+    AVFrame *got = frame_bus_acquire(sub);
+    TEST_ASSERT_NOT_NULL(got);
+    TEST_ASSERT_EQUAL_PTR(frame->data[0], got->data[0]);
+    TEST_ASSERT_EQUAL_INT(16, got->width);
+
+    // Same frame is not delivered twice
+    TEST_ASSERT_NULL(frame_bus_acquire(sub));
+
+    frame_bus_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_get_stats("fb_ref", &stats));
+    TEST_ASSERT_EQUAL_INT(1, stats.subscribers);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.frames_published);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.frames_delivered);
+
+    av_frame_free(&got);
+    av_frame_free(&frame);
+    frame_bus_unsubscribe(sub);
+}
+
+void test_interval_limits_publish_and_delivery(void) {
+    frame_bus_sub_config_t cfg = { .interval_ms = 200, .pix_fmt = AV_PIX_FMT_NONE };
+    frame_bus_subscriber_t *sub = frame_bus_subscribe("fb_rate", &cfg);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    AVFrame *frame = make_gray_frame(8, 8, 1);
+    TEST_ASSERT_EQUAL_INT(1, frame_bus_publish("fb_rate", frame));
+
+    AVFrame *got = frame_bus_acquire(sub);
+    TEST_ASSERT_NOT_NULL(got);
+    av_frame_free(&got);
+
+    // Too soon: the bus drops the frame instead of retaining it
+    TEST_ASSERT_FALSE(frame_bus_wants_frame("fb_rate"));
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_publish("fb_rate", frame));
+
+    usleep(250 * 1000);
+    TEST_ASSERT_TRUE(frame_bus_wants_frame("fb_rate"));
+    TEST_ASSERT_EQUAL_INT(1, frame_bus_publish("fb_rate", frame));
+
+    got = frame_bus_acquire_wait(sub, 500);
+    TEST_ASSERT_NOT_NULL(got);
+    av_frame_free(&got);
+
+    av_frame_free(&frame);
+    frame_bus_unsubscribe(sub);
+}
+
+void test_subscriber_scaling(void) {
+    frame_bus_sub_config_t cfg = { .width = 8, .height = 4, .pix_fmt = AV_PIX_FMT_GRAY8 };
+    frame_bus_subscriber_t *sub = frame_bus_subscribe("fb_scale", &cfg);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    AVFrame *frame = make_gray_frame(32, 16, 200);
+    TEST_ASSERT_EQUAL_INT(1, frame_bus_publish("fb_scale", frame));
+
+    AVFrame *got = frame_bus_acquire(sub);
+    TEST_ASSERT_NOT_NULL(got);
+    TEST_ASSERT_EQUAL_INT(8, got->width);
+    TEST_ASSERT_EQUAL_INT(4, got->height);
+    TEST_ASSERT_TRUE(got->data[0] != frame->data[0]);
+    TEST_ASSERT_UINT8_WITHIN(2, 200, got->data[0][0]);
+
+    av_frame_free(&got);
+    av_frame_free(&frame);
+    frame_bus_unsubscribe(sub);
+}
+
+void test_acquire_wait_times_out(void) {
+    frame_bus_subscriber_t *sub = frame_bus_subscribe("fb_wait", NULL);
+    TEST_ASSERT_NOT_NULL(sub);
+    TEST_ASSERT_NULL(frame_bus_acquire_wait(sub, 50));
+    frame_bus_unsubscribe(sub);
+}
+
+void test_unsubscribe_releases_stream(void) {
+    frame_bus_subscriber_t *a = frame_bus_subscribe("fb_rel", NULL);
+    frame_bus_subscriber_t *b = frame_bus_subscribe("fb_rel", NULL);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+
+    frame_bus_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, frame_bus_get_stats("fb_rel", &stats));
+    TEST_ASSERT_EQUAL_INT(2, stats.subscribers);
+
+    frame_bus_unsubscribe(a);
+    TEST_ASSERT_TRUE(frame_bus_wants_frame("fb_rel"));
+
+    frame_bus_unsubscribe(b);
+    TEST_ASSERT_FALSE(frame_bus_wants_frame("fb_rel"));
+    TEST_ASSERT_EQUAL_INT(-1, frame_bus_get_stats("fb_rel", &stats));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_without_subscribers_is_dropped);
+    RUN_TEST(test_subscriber_gets_zero_copy_reference);
+    RUN_TEST(test_interval_limits_publish_and_delivery);
+    RUN_TEST(test_subscriber_scaling);
+    RUN_TEST(test_acquire_wait_times_out);
+    RUN_TEST(test_unsubscribe_releases_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_hls_ll_playlist.c
+ * @brief Layer 2 Unity tests for video/hls/hls_ll_playlist.c
+ *
+ * Covers the rendered LL-HLS playlist (server control, parts, preload hint),
+ * the segment window, which segments keep their parts listed, target
+ * duration growth, and the blocking-request decision for _HLS_msn/_HLS_part.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "video/hls/hls_ll_playlist.h"
+
+static hls_ll_playlist_t g_pl;
+static char g_buf[16384];
+
+/* ---- helpers ---- */
+
+static void add_segment(int parts, double part_duration) {
+    for (int i = 0; i < parts; i++) {
+        TEST_ASSERT_EQUAL_INT(i, hls_ll_playlist_add_part(&g_pl, part_duration, i == 0));
+    }
+    TEST_ASSERT_TRUE(hls_ll_playlist_end_segment(&g_pl) >= 0);
+}
+
+static const char *render(void) {
+    TEST_ASSERT_TRUE(hls_ll_playlist_render(&g_pl, g_buf, sizeof(g_buf)) > 0);
+    return g_buf;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_ll_playlist_init(&g_pl, 2, 0.5, 4, 64));
+}
+
+void tearDown(void) {
+    hls_ll_playlist_free(&g_pl);
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_init_rejects_bad_parameters(void) {
+    hls_ll_playlist_t pl;
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_init(&pl, 0, 0.5, 4, 16));
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_init(&pl, 2, 0.0, 4, 16));
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_init(&pl, 2, 0.5, 0, 16));
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_init(NULL, 2, 0.5, 4, 16));
+}
+
+void test_empty_playlist_has_server_control_and_hint(void) {
+    const char *out = render();
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-TARGETDURATION:2\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.500\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-PART-INF:PART-TARGET=0.500\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-MEDIA-SEQUENCE:0\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"part_0_0.ts\"\n"));
+    TEST_ASSERT_NULL(strstr(out, "#EXTINF"));
+}
+
+void test_parts_of_segment_being_built_are_listed(void) {
+    hls_ll_playlist_add_part(&g_pl, 0.5, true);
+    hls_ll_playlist_add_part(&g_pl, 0.48, false);
+
+    const char *out = render();
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-PART:DURATION=0.50000,URI=\"part_0_0.ts\",INDEPENDENT=YES\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-PART:DURATION=0.48000,URI=\"part_0_1.ts\"\n"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "URI=\"part_0_2.ts\"\n"));
+}
+
+void test_completed_segment_follows_its_parts(void) {
+    add_segment(4, 0.5);
+
+    const char *out = render();
+    const char *last_part = strstr(out, "part_0_3.ts");
+    const char *segment = strstr(out, "#EXTINF:2.00000,\nsegment_0.ts\n");
+    TEST_ASSERT_NOT_NULL(last_part);
+    TEST_ASSERT_NOT_NULL(segment);
+    TEST_ASSERT_TRUE(last_part < segment);
+    TEST_ASSERT_NOT_NULL(strstr(out, "URI=\"part_1_0.ts\"\n"));
+}
+
+void test_window_slides_media_sequence(void) {
+    for (int i = 0; i < 6; i++) {
+        add_segment(4, 0.5);
+    }
+
+    const char *out = render();
+    TEST_ASSERT_NOT_NULL(strstr(out, "#EXT-X-MEDIA-SEQUENCE:2\n"));
+    TEST_ASSERT_NULL(strstr(out, "segment_1.ts"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "segment_2.ts"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "segment_5.ts"));
+}
+
+void test_old_segments_drop_their_parts(void) {
+    for (int i = 0; i < 4; i++) {
+        add_segment(4, 0.5);
+    }
+
+    // Segments 1-3 end within three target durations (6 s) of the live edge
+    const char *out = render();
+    TEST_ASSERT_NULL(strstr(out, "part_0_"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "segment_0.ts"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "part_1_0.ts"));
+    TEST_ASSERT_NOT_NULL(strstr(out, "part_3_3.ts"));
+}
+
+void test_parts_limited_to_what_the_store_keeps(void) {
+    hls_ll_playlist_t pl;
+    TEST_ASSERT_EQUAL_INT(0, hls_ll_playlist_init(&pl, 2, 0.5, 4, 6));
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < 4; i++) {
+            hls_ll_playlist_add_part(&pl, 0.5, i == 0);
+        }
+        hls_ll_playlist_end_segment(&pl);
+    }
+    hls_ll_playlist_add_part(&pl, 0.5, true);
+
+    // One current part leaves room for one whole segment's parts only
+    TEST_ASSERT_TRUE(hls_ll_playlist_render(&pl, g_buf, sizeof(g_buf)) > 0);
+    TEST_ASSERT_NULL(strstr(g_buf, "part_0_"));
+    TEST_ASSERT_NOT_NULL(strstr(g_buf, "part_1_3.ts"));
+    TEST_ASSERT_NOT_NULL(strstr(g_buf, "part_2_0.ts"));
+    hls_ll_playlist_free(&pl);
+}
+
+void test_long_segment_raises_target_duration(void) {
+    add_segment(6, 0.5);
+    TEST_ASSERT_NOT_NULL(strstr(render(), "#EXT-X-TARGETDURATION:3\n"));
+
+    // It never shrinks back
+    add_segment(2, 0.5);
+    TEST_ASSERT_NOT_NULL(strstr(render(), "#EXT-X-TARGETDURATION:3\n"));
+}
+
+void test_segment_part_limit(void) {
+    for (int i = 0; i < HLS_LL_MAX_PARTS; i++) {
+        TEST_ASSERT_EQUAL_INT(i, hls_ll_playlist_add_part(&g_pl, 0.01, false));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_add_part(&g_pl, 0.01, false));
+
+    // Ending an empty segment is refused
+    TEST_ASSERT_EQUAL_INT64(0, hls_ll_playlist_end_segment(&g_pl));
+    TEST_ASSERT_EQUAL_INT64(-1, hls_ll_playlist_end_segment(&g_pl));
+}
+
+void test_render_reports_small_buffer(void) {
+    char small[32];
+    TEST_ASSERT_EQUAL_INT(-1, hls_ll_playlist_render(&g_pl, small, sizeof(small)));
+}
+
+void test_request_state(void) {
+    // Segment 5 being built with two parts published
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_READY, hls_ll_playlist_request_state(5, 2, 4, -1));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_READY, hls_ll_playlist_request_state(5, 2, 4, 9));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_READY, hls_ll_playlist_request_state(5, 2, 5, 1));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_WAIT, hls_ll_playlist_request_state(5, 2, 5, 2));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_WAIT, hls_ll_playlist_request_state(5, 2, 5, -1));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_WAIT, hls_ll_playlist_request_state(5, 2, 7, 0));
+    TEST_ASSERT_EQUAL_INT(HLS_LL_REQUEST_INVALID, hls_ll_playlist_request_state(5, 2, 8, 0));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_rejects_bad_parameters);
+    RUN_TEST(test_empty_playlist_has_server_control_and_hint);
+    RUN_TEST(test_parts_of_segment_being_built_are_listed);
+    RUN_TEST(test_completed_segment_follows_its_parts);
+    RUN_TEST(test_window_slides_media_sequence);
+    RUN_TEST(test_old_segments_drop_their_parts);
+    RUN_TEST(test_parts_limited_to_what_the_store_keeps);
+    RUN_TEST(test_long_segment_raises_target_duration);
+    RUN_TEST(test_segment_part_limit);
+    RUN_TEST(test_render_reports_small_buffer);
+    RUN_TEST(test_request_state);
+    return UNITY_END();
+}
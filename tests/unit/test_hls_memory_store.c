@@ -0,0 +1,291 @@
+/**
+ * @file test_hls_memory_store.c
+ * @brief Layer 2 Unity tests for video/hls/hls_memory_store.c
+ *
+ * Covers playlist replacement, the segment ring evicting the oldest segment,
+ * in-place rewrites, readers copying while a segment is replaced, spilling
+ * evicted segments to disk (and expiring them), closing a store, and the
+ * low-latency part ring with its published position and listener.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "unity.h"
+#include "video/hls/hls_memory_store.h"
+
+#define TEST_STREAM "hls_mem_cam"
+#define SPILL_DIR "/tmp/lightnvr_unit_hls_spill"
+
+/* ---- helpers ---- */
+
+static void put_text(const char *file_name, const char *text) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_put(TEST_STREAM, file_name,
+                                                  (const unsigned char *)text, strlen(text)));
+}
+
+static bool in_memory(const char *file_name) {
+    unsigned char *data = NULL;
+    size_t size = 0;
+    if (hls_memory_store_get(TEST_STREAM, file_name, &data, &size) != 0) {
+        return false;
+    }
+    free(data);
+    return true;
+}
+
+static int g_listener_calls = 0;
+
+static void count_listener_call(void) {
+    g_listener_calls++;
+}
+
+static bool spilled(const char *file_name) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", SPILL_DIR, file_name);
+    return access(path, F_OK) == 0;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    mkdir(SPILL_DIR, 0755);
+}
+
+void tearDown(void) {
+    hls_memory_store_set_listener(NULL);
+    hls_memory_store_close_all();
+    rmdir(SPILL_DIR);
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_put_requires_an_open_store(void) {
+    TEST_ASSERT_FALSE(hls_memory_store_is_open(TEST_STREAM));
+    TEST_ASSERT_EQUAL_INT(-1, hls_memory_store_put(TEST_STREAM, "index.m3u8",
+                                                   (const unsigned char *)"x", 1));
+
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+    TEST_ASSERT_TRUE(hls_memory_store_is_open(TEST_STREAM));
+}
+
+void test_playlist_is_replaced(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+    put_text("index.m3u8", "#EXTM3U\n#first\n");
+    put_text("index.m3u8", "#EXTM3U\n#second\n");
+
+    unsigned char *data = NULL;
+    size_t size = 0;
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_get(TEST_STREAM, "index.m3u8", &data, &size));
+    TEST_ASSERT_EQUAL_size_t(strlen("#EXTM3U\n#second\n"), size);
+    TEST_ASSERT_EQUAL_MEMORY("#EXTM3U\n#second\n", data, size);
+    free(data);
+
+    size_t bytes = 0;
+    hls_memory_store_get_usage(NULL, &bytes);
+    TEST_ASSERT_EQUAL_size_t(strlen("#EXTM3U\n#second\n"), bytes);
+}
+
+void test_oldest_segment_is_evicted(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+    put_text("segment_0.ts", "aaaa");
+    put_text("segment_1.ts", "bbbb");
+    put_text("segment_2.ts", "cccc");
+    put_text("segment_3.ts", "dddd");
+
+    TEST_ASSERT_FALSE(in_memory("segment_0.ts"));
+    TEST_ASSERT_TRUE(in_memory("segment_1.ts"));
+    TEST_ASSERT_TRUE(in_memory("segment_2.ts"));
+    TEST_ASSERT_TRUE(in_memory("segment_3.ts"));
+
+    int streams = 0;
+    size_t bytes = 0;
+    hls_memory_store_get_usage(&streams, &bytes);
+    TEST_ASSERT_EQUAL_INT(1, streams);
+    TEST_ASSERT_EQUAL_size_t(12, bytes);
+}
+
+void test_rewritten_segment_is_replaced_in_place(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 2, NULL, 0));
+    put_text("segment_0.ts", "old");
+    put_text("segment_1.ts", "bbbb");
+    put_text("segment_0.ts", "new!");
+
+    // The rewrite must not have pushed segment_1 out
+    TEST_ASSERT_TRUE(in_memory("segment_1.ts"));
+
+    unsigned char *data = NULL;
+    size_t size = 0;
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_get(TEST_STREAM, "segment_0.ts", &data, &size));
+    TEST_ASSERT_EQUAL_MEMORY("new!", data, 4);
+    free(data);
+}
+
+#define CHURN_SEGMENT_SIZE (256 * 1024)
+#define CHURN_ROUNDS 200
+
+// Rewrites and evicts segments filled with one byte value per round
+static void *churn_segments(void *arg) {
+    unsigned char *buf = arg;
+    char name[32];
+    for (int round = 0; round < CHURN_ROUNDS; round++) {
+        memset(buf, round & 0xFF, CHURN_SEGMENT_SIZE);
+        snprintf(name, sizeof(name), "segment_%d.ts", round % 3);
+        hls_memory_store_put(TEST_STREAM, name, buf, CHURN_SEGMENT_SIZE);
+    }
+    return NULL;
+}
+
+void test_reader_copy_survives_replacement(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 2, NULL, 0));
+
+    unsigned char *buf = malloc(CHURN_SEGMENT_SIZE);
+    TEST_ASSERT_NOT_NULL(buf);
+    pthread_t writer;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, churn_segments, buf));
+
+    // Every copy is one whole segment, never a mix of two
+    bool consistent = true;
+    for (int i = 0; i < CHURN_ROUNDS; i++) {
+        unsigned char *data = NULL;
+        size_t size = 0;
+        if (hls_memory_store_get(TEST_STREAM, "segment_1.ts", &data, &size) == 0) {
+            consistent = consistent && size == CHURN_SEGMENT_SIZE &&
+                         memcmp(data, data + 1, size - 1) == 0;
+            free(data);
+        }
+    }
+
+    pthread_join(writer, NULL);
+    free(buf);
+    TEST_ASSERT_TRUE(consistent);
+}
+
+void test_evicted_segments_spill_to_disk_and_expire(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 2, SPILL_DIR, 2));
+    put_text("segment_0.ts", "s0");
+    put_text("segment_1.ts", "s1");
+    put_text("segment_2.ts", "s2");
+    put_text("segment_3.ts", "s3");
+
+    TEST_ASSERT_TRUE(spilled("segment_0.ts"));
+    TEST_ASSERT_TRUE(spilled("segment_1.ts"));
+    TEST_ASSERT_FALSE(spilled("segment_2.ts"));
+
+    // A third spill pushes the oldest spilled segment off the disk
+    put_text("segment_4.ts", "s4");
+    TEST_ASSERT_FALSE(spilled("segment_0.ts"));
+    TEST_ASSERT_TRUE(spilled("segment_1.ts"));
+    TEST_ASSERT_TRUE(spilled("segment_2.ts"));
+
+    // Spilled segments are no longer served from memory
+    TEST_ASSERT_FALSE(in_memory("segment_2.ts"));
+    TEST_ASSERT_TRUE(in_memory("segment_4.ts"));
+
+    // Closing deletes what was spilled
+    hls_memory_store_close(TEST_STREAM);
+    TEST_ASSERT_FALSE(spilled("segment_1.ts"));
+    TEST_ASSERT_FALSE(spilled("segment_2.ts"));
+}
+
+void test_close_drops_the_store(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+    put_text("index.m3u8", "#EXTM3U\n");
+    hls_memory_store_close(TEST_STREAM);
+
+    TEST_ASSERT_FALSE(hls_memory_store_is_open(TEST_STREAM));
+    TEST_ASSERT_FALSE(in_memory("index.m3u8"));
+
+    int streams = -1;
+    hls_memory_store_get_usage(&streams, NULL);
+    TEST_ASSERT_EQUAL_INT(0, streams);
+
+    // Closing an unknown stream is harmless
+    hls_memory_store_close("missing");
+}
+
+void test_reopen_resets_contents(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+    put_text("segment_0.ts", "data");
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 3, NULL, 0));
+
+    TEST_ASSERT_FALSE(in_memory("segment_0.ts"));
+    int streams = 0;
+    hls_memory_store_get_usage(&streams, NULL);
+    TEST_ASSERT_EQUAL_INT(1, streams);
+}
+
+void test_parts_use_their_own_ring(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 2, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_enable_parts(TEST_STREAM, 3, 2));
+    TEST_ASSERT_EQUAL_INT(-1, hls_memory_store_enable_parts(TEST_STREAM, 3, 2));
+
+    put_text("segment_0.ts", "s0");
+    put_text("part_1_0.ts", "p0");
+    put_text("part_1_1.ts", "p1");
+    put_text("part_1_2.ts", "p2");
+    put_text("part_1_3.ts", "p3");
+
+    // Parts never push segments out, and only the newest parts are kept
+    TEST_ASSERT_TRUE(in_memory("segment_0.ts"));
+    TEST_ASSERT_FALSE(in_memory("part_1_0.ts"));
+    TEST_ASSERT_TRUE(in_memory("part_1_1.ts"));
+    TEST_ASSERT_TRUE(in_memory("part_1_3.ts"));
+}
+
+void test_position_is_published_and_notified(void) {
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_open(TEST_STREAM, 2, NULL, 0));
+    hls_memory_store_set_listener(count_listener_call);
+    g_listener_calls = 0;
+
+    // Not a low-latency store: no position to report
+    TEST_ASSERT_EQUAL_INT(-1, hls_memory_store_get_position(TEST_STREAM, NULL, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_enable_parts(TEST_STREAM, 8, 2));
+    TEST_ASSERT_EQUAL_INT(-1, hls_memory_store_get_position(TEST_STREAM, NULL, NULL, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_set_position(TEST_STREAM, 7, 3));
+    TEST_ASSERT_EQUAL_INT(1, g_listener_calls);
+
+    int64_t msn = 0;
+    int parts = 0;
+    int target = 0;
+    TEST_ASSERT_EQUAL_INT(0, hls_memory_store_get_position(TEST_STREAM, &msn, &parts, &target));
+    TEST_ASSERT_EQUAL_INT64(7, msn);
+    TEST_ASSERT_EQUAL_INT(3, parts);
+    TEST_ASSERT_EQUAL_INT(2, target);
+
+    // Closing wakes whoever waits on the stream
+    hls_memory_store_close(TEST_STREAM);
+    TEST_ASSERT_EQUAL_INT(2, g_listener_calls);
+    TEST_ASSERT_EQUAL_INT(-1, hls_memory_store_set_position(TEST_STREAM, 8, 0));
+    TEST_ASSERT_EQUAL_INT(2, g_listener_calls);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_put_requires_an_open_store);
+    RUN_TEST(test_playlist_is_replaced);
+    RUN_TEST(test_oldest_segment_is_evicted);
+    RUN_TEST(test_rewritten_segment_is_replaced_in_place);
+    RUN_TEST(test_reader_copy_survives_replacement);
+    RUN_TEST(test_evicted_segments_spill_to_disk_and_expire);
+    RUN_TEST(test_close_drops_the_store);
+    RUN_TEST(test_reopen_resets_contents);
+    RUN_TEST(test_parts_use_their_own_ring);
+    RUN_TEST(test_position_is_published_and_notified);
+    return UNITY_END();
+}
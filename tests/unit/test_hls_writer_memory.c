@@ -0,0 +1,140 @@
+/**
+ * @file test_hls_writer_memory.c
+ * @brief Layer 2 Unity tests for the in-memory output of video/hls_writer.c
+ *
+ * Runs the real FFmpeg HLS muxer through the writer's memory hooks and checks
+ * that the playlist and its segments land in the HLS memory store under
+ * their final names, with nothing written to the HLS directory.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+
+#include "unity.h"
+#include "core/config.h"
+#include "utils/strings.h"
+#include "video/hls_writer.h"
+#include "video/hls/hls_memory_store.h"
+
+#define TEST_STREAM "hls_writer_mem_cam"
+#define TEST_STORAGE "/tmp/lightnvr_unit_hls_writer"
+
+static AVFormatContext *input_ctx;
+static AVStream *input_stream;
+
+/* ---- helpers ---- */
+
+/* One Annex B access unit: an IDR slice when keyframe, otherwise a P slice */
+static void write_frame(hls_writer_t *writer, int64_t pts, bool keyframe) {
+    static const uint8_t idr[] = { 0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x00, 0x33, 0xFF };
+    static const uint8_t p[]   = { 0x00, 0x00, 0x00, 0x01, 0x41, 0x9A, 0x02, 0x04, 0x0C, 0xFF };
+
+    AVPacket *pkt = av_packet_alloc();
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, av_new_packet(pkt, (int)sizeof(idr)));
+    memcpy(pkt->data, keyframe ? idr : p, sizeof(idr));
+    pkt->pts = pts;
+    pkt->dts = pts;
+    pkt->duration = 9000;
+    if (keyframe)
+        pkt->flags |= AV_PKT_FLAG_KEY;
+
+    TEST_ASSERT_EQUAL_INT(0, hls_writer_write_packet(writer, pkt, input_stream));
+    av_packet_free(&pkt);
+}
+
+static char *get_text(const char *file_name) {
+    unsigned char *data = NULL;
+    size_t size = 0;
+    if (hls_memory_store_get(TEST_STREAM, file_name, &data, &size) != 0) {
+        return NULL;
+    }
+    char *text = malloc(size + 1);
+    TEST_ASSERT_NOT_NULL(text);
+    memcpy(text, data, size);
+    text[size] = '\0';
+    free(data);
+    return text;
+}
+
+static bool on_disk(const char *file_name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/hls/%s/%s", TEST_STORAGE, TEST_STREAM, file_name);
+    return access(path, F_OK) == 0;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    load_default_config(&g_config);
+    safe_strcpy(g_config.storage_path, TEST_STORAGE, sizeof(g_config.storage_path), 0);
+    g_config.storage_path_hls[0] = '\0';
+    g_config.hls_memory_store = true;
+    g_config.hls_memory_segments = 3;
+    g_config.hls_spill_segments = 0;
+    g_config.hls_low_latency = false;
+
+    input_ctx = avformat_alloc_context();
+    TEST_ASSERT_NOT_NULL(input_ctx);
+    input_stream = avformat_new_stream(input_ctx, NULL);
+    TEST_ASSERT_NOT_NULL(input_stream);
+    input_stream->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    input_stream->codecpar->codec_id = AV_CODEC_ID_H264;
+    input_stream->codecpar->width = 320;
+    input_stream->codecpar->height = 240;
+    input_stream->time_base = (AVRational){ 1, 90000 };
+}
+
+void tearDown(void) {
+    hls_memory_store_close_all();
+    avformat_free_context(input_ctx);
+    input_ctx = NULL;
+    input_stream = NULL;
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_muxer_publishes_playlist_and_segments_to_the_store(void) {
+    hls_writer_t *writer = hls_writer_create(TEST_STORAGE "/hls/" TEST_STREAM, TEST_STREAM, 1);
+    TEST_ASSERT_NOT_NULL(writer);
+    TEST_ASSERT_TRUE(writer->memory_mode);
+
+    /* 4 s at 10 fps with a keyframe every second: cuts three 1 s segments */
+    for (int frame = 0; frame < 40; frame++) {
+        write_frame(writer, (int64_t)frame * 9000, frame % 10 == 0);
+    }
+
+    char *playlist = get_text("index.m3u8");
+    TEST_ASSERT_NOT_NULL_MESSAGE(playlist, "playlist was not published to the store");
+    TEST_ASSERT_NOT_NULL(strstr(playlist, "#EXTM3U"));
+    TEST_ASSERT_NOT_NULL(strstr(playlist, "\nsegment_0.ts"));
+    TEST_ASSERT_NULL(strstr(playlist, "nvrmem:"));
+    free(playlist);
+
+    char *segment = get_text("segment_0.ts");
+    TEST_ASSERT_NOT_NULL(segment);
+    free(segment);
+
+    TEST_ASSERT_NULL(get_text("index.m3u8.tmp"));
+    TEST_ASSERT_FALSE(on_disk("index.m3u8"));
+    TEST_ASSERT_FALSE(on_disk("index.m3u8.tmp"));
+    TEST_ASSERT_FALSE(on_disk("segment_0.ts"));
+
+    hls_writer_close(writer);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_muxer_publishes_playlist_and_segments_to_the_store);
+    return UNITY_END();
+}
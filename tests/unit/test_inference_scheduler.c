@@ -0,0 +1,397 @@
+/**
+ * @file test_inference_scheduler.c
+ * @brief Layer 2 Unity tests for video/inference_scheduler.c
+ *
+ * Runs the scheduler against a fake backend whose detect call can be held
+ * open, so frames pile up behind it.  Covers batching by model, priority
+ * order, deadline and superseded drops, load failures, shutdown, parallel
+ * instances of one model and the statistics.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "video/inference_scheduler.h"
+
+/* ---- fake backend ---- */
+
+#define MAX_CALLS 32
+
+static pthread_mutex_t fake_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fake_cond = PTHREAD_COND_INITIALIZER;
+static bool gate_closed;
+static int calls;
+static int call_sizes[MAX_CALLS];
+static char call_models[MAX_CALLS][64];
+static int loads;
+static int unloads;
+
+static detection_model_t fake_load(const char *model_path, float threshold) {
+    (void)threshold;
+    if (strcmp(model_path, "missing.sod") == 0) {
+        return NULL;
+    }
+    pthread_mutex_lock(&fake_mutex);
+    loads++;
+    pthread_mutex_unlock(&fake_mutex);
+    return strdup(model_path);
+}
+
+static void fake_unload(detection_model_t model) {
+    pthread_mutex_lock(&fake_mutex);
+    unloads++;
+    pthread_mutex_unlock(&fake_mutex);
+    free(model);
+}
+
+// Each frame reports its width as the detection count
+static void fake_detect_batch(detection_model_t model, const inference_frame_t *frames, int count,
+                              detection_result_t *results, int *status) {
+    pthread_mutex_lock(&fake_mutex);
+    if (calls < MAX_CALLS) {
+        call_sizes[calls] = count;
+        snprintf(call_models[calls], sizeof(call_models[calls]), "%s", (const char *)model);
+    }
+    calls++;
+    pthread_cond_broadcast(&fake_cond);
+    while (gate_closed) {
+        pthread_cond_wait(&fake_cond, &fake_mutex);
+    }
+    pthread_mutex_unlock(&fake_mutex);
+
+    for (int i = 0; i < count; i++) {
+        results[i].count = frames[i].width;
+        status[i] = 0;
+    }
+}
+
+static const inference_backend_t fake_backend = {
+    .load = fake_load,
+    .unload = fake_unload,
+    .detect_batch = fake_detect_batch,
+};
+
+/* ---- helpers ---- */
+
+static const unsigned char pixels[16];
+
+typedef struct {
+    char stream_name[32];
+    inference_request_t req;
+    detection_result_t result;
+    int ret;
+    pthread_t thread;
+} submission_t;
+
+static void *submit_thread(void *arg) {
+    submission_t *s = arg;
+    s->ret = inference_scheduler_detect(&s->req, &s->result);
+    return NULL;
+}
+
+static void submit_async(submission_t *s, const char *stream, const char *model,
+                         int priority, int width, int deadline_ms) {
+    memset(s, 0, sizeof(*s));
+    snprintf(s->stream_name, sizeof(s->stream_name), "%s", stream);
+    s->req.stream_name = s->stream_name;
+    s->req.model_path = model;
+    s->req.threshold = 0.5f;
+    s->req.frame.data = pixels;
+    s->req.frame.width = width;
+    s->req.frame.height = 1;
+    s->req.frame.channels = 3;
+    s->req.priority = priority;
+    s->req.deadline_ms = deadline_ms;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&s->thread, NULL, submit_thread, s));
+}
+
+static int submit_sync(const char *stream, const char *model, int width, detection_result_t *result) {
+    inference_request_t req = {
+        .stream_name = stream,
+        .model_path = model,
+        .threshold = 0.5f,
+        .frame = { pixels, width, 1, 3 },
+    };
+    return inference_scheduler_detect(&req, result);
+}
+
+static void close_gate(void) {
+    pthread_mutex_lock(&fake_mutex);
+    gate_closed = true;
+    pthread_mutex_unlock(&fake_mutex);
+}
+
+static void open_gate(void) {
+    pthread_mutex_lock(&fake_mutex);
+    gate_closed = false;
+    pthread_cond_broadcast(&fake_cond);
+    pthread_mutex_unlock(&fake_mutex);
+}
+
+static void *open_gate_after_stop(void *arg) {
+    (void)arg;
+    while (inference_scheduler_is_running()) {
+        usleep(1000);
+    }
+    open_gate();
+    return NULL;
+}
+
+static void wait_for_calls(int n) {
+    pthread_mutex_lock(&fake_mutex);
+    while (calls < n) {
+        pthread_cond_wait(&fake_cond, &fake_mutex);
+    }
+    pthread_mutex_unlock(&fake_mutex);
+}
+
+static void wait_for_queue_depth(int depth) {
+    for (int i = 0; i < 2000; i++) {
+        inference_scheduler_stats_t stats;
+        inference_scheduler_get_stats(&stats);
+        if (stats.queue_depth == depth) {
+            return;
+        }
+        usleep(1000);
+    }
+    TEST_FAIL_MESSAGE("queue never reached the expected depth");
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    gate_closed = false;
+    calls = 0;
+    loads = 0;
+    unloads = 0;
+    memset(call_sizes, 0, sizeof(call_sizes));
+    TEST_ASSERT_EQUAL_INT(0, inference_scheduler_init(1, &fake_backend));
+}
+
+void tearDown(void) {
+    open_gate();
+    inference_scheduler_shutdown();
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_single_frame_runs(void) {
+    detection_result_t result;
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, submit_sync("cam1", "a.sod", 7, &result));
+    TEST_ASSERT_EQUAL_INT(7, result.count);
+    TEST_ASSERT_EQUAL_INT(1, loads);
+
+    // The model stays loaded for the next frame
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, submit_sync("cam2", "a.sod", 3, &result));
+    TEST_ASSERT_EQUAL_INT(3, result.count);
+    TEST_ASSERT_EQUAL_INT(1, loads);
+}
+
+void test_frames_for_one_model_are_batched(void) {
+    submission_t first, others[3];
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+
+    submit_async(&others[0], "cam1", "a.sod", 5, 11, 5000);
+    submit_async(&others[1], "cam2", "a.sod", 5, 12, 5000);
+    submit_async(&others[2], "cam3", "b.sod", 5, 13, 5000);
+    wait_for_queue_depth(3);
+    open_gate();
+
+    pthread_join(first.thread, NULL);
+    for (int i = 0; i < 3; i++) {
+        pthread_join(others[i].thread, NULL);
+        TEST_ASSERT_EQUAL_INT(INFERENCE_OK, others[i].ret);
+        TEST_ASSERT_EQUAL_INT(11 + i, others[i].result.count);
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, calls);
+    TEST_ASSERT_EQUAL_INT(2, call_sizes[1]);
+    TEST_ASSERT_EQUAL_STRING("a.sod", call_models[1]);
+    TEST_ASSERT_EQUAL_INT(1, call_sizes[2]);
+    TEST_ASSERT_EQUAL_STRING("b.sod", call_models[2]);
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.batches);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.batch_sizes[0]);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.batch_sizes[1]);
+    TEST_ASSERT_EQUAL_INT(2, stats.models_loaded);
+}
+
+void test_higher_priority_runs_first(void) {
+    submission_t first, low, high;
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+
+    submit_async(&low, "cam1", "low.sod", 2, 1, 5000);
+    wait_for_queue_depth(1);
+    submit_async(&high, "cam2", "high.sod", 9, 1, 5000);
+    wait_for_queue_depth(2);
+    open_gate();
+
+    pthread_join(first.thread, NULL);
+    pthread_join(low.thread, NULL);
+    pthread_join(high.thread, NULL);
+
+    TEST_ASSERT_EQUAL_INT(3, calls);
+    TEST_ASSERT_EQUAL_STRING("high.sod", call_models[1]);
+    TEST_ASSERT_EQUAL_STRING("low.sod", call_models[2]);
+}
+
+void test_frame_past_deadline_is_dropped(void) {
+    submission_t first, late;
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+
+    submit_async(&late, "cam1", "a.sod", 5, 1, 30);
+    pthread_join(late.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_DROPPED, late.ret);
+
+    open_gate();
+    pthread_join(first.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, first.ret);
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.dropped_deadline);
+    TEST_ASSERT_EQUAL_INT(0, stats.queue_depth);
+    TEST_ASSERT_EQUAL_INT(1, calls);
+}
+
+void test_newer_frame_supersedes_queued_one(void) {
+    submission_t first, old_frame, new_frame;
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+
+    submit_async(&old_frame, "cam1", "a.sod", 5, 1, 5000);
+    wait_for_queue_depth(1);
+    submit_async(&new_frame, "cam1", "a.sod", 5, 2, 5000);
+    pthread_join(old_frame.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_DROPPED, old_frame.ret);
+
+    open_gate();
+    pthread_join(first.thread, NULL);
+    pthread_join(new_frame.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, new_frame.ret);
+    TEST_ASSERT_EQUAL_INT(2, new_frame.result.count);
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.dropped_superseded);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.submitted);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.completed);
+}
+
+void test_load_failure_fails_frame(void) {
+    detection_result_t result;
+    TEST_ASSERT_EQUAL_INT(INFERENCE_ERROR, submit_sync("cam1", "missing.sod", 1, &result));
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT64(1, stats.failed);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.batches);
+    TEST_ASSERT_EQUAL_INT(0, calls);
+}
+
+void test_shutdown_fails_queued_frames_and_unloads(void) {
+    submission_t first, queued;
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+    submit_async(&queued, "cam1", "b.sod", 5, 1, 5000);
+    wait_for_queue_depth(1);
+
+    // Shutdown waits for the running batch, so let it finish from here
+    pthread_t opener;
+    pthread_create(&opener, NULL, open_gate_after_stop, NULL);
+    inference_scheduler_shutdown();
+    pthread_join(opener, NULL);
+
+    pthread_join(first.thread, NULL);
+    pthread_join(queued.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, first.ret);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_ERROR, queued.ret);
+    TEST_ASSERT_EQUAL_INT(loads, unloads);
+    TEST_ASSERT_FALSE(inference_scheduler_is_running());
+
+    detection_result_t result;
+    TEST_ASSERT_EQUAL_INT(INFERENCE_ERROR, submit_sync("cam1", "a.sod", 1, &result));
+}
+
+void test_workers_run_one_model_in_parallel(void) {
+    inference_scheduler_shutdown();
+    TEST_ASSERT_EQUAL_INT(0, inference_scheduler_init(2, &fake_backend));
+
+    // Both frames are in the backend at once, each on its own instance
+    submission_t first, second;
+    close_gate();
+    submit_async(&first, "cam0", "a.sod", 5, 1, 5000);
+    wait_for_calls(1);
+    submit_async(&second, "cam1", "a.sod", 5, 2, 5000);
+    wait_for_calls(2);
+    TEST_ASSERT_EQUAL_INT(2, loads);
+
+    open_gate();
+    pthread_join(first.thread, NULL);
+    pthread_join(second.thread, NULL);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, first.ret);
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, second.ret);
+    TEST_ASSERT_EQUAL_INT(2, second.result.count);
+
+    // No more instances than workers
+    detection_result_t result;
+    TEST_ASSERT_EQUAL_INT(INFERENCE_OK, submit_sync("cam2", "a.sod", 1, &result));
+    TEST_ASSERT_EQUAL_INT(2, loads);
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.models_loaded);
+}
+
+void test_histograms_are_cumulative(void) {
+    detection_result_t result;
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(INFERENCE_OK, submit_sync("cam1", "a.sod", 1, &result));
+    }
+
+    inference_scheduler_stats_t stats;
+    inference_scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.workers);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.latency.count);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.queue_wait.count);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.latency.buckets[INFERENCE_HISTOGRAM_BUCKETS - 1]);
+    for (int i = 1; i < INFERENCE_HISTOGRAM_BUCKETS; i++) {
+        TEST_ASSERT_TRUE(stats.latency.buckets[i] >= stats.latency.buckets[i - 1]);
+    }
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_frame_runs);
+    RUN_TEST(test_frames_for_one_model_are_batched);
+    RUN_TEST(test_higher_priority_runs_first);
+    RUN_TEST(test_frame_past_deadline_is_dropped);
+    RUN_TEST(test_newer_frame_supersedes_queued_one);
+    RUN_TEST(test_load_failure_fails_frame);
+    RUN_TEST(test_shutdown_fails_queued_frames_and_unloads);
+    RUN_TEST(test_workers_run_one_model_in_parallel);
+    RUN_TEST(test_histograms_are_cumulative);
+    return UNITY_END();
+}
@@ -0,0 +1,192 @@
+/**
+ * @file test_keyframe_index.c
+ * @brief Layer 2 Unity tests for video/keyframe_index.c
+ *
+ * Covers the sidecar round trip, GOP lookups by wall-clock time and by
+ * position, the last GOP ending at the end of the media data, and rejection
+ * of missing or corrupt sidecars.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "video/keyframe_index.h"
+
+#define TEST_RECORDING "/tmp/lightnvr_unit_kfi_test.mp4"
+
+/* Four GOPs, 90 kHz time base, one keyframe every 2 s */
+static keyframe_index_entry_t g_entries[] = {
+    { .pts = 0,      .offset = 48,    .wall_ms = 1700000000000 },
+    { .pts = 180000, .offset = 10048, .wall_ms = 1700000002000 },
+    { .pts = 360000, .offset = 20048, .wall_ms = 1700000004010 },
+    { .pts = 540000, .offset = 30048, .wall_ms = 1700000006000 },
+};
+
+static char g_sidecar[256];
+
+static void save_test_index(void) {
+    keyframe_index_t index = {
+        .tb_num = 1, .tb_den = 90000,
+        .data_end = 36000,
+        .count = 4,
+        .entries = g_entries,
+    };
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_save(&index, g_sidecar));
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_sidecar_path(TEST_RECORDING, g_sidecar, sizeof(g_sidecar)));
+    unlink(g_sidecar);
+}
+
+void tearDown(void) {
+    unlink(g_sidecar);
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_sidecar_path_appends_extension(void) {
+    TEST_ASSERT_EQUAL_STRING(TEST_RECORDING ".kfi", g_sidecar);
+
+    char small[8];
+    TEST_ASSERT_EQUAL_INT(-1, keyframe_index_sidecar_path(TEST_RECORDING, small, sizeof(small)));
+}
+
+void test_save_and_load_round_trip(void) {
+    save_test_index();
+
+    keyframe_index_t *index = keyframe_index_load(TEST_RECORDING);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT_EQUAL_INT(1, index->tb_num);
+    TEST_ASSERT_EQUAL_INT(90000, index->tb_den);
+    TEST_ASSERT_EQUAL_INT64(36000, index->data_end);
+    TEST_ASSERT_EQUAL_INT(4, index->count);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT64(g_entries[i].pts, index->entries[i].pts);
+        TEST_ASSERT_EQUAL_INT64(g_entries[i].offset, index->entries[i].offset);
+        TEST_ASSERT_EQUAL_INT64(g_entries[i].wall_ms, index->entries[i].wall_ms);
+    }
+    keyframe_index_free(index);
+}
+
+void test_find_gop_by_wall_time(void) {
+    save_test_index();
+    keyframe_index_t *index = keyframe_index_load(TEST_RECORDING);
+    TEST_ASSERT_NOT_NULL(index);
+
+    keyframe_gop_range_t range;
+
+    // Between the second and third keyframe
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop(index, 1700000003500, &range));
+    TEST_ASSERT_EQUAL_INT64(10048, range.offset);
+    TEST_ASSERT_EQUAL_INT64(10000, range.length);
+    TEST_ASSERT_EQUAL_INT64(180000, range.pts);
+    TEST_ASSERT_EQUAL_INT64(1700000002000, range.wall_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, (float)range.media_seconds);
+
+    // Exactly on a keyframe
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop(index, 1700000004010, &range));
+    TEST_ASSERT_EQUAL_INT64(20048, range.offset);
+
+    // Before the recording maps to the first GOP
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop(index, 1600000000000, &range));
+    TEST_ASSERT_EQUAL_INT64(48, range.offset);
+    TEST_ASSERT_EQUAL_INT64(10000, range.length);
+
+    keyframe_index_free(index);
+}
+
+void test_last_gop_ends_at_media_data_end(void) {
+    save_test_index();
+    keyframe_index_t *index = keyframe_index_load(TEST_RECORDING);
+    TEST_ASSERT_NOT_NULL(index);
+
+    keyframe_gop_range_t range;
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop(index, 1800000000000, &range));
+    TEST_ASSERT_EQUAL_INT64(30048, range.offset);
+    TEST_ASSERT_EQUAL_INT64(36000 - 30048, range.length);
+
+    keyframe_index_free(index);
+}
+
+void test_find_gop_by_position(void) {
+    save_test_index();
+    keyframe_index_t *index = keyframe_index_load(TEST_RECORDING);
+    TEST_ASSERT_NOT_NULL(index);
+
+    keyframe_gop_range_t range;
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop_at(index, 5.9, &range));
+    TEST_ASSERT_EQUAL_INT64(360000, range.pts);
+    TEST_ASSERT_EQUAL_INT64(20048, range.offset);
+
+    TEST_ASSERT_EQUAL_INT(0, keyframe_index_find_gop_at(index, 0.0, &range));
+    TEST_ASSERT_EQUAL_INT64(0, range.pts);
+
+    keyframe_index_free(index);
+}
+
+void test_missing_or_corrupt_sidecar_is_rejected(void) {
+    TEST_ASSERT_NULL(keyframe_index_load(TEST_RECORDING));
+
+    FILE *fp = fopen(g_sidecar, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs("not a keyframe index at all", fp);
+    fclose(fp);
+    TEST_ASSERT_NULL(keyframe_index_load(TEST_RECORDING));
+
+    // Truncated entry table
+    save_test_index();
+    TEST_ASSERT_EQUAL_INT(0, truncate(g_sidecar, 28 + 24 * 2));
+    TEST_ASSERT_NULL(keyframe_index_load(TEST_RECORDING));
+}
+
+void test_delete_removes_sidecar(void) {
+    save_test_index();
+    TEST_ASSERT_EQUAL_INT(0, access(g_sidecar, F_OK));
+
+    keyframe_index_delete(TEST_RECORDING);
+    TEST_ASSERT_NOT_EQUAL(0, access(g_sidecar, F_OK));
+
+    // Deleting again is harmless
+    keyframe_index_delete(TEST_RECORDING);
+}
+
+void test_recorder_without_file_writes_nothing(void) {
+    keyframe_index_recorder_t *rec = keyframe_index_recorder_create();
+    TEST_ASSERT_NOT_NULL(rec);
+
+    // No keyframes recorded
+    TEST_ASSERT_EQUAL_INT(-1, keyframe_index_recorder_finish(rec, TEST_RECORDING));
+
+    keyframe_index_recorder_add(rec, 1700000000000);
+    TEST_ASSERT_EQUAL_INT(-1, keyframe_index_recorder_finish(rec, "/nonexistent/recording.mp4"));
+    keyframe_index_recorder_free(rec);
+
+    TEST_ASSERT_NOT_EQUAL(0, access(g_sidecar, F_OK));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sidecar_path_appends_extension);
+    RUN_TEST(test_save_and_load_round_trip);
+    RUN_TEST(test_find_gop_by_wall_time);
+    RUN_TEST(test_last_gop_ends_at_media_data_end);
+    RUN_TEST(test_find_gop_by_position);
+    RUN_TEST(test_missing_or_corrupt_sidecar_is_rejected);
+    RUN_TEST(test_delete_removes_sidecar);
+    RUN_TEST(test_recorder_without_file_writes_nothing);
+    return UNITY_END();
+}
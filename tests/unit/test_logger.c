@@ -13,6 +13,10 @@
  *   - enable_syslog() / disable_syslog() / is_syslog_enabled().
  *   - log_error / log_warn / log_info / log_debug / log_message — smoke tests.
  *   - log_message_v() indirectly via log_message().
+ *   - log_flush() after concurrent logging from several threads.
+ *   - Logging from a forked child.
+ *   - Per-call-site rate limiting (errors exempt) and the suppressed-message summary.
+ *   - log_tail_foreach() level, count and timestamp filtering.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -22,6 +26,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <syslog.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/wait.h>
 #include "unity.h"
 #include "core/logger.h"
 
@@ -29,6 +36,31 @@
 void setUp(void)    {}
 void tearDown(void) {}
 
+/* Point the logger at a fresh temp file; returns the path in buf */
+static void use_temp_log_file(char *buf) {
+    strcpy(buf, "/tmp/lightnvr_async_XXXXXX");
+    int fd = mkstemp(buf);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+    TEST_ASSERT_EQUAL_INT(0, set_log_file(buf));
+}
+
+/* Count lines of the log file containing needle */
+static int count_lines_containing(const char *path, const char *needle) {
+    FILE *fp = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+
+    char line[4096];
+    int count = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strstr(line, needle)) {
+            count++;
+        }
+    }
+    fclose(fp);
+    return count;
+}
+
 /* ================================================================
  * get_log_level_string
  * ================================================================ */
@@ -125,6 +157,7 @@ void test_set_log_file_with_temp_file(void) {
     /* After setting the file, logging should still work and write to the file */
     const char *msg = "test_set_log_file_with_temp_file: log line";
     log_info("%s", msg);
+    log_flush();
 
     /* Verify that the log message was actually written to the file */
     FILE *fp = fopen(file_template, "r");
@@ -236,6 +269,260 @@ void test_log_debug_suppressed_at_info_level(void) {
     TEST_PASS();
 }
 
+/* ================================================================
+ * Asynchronous writer
+ * ================================================================ */
+
+#define FLOOD_THREADS 4
+#define FLOOD_MESSAGES 500
+
+static void *flood_thread(void *arg) {
+    int id = (int)(long)arg;
+    for (int i = 0; i < FLOOD_MESSAGES; i++) {
+        log_info("flood thread %d message %d", id, i);
+    }
+    return NULL;
+}
+
+void test_log_flush_writes_every_queued_message(void) {
+    char path[64];
+    use_temp_log_file(path);
+    set_log_rate_limit(0);
+
+    /* More messages than the queue holds, from several threads at once */
+    pthread_t threads[FLOOD_THREADS];
+    for (long t = 0; t < FLOOD_THREADS; t++) {
+        pthread_create(&threads[t], NULL, flood_thread, (void *)t);
+    }
+    for (int t = 0; t < FLOOD_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    log_flush();
+
+    TEST_ASSERT_EQUAL_INT(FLOOD_THREADS * FLOOD_MESSAGES,
+                          count_lines_containing(path, "flood thread"));
+
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+    unlink(path);
+}
+
+void test_forked_child_starts_its_own_writer(void) {
+    char path[64];
+    use_temp_log_file(path);
+    set_log_rate_limit(0);
+
+    pid_t pid = fork();
+    TEST_ASSERT_NOT_EQUAL(-1, pid);
+    if (pid == 0) {
+        /* More than the queue holds, so this hangs without a writer */
+        for (int i = 0; i < LOG_QUEUE_SIZE * 2; i++) {
+            log_info("forked child %d", i);
+        }
+        log_flush();
+        _exit(0);
+    }
+
+    int status = 0;
+    TEST_ASSERT_EQUAL_INT(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL_INT(LOG_QUEUE_SIZE * 2, count_lines_containing(path, "forked child"));
+
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+    unlink(path);
+}
+
+void test_long_message_not_truncated_at_slot_size(void) {
+    char path[64];
+    use_temp_log_file(path);
+
+    char long_text[2048];
+    memset(long_text, 'x', sizeof(long_text) - 2);
+    long_text[sizeof(long_text) - 2] = 'E';
+    long_text[sizeof(long_text) - 1] = '\0';
+    log_info("long %s", long_text);
+    log_flush();
+
+    TEST_ASSERT_EQUAL_INT(1, count_lines_containing(path, "xxxxE"));
+    unlink(path);
+}
+
+/* ================================================================
+ * Rate limiting
+ * ================================================================ */
+
+static void log_from_one_site(int i) {
+    log_warn("repeated call site %d", i);
+}
+
+void test_rate_limit_suppresses_repeats(void) {
+    char path[64];
+    use_temp_log_file(path);
+    set_log_rate_limit(5);
+
+    for (int i = 0; i < 200; i++) {
+        log_from_one_site(i);
+    }
+    log_flush();
+
+    /* At most two one-second windows can be crossed by the loop */
+    int written = count_lines_containing(path, "repeated call site");
+    TEST_ASSERT_TRUE(written >= 5);
+    TEST_ASSERT_TRUE(written <= 10);
+
+    /* The next message in a later second reports what was dropped */
+    sleep(1);
+    log_from_one_site(999);
+    log_flush();
+    TEST_ASSERT_EQUAL_INT(1, count_lines_containing(path, "similar messages suppressed"));
+    TEST_ASSERT_EQUAL_INT(1, count_lines_containing(path, "repeated call site 999"));
+
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+    unlink(path);
+}
+
+void test_rate_limit_is_per_call_site(void) {
+    char path[64];
+    use_temp_log_file(path);
+    set_log_rate_limit(5);
+
+    for (int i = 0; i < 20; i++) {
+        log_info("site A %d", i);
+        log_info("site B %d", i);
+    }
+    log_flush();
+
+    TEST_ASSERT_TRUE(count_lines_containing(path, "site A") >= 5);
+    TEST_ASSERT_TRUE(count_lines_containing(path, "site B") >= 5);
+
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+    unlink(path);
+}
+
+static void log_error_from_one_site(int i) {
+    log_error("repeated error site %d", i);
+}
+
+void test_rate_limit_never_drops_errors(void) {
+    char path[64];
+    use_temp_log_file(path);
+    set_log_rate_limit(5);
+
+    for (int i = 0; i < 50; i++) {
+        log_error_from_one_site(i);
+    }
+    log_flush();
+
+    TEST_ASSERT_EQUAL_INT(50, count_lines_containing(path, "repeated error site"));
+    TEST_ASSERT_EQUAL_INT(0, count_lines_containing(path, "similar messages suppressed"));
+
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+    unlink(path);
+}
+
+/* ================================================================
+ * In-memory tail
+ * ================================================================ */
+
+typedef struct {
+    int count;
+    log_tail_entry_t last;
+    char texts[8][LOG_TAIL_TEXT_MAX];
+} tail_visit_t;
+
+static void collect_tail_entry(const log_tail_entry_t *entry, void *user_data) {
+    tail_visit_t *visit = user_data;
+    if (visit->count < 8) {
+        strcpy(visit->texts[visit->count], entry->text);
+    }
+    visit->last = *entry;
+    visit->count++;
+}
+
+void test_tail_returns_newest_in_order(void) {
+    set_log_rate_limit(0);
+    for (int i = 0; i < 5; i++) {
+        log_info("tail order %d", i);
+    }
+    log_flush();
+
+    tail_visit_t visit = {0};
+    TEST_ASSERT_EQUAL_INT(3, log_tail_foreach(LOG_LEVEL_DEBUG, NULL, 3, collect_tail_entry, &visit));
+    TEST_ASSERT_EQUAL_INT(3, visit.count);
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[0], "tail order 2"));
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[2], "tail order 4"));
+    TEST_ASSERT_EQUAL_INT(LOG_LEVEL_INFO, visit.last.level);
+    TEST_ASSERT_EQUAL_INT(23, (int)strlen(visit.last.timestamp));
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+}
+
+void test_tail_filters_by_level(void) {
+    set_log_rate_limit(0);
+    log_warn("tail level warn");
+    log_info("tail level info");
+    log_flush();
+
+    tail_visit_t visit = {0};
+    TEST_ASSERT_EQUAL_INT(1, log_tail_foreach(LOG_LEVEL_WARN, NULL, 1, collect_tail_entry, &visit));
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[0], "tail level warn"));
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+}
+
+void test_tail_after_timestamp(void) {
+    log_info("tail before marker");
+    log_flush();
+
+    tail_visit_t visit = {0};
+    log_tail_foreach(LOG_LEVEL_DEBUG, NULL, 1, collect_tail_entry, &visit);
+    char marker[24];
+    strcpy(marker, visit.last.timestamp);
+
+    /* Make sure the next message gets a later timestamp */
+    struct timespec pause = { .tv_sec = 0, .tv_nsec = 2000000 };
+    nanosleep(&pause, NULL);
+    log_info("tail after marker");
+    log_flush();
+
+    memset(&visit, 0, sizeof(visit));
+    TEST_ASSERT_EQUAL_INT(1, log_tail_foreach(LOG_LEVEL_DEBUG, marker, 100, collect_tail_entry, &visit));
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[0], "tail after marker"));
+}
+
+void test_tail_after_timestamp_pages_forward(void) {
+    set_log_rate_limit(0);
+    log_info("tail page marker");
+    log_flush();
+
+    tail_visit_t visit = {0};
+    log_tail_foreach(LOG_LEVEL_DEBUG, NULL, 1, collect_tail_entry, &visit);
+    char marker[24];
+    strcpy(marker, visit.last.timestamp);
+
+    struct timespec pause = { .tv_sec = 0, .tv_nsec = 2000000 };
+    nanosleep(&pause, NULL);
+    for (int i = 0; i < 5; i++) {
+        log_info("tail page %d", i);
+    }
+    log_flush();
+
+    /* The oldest lines after the marker come first; the rest come next poll */
+    memset(&visit, 0, sizeof(visit));
+    TEST_ASSERT_EQUAL_INT(2, log_tail_foreach(LOG_LEVEL_DEBUG, marker, 2, collect_tail_entry, &visit));
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[0], "tail page 0"));
+    TEST_ASSERT_NOT_NULL(strstr(visit.texts[1], "tail page 1"));
+    set_log_rate_limit(LOG_RATE_LIMIT_DEFAULT);
+}
+
+void test_tail_declines_incomplete_queries(void) {
+    tail_visit_t visit = {0};
+
+    /* More lines than it can hold, or a timestamp older than its oldest line */
+    TEST_ASSERT_EQUAL_INT(-1, log_tail_foreach(LOG_LEVEL_DEBUG, NULL, LOG_TAIL_ENTRIES + 1,
+                                               collect_tail_entry, &visit));
+    TEST_ASSERT_EQUAL_INT(-1, log_tail_foreach(LOG_LEVEL_DEBUG, "2000-01-01 00:00:00.000", 10,
+                                               collect_tail_entry, &visit));
+    TEST_ASSERT_EQUAL_INT(0, visit.count);
+}
+
 /* ================================================================
  * main
  * ================================================================ */
@@ -277,6 +564,20 @@ int main(void) {
     RUN_TEST(test_log_message_does_not_crash);
     RUN_TEST(test_log_debug_suppressed_at_info_level);
 
+    RUN_TEST(test_log_flush_writes_every_queued_message);
+    RUN_TEST(test_forked_child_starts_its_own_writer);
+    RUN_TEST(test_long_message_not_truncated_at_slot_size);
+
+    RUN_TEST(test_rate_limit_suppresses_repeats);
+    RUN_TEST(test_rate_limit_is_per_call_site);
+    RUN_TEST(test_rate_limit_never_drops_errors);
+
+    RUN_TEST(test_tail_returns_newest_in_order);
+    RUN_TEST(test_tail_filters_by_level);
+    RUN_TEST(test_tail_after_timestamp);
+    RUN_TEST(test_tail_after_timestamp_pages_forward);
+    RUN_TEST(test_tail_declines_incomplete_queries);
+
     int result = UNITY_END();
     shutdown_logger();
     return result;
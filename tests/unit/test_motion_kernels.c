@@ -0,0 +1,313 @@
+/**
+ * @file test_motion_kernels.c
+ * @brief Layer 2 Unity tests for video/motion_kernels.c
+ *
+ * Every kernel set available on the build machine (SSE2/AVX2 or NEON) must be
+ * bit-exact against the scalar reference set for:
+ *   rgb_to_gray, downscale, box_blur, update_background, diff_sum, diff_row
+ *
+ * Inputs are pseudo-random with awkward sizes so that vector bodies, scalar
+ * tails and image borders are all exercised.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "video/motion_kernels.h"
+
+#define MAX_W 203
+#define MAX_H 67
+
+static const motion_kernels_t *kernels[8];
+static int kernel_count;
+
+static uint32_t rng_state;
+
+static uint8_t rand_u8(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (uint8_t)(rng_state >> 16);
+}
+
+static void fill_random(uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = rand_u8();
+    }
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    rng_state = 12345u;
+    kernel_count = motion_kernels_available(kernels, 8);
+}
+void tearDown(void) {}
+
+/* ================================================================
+ * Selection
+ * ================================================================ */
+
+void test_scalar_listed_first(void) {
+    TEST_ASSERT_GREATER_OR_EQUAL(1, kernel_count);
+    TEST_ASSERT_EQUAL_PTR(motion_kernels_scalar(), kernels[0]);
+}
+
+void test_selected_is_available(void) {
+    const motion_kernels_t *selected = motion_kernels_get();
+    TEST_ASSERT_NOT_NULL(selected);
+    TEST_ASSERT_EQUAL_PTR(kernels[kernel_count - 1], selected);
+}
+
+/* ================================================================
+ * Bit-exactness against the scalar reference
+ * ================================================================ */
+
+void test_rgb_to_gray_matches_scalar(void) {
+    static uint8_t rgb[MAX_W * MAX_H * 3];
+    static uint8_t expect[MAX_W * MAX_H];
+    static uint8_t got[MAX_W * MAX_H];
+    const int sizes[] = {1, 15, 16, 17, 47, 48, 1000, MAX_W * MAX_H};
+
+    fill_random(rgb, sizeof(rgb));
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        kernels[0]->rgb_to_gray(rgb, expect, sizes[s]);
+        for (int k = 1; k < kernel_count; k++) {
+            memset(got, 0xAA, sizeof(got));
+            kernels[k]->rgb_to_gray(rgb, got, sizes[s]);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expect, got, sizes[s], kernels[k]->name);
+        }
+    }
+}
+
+void test_downscale_matches_scalar(void) {
+    static uint8_t src[MAX_W * MAX_H];
+    static uint8_t expect[MAX_W * MAX_H];
+    static uint8_t got[MAX_W * MAX_H];
+    const int dims[][2] = {{MAX_W, MAX_H}, {64, 64}, {33, 17}, {100, 3}, {40, 40}};
+
+    fill_random(src, sizeof(src));
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        int w = dims[d][0];
+        int h = dims[d][1];
+        for (int factor = 1; factor <= 4; factor++) {
+            int dw = w / factor;
+            int dh = h / factor;
+            // Mirror the minimum-size clamp used by motion_detection.c
+            if (factor > 1 && dw < 32) dw = 32;
+            if (factor > 1 && dh < 32) dh = 32;
+            if (dw > MAX_W || dh > MAX_H) continue;
+
+            kernels[0]->downscale(src, MAX_W, w, h, factor, expect, dw, dh);
+            for (int k = 1; k < kernel_count; k++) {
+                memset(got, 0xAA, sizeof(got));
+                kernels[k]->downscale(src, MAX_W, w, h, factor, got, dw, dh);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expect, got, dw * dh, kernels[k]->name);
+            }
+        }
+    }
+}
+
+void test_box_blur_matches_scalar(void) {
+    static uint8_t src[MAX_W * MAX_H];
+    static uint8_t tmp[MAX_W * MAX_H];
+    static uint8_t expect[MAX_W * MAX_H];
+    static uint8_t got[MAX_W * MAX_H];
+    const int dims[][2] = {{MAX_W, MAX_H}, {16, 16}, {37, 11}, {5, 40}, {1, 1}};
+
+    fill_random(src, sizeof(src));
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        int w = dims[d][0];
+        int h = dims[d][1];
+        for (int radius = 0; radius <= 12; radius++) {
+            kernels[0]->box_blur(src, expect, tmp, w, h, radius);
+            for (int k = 1; k < kernel_count; k++) {
+                memset(got, 0xAA, sizeof(got));
+                kernels[k]->box_blur(src, got, tmp, w, h, radius);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expect, got, w * h, kernels[k]->name);
+            }
+        }
+    }
+}
+
+void test_update_background_matches_scalar(void) {
+    static uint8_t cur[MAX_W * MAX_H];
+    static uint8_t bg_init[MAX_W * MAX_H];
+    static uint8_t expect[MAX_W * MAX_H];
+    static uint8_t got[MAX_W * MAX_H];
+    const int alphas[] = {0, 1, 3, 12, 64, 128, 255, 256};
+    const int n = MAX_W * MAX_H;
+
+    fill_random(cur, sizeof(cur));
+    fill_random(bg_init, sizeof(bg_init));
+    for (size_t a = 0; a < sizeof(alphas) / sizeof(alphas[0]); a++) {
+        memcpy(expect, bg_init, (size_t)n);
+        kernels[0]->update_background(expect, cur, n, alphas[a]);
+        for (int k = 1; k < kernel_count; k++) {
+            memcpy(got, bg_init, (size_t)n);
+            kernels[k]->update_background(got, cur, n, alphas[a]);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expect, got, n, kernels[k]->name);
+        }
+    }
+}
+
+void test_diff_sum_matches_scalar(void) {
+    static uint8_t curr[MAX_W * MAX_H];
+    static uint8_t prev[MAX_W * MAX_H];
+    static uint8_t bg[MAX_W * MAX_H];
+    const int thresholds[] = {-1, 0, 10, 38, 128, 254, 255};
+    const int lengths[] = {1, 2, 15, 16, 31, 32, 33, 63, 64, 65, MAX_W, MAX_W * MAX_H};
+
+    fill_random(curr, sizeof(curr));
+    fill_random(prev, sizeof(prev));
+    fill_random(bg, sizeof(bg));
+    for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); t++) {
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            int expect_changed = 0;
+            uint32_t expect = kernels[0]->diff_sum(curr, prev, bg, lengths[l], thresholds[t],
+                                                   &expect_changed);
+            for (int k = 1; k < kernel_count; k++) {
+                int changed = 0;
+                uint32_t got = kernels[k]->diff_sum(curr, prev, bg, lengths[l], thresholds[t], &changed);
+                TEST_ASSERT_EQUAL_UINT32_MESSAGE(expect, got, kernels[k]->name);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(expect_changed, changed, kernels[k]->name);
+            }
+        }
+    }
+}
+
+void test_diff_row_matches_scalar(void) {
+    static uint8_t curr[MAX_W * MAX_H];
+    static uint8_t prev[MAX_W * MAX_H];
+    static uint8_t bg[MAX_W * MAX_H];
+    static uint8_t expect[MAX_W * MAX_H / 2 + 2];
+    static uint8_t got[MAX_W * MAX_H / 2 + 2];
+    const int thresholds[] = {-1, 0, 10, 38, 128, 254, 255};
+    const int lengths[] = {1, 2, 15, 16, 31, 32, 33, 63, 64, 65, 127, 128, 129, MAX_W, MAX_W * MAX_H};
+
+    fill_random(curr, sizeof(curr));
+    fill_random(prev, sizeof(prev));
+    fill_random(bg, sizeof(bg));
+    for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); t++) {
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+            int out_len = (lengths[l] + 1) / 2;
+            kernels[0]->diff_row(curr, prev, bg, lengths[l], thresholds[t], expect);
+            for (int k = 1; k < kernel_count; k++) {
+                memset(got, 0xAA, sizeof(got));
+                kernels[k]->diff_row(curr, prev, bg, lengths[l], thresholds[t], got);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expect, got, out_len, kernels[k]->name);
+                TEST_ASSERT_EQUAL_UINT8_MESSAGE(0xAA, got[out_len], kernels[k]->name);
+            }
+        }
+    }
+}
+
+/* ================================================================
+ * Scalar reference sanity
+ * ================================================================ */
+
+void test_scalar_gray_known_values(void) {
+    const uint8_t rgb[] = {0, 0, 0, 255, 255, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255};
+    uint8_t gray[5];
+    motion_kernels_scalar()->rgb_to_gray(rgb, gray, 5);
+    TEST_ASSERT_EQUAL_UINT8(0, gray[0]);
+    TEST_ASSERT_EQUAL_UINT8(254, gray[1]);
+    TEST_ASSERT_EQUAL_UINT8(75, gray[2]);
+    TEST_ASSERT_EQUAL_UINT8(149, gray[3]);
+    TEST_ASSERT_EQUAL_UINT8(28, gray[4]);
+}
+
+void test_scalar_diff_sum_samples_even_pixels(void) {
+    uint8_t curr[4] = {100, 200, 100, 200};
+    uint8_t prev[4] = {0, 0, 100, 0};
+    uint8_t bg[4]   = {100, 0, 100, 0};
+    int changed = 0;
+    uint32_t sum = motion_kernels_scalar()->diff_sum(curr, prev, bg, 4, 10, &changed);
+    TEST_ASSERT_EQUAL_UINT32(100, sum);
+    TEST_ASSERT_EQUAL_INT(1, changed);
+}
+
+void test_scalar_diff_row_agrees_with_diff_sum(void) {
+    static uint8_t curr[MAX_W];
+    static uint8_t prev[MAX_W];
+    static uint8_t bg[MAX_W];
+    uint8_t row[MAX_W / 2 + 1];
+
+    fill_random(curr, sizeof(curr));
+    fill_random(prev, sizeof(prev));
+    fill_random(bg, sizeof(bg));
+
+    int changed = 0;
+    uint32_t expect = motion_kernels_scalar()->diff_sum(curr, prev, bg, MAX_W, 40, &changed);
+    motion_kernels_scalar()->diff_row(curr, prev, bg, MAX_W, 40, row);
+
+    uint32_t sum = 0;
+    int nonzero = 0;
+    for (int i = 0; i < (MAX_W + 1) / 2; i++) {
+        sum += row[i];
+        nonzero += row[i] != 0;
+    }
+    TEST_ASSERT_EQUAL_UINT32(expect, sum);
+    TEST_ASSERT_EQUAL_INT(changed, nonzero);
+}
+
+void test_scalar_box_blur_matches_brute_force(void) {
+    static uint8_t src[MAX_W * MAX_H];
+    static uint8_t tmp[MAX_W * MAX_H];
+    static uint8_t got[MAX_W * MAX_H];
+    static uint8_t h_pass[MAX_W * MAX_H];
+    const int w = MAX_W;
+    const int h = MAX_H;
+    const int radii[] = {1, 4, 9, 30, 100};
+
+    fill_random(src, sizeof(src));
+    for (size_t r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+        int radius = radii[r];
+        motion_kernels_scalar()->box_blur(src, got, tmp, w, h, radius);
+
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                int x0 = x - radius < 0 ? 0 : x - radius;
+                int x1 = x + radius >= w ? w - 1 : x + radius;
+                int sum = 0;
+                for (int i = x0; i <= x1; i++) sum += src[y * w + i];
+                h_pass[y * w + x] = (uint8_t)(sum / (x1 - x0 + 1));
+            }
+        }
+        for (int y = 0; y < h; y++) {
+            int y0 = y - radius < 0 ? 0 : y - radius;
+            int y1 = y + radius >= h ? h - 1 : y + radius;
+            for (int x = 0; x < w; x++) {
+                int sum = 0;
+                for (int i = y0; i <= y1; i++) sum += h_pass[i * w + x];
+                TEST_ASSERT_EQUAL_UINT8((uint8_t)(sum / (y1 - y0 + 1)), got[y * w + x]);
+            }
+        }
+    }
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scalar_listed_first);
+    RUN_TEST(test_selected_is_available);
+
+    RUN_TEST(test_rgb_to_gray_matches_scalar);
+    RUN_TEST(test_downscale_matches_scalar);
+    RUN_TEST(test_box_blur_matches_scalar);
+    RUN_TEST(test_update_background_matches_scalar);
+    RUN_TEST(test_diff_sum_matches_scalar);
+    RUN_TEST(test_diff_row_matches_scalar);
+
+    RUN_TEST(test_scalar_gray_known_values);
+    RUN_TEST(test_scalar_diff_sum_samples_even_pixels);
+    RUN_TEST(test_scalar_diff_row_agrees_with_diff_sum);
+    RUN_TEST(test_scalar_box_blur_matches_brute_force);
+
+    return UNITY_END();
+}
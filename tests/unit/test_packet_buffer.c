@@ -14,12 +14,17 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 
 #include "unity.h"
 #include "video/packet_buffer.h"
+#include "core/config.h"
+#include "utils/strings.h"
+
+#define TEST_SPILL_PATH "/tmp/lightnvr_unit_pb_spill"
 
 /* ---- helpers ---- */
 
@@ -269,6 +274,319 @@ void test_clear_empties_buffer(void) {
     destroy_packet_buffer(b);
 }
 
+/* ================================================================
+ * pooled mode (byte ring)
+ * ================================================================ */
+
+void test_pooled_fifo_order_and_payload(void) {
+    packet_buffer_t *b = create_packet_buffer("pool_fifo", 5, BUFFER_MODE_MEMORY_POOLED);
+    TEST_ASSERT_NOT_NULL(b);
+
+    for (int i = 0; i < 10; i++) {
+        AVPacket *p = make_pkt(100 + i, i == 0);
+        memset(p->data, i, p->size);
+        p->pts = i;
+        packet_buffer_add_packet(b, p, time(NULL));
+        av_packet_free(&p);
+    }
+    TEST_ASSERT_EQUAL_INT(1, packet_buffer_get_keyframe_count(b));
+
+    for (int i = 0; i < 10; i++) {
+        AVPacket *out = NULL;
+        TEST_ASSERT_EQUAL_INT(0, packet_buffer_pop_oldest(b, &out));
+        TEST_ASSERT_EQUAL_INT(100 + i, out->size);
+        TEST_ASSERT_EQUAL_INT64(i, out->pts);
+        TEST_ASSERT_EQUAL_UINT8(i, out->data[out->size - 1]);
+        TEST_ASSERT_EQUAL_INT(i == 0, (out->flags & AV_PKT_FLAG_KEY) != 0);
+        av_packet_free(&out);
+    }
+    TEST_ASSERT_EQUAL_INT(0, packet_buffer_get_keyframe_count(b));
+
+    destroy_packet_buffer(b);
+}
+
+/* Collects pts values and checks each payload byte equals pts & 0xFF */
+typedef struct {
+    int count;
+    int64_t first_pts;
+    int64_t last_pts;
+    bool ok;
+} pts_check_t;
+
+static int pts_check_cb(const AVPacket *pkt, void *user_data) {
+    pts_check_t *c = (pts_check_t *)user_data;
+    if (c->count == 0) {
+        c->first_pts = pkt->pts;
+    } else if (pkt->pts != c->last_pts + 1) {
+        c->ok = false;
+    }
+    if (pkt->size > 0 && (pkt->data[0] != (uint8_t)pkt->pts ||
+                          pkt->data[pkt->size - 1] != (uint8_t)pkt->pts)) {
+        c->ok = false;
+    }
+    c->last_pts = pkt->pts;
+    c->count++;
+    return 0;
+}
+
+void test_pooled_ring_grows_and_wraps(void) {
+    packet_buffer_t *b = create_packet_buffer("pool_wrap", 5, BUFFER_MODE_MEMORY_POOLED);
+    TEST_ASSERT_NOT_NULL(b);
+
+    /* 5 s at 15 fps * 1.2 = 90 slots; 300 mixed-size packets force count
+       eviction and wrap-around, and 256 KB keyframes force ring growth */
+    time_t now = time(NULL);
+    for (int i = 0; i < 300; i++) {
+        int size = (i % 15 == 0) ? 256 * 1024 : 3000 + (i * 37) % 5000;
+        AVPacket *p = make_pkt(size, i % 15 == 0);
+        memset(p->data, i & 0xFF, size);
+        p->pts = i;
+        TEST_ASSERT_EQUAL_INT(0, packet_buffer_add_packet(b, p, now));
+        av_packet_free(&p);
+    }
+
+    int count = 0;
+    size_t mem = 0;
+    int dur = 0;
+    packet_buffer_get_stats(b, &count, &mem, &dur);
+    TEST_ASSERT_EQUAL_INT(b->max_packets, count);
+
+    pts_check_t c = { .ok = true };
+    TEST_ASSERT_EQUAL_INT(count, packet_buffer_flush(b, pts_check_cb, &c));
+    TEST_ASSERT_TRUE(c.ok);
+    TEST_ASSERT_EQUAL_INT64(299, c.last_pts);
+    TEST_ASSERT_EQUAL_INT64(300 - count, c.first_pts);
+
+    /* The emptied ring stays allocated and charged */
+    packet_buffer_get_stats(b, &count, &mem, &dur);
+    TEST_ASSERT_EQUAL_INT(0, count);
+    TEST_ASSERT_TRUE(b->ring.capacity > PACKET_RING_INITIAL_BYTES);
+    TEST_ASSERT_EQUAL_size_t(b->ring.capacity, mem);
+
+    destroy_packet_buffer(b);
+}
+
+void test_pooled_time_eviction(void) {
+    packet_buffer_t *b = create_packet_buffer("pool_time", 5, BUFFER_MODE_MEMORY_POOLED);
+    TEST_ASSERT_NOT_NULL(b);
+
+    for (int i = 0; i < 20; i++) {
+        AVPacket *p = make_pkt(500, false);
+        p->pts = i;
+        packet_buffer_add_packet(b, p, (time_t)(1000 + i));
+        av_packet_free(&p);
+    }
+
+    /* Only packets within 5 s of the newest (t=1019) remain: t=1014..1019 */
+    int count = 0;
+    packet_buffer_get_stats(b, &count, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(6, count);
+
+    AVPacket *out = NULL;
+    TEST_ASSERT_EQUAL_INT(0, packet_buffer_peek_oldest(b, &out));
+    TEST_ASSERT_EQUAL_INT64(14, out->pts);
+    av_packet_free(&out);
+
+    destroy_packet_buffer(b);
+}
+
+/* ================================================================
+ * pool admission control
+ * ================================================================ */
+
+/* Adds packets_per_second packets of size bytes for each second in [from, to) */
+static void feed(packet_buffer_t *b, int from, int to, int packets_per_second, int size, int64_t *pts) {
+    for (int t = from; t < to; t++) {
+        for (int i = 0; i < packets_per_second; i++) {
+            AVPacket *p = make_pkt(size, i == 0);
+            p->pts = *pts;
+            memset(p->data, (int)(*pts & 0xFF), size);
+            (*pts)++;
+            TEST_ASSERT_EQUAL_INT(0, packet_buffer_add_packet(b, p, (time_t)(1000 + t)));
+            av_packet_free(&p);
+        }
+    }
+}
+
+static const packet_buffer_budget_t *find_budget(const packet_buffer_budget_t *budgets, int n,
+                                                 const char *name) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(budgets[i].stream_name, name) == 0) return &budgets[i];
+    }
+    return NULL;
+}
+
+void test_budget_shrinks_low_priority_first(void) {
+    cleanup_packet_buffer_pool();
+    TEST_ASSERT_EQUAL_INT(0, init_packet_buffer_pool(1)); /* 1 MB for both streams */
+
+    packet_buffer_t *hi = create_packet_buffer("adm_hi", 10, BUFFER_MODE_MEMORY_POOLED);
+    packet_buffer_t *lo = create_packet_buffer("adm_lo", 10, BUFFER_MODE_MEMORY);
+    TEST_ASSERT_NOT_NULL(hi);
+    TEST_ASSERT_NOT_NULL(lo);
+    packet_buffer_set_priority(hi, 9);
+    packet_buffer_set_priority(lo, 1);
+
+    /* Each stream wants ~1 MB for its 10 s window */
+    int64_t pts_hi = 0, pts_lo = 0;
+    feed(hi, 0, 10, 10, 10 * 1024, &pts_hi);
+    feed(lo, 0, 10, 10, 10 * 1024, &pts_lo);
+    packet_buffer_rebalance_pool();
+    feed(hi, 10, 12, 10, 10 * 1024, &pts_hi);
+    feed(lo, 10, 12, 10, 10 * 1024, &pts_lo);
+
+    packet_buffer_budget_t budgets[4];
+    size_t limit = 0;
+    int n = packet_buffer_get_budgets(budgets, 4, &limit);
+    TEST_ASSERT_EQUAL_INT(2, n);
+    TEST_ASSERT_EQUAL_size_t(1024 * 1024, limit);
+
+    const packet_buffer_budget_t *bh = find_budget(budgets, n, "adm_hi");
+    const packet_buffer_budget_t *bl = find_budget(budgets, n, "adm_lo");
+    TEST_ASSERT_NOT_NULL(bh);
+    TEST_ASSERT_NOT_NULL(bl);
+
+    /* Both keep at least their minimum pre-roll; the rest goes to hi */
+    TEST_ASSERT_FALSE(bh->spilled);
+    TEST_ASSERT_FALSE(bl->spilled);
+    TEST_ASSERT_TRUE(bh->memory_budget > bl->memory_budget);
+    TEST_ASSERT_TRUE(bh->memory_budget + bl->memory_budget <= limit);
+    TEST_ASSERT_TRUE(bl->memory_usage <= bl->memory_budget);
+    TEST_ASSERT_TRUE(bh->memory_usage > bl->memory_usage);
+    TEST_ASSERT_TRUE(bl->packets_shed > 0);
+    TEST_ASSERT_TRUE(packet_buffer_get_total_memory_usage() <= limit);
+
+    /* Trimmed buffers still flush in order */
+    pts_check_t c = { .ok = true };
+    TEST_ASSERT_TRUE(packet_buffer_flush(lo, pts_check_cb, &c) > 0);
+    TEST_ASSERT_TRUE(c.ok);
+    TEST_ASSERT_EQUAL_INT64(pts_lo - 1, c.last_pts);
+
+    destroy_packet_buffer(hi);
+    destroy_packet_buffer(lo);
+    TEST_ASSERT_EQUAL_size_t(0, packet_buffer_get_total_memory_usage());
+}
+
+void test_unmeasured_buffers_share_the_pool(void) {
+    cleanup_packet_buffer_pool();
+    TEST_ASSERT_EQUAL_INT(0, init_packet_buffer_pool(1));
+
+    packet_buffer_t *a = create_packet_buffer("new_a", 10, BUFFER_MODE_MEMORY_POOLED);
+    packet_buffer_t *b = create_packet_buffer("new_b", 10, BUFFER_MODE_MEMORY_POOLED);
+    packet_buffer_t *c = create_packet_buffer("new_c", 10, BUFFER_MODE_MEMORY);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    packet_buffer_rebalance_pool();
+
+    /* No demand measured yet: the pool is split, not handed to each in full */
+    packet_buffer_budget_t budgets[4];
+    size_t limit = 0;
+    int n = packet_buffer_get_budgets(budgets, 4, &limit);
+    TEST_ASSERT_EQUAL_INT(3, n);
+    size_t total = 0;
+    for (int i = 0; i < n; i++) {
+        TEST_ASSERT_TRUE(budgets[i].memory_budget > 0);
+        total += budgets[i].memory_budget;
+    }
+    TEST_ASSERT_TRUE(total <= limit);
+
+    destroy_packet_buffer(a);
+    destroy_packet_buffer(b);
+    destroy_packet_buffer(c);
+}
+
+void test_spill_to_disk_when_minimum_preroll_does_not_fit(void) {
+    mkdir(TEST_SPILL_PATH, 0755);
+    safe_strcpy(g_config.storage_path, TEST_SPILL_PATH, sizeof(g_config.storage_path), 0);
+
+    cleanup_packet_buffer_pool();
+    TEST_ASSERT_EQUAL_INT(0, init_packet_buffer_pool(1));
+
+    packet_buffer_t *hi = create_packet_buffer("spill_hi", 10, BUFFER_MODE_MEMORY_POOLED);
+    packet_buffer_t *lo = create_packet_buffer("spill_lo", 10, BUFFER_MODE_MEMORY_POOLED);
+    TEST_ASSERT_NOT_NULL(hi);
+    TEST_ASSERT_NOT_NULL(lo);
+    packet_buffer_set_priority(hi, 8);
+    packet_buffer_set_priority(lo, 2);
+
+    /* ~300 KB/s each: two 2 s minimum pre-rolls do not fit in 1 MB */
+    int64_t pts_hi = 0, pts_lo = 0;
+    feed(hi, 0, 3, 10, 30 * 1024, &pts_hi);
+    feed(lo, 0, 3, 10, 30 * 1024, &pts_lo);
+    packet_buffer_rebalance_pool();
+    feed(lo, 3, 4, 10, 30 * 1024, &pts_lo);
+
+    packet_buffer_budget_t budgets[4];
+    int n = packet_buffer_get_budgets(budgets, 4, NULL);
+    const packet_buffer_budget_t *bh = find_budget(budgets, n, "spill_hi");
+    const packet_buffer_budget_t *bl = find_budget(budgets, n, "spill_lo");
+    TEST_ASSERT_NOT_NULL(bh);
+    TEST_ASSERT_NOT_NULL(bl);
+    TEST_ASSERT_FALSE(bh->spilled);
+    TEST_ASSERT_TRUE(bl->spilled);
+    TEST_ASSERT_EQUAL_size_t(0, bl->memory_usage);
+    TEST_ASSERT_EQUAL_size_t(0, lo->ring.capacity);
+    TEST_ASSERT_EQUAL_INT(0, access(TEST_SPILL_PATH "/buffer/spill_lo_prebuffer.mmap", F_OK));
+
+    /* Spilled packets are still counted and flushed */
+    int count = 0;
+    size_t mem = 0;
+    packet_buffer_get_stats(lo, &count, &mem, NULL);
+    TEST_ASSERT_TRUE(count > 0);
+    TEST_ASSERT_EQUAL_size_t(0, mem);
+
+    /* Raising the limit brings the stream back to memory; packets buffered
+       in RAM after the spill flush after the spilled ones */
+    TEST_ASSERT_EQUAL_INT(0, reinit_packet_buffer_pool(64));
+    feed(lo, 4, 5, 10, 30 * 1024, &pts_lo);
+    packet_buffer_get_stats(lo, NULL, &mem, NULL);
+    TEST_ASSERT_TRUE(mem > 0);
+
+    pts_check_t c = { .ok = true };
+    int flushed = packet_buffer_flush(lo, pts_check_cb, &c);
+    TEST_ASSERT_TRUE(flushed > 10);
+    TEST_ASSERT_TRUE(c.ok);
+    TEST_ASSERT_EQUAL_INT64(pts_lo - 1, c.last_pts);
+
+    destroy_packet_buffer(hi);
+    destroy_packet_buffer(lo);
+
+    /* Retiring the spill removes its backing file */
+    TEST_ASSERT_NOT_EQUAL(0, access(TEST_SPILL_PATH "/buffer/spill_lo_prebuffer.mmap", F_OK));
+}
+
+void test_pooled_ring_shrinks_to_a_lower_budget(void) {
+    packet_buffer_t *b = create_packet_buffer("pool_shrink", 10, BUFFER_MODE_MEMORY_POOLED);
+    TEST_ASSERT_NOT_NULL(b);
+
+    /* ~4 MB window grows the ring well past its initial size */
+    int64_t pts = 0;
+    feed(b, 0, 4, 10, 100 * 1024, &pts);
+    TEST_ASSERT_TRUE(b->ring.capacity > 2 * PACKET_RING_INITIAL_BYTES);
+
+    size_t mem = 0;
+    packet_buffer_get_stats(b, NULL, &mem, NULL);
+    TEST_ASSERT_EQUAL_size_t(b->ring.capacity, mem);
+    TEST_ASSERT_EQUAL_size_t(mem, packet_buffer_get_total_memory_usage());
+
+    /* The whole ring, not just its payload, has to fit a lower limit */
+    TEST_ASSERT_EQUAL_INT(0, packet_buffer_set_memory_limit(b, 1));
+    feed(b, 4, 5, 10, 100 * 1024, &pts);
+    TEST_ASSERT_TRUE(b->ring.capacity <= 1024 * 1024);
+    packet_buffer_get_stats(b, NULL, &mem, NULL);
+    TEST_ASSERT_TRUE(mem <= 1024 * 1024);
+    TEST_ASSERT_EQUAL_size_t(mem, packet_buffer_get_total_memory_usage());
+
+    pts_check_t c = { .ok = true };
+    TEST_ASSERT_TRUE(packet_buffer_flush(b, pts_check_cb, &c) > 0);
+    TEST_ASSERT_TRUE(c.ok);
+    TEST_ASSERT_EQUAL_INT64(pts - 1, c.last_pts);
+
+    destroy_packet_buffer(b);
+    TEST_ASSERT_EQUAL_size_t(0, packet_buffer_get_total_memory_usage());
+}
+
 /* ================================================================
  * estimate_packet_count
  * ================================================================ */
@@ -301,6 +619,13 @@ int main(void) {
     RUN_TEST(test_flush_calls_callback_for_each_packet);
     RUN_TEST(test_flush_null_callback_returns_error);
     RUN_TEST(test_clear_empties_buffer);
+    RUN_TEST(test_pooled_fifo_order_and_payload);
+    RUN_TEST(test_pooled_ring_grows_and_wraps);
+    RUN_TEST(test_pooled_time_eviction);
+    RUN_TEST(test_budget_shrinks_low_priority_first);
+    RUN_TEST(test_unmeasured_buffers_share_the_pool);
+    RUN_TEST(test_spill_to_disk_when_minimum_preroll_does_not_fit);
+    RUN_TEST(test_pooled_ring_shrinks_to_a_lower_budget);
     RUN_TEST(test_estimate_packet_count_positive);
     return UNITY_END();
 }
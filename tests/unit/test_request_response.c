@@ -2,8 +2,9 @@
  * @file test_request_response.c
  * @brief Layer 2 unit tests — HTTP request/response helpers
  *
- * Tests url_decode, header/query-param extraction, path-param extraction,
- * response init/free, set_json, set_json_error, add_header, add_cors_headers.
+ * Tests url_decode, header/query-param extraction, path-param extraction
+ * (by prefix and by captured index), response init/free, set_json,
+ * set_json_error, add_header, add_cors_headers.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -145,6 +146,44 @@ void test_extract_path_param_with_query(void) {
     TEST_ASSERT_EQUAL_STRING("42", param);
 }
 
+/* ================================================================
+ * http_request_get_path_param
+ * ================================================================ */
+
+static void set_path_param(http_request_t *req, int index, const char *value) {
+    const char *at = strstr(req->path, value);
+    req->path_params[index].offset = (uint16_t)(at - req->path);
+    req->path_params[index].length = (uint16_t)strlen(value);
+    if (req->num_path_params <= index) req->num_path_params = index + 1;
+}
+
+void test_get_path_param(void) {
+    http_request_t req;
+    http_request_init(&req);
+    safe_strcpy(req.path, "/api/recordings/thumbnail/42/my%20cam", sizeof(req.path), 0);
+    set_path_param(&req, 0, "42");
+    set_path_param(&req, 1, "my%20cam");
+
+    char param[32];
+    TEST_ASSERT_EQUAL_INT(0, http_request_get_path_param(&req, 0, param, sizeof(param)));
+    TEST_ASSERT_EQUAL_STRING("42", param);
+    TEST_ASSERT_EQUAL_INT(0, http_request_get_path_param(&req, 1, param, sizeof(param)));
+    TEST_ASSERT_EQUAL_STRING("my cam", param);
+}
+
+void test_get_path_param_missing_or_too_long(void) {
+    http_request_t req;
+    http_request_init(&req);
+    safe_strcpy(req.path, "/api/streams/front-door", sizeof(req.path), 0);
+
+    char param[8];
+    TEST_ASSERT_EQUAL_INT(-1, http_request_get_path_param(&req, 0, param, sizeof(param)));
+
+    set_path_param(&req, 0, "front-door");
+    TEST_ASSERT_EQUAL_INT(-1, http_request_get_path_param(&req, 0, param, sizeof(param)));
+    TEST_ASSERT_EQUAL_INT(-1, http_request_get_path_param(&req, 1, param, sizeof(param)));
+}
+
 /* ================================================================
  * http_response helpers
  * ================================================================ */
@@ -247,6 +286,8 @@ int main(void) {
     RUN_TEST(test_extract_path_param);
     RUN_TEST(test_extract_path_param_encoded);
     RUN_TEST(test_extract_path_param_with_query);
+    RUN_TEST(test_get_path_param);
+    RUN_TEST(test_get_path_param_missing_or_too_long);
 
     RUN_TEST(test_response_init_and_free);
     RUN_TEST(test_response_set_json);
@@ -0,0 +1,205 @@
+/**
+ * @file test_route_trie.c
+ * @brief Layer 2 unit tests — HTTP route trie
+ *
+ * Tests literal, '#' and '*' matching, method tables, registration-order
+ * precedence, path-parameter capture and pattern validation.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <string.h>
+#include "unity.h"
+#include "web/route_trie.h"
+
+static route_trie_t trie;
+
+static void handler_a(const http_request_t *req, http_response_t *res) { (void)req; (void)res; }
+static void handler_b(const http_request_t *req, http_response_t *res) { (void)req; (void)res; }
+static void handler_c(const http_request_t *req, http_response_t *res) { (void)req; (void)res; }
+
+static request_handler_t match_handler(http_method_t method, const char *path) {
+    route_match_t match;
+    if (!route_trie_match(&trie, method, path, &match)) {
+        return NULL;
+    }
+    return match.handler;
+}
+
+static void assert_param(const char *path, const route_match_t *match, int index,
+                         const char *expected) {
+    TEST_ASSERT_TRUE(index < match->num_params);
+    TEST_ASSERT_EQUAL_INT((int)strlen(expected), match->params[index].length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, path + match->params[index].offset, strlen(expected));
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void)    { route_trie_init(&trie); }
+void tearDown(void) { route_trie_free(&trie); }
+
+/* ================================================================
+ * literal routes
+ * ================================================================ */
+
+void test_literal_match(void) {
+    route_trie_insert(&trie, "/api/streams", "GET", handler_a);
+    route_trie_insert(&trie, "/api/streams/test", "POST", handler_b);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/streams"));
+    TEST_ASSERT_EQUAL_PTR(handler_b, match_handler(HTTP_METHOD_POST, "/api/streams/test"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/api/stream"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/api/streams/"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/api"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "api/streams"));
+}
+
+void test_method_tables(void) {
+    route_trie_insert(&trie, "/api/settings", "GET", handler_a);
+    route_trie_insert(&trie, "/api/settings", "POST", handler_b);
+    route_trie_insert(&trie, "/api/any", NULL, handler_c);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/settings"));
+    TEST_ASSERT_EQUAL_PTR(handler_b, match_handler(HTTP_METHOD_POST, "/api/settings"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_DELETE, "/api/settings"));
+    TEST_ASSERT_EQUAL_PTR(handler_c, match_handler(HTTP_METHOD_PATCH, "/api/any"));
+    TEST_ASSERT_EQUAL_PTR(handler_c, match_handler(HTTP_METHOD_UNKNOWN, "/api/any"));
+}
+
+/* ================================================================
+ * wildcards
+ * ================================================================ */
+
+void test_hash_matches_one_segment(void) {
+    route_trie_insert(&trie, "/api/streams/#", "GET", handler_a);
+    route_trie_insert(&trie, "/api/streams/#/zones", "GET", handler_b);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/streams/cam1"));
+    TEST_ASSERT_EQUAL_PTR(handler_b, match_handler(HTTP_METHOD_GET, "/api/streams/cam1/zones"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/api/streams/cam1/other"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/api/streams/cam1/zones/x"));
+
+    // An empty segment still matches '#', as it did with the linear matcher
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/streams/"));
+}
+
+void test_star_matches_rest(void) {
+    route_trie_insert(&trie, "/go2rtc/api/hls/*", "GET", handler_a);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/go2rtc/api/hls/playlist.m3u8"));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/go2rtc/api/hls/a/b/c.m4s"));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/go2rtc/api/hls/"));
+    TEST_ASSERT_NULL(match_handler(HTTP_METHOD_GET, "/go2rtc/api/hls"));
+}
+
+void test_deep_path_only_matches_star(void) {
+    route_trie_insert(&trie, "/files/*", "GET", handler_a);
+
+    char path[256] = "/files";
+    for (int i = 0; i < ROUTE_MAX_SEGMENTS + 8; i++) {
+        strcat(path, "/d");
+    }
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, path));
+}
+
+/* ================================================================
+ * precedence
+ * ================================================================ */
+
+void test_first_registered_wins(void) {
+    route_trie_insert(&trie, "/api/streams/#", "GET", handler_a);
+    route_trie_insert(&trie, "/api/streams/test", "GET", handler_b);
+    route_trie_insert(&trie, "/api/recordings/files", "GET", handler_c);
+    route_trie_insert(&trie, "/api/recordings/#", "GET", handler_a);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/streams/test"));
+    TEST_ASSERT_EQUAL_PTR(handler_c, match_handler(HTTP_METHOD_GET, "/api/recordings/files"));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/recordings/42"));
+}
+
+void test_any_method_respects_order(void) {
+    route_trie_insert(&trie, "/api/x", NULL, handler_a);
+    route_trie_insert(&trie, "/api/x", "GET", handler_b);
+    route_trie_insert(&trie, "/api/y", "GET", handler_b);
+    route_trie_insert(&trie, "/api/y", NULL, handler_a);
+
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/x"));
+    TEST_ASSERT_EQUAL_PTR(handler_b, match_handler(HTTP_METHOD_GET, "/api/y"));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_POST, "/api/y"));
+}
+
+void test_duplicate_keeps_first(void) {
+    TEST_ASSERT_EQUAL_INT(0, route_trie_insert(&trie, "/api/dup", "GET", handler_a));
+    TEST_ASSERT_EQUAL_INT(0, route_trie_insert(&trie, "/api/dup", "GET", handler_b));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match_handler(HTTP_METHOD_GET, "/api/dup"));
+}
+
+/* ================================================================
+ * parameter capture
+ * ================================================================ */
+
+void test_params_captured(void) {
+    route_trie_insert(&trie, "/api/recordings/thumbnail/#/#", "GET", handler_a);
+
+    const char *path = "/api/recordings/thumbnail/1234/2";
+    route_match_t match;
+    TEST_ASSERT_TRUE(route_trie_match(&trie, HTTP_METHOD_GET, path, &match));
+    TEST_ASSERT_EQUAL_INT(2, match.num_params);
+    assert_param(path, &match, 0, "1234");
+    assert_param(path, &match, 1, "2");
+}
+
+void test_params_follow_winning_route(void) {
+    route_trie_insert(&trie, "/api/users/me", "GET", handler_a);
+    route_trie_insert(&trie, "/api/users/#", "GET", handler_b);
+
+    route_match_t match;
+    TEST_ASSERT_TRUE(route_trie_match(&trie, HTTP_METHOD_GET, "/api/users/me", &match));
+    TEST_ASSERT_EQUAL_PTR(handler_a, match.handler);
+    TEST_ASSERT_EQUAL_INT(0, match.num_params);
+
+    const char *path = "/api/users/7";
+    TEST_ASSERT_TRUE(route_trie_match(&trie, HTTP_METHOD_GET, path, &match));
+    TEST_ASSERT_EQUAL_PTR(handler_b, match.handler);
+    assert_param(path, &match, 0, "7");
+}
+
+/* ================================================================
+ * pattern validation
+ * ================================================================ */
+
+void test_invalid_patterns_rejected(void) {
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "api/streams", "GET", handler_a));
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "/api/str#", "GET", handler_a));
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "/api/*/x", "GET", handler_a));
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "/#/#/#/#/#", "GET", handler_a));
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "/api/x", "BREW", handler_a));
+    TEST_ASSERT_EQUAL_INT(-1, route_trie_insert(&trie, "/api/x", "GET", NULL));
+    TEST_ASSERT_EQUAL_INT(0, trie.route_count);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_literal_match);
+    RUN_TEST(test_method_tables);
+
+    RUN_TEST(test_hash_matches_one_segment);
+    RUN_TEST(test_star_matches_rest);
+    RUN_TEST(test_deep_path_only_matches_star);
+
+    RUN_TEST(test_first_registered_wins);
+    RUN_TEST(test_any_method_respects_order);
+    RUN_TEST(test_duplicate_keeps_first);
+
+    RUN_TEST(test_params_captured);
+    RUN_TEST(test_params_follow_winning_route);
+
+    RUN_TEST(test_invalid_patterns_rejected);
+
+    return UNITY_END();
+}
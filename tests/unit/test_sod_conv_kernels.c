@@ -0,0 +1,220 @@
+/**
+ * @file test_sod_conv_kernels.c
+ * @brief Layer 1 Unity tests for the SOD convolution kernels
+ *
+ * The cache-blocked GEMM and the Winograd F(2x2,3x3) convolution are static
+ * in src/sod/sod.c, so the library source is compiled into this test.  Both
+ * are checked against naive reference loops, single threaded and through
+ * the worker pool, on shapes that exercise the partial MR/NR/KC blocks and
+ * odd output sizes.
+ */
+
+#include "../../src/sod/sod.c"
+
+#include "unity.h"
+
+#define KERNEL_TOLERANCE 1e-4f
+
+static unsigned int rng_state;
+
+/* Deterministic values in [-1, 1) */
+static float next_value(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (float)((rng_state >> 8) & 0xffff) / 32768.0f - 1.0f;
+}
+
+static float *random_buffer(size_t count) {
+    float *buf = malloc(count * sizeof(float));
+    TEST_ASSERT_NOT_NULL(buf);
+    for (size_t i = 0; i < count; i++) {
+        buf[i] = next_value();
+    }
+    return buf;
+}
+
+static void assert_close(const float *expected, const float *actual, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(KERNEL_TOLERANCE, expected[i], actual[i]);
+    }
+}
+
+/* ---- reference implementations ---- */
+
+static void naive_gemm(int M, int N, int K, float alpha, const float *A, const float *B, float *C) {
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) {
+            double sum = 0;
+            for (int k = 0; k < K; k++) {
+                sum += (double)A[i * K + k] * B[k * N + j];
+            }
+            C[i * N + j] += alpha * (float)sum;
+        }
+    }
+}
+
+/* 3x3, stride 1, pad 1; weights are [n][c][3][3] */
+static void naive_conv3x3(int c, int n, int h, int w, const float *weights, const float *input,
+                          float *output) {
+    for (int k = 0; k < n; k++) {
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                double sum = 0;
+                for (int ch = 0; ch < c; ch++) {
+                    for (int dy = 0; dy < 3; dy++) {
+                        for (int dx = 0; dx < 3; dx++) {
+                            int iy = y + dy - 1;
+                            int ix = x + dx - 1;
+                            if (iy < 0 || ix < 0 || iy >= h || ix >= w) continue;
+                            sum += (double)weights[((k * c + ch) * 3 + dy) * 3 + dx] *
+                                   input[(ch * h + iy) * w + ix];
+                        }
+                    }
+                }
+                output[(k * h + y) * w + x] = (float)sum;
+            }
+        }
+    }
+}
+
+/* ---- helpers ---- */
+
+static void check_gemm(int M, int N, int K) {
+    float *A = random_buffer((size_t)M * K);
+    float *B = random_buffer((size_t)K * N);
+    float *C = random_buffer((size_t)M * N);
+    float *expected = malloc((size_t)M * N * sizeof(float));
+    TEST_ASSERT_NOT_NULL(expected);
+    memcpy(expected, C, (size_t)M * N * sizeof(float));
+
+    naive_gemm(M, N, K, 0.5f, A, B, expected);
+    gemm(0, 0, M, N, K, 0.5f, A, K, B, N, 1, C, N);
+    assert_close(expected, C, (size_t)M * N);
+
+    free(A);
+    free(B);
+    free(C);
+    free(expected);
+}
+
+static void check_winograd(int c, int n, int h, int w) {
+    layer l;
+    memset(&l, 0, sizeof(l));
+    l.type = CONVOLUTIONAL;
+    l.size = 3;
+    l.stride = 1;
+    l.pad = 1;
+    l.c = c;
+    l.n = n;
+    l.h = l.out_h = h;
+    l.w = l.out_w = w;
+    TEST_ASSERT_TRUE(conv_winograd_eligible(&l));
+
+    l.weights = random_buffer((size_t)n * c * 9);
+    l.winograd_weights = malloc((size_t)16 * n * c * sizeof(float));
+    TEST_ASSERT_NOT_NULL(l.winograd_weights);
+    winograd_transform_weights(&l);
+
+    int tiles = WINOGRAD_TILES(l);
+    float *workspace = malloc((size_t)16 * (c + n) * tiles * sizeof(float));
+    float *input = random_buffer((size_t)c * h * w);
+    float *output = malloc((size_t)n * h * w * sizeof(float));
+    float *expected = malloc((size_t)n * h * w * sizeof(float));
+    TEST_ASSERT_NOT_NULL(workspace);
+    TEST_ASSERT_NOT_NULL(output);
+    TEST_ASSERT_NOT_NULL(expected);
+
+    naive_conv3x3(c, n, h, w, l.weights, input, expected);
+    forward_convolutional_winograd(&l, input, output, workspace);
+    assert_close(expected, output, (size_t)n * h * w);
+
+    free(l.weights);
+    free(l.winograd_weights);
+    free(workspace);
+    free(input);
+    free(output);
+    free(expected);
+}
+
+void setUp(void) {
+    rng_state = 1;
+}
+
+void tearDown(void) {
+    sod_pool_set_threads(1);
+}
+
+/* ================================================================
+ * Blocked GEMM
+ * ================================================================ */
+
+void test_gemm_matches_naive_on_partial_blocks(void) {
+    /* M, N and K all leave a remainder against MR, NR and KC */
+    check_gemm(7, 2 * SOD_GEMM_NR + 3, SOD_GEMM_KC + 5);
+    check_gemm(1, 1, 1);
+    check_gemm(SOD_GEMM_MR, SOD_GEMM_NR, 9);
+}
+
+void test_gemm_matches_naive_through_pool(void) {
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_pool_set_threads(4));
+    /* Large enough to pass SOD_GEMM_PARALLEL_MIN and be split by rows */
+    check_gemm(67, 130, 150);
+}
+
+void test_gemm_applies_beta(void) {
+    float A[2] = {1.0f, 2.0f};
+    float B[2] = {3.0f, 4.0f};
+    float C[1] = {10.0f};
+    gemm(0, 0, 1, 1, 2, 1, A, 2, B, 1, 0, C, 1);
+    TEST_ASSERT_FLOAT_WITHIN(KERNEL_TOLERANCE, 11.0f, C[0]);
+}
+
+/* ================================================================
+ * Winograd F(2x2,3x3)
+ * ================================================================ */
+
+void test_winograd_matches_naive_even_size(void) {
+    check_winograd(8, 8, 6, 6);
+}
+
+void test_winograd_matches_naive_odd_size(void) {
+    /* Odd output sizes leave half-filled tiles on the right and bottom */
+    check_winograd(9, 11, 7, 5);
+}
+
+void test_winograd_matches_naive_through_pool(void) {
+    TEST_ASSERT_EQUAL_INT(SOD_OK, sod_pool_set_threads(4));
+    check_winograd(16, 24, 13, 17);
+}
+
+void test_winograd_skips_ineligible_layers(void) {
+    layer l;
+    memset(&l, 0, sizeof(l));
+    l.type = CONVOLUTIONAL;
+    l.size = 3;
+    l.stride = 1;
+    l.pad = 1;
+    l.c = 3;
+    l.n = 16;
+    l.h = l.out_h = 8;
+    l.w = l.out_w = 8;
+    TEST_ASSERT_FALSE(conv_winograd_eligible(&l));
+    l.c = 16;
+    l.stride = 2;
+    TEST_ASSERT_FALSE(conv_winograd_eligible(&l));
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_gemm_matches_naive_on_partial_blocks);
+    RUN_TEST(test_gemm_matches_naive_through_pool);
+    RUN_TEST(test_gemm_applies_beta);
+    RUN_TEST(test_winograd_matches_naive_even_size);
+    RUN_TEST(test_winograd_matches_naive_odd_size);
+    RUN_TEST(test_winograd_matches_naive_through_pool);
+    RUN_TEST(test_winograd_skips_ineligible_layers);
+    return UNITY_END();
+}
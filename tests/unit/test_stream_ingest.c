@@ -0,0 +1,231 @@
+/**
+ * @file test_stream_ingest.c
+ * @brief Layer 2 Unity tests for video/stream_ingest.c
+ *
+ * Covers the per-consumer rings behind the shared ingest: ordering and
+ * wrap-around, zero-copy delivery, starting on a keyframe, both drop
+ * policies, draining after the source is lost, and timeout / interrupt
+ * handling.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+
+#include "unity.h"
+#include "video/stream_ingest.h"
+#include "video/stream_ingest_internal.h"
+
+static stream_ingest_queue_t *queue;
+static AVPacket *out;
+
+/* ---- helpers ---- */
+
+static stream_ingest_queue_t *make_queue(int packets, stream_ingest_drop_policy_t policy) {
+    stream_ingest_consumer_config_t cfg = { .queue_packets = packets, .drop_policy = policy };
+    stream_ingest_queue_t *q = stream_ingest_queue_create(&cfg);
+    TEST_ASSERT_NOT_NULL(q);
+    return q;
+}
+
+static int push(int64_t pts, bool keyframe, bool is_video) {
+    AVPacket *pkt = av_packet_alloc();
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, av_new_packet(pkt, 32));
+    memset(pkt->data, (int)(pts & 0xFF), 32);
+    pkt->pts = pts;
+    pkt->dts = pts;
+    if (keyframe)
+        pkt->flags |= AV_PKT_FLAG_KEY;
+    int ret = stream_ingest_queue_push(queue, pkt, is_video);
+    av_packet_free(&pkt);
+    return ret;
+}
+
+static int64_t pop_pts(void) {
+    TEST_ASSERT_EQUAL_INT(0, stream_ingest_queue_pop(queue, out, NULL, 0));
+    int64_t pts = out->pts;
+    av_packet_unref(out);
+    return pts;
+}
+
+static int always_interrupt(void *opaque) {
+    (void)opaque;
+    return 1;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    queue = NULL;
+    out = av_packet_alloc();
+}
+
+void tearDown(void) {
+    stream_ingest_queue_destroy(queue);
+    queue = NULL;
+    av_packet_free(&out);
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_packets_are_delivered_in_order_across_wraparound(void) {
+    queue = make_queue(3, STREAM_INGEST_DROP_NEWEST);   /* rounded up to 4 */
+
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 4; i++) {
+            TEST_ASSERT_EQUAL_INT(1, push(round * 4 + i, i == 0, true));
+        }
+        for (int i = 0; i < 4; i++) {
+            TEST_ASSERT_EQUAL_INT64(round * 4 + i, pop_pts());
+        }
+    }
+
+    stream_ingest_stats_t stats = {0};
+    stream_ingest_queue_stats(queue, &stats);
+    TEST_ASSERT_EQUAL_INT(0, stats.queued);
+    TEST_ASSERT_EQUAL_UINT64(20, stats.packets_delivered);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.packets_dropped);
+}
+
+void test_consumer_gets_a_reference_not_a_copy(void) {
+    queue = make_queue(4, STREAM_INGEST_DROP_NEWEST);
+
+    AVPacket *pkt = av_packet_alloc();
+    TEST_ASSERT_EQUAL_INT(0, av_new_packet(pkt, 64));
+    pkt->pts = 7;
+    pkt->flags |= AV_PKT_FLAG_KEY;
+    TEST_ASSERT_EQUAL_INT(1, stream_ingest_queue_push(queue, pkt, true));
+
+    TEST_ASSERT_EQUAL_INT(0, stream_ingest_queue_pop(queue, out, NULL, 0));
+    TEST_ASSERT_EQUAL_PTR(pkt->data, out->data);
+    TEST_ASSERT_EQUAL_INT64(7, out->pts);
+
+    av_packet_unref(out);
+    av_packet_free(&pkt);
+}
+
+void test_new_queue_waits_for_first_video_keyframe(void) {
+    queue = make_queue(8, STREAM_INGEST_DROP_NEWEST);
+
+    TEST_ASSERT_EQUAL_INT(0, push(0, false, true));     /* mid-GOP */
+    TEST_ASSERT_EQUAL_INT(0, push(1, true, false));     /* audio */
+    TEST_ASSERT_EQUAL_INT(1, push(2, true, true));
+    TEST_ASSERT_EQUAL_INT(1, push(3, false, false));
+    TEST_ASSERT_EQUAL_INT(1, push(4, false, true));
+
+    TEST_ASSERT_EQUAL_INT64(2, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(3, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(4, pop_pts());
+
+    stream_ingest_stats_t stats = {0};
+    stream_ingest_queue_stats(queue, &stats);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.packets_dropped);
+}
+
+void test_drop_newest_keeps_queued_packets(void) {
+    queue = make_queue(4, STREAM_INGEST_DROP_NEWEST);
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(1, push(i, i == 0, true));
+    }
+    TEST_ASSERT_EQUAL_INT(0, push(4, false, true));
+    TEST_ASSERT_EQUAL_INT(0, push(5, false, true));
+
+    TEST_ASSERT_EQUAL_INT64(0, pop_pts());
+
+    // Room again: the next packet is accepted even though it is not a keyframe
+    TEST_ASSERT_EQUAL_INT(1, push(6, false, true));
+    TEST_ASSERT_EQUAL_INT64(1, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(2, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(3, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(6, pop_pts());
+
+    stream_ingest_stats_t stats = {0};
+    stream_ingest_queue_stats(queue, &stats);
+    TEST_ASSERT_EQUAL_UINT64(2, stats.packets_dropped);
+}
+
+void test_drop_to_keyframe_resumes_on_next_video_keyframe(void) {
+    queue = make_queue(4, STREAM_INGEST_DROP_TO_KEYFRAME);
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(1, push(i, i == 0, true));
+    }
+    TEST_ASSERT_EQUAL_INT(0, push(4, false, true));     /* overflow */
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT64(i, pop_pts());
+    }
+
+    // The ring is empty but the GOP is broken: wait for a video keyframe
+    TEST_ASSERT_EQUAL_INT(0, push(5, false, true));
+    TEST_ASSERT_EQUAL_INT(0, push(6, true, false));     /* audio "keyframe" */
+    TEST_ASSERT_EQUAL_INT(1, push(7, true, true));
+    TEST_ASSERT_EQUAL_INT(1, push(8, false, true));
+
+    TEST_ASSERT_EQUAL_INT64(7, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(8, pop_pts());
+
+    stream_ingest_stats_t stats = {0};
+    stream_ingest_queue_stats(queue, &stats);
+    TEST_ASSERT_EQUAL_UINT64(3, stats.packets_dropped);
+}
+
+void test_lost_source_drains_then_reports_eof(void) {
+    queue = make_queue(8, STREAM_INGEST_DROP_TO_KEYFRAME);
+
+    TEST_ASSERT_EQUAL_INT(1, push(0, true, true));
+    TEST_ASSERT_EQUAL_INT(1, push(1, false, true));
+    stream_ingest_queue_mark_lost(queue);
+    TEST_ASSERT_EQUAL_INT(0, push(2, true, true));
+
+    TEST_ASSERT_EQUAL_INT64(0, pop_pts());
+    TEST_ASSERT_EQUAL_INT64(1, pop_pts());
+    TEST_ASSERT_EQUAL_INT(AVERROR_EOF, stream_ingest_queue_pop(queue, out, NULL, 1000));
+}
+
+void test_empty_queue_times_out_or_is_interrupted(void) {
+    queue = make_queue(4, STREAM_INGEST_DROP_NEWEST);
+
+    TEST_ASSERT_EQUAL_INT(AVERROR(EAGAIN), stream_ingest_queue_pop(queue, out, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(AVERROR(EAGAIN), stream_ingest_queue_pop(queue, out, NULL, 50));
+
+    AVIOInterruptCB interrupt = { .callback = always_interrupt, .opaque = NULL };
+    TEST_ASSERT_EQUAL_INT(AVERROR_EXIT, stream_ingest_queue_pop(queue, out, &interrupt, 1000));
+}
+
+void test_plain_context_is_not_shared(void) {
+    TEST_ASSERT_FALSE(stream_ingest_is_shared(NULL));
+
+    AVFormatContext *ctx = avformat_alloc_context();
+    TEST_ASSERT_NOT_NULL(ctx);
+    TEST_ASSERT_FALSE(stream_ingest_is_shared(ctx));
+
+    stream_ingest_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(-1, stream_ingest_get_stats(ctx, &stats));
+    avformat_free_context(ctx);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_packets_are_delivered_in_order_across_wraparound);
+    RUN_TEST(test_consumer_gets_a_reference_not_a_copy);
+    RUN_TEST(test_new_queue_waits_for_first_video_keyframe);
+    RUN_TEST(test_drop_newest_keeps_queued_packets);
+    RUN_TEST(test_drop_to_keyframe_resumes_on_next_video_keyframe);
+    RUN_TEST(test_lost_source_drains_then_reports_eof);
+    RUN_TEST(test_empty_queue_times_out_or_is_interrupted);
+    RUN_TEST(test_plain_context_is_not_shared);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_thumbnail_engine.c
+ * @brief Layer 2 Unity tests for the thumbnail memory cache in video/thumbnail_engine.c
+ *
+ * Covers insert / lookup / replace, least-recently-used eviction against the
+ * byte budget, removal, oversize rejection and shrinking the budget.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "video/thumbnail_engine.h"
+
+/* ---- helpers ---- */
+
+static void put_filled(const char *key, unsigned char fill, size_t size) {
+    unsigned char *buf = malloc(size);
+    TEST_ASSERT_NOT_NULL(buf);
+    memset(buf, fill, size);
+    TEST_ASSERT_EQUAL_INT(0, thumbnail_cache_put(key, buf, size));
+    free(buf);
+}
+
+static bool cached(const char *key) {
+    unsigned char *data = NULL;
+    size_t size = 0;
+    if (thumbnail_cache_get(key, &data, &size) != 0) {
+        return false;
+    }
+    free(data);
+    return true;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    thumbnail_cache_clear();
+    thumbnail_cache_set_limit(THUMBNAIL_CACHE_DEFAULT_BYTES);
+}
+
+void tearDown(void) {
+    thumbnail_cache_clear();
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_get_returns_a_copy_of_the_stored_data(void) {
+    const unsigned char jpeg[] = { 0xFF, 0xD8, 0x01, 0x02, 0xFF, 0xD9 };
+    TEST_ASSERT_EQUAL_INT(0, thumbnail_cache_put("/thumbs/1_0.jpg", jpeg, sizeof(jpeg)));
+
+    unsigned char *data = NULL;
+    size_t size = 0;
+    TEST_ASSERT_EQUAL_INT(0, thumbnail_cache_get("/thumbs/1_0.jpg", &data, &size));
+    TEST_ASSERT_EQUAL_size_t(sizeof(jpeg), size);
+    TEST_ASSERT_EQUAL_MEMORY(jpeg, data, sizeof(jpeg));
+    TEST_ASSERT_TRUE(data != jpeg);
+    free(data);
+
+    TEST_ASSERT_EQUAL_INT(-1, thumbnail_cache_get("/thumbs/1_1.jpg", &data, &size));
+}
+
+void test_put_replaces_existing_entry(void) {
+    put_filled("k", 0xAA, 100);
+    put_filled("k", 0xBB, 40);
+
+    int entries = 0;
+    size_t bytes = 0;
+    thumbnail_cache_get_usage(&entries, &bytes);
+    TEST_ASSERT_EQUAL_INT(1, entries);
+    TEST_ASSERT_EQUAL_size_t(40, bytes);
+
+    unsigned char *data = NULL;
+    size_t size = 0;
+    TEST_ASSERT_EQUAL_INT(0, thumbnail_cache_get("k", &data, &size));
+    TEST_ASSERT_EQUAL_size_t(40, size);
+    TEST_ASSERT_EQUAL_HEX8(0xBB, data[0]);
+    free(data);
+}
+
+void test_least_recently_used_entry_is_evicted_first(void) {
+    thumbnail_cache_set_limit(300);
+    put_filled("a", 1, 100);
+    put_filled("b", 2, 100);
+    put_filled("c", 3, 100);
+
+    // Touch "a" so "b" becomes the oldest
+    TEST_ASSERT_TRUE(cached("a"));
+    put_filled("d", 4, 100);
+
+    TEST_ASSERT_TRUE(cached("a"));
+    TEST_ASSERT_FALSE(cached("b"));
+    TEST_ASSERT_TRUE(cached("c"));
+    TEST_ASSERT_TRUE(cached("d"));
+
+    size_t bytes = 0;
+    thumbnail_cache_get_usage(NULL, &bytes);
+    TEST_ASSERT_EQUAL_size_t(300, bytes);
+}
+
+void test_remove_drops_only_that_entry(void) {
+    put_filled("a", 1, 10);
+    put_filled("b", 2, 10);
+
+    thumbnail_cache_remove("a");
+    thumbnail_cache_remove("missing");
+
+    TEST_ASSERT_FALSE(cached("a"));
+    TEST_ASSERT_TRUE(cached("b"));
+
+    int entries = 0;
+    thumbnail_cache_get_usage(&entries, NULL);
+    TEST_ASSERT_EQUAL_INT(1, entries);
+}
+
+void test_entry_larger_than_budget_is_rejected(void) {
+    thumbnail_cache_set_limit(64);
+    put_filled("small", 1, 32);
+
+    unsigned char big[128] = {0};
+    TEST_ASSERT_EQUAL_INT(-1, thumbnail_cache_put("big", big, sizeof(big)));
+
+    // The rejected put must not have evicted anything
+    TEST_ASSERT_TRUE(cached("small"));
+    TEST_ASSERT_FALSE(cached("big"));
+}
+
+void test_lowering_the_limit_evicts_to_fit(void) {
+    put_filled("a", 1, 100);
+    put_filled("b", 2, 100);
+    put_filled("c", 3, 100);
+
+    thumbnail_cache_set_limit(150);
+
+    int entries = 0;
+    size_t bytes = 0;
+    thumbnail_cache_get_usage(&entries, &bytes);
+    TEST_ASSERT_EQUAL_INT(1, entries);
+    TEST_ASSERT_EQUAL_size_t(100, bytes);
+    TEST_ASSERT_TRUE(cached("c"));
+
+    // A zero budget disables the cache
+    thumbnail_cache_set_limit(0);
+    unsigned char one = 1;
+    TEST_ASSERT_EQUAL_INT(-1, thumbnail_cache_put("d", &one, 1));
+    thumbnail_cache_get_usage(&entries, NULL);
+    TEST_ASSERT_EQUAL_INT(0, entries);
+}
+
+void test_render_rejects_missing_input(void) {
+    unsigned char *jpeg = (unsigned char *)"sentinel";
+    size_t size = 123;
+    TEST_ASSERT_EQUAL_INT(-1, thumbnail_engine_render(NULL, 0, 320, 75, &jpeg, &size));
+    TEST_ASSERT_EQUAL_INT(-1, thumbnail_engine_render("/nonexistent/recording.mp4", 1.0, 320, 75,
+                                                      &jpeg, &size));
+    TEST_ASSERT_NULL(jpeg);
+    TEST_ASSERT_EQUAL_size_t(0, size);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_get_returns_a_copy_of_the_stored_data);
+    RUN_TEST(test_put_replaces_existing_entry);
+    RUN_TEST(test_least_recently_used_entry_is_evicted_first);
+    RUN_TEST(test_remove_drops_only_that_entry);
+    RUN_TEST(test_entry_larger_than_budget_is_rejected);
+    RUN_TEST(test_lowering_the_limit_evicts_to_fit);
+    RUN_TEST(test_render_rejects_missing_input);
+    return UNITY_END();
+}
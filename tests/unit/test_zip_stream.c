@@ -0,0 +1,224 @@
+/**
+ * @file test_zip_stream.c
+ * @brief Layer 2 Unity tests for web/zip_stream.c
+ *
+ * Assembles archives in memory the way the libuv sender does (local header,
+ * data, data descriptor, then the trailer) and checks the CRC-32, the
+ * precomputed offsets and total length, and when ZIP64 records are used.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "web/zip_stream.h"
+
+static zip_stream_t g_zs;
+
+/* ---- helpers ---- */
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+/* Stream the archive into a buffer, with the data of entry i given by contents[i] */
+static uint8_t *assemble(const char **contents, size_t *len) {
+    uint64_t total = zip_stream_total_size(&g_zs);
+    uint8_t *out = malloc((size_t)total);
+    TEST_ASSERT_NOT_NULL(out);
+
+    size_t pos = 0;
+    for (int i = 0; i < g_zs.count; i++) {
+        zip_stream_entry_t *e = &g_zs.entries[i];
+        TEST_ASSERT_EQUAL_UINT64(e->offset, pos);
+        pos += zip_stream_local_header(e, out + pos);
+
+        // Feed the data in two pieces to exercise the running CRC
+        size_t n = (size_t)e->size;
+        e->crc = zip_stream_crc32(0, contents[i], n / 2);
+        e->crc = zip_stream_crc32(e->crc, contents[i] + n / 2, n - n / 2);
+        memcpy(out + pos, contents[i], n);
+        pos += n;
+
+        pos += zip_stream_data_descriptor(e, out + pos);
+    }
+    TEST_ASSERT_EQUAL_UINT64(g_zs.data_end, pos);
+
+    size_t trailer_len = 0;
+    uint8_t *trailer = zip_stream_build_trailer(&g_zs, &trailer_len);
+    TEST_ASSERT_NOT_NULL(trailer);
+    memcpy(out + pos, trailer, trailer_len);
+    free(trailer);
+    pos += trailer_len;
+
+    TEST_ASSERT_EQUAL_UINT64(total, pos);
+    *len = pos;
+    return out;
+}
+
+/* ---- Unity boilerplate ---- */
+void setUp(void) {
+    TEST_ASSERT_EQUAL_INT(0, zip_stream_init(&g_zs, 4));
+}
+
+void tearDown(void) {
+    zip_stream_free(&g_zs);
+}
+
+/* ================================================================
+ * tests
+ * ================================================================ */
+
+void test_crc32_check_value(void) {
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, zip_stream_crc32(0, "123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0, zip_stream_crc32(0, "", 0));
+
+    // Any split gives the same result as one pass
+    const char *text = "The quick brown fox jumps over the lazy dog";
+    size_t n = strlen(text);
+    uint32_t whole = zip_stream_crc32(0, text, n);
+    TEST_ASSERT_EQUAL_HEX32(0x414FA339u, whole);
+    for (size_t split = 0; split <= n; split++) {
+        uint32_t crc = zip_stream_crc32(0, text, split);
+        TEST_ASSERT_EQUAL_HEX32(whole, zip_stream_crc32(crc, text + split, n - split));
+    }
+}
+
+void test_add_respects_capacity(void) {
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(i, zip_stream_add(&g_zs, "a.mp4", "/tmp/a.mp4", 10, 0));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, zip_stream_add(&g_zs, "a.mp4", "/tmp/a.mp4", 10, 0));
+}
+
+void test_empty_archive_is_end_record_only(void) {
+    size_t len = 0;
+    uint8_t *zip = assemble(NULL, &len);
+    TEST_ASSERT_EQUAL_size_t(22, len);
+    TEST_ASSERT_EQUAL_HEX32(0x06054b50u, get_u32(zip));
+    free(zip);
+}
+
+void test_small_archive_layout(void) {
+    const char *contents[] = { "hello world", "123456789" };
+    zip_stream_add(&g_zs, "one.mp4", "/unused", strlen(contents[0]), 1700000000);
+    zip_stream_add(&g_zs, "two.mp4", "/unused", strlen(contents[1]), 1700000000);
+
+    size_t len = 0;
+    uint8_t *zip = assemble(contents, &len);
+
+    // Local header: data descriptor flag, no CRC yet, sizes filled in
+    TEST_ASSERT_EQUAL_HEX32(0x04034b50u, get_u32(zip));
+    TEST_ASSERT_EQUAL_UINT16(20, get_u16(zip + 4));
+    TEST_ASSERT_EQUAL_HEX16(0x0008, get_u16(zip + 6));
+    TEST_ASSERT_EQUAL_HEX32(0, get_u32(zip + 14));
+    TEST_ASSERT_EQUAL_UINT32(11, get_u32(zip + 18));
+    TEST_ASSERT_EQUAL_UINT16(0, get_u16(zip + 28));
+    TEST_ASSERT_EQUAL_MEMORY("one.mp4hello world", zip + 30, 18);
+
+    // 32-bit data descriptor right after the data
+    const uint8_t *dd = zip + 30 + 7 + 11;
+    TEST_ASSERT_EQUAL_HEX32(0x08074b50u, get_u32(dd));
+    TEST_ASSERT_EQUAL_HEX32(g_zs.entries[0].crc, get_u32(dd + 4));
+    TEST_ASSERT_EQUAL_UINT32(11, get_u32(dd + 8));
+
+    // End record points at a central directory that points back at entry 2
+    const uint8_t *eocd = zip + len - 22;
+    TEST_ASSERT_EQUAL_HEX32(0x06054b50u, get_u32(eocd));
+    TEST_ASSERT_EQUAL_UINT16(2, get_u16(eocd + 10));
+    uint32_t cd_offset = get_u32(eocd + 16);
+    TEST_ASSERT_EQUAL_UINT64(g_zs.data_end, cd_offset);
+
+    const uint8_t *cd = zip + cd_offset;
+    TEST_ASSERT_EQUAL_HEX32(0x02014b50u, get_u32(cd));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, get_u32(cd + 46 + 7 + 16));
+    const uint8_t *cd2 = cd + 46 + 7;
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, get_u32(cd2 + 16));
+    TEST_ASSERT_EQUAL_UINT32(g_zs.entries[1].offset, get_u32(cd2 + 42));
+    TEST_ASSERT_EQUAL_HEX32(0x04034b50u, get_u32(zip + get_u32(cd2 + 42)));
+
+    free(zip);
+}
+
+void test_large_entry_uses_zip64(void) {
+    uint64_t big = 5ULL * 1024 * 1024 * 1024;
+    zip_stream_add(&g_zs, "big.mp4", "/unused", big, 1700000000);
+    zip_stream_add(&g_zs, "after.mp4", "/unused", 100, 1700000000);
+    g_zs.entries[0].crc = 0x12345678u;
+
+    // Local header carries the sizes in the ZIP64 extra field
+    uint8_t hdr[ZIP_STREAM_HEADER_MAX];
+    size_t n = zip_stream_local_header(&g_zs.entries[0], hdr);
+    TEST_ASSERT_EQUAL_size_t(30 + 7 + 20, n);
+    TEST_ASSERT_EQUAL_UINT16(45, get_u16(hdr + 4));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, get_u32(hdr + 18));
+    TEST_ASSERT_EQUAL_HEX16(0x0001, get_u16(hdr + 37));
+    TEST_ASSERT_EQUAL_UINT64(big, get_u64(hdr + 41));
+
+    // ... and its descriptor uses 8-byte sizes
+    n = zip_stream_data_descriptor(&g_zs.entries[0], hdr);
+    TEST_ASSERT_EQUAL_size_t(24, n);
+    TEST_ASSERT_EQUAL_UINT64(big, get_u64(hdr + 16));
+
+    // The entry after it starts past 4 GiB but is small itself
+    TEST_ASSERT_EQUAL_UINT64(57 + big + 24, g_zs.entries[1].offset);
+    TEST_ASSERT_EQUAL_size_t(30 + 9, zip_stream_local_header(&g_zs.entries[1], hdr));
+
+    size_t len = 0;
+    uint8_t *trailer = zip_stream_build_trailer(&g_zs, &len);
+    TEST_ASSERT_NOT_NULL(trailer);
+    TEST_ASSERT_EQUAL_UINT64(zip_stream_total_size(&g_zs), g_zs.data_end + len);
+
+    // Second central entry has only the offset in its ZIP64 extra field
+    const uint8_t *cd2 = trailer + 46 + 7 + 4 + 16;
+    TEST_ASSERT_EQUAL_HEX32(0x02014b50u, get_u32(cd2));
+    TEST_ASSERT_EQUAL_UINT16(12, get_u16(cd2 + 30));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, get_u32(cd2 + 42));
+    TEST_ASSERT_EQUAL_UINT64(g_zs.entries[1].offset, get_u64(cd2 + 46 + 9 + 4));
+
+    // ZIP64 end record and locator precede the classic end record
+    const uint8_t *eocd = trailer + len - 22;
+    const uint8_t *locator = eocd - 20;
+    const uint8_t *eocd64 = locator - 56;
+    TEST_ASSERT_EQUAL_HEX32(0x06064b50u, get_u32(eocd64));
+    TEST_ASSERT_EQUAL_UINT64(2, get_u64(eocd64 + 32));
+    TEST_ASSERT_EQUAL_UINT64(g_zs.data_end, get_u64(eocd64 + 48));
+    TEST_ASSERT_EQUAL_HEX32(0x07064b50u, get_u32(locator));
+    TEST_ASSERT_EQUAL_UINT64(g_zs.data_end + (uint64_t)(eocd64 - trailer), get_u64(locator + 8));
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, get_u32(eocd + 16));
+
+    free(trailer);
+}
+
+void test_dos_time_before_1980_is_clamped(void) {
+    zip_stream_add(&g_zs, "old.mp4", "/unused", 1, 0);
+    TEST_ASSERT_EQUAL_HEX16(0x0021, g_zs.entries[0].dos_date);
+    TEST_ASSERT_EQUAL_HEX16(0, g_zs.entries[0].dos_time);
+}
+
+/* ================================================================
+ * main
+ * ================================================================ */
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_add_respects_capacity);
+    RUN_TEST(test_empty_archive_is_end_record_only);
+    RUN_TEST(test_small_archive_layout);
+    RUN_TEST(test_large_entry_uses_zip64);
+    RUN_TEST(test_dos_time_before_1980_is_clamped);
+    return UNITY_END();
+}
@@ -5,6 +5,8 @@
  * Tests:
  *   filter_detections_by_zones     — zone polygon + class/confidence gate
  *   filter_detections_by_stream_objects — include/exclude object list
+ *   build_motion_zone_mask         — grid mask from the same zones
+ *   compiled zone cache            — reload on zone changes, exact edges
  *
  * Both functions query SQLite (zones / streams tables) so we use a real DB.
  */
@@ -84,6 +86,7 @@ static void clear_all(void) {
     sqlite3 *db = get_db_handle();
     sqlite3_exec(db, "DELETE FROM detection_zones;", NULL, NULL, NULL);
     sqlite3_exec(db, "DELETE FROM streams;", NULL, NULL, NULL);
+    bump_detection_zones_version();
 }
 
 /* ---- Unity boilerplate ---- */
@@ -298,6 +301,129 @@ void test_stream_object_exclude_keeps_unmatched_label(void) {
     TEST_ASSERT_EQUAL_INT(1, r.count);
 }
 
+/* ================================================================
+ * compiled zone cache
+ * ================================================================ */
+
+void test_zone_changes_are_picked_up(void) {
+    ensure_stream("cam_reload");
+    detection_zone_t z = make_square_zone("cam_reload", "left", true, NULL, 0.0f);
+    save_detection_zones("cam_reload", &z, 1);
+
+    detection_result_t r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_reload", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+
+    // Disabling the only zone turns filtering off
+    update_zone_enabled("zone-test-1", false);
+    r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_reload", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+
+    // Replacing the zones moves the active area
+    z.enabled = true;
+    for (int i = 0; i < 4; i++) {
+        z.polygon[i].x += 0.5f;
+        z.polygon[i].y += 0.5f;
+    }
+    save_detection_zones("cam_reload", &z, 1);
+    r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_reload", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    r = make_result_1det("car", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_reload", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+}
+
+void test_deleted_stream_drops_cached_zones(void) {
+    ensure_stream("cam_gone");
+    detection_zone_t z = make_square_zone("cam_gone", "zone", true, NULL, 0.0f);
+    save_detection_zones("cam_gone", &z, 1);
+
+    detection_result_t r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_gone", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+
+    TEST_ASSERT_EQUAL_INT(0, delete_stream_config_internal("cam_gone", true));
+    r = make_result_1det("car", 0.7f, 0.7f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_gone", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+}
+
+void test_points_near_zone_edge_use_exact_polygon(void) {
+    ensure_stream("cam_tri");
+    detection_zone_t z = make_square_zone("cam_tri", "triangle", true, NULL, 0.0f);
+    z.polygon[0] = (zone_point_t){0.0f, 0.0f};
+    z.polygon[1] = (zone_point_t){1.0f, 0.0f};
+    z.polygon[2] = (zone_point_t){0.0f, 1.0f};
+    z.polygon_count = 3;
+    save_detection_zones("cam_tri", &z, 1);
+
+    // Zero-size boxes so the center is the given point; the hypotenuse is x + y = 1
+    const float inside[][2] = { {0.499f, 0.499f}, {0.3f, 0.69f}, {0.01f, 0.98f}, {0.2f, 0.2f} };
+    const float outside[][2] = { {0.501f, 0.501f}, {0.3f, 0.71f}, {0.9f, 0.9f}, {1.2f, 0.1f} };
+    for (int i = 0; i < 4; i++) {
+        detection_result_t r = make_result_1det("car", inside[i][0], inside[i][1], 0.0f, 0.0f, 0.9f);
+        filter_detections_by_zones("cam_tri", &r);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(1, r.count, "point inside the triangle was rejected");
+
+        r = make_result_1det("car", outside[i][0], outside[i][1], 0.0f, 0.0f, 0.9f);
+        filter_detections_by_zones("cam_tri", &r);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, r.count, "point outside the triangle was accepted");
+    }
+}
+
+void test_class_list_is_trimmed(void) {
+    ensure_stream("cam_trim");
+    detection_zone_t z = make_square_zone("cam_trim", "zone", true, " car ,  person ", 0.0f);
+    save_detection_zones("cam_trim", &z, 1);
+
+    detection_result_t r = make_result_1det("person", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_trim", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+
+    r = make_result_1det("dog", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_trim", &r);
+    TEST_ASSERT_EQUAL_INT(0, r.count);
+}
+
+void test_first_accepting_zone_sets_zone_id(void) {
+    ensure_stream("cam_two");
+    detection_zone_t z[2];
+    z[0] = make_square_zone("cam_two", "cars", true, "car", 0.0f);
+    z[1] = make_square_zone("cam_two", "anything", true, NULL, 0.0f);
+    safe_strcpy(z[1].id, "zone-test-2", sizeof(z[1].id), 0);
+    save_detection_zones("cam_two", z, 2);
+
+    detection_result_t r = make_result_1det("person", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_two", &r);
+    TEST_ASSERT_EQUAL_INT(1, r.count);
+    TEST_ASSERT_EQUAL_STRING("zone-test-2", r.detections[0].zone_id);
+
+    r = make_result_1det("car", 0.1f, 0.1f, 0.1f, 0.1f, 0.9f);
+    filter_detections_by_zones("cam_two", &r);
+    TEST_ASSERT_EQUAL_STRING("zone-test-1", r.detections[0].zone_id);
+}
+
+void test_motion_mask_follows_zones(void) {
+    ensure_stream("cam_mask");
+    bool mask[16];
+
+    TEST_ASSERT_EQUAL_INT(0, build_motion_zone_mask("cam_mask", 4, mask));
+    for (int i = 0; i < 16; i++) {
+        TEST_ASSERT_TRUE(mask[i]);
+    }
+
+    detection_zone_t z = make_square_zone("cam_mask", "zone", true, NULL, 0.0f);
+    save_detection_zones("cam_mask", &z, 1);
+    TEST_ASSERT_EQUAL_INT(1, build_motion_zone_mask("cam_mask", 4, mask));
+    for (int gy = 0; gy < 4; gy++) {
+        for (int gx = 0; gx < 4; gx++) {
+            TEST_ASSERT_EQUAL(gx < 2 && gy < 2, mask[gy * 4 + gx]);
+        }
+    }
+}
+
 /* ================================================================
  * main
  * ================================================================ */
@@ -325,6 +451,12 @@ int main(void) {
     RUN_TEST(test_stream_object_include_drops_unmatched_label);
     RUN_TEST(test_stream_object_exclude_drops_matching_label);
     RUN_TEST(test_stream_object_exclude_keeps_unmatched_label);
+    RUN_TEST(test_zone_changes_are_picked_up);
+    RUN_TEST(test_deleted_stream_drops_cached_zones);
+    RUN_TEST(test_points_near_zone_edge_use_exact_polygon);
+    RUN_TEST(test_class_list_is_trimmed);
+    RUN_TEST(test_first_accepting_zone_sets_zone_id);
+    RUN_TEST(test_motion_mask_follows_zones);
     int result = UNITY_END();
     shutdown_database();
     unlink(TEST_DB_PATH);
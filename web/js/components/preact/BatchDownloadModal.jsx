@@ -26,7 +26,9 @@ async function downloadSequential(recordings) {
 }
 
 /**
- * ZIP download: POST to server, poll for completion, then redirect to result URL.
+ * ZIP download: POST to server, then start the download from the result URL.
+ * The server streams the archive as it reads the recordings, so there is
+ * nothing to wait for once the job exists.
  * @param {number[]} ids
  * @param {string}  filename
  * @param {Function} onProgress  (current, total) => void
@@ -43,16 +45,7 @@ async function downloadZip(ids, filename, onProgress, onComplete, onError) {
     if (!resp.ok) throw new Error(`Server error ${resp.status}`);
     const { token, total } = await resp.json();
 
-    // Poll status
-    while (true) {
-      await new Promise(r => setTimeout(r, 800));
-      const st = await fetch(`/api/recordings/batch-download/status/${token}`);
-      if (!st.ok) throw new Error('Status poll failed');
-      const { status, current } = await st.json();
-      onProgress(current, total);
-      if (status === 'complete') break;
-      if (status === 'error')   throw new Error('ZIP creation failed on server');
-    }
+    onProgress(total, total);
 
     // Trigger download
     const a = document.createElement('a');